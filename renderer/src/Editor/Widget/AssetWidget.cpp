@@ -55,27 +55,29 @@ bool AssetWidget::MaterialAssetUI(std::shared_ptr<Material> material)
     ImGui::SeparatorText("");
     if(ImGui::CollapsingHeader("Pipeline states"))
     {
+        bool pipelineUpdate = false;
+
         int renderQueue = material->renderQueue;
-        ImGui::InputInt("Render queue", &renderQueue);
+        pipelineUpdate |= ImGui::InputInt("Render queue", &renderQueue);
         material->renderQueue = renderQueue;
 
         const char* cullModes[] = { "CULL_MODE_NONE", 
                                     "CULL_MODE_FRONT", 
                                     "CULL_MODE_BACK" };
         int cullMode = material->cullMode;
-        update |= ImGui::Combo("Cull mode", &cullMode, cullModes, IM_ARRAYSIZE(cullModes));
+        pipelineUpdate |= ImGui::Combo("Cull mode", &cullMode, cullModes, IM_ARRAYSIZE(cullModes));
         material->cullMode = (RasterizerCullMode)cullMode;
 
         const char* fillModes[] = { "FILL_MODE_POINT", 
                                     "FILL_MODE_WIREFRAME", 
                                     "FILL_MODE_SOLID" };
         int fillMode = material->fillMode;
-        update |= ImGui::Combo("Fill mode", &fillMode, fillModes, IM_ARRAYSIZE(fillModes));
+        pipelineUpdate |= ImGui::Combo("Fill mode", &fillMode, fillModes, IM_ARRAYSIZE(fillModes));
         material->fillMode = (RasterizerFillMode)fillMode;
 
-        ImGui::Checkbox("Depth test", &material->depthTest);
+        pipelineUpdate |= ImGui::Checkbox("Depth test", &material->depthTest);
         ImGui::SameLine();
-        ImGui::Checkbox("Depth write", &material->depthWrite);
+        pipelineUpdate |= ImGui::Checkbox("Depth write", &material->depthWrite);
 
         const char* depthCompares[] = { "COMPARE_FUNCTION_LESS", 
                                         "COMPARE_FUNCTION_LESS_EQUAL", 
@@ -86,22 +88,25 @@ bool AssetWidget::MaterialAssetUI(std::shared_ptr<Material> material)
                                         "COMPARE_FUNCTION_NEVER", 
                                         "COMPARE_FUNCTION_ALWAYS"};
         int depthCompare = material->depthCompare;
-        update |= ImGui::Combo("Depth compare", &depthCompare, depthCompares, IM_ARRAYSIZE(depthCompares));
+        pipelineUpdate |= ImGui::Combo("Depth compare", &depthCompare, depthCompares, IM_ARRAYSIZE(depthCompares));
         material->depthCompare = (CompareFunction)depthCompare;
 
         ImGui::SeparatorText("Pass masks");
-        ImGui::CheckboxFlags("Forward", &material->renderPassMask, PASS_MASK_FORWARD_PASS);
+        pipelineUpdate |= ImGui::CheckboxFlags("Forward", &material->renderPassMask, PASS_MASK_FORWARD_PASS);
         ImGui::SameLine();
-        ImGui::CheckboxFlags("Deferred", &material->renderPassMask, PASS_MASK_DEFERRED_PASS);
+        pipelineUpdate |= ImGui::CheckboxFlags("Deferred", &material->renderPassMask, PASS_MASK_DEFERRED_PASS);
         ImGui::SameLine();
-        ImGui::CheckboxFlags("Transparent", &material->renderPassMask, PASS_MASK_TRANSPARENT_PASS);
+        pipelineUpdate |= ImGui::CheckboxFlags("Transparent", &material->renderPassMask, PASS_MASK_TRANSPARENT_PASS);
 
         ImGui::SeparatorText("Vertex shader");
-        update |= AssetWidget::UI(material->vertexShader, pushID++);
+        pipelineUpdate |= AssetWidget::UI(material->vertexShader, pushID++);
         ImGui::SeparatorText("Geometry shader");
-        update |= AssetWidget::UI(material->geometryShader, pushID++);
+        pipelineUpdate |= AssetWidget::UI(material->geometryShader, pushID++);
         ImGui::SeparatorText("Fragment shader");
-        update |= AssetWidget::UI(material->fragmentShader, pushID++);
+        pipelineUpdate |= AssetWidget::UI(material->fragmentShader, pushID++);
+
+        if(pipelineUpdate) Material::UpdatePipelineState();     // 通知mesh pass重新合批
+        update |= pipelineUpdate;
     }
 
     if(update) material->Update();
@@ -50,13 +50,9 @@ void ComponentWidget::TransformComponentUI(std::shared_ptr<TransformComponent> c
     Vec3 eulerAngle = component->transform.GetEulerAngle();
     Vec3 scale = component->transform.GetScale();
 
-    ImGui::DragFloat3("Position", &position[0], 0.1f);
-	ImGui::DragFloat3("Rotation", &eulerAngle[0]);
-    ImGui::DragFloat3("Scale", &scale[0], 0.1f);
-
-    component->transform.SetPosition(position);
-    component->transform.SetRotation(eulerAngle);
-    component->transform.SetScale(scale);
+    if(ImGui::DragFloat3("Position", &position[0], 0.1f))  component->SetPosition(position);     // 只在修改时写回，避免每帧都标脏
+	if(ImGui::DragFloat3("Rotation", &eulerAngle[0]))      component->SetRotation(eulerAngle);
+    if(ImGui::DragFloat3("Scale", &scale[0], 0.1f))        component->SetScale(scale);
 }
 
 void ComponentWidget::DirectionalLightComponentUI(std::shared_ptr<DirectionalLightComponent> component)
@@ -174,7 +170,7 @@ void ComponentWidget::MeshRendererComponentUI(std::shared_ptr<MeshRendererCompon
 	ImGui::Checkbox("Cast shadow", &component->castShadow);
 	
 	ImGui::SeparatorText("Mesh:");
-	AssetWidget::UI(component->model);
+	if(AssetWidget::UI(component->model)) component->MarkDrawableDirty(DRAWABLE_DIRTY_MESH);
 	
 	ImGui::SeparatorText("Materials:");
 	ImGui::Text("Inspect mode:");
@@ -196,7 +192,7 @@ void ComponentWidget::MeshRendererComponentUI(std::shared_ptr<MeshRendererCompon
 			uint64_t pushID = component->materials[index] != nullptr ? (uint64_t)component->materials[index].get() : index;
 			ImGui::PushID(pushID);
 			ImGui::SeparatorText(("[Sub mesh : " + std::to_string(index) + "]").c_str());
-            AssetWidget::UI(component->materials[index]);
+            if(AssetWidget::UI(component->materials[index])) component->MarkDrawableDirty(DRAWABLE_DIRTY_MATERIAL);
 			ImGui::PopID();
 		}
 	}
@@ -204,7 +200,7 @@ void ComponentWidget::MeshRendererComponentUI(std::shared_ptr<MeshRendererCompon
 	{
 		uint32_t index = component->materilalInspectIndex;
 		ImGui::SeparatorText(("[Sub mesh : " + std::to_string(index) + "]").c_str());
-		AssetWidget::UI(component->materials[index]);
+		if(AssetWidget::UI(component->materials[index])) component->MarkDrawableDirty(DRAWABLE_DIRTY_MATERIAL);
 	}
 }
 
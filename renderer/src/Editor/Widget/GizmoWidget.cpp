@@ -72,7 +72,7 @@ void GizmoWidget::UI()
         Mat4 model = transform->GetModelMat();
         Mat4 delta;
         ImGuizmo::Manipulate((float*)&view, (float*)&proj, mCurrentGizmoOperation, mCurrentGizmoMode, (float*)&model, (float*)&delta, NULL);
-        if(delta != Mat4::Identity()) transform->SetTransform(model);  // 做个判断，不然参数输入和这里会冲突
+        if(delta != Mat4::Identity()) transform->SetWorldTransform(model);  // 做个判断，不然参数输入和这里会冲突
     }	
 }
 
@@ -1,8 +1,9 @@
 #include "InspectorWidget.h"
 #include "ComponentWidget.h"
-#include "Core/Util/TimeScope.h"
+#include "Core/Util/Profiler.h"
 #include "Function/Global/EngineContext.h"
 #include "PassWidget.h"
+#include "PoolWidget.h"
 #include "SurfaceCacheWidget.h"
 #include "TimerWidget.h"
 #include "RDGGraphWidget.h"
@@ -128,29 +129,43 @@ void InspectorWidget::InfoUI()
 		ImGui::Text("Average frame time : %f ms", totalFrameTime / frameTimes.size());
 		ImGui::Text("Average frame fps : %f ", 1000.0f / (totalFrameTime / frameTimes.size()));
 
+		const ScenePrimitiveStatistics& primitiveStatistics = EngineContext::Render()->GetMeshManager()->GetPrimitiveStatistics();
+		ImGui::Text("Scene primitives : %d, touched : %d, collected : %d, recomputed objects : %d",
+			primitiveStatistics.primitiveCount, primitiveStatistics.touchedPrimitives, primitiveStatistics.collectedPrimitives, primitiveStatistics.recomputedObjects);
+		ImGui::Text("Draw batches : %d, cpu culled : %d, rebuilt passes : %d, rebuilt batches : %d",
+			primitiveStatistics.drawBatchCount, primitiveStatistics.culledBatches, primitiveStatistics.rebuiltPasses, primitiveStatistics.rebuiltDrawBatches);
+
 		// ImGui::Separator();
 	}
 
+	// 资源池统计
+	{
+		ImGui::SeparatorText("Resource Pool");
+		PoolWidget::UI();
+	}
+
 	// 火焰图
 	{
 		ImGui::SeparatorText("Flame Graph");
 
 		static bool update = false;
-		static std::map<uint32_t, std::shared_ptr<TimeScopes>> previousTimers;
+		static ProfilerFrame previousFrame;
 
 		ImGui::Checkbox("Update", &update);
 		if(update)
 		{
-			previousTimers = EngineContext::GetHistoryTimeScopes();
+			previousFrame = Profiler::Get()->GetHistoryFrame();
 		}
 		ImGui::SameLine();
 		if(ImGui::Button("Update once"))
 		{
-			previousTimers = EngineContext::GetHistoryTimeScopes();
+			previousFrame = Profiler::Get()->GetHistoryFrame();
 		}
+		ImGui::SameLine();
+		TimerWidget::CaptureUI();
 
-		if(previousTimers.empty()) previousTimers = EngineContext::GetHistoryTimeScopes();
-		TimerWidget::TimeScopeUI(previousTimers);
+		if(previousFrame.threads.empty()) previousFrame = Profiler::Get()->GetHistoryFrame();
+		TimerWidget::TimeScopeUI(previousFrame);
 	}
 	
 }
\ No newline at end of file
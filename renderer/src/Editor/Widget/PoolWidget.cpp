@@ -0,0 +1,87 @@
+#include "PoolWidget.h"
+
+#include "Function/Global/EngineContext.h"
+#include "Function/Render/RenderResource/PipelineCache.h"
+#include "Function/Render/RenderResource/UploadHeap.h"
+
+#include <cfloat>
+#include <cstdint>
+#include <imgui.h>
+#include <string>
+
+void PoolWidget::UI()
+{
+    uint32_t frameIndex = EngineContext::ThreadPool()->ThreadFrameIndex();
+    RDGPoolConfig pipelineConfig = GraphicsPipelineCache::Get()->GetConfig();
+
+    ImGuiTableFlags flags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit;
+    if (ImGui::BeginTable("pool_table", 8, flags))
+    {
+        ImGui::TableSetupColumn("Pool");
+        ImGui::TableSetupColumn("Hits");
+        ImGui::TableSetupColumn("Misses");
+        ImGui::TableSetupColumn("Evictions");
+        ImGui::TableSetupColumn("Pooled");
+        ImGui::TableSetupColumn("Pooled MB");
+        ImGui::TableSetupColumn("Max unused frames");
+        ImGui::TableSetupColumn("Budget MB");
+        ImGui::TableHeadersRow();
+
+        StatsRow("Buffer", RDGBufferPool::Get()->GetStats(), RDGBufferPool::Get()->GetConfig(), true);
+        StatsRow("Texture", RDGTexturePool::Get()->GetStats(), RDGTexturePool::Get()->GetConfig(), true);
+        StatsRow("Texture view", RDGTextureViewPool::Get()->GetStats(), RDGTextureViewPool::Get()->GetConfig(), false);
+        StatsRow("Descriptor set", RDGDescriptorSetPool::Get(frameIndex)->GetStats(), RDGDescriptorSetPool::Get(frameIndex)->GetConfig(), false);
+        StatsRow("Graphics pipeline", GraphicsPipelineCache::Get()->GetStats(), pipelineConfig, false);
+
+        ImGui::EndTable();
+    }
+    GraphicsPipelineCache::Get()->SetConfig(pipelineConfig);    // 管线缓存在工作线程上访问，配置需要加锁写回
+
+    RDGPoolStats descriptorStats = RDGDescriptorSetPool::Get(frameIndex)->GetStats();
+    ImGui::Text("Descriptor set reuses: %d / %d hits, writes skipped", descriptorStats.reuses, descriptorStats.hits);
+
+    UploadHeapStats uploadStats = UploadHeap::Get()->GetStats();
+    ImGui::Text("Upload heap: %.1f / %.1f MB, uploads: %d, copies: %d, %.2f MB, fallback: %d", 
+        uploadStats.usedBytes / (1024.0f * 1024.0f), uploadStats.capacity / (1024.0f * 1024.0f),
+        uploadStats.uploadCount, uploadStats.copyCount, uploadStats.uploadBytes / (1024.0f * 1024.0f), uploadStats.fallbackCount);
+
+    PipelineCompileStats compileStats = GraphicsPipelineCache::Get()->GetCompileStats();
+    ImGui::Text("Pipeline compile queue: %d (max %d), compiled: %d, failed: %d", 
+        compileStats.queueDepth, compileStats.maxQueueDepth, compileStats.compiledCount, compileStats.failedCount);
+    ImGui::Text("Compile time avg: %.2f ms, max: %.2f ms, latency avg: %.2f ms", 
+        compileStats.AverageTime(), compileStats.maxTime, compileStats.AverageLatency());
+
+    float histogram[PIPELINE_COMPILE_HISTOGRAM_SIZE];
+    for(uint32_t i = 0; i < PIPELINE_COMPILE_HISTOGRAM_SIZE; i++) histogram[i] = compileStats.histogram[i];
+    ImGui::PlotHistogram("Compile time (<1, <2, <4 ... ms)", histogram, PIPELINE_COMPILE_HISTOGRAM_SIZE, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 60));
+}
+
+void PoolWidget::StatsRow(const char* name, const RDGPoolStats& stats, RDGPoolConfig& config, bool hasBytes)
+{
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn(); ImGui::Text("%s", name);
+    ImGui::TableNextColumn(); ImGui::Text("%d", stats.hits);
+    ImGui::TableNextColumn(); ImGui::Text("%d", stats.misses);
+    ImGui::TableNextColumn(); ImGui::Text("%d", stats.evictions);
+    ImGui::TableNextColumn(); ImGui::Text("%d", stats.pooledCount);
+
+    ImGui::TableNextColumn(); 
+    if(hasBytes)    ImGui::Text("%.1f", stats.pooledBytes / (1024.0f * 1024.0f));
+    else            ImGui::Text("-");
+
+    std::string id = std::string("##") + name;
+
+    ImGui::TableNextColumn();
+    int maxUnusedFrames = config.maxUnusedFrames;
+    ImGui::SetNextItemWidth(80);
+    if(ImGui::DragInt((id + "frames").c_str(), &maxUnusedFrames, 1.0f, 0, 100000)) config.maxUnusedFrames = maxUnusedFrames;
+
+    ImGui::TableNextColumn();
+    if(hasBytes)
+    {
+        int budget = config.maxPooledBytes / (1024 * 1024);   // 0为不限制
+        ImGui::SetNextItemWidth(80);
+        if(ImGui::DragInt((id + "budget").c_str(), &budget, 1.0f, 0, 65536)) config.maxPooledBytes = (uint64_t)budget * 1024 * 1024;
+    }
+    else ImGui::Text("-");
+}
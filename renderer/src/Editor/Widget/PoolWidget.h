@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Function/Render/RDG/RDGPool.h"
+
+class PoolWidget
+{
+public:
+    static void UI();
+
+private:
+    static void StatsRow(const char* name, const RDGPoolStats& stats, RDGPoolConfig& config, bool hasBytes);
+};
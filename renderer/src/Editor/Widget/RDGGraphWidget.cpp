@@ -603,6 +603,13 @@ void RDGGraphWidget::UIInternel(bool* open)
             RDGTextureViewPool::Get()->AllocatedSize(),
             RDGDescriptorSetPool::Get(currentFrameIndex)->AllocatedSize());
 
+        auto transientStats = RDGTransientAllocator::Get()->GetStats();
+        ImGui::Text("Transient memory: %.1f MB(pooled) / %.1f MB(placed) / %.1f MB(heap), resource count: %d",
+            transientStats.pooledBytes / (1024.0f * 1024.0f),
+            transientStats.placedBytes / (1024.0f * 1024.0f),
+            RDGTransientAllocator::Get()->HeapBytes() / (1024.0f * 1024.0f),
+            transientStats.resourceCount);
+
         
         
         if(init)
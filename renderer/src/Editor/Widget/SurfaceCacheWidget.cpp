@@ -40,6 +40,13 @@ void SurfaceCacheWidget::UIInternel(bool* open)
         return;
     }
 
+    if(EngineContext::RHI()->GetBackendInfo().type != BACKEND_VULKAN)     // 纹理句柄只有vulkan后端能交给imgui
+    {
+        ImGui::Text("Surface cache preview requires vulkan backend");
+        ImGui::End();
+        return;
+    }
+
     static SamplerRef sampler;
     static VkDescriptorSet handle[5];
     static ImVec2 imageSize = { SURFACE_CACHE_SIZE, SURFACE_CACHE_SIZE };
@@ -1,72 +1,54 @@
 #include "TimerWidget.h"
 
-#include "Core/Util/TimeScope.h"
+#include "Core/Util/Profiler.h"
+#include "Function/Global/EngineContext.h"
 
 #include "imgui_widget_flamegraph.h"
+#include <imgui.h>
 #include <algorithm>
-#include <array>
 #include <string>
 
-static std::array<TimePoint, 2> period;
+static uint64_t periodBegin = 0;
 
 static void ProfilerValueGetter(float* startTimestamp, float* endTimestamp, ImU8* level, const char** caption, const void* data, int idx)
 {
-    auto scopes = (TimeScopes*) data;
-
-    auto& firstScope = scopes->GetScopes()[0];
-    auto& scope = scopes->GetScopes()[idx];
+    auto threadEvents = (const ProfilerThreadEvents*) data;
+    auto& event = threadEvents->events[idx];
 
     if (startTimestamp)
     {
-        auto time = std::chrono::duration_cast<std::chrono::microseconds>(scope->GetBeginTime() - period[0]);
-        *startTimestamp = (float)time.count() / 1000;
+        *startTimestamp = (float)Profiler::ToMicroSeconds(event.begin - periodBegin) / 1000;
     }
     if (endTimestamp)
     {
-        auto time = std::chrono::duration_cast<std::chrono::microseconds>(scope->GetEndTime() - period[0]);
-        *endTimestamp = (float)time.count() / 1000;
+        *endTimestamp = (float)Profiler::ToMicroSeconds(event.end - periodBegin) / 1000;
     }
     if (level)
     {
-        *level = scope->GetDepth();
+        *level = event.depth;
     }
     if (caption)
     {
-        *caption = scope->name.c_str();
+        *caption = event.name;
     }
 }
 
-void TimerWidget::TimeScopeUI(const std::map<uint32_t, std::shared_ptr<TimeScopes>>& timeScopes)
+void TimerWidget::TimeScopeUI(const ProfilerFrame& frame)
 {
-    period = {};
-    bool init = false;
-    for(auto& pair : timeScopes)
-    {
-        if(pair.second && pair.second->GetScopes().size() > 0)
-        {
-            auto& begin = pair.second->GetBeginTime();
-            auto& end = pair.second->GetEndTime();
-            
-            period[0] = init ? std::min(begin, period[0]) : begin;
-            period[1] = init ? std::max(end, period[1]) : end;
-            init = true;
-        }
-    }
-    auto time = std::chrono::duration_cast<std::chrono::microseconds>(period[1] - period[0]);
-    float scaleMax = (float)time.count() / 1000;
+    periodBegin = frame.begin;
+    float scaleMax = (float)Profiler::ToMicroSeconds(frame.end - frame.begin) / 1000;
 
-    for(auto& pair : timeScopes)
+    for(auto& threadEvents : frame.threads)
     {
-        auto scopes = pair.second.get();
-        if(scopes)
+        if(threadEvents.events.size() > 0)
         {
-            std::string name = "[" + std::to_string(pair.first) + "] Thread Time";
+            std::string name = "[" + std::to_string(threadEvents.threadID) + "] Thread Time";
 
             ImGuiWidgetFlameGraph::PlotFlame(
                 "", 
                 ProfilerValueGetter, 
-                scopes, 
-                scopes->Size(),
+                &threadEvents, 
+                threadEvents.events.size(),
                 0,
                 name.c_str(), 
                 0, 
@@ -74,4 +56,30 @@ void TimerWidget::TimeScopeUI(const std::map<uint32_t, std::shared_ptr<TimeScope
                 ImVec2(0, 0));
         }
     }
-}
\ No newline at end of file
+}
+
+void TimerWidget::CaptureUI()
+{
+    static int frameCount = 8;
+
+    auto& profiler = Profiler::Get();
+    if(profiler->IsCapturing())
+    {
+        ImGui::Text("Capturing... %d / %d", profiler->CapturedFrames(), frameCount);
+        return;
+    }
+
+    ImGui::SetNextItemWidth(100);
+    ImGui::InputInt("Frames", &frameCount);
+    frameCount = std::clamp(frameCount, 1, PROFILER_MAX_CAPTURE_FRAMES);
+    ImGui::SameLine();
+    if(ImGui::Button("Capture"))
+    {
+        std::string dir = EngineContext::File()->CachePath() + "Profiler/";
+        EngineContext::File()->CreateDir(dir, true);
+        std::string path = dir + "Trace_" + std::to_string(EngineContext::GetCurretTick()) + ".json";
+
+        profiler->RequestCapture(frameCount, EngineContext::File()->Absolute(path));
+        ENGINE_LOG_INFO("Profiler capturing {} frames to {}", frameCount, path);
+    }
+}
@@ -1,10 +1,10 @@
 #pragma once
 
-#include "Core/Util/TimeScope.h"
-#include <map>
+#include "Core/Util/Profiler.h"
 
 class TimerWidget
 {
 public:
-    static void TimeScopeUI(const std::map<uint32_t, std::shared_ptr<TimeScopes>>& timeScopes);
-};
\ No newline at end of file
+    static void TimeScopeUI(const ProfilerFrame& frame);
+    static void CaptureUI();        // 连续抓取若干帧，导出Chrome trace
+};
@@ -51,6 +51,9 @@ public:
         template<typename Type = Node>
         inline Type* To()   { return graph->GetNode<Type>(to); }
 
+        inline NodeID FromID()  { return from; }   // 不需要节点类型时避免dynamic_cast
+        inline NodeID ToID()    { return to; }
+
     private:
         EdgeID id;
         NodeID from;
@@ -117,6 +120,9 @@ public:
         return castNodes;
     }
 
+    inline uint32_t NodeCount() { return nodes.size(); }    // 包括已经remove的空位，可以直接作为按ID索引的数组大小
+    inline uint32_t EdgeCount() { return edges.size(); }
+
     template<typename Type = Edge>
     inline Type* GetEdge(EdgeID id) 
     { 
@@ -3,6 +3,7 @@
 #include "Math.h"
 
 #include <cstdint>
+#include <cstring>
 
 inline uint32_t MurmurAdd(uint32_t hash, uint32_t elememt)
 {
@@ -53,3 +54,23 @@ inline uint32_t Hash(const Vec3& first, const Vec3& second)
     return Hash(Hash(first), Hash(second));
 }
 
+
+inline uint32_t Hash(const void* data, uint64_t size, uint32_t seed = 0)    // 按4字节逐个累加，末尾不足4字节的部分补零，最后混入长度
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t hash = seed;
+    uint64_t i = 0;
+    for(; i + 4 <= size; i += 4)
+    {
+        uint32_t element;
+        memcpy(&element, bytes + i, 4);
+        hash = MurmurAdd(hash, element);
+    }
+    if(i < size)
+    {
+        uint32_t element = 0;
+        memcpy(&element, bytes + i, size - i);
+        hash = MurmurAdd(hash, element);
+    }
+    return MurmurMix(hash ^ (uint32_t)size);
+}
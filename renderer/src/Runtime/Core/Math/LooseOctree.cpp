@@ -0,0 +1,283 @@
+#include "LooseOctree.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#define LOOSE_OCTREE_USE_SSE 1
+#include <xmmintrin.h>
+#else
+#define LOOSE_OCTREE_USE_SSE 0
+#endif
+
+FrustumPlanes::FrustumPlanes(const Frustum& frustum, bool ignoreNear)
+{
+    const Vec4* planes[6] = {
+        &frustum.planeRight,
+        &frustum.planeLeft,
+        &frustum.planeTop,
+        &frustum.planeBottom,
+        &frustum.planeFar,
+        &frustum.planeNear };
+    planeCount = ignoreNear ? 5 : 6;
+
+    for(uint32_t i = 0; i < MAX_PLANE_COUNT; i++)
+    {
+        if(i < planeCount)
+        {
+            const Vec4& plane = *planes[i];
+            nx[i] = plane.x();
+            ny[i] = plane.y();
+            nz[i] = plane.z();
+            nd[i] = plane.w();
+        }
+        else    // 距离为负无穷，总在内部
+        {
+            nx[i] = ny[i] = nz[i] = 0.0f;
+            nd[i] = -FLT_MAX;
+        }
+        ax[i] = fabs(nx[i]);
+        ay[i] = fabs(ny[i]);
+        az[i] = fabs(nz[i]);
+    }
+}
+
+FrustumTestResult FrustumPlanes::Test(const Vec3& center, const Vec3& extent) const
+{
+    // 平面法线朝外，signedDistance >= radiusProject时完全在平面外，signedDistance <= -radiusProject时完全在平面内
+#if LOOSE_OCTREE_USE_SSE
+    __m128 cx = _mm_set1_ps(center.x());
+    __m128 cy = _mm_set1_ps(center.y());
+    __m128 cz = _mm_set1_ps(center.z());
+    __m128 ex = _mm_set1_ps(extent.x());
+    __m128 ey = _mm_set1_ps(extent.y());
+    __m128 ez = _mm_set1_ps(extent.z());
+
+    int outside = 0;
+    int intersect = 0;
+    for(uint32_t i = 0; i < MAX_PLANE_COUNT; i += 4)
+    {
+        __m128 distance = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_load_ps(nx + i), cx), _mm_mul_ps(_mm_load_ps(ny + i), cy)),
+            _mm_add_ps(_mm_mul_ps(_mm_load_ps(nz + i), cz), _mm_load_ps(nd + i)));
+        __m128 radius = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(_mm_load_ps(ax + i), ex), _mm_mul_ps(_mm_load_ps(ay + i), ey)),
+            _mm_mul_ps(_mm_load_ps(az + i), ez));
+
+        outside |= _mm_movemask_ps(_mm_cmpge_ps(distance, radius));
+        intersect |= _mm_movemask_ps(_mm_cmpgt_ps(distance, _mm_sub_ps(_mm_setzero_ps(), radius)));
+    }
+#else
+    bool outside = false;
+    bool intersect = false;
+    for(uint32_t i = 0; i < planeCount; i++)
+    {
+        float distance = nx[i] * center.x() + ny[i] * center.y() + nz[i] * center.z() + nd[i];
+        float radius = ax[i] * extent.x() + ay[i] * extent.y() + az[i] * extent.z();
+
+        outside |= distance >= radius;
+        intersect |= distance > -radius;
+    }
+#endif
+
+    if(outside) return FRUSTUM_OUTSIDE;
+    if(intersect) return FRUSTUM_INTERSECT;
+    return FRUSTUM_INSIDE;
+}
+
+LooseOctree::LooseOctree(Vec3 center, float halfSize, uint32_t maxDepth)
+: rootCenter(center)
+, rootHalfSize(halfSize)
+, maxDepth(maxDepth)
+{
+    Clear();
+}
+
+void LooseOctree::Update(uint32_t id, const BoundingBox& box)
+{
+    if(id >= elements.size()) elements.resize(id + 1);
+
+    Vec3 center = (box.maxBound + box.minBound) * 0.5f;
+    Vec3 extent = (box.maxBound - box.minBound) * 0.5f;
+    int32_t node = FindNode(center, extent);
+
+    Element& element = elements[id];
+    element.center = center;
+    element.extent = extent;
+    if(element.node == node) return;    // 大部分的小幅移动不需要换节点
+
+    if(element.node != -1) Unlink(id);
+    else size++;
+    Link(id, node);
+}
+
+void LooseOctree::Remove(uint32_t id)
+{
+    if(id >= elements.size() || elements[id].node == -1) return;
+    Unlink(id);
+    size--;
+}
+
+void LooseOctree::Clear()
+{
+    nodes.clear();
+    elements.clear();
+    outliers.clear();
+    size = 0;
+
+    Node root;
+    root.center = rootCenter;
+    root.halfSize = rootHalfSize;
+    root.depth = 0;
+    nodes.push_back(root);
+}
+
+void LooseOctree::Cull(const FrustumPlanes* frustums, uint32_t frustumCount, std::vector<uint32_t>& masks) const
+{
+    masks.assign(elements.size(), 0);
+    if(frustumCount == 0 || size == 0) return;
+
+    uint32_t activeMask = frustumCount >= 32 ? 0xFFFFFFFF : (1u << frustumCount) - 1;
+    CullElements(outliers, frustums, activeMask, 0, masks);
+    CullNode(0, frustums, activeMask, 0, masks);
+}
+
+int32_t LooseOctree::FindNode(const Vec3& center, const Vec3& extent)
+{
+    Vec3 offset = (center - rootCenter).cwiseAbs();
+    float maxExtent = extent.maxCoeff();
+    if(offset.maxCoeff() > rootHalfSize || maxExtent > rootHalfSize) return OUTLIER_NODE;
+
+    // 中心所在的子格子半边长不小于物体的半边长时继续下降，此时子节点的松散包围盒一定包含物体
+    int32_t nodeIndex = 0;
+    while(nodes[nodeIndex].depth < maxDepth && maxExtent <= nodes[nodeIndex].halfSize * 0.5f)
+    {
+        Vec3 nodeCenter = nodes[nodeIndex].center;
+        float childHalfSize = nodes[nodeIndex].halfSize * 0.5f;
+
+        uint32_t child =    (center.x() >= nodeCenter.x() ? 1 : 0) |
+                            (center.y() >= nodeCenter.y() ? 2 : 0) |
+                            (center.z() >= nodeCenter.z() ? 4 : 0);
+        if(nodes[nodeIndex].children[child] == -1)
+        {
+            Node node;
+            node.center = nodeCenter + Vec3(   child & 1 ? childHalfSize : -childHalfSize,
+                                                child & 2 ? childHalfSize : -childHalfSize,
+                                                child & 4 ? childHalfSize : -childHalfSize);
+            node.halfSize = childHalfSize;
+            node.depth = nodes[nodeIndex].depth + 1;
+            nodes.push_back(node);      // 会使引用失效，全程只用下标访问
+            nodes[nodeIndex].children[child] = nodes.size() - 1;
+        }
+        nodeIndex = nodes[nodeIndex].children[child];
+    }
+    return nodeIndex;
+}
+
+void LooseOctree::Link(uint32_t id, int32_t node)
+{
+    Element& element = elements[id];
+    element.node = node;
+
+    std::vector<uint32_t>& ids = node == OUTLIER_NODE ? outliers : nodes[node].elements;
+    element.slot = ids.size();
+    ids.push_back(id);
+    if(node == OUTLIER_NODE) return;
+
+    // 沿路径更新子树计数，节点的深度决定了需要经过的层数
+    Vec3 center = nodes[node].center;
+    int32_t nodeIndex = 0;
+    while(true)
+    {
+        nodes[nodeIndex].subtreeSize++;
+        if(nodeIndex == node) break;
+
+        Vec3 nodeCenter = nodes[nodeIndex].center;
+        uint32_t child =    (center.x() >= nodeCenter.x() ? 1 : 0) |
+                            (center.y() >= nodeCenter.y() ? 2 : 0) |
+                            (center.z() >= nodeCenter.z() ? 4 : 0);
+        nodeIndex = nodes[nodeIndex].children[child];
+    }
+}
+
+void LooseOctree::Unlink(uint32_t id)
+{
+    Element& element = elements[id];
+    int32_t node = element.node;
+
+    std::vector<uint32_t>& ids = node == OUTLIER_NODE ? outliers : nodes[node].elements;
+    uint32_t last = ids.back();         // 和末尾交换后删除
+    ids[element.slot] = last;
+    elements[last].slot = element.slot;
+    ids.pop_back();
+    element.node = -1;
+    if(node == OUTLIER_NODE) return;
+
+    Vec3 center = nodes[node].center;
+    int32_t nodeIndex = 0;
+    while(true)
+    {
+        nodes[nodeIndex].subtreeSize--;
+        if(nodeIndex == node) break;
+
+        Vec3 nodeCenter = nodes[nodeIndex].center;
+        uint32_t child =    (center.x() >= nodeCenter.x() ? 1 : 0) |
+                            (center.y() >= nodeCenter.y() ? 2 : 0) |
+                            (center.z() >= nodeCenter.z() ? 4 : 0);
+        nodeIndex = nodes[nodeIndex].children[child];
+    }
+}
+
+void LooseOctree::CullNode( uint32_t nodeIndex,
+                            const FrustumPlanes* frustums,
+                            uint32_t activeMask,
+                            uint32_t insideMask,
+                            std::vector<uint32_t>& masks) const
+{
+    const Node& node = nodes[nodeIndex];
+    if(node.subtreeSize == 0) return;
+
+    // 只测试还和节点相交的视锥，完全包含节点的视锥对子树内所有元素都可见
+    Vec3 looseExtent = Vec3::Constant(node.halfSize * 2.0f);
+    for(uint32_t pending = activeMask & ~insideMask; pending != 0; pending &= pending - 1)
+    {
+        uint32_t bit = pending & (~pending + 1);
+        uint32_t index = 0;
+        while((1u << index) != bit) index++;
+
+        FrustumTestResult result = frustums[index].Test(node.center, looseExtent);
+        if(result == FRUSTUM_OUTSIDE)       activeMask &= ~bit;
+        else if(result == FRUSTUM_INSIDE)   insideMask |= bit;
+    }
+    if(activeMask == 0) return;
+
+    CullElements(node.elements, frustums, activeMask, insideMask, masks);
+    for(int32_t child : node.children)
+    {
+        if(child != -1) CullNode(child, frustums, activeMask, insideMask, masks);
+    }
+}
+
+void LooseOctree::CullElements( const std::vector<uint32_t>& ids,
+                                const FrustumPlanes* frustums,
+                                uint32_t activeMask,
+                                uint32_t insideMask,
+                                std::vector<uint32_t>& masks) const
+{
+    uint32_t pendingMask = activeMask & ~insideMask;
+    for(uint32_t id : ids)
+    {
+        const Element& element = elements[id];
+        uint32_t mask = insideMask;
+        for(uint32_t pending = pendingMask; pending != 0; pending &= pending - 1)
+        {
+            uint32_t bit = pending & (~pending + 1);
+            uint32_t index = 0;
+            while((1u << index) != bit) index++;
+
+            if(frustums[index].Test(element.center, element.extent) != FRUSTUM_OUTSIDE) mask |= bit;
+        }
+        masks[id] = mask;
+    }
+}
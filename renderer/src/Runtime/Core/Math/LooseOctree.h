@@ -0,0 +1,98 @@
+#pragma once
+
+#include "BoundingBox.h"
+#include "Math.h"
+
+#include <cstdint>
+#include <vector>
+
+enum FrustumTestResult
+{
+    FRUSTUM_OUTSIDE = 0,
+    FRUSTUM_INTERSECT,
+    FRUSTUM_INSIDE,
+};
+
+// SoA存储的视锥平面，用SSE一次测试4个平面，判定方式和FrustumIntersectBox一致
+class FrustumPlanes
+{
+public:
+    FrustumPlanes() = default;
+    FrustumPlanes(const Frustum& frustum, bool ignoreNear = false);     // 去掉近平面后即为平行光的投影体，近平面外的物体仍可能投射阴影
+
+    FrustumTestResult Test(const Vec3& center, const Vec3& extent) const;
+
+private:
+    static const uint32_t MAX_PLANE_COUNT = 8;      // 不足的部分用永远通过的平面填充
+
+    alignas(16) float nx[MAX_PLANE_COUNT];
+    alignas(16) float ny[MAX_PLANE_COUNT];
+    alignas(16) float nz[MAX_PLANE_COUNT];
+    alignas(16) float nd[MAX_PLANE_COUNT];
+    alignas(16) float ax[MAX_PLANE_COUNT];          // 法线分量的绝对值，用于计算包围盒在法线上的投影半径
+    alignas(16) float ay[MAX_PLANE_COUNT];
+    alignas(16) float az[MAX_PLANE_COUNT];
+    uint32_t planeCount = 0;
+};
+
+// 松散八叉树，节点的包围盒是其格子的两倍，物体按中心所在的格子和尺寸放入对应层级，更新时只需要O(depth)的移动
+// 元素用外部的连续ID索引，例如RenderMeshManager的图元ID
+class LooseOctree
+{
+public:
+    LooseOctree(Vec3 center = Vec3::Zero(), float halfSize = 1024.0f, uint32_t maxDepth = 6);
+
+    void Update(uint32_t id, const BoundingBox& box);       // 不存在时插入
+    void Remove(uint32_t id);
+    void Clear();
+
+    // 对最多32个视锥同时剔除，masks按ID索引，第k位表示元素与第k个视锥相交
+    void Cull(const FrustumPlanes* frustums, uint32_t frustumCount, std::vector<uint32_t>& masks) const;
+
+    inline uint32_t Size() const                { return size; }
+    inline uint32_t NodeCount() const           { return nodes.size(); }
+
+private:
+    struct Node
+    {
+        Vec3 center;
+        float halfSize;                         // 格子的半边长，松散包围盒的半边长是它的两倍
+        uint32_t depth;
+        int32_t children[8] = { -1, -1, -1, -1, -1, -1, -1, -1 };
+        uint32_t subtreeSize = 0;               // 子树内的元素总数，为0时跳过
+        std::vector<uint32_t> elements;
+    };
+
+    struct Element
+    {
+        Vec3 center;
+        Vec3 extent;
+        int32_t node = -1;                      // -1为不在树中，OUTLIER_NODE为超出根节点
+        uint32_t slot = 0;                      // 在节点元素数组中的位置，用于O(1)删除
+    };
+
+    static const int32_t OUTLIER_NODE = -2;
+
+    int32_t FindNode(const Vec3& center, const Vec3& extent);
+    void Link(uint32_t id, int32_t node);
+    void Unlink(uint32_t id);
+    void CullNode(  uint32_t nodeIndex,
+                    const FrustumPlanes* frustums,
+                    uint32_t activeMask,
+                    uint32_t insideMask,
+                    std::vector<uint32_t>& masks) const;
+    void CullElements(  const std::vector<uint32_t>& ids,
+                        const FrustumPlanes* frustums,
+                        uint32_t activeMask,
+                        uint32_t insideMask,
+                        std::vector<uint32_t>& masks) const;
+
+    Vec3 rootCenter;
+    float rootHalfSize;
+    uint32_t maxDepth;
+
+    std::vector<Node> nodes;
+    std::vector<Element> elements;
+    std::vector<uint32_t> outliers;             // 超出根节点范围的元素，每次都逐个测试
+    uint32_t size = 0;
+};
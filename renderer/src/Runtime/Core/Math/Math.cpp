@@ -181,4 +181,12 @@ namespace Math
 
         return scale;
     }
-}
\ No newline at end of file
+
+    Mat4 AffineInverse(const Mat4& matrix)
+    {
+        Mat4 inv = Mat4::Identity();
+        inv.block<3,3>(0,0) = matrix.block<3,3>(0,0).inverse();
+        inv.block<3,1>(0,3) = -(inv.block<3,3>(0,0) * matrix.block<3,1>(0,3));
+        return inv;
+    }
+}
@@ -158,4 +158,6 @@ namespace Math
     void Mat3x4(Mat4 mat, float* newMat);
 
     Vec3 GetScale(const Mat4 &matrix);
+
+    Mat4 AffineInverse(const Mat4& matrix);     // 最后一行为(0,0,0,1)的仿射矩阵求逆，只对3x3部分求逆
 }
\ No newline at end of file
@@ -31,12 +31,11 @@ Mat4 Transform::GetMatrix() const
 
 Mat4 Transform::GetInverseMatrix() const
 {
-    // Mat4 invTransform = Mat4::Identity();
-    // invTransform.block<3,3>(0,0) = (rotation.toRotationMatrix() * scale.asDiagonal()).inverse();
-    // invTransform.block<3,1>(0,3) = -(invTransform.block<3,3>(0,0) * position);
-    // return invTransform;
-
-    return GetMatrix().inverse();
+    // (T * R * S)^-1 = S^-1 * R^T * T^-1，不需要通用的4x4求逆
+    Mat4 invTransform = Mat4::Identity();
+    invTransform.block<3,3>(0,0) = InverseScale().asDiagonal() * rotation.toRotationMatrix().transpose();
+    invTransform.block<3,1>(0,3) = -(invTransform.block<3,3>(0,0) * position);
+    return invTransform;
 }
 
 void Transform::UpdateVector()
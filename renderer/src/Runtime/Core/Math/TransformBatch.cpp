@@ -0,0 +1,43 @@
+#include "TransformBatch.h"
+
+#include <algorithm>
+
+void TransformBatch::Clear()
+{
+    items.clear();
+}
+
+void TransformBatch::Reserve(uint32_t size)
+{
+    items.reserve(size);
+}
+
+void TransformBatch::Resize(uint32_t size)
+{
+    items.resize(size);
+}
+
+uint32_t TransformBatch::Add(const Mat4& model, const Mat4& invModel, const Mat4& local, const Mat4& localInv, Mat4* world, Mat4* invWorld)
+{
+    items.push_back({ &model, &invModel, &local, &localInv, world, invWorld });
+    return items.size() - 1;
+}
+
+void TransformBatch::Set(uint32_t index, const Mat4& model, const Mat4& invModel, const Mat4& local, const Mat4& localInv, Mat4* world, Mat4* invWorld)
+{
+    items[index] = { &model, &invModel, &local, &localInv, world, invWorld };
+}
+
+void TransformBatch::Compute(uint32_t begin, uint32_t end)
+{
+    end = std::min(end, (uint32_t)items.size());
+    for(uint32_t index = begin; index < end; index++)
+    {
+        const Item& item = items[index];
+        if(!item.world) continue;
+
+        // 4x4相乘走Eigen的SSE路径，结果直接写入目标
+        item.world->noalias() = (*item.model) * (*item.local);
+        item.invWorld->noalias() = (*item.localInv) * (*item.invModel);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Math.h"
+
+#include <cstdint>
+#include <vector>
+
+// 一批仿射变换，每项计算 world = model * local 和它的逆 invWorld = localInv * invModel，不做通用的4x4求逆
+// model/invModel是物体的世界矩阵及其逆，由场景的TransformHierarchy按层级更新后缓存在TransformComponent里
+// localInv由调用方预先计算（例如子网格的变换，只在加载时求一次）
+// Add只记录地址，Compute时逐项计算后直接写入目标地址，不同范围可以分块并行
+// 也可以先Resize预留好项数，再用Set分块并行填写各自的范围，没有填写的项在计算时跳过
+class TransformBatch
+{
+public:
+    void Clear();
+    void Reserve(uint32_t size);
+    void Resize(uint32_t size);
+
+    // 传入的地址在Compute完成前需要保持有效
+    uint32_t Add(const Mat4& model, const Mat4& invModel, const Mat4& local, const Mat4& localInv, Mat4* world, Mat4* invWorld);
+    void Set(uint32_t index, const Mat4& model, const Mat4& invModel, const Mat4& local, const Mat4& localInv, Mat4* world, Mat4* invWorld);
+    inline uint32_t Size() const                        { return items.size(); }
+
+    // 计算[begin, end)范围内的项，不同的范围可以在不同线程并行计算
+    void Compute(uint32_t begin, uint32_t end);
+
+private:
+    struct Item
+    {
+        const Mat4* model = nullptr;
+        const Mat4* invModel = nullptr;
+        const Mat4* local = nullptr;
+        const Mat4* localInv = nullptr;
+        Mat4* world = nullptr;
+        Mat4* invWorld = nullptr;
+    };
+
+    std::vector<Item> items;
+};
@@ -6,6 +6,7 @@
 #include "Partitioner.h"
 #include "Core/Mesh/MeshOptimizor/MeshOptimizor.h"
 #include "Core/Math/Hash.h"
+#include "Core/Util/RadixSort.h"
 // #include "../bounding_box.h"
 // #include "../mesh_optimizor/mesh_optimizor.h"
 // #include "../../math/hash_table.h"
@@ -44,7 +45,7 @@ uint32_t Morton3D(Vec3 p)
     x = ExpandBits(x);
     y = ExpandBits(y);
     z = ExpandBits(z);
-    return (x << 2) | (y << 1) | (z << 1);
+    return (x << 2) | (y << 1) | z;
 }
 
 Vec3 GetTriangleCenter(
@@ -82,23 +83,25 @@ void BuildLocalityLinks(
     std::vector<uint32_t> sortKeys(triangleSize);
     std::vector<uint32_t> sortTo(triangleSize);                            //new_indices的反向索引
     std::vector<std::pair<uint32_t, uint32_t>> islandRuns(triangleSize);   //排序后各三角形对应的连通分量的起始和终止下标
+    std::vector<float> centerX(triangleSize);                              //三角形中心，SoA存储，后面的邻近搜索反复用到
+    std::vector<float> centerY(triangleSize);
+    std::vector<float> centerZ(triangleSize);
 
     for(uint32_t i = 0; i < triangleSize; i++)    //计算各三角面相对位置，莫顿码编码
     {
         Vec3 center = GetTriangleCenter(i, mesh);
+        centerX[i] = center.x();
+        centerY[i] = center.y();
+        centerZ[i] = center.z();
+
         Vec3 centerLocal = (center - bounds.minBound) * (1 / maxLength);  
 
         uint32_t morton = Morton3D(centerLocal);
         sortKeys[i] = morton;
     }
 
-    // UE: RadixSort32排序
-    // 按照莫顿码重新索引三角形序列
-    for (int i = 0; i < triangleSize; i++) { newTriangleIndex[i] = i; }
-    std::sort(newTriangleIndex.begin(), newTriangleIndex.end(),
-        [&](uint32_t i, uint32_t j) {
-            return sortKeys[i] < sortKeys[j];
-        });
+    // 按照莫顿码重新索引三角形序列，和UE一样使用基数排序
+    RadixSort32(sortKeys, newTriangleIndex);
 
     for (int i = 0; i < triangleSize; i++) { sortTo[newTriangleIndex[i]] = i; }
 
@@ -143,7 +146,6 @@ void BuildLocalityLinks(
         uint32_t runLength = islandRuns[i].second - islandRuns[i].first + 1;
         //if (runLength < 128)
         {         
-            Vec3 center = GetTriangleCenter(index, mesh);
             uint32_t islandID = graph.parents[index];
 
             const uint32_t maxLinksPerElement = 5;
@@ -182,7 +184,10 @@ void BuildLocalityLinks(
                     else
                     {
                         // Add to sorted list
-                        float adjDist2 = (center - GetTriangleCenter(adjIndex, mesh)).squaredNorm();
+                        float dx = centerX[index] - centerX[adjIndex];
+                        float dy = centerY[index] - centerY[adjIndex];
+                        float dz = centerZ[index] - centerZ[adjIndex];
+                        float adjDist2 = dx * dx + dy * dy + dz * dz;
                         for (int k = 0; k < maxLinksPerElement; k++)
                         {
                             if (adjDist2 < closestDist2[k])
@@ -238,6 +243,42 @@ bool VertexEqual(const std::shared_ptr<Mesh>& mesh0, uint32_t index0, const std:
     return equal;
 }
 
+// 开放寻址的哈希多重表，线性探测，不支持删除
+// 容量按最大元素数预先分配，负载因子不超过0.5；同一个键按插入顺序遍历，结果和逐键数组一致
+class EdgeHashTable
+{
+public:
+    EdgeHashTable(uint32_t maxSize)
+    {
+        uint32_t capacity = 16;
+        while (capacity < maxSize * 2) capacity <<= 1;
+        mask = capacity - 1;
+        slots.resize(capacity, { 0, EMPTY });
+    }
+
+    inline void Add(uint32_t key, uint32_t value)      // 键本身已经是哈希值，直接取低位作为槽位
+    {
+        uint32_t slot = key & mask;
+        while (slots[slot].second != EMPTY) slot = (slot + 1) & mask;
+        slots[slot] = { key, value };
+    }
+
+    template<typename Func>
+    inline void ForEach(uint32_t key, Func&& func) const
+    {
+        for (uint32_t slot = key & mask; slots[slot].second != EMPTY; slot = (slot + 1) & mask)
+        {
+            if (slots[slot].first == key) func(slots[slot].second);
+        }
+    }
+
+private:
+    static constexpr uint32_t EMPTY = ~0u;
+
+    uint32_t mask;
+    std::vector<std::pair<uint32_t, uint32_t>> slots;   // {键，值}
+};
+
 // 使用半边结构来构建模型的
 // 半边邻接图和三角面邻接图
 inline uint32_t Cycle3(uint32_t i) {
@@ -257,25 +298,28 @@ void BuildEdgeGraph(
     auto& positions = mesh->position;
     uint32_t indexCount = indices.size();
 
-    std::unordered_map<uint32_t, std::vector<uint32_t>> edgeHash;
+    std::vector<uint32_t> vertexHash(positions.size());    //每个顶点只算一次哈希
+    for (uint32_t i = 0; i < positions.size(); i++) vertexHash[i] = HashVertex(mesh, i);
+
+    EdgeHashTable edgeHash(indexCount);
     edgeGraph.Init(indexCount);
 
     for (uint32_t i = 0; i < indexCount; i++)
     {
-        uint32_t v0 = HashVertex(mesh, indices[i]);
-        uint32_t v1 = HashVertex(mesh, indices[Cycle3(i)]);
-        edgeHash[Hash(v0, v1)].push_back(i);
+        uint32_t v0 = vertexHash[indices[i]];
+        uint32_t v1 = vertexHash[indices[Cycle3(i)]];
+        edgeHash.Add(Hash(v0, v1), i);
 
-        for (uint32_t j : edgeHash[Hash(v1, v0)])         //三角形的手性是一致的，则若查找到了共享顶点且相反的半边
-        {                                                       //说明该边邻接着两个三角面，更新权重以将这两个边互相索引
-            if(VertexEqual(mesh, indices[Cycle3(i)], mesh, indices[j]) &&
+        edgeHash.ForEach(Hash(v1, v0), [&](uint32_t j) {       //三角形的手性是一致的，则若查找到了共享顶点且相反的半边
+            if(VertexEqual(mesh, indices[Cycle3(i)], mesh, indices[j]) &&   //说明该边邻接着两个三角面，更新权重以将这两个边互相索引
                VertexEqual(mesh, indices[i], mesh, indices[Cycle3(j)]))
             {
                 edgeGraph.IncreaseEdgeCost(i, j, 1);
                 edgeGraph.IncreaseEdgeCost(j, i, 1);
             }
-        }
+        });
     }
+    edgeGraph.Build();
 }
 
 // 根据半边的邻接构建三角形的邻接图，边权为1，当需要加入local时需要adjacency边权足够大
@@ -283,21 +327,20 @@ void BuildTriangleGraph(
     const PartitionGraph& edgeGraph,
     PartitionGraph& triangleGraph) 
 {
-    triangleGraph.Init(edgeGraph.graph.size() / 3);
-    uint32_t index = 0;
-    for (const auto& mp : edgeGraph.graph)
+    triangleGraph.Init(edgeGraph.NumNodes() / 3);
+    for (uint32_t index = 0; index < edgeGraph.NumNodes(); index++)
     {
-        for (auto& pair : mp) 
+        for (uint32_t j = edgeGraph.EdgeBegin(index); j < edgeGraph.EdgeEnd(index); j++) 
         {
-            triangleGraph.IncreaseEdgeCost(index / 3, pair.first / 3, 1);  //对于关联的负半边，根据索引找到对应的三角形，建立邻接
+            triangleGraph.IncreaseEdgeCost(index / 3, edgeGraph.adjacency[j] / 3, 1);  //对于关联的负半边，根据索引找到对应的三角形，建立邻接
         }
-        index++;
     }
 }
 
 void ClusterTriangles(
     const std::shared_ptr<Mesh>& mesh,
-    std::vector<MeshClusterRef>& clusters)
+    std::vector<MeshClusterRef>& clusters,
+    QueuedThreadPoolRef threadPool)
 {
     auto& indices = mesh->index;
     auto& positions = mesh->position;
@@ -306,9 +349,10 @@ void ClusterTriangles(
     BuildEdgeGraph(mesh, edgeGraph);                       //构建边的邻接图
     BuildTriangleGraph(edgeGraph, triangleGraph);         //构建三角形的邻接图 
     //BuildLocalityLinks(mesh, indices, triangleGraph);        //保证各分量连通
+    triangleGraph.Build();
 
     Partitioner partitioner;
-    partitioner.Partition(triangleGraph, MeshCluster::CLUSTER_SIZE - 4, MeshCluster::CLUSTER_SIZE);
+    partitioner.Partition(triangleGraph, MeshCluster::CLUSTER_SIZE - 4, MeshCluster::CLUSTER_SIZE, threadPool);
 
     // 根据划分结果构建clusters
     for (auto& range : partitioner.ranges) 
@@ -329,9 +373,9 @@ void ClusterTriangles(
                 uint32_t vertexIndex = indices[halfEdgeIndex];
 
                 bool isExternal = false;
-                for (auto& pair : edgeGraph.graph[halfEdgeIndex])
+                for (uint32_t j = edgeGraph.EdgeBegin(halfEdgeIndex); j < edgeGraph.EdgeEnd(halfEdgeIndex); j++)
                 {
-                    uint32_t adjEdgeIndex = pair.first;
+                    uint32_t adjEdgeIndex = edgeGraph.adjacency[j];
 
                     uint32_t adjTriangle = partitioner.sortTo[adjEdgeIndex / 3];       // sortTo[nodeID[i]] = i，反向映射，方便从变换后的三角形图查找未变换的半边图
                     if (adjTriangle < left || adjTriangle >= right)                         // 邻接三角形索引不在该聚类范围，说明此处为cluster边缘
@@ -360,11 +404,11 @@ void ClusterTriangles(
 // step 2. 聚类cluster为cluster group////////////////////////////////////////////////////////////////
 
 void BuildClustersEdgeGraph(
-    std::vector<MeshClusterRef> clusters,
+    const std::vector<MeshClusterRef>& clusters,
     const std::vector<std::pair<uint32_t, uint32_t>>& externalEdges,
     PartitionGraph& edgeGraph) 
 {
-    std::unordered_map<uint32_t, std::vector<uint32_t>> edgeHash;
+    EdgeHashTable edgeHash(externalEdges.size());
     edgeGraph.Init(externalEdges.size());
 
     uint32_t i = 0;
@@ -377,10 +421,9 @@ void BuildClustersEdgeGraph(
 
         uint32_t v0 = HashVertex(clusters[clusterID]->mesh, indices[originEdgeID]);
         uint32_t v1 = HashVertex(clusters[clusterID]->mesh, indices[Cycle3(originEdgeID)]);
-        edgeHash[Hash(v0, v1)].push_back(i);
+        edgeHash.Add(Hash(v0, v1), i);
 
-        for (uint32_t j : edgeHash[Hash(v1, v0)])     // 和BuildEdgeGraph中基本一致，只是需要额外通过cluster索引原边界半边的信息
-        {
+        edgeHash.ForEach(Hash(v1, v0), [&](uint32_t j) {   // 和BuildEdgeGraph中基本一致，只是需要额外通过cluster索引原边界半边的信息
             auto& pair1 = externalEdges[j];
 
             uint32_t otherClusterID = pair1.first;
@@ -394,9 +437,10 @@ void BuildClustersEdgeGraph(
                 edgeGraph.IncreaseEdgeCost(i, j, 1);
                 edgeGraph.IncreaseEdgeCost(j, i, 1);
             }
-        }
+        });
         i++;
     }
+    edgeGraph.Build();
 }
 
 void BuildClustersGraph(
@@ -406,15 +450,14 @@ void BuildClustersGraph(
     PartitionGraph& graph) 
 {
     graph.Init(numCluster);
-    uint32_t index = 0;
-    for (const auto& emp : edgeGraph.graph)
+    for (uint32_t index = 0; index < edgeGraph.NumNodes(); index++)
     {
-        for (auto& pair : emp) 
+        for (uint32_t j = edgeGraph.EdgeBegin(index); j < edgeGraph.EdgeEnd(index); j++) 
         {
-            graph.IncreaseEdgeCost(mp[index], mp[pair.first], 1);   // 和BuildTriangleGraph中基本一致，也是找关联半边建立邻接
+            graph.IncreaseEdgeCost(mp[index], mp[edgeGraph.adjacency[j]], 1);   // 和BuildTriangleGraph中基本一致，也是找关联半边建立邻接
         }
-        index++;
     }
+    graph.Build();
 }
 
 void GroupClusters(
@@ -422,7 +465,8 @@ void GroupClusters(
     uint32_t offset,
     uint32_t numCluster,
     std::vector<MeshClusterGroupRef>& clusterGroups,
-    uint32_t mipLevel)
+    uint32_t mipLevel,
+    QueuedThreadPoolRef threadPool)
 {
     std::vector<MeshClusterRef> subClusters;
     for (int i = 0; i < numCluster; i++) subClusters.push_back(clusters[offset + i]);
@@ -449,7 +493,7 @@ void GroupClusters(
     BuildClustersGraph(edgeGraph, mp, numCluster, graph);
 
     Partitioner partitioner;
-    partitioner.Partition(graph, MeshClusterGroup::GROUP_SIZE - 4, MeshClusterGroup::GROUP_SIZE);
+    partitioner.Partition(graph, MeshClusterGroup::GROUP_SIZE - 4, MeshClusterGroup::GROUP_SIZE, threadPool);
 
     for (auto& range : partitioner.ranges)
     {
@@ -468,9 +512,9 @@ void GroupClusters(
             for (uint32_t halfEdgeIndex = mp1[clusterID]; halfEdgeIndex < mp.size() && mp[halfEdgeIndex] == clusterID; halfEdgeIndex++) 
             {
                 bool isExternal = false;
-                for (auto& pair : edgeGraph.graph[halfEdgeIndex])
+                for (uint32_t j = edgeGraph.EdgeBegin(halfEdgeIndex); j < edgeGraph.EdgeEnd(halfEdgeIndex); j++)
                 {
-                    uint32_t adjEdge = pair.first;
+                    uint32_t adjEdge = edgeGraph.adjacency[j];
                     uint32_t adjCluster = partitioner.sortTo[mp[adjEdge]];
 
                     if (adjCluster < left || adjCluster >= right)
@@ -494,6 +538,17 @@ void GroupClusters(
 void BuildParentClusters(
     MeshClusterGroupRef& clusterGroup,
     std::vector<MeshClusterRef>& clusters)
+{
+    std::vector<MeshClusterRef> parentClusters;
+    BuildParentClusters(clusterGroup, clusters, parentClusters);
+
+    for (auto& cluster : parentClusters) clusters.push_back(cluster);
+}
+
+void BuildParentClusters(
+    MeshClusterGroupRef& clusterGroup,
+    const std::vector<MeshClusterRef>& clusters,
+    std::vector<MeshClusterRef>& parentClusters)
 {
     // 收集子cluster信息
     std::vector<BoundingSphere> lodBound;
@@ -502,7 +557,7 @@ void BuildParentClusters(
     std::vector<uint32_t> tempIndex;
     for(auto& clusterID : clusterGroup->clusters)
     {
-        auto& cluster = clusters[clusterID];
+        const auto& cluster = clusters[clusterID];
 
         lodBound.push_back(cluster->lodBound);
         parentLodError = std::max(parentLodError, cluster->lodError); //强制父节点的error大于等于子节点
@@ -527,7 +582,6 @@ void BuildParentClusters(
     MeshRef parentMesh = std::make_shared<Mesh>(*tempMesh.get(), tempIndex);
     MeshOptimizor::RemapMesh(tempMesh); 
     // 生成新cluster
-    std::vector<MeshClusterRef> parentClusters;
     ClusterTriangles(parentMesh, parentClusters);
 
     //强制父节点的lod包围盒覆盖所有子节点lod包围盒
@@ -540,6 +594,4 @@ void BuildParentClusters(
 
     clusterGroup->lodBound = parentLodBound;
     clusterGroup->parentLodError = parentLodError;
-
-    for (auto& cluster : parentClusters) clusters.push_back(cluster);
 }
@@ -3,6 +3,7 @@
 #include "Core/Mesh/Mesh.h"
 #include "Core/Serialize/Serializable.h"
 #include "Function/Global/Definations.h"
+#include "Platform/Thread/QueuedThreadPool.h"
 
 #include <memory>
 #include <vector>
@@ -74,17 +75,37 @@ private:
 };
 typedef std::shared_ptr<MeshClusterGroup> MeshClusterGroupRef;
 
+// ClusterTriangles的内部步骤，单独暴露出来方便测试
+class PartitionGraph;
+
+uint32_t Morton3D(Vec3 p);                                  // 30位莫顿码，要求 0<=x,y,z<=1
+
+void BuildEdgeGraph(                                        // 半边邻接图，完成后已调用PartitionGraph::Build
+    const std::shared_ptr<Mesh>& mesh,
+    PartitionGraph& edgeGraph);
+
+void BuildLocalityLinks(                                    // 需要在graph调用Build之前执行
+    const std::shared_ptr<Mesh>& mesh,
+    PartitionGraph& graph);
+
 void ClusterTriangles(
     const std::shared_ptr<Mesh>& mesh,
-    std::vector<MeshClusterRef>& clusters);
+    std::vector<MeshClusterRef>& clusters,
+    QueuedThreadPoolRef threadPool = nullptr);      // 提供线程池时图划分并行执行
 
 void GroupClusters(
     std::vector<MeshClusterRef>& clusters,
     uint32_t offset,
     uint32_t numCluster,
     std::vector<MeshClusterGroupRef>& clusterGroups,
-    uint32_t mipLevel);
+    uint32_t mipLevel,
+    QueuedThreadPoolRef threadPool = nullptr);
 
 void BuildParentClusters(
     MeshClusterGroupRef& clusterGroup,
-    std::vector<MeshClusterRef>& clusters);
\ No newline at end of file
+    std::vector<MeshClusterRef>& clusters);
+
+void BuildParentClusters(                           // 只读clusters，新生成的cluster写入parentClusters，不同group间可以并行调用
+    MeshClusterGroupRef& clusterGroup,
+    const std::vector<MeshClusterRef>& clusters,
+    std::vector<MeshClusterRef>& parentClusters);
\ No newline at end of file
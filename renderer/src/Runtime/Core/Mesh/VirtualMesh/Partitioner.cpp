@@ -4,6 +4,7 @@
 
 #include <assert.h>
 #include <algorithm>
+#include <atomic>
 
 struct MetisGraph 
 {
@@ -14,6 +15,12 @@ struct MetisGraph
     std::vector<idx_t> adjwgt;  //边权重
 };
 
+// 并行二分时兄弟子图会同时读写sortTo的不同元素，子图提取时也会读到其他范围的顶点（结果只用于判断不在本范围内）
+static inline uint32_t LoadRelaxed(const uint32_t& value)       { return std::atomic_ref<uint32_t>(const_cast<uint32_t&>(value)).load(std::memory_order_relaxed); }
+static inline void StoreRelaxed(uint32_t& value, uint32_t v)    { std::atomic_ref<uint32_t>(value).store(v, std::memory_order_relaxed); }
+
+static const uint32_t PARALLEL_BISECT_THRESHOLD = 1024;    //顶点数超过该值的子图才并行二分
+
 uint32_t PartitionGraph::Find(uint32_t x)
 {
     // Find root
@@ -111,86 +118,140 @@ uint32_t PartitionGraph::UnionSequential(uint32_t x, uint32_t y)
 }
 
 
-std::shared_ptr<MetisGraph> ConvertMetisGraph(const PartitionGraph& graph)
+void PartitionGraph::Build()
 {
-    std::shared_ptr<MetisGraph> metisGraph = std::make_shared<MetisGraph>();
-    metisGraph->nvtxs = graph.graph.size();
+    // 按起点计数排序
+    offsets.assign(numNodes + 1, 0);
+    for (auto& edge : edges) offsets[edge.from + 1]++;
+    for (uint32_t i = 0; i < numNodes; i++) offsets[i + 1] += offsets[i];
+
+    std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    adjacency.resize(edges.size());
+    weights.resize(edges.size());
+    for (auto& edge : edges)
+    {
+        uint32_t pos = cursor[edge.from]++;
+        adjacency[pos] = edge.to;
+        weights[pos] = edge.cost;
+    }
+    edges.clear();
+    edges.shrink_to_fit();
 
-    for (auto& edge : graph.graph)
+    // 每个顶点的邻接边按终点排序，合并重复边并原地压缩
+    std::vector<std::pair<uint32_t, int>> row;
+    uint32_t write = 0;
+    for (uint32_t i = 0; i < numNodes; i++)
     {
-        metisGraph->xadj.push_back(metisGraph->adjncy.size());
-        for (auto& pair : edge)
+        uint32_t begin = offsets[i];
+        uint32_t end = offsets[i + 1];
+
+        row.clear();
+        for (uint32_t j = begin; j < end; j++) row.push_back({ adjacency[j], weights[j] });
+        std::sort(row.begin(), row.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        offsets[i] = write;
+        for (uint32_t j = 0; j < row.size(); j++)
         {
-            metisGraph->adjncy.push_back(pair.first);
-            metisGraph->adjwgt.push_back(pair.second);
+            if (write > offsets[i] && adjacency[write - 1] == row[j].first) weights[write - 1] += row[j].second;
+            else 
+            {
+                adjacency[write] = row[j].first;
+                weights[write] = row[j].second;
+                write++;
+            }
         }
     }
-
-    metisGraph->xadj.push_back(metisGraph->adjncy.size());
-
-    return metisGraph;
+    offsets[numNodes] = write;
+    adjacency.resize(write);
+    weights.resize(write);
 }
 
 void Partitioner::Init(uint32_t num_node) 
 {
     nodeID.resize(num_node);
     sortTo.resize(num_node);
-    uint32_t i = 0;
+    ranges.clear();
 
     for (uint32_t i = 0; i < nodeID.size(); i++) nodeID[i] = i;
     for (uint32_t i = 0; i < sortTo.size(); i++) sortTo[i] = i;
 }
 
-void Partitioner::Partition(const PartitionGraph& graph, uint32_t minPartSize, uint32_t maxPartSize)
+void Partitioner::Partition(const PartitionGraph& graph, uint32_t minPartSize, uint32_t maxPartSize, QueuedThreadPoolRef threadPool)
 {
-    Init(graph.graph.size());
+    assert(graph.offsets.size() == graph.NumNodes() + 1);   //需要先调用PartitionGraph::Build
+
+    Init(graph.NumNodes());
     this->minPartSize = minPartSize;
     this->maxPartSize = maxPartSize;
+    this->graph = &graph;
+    this->threadPool = threadPool;
 
-    std::shared_ptr<MetisGraph> graphData = ConvertMetisGraph(graph);
-
-    RecursiveBisect(graphData, 0, graphData->nvtxs);
+    RecursiveBisect(0, graph.NumNodes(), ranges);     //二分过程中同步维护了sortTo[nodeID[i]] = i
 
     sort(this->ranges.begin(), this->ranges.end());
-    for (uint32_t i = 0; i < nodeID.size(); i++) 
-    {
-        sortTo[nodeID[i]] = i;
-    }
+
+    this->graph = nullptr;
+    this->threadPool = nullptr;
 }
 
-void Partitioner::RecursiveBisect(std::shared_ptr<MetisGraph> graphData, uint32_t start, uint32_t end) 
+void Partitioner::RecursiveBisect(uint32_t start, uint32_t end, std::vector<std::pair<uint32_t, uint32_t>>& outRanges) 
 {
-    std::shared_ptr<MetisGraph> childGraphs[2] = { nullptr, nullptr };
+    if (end - start <= maxPartSize)     //剩余待划分顶点数已不足最大单元数目，无需划分
+    {
+        outRanges.push_back({ start, end });
+        return;
+    }
 
-    uint32_t split = Bisect(graphData, childGraphs, start, end);
+    uint32_t split = Bisect(start, end);
 
-    if (childGraphs[0] && childGraphs[1])             //能够划分为两个，就继续递归
+    if (threadPool && end - start >= PARALLEL_BISECT_THRESHOLD)     //两个子图的顶点范围不相交，可以并行继续划分
     {
-        RecursiveBisect(childGraphs[0], start, split);
-        RecursiveBisect(childGraphs[1], split, end);
+        uint32_t bounds[3] = { start, split, end };
+        std::vector<std::pair<uint32_t, uint32_t>> childRanges[2];
+        threadPool->ParallelFor(2, [&](uint32_t i) {
+            RecursiveBisect(bounds[i], bounds[i + 1], childRanges[i]);
+        });
+        for (auto& child : childRanges) outRanges.insert(outRanges.end(), child.begin(), child.end());
     }
-    else {
-        assert(
-            childGraphs[0] == nullptr && 
-            childGraphs[1] == nullptr);                //无法继续划分，在当前位置结束
+    else 
+    {
+        RecursiveBisect(start, split, outRanges);
+        RecursiveBisect(split, end, outRanges);
     }
 }
 
-uint32_t Partitioner::Bisect(std::shared_ptr<MetisGraph> graphData, std::shared_ptr<MetisGraph> childGraphs[2], uint32_t start, uint32_t end)
+uint32_t Partitioner::Bisect(uint32_t start, uint32_t end)
 {
-    assert(end - start == graphData->nvtxs);
-
-    if (graphData->nvtxs <= maxPartSize) //剩余待划分顶点数已不足最大单元数目，无需划分
+    // 从原图中提取[start, end)范围的子图，复用线程本地的缓冲
+    // 子图顶点按nodeID顺序，邻接顶点保持原图中的顺序，和逐级复制子图得到的输入一致
+    thread_local MetisGraph graphData;
+    thread_local std::vector<idx_t> part;
+
+    graphData.nvtxs = end - start;
+    graphData.xadj.clear();
+    graphData.adjncy.clear();
+    graphData.adjwgt.clear();
+    for (uint32_t i = start; i < end; i++)
     {
-        ranges.push_back({ start,end });
-        return end;
+        uint32_t u = nodeID[i];
+
+        graphData.xadj.push_back(graphData.adjncy.size());
+        for (uint32_t j = graph->EdgeBegin(u); j < graph->EdgeEnd(u); j++) 
+        {
+            uint32_t v = LoadRelaxed(sortTo[graph->adjacency[j]]);
+            if (start <= v && v < end)                                  //邻接顶点不在本范围内的边被切掉
+            {
+                graphData.adjncy.push_back(v - start);
+                graphData.adjwgt.push_back(graph->weights[j]);
+            }
+        }
     }
+    graphData.xadj.push_back(graphData.adjncy.size());
 
-    std::vector<idx_t> part(graphData->nvtxs);
-    std::vector<idx_t> swapTo(graphData->nvtxs);
+    part.resize(graphData.nvtxs);
     {
         const uint32_t expPartSize = (minPartSize + maxPartSize) / 2;
-        const uint32_t expNumParts = std::max(2u, (graphData->nvtxs + expPartSize - 1) / expPartSize);
+        const uint32_t expNumParts = std::max(2u, (graphData.nvtxs + expPartSize - 1) / expPartSize);
         idx_t nw = 1;
         idx_t npart = 2;
         idx_t ncut = 0;
@@ -200,13 +261,13 @@ uint32_t Partitioner::Bisect(std::shared_ptr<MetisGraph> graphData, std::shared_
         };
 
         int res = METIS_PartGraphRecursive(
-            &graphData->nvtxs,                 //待划分目标（顶点）数
+            &graphData.nvtxs,                   //待划分目标（顶点）数
             &nw,                                //
-            graphData->xadj.data(),            //邻接边的偏移信息
-            graphData->adjncy.data(),          //邻接边数据
+            graphData.xadj.data(),              //邻接边的偏移信息
+            graphData.adjncy.data(),            //邻接边数据
             nullptr,                            //顶点权重
             nullptr,                            //顶点数目
-            graphData->adjwgt.data(),          //邻接边权重
+            graphData.adjwgt.data(),            //邻接边权重
             &npart,                             //划分数目
             part_weight,                        //划分权重
             nullptr,
@@ -217,63 +278,23 @@ uint32_t Partitioner::Bisect(std::shared_ptr<MetisGraph> graphData, std::shared_
         assert(res == METIS_OK);
     }
 
-    int left = 0, right = graphData->nvtxs - 1;
-    while (left <= right)                                               //快排，存映射
+    int left = 0, right = graphData.nvtxs - 1;
+    while (left <= right)                                               //快排，原地交换nodeID并维护反向映射
     {
-        while (left <= right && part[left] == 0)    swapTo[left] = left, left++;
-        while (left <= right && part[right] == 1)   swapTo[right] = right, right--;
+        while (left <= right && part[left] == 0)    left++;
+        while (left <= right && part[right] == 1)   right--;
         if (left < right) 
         {
-            std::swap(nodeID[start + left], nodeID[start + right]);   //
-            swapTo[left] = right, swapTo[right] = left;
+            std::swap(nodeID[start + left], nodeID[start + right]);
+            StoreRelaxed(sortTo[nodeID[start + left]], start + left);
+            StoreRelaxed(sortTo[nodeID[start + right]], start + right);
             left++, right--;
         }
     }
     int split = left;
 
-    int size[2] = { split, graphData->nvtxs - split };
+    int size[2] = { split, graphData.nvtxs - split };
     assert(size[0] >= 1 && size[1] >= 1);
 
-    if (size[0] <= maxPartSize && size[1] <= maxPartSize)   //两边都满足大小要求了，也无需继续划分
-    {
-        ranges.push_back({ start, start + split });
-        ranges.push_back({ start + split, end });
-    }
-    else 
-    {
-        for (uint32_t i = 0; i < 2; i++)                        //还可以划分，构建子图
-        {
-            childGraphs[i] = std::make_shared<MetisGraph>();
-            childGraphs[i]->nvtxs = size[i];
-            childGraphs[i]->adjncy.reserve(graphData->adjncy.size() >> 1);
-            childGraphs[i]->adjwgt.reserve(graphData->adjwgt.size() >> 1);
-            childGraphs[i]->xadj.reserve(size[i] + 1);
-        }
-        for (uint32_t i = 0; i < graphData->nvtxs; i++) 
-        {
-            uint32_t index = i >= childGraphs[0]->nvtxs ? 1 : 0;
-            uint32_t u = swapTo[i];
-
-            std::shared_ptr<MetisGraph> ch = childGraphs[index];
-
-            ch->xadj.push_back(ch->adjncy.size());
-            for (uint32_t j = graphData->xadj[u]; j < graphData->xadj[u + 1]; j++) 
-            {
-                idx_t v = graphData->adjncy[j];
-                idx_t w = graphData->adjwgt[j];
-                v = swapTo[v] - (index ? size[0] : 0); //邻接顶点要重新映射，如果是右侧还得减个左侧顶点数的偏移
-                if (0 <= v && v < size[index]) 
-                {
-                    ch->adjncy.push_back(v);
-                    ch->adjwgt.push_back(w);
-                }
-            }
-        }
-        childGraphs[0]->xadj.push_back(childGraphs[0]->adjncy.size());
-        childGraphs[1]->xadj.push_back(childGraphs[1]->adjncy.size());
-    }
     return start + split;
 }
-
-
-
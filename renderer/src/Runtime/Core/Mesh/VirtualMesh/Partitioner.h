@@ -1,34 +1,52 @@
 #pragma once
 
+#include "Platform/Thread/QueuedThreadPool.h"
+
 #include <vector>
 #include <map>
 #include <queue>
 #include <set>
 #include <memory>
 
-struct MetisGraph;
-
 class PartitionGraph //UE使用的FDisjointSet是并查集
 {
 public:
-    std::vector<std::map<uint32_t, int>> graph; //顶点 -> {顶点, 权重} 的映射表
+    // 压缩稀疏行(CSR)存储，顶点i的邻接边为[offsets[i], offsets[i + 1])，同一顶点的邻接顶点升序排列
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> adjacency;            //邻接顶点
+    std::vector<int> weights;                   //边权重
     std::vector<uint32_t> parents;              //并查集
 
-    inline void Init(uint32_t n)                                            { graph.resize(n);  for (int i = 0; i < n; i++) parents.push_back(parents.size()); }
-    inline void AddNode()                                                   { graph.push_back({}); parents.push_back(parents.size());}
-    inline void AddEdge(uint32_t from, uint32_t to, int cost)               { graph[from][to] = cost;   Union(from, to); }
-    inline void IncreaseEdgeCost(uint32_t from, uint32_t to, int cost)      { graph[from][to] += cost;  Union(from, to); }
+    inline void Init(uint32_t n)                                            { numNodes = n; edges.clear(); parents.clear(); for (int i = 0; i < n; i++) parents.push_back(parents.size()); }
+    inline void AddNode()                                                   { numNodes++; parents.push_back(parents.size()); }
+    inline void IncreaseEdgeCost(uint32_t from, uint32_t to, int cost)      { edges.push_back({ from, to, cost }); Union(from, to); }
+
+    void Build();                                                           //加边结束后调用，批量排序去重生成CSR，重复边的权重累加
+
+    inline uint32_t NumNodes() const                                        { return numNodes; }
+    inline uint32_t EdgeBegin(uint32_t node) const                          { return offsets[node]; }
+    inline uint32_t EdgeEnd(uint32_t node) const                            { return offsets[node + 1]; }
 
     uint32_t Find(uint32_t x);
     uint32_t Union(uint32_t x, uint32_t y);
     uint32_t UnionSequential(uint32_t x, uint32_t y);
+
+private:
+    struct Edge
+    {
+        uint32_t from;
+        uint32_t to;
+        int cost;
+    };
+    std::vector<Edge> edges;                    //构建阶段暂存的边，Build后清空
+    uint32_t numNodes = 0;
 };
 
 class Partitioner 
 { 
 public:
     void Init(uint32_t num_node);
-    void Partition(const PartitionGraph& graph, uint32_t minPartSize, uint32_t maxPartSize);
+    void Partition(const PartitionGraph& graph, uint32_t minPartSize, uint32_t maxPartSize, QueuedThreadPoolRef threadPool = nullptr);  //提供线程池时兄弟子图的二分并行执行
 
     std::vector<std::pair<uint32_t, uint32_t>> ranges;  //划分范围 [起始索引，结束索引]
     std::vector<uint32_t> nodeID;                      //节点映射，在划分范围内的为同一划分
@@ -37,8 +55,11 @@ public:
     uint32_t maxPartSize;                             //最大的单聚类节点数
 
 private:
-    void RecursiveBisect(std::shared_ptr<MetisGraph> graphData, uint32_t start, uint32_t end);
+    // 所有二分都直接在nodeID的[start, end)范围上原地进行，子图只在调用METIS前临时从原图中提取
+    void RecursiveBisect(uint32_t start, uint32_t end, std::vector<std::pair<uint32_t, uint32_t>>& outRanges);
 
-    uint32_t Bisect(std::shared_ptr<MetisGraph> graphData, std::shared_ptr<MetisGraph> childGraphs[2], uint32_t start, uint32_t end);
+    uint32_t Bisect(uint32_t start, uint32_t end);     //返回分割位置，[start, split)和[split, end)分别为两个子图
 
-};
\ No newline at end of file
+    const PartitionGraph* graph = nullptr;
+    QueuedThreadPoolRef threadPool;
+};
@@ -38,9 +38,9 @@ void LogGroupSize(std::vector<std::shared_ptr<MeshClusterGroup>>& groups, uint32
     LOG_DEBUG("groups size: max=%f, min=%f, avg=%f\n", maxsz, minsz, avgsz);
 }
 
-void VirtualMesh::Build(MeshRef mesh) 
+void VirtualMesh::Build(MeshRef mesh, QueuedThreadPoolRef threadPool) 
 {
-    ClusterTriangles(mesh, clusters);
+    ClusterTriangles(mesh, clusters, threadPool);
 
     uint32_t originTriangles = mesh->TriangleNum();
     uint32_t levelOffset = 0;  
@@ -89,14 +89,26 @@ void VirtualMesh::Build(MeshRef mesh)
                 levelOffset,
                 numLevelClusters,
                 clusterGroups,
-                mipLevel);
+                mipLevel,
+                threadPool);
         }
         
         //LogGroupSize(clusterGroups, prevGroupNum, clusterGroups.size());
 
-        for (uint32_t i = prevGroupNum; i < clusterGroups.size(); i++) 
+        // 同层的各group互相独立，只读本层及以下的cluster，新cluster先写入各自的数组，
+        // 再按group顺序追加，保证cluster下标和串行构建一致
+        uint32_t numLevelGroups = clusterGroups.size() - prevGroupNum;
+        std::vector<std::vector<MeshClusterRef>> parentClusters(numLevelGroups);
+        auto buildGroup = [&](uint32_t i) {
+            BuildParentClusters(clusterGroups[prevGroupNum + i], clusters, parentClusters[i]);
+        };
+
+        if(threadPool)  threadPool->ParallelFor(numLevelGroups, buildGroup);
+        else            for (uint32_t i = 0; i < numLevelGroups; i++) buildGroup(i);
+
+        for (auto& groupClusters : parentClusters)
         {
-            BuildParentClusters(clusterGroups[i], clusters);
+            clusters.insert(clusters.end(), groupClusters.begin(), groupClusters.end());
         }
 
         levelOffset = prevClusterNum;
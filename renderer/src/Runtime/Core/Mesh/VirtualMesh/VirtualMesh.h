@@ -2,6 +2,7 @@
 
 #include "Core/Serialize/Serializable.h"
 #include "MeshCluster.h"
+#include "Platform/Thread/QueuedThreadPool.h"
 
 #include <assert.h>
 
@@ -53,7 +54,7 @@ class Mesh;
 class VirtualMesh 
 {
 public:
-    void Build(MeshRef mesh);
+    void Build(MeshRef mesh, QueuedThreadPoolRef threadPool = nullptr);    // 提供线程池时同层的各group并行简化，结果与串行构建完全一致
 
     std::vector<std::shared_ptr<MeshCluster>> clusters;
     std::vector<std::shared_ptr<MeshClusterGroup>> clusterGroups;
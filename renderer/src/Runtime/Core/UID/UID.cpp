@@ -12,7 +12,7 @@ std::mt19937 Generator()
 
     return randomGenerator;
 }
-std::mt19937 UID::randomGenerator = Generator();
+thread_local std::mt19937 UID::randomGenerator = Generator();
 
 UID::UID()
 {
@@ -30,7 +30,7 @@ public:
 private:
     uuid id;
     std::string str;
-    static std::mt19937 randomGenerator;
+    static thread_local std::mt19937 randomGenerator;     // 资源在工作线程上反序列化时也会构造UID
 
     friend class std::hash<UID>;
 
@@ -2,7 +2,7 @@
 #include "Core/Log/log.h"
 #include <cstdint>
 
-IndexAlloctor::IndexAlloctor(uint32_t maxIndex) 
+IndexAlloctor::IndexAlloctor(uint32_t maxIndex)
 : maxIndex(maxIndex)
 , nextIndex(1)
 {}
@@ -14,23 +14,20 @@ uint32_t IndexAlloctor::Allocate()
 
 IndexRange IndexAlloctor::Allocate(uint32_t size)
 {
-    for(auto iter = unusedIndex.begin(); iter != unusedIndex.end(); iter++)
+    if(size == 0) return { 0, 0 };
+
+    auto iter = freeRangeBySize.lower_bound({ size, 0 });
+    if(iter != freeRangeBySize.end())
     {
-        if(iter->size > size)
-        {
-            iter->size -= size;
-            return { iter->begin + iter->size, size};
-        }
-        if(iter->size == size)
-        {
-            IndexRange range = *iter;
-            unusedIndex.erase(iter);
-            return range;
-        }
+        IndexRange range = { iter->second, iter->first };
+        EraseFreeRange(freeRangeByBegin.find(range.begin));
+
+        if(range.size > size) InsertFreeRange({ range.begin + size, range.size - size });   // 剩余部分放回，前后都是已分配的不会再合并
+        return { range.begin, size };
     }
 
-    if(nextIndex + size > maxIndex) LOG_FATAL("Index is greater than max index!");
-    
+    if((uint64_t)nextIndex + size > maxIndex) LOG_FATAL("Index is greater than max index!");
+
     IndexRange range = {nextIndex, size};
     nextIndex += size;
     return range;
@@ -43,21 +40,61 @@ void IndexAlloctor::Release(uint32_t index)
 
 void IndexAlloctor::Release(IndexRange range)
 {
+    if(range.size == 0) return;
+    if(range.begin == 0 || (uint64_t)range.begin + range.size > nextIndex) LOG_FATAL("Releasing index range [%d, %d) that was never allocated!", range.begin, range.begin + range.size);
+
+    InsertFreeRange(range);
+}
+
+IndexAlloctorStats IndexAlloctor::GetStats()
+{
+    IndexAlloctorStats stats;
+    stats.usedSize = nextIndex - 1 - freeSize;
+    stats.freeSize = freeSize;
+    stats.freeRangeCount = freeRangeByBegin.size();
+    stats.largestFreeRange = freeRangeBySize.empty() ? 0 : freeRangeBySize.rbegin()->first;
+    stats.nextIndex = nextIndex;
+    return stats;
+}
+
+void IndexAlloctor::InsertFreeRange(IndexRange range)
+{
+    uint32_t begin = range.begin;
     uint32_t end = range.begin + range.size;
 
-    for(auto iter = unusedIndex.begin(); iter != unusedIndex.end(); iter++)
+    auto next = freeRangeByBegin.lower_bound(begin);
+    if(next != freeRangeByBegin.end() && next->first < end) LOG_FATAL("Index range [%d, %d) is released twice!", begin, end);
+    if(next != freeRangeByBegin.begin())
     {
-        if(end < iter->begin) 
-        {
-            unusedIndex.insert(iter, range);
-            return;
-        }
-        if(end == iter->begin) 
+        auto prev = std::prev(next);
+        uint32_t prevEnd = prev->first + prev->second;
+        if(prevEnd > begin) LOG_FATAL("Index range [%d, %d) is released twice!", begin, end);
+        if(prevEnd == begin)                                                        // 和前一个合并
         {
-            iter->begin = range.begin;
-            return;
+            begin = prev->first;
+            EraseFreeRange(prev);
         }
-    }   
+    }
+    if(next != freeRangeByBegin.end() && next->first == end)                       // 和后一个合并
+    {
+        end += next->second;
+        EraseFreeRange(next);
+    }
 
-    unusedIndex.push_back(range);
+    if(end == nextIndex)                                                            // 和末尾未分配的部分合并
+    {
+        nextIndex = begin;
+        return;
+    }
+
+    freeRangeByBegin.emplace(begin, end - begin);
+    freeRangeBySize.emplace(end - begin, begin);
+    freeSize += end - begin;
+}
+
+void IndexAlloctor::EraseFreeRange(std::map<uint32_t, uint32_t>::iterator iter)
+{
+    freeSize -= iter->second;
+    freeRangeBySize.erase({ iter->second, iter->first });
+    freeRangeByBegin.erase(iter);
 }
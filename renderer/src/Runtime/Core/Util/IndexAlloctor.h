@@ -3,6 +3,9 @@
 #include "Core/Serialize/Serializable.h"
 #include <cstdint>
 #include <list>
+#include <map>
+#include <set>
+#include <utility>
 
 typedef struct IndexRange
 {
@@ -16,9 +19,21 @@ private:
     EndSerailize
 } IndexRange;
 
+typedef struct IndexAlloctorStats
+{
+    uint32_t usedSize = 0;          // 已分配出去的索引数
+    uint32_t freeSize = 0;          // 回收后空闲的索引数，不含末尾从未分配的部分
+    uint32_t freeRangeCount = 0;
+    uint32_t largestFreeRange = 0;
+    uint32_t nextIndex = 0;         // 末尾未分配部分的起点
+
+    float Fragmentation() const     { return freeSize == 0 ? 0.0f : 1.0f - (float)largestFreeRange / freeSize; }   // 0表示空闲索引全部连续
+} IndexAlloctorStats;
+
 // 工具类，用于分配映射关系，0为无效值
 // 写复杂了就是一个内存池
-class IndexAlloctor   
+// 空闲区间同时按起点和按大小各存一棵树，分配取最小的够用的区间（best fit），释放时和前后相邻区间合并，都是O(log n)
+class IndexAlloctor
 {
 public:
     IndexAlloctor(uint32_t maxIndex = UINT32_MAX);
@@ -29,17 +44,34 @@ public:
     void Release(IndexRange range);
 
     inline uint32_t GetSize() { return maxIndex; }
+    IndexAlloctorStats GetStats();
 
 private:
+    void InsertFreeRange(IndexRange range);
+    void EraseFreeRange(std::map<uint32_t, uint32_t>::iterator iter);
+
     uint32_t maxIndex;
     uint32_t nextIndex;
-     
-    std::list<IndexRange> unusedIndex;
+    uint32_t freeSize = 0;
+
+    std::map<uint32_t, uint32_t> freeRangeByBegin;              // begin -> size
+    std::set<std::pair<uint32_t, uint32_t>> freeRangeBySize;    // (size, begin)
 
 private:
+    // 序列化格式和原先的链表实现一致，读取后重建两棵树
     BeginSerailize()
+    std::list<IndexRange> unusedIndex;
+    IfSerailizeOutput()
+        for(auto& pair : freeRangeByBegin) unusedIndex.push_back({ pair.first, pair.second });
+    EndIfSerailize
     SerailizeEntry(maxIndex)
     SerailizeEntry(nextIndex)
     SerailizeEntry(unusedIndex)
+    IfSerailizeInput()
+        freeSize = 0;
+        freeRangeByBegin.clear();
+        freeRangeBySize.clear();
+        for(auto& range : unusedIndex) InsertFreeRange(range);
+    EndIfSerailize
     EndSerailize
-};
\ No newline at end of file
+};
@@ -0,0 +1,203 @@
+#include "Profiler.h"
+#include "Core/Log/Log.h"
+#include "Platform/HAL/PlatformProcess.h"
+#include "Platform/HAL/ScopeLock.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+thread_local ProfilerThreadBuffer* Profiler::threadBuffer = nullptr;
+
+Profiler::Profiler()
+{
+    sync = PlatformProcess::CreateMutex();
+}
+
+ProfilerThreadBuffer* Profiler::RegisterThread()
+{
+    ScopeLock lock(sync);
+    buffers.push_back(std::make_unique<ProfilerThreadBuffer>(PlatformProcess::GetThreadID()));
+    return buffers.back().get();
+}
+
+const char* Profiler::InternName(std::string_view prefix, std::string_view name)
+{
+    uint64_t hash = 14695981039346656037ull;   // FNV-1a
+    for(char c : prefix)    { hash ^= (uint8_t)c; hash *= 1099511628211ull; }
+    for(char c : name)      { hash ^= (uint8_t)c; hash *= 1099511628211ull; }
+
+    thread_local std::unordered_map<uint64_t, const char*> cache;
+    auto iter = cache.find(hash);
+    if(iter != cache.end())
+    {
+        std::string_view interned = iter->second;
+        if( interned.size() == prefix.size() + name.size() &&
+            interned.substr(0, prefix.size()) == prefix &&
+            interned.substr(prefix.size()) == name)
+            return iter->second;
+    }
+
+    std::string fullName;
+    fullName.reserve(prefix.size() + name.size());
+    fullName.append(prefix).append(name);
+
+    const std::shared_ptr<Profiler>& profiler = Get();
+    const char* interned;
+    {
+        ScopeLock lock(profiler->sync);
+        interned = profiler->names.insert(fullName).first->c_str();    // unordered_set的节点地址不随rehash改变
+    }
+    cache[hash] = interned;     // 哈希冲突时直接覆盖
+    return interned;
+}
+
+void Profiler::BeginFrame(uint32_t tick, uint32_t lag)
+{
+    markers[markerCount % PROFILER_MAX_FRAME_MARKERS] = { tick, Now() };
+    markerCount++;
+
+    if(tick < lag) return;
+    Collect(tick - lag, history);
+
+    if(captureFrameCount > 0)
+    {
+        captureFrames.push_back(history);
+        if(captureFrames.size() >= captureFrameCount)
+        {
+            if(WriteChromeTrace(capturePath, captureFrames)) LOG_DEBUG("Profiler capture of %d frames saved to %s", (uint32_t)captureFrames.size(), capturePath.c_str());
+            else                                             LOG_DEBUG("Profiler failed to write capture to %s", capturePath.c_str());
+
+            captureFrameCount = 0;
+            captureFrames.clear();
+        }
+    }
+}
+
+void Profiler::RequestCapture(uint32_t frameCount, const std::string& path)
+{
+    if(captureFrameCount > 0) return;   // 上一次抓取还没完成
+
+    captureFrameCount = std::clamp(frameCount, 1u, (uint32_t)PROFILER_MAX_CAPTURE_FRAMES);
+    capturePath = path;
+    captureFrames.clear();
+    captureFrames.reserve(captureFrameCount);
+}
+
+void Profiler::Collect(uint32_t tick, ProfilerFrame& frame)
+{
+    frame.tick = tick;
+    frame.marker = 0;
+    frame.begin = UINT64_MAX;
+    frame.end = 0;
+    for(auto& marker : markers)
+    {
+        if(marker.tick == tick && marker.time != 0) frame.marker = marker.time;
+    }
+
+    ScopeLock lock(sync);   // 只防止读取时有新线程注册
+    frame.threads.resize(buffers.size());
+    for(uint32_t i = 0; i < buffers.size(); i++)
+    {
+        ProfilerThreadBuffer* buffer = buffers[i].get();
+        ProfilerThreadEvents& threadEvents = frame.threads[i];
+        threadEvents.threadID = buffer->threadID;
+        threadEvents.events.clear();
+
+        // 事件在区间结束时写入，等待时帮忙执行其他帧的任务会让不同帧的事件交错，需要扫描整个区间
+        // 更旧的帧直接跳过，下次从第一个更新的帧的事件开始读
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = std::max(buffer->readCursor, head > PROFILER_EVENTS_PER_THREAD ? head - PROFILER_EVENTS_PER_THREAD : 0);
+        uint64_t cursor = head;
+        for(uint64_t index = first; index < head; index++)
+        {
+            ProfilerEvent event;
+            if(!buffer->Read(index, event)) continue;      // 读取期间写入线程绕了一圈，已被覆盖
+            if(event.tick > tick) cursor = std::min(cursor, index);
+            if(event.tick == tick) threadEvents.events.push_back(event);
+        }
+        buffer->readCursor = cursor;
+
+        for(auto& event : threadEvents.events)
+        {
+            frame.begin = std::min(frame.begin, event.begin);
+            frame.end = std::max(frame.end, event.end);
+        }
+    }
+    if(frame.begin > frame.end) frame.begin = frame.end = 0;
+}
+
+static void WriteJsonString(std::ofstream& out, const char* str)
+{
+    out << '"';
+    for(const char* c = str; *c != '\0'; c++)
+    {
+        if(*c == '"' || *c == '\\')         out << '\\' << *c;
+        else if((uint8_t)*c < 0x20)         out << ' ';
+        else                                out << *c;
+    }
+    out << '"';
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path, const std::vector<ProfilerFrame>& frames)
+{
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if(!out.is_open()) return false;
+
+    uint64_t base = UINT64_MAX;
+    for(auto& frame : frames)
+    {
+        if(frame.marker != 0)   base = std::min(base, frame.marker);
+        if(frame.end != 0)      base = std::min(base, frame.begin);
+    }
+    if(base == UINT64_MAX) base = 0;
+
+    char buffer[128];
+    auto timestamp = [&](uint64_t time) {
+        snprintf(buffer, sizeof(buffer), "%.3f", ToMicroSeconds(time - base));
+        return buffer;
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if(!first) out << ",\n";
+        first = false;
+    };
+
+    std::unordered_set<uint32_t> threads;
+    for(auto& frame : frames)
+    {
+        if(frame.marker != 0)
+        {
+            separator();
+            out << "{\"name\":\"Frame " << frame.tick << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":0,\"ts\":" << timestamp(frame.marker) << "}";
+        }
+
+        for(auto& thread : frame.threads)
+        {
+            if(thread.events.empty()) continue;
+            if(threads.insert(thread.threadID).second)
+            {
+                separator();
+                out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread.threadID
+                    << ",\"args\":{\"name\":\"Thread " << thread.threadID << "\"}}";
+            }
+
+            for(auto& event : thread.events)
+            {
+                separator();
+                out << "{\"name\":";
+                WriteJsonString(out, event.name ? event.name : "Unknown");
+                out << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread.threadID << ",\"ts\":" << timestamp(event.begin);
+                snprintf(buffer, sizeof(buffer), "%.3f", ToMicroSeconds(event.end - event.begin));
+                out << ",\"dur\":" << buffer << ",\"args\":{\"frame\":" << event.tick << "}}";
+            }
+        }
+    }
+    out << "\n]}\n";
+
+    return out.good();
+}
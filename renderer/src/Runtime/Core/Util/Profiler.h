@@ -0,0 +1,195 @@
+#pragma once
+
+#include "Platform/HAL/Mutex.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#define PROFILER_EVENTS_PER_THREAD 16384    // 每个线程环形缓冲的事件数，必须是2的幂
+#define PROFILER_MAX_FRAME_MARKERS 64
+#define PROFILER_MAX_CAPTURE_FRAMES 64
+
+// 一个计时区间，name必须是静态字符串或InternName返回的字符串
+typedef struct ProfilerEvent
+{
+    const char* name = nullptr;
+    uint64_t begin = 0;         // Profiler::Now()的时钟计数
+    uint64_t end = 0;
+    uint32_t tick = 0;          // 录制时线程所属的帧
+    uint32_t depth = 0;
+} ProfilerEvent;
+
+typedef struct ProfilerFrameMarker
+{
+    uint32_t tick = 0;
+    uint64_t time = 0;          // 主线程开始该帧的时间
+} ProfilerFrameMarker;
+
+// 环形缓冲中的一项，字段都是原子的，收集线程读取时写入线程可能正在覆盖
+// sequence在写入期间为0，写完后为事件序号加1，读取前后两次sequence一致才说明读到的是完整的事件
+typedef struct ProfilerEventSlot
+{
+    std::atomic<uint64_t> sequence = 0;
+    std::atomic<const char*> name = nullptr;
+    std::atomic<uint64_t> begin = 0;
+    std::atomic<uint64_t> end = 0;
+    std::atomic<uint32_t> tick = 0;
+    std::atomic<uint32_t> depth = 0;
+} ProfilerEventSlot;
+
+// 每个线程独占一个环形缓冲，只有所属线程写入，收集线程只读
+// 每一项按sequence单独发布，再release发布head；收集线程读到被覆盖的项时只丢弃该项
+class ProfilerThreadBuffer
+{
+public:
+    ProfilerThreadBuffer(uint32_t threadID) : threadID(threadID) {}
+
+    inline void Push(const ProfilerEvent& event)
+    {
+        uint64_t index = head.load(std::memory_order_relaxed);
+        ProfilerEventSlot& slot = events[index & (PROFILER_EVENTS_PER_THREAD - 1)];
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);            // 先让读取方看到写入中的标记，再改字段
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.begin.store(event.begin, std::memory_order_relaxed);
+        slot.end.store(event.end, std::memory_order_relaxed);
+        slot.tick.store(event.tick, std::memory_order_relaxed);
+        slot.depth.store(event.depth, std::memory_order_relaxed);
+        slot.sequence.store(index + 1, std::memory_order_release);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    inline bool Read(uint64_t index, ProfilerEvent& event) const        // 该项已被覆盖或正在写入时返回false
+    {
+        const ProfilerEventSlot& slot = events[index & (PROFILER_EVENTS_PER_THREAD - 1)];
+        if(slot.sequence.load(std::memory_order_acquire) != index + 1) return false;
+        event.name = slot.name.load(std::memory_order_relaxed);
+        event.begin = slot.begin.load(std::memory_order_relaxed);
+        event.end = slot.end.load(std::memory_order_relaxed);
+        event.tick = slot.tick.load(std::memory_order_relaxed);
+        event.depth = slot.depth.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == index + 1;
+    }
+
+private:
+    uint32_t threadID;
+    uint32_t depth = 0;
+    std::atomic<uint64_t> head = 0;     // 已写入的事件总数
+    uint64_t readCursor = 0;            // 收集线程下次开始读取的位置，之前的事件都属于已经收集过的帧
+    std::array<ProfilerEventSlot, PROFILER_EVENTS_PER_THREAD> events;
+
+    friend class Profiler;
+    friend class ProfilerScope;
+};
+
+typedef struct ProfilerThreadEvents
+{
+    uint32_t threadID = 0;
+    std::vector<ProfilerEvent> events;
+} ProfilerThreadEvents;
+
+// 收集完成的一帧，所有线程中tick相同的事件
+typedef struct ProfilerFrame
+{
+    uint32_t tick = 0;
+    uint64_t marker = 0;        // 帧标记的时间，没找到时为0
+    uint64_t begin = 0;
+    uint64_t end = 0;
+    std::vector<ProfilerThreadEvents> threads;
+} ProfilerFrame;
+
+// 无锁无分配的CPU计时，替代原先每个区间一个shared_ptr<TimeScope>，按线程ID加map的实现
+// 计时只写本线程的环形缓冲，主线程在每帧开始时按帧收集已经完成的帧，也可以连续抓取若干帧导出Chrome trace格式
+class Profiler
+{
+public:
+    static inline uint64_t Now()                { return std::chrono::steady_clock::now().time_since_epoch().count(); }
+    static inline double ToMicroSeconds(uint64_t ticks)
+    {
+        return (double)ticks * std::chrono::steady_clock::period::num * 1000000 / std::chrono::steady_clock::period::den;
+    }
+
+    static inline ProfilerThreadBuffer* ThreadBuffer()
+    {
+        if(threadBuffer == nullptr) threadBuffer = Get()->RegisterThread();
+        return threadBuffer;
+    }
+
+    // 运行时拼接的名字转成常驻的字符串，线程内缓存命中时不分配内存
+    static const char* InternName(std::string_view name)                            { return InternName("", name); }
+    static const char* InternName(std::string_view prefix, std::string_view name);
+
+    // 主线程每帧开始时调用，记录tick的帧标记，收集tick - lag帧的事件
+    // lag需要足够大，保证该帧各线程的任务都已经执行完
+    void BeginFrame(uint32_t tick, uint32_t lag);
+
+    void RequestCapture(uint32_t frameCount, const std::string& path);     // 从下一次收集开始连续抓取frameCount帧，完成后写入path
+    bool IsCapturing()                          { return captureFrameCount > 0; }
+    uint32_t CapturedFrames()                   { return captureFrames.size(); }
+
+    const ProfilerFrame& GetHistoryFrame()      { return history; }         // 最近收集的一帧
+
+    static bool WriteChromeTrace(const std::string& path, const std::vector<ProfilerFrame>& frames);   // chrome://tracing和Perfetto都能直接打开
+
+    static const std::shared_ptr<Profiler>& Get()
+    {
+        static std::shared_ptr<Profiler> profiler = std::make_shared<Profiler>();   // 工作线程也会首次调用，用局部静态变量保证初始化线程安全
+        return profiler;
+    }
+
+    Profiler();
+
+private:
+    ProfilerThreadBuffer* RegisterThread();
+    void Collect(uint32_t tick, ProfilerFrame& frame);
+
+    static thread_local ProfilerThreadBuffer* threadBuffer;
+
+    MutexRef sync;      // 只保护线程注册和名字表
+    std::vector<std::unique_ptr<ProfilerThreadBuffer>> buffers;
+    std::unordered_set<std::string> names;
+
+    std::array<ProfilerFrameMarker, PROFILER_MAX_FRAME_MARKERS> markers;
+    uint32_t markerCount = 0;
+
+    ProfilerFrame history;
+
+    uint32_t captureFrameCount = 0;
+    std::string capturePath;
+    std::vector<ProfilerFrame> captureFrames;
+};
+
+class ProfilerScope
+{
+public:
+    ProfilerScope(const char* name, uint32_t tick)
+    : name(name)
+    , tick(tick)
+    {
+        buffer = Profiler::ThreadBuffer();
+        depth = buffer->depth++;
+        begin = Profiler::Now();
+    }
+
+    ~ProfilerScope()
+    {
+        uint64_t end = Profiler::Now();
+        buffer->depth--;
+        buffer->Push({ name, begin, end, tick, depth });
+    }
+
+private:
+    ProfilerThreadBuffer* buffer;
+    const char* name;
+    uint64_t begin;
+    uint32_t tick;
+    uint32_t depth;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// LSD基数排序，每趟8位，输出按keys升序排列的下标，键相同的保持原有顺序
+// 所有键在某一趟的8位上都相同时跳过该趟，例如键都小于2^24时只需要排3趟；30位的莫顿码第24~29位落在最高字节，仍需排4趟
+// temp为排序用的临时下标数组，每帧调用时可以传入复用的数组避免分配
+template<typename KeyType>
+inline void RadixSort(const std::vector<KeyType>& keys, std::vector<uint32_t>& order, std::vector<uint32_t>& temp)
+{
+    static_assert(std::is_unsigned<KeyType>::value, "RadixSort only sorts unsigned keys");
+    const uint32_t numPasses = sizeof(KeyType);
+
+    uint32_t count = keys.size();
+    order.resize(count);
+    for (uint32_t i = 0; i < count; i++) order[i] = i;
+    if (count == 0) return;
+
+    uint32_t histogram[numPasses][256] = {};
+    for (KeyType key : keys)
+    {
+        for (uint32_t pass = 0; pass < numPasses; pass++) histogram[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+
+    temp.resize(count);
+    for (uint32_t pass = 0; pass < numPasses; pass++)
+    {
+        uint32_t shift = pass * 8;
+        uint32_t* bucket = histogram[pass];
+        if (bucket[(keys[0] >> shift) & 0xFF] == count) continue;
+
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t size = bucket[i];
+            bucket[i] = offset;
+            offset += size;
+        }
+
+        for (uint32_t index : order) temp[bucket[(keys[index] >> shift) & 0xFF]++] = index;
+        order.swap(temp);
+    }
+}
+
+inline void RadixSort32(const std::vector<uint32_t>& keys, std::vector<uint32_t>& order)
+{
+    std::vector<uint32_t> temp;
+    RadixSort(keys, order, temp);
+}
+
+inline void RadixSort64(const std::vector<uint64_t>& keys, std::vector<uint32_t>& order)
+{
+    std::vector<uint32_t> temp;
+    RadixSort(keys, order, temp);
+}
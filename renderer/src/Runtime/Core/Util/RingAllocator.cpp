@@ -0,0 +1,93 @@
+#include "RingAllocator.h"
+
+#include <algorithm>
+#include <cstdint>
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    if(alignment <= 1) return value;
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+RingAllocator::RingAllocator(uint64_t capacity)
+: capacity(capacity)
+{}
+
+uint64_t RingAllocator::Tail()
+{
+    return (head + capacity - usedSize) % capacity;
+}
+
+bool RingAllocator::Allocate(uint64_t size, uint64_t alignment, uint64_t& offset)
+{
+    if(size == 0 || size > capacity) return false;
+    if(usedSize == 0) head = 0;                 // 全部回收后从头开始，整个缓冲都是连续的
+    if(usedSize == capacity) return false;
+
+    uint64_t tail = Tail();
+    uint64_t aligned = AlignUp(head, alignment);
+    uint64_t begin;
+    if(usedSize != 0 && tail > head)            // 空闲部分只有[head, tail)
+    {
+        if(aligned + size > tail) return false;
+        begin = aligned;
+    }
+    else if(aligned + size <= capacity)         // 空闲部分为[head, capacity)和[0, tail)，先用后面的
+    {
+        begin = aligned;
+    }
+    else if(size <= tail)                       // 末尾放不下，跳过剩余部分回绕到0
+    {
+        begin = 0;
+    }
+    else return false;
+
+    uint64_t consumed = begin >= head ?
+                        begin + size - head :
+                        capacity - head + size;
+    usedSize += consumed;
+    pendingSize += consumed;
+    head = (begin + size) % capacity;
+    offset = begin;
+    return true;
+}
+
+void RingAllocator::FinishFrame(uint64_t frame)
+{
+    if(pendingSize == 0) return;
+
+    if(!frames.empty() && frames.back().frame == frame) frames.back().size += pendingSize;
+    else                                                frames.push_back({ frame, pendingSize });
+    pendingSize = 0;
+}
+
+void RingAllocator::Retire(uint64_t completedFrame)
+{
+    while(!frames.empty() && frames.front().frame <= completedFrame)
+    {
+        usedSize -= frames.front().size;
+        frames.pop_front();
+    }
+}
+
+uint64_t RingAllocator::LargestAllocation(uint64_t alignment)
+{
+    if(usedSize == 0)           return capacity;
+    if(usedSize == capacity)    return 0;
+
+    uint64_t tail = Tail();
+    uint64_t aligned = AlignUp(head, alignment);
+    if(tail > head) return aligned < tail ? tail - aligned : 0;
+    return std::max(aligned < capacity ? capacity - aligned : 0, tail);
+}
+
+RingAllocatorStats RingAllocator::GetStats()
+{
+    RingAllocatorStats stats;
+    stats.capacity = capacity;
+    stats.usedSize = usedSize;
+    stats.pendingSize = pendingSize;
+    stats.inFlightFrames = frames.size();
+    stats.head = head;
+    return stats;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+typedef struct RingAllocatorStats
+{
+    uint64_t capacity = 0;
+    uint64_t usedSize = 0;          // 尚未回收的字节数，包含对齐和回绕时跳过的部分
+    uint64_t pendingSize = 0;       // 本帧已分配，还未调用FinishFrame的部分
+    uint32_t inFlightFrames = 0;    // 已经提交还未回收的帧数
+    uint64_t head = 0;              // 下一次分配的起点
+
+} RingAllocatorStats;
+
+// 环形缓冲的子分配，只管理偏移量，不涉及实际内存，用于每帧上传的暂存缓冲
+// 分配总是从head向后连续推进，末尾放不下时跳到0重新开始，跳过的部分计入本帧占用一起回收
+// 每帧的分配在FinishFrame时打上帧号，GPU执行完该帧后调用Retire按提交顺序回收，不支持单独释放
+class RingAllocator
+{
+public:
+    RingAllocator(uint64_t capacity);
+
+    bool Allocate(uint64_t size, uint64_t alignment, uint64_t& offset);     // 空间不足时返回false，不修改状态
+    void FinishFrame(uint64_t frame);                                       // 帧号需要单调递增
+    void Retire(uint64_t completedFrame);                                   // 回收帧号不大于completedFrame的全部分配
+
+    uint64_t LargestAllocation(uint64_t alignment);                         // 当前能成功分配的最大尺寸
+    inline uint64_t GetCapacity()   { return capacity; }
+    RingAllocatorStats GetStats();
+
+private:
+    struct FrameRecord
+    {
+        uint64_t frame;
+        uint64_t size;
+    };
+
+    uint64_t Tail();
+
+    uint64_t capacity;
+    uint64_t head = 0;
+    uint64_t usedSize = 0;
+    uint64_t pendingSize = 0;
+    std::deque<FrameRecord> frames;
+};
@@ -48,53 +48,3 @@ float TimeScope::GetSeconds()
 {
     return (float)duration.count() / 1000000;
 }
-
-void TimeScopes::PushScope(std::string name)
-{
-    std::shared_ptr<TimeScope> newScope = std::make_shared<TimeScope>();
-    newScope->name = name;
-    newScope->depth = depth;
-    newScope->Begin();
-
-    scopes.push_back(newScope); 
-    runningScopes.push(newScope);
-
-    depth++;
-
-    if(scopes.size() == 1) begin = newScope->GetBeginTime();
-}
-
-void TimeScopes::PopScope()
-{
-    if(runningScopes.empty()) 
-    {
-        LOG_FATAL("Time scope popping is not valid!");
-        return;
-    }
-
-    auto scope = runningScopes.top();
-    runningScopes.pop();
-    scope->End();
-
-    depth--;
-
-    if(depth == 0) end = std::max(end, scope->GetEndTime());
-}
-
-void TimeScopes::Clear() 
-{ 
-    scopes.clear();
-    runningScopes = {};
-    depth = 0; 
-};
-
-bool TimeScopes::Valid() 
-{ 
-    return depth == 0;
-};
-
-const std::vector<std::shared_ptr<TimeScope>>& TimeScopes::GetScopes()
-{
-    if(depth != 0) LOG_FATAL("Time scope recording is not complete!");
-    return scopes;
-}
\ No newline at end of file
@@ -77,10 +77,16 @@ void CameraComponent::UpdateMatrix()
 	std::shared_ptr<TransformComponent> transformComponent = TryGetComponent<TransformComponent>();
 	if(transformComponent)
 	{
-		this->position = transformComponent->GetPosition();
-		this->front = transformComponent->Front();
-		this->up = transformComponent->Up();
-		this->right = transformComponent->Right();
+		// 相机在本帧OnUpdate中刚移动过，层级还未更新，用父物体缓存的世界矩阵乘当前的局部矩阵
+		Mat4 world = transformComponent->GetLocalMat();
+		std::shared_ptr<TransformComponent> fatherTransform = GetEntity()->TryGetComponentInParent<TransformComponent>();
+		if(fatherTransform) world = fatherTransform->GetModelMat() * world;
+
+		Mat3 axis = world.block<3,3>(0,0);		// 各列为带缩放的局部坐标轴
+		this->position = world.block<3,1>(0,3);
+		this->front = axis.col(0).normalized();
+		this->up = axis.col(1).normalized();
+		this->right = axis.col(2).normalized();
 	}
 
 	prevView = view;
@@ -42,6 +42,7 @@ public:
 
 	virtual std::string GetTypeName() override				{ return "Camera Component"; }
 	virtual ComponentType GetType()	override 				{ return CAMERA_COMPONENT; }
+	static ComponentType StaticType()			{ return CAMERA_COMPONENT; }
 
 	void UpdateCameraInfo();
 
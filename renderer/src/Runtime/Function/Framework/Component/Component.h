@@ -38,7 +38,7 @@ public:
 	inline bool Inited() 						{ return init; }
 
 	virtual std::string GetTypeName()			{ return "Undefined"; }
-	virtual ComponentType GetType()				{ return UNDEFINED_COMPONENT; }
+	virtual ComponentType GetType()				{ return UNDEFINED_COMPONENT; }	// 子类同时提供static ComponentType StaticType()，模板中按类型查找时不需要dynamic_cast
 	inline std::shared_ptr<Entity> GetEntity()	{ return entity.lock(); }
 
 	template<typename TComponent>
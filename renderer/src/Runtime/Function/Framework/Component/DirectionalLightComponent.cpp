@@ -156,7 +156,7 @@ void DirectionalLightComponent::UpdateCascades()
 			lightInfos[i].view = lightViewMatrix;
 			lightInfos[i].proj = lightOrthoMatrix;
 			lightInfos[i].viewProj = lightOrthoMatrix * lightViewMatrix;
-			lightInfos[i].pos = TryGetComponent<TransformComponent>()->GetPosition();
+			lightInfos[i].pos = TryGetComponent<TransformComponent>()->GetWorldPosition();
 			lightInfos[i].color = color;
             lightInfos[i].intencity = intencity;
             lightInfos[i].fogScattering = fogScattering;
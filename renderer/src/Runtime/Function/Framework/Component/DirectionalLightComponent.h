@@ -23,6 +23,7 @@ public:
 
 	virtual std::string GetTypeName() override						{ return "Directional Light Component"; }
 	virtual ComponentType GetType() override						{ return DIRECTIONAL_LIGHT_COMPONENT; }
+	static ComponentType StaticType()			{ return DIRECTIONAL_LIGHT_COMPONENT; }
 
 	bool ShouldUpdate(uint32_t cascade)								{ return updateCnts[cascade] == 0; }
 	float GetConstantBias()											{ return constantBias; }
@@ -15,6 +15,8 @@ CEREAL_REGISTER_POLYMORPHIC_RELATION(Component, MeshRendererComponent)
 
 MeshRendererComponent::~MeshRendererComponent()
 {
+    UnregisterDrawable();
+
     if(!EngineContext::Destroyed()) 
     {
         for(auto& objectID : objectIDs) EngineContext::RenderResource()->ReleaseObjectID(objectID); 
@@ -48,19 +50,17 @@ void MeshRendererComponent::OnSave()
 
 void MeshRendererComponent::InitResource()
 {
-    updateTicks = -1;
+    MarkDrawableDirty(DRAWABLE_DIRTY_ALL);
 
     for(auto& objectID : objectIDs) EngineContext::RenderResource()->ReleaseObjectID(objectID); 
     objectIDs.clear();
     objectInfos.clear();
-    currentModels.clear();
-    prevModels.clear();
+    submeshInvTransforms.clear();
     if(model)
     {   
         uint32_t submeshCount = model->GetSubmeshCount();
         materials.resize(submeshCount);
-        currentModels.resize(submeshCount);
-        prevModels.resize(submeshCount);
+        submeshInvTransforms.resize(submeshCount);
         objectInfos.resize(submeshCount);  
         while(objectIDs.size() < submeshCount)
         {
@@ -75,7 +75,12 @@ void MeshRendererComponent::InitResource()
             localScale.y() = model->Submesh(i).scale.y();
             localScale.z() = model->Submesh(i).scale.z();
 
+            submeshInvTransforms[i] = Math::AffineInverse(model->Submesh(i).transform);
+
             objectInfos[i] = {
+                .model = Mat4::Identity(),
+                .prevModel = Mat4::Identity(),
+                .invModel = Mat4::Identity(),
                 .animationID = 0,
                 .materialID = materials[i] ? materials[i]->GetMaterialID() : 0,
                 .vertexID = model->Submesh(i).vertexBuffer->vertexID,
@@ -93,6 +98,7 @@ void MeshRendererComponent::InitResource()
 void MeshRendererComponent::OnInit()
 {
     Component::OnInit();
+    RegisterDrawable(this);
     InitResource();
 }
 
@@ -114,6 +120,7 @@ void MeshRendererComponent::SetMaterial(MaterialRef material, uint32_t index)
         this->materials.resize(index + 1);
     }
     materials[index] = material;
+    MarkDrawableDirty(DRAWABLE_DIRTY_MATERIAL);
 }
 
 void MeshRendererComponent::SetMaterials(std::vector<MaterialRef> materials, uint32_t firstIndex)
@@ -127,6 +134,7 @@ void MeshRendererComponent::SetMaterials(std::vector<MaterialRef> materials, uin
         uint32_t index = i + firstIndex;
         this->materials[index] = materials[i];
     }
+    MarkDrawableDirty(DRAWABLE_DIRTY_MATERIAL);
 }
 
 MaterialRef MeshRendererComponent::GetMaterial(uint32_t index)
@@ -137,6 +145,8 @@ MaterialRef MeshRendererComponent::GetMaterial(uint32_t index)
 
 void MeshRendererComponent::CollectDrawBatch(std::vector<DrawBatch>& batches)
 {
+    if(!model) return;
+
     for(uint32_t i = 0; i < model->GetSubmeshCount(); i++)
     {   
         auto& submesh = model->Submesh(i);
@@ -152,43 +162,56 @@ void MeshRendererComponent::CollectDrawBatch(std::vector<DrawBatch>& batches)
                 materials[i]);
         }
     }
+}
 
-    // 此处涉及提交物体数据，需要等待帧栅栏////////////////////////////////////////////
-    // TODO 换个位置写
-    std::shared_ptr<TransformComponent> transformComponent = TryGetComponent<TransformComponent>();
-    if(!transformComponent) return;
-
-    Mat4 transform = transformComponent->GetModelMat();
-    Vec3 scale = transformComponent->GetScale();
-    bool update = (transform != prevModel) || (scale != prevScale) || (updateTicks == -1);
+uint32_t MeshRendererComponent::ObjectInfoSize()
+{
+    return (model && !objectIDs.empty()) ? model->GetSubmeshCount() : 0;
+}
 
-    Vec4 modelScale = Vec4::Ones();
-    modelScale.x() = scale.x();
-    modelScale.y() = scale.y();
-    modelScale.z() = scale.z();
+void MeshRendererComponent::CollectObjectInfos(ObjectInfoBatch::Range& range, bool recompute)
+{
+    // 由RenderMeshManager在标脏后的几帧内并行调用，矩阵的计算和写入当前帧物体缓冲都在batch里并行完成
+    if(!model || objectIDs.empty()) return;
 
-    if(update)
-        updateTicks = 0;
-    if(updateTicks <= FRAMES_IN_FLIGHT)
+    if(recompute)
     {
+        std::shared_ptr<TransformComponent> transformComponent = TryGetComponent<TransformComponent>();
+        if(!transformComponent) return;
+
+        Vec3 scale = transformComponent->GetWorldScale();
+
+        Vec4 modelScale = Vec4::Ones();
+        modelScale.x() = scale.x();
+        modelScale.y() = scale.y();
+        modelScale.z() = scale.z();
+
         for(uint32_t i = 0; i < model->GetSubmeshCount(); i++)  // 逐子物体更新物体信息
         {
-            currentModels[i] = transform * model->Submesh(i).transform;  // 很慢
-            objectInfos[i].model = currentModels[i];  // 矩阵乘法慢？
-            objectInfos[i].invModel = currentModels[i].inverse();
-            //objectInfos[i].invModel = transformComponent->GetModelMatInv();
-            objectInfos[i].prevModel = prevModels[i];
             objectInfos[i].modelScale = modelScale;
+            objectInfos[i].materialID = materials[i] ? materials[i]->GetMaterialID() : 0;
 
-            prevModels[i] = currentModels[i];  
+            range.Add(&objectInfos[i], objectIDs[i], transformComponent->GetModelMat(), transformComponent->GetModelMatInv(), model->Submesh(i).transform, submeshInvTransforms[i]);
         }
-
-        EngineContext::RenderResource()->SetObjectInfos(objectInfos, objectIDs[0]);
-        updateTicks++; 
+        return;
     }
 
-    prevModel = transform;
-    prevScale = scale;
+    for(uint32_t i = 0; i < model->GetSubmeshCount(); i++) range.Add(&objectInfos[i], objectIDs[i]);
+}
+
+bool MeshRendererComponent::GetWorldBounds(BoundingBox& box)
+{
+    if(!model || model->GetSubmeshCount() == 0) return false;
+
+    box.minBound = Vec3::Constant(std::numeric_limits<float>::max());
+    box.maxBound = Vec3::Constant(std::numeric_limits<float>::lowest());
+    for(uint32_t i = 0; i < model->GetSubmeshCount(); i++)  // 全部子物体的世界空间包围盒
+    {
+        BoundingBox submeshBox = BoundingBoxTransform(model->Submesh(i).mesh->box, objectInfos[i].model);     // 和GPU剔除使用的包围盒一致
+        box.minBound = box.minBound.cwiseMin(submeshBox.minBound);
+        box.maxBound = box.maxBound.cwiseMax(submeshBox.maxBound);
+    }
+    return true;
 }
 
 void MeshRendererComponent::CollectAccelerationStructureInstance(std::vector<RHIAccelerationStructureInstanceInfo>& instances)
@@ -207,7 +230,7 @@ void MeshRendererComponent::CollectAccelerationStructureInstance(std::vector<RHI
             info.mask = 0xFF;
             info.shaderBindingTableOffset = 0;
             info.blas = submesh.blas;
-            Math::Mat3x4(currentModels[i], &info.transform[0][0]);   
+            Math::Mat3x4(objectInfos[i].model, &info.transform[0][0]);   
 
             instances.push_back(info);
         }
@@ -234,7 +257,7 @@ void MeshRendererComponent::CollectSurfaceCacheTask(std::vector<SurfaceCacheTask
                 meshCardIDs[i],
                 objectIDs[i], 
                 materials[i]->GetMaterialID(),
-                transformComponent->GetScale().array() * submesh.scale.array(),
+                transformComponent->GetWorldScale().array() * submesh.scale.array(),
                 Vec3(pos.x(), pos.y(), pos.z()),
                 submesh.mesh->box,
                 submesh.mesh->sphere,
@@ -35,6 +35,7 @@ public:
 
 	virtual std::string GetTypeName() override		{ return "Mesh Renderer Component"; }
 	virtual ComponentType GetType() override	    { return MESH_RENDERER_COMPONENT; }
+	static ComponentType StaticType()			{ return MESH_RENDERER_COMPONENT; }
 
 	void SetModel(ModelRef model); 					
 	ModelRef GetModel()								{ return model; }
@@ -44,23 +45,21 @@ public:
 	MaterialRef GetMaterial(uint32_t index);			
 
 	virtual void CollectDrawBatch(std::vector<DrawBatch>& batches) override;
+	virtual uint32_t ObjectInfoSize() override;
+	virtual void CollectObjectInfos(ObjectInfoBatch::Range& range, bool recompute) override;
+	virtual bool GetWorldBounds(BoundingBox& box) override;
 	virtual void CollectAccelerationStructureInstance(std::vector<RHIAccelerationStructureInstanceInfo>& instances) override;
 	virtual void CollectSurfaceCacheTask(std::vector<SurfaceCacheTask>& tasks) override;
 
 private:
 	void InitResource();
-	int updateTicks = 0;	//GPU端数据已经更新的帧数，需要至少更新FRAMES_IN_FLIGHT次
 	ModelRef model;
     std::vector<MaterialRef> materials;
 	std::vector<ObjectInfo> objectInfos;
 	std::vector<uint32_t> objectIDs;
 	std::vector<uint32_t> meshCardIDs;
 
-	// 矩阵计算的用时很高，尽量缓存
-	Mat4 prevModel = Mat4::Identity();
-	Vec3 prevScale = Vec3::Ones();
-	std::vector<Mat4> currentModels;
-	std::vector<Mat4> prevModels;
+	std::vector<Mat4> submeshInvTransforms;		// 子网格变换的逆，只在设置模型时计算一次；model矩阵由ObjectInfoBatch批量计算后写回objectInfos
 
 	bool castShadow;					//是否产生阴影（加入shadow map render pass）
 	MeshRendererMode renderMode;		//渲染模式
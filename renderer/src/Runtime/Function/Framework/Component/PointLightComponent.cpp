@@ -36,7 +36,7 @@ void PointLightComponent::UpdateLightInfo()
         if(transform)
         {
             //更新包围信息
-            pos = transform->GetPosition();
+            pos = transform->GetWorldPosition();
 
             //box = BoundingBox(pos - Vec3::Constant(far), pos + Vec3::Constant(far));
             sphere = BoundingSphere(pos, far);
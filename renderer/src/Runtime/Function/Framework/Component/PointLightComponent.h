@@ -26,6 +26,7 @@ public:
 
     virtual std::string GetTypeName() override		{ return "Point Light Component"; }
 	virtual ComponentType GetType() override	    { return POINT_LIGHT_COMPONENT; }
+	static ComponentType StaticType()			{ return POINT_LIGHT_COMPONENT; }
 
 	inline BoundingSphere GetBoundingSphere() const	{ return sphere; }
     float GetConstantBias()						    { return constantBias; }
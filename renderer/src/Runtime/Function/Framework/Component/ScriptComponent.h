@@ -19,6 +19,7 @@ public:
 
     virtual std::string GetTypeName() override		{ return "Script Component"; }
 	virtual ComponentType GetType() override	    { return SCRIPT_COMPONENT; }
+	static ComponentType StaticType()			{ return SCRIPT_COMPONENT; }
 
     void ScriptOnUpdate(ScriptFunction func)        { onUpdate = func; }
 
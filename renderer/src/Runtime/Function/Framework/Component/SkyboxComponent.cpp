@@ -48,6 +48,8 @@ SkyboxComponent::SkyboxComponent()
 
 SkyboxComponent::~SkyboxComponent()
 {
+    UnregisterDrawable();
+
     if(!EngineContext::Destroyed() && objectID != 0) 
     {
         EngineContext::RenderResource()->ReleaseObjectID(objectID); 
@@ -71,6 +73,7 @@ void SkyboxComponent::OnSave()
 void SkyboxComponent::OnInit()
 {
     Component::OnInit();
+    RegisterDrawable(this);
 
     if(skyboxTexture) material->SetTextureCube(skyboxTexture, 0);
 }
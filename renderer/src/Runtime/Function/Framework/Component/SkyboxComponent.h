@@ -24,6 +24,7 @@ public:
 
     virtual std::string GetTypeName() override		{ return "Skybox Component"; }
 	virtual ComponentType GetType() override	    { return SKYBOX_COMPONENT; }
+	static ComponentType StaticType()			{ return SKYBOX_COMPONENT; }
 
     void SetIntencity(float intencity)              { this->intencity = intencity; };  
     void SetSkyboxTexture(TextureRef texture);     
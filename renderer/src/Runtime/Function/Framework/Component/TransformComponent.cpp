@@ -1,7 +1,8 @@
 
 #include "TransformComponent.h"
 #include "Component.h"
-#include "Function/Global/EngineContext.h"
+#include "Function/Framework/Entity/Entity.h"
+#include "Function/Framework/Scene/Scene.h"
 #include "TryGetComponent.h"
 
 CEREAL_REGISTER_TYPE(TransformComponent)
@@ -11,27 +12,32 @@ void TransformComponent::OnInit()
 {
     Component::OnInit();
 
-	UpdateMatrix();
+	MarkDirty();
 }
 
 void TransformComponent::OnUpdate(float deltaTime)
 {
     InitComponentIfNeed();
-
-    UpdateMatrix();
 }
 
-void TransformComponent::UpdateMatrix()
+void TransformComponent::SetWorldTransform(Mat4 mat)
 {
-//     std::shared_ptr<TransformComponent> fatherTransform = TryGetComponentInParent<TransformComponent>();
-//     if(fatherTransform)
-//     {
-//         // TODO 
-//     }
-
-//     //这里的矩阵计算顺序需要和ImGuizmo库一致，不然会有跳变
-//     model = transform.GetMatrix();
-// 
+	std::shared_ptr<TransformComponent> fatherTransform = TryGetComponentInParent<TransformComponent>();
+	if(fatherTransform) mat = fatherTransform->GetModelMatInv() * mat;
+
+	transform = Transform(mat);
+	MarkDirty();
 }
 
+void TransformComponent::MarkDirty()
+{
+	if(worldDirty) return;		// 已经在等待更新，子孙会在更新时一并处理
 
+	std::shared_ptr<Entity> entity = GetEntity();
+	if(!entity) return;
+	std::shared_ptr<Scene> scene = entity->GetScene();
+	if(!scene) return;
+
+	worldDirty = true;
+	scene->MarkTransformDirty(entity);
+}
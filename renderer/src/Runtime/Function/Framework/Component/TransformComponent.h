@@ -13,14 +13,15 @@ public:
 	virtual void OnInit() override;
 	virtual void OnUpdate(float deltaTime) override;
 
-	inline void SetTransform(Mat4 mat) 					{ transform = Transform(mat); }
-	inline void SetPosition(Vec3 position) 				{ transform.SetPosition(position); }
-	inline void SetScale(Vec3 scale) 					{ transform.SetScale(scale); }
-	inline void SetRotation(Quaternion rotation) 		{ transform.SetRotation(rotation); }
-	inline void SetRotation(Vec3 angle) 				{ transform.SetRotation(angle); }
-    Vec3 Translate(Vec3 translation)        			{ return transform.Translate(translation); }	// TODO 相对操作
-    Vec3 Scale(Vec3 scale)                  			{ return transform.Scale(scale); }
-    Vec3 Rotate(Vec3 angle)                 			{ return transform.Rotate(angle); }
+	inline void SetTransform(Mat4 mat) 					{ transform = Transform(mat); 			MarkDirty(); }	// 局部变换
+	void SetWorldTransform(Mat4 mat);													// 按父物体的世界矩阵换算成局部变换
+	inline void SetPosition(Vec3 position) 				{ transform.SetPosition(position); 		MarkDirty(); }
+	inline void SetScale(Vec3 scale) 					{ transform.SetScale(scale); 			MarkDirty(); }
+	inline void SetRotation(Quaternion rotation) 		{ transform.SetRotation(rotation); 		MarkDirty(); }
+	inline void SetRotation(Vec3 angle) 				{ transform.SetRotation(angle); 		MarkDirty(); }
+    Vec3 Translate(Vec3 translation)        			{ MarkDirty(); return transform.Translate(translation); }	// TODO 相对操作
+    Vec3 Scale(Vec3 scale)                  			{ MarkDirty(); return transform.Scale(scale); }
+    Vec3 Rotate(Vec3 angle)                 			{ MarkDirty(); return transform.Rotate(angle); }
 
 	inline Vec3 Front() const							{ return transform.Front(); }
     inline Vec3 Up() const                  			{ return transform.Up(); }
@@ -31,16 +32,28 @@ public:
 	inline Quaternion GetRotation() const   			{ return transform.GetRotation(); }
 	inline Vec3 GetEulerAngle() const					{ return transform.GetEulerAngle(); }
 
-	Mat4 GetModelMat()									{ return transform.GetMatrix(); }
-	Mat4 GetModelMatInv()								{ return transform.GetMatrix().inverse(); }
+	// 世界矩阵由场景的TransformHierarchy在变换修改后统一更新并缓存，静态物体不会重新计算
+	inline const Mat4& GetModelMat() const				{ return worldMatrix; }
+	inline const Mat4& GetModelMatInv() const			{ return worldMatrixInv; }
+	inline Mat4 GetLocalMat() const						{ return transform.GetMatrix(); }
+	inline Vec3 GetWorldPosition() const				{ return worldMatrix.block<3,1>(0,3); }
+	inline Vec3 GetWorldScale() const					{ return Math::GetScale(worldMatrix); }
+	inline const Transform& GetTransform() const		{ return transform; }
+
+	void MarkDirty();		// 本物体及其子孙的世界矩阵需要重新计算，修改变换或父子关系后调用
 
 	virtual std::string GetTypeName() override			{ return "Transform Component"; }
 	virtual ComponentType GetType()	override final		{ return TRANSFORM_COMPONENT; }
+	static ComponentType StaticType()			{ return TRANSFORM_COMPONENT; }
 
 private:
     Transform transform;
 
-	void UpdateMatrix();
+	Mat4 worldMatrix = Mat4::Identity();		// 运行时缓存，不做序列化
+	Mat4 worldMatrixInv = Mat4::Identity();
+	bool worldDirty = false;					// 已记录到场景的TransformHierarchy，等待更新
+
+	friend class TransformHierarchy;
 
 private:
     BeginSerailize()
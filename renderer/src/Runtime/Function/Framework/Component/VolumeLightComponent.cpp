@@ -56,7 +56,7 @@ void VolumeLightComponent::UpdateLightInfo()
         Vec3 extent = { (probeCounts.x() - 1) * gridStep.x(),
                         (probeCounts.y() - 1) * gridStep.y(),
                         (probeCounts.z() - 1) * gridStep.z()};
-		box = BoundingBox(transformComponent->GetPosition() - extent / 2.0f, transformComponent->GetPosition() + extent / 2.0f);
+		box = BoundingBox(transformComponent->GetWorldPosition() - extent / 2.0f, transformComponent->GetWorldPosition() + extent / 2.0f);
 	}
 
 	//更新DDGI信息
@@ -51,6 +51,7 @@ public:
 
     virtual std::string GetTypeName() override		{ return "Volume Light Component"; }
 	virtual ComponentType GetType() override	    { return VOLUME_LIGHT_COMPONENT; }
+	static ComponentType StaticType()			{ return VOLUME_LIGHT_COMPONENT; }
 
 private:
     uint32_t volumeLightID = 0;
@@ -1,6 +1,8 @@
 
 #include "Entity.h"
 #include "Core/Log/log.h"
+#include "Function/Framework/Component/TransformComponent.h"
+#include "Function/Framework/Scene/Scene.h"
 
 #include <memory>
 
@@ -37,6 +39,12 @@ void Entity::AddComponent(std::shared_ptr<Component> component)
     }
     components.push_back(component);
     component->entity = weak_from_this();
+    SyncComponent(component->GetType());
+}
+
+void Entity::SyncComponent(ComponentType type)
+{
+    if(std::shared_ptr<Scene> scene = this->scene.lock()) scene->SyncComponent(this, type);
 }
 
 void Entity::SetFather(std::weak_ptr<Entity> father)
@@ -51,12 +59,12 @@ void Entity::SetFather(std::weak_ptr<Entity> father)
     {
         newFather->children.push_back(shared_from_this());
     }
+    MarkTransformDirty();
 }
 
 void Entity::AddChild(std::shared_ptr<Entity> child)
 {
-    children.push_back(child);
-    child->SetFather(weak_from_this());
+    child->SetFather(weak_from_this());     // SetFather里加入children
 }
 
 bool Entity::RemoveChild(std::shared_ptr<Entity> child)
@@ -67,9 +75,16 @@ bool Entity::RemoveChild(std::shared_ptr<Entity> child)
         if (myChild.get() == child.get()) 
         {
             myChild->father = std::weak_ptr<Entity>();
+            myChild->MarkTransformDirty();
             children.erase(children.begin() + i);
             return true;
         }
     }
     return false;
 }
+
+void Entity::MarkTransformDirty()
+{
+    if(std::shared_ptr<TransformComponent> transform = TryGetComponent<TransformComponent>()) transform->MarkDirty();
+    else for(auto& child : children) child->MarkTransformDirty();     // 没有变换组件时标记各个子物体
+}
@@ -22,8 +22,15 @@ public:
     {
         for (auto& component : components)
         {
-            std::shared_ptr<TComponent> cast = std::dynamic_pointer_cast<TComponent>(component);
-            if(cast != nullptr) return cast;
+            if constexpr (requires { TComponent::StaticType(); })   // 具体组件类型直接比较GetType()
+            {
+                if(component && component->GetType() == TComponent::StaticType()) return std::static_pointer_cast<TComponent>(component);
+            }
+            else 
+            {
+                std::shared_ptr<TComponent> cast = std::dynamic_pointer_cast<TComponent>(component);
+                if(cast != nullptr) return cast;
+            }
         }
         return nullptr;
     }
@@ -50,10 +57,14 @@ public:
         {
             auto& component = components.at(i);
 
-            std::shared_ptr<TComponent> cast = std::dynamic_pointer_cast<TComponent>(component);
-            if(cast != nullptr) 
+            bool match;
+            if constexpr (requires { TComponent::StaticType(); })   match = component && component->GetType() == TComponent::StaticType();
+            else                                                    match = std::dynamic_pointer_cast<TComponent>(component) != nullptr;
+            if(match) 
             {
+                ComponentType type = component->GetType();
                 components.erase(components.begin() + i);
+                SyncComponent(type);
                 return true;
             }
         }
@@ -85,6 +96,9 @@ public:
     inline std::shared_ptr<Scene> GetScene()                          { return scene.lock(); }
     
 private:
+    void SyncComponent(ComponentType type);     // 同步到所属场景的组件表
+    void MarkTransformDirty();                  // 父子关系变化后重新计算世界矩阵
+
     uint32_t id = 0;    // 运行时分配，不做序列化
     std::string name = "";
     std::vector<std::shared_ptr<Component>> components;
@@ -104,4 +118,5 @@ private:
     EndSerailize 
 
     friend class Scene; // 由Scene负责创建Entity 
+    friend class TransformHierarchy;
 };
\ No newline at end of file
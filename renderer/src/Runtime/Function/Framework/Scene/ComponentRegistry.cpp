@@ -0,0 +1,95 @@
+#include "ComponentRegistry.h"
+#include "Function/Framework/Component/CameraComponent.h"
+#include "Function/Framework/Component/DirectionalLightComponent.h"
+#include "Function/Framework/Component/MeshRendererComponent.h"
+#include "Function/Framework/Component/PointLightComponent.h"
+#include "Function/Framework/Component/ScriptComponent.h"
+#include "Function/Framework/Component/SkyboxComponent.h"
+#include "Function/Framework/Component/TransformComponent.h"
+#include "Function/Framework/Component/VolumeLightComponent.h"
+#include "Function/Framework/Entity/Entity.h"
+
+#include <memory>
+
+uint32_t ComponentPoolBase::Emplace(uint32_t entityID)
+{
+    if(entityID >= sparse.size()) sparse.resize(entityID + 1, 0);
+    entities.push_back(entityID);
+    sparse[entityID] = entities.size();
+    return entities.size() - 1;
+}
+
+void ComponentPoolBase::Remove(uint32_t entityID)
+{
+    if(!Contains(entityID)) return;
+
+    uint32_t index = sparse[entityID] - 1;
+    uint32_t last = entities.back();
+    SwapRemove(index);
+    entities[index] = last;
+    entities.pop_back();
+    sparse[last] = index + 1;
+    sparse[entityID] = 0;
+}
+
+void ComponentRegistry::AddEntity(Entity* entity)
+{
+    for(auto& component : entity->GetComponents())
+    {
+        if(!component) continue;
+
+        ComponentPoolBase* pool = GetPool(component->GetType());
+        if(pool && !pool->Contains(entity->GetID())) pool->Set(entity->GetID(), component);
+    }
+}
+
+void ComponentRegistry::RemoveEntity(Entity* entity)
+{
+    for(auto& pool : pools)
+    {
+        if(pool) pool->Remove(entity->GetID());
+    }
+}
+
+void ComponentRegistry::Sync(Entity* entity, ComponentType type)
+{
+    ComponentPoolBase* pool = GetPool(type);
+    if(!pool) return;
+
+    for(auto& component : entity->GetComponents())
+    {
+        if(component && component->GetType() == type)
+        {
+            pool->Set(entity->GetID(), component);
+            return;
+        }
+    }
+    pool->Remove(entity->GetID());
+}
+
+void ComponentRegistry::Clear()
+{
+    for(auto& pool : pools) pool = nullptr;
+}
+
+ComponentPoolBase* ComponentRegistry::GetPool(ComponentType type)
+{
+    if(type == UNDEFINED_COMPONENT || type >= COMPONENT_TYPE_MAX_ENUM) return nullptr;
+
+    auto& pool = pools[type];
+    if(!pool)
+    {
+        switch (type) {
+        case TRANSFORM_COMPONENT:           pool = std::make_shared<ComponentPool<TransformComponent>>();           break;
+        case CAMERA_COMPONENT:              pool = std::make_shared<ComponentPool<CameraComponent>>();              break;
+        case POINT_LIGHT_COMPONENT:         pool = std::make_shared<ComponentPool<PointLightComponent>>();          break;
+        case DIRECTIONAL_LIGHT_COMPONENT:   pool = std::make_shared<ComponentPool<DirectionalLightComponent>>();    break;
+        case VOLUME_LIGHT_COMPONENT:        pool = std::make_shared<ComponentPool<VolumeLightComponent>>();         break;
+        case MESH_RENDERER_COMPONENT:       pool = std::make_shared<ComponentPool<MeshRendererComponent>>();        break;
+        case SKYBOX_COMPONENT:              pool = std::make_shared<ComponentPool<SkyboxComponent>>();              break;
+        case SCRIPT_COMPONENT:              pool = std::make_shared<ComponentPool<ScriptComponent>>();              break;
+        default:                                                                                                    break;
+        }
+    }
+    return pool.get();
+}
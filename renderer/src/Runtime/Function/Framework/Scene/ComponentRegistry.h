@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Function/Framework/Component/Component.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Entity;
+
+// 一类组件的稀疏集合，sparse按实体ID索引到dense下标，同类组件连续存放
+// 删除时和末尾交换，遍历顺序不保证和实体顺序一致
+class ComponentPoolBase
+{
+public:
+    virtual ~ComponentPoolBase() {};
+
+    virtual void Set(uint32_t entityID, const std::shared_ptr<Component>& component) = 0;   // 组件类型由GetType()保证
+    void Remove(uint32_t entityID);
+
+    inline bool Contains(uint32_t entityID)     { return entityID < sparse.size() && sparse[entityID] != 0; }
+    inline uint32_t Size()                      { return entities.size(); }
+    inline const std::vector<uint32_t>& GetEntityIDs() { return entities; }
+
+protected:
+    virtual void SwapRemove(uint32_t index) = 0;
+
+    uint32_t Emplace(uint32_t entityID);
+
+    std::vector<uint32_t> sparse;       // 实体ID -> dense下标 + 1，0为无效
+    std::vector<uint32_t> entities;     // dense下标 -> 实体ID
+};
+
+template<typename TComponent>
+class ComponentPool : public ComponentPoolBase
+{
+public:
+    virtual void Set(uint32_t entityID, const std::shared_ptr<Component>& component) override
+    {
+        std::shared_ptr<TComponent> cast = std::static_pointer_cast<TComponent>(component);
+        if(Contains(entityID))  components[sparse[entityID] - 1] = cast;
+        else                    { Emplace(entityID); components.push_back(cast); }
+    }
+
+    inline std::shared_ptr<TComponent> Get(uint32_t entityID)          { return Contains(entityID) ? components[sparse[entityID] - 1] : nullptr; }
+    inline const std::vector<std::shared_ptr<TComponent>>& GetComponents() { return components; }
+
+protected:
+    virtual void SwapRemove(uint32_t index) override
+    {
+        components[index] = std::move(components.back());
+        components.pop_back();
+    }
+
+private:
+    std::vector<std::shared_ptr<TComponent>> components;
+};
+
+// 场景内按ComponentType划分的组件表，由Entity增删组件和Scene增删实体时同步
+// 替代原先遍历全部实体逐个dynamic_pointer_cast的查找方式
+class ComponentRegistry
+{
+public:
+    void AddEntity(Entity* entity);
+    void RemoveEntity(Entity* entity);
+    void Sync(Entity* entity, ComponentType type);     // 实体上该类组件增删后调用，一个实体有多个同类组件时只登记第一个
+    void Clear();
+
+    template<typename TComponent>
+    ComponentPool<TComponent>* GetPool()    { return static_cast<ComponentPool<TComponent>*>(GetPool(TComponent::StaticType())); }
+
+private:
+    ComponentPoolBase* GetPool(ComponentType type);
+
+    std::array<std::shared_ptr<ComponentPoolBase>, COMPONENT_TYPE_MAX_ENUM> pools;
+};
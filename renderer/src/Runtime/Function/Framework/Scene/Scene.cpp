@@ -14,6 +14,14 @@ CEREAL_REGISTER_POLYMORPHIC_RELATION(Asset, Scene)
 
 void Scene::OnLoadAsset()
 {
+    componentRegistry.Clear();
+    transformHierarchy.Clear();
+    for(auto& entity : entities) 
+    {
+        if(entity->id == 0) entity->id = idAlloctor.Allocate();    // ID不做序列化，加载后重新分配
+        componentRegistry.AddEntity(entity.get());
+    }
+
     for(auto& entity : entities) 
     {
         entity->Load();
@@ -21,6 +29,18 @@ void Scene::OnLoadAsset()
     }
 }
 
+void Scene::GetDependencies(std::vector<UID>& dependencies)
+{
+    for(auto& entity : entities) 
+    {
+        for(auto& component : entity->GetComponents())
+        {
+            AssetBinder* binder = dynamic_cast<AssetBinder*>(component.get());
+            if(binder) binder->GetBindedAssets(dependencies);
+        }
+    }
+}
+
 void Scene::OnSaveAsset() 
 {
     for(auto& entity : entities) 
@@ -41,6 +61,8 @@ void Scene::Tick(float deltaTime)
             if(component) component->OnUpdate(deltaTime);
         }
     }
+
+    UpdateTransforms();     // 组件更新中修改的变换在这一帧内生效
 }
 
 std::shared_ptr<Entity> Scene::GetEntity(std::string name)
@@ -64,6 +86,7 @@ std::shared_ptr<Entity> Scene::CreateEntity(std::string name)
     entity->AddComponent<TransformComponent>();     // 默认添加一个transform组件
 
     entities.push_back(entity);
+    version++;
     return entity;
 }
 
@@ -78,6 +101,8 @@ bool Scene::AddEntity(std::shared_ptr<Entity> entity)
     entity->id = idAlloctor.Allocate();    // 重新分配ID
     entity->scene = weak_from_this();
     entities.push_back(entity);
+    componentRegistry.AddEntity(entity.get());
+    version++;
     return true;
 }
 
@@ -88,9 +113,12 @@ std::shared_ptr<Entity> Scene::RemoveEntity(std::string name)
         std::shared_ptr<Entity>& entity = entities[i];
         if (entity->name.compare(name) == 0) 
         {
+            std::shared_ptr<Entity> removed = entity;
             entities.erase(entities.begin() + i);
-            entity->scene = std::weak_ptr<Scene>();
-            return entity;    // TODO 重名？
+            componentRegistry.RemoveEntity(removed.get());
+            removed->scene = std::weak_ptr<Scene>();
+            version++;
+            return removed;    // TODO 重名？
         }
     }
     return nullptr;
@@ -103,9 +131,12 @@ std::shared_ptr<Entity> Scene::RemoveEntity(uint32_t id)
         std::shared_ptr<Entity>& entity = entities[i];
         if (entity->id == id) 
         {
+            std::shared_ptr<Entity> removed = entity;
             entities.erase(entities.begin() + i);
-            entity->scene = std::weak_ptr<Scene>();
-            return entity;  
+            componentRegistry.RemoveEntity(removed.get());
+            removed->scene = std::weak_ptr<Scene>();
+            version++;
+            return removed;  
         }
     }
     return nullptr;
@@ -113,30 +144,15 @@ std::shared_ptr<Entity> Scene::RemoveEntity(uint32_t id)
 
 std::shared_ptr<CameraComponent> Scene::GetActiveCamera()   // TODO 暂时做成找第一个
 {
-    for(auto& entity : entities)
-    {
-        std::shared_ptr<CameraComponent> camera = entity->TryGetComponent<CameraComponent>();
-        if(camera) return camera;
-    }
-    return nullptr;
+    return GetFirstComponent<CameraComponent>();
 }
 
 std::shared_ptr<SkyboxComponent> Scene::GetSkyBox() // TODO 暂时做成找第一个
 {
-    for(auto& entity : entities)
-    {
-        std::shared_ptr<SkyboxComponent> skybox = entity->TryGetComponent<SkyboxComponent>();
-        if(skybox) return skybox;
-    }
-    return nullptr;
+    return GetFirstComponent<SkyboxComponent>();
 }
 
 std::shared_ptr<DirectionalLightComponent> Scene::GetDirectionalLight() // TODO 暂时做成找第一个
 {
-    for(auto& entity : entities)
-    {
-        std::shared_ptr<DirectionalLightComponent> directionalLight = entity->TryGetComponent<DirectionalLightComponent>();
-        if(directionalLight) return directionalLight;
-    }
-    return nullptr;
+    return GetFirstComponent<DirectionalLightComponent>();
 }
\ No newline at end of file
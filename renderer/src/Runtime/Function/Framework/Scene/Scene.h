@@ -8,6 +8,8 @@
 #include "Function/Framework/Component/SkyboxComponent.h"
 #include "Function/Framework/Component/VolumeLightComponent.h"
 #include "Function/Framework/Entity/Entity.h"
+#include "Function/Framework/Scene/ComponentRegistry.h"
+#include "Function/Framework/Scene/TransformHierarchy.h"
 #include "Resource/Asset/Asset.h"
 
 #include <cstdint>
@@ -27,6 +29,7 @@ public:
 
     virtual void OnLoadAsset() override;
     virtual void OnSaveAsset() override;
+    virtual void GetDependencies(std::vector<UID>& dependencies) override;     // 组件绑定的资源
 
     void Tick(float deltaTime);
 
@@ -41,33 +44,53 @@ public:
     std::shared_ptr<Entity> RemoveEntity(std::string name);
     std::shared_ptr<Entity> RemoveEntity(uint32_t id);
 
+    uint32_t GetVersion() { return version; }      // 增删物体时递增，用于检查场景结构是否变化
+
     std::string GetName() { return name; }
     void SetName(std::string name) { this->name = name; }
 
     template<typename TComponent>
-    std::vector<std::shared_ptr<TComponent>> GetComponents()
+    const std::vector<std::shared_ptr<TComponent>>& GetComponents()    // 连续存放的同类组件，每个实体只取第一个，增删组件和实体后会失效
     {
-        std::vector<std::shared_ptr<TComponent>> components;
-        for(auto& entity : entities)
-        {
-            std::shared_ptr<TComponent> component = entity->TryGetComponent<TComponent>();
-            if(component) components.push_back(component);
-        }
-        return components;
+        return componentRegistry.GetPool<TComponent>()->GetComponents();
     }
 
+    void SyncComponent(Entity* entity, ComponentType type)              { componentRegistry.Sync(entity, type); }
+
+    void MarkTransformDirty(const std::shared_ptr<Entity>& entity)      { transformHierarchy.MarkDirty(entity); }
+    void UpdateTransforms()                                             { transformHierarchy.Update(); }   // 在Tick末尾调用，渲染使用的都是更新后的世界矩阵
+    TransformHierarchy& GetTransformHierarchy()                         { return transformHierarchy; }
+
     // 获取场景内的组件
     std::shared_ptr<CameraComponent> GetActiveCamera();
     std::shared_ptr<SkyboxComponent> GetSkyBox();
     std::shared_ptr<DirectionalLightComponent> GetDirectionalLight();
-    std::vector<std::shared_ptr<PointLightComponent>> GetPointLights()      { return GetComponents<PointLightComponent>(); }
-    std::vector<std::shared_ptr<VolumeLightComponent>> GetVolumeLights()    { return GetComponents<VolumeLightComponent>(); }
+    const std::vector<std::shared_ptr<PointLightComponent>>& GetPointLights()      { return GetComponents<PointLightComponent>(); }
+    const std::vector<std::shared_ptr<VolumeLightComponent>>& GetVolumeLights()    { return GetComponents<VolumeLightComponent>(); }
 
 protected:
+    template<typename TComponent>
+    std::shared_ptr<TComponent> GetFirstComponent()                     // 按实体顺序的第一个，组件池内的顺序会随交换删除变化，不能直接取池的第一个
+    {
+        auto& components = GetComponents<TComponent>();
+        if(components.size() <= 1) return components.empty() ? nullptr : components[0];
+
+        for(auto& entity : entities)
+        {
+            std::shared_ptr<TComponent> component = entity->TryGetComponent<TComponent>();
+            if(component) return component;
+        }
+        return nullptr;
+    }
+
     std::string name;
     std::vector<std::shared_ptr<Entity>> entities;
 
     IndexAlloctor idAlloctor = IndexAlloctor(UINT32_MAX);
+    uint32_t version = 0;
+
+    ComponentRegistry componentRegistry;    // 运行时构建，不做序列化
+    TransformHierarchy transformHierarchy;
 
 private:
     BeginSerailize()
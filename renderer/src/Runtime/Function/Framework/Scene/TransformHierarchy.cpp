@@ -0,0 +1,160 @@
+#include "TransformHierarchy.h"
+#include "Core/Math/Math.h"
+#include "Function/Framework/Component/TransformComponent.h"
+#include "Function/Framework/Entity/Entity.h"
+#include "Function/Global/EngineContext.h"
+#include "Function/Render/RenderResource/Drawable.h"
+
+#include <algorithm>
+
+static TransformComponent* GetTransform(Entity* entity)   // 不经过shared_ptr，避免逐个物体的引用计数开销
+{
+    for(auto& component : entity->GetComponents())
+    {
+        if(component && component->GetType() == TransformComponent::StaticType()) return static_cast<TransformComponent*>(component.get());
+    }
+    return nullptr;
+}
+
+static void ComputeWorld(const TransformComponent* parent, const Transform& transform, Mat4& world, Mat4& worldInv)
+{
+    // TRS = [R * S | P]，逆为 [S^-1 * R^T | -S^-1 * R^T * P]，旋转矩阵只算一次
+    Mat3 rotation = transform.GetRotation().toRotationMatrix();
+    Vec3 position = transform.GetPosition();
+
+    Mat4 local = Mat4::Identity();
+    local.block<3,3>(0,0) = rotation * transform.GetScale().asDiagonal();
+    local.block<3,1>(0,3) = position;
+
+    Mat4 localInv = Mat4::Identity();
+    localInv.block<3,3>(0,0) = transform.GetScale().cwiseInverse().asDiagonal() * rotation.transpose();
+    localInv.block<3,1>(0,3) = -(localInv.block<3,3>(0,0) * position);
+
+    if(parent)
+    {
+        world.noalias() = parent->GetModelMat() * local;
+        worldInv.noalias() = localInv * parent->GetModelMatInv();
+    }
+    else
+    {
+        world = local;
+        worldInv = localInv;
+    }
+}
+
+void TransformHierarchy::MarkDirty(const std::shared_ptr<Entity>& entity)
+{
+    dirtyRoots.push_back(entity);
+}
+
+void TransformHierarchy::Clear()
+{
+    for(auto& root : dirtyRoots)    // 标记不清掉的话MarkDirty会直接返回，这些物体之后再也不会更新
+    {
+        std::shared_ptr<Entity> entity = root.lock();
+        if(!entity) continue;
+
+        TransformComponent* transform = GetTransform(entity.get());
+        if(transform) transform->worldDirty = false;
+    }
+    dirtyRoots.clear();
+}
+
+void TransformHierarchy::Update()
+{
+    updatedCount = 0;
+    levelCount = 0;
+    if(dirtyRoots.empty()) return;
+
+    CollectRoots();
+    while(!currentLevel.empty())
+    {
+        ComputeLevel();
+
+        // 清标记，通知Drawable，并收集下一层
+        nextLevel.clear();
+        for(Node& node : currentLevel)
+        {
+            node.transform->worldDirty = false;
+            for(auto& component : node.entity->GetComponents())
+            {
+                if(component.get() == node.transform) continue;
+                Drawable* drawable = dynamic_cast<Drawable*>(component.get());
+                if(drawable) drawable->MarkDrawableDirty(DRAWABLE_DIRTY_TRANSFORM);
+            }
+            ExpandChildren(node.entity, node.transform, nextLevel);
+        }
+
+        updatedCount += currentLevel.size();
+        levelCount++;
+        std::swap(currentLevel, nextLevel);
+    }
+    roots.clear();
+}
+
+void TransformHierarchy::CollectRoots()
+{
+    currentLevel.clear();
+    for(auto& weak : dirtyRoots)
+    {
+        std::shared_ptr<Entity> entity = weak.lock();
+        if(!entity) continue;
+        TransformComponent* transform = GetTransform(entity.get());
+        if(!transform || !transform->worldDirty) continue;
+
+        // 有祖先也在等待更新时由祖先向下统一处理，否则父矩阵取最近的带变换组件的祖先
+        const TransformComponent* parent = nullptr;
+        bool ancestorDirty = false;
+        for(std::shared_ptr<Entity> father = entity->father.lock(); father; father = father->father.lock())
+        {
+            TransformComponent* fatherTransform = GetTransform(father.get());
+            if(!fatherTransform) continue;
+            if(fatherTransform->worldDirty)
+            {
+                ancestorDirty = true;
+                break;
+            }
+            if(!parent) parent = fatherTransform;
+        }
+        if(ancestorDirty) continue;
+
+        currentLevel.push_back({ entity.get(), transform, parent });
+        roots.push_back(entity);
+    }
+    dirtyRoots.clear();
+}
+
+void TransformHierarchy::ComputeLevel()
+{
+    // 同一层的物体互不依赖，父物体的矩阵在上一层已经算完
+    auto compute = [&](uint32_t begin, uint32_t end) {
+        for(uint32_t i = begin; i < end; i++)
+        {
+            Node& node = currentLevel[i];
+            ComputeWorld(node.parent, node.transform->transform, node.transform->worldMatrix, node.transform->worldMatrixInv);
+        }
+    };
+
+    uint32_t size = currentLevel.size();
+    if(size < PARALLEL_THRESHOLD || EngineContext::Destroyed())
+    {
+        compute(0, size);
+        return;
+    }
+
+    uint32_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    EngineContext::ThreadPool()->ParallelFor(chunks, [&](uint32_t chunk) {
+        uint32_t begin = chunk * CHUNK_SIZE;
+        compute(begin, std::min(begin + CHUNK_SIZE, size));
+    });
+}
+
+void TransformHierarchy::ExpandChildren(Entity* entity, const TransformComponent* parent, std::vector<Node>& level)
+{
+    for(auto& child : entity->children)
+    {
+        TransformComponent* transform = GetTransform(child.get());
+        if(transform)   level.push_back({ child.get(), transform, parent });
+        else            ExpandChildren(child.get(), parent, level);
+    }
+}
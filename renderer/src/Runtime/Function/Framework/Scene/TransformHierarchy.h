@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Entity;
+class TransformComponent;
+
+// 场景内世界矩阵的增量更新，世界矩阵 = 父物体世界矩阵 * 局部变换，缓存在TransformComponent里
+// 修改变换时只把该物体记为脏根，Update时从脏根出发逐层广度优先向下计算，父物体先于子物体算完，同一层内并行
+// 没有修改的子树不会被访问，每帧的开销只和需要重新计算的物体数目相关
+class TransformHierarchy
+{
+public:
+    void MarkDirty(const std::shared_ptr<Entity>& entity);     // 本物体及其全部子孙需要重新计算
+    void Update();
+    void Clear();
+
+    inline uint32_t GetUpdatedCount()       { return updatedCount; }    // 上一次Update重新计算的物体数目
+    inline uint32_t GetLevelCount()         { return levelCount; }      // 上一次Update处理的层数
+
+private:
+    struct Node
+    {
+        Entity* entity;
+        TransformComponent* transform;
+        const TransformComponent* parent;       // 最近的带变换组件的祖先，为空时局部变换即世界变换
+    };
+
+    void CollectRoots();
+    void ComputeLevel();
+    void ExpandChildren(Entity* entity, const TransformComponent* parent, std::vector<Node>& level);   // 没有变换组件的子物体直接展开它的子物体
+
+    static const uint32_t CHUNK_SIZE = 256;     // 每个并行任务处理的物体数
+    static const uint32_t PARALLEL_THRESHOLD = 1024;
+
+    std::vector<std::weak_ptr<Entity>> dirtyRoots;
+    std::vector<std::shared_ptr<Entity>> roots;     // Update期间持有，保证子树有效
+    std::vector<Node> currentLevel;
+    std::vector<Node> nextLevel;
+
+    uint32_t updatedCount = 0;
+    uint32_t levelCount = 0;
+};
@@ -2,6 +2,15 @@
 
 #define ENABLE_DEBUG_MODE 0                         //启用调试模式
 #define ENABLE_RAY_TRACING 1                        //启用硬件光追
+#define ENABLE_NULL_RHI 0                           //使用无GPU的空后端，不创建窗口，用于CI上统计CPU端开销
+#define NULL_RHI_MAX_FRAMES 1000                    //空后端下运行的帧数，之后自动退出
+#define ASSET_UPLOAD_TIME_BUDGET 4.0f               //每帧主线程执行异步加载资源的OnLoadAsset的时间预算，毫秒
+#define UPLOAD_HEAP_FRAME_SIZE (32 * 1024 * 1024)   //上传堆每帧的暂存容量，环形缓冲总共FRAMES_IN_FLIGHT份，放不下的上传使用单独的暂存缓冲
+#define ENABLE_RDG_PASS_CULLING 1                   //RDG编译时剔除输出没有被使用的pass
+#define ENABLE_RDG_TRANSIENT_ALIASING 1             //RDG中GPU独占的临时资源按生命周期放置在共享的heap上，不重叠的资源复用同一段显存
+#define ENABLE_RDG_PARALLEL_RECORDING 1             //RDG执行时把pass列表切成连续的若干段，在工作线程上并行录制到各自的指令列表，按顺序合并提交；执行函数不是线程安全的pass（RecordOnMainThread）留在主线程上录制
+#define MAX_RDG_RECORDING_CHUNKS 8                  //RDG并行录制的最大段数，每段使用独立的指令池
+#define MIN_RDG_PASSES_PER_CHUNK 4                  //RDG并行录制时每段最少的pass数目，pass较少时调度开销不划算
 
 #define FRAMES_IN_FLIGHT 2							//帧缓冲数目
 #define WINDOW_WIDTH 2048                           //32 * 64   16 * 128
@@ -30,6 +39,8 @@
 #define MAX_PER_FRAME_CLUSTER_GROUP_SIZE 20480      //全局最大支持的cluster group数目
 #define MAX_PER_PASS_PIPELINE_STATE_COUNT 64        //每个mesh pass支持的最大的不同管线状态数目
 #define MAX_SUPPORTED_MESH_PASS_COUNT 32            //全局支持的最大mesh pass数目 
+#define SCENE_OCTREE_HALF_SIZE 2048.0f              //CPU端剔除使用的场景八叉树根节点半边长，超出的物体单独逐个剔除
+#define SCENE_OCTREE_MAX_DEPTH 6                    //场景八叉树的最大深度，叶节点的格子半边长为32
 
 #define MAX_LIGHTS_PER_CLUSTER 8                    //每个cluster最多支持存储的光源数目
 #define LIGHT_CLUSTER_GRID_SIZE 64                  //cluster based lighting裁剪时使用的tile像素尺寸
@@ -36,7 +36,7 @@ std::shared_ptr<EngineContext> EngineContext::Init()
     context->inputSystem->Init();
     context->inputSystem->InitGLFW();
 
-    context->rhiBackend = RHIBackend::Init({.type = BACKEND_VULKAN, .enableDebug = true, .enableRayTracing = ENABLE_RAY_TRACING});
+    context->rhiBackend = RHIBackend::Init({.type = ENABLE_NULL_RHI ? BACKEND_NULL : BACKEND_VULKAN, .enableDebug = true, .enableRayTracing = ENABLE_RAY_TRACING});
 
     context->renderResourceManger = std::make_shared<RenderResourceManager>();
     context->renderResourceManger->Init();
@@ -81,6 +81,10 @@ void EngineContext::MainLoopInternal()
             
             EngineContext::ThreadPool()->WaitIdle();   
         }
+        {
+            ENGINE_TIME_SCOPE(EngineContext::AssetStreaming);
+            assetManager->UpdateStreaming();    // 异步加载完成的资源在主线程创建GPU资源，有时间预算
+        }
         {
             ENGINE_TIME_SCOPE(EngineContext::RenderTick);
             exit = renderSystem->Tick();
@@ -107,10 +111,7 @@ void EngineContext::DestroyInternal()
 
 void EngineContext::UpdateTimers()
 {
-    historyTimers = timers[currentTick % (2 * FRAMES_IN_FLIGHT)];
-
-    for(auto& timerPair : timers[currentTick % (2 * FRAMES_IN_FLIGHT)])    // 计时需要在全部同步之后做更新
-        timerPair.second = std::make_shared<TimeScopes>(); // 重新生成对象，不clear了
+    Profiler::Get()->BeginFrame(currentTick, 2 * FRAMES_IN_FLIGHT);   // 计时需要在全部同步之后做收集，和原先一样延迟2 * FRAMES_IN_FLIGHT帧
     
     timer.EndAfterMilliSeconds(renderSystem->GetGlobalSetting()->minFrameTime);
     deltaTime = timer.GetMilliSeconds();
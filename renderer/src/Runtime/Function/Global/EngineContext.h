@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Core/Log/LogSystem.h"
+#include "Core/Util/Profiler.h"
 #include "Core/Util/TimeScope.h"
 #include "Core/Event/EventSystem.h"
 #include "EngineThreadPool.h"
@@ -37,20 +38,13 @@ class EngineContext;
     throw std::runtime_error("");  \
 } while (0)
 
-#define ENGINE_TIME_SCOPE(name)                                                                                             \
-    auto& __timeScopes = EngineContext::GetTimeScopes(EngineContext::ThreadPool()->ThreadTick() % (2 * FRAMES_IN_FLIGHT));  \
-    uint32_t __threadID = PlatformProcess::GetThreadID();                                                                   \
-    if(!__timeScopes[__threadID])                                                                                           \
-        __timeScopes[__threadID] = std::make_shared<TimeScopes>();                                                          \
-    TimeScopeHelper __timeScopeHelper(#name, __timeScopes[__threadID].get());                                               \
+// 名字直接作为静态字符串记录，不分配内存
+#define ENGINE_TIME_SCOPE(name) \
+    ProfilerScope __profilerScope(#name, EngineContext::ThreadPool()->ThreadTick());
 
-
-#define ENGINE_TIME_SCOPE_STR(name)                                                                                         \
-    auto& __timeScopes = EngineContext::GetTimeScopes(EngineContext::ThreadPool()->ThreadTick() % (2 * FRAMES_IN_FLIGHT));  \
-    uint32_t __threadID = PlatformProcess::GetThreadID();                                                                   \
-    if(!__timeScopes[__threadID])                                                                                           \
-        __timeScopes[__threadID] = std::make_shared<TimeScopes>();                                                          \
-    TimeScopeHelper __timeScopeHelper(name, __timeScopes[__threadID].get());                                                \
+// 运行时的名字，可以传前缀和名字两部分，避免在调用处拼接字符串
+#define ENGINE_TIME_SCOPE_STR(...) \
+    ProfilerScope __profilerScope(Profiler::InternName(__VA_ARGS__), EngineContext::ThreadPool()->ThreadTick());
 
 class EngineContext
 {
@@ -69,10 +63,6 @@ public:
     static uint32_t PreviousFrameIndex()                            { return (context->currentFrameIndex + FRAMES_IN_FLIGHT - 1) % FRAMES_IN_FLIGHT; }  // 主线程的帧
     static uint32_t GetCurretTick()                                 { return context->currentTick; }
     static float GetDeltaTime()                                     { return context->deltaTime; }
-    static std::map<uint32_t, std::shared_ptr<TimeScopes>>& GetTimeScopes(uint32_t index)                               
-                                                                    { return context->timers[index]; }
-    static std::map<uint32_t, std::shared_ptr<TimeScopes>>& GetHistoryTimeScopes()                   
-                                                                    { return context->historyTimers; }                                              
 
     static const std::shared_ptr<EngineContext>& Get() { return context; }
 
@@ -106,9 +96,6 @@ private:
     uint32_t currentFrameIndex = 0;
     TimeScope timer;
 
-    std::map<uint32_t, std::shared_ptr<TimeScopes>> historyTimers; 
-    std::array<std::map<uint32_t, std::shared_ptr<TimeScopes>>, 2 * FRAMES_IN_FLIGHT> timers; // 各个线程的计时器
-
     void DestroyInternal();
     void MainLoopInternal();
     void UpdateTimers();
@@ -1,7 +1,9 @@
 #include "EngineThreadPool.h"
 #include "Function/Global/EngineContext.h"
 #include "Platform/HAL/PlatformProcess.h"
+#include <algorithm>
 #include <cstdint>
+#include <thread>
 
 thread_local uint32_t EngineThreadPool::threadFrameIndex = 0;
 thread_local uint32_t EngineThreadPool::threadTick = 0;
@@ -10,8 +12,11 @@ void EngineThreadPool::Init()
 {
     mainThreadID = PlatformProcess::GetThreadID();
 
+    // 主线程和RHI线程各占一个核，其余给ANY；资源线程优先级较低，只在空闲时占用
+    uint32_t cores = std::max(std::thread::hardware_concurrency(), 1u);
     rhiThread = QueuedThreadPool::Create(1);
-    anyThread = QueuedThreadPool::Create(2);
+    anyThread = QueuedThreadPool::Create(cores > 4 ? cores - 2 : 2);
+    assetThread = QueuedThreadPool::Create(cores > 4 ? cores - 2 : 2, 10240 * 1024, PRIORITY_TYPE_BELOW_NORMAL);
 }
 
 uint32_t EngineThreadPool::ThreadFrameIndex()
@@ -33,40 +38,77 @@ uint32_t EngineThreadPool::ThreadTick()
     return threadTick;
 }
 
+bool EngineThreadPool::IsMainThread()
+{
+    return PlatformProcess::GetThreadID() == mainThreadID;
+}
+
 void EngineThreadPool::WaitIdle(EngineThreadType threadType)
 {
     auto thread = TypeToThreadPool(threadType);
-    if(thread)
-        thread->WaitIdle();
+    if(!thread) return;
+
+    if(IsMainThread()) 
+    {
+        thread->WaitIdle([](){                                      // OnLoadAsset只能在主线程执行
+            if(EngineContext::Asset()) EngineContext::Asset()->ServeBlockingRequests();
+        });
+    }
+    else thread->WaitIdle();
 }
 
 void EngineThreadPool::WaitAllIdle()
 {
     rhiThread->WaitIdle();
     anyThread->WaitIdle();
+    assetThread->WaitIdle();
 }
 
 void EngineThreadPool::Destroy()
 {
     rhiThread->Destroy();
     anyThread->Destroy();
+    assetThread->Destroy();
 }
 
-void EngineThreadPool::AddQueuedWork(QueuedWorkFunc func, EngineThreadType threadType)
+void EngineThreadPool::AddQueuedWork(QueuedWorkFunc func, EngineThreadType threadType, QueuedWorkPriority priority)
 {
     uint32_t frameIndex = ThreadFrameIndex();               // 线程执行前，将帧设置为录制该指令时对应线程的对应时间
     uint32_t tick = ThreadTick();
     auto lambda = [frameIndex, tick, func](){
+        uint32_t lastFrameIndex = threadFrameIndex;     // 等待时线程会帮忙执行其他任务，执行完恢复外层任务的帧
+        uint32_t lastTick = threadTick;
         threadFrameIndex = frameIndex;  
         threadTick = tick; 
         func();
+        threadFrameIndex = lastFrameIndex;
+        threadTick = lastTick;
     };
 
     // lambda();    // 不使用多线程时直接串行
 
     auto thread = TypeToThreadPool(threadType);
     if (thread) 
-        thread->AddQueuedWork(std::make_shared<QueuedWork>(lambda));
+        thread->AddQueuedWork(std::make_shared<QueuedWork>(lambda, priority));
+}
+
+void EngineThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func, EngineThreadType threadType)
+{
+    uint32_t frameIndex = ThreadFrameIndex();
+    uint32_t tick = ThreadTick();
+    auto lambda = [frameIndex, tick, &func](uint32_t index){
+        uint32_t lastFrameIndex = threadFrameIndex;
+        uint32_t lastTick = threadTick;
+        threadFrameIndex = frameIndex;  
+        threadTick = tick; 
+        func(index);
+        threadFrameIndex = lastFrameIndex;
+        threadTick = lastTick;
+    };
+
+    auto thread = TypeToThreadPool(threadType);
+    if (thread) thread->ParallelFor(count, lambda);
+    else        for(uint32_t i = 0; i < count; i++) func(i);
 }
 
 std::shared_ptr<QueuedThreadPool> EngineThreadPool::TypeToThreadPool(EngineThreadType threadType)
@@ -75,6 +117,7 @@ std::shared_ptr<QueuedThreadPool> EngineThreadPool::TypeToThreadPool(EngineThrea
     switch (threadType) {
         case ENGINE_THREAD_TYPE_RHI:        thread = rhiThread;     break;
         case ENGINE_THREAD_TYPE_ANY:        thread = anyThread;     break;
+        case ENGINE_THREAD_TYPE_ASSET:      thread = assetThread;   break;
         case ENGINE_THREAD_TYPE_MAX_ENUM:                           break;
     }
     return thread;
@@ -2,12 +2,14 @@
 
 #include "Platform/Thread/QueuedThreadPool.h"
 #include <cstdint>
+#include <functional>
 #include <string>
 
 enum EngineThreadType : uint32_t
 {
 	ENGINE_THREAD_TYPE_RHI = 0,
 	ENGINE_THREAD_TYPE_ANY,
+	ENGINE_THREAD_TYPE_ASSET,		// 资源的异步加载和构建，不参与每帧的WaitIdle
 
 	ENGINE_THREAD_TYPE_MAX_ENUM,	//
 };
@@ -22,18 +24,23 @@ public:
     uint32_t ThreadFrameIndex();    // 获取线程任务的帧，任务被录制时的帧下标（执行时可能跨帧）
     uint32_t ThreadPreviousFrameIndex();
     uint32_t ThreadTick();    
+    bool IsMainThread();
 
-    void WaitIdle(EngineThreadType threadType = ENGINE_THREAD_TYPE_ANY);
+    void WaitIdle(EngineThreadType threadType = ENGINE_THREAD_TYPE_ANY);   // 主线程等待时会替阻塞在同步加载上的工作线程执行资源上传
     void WaitAllIdle();
 	void Destroy();
 
-	void AddQueuedWork(QueuedWorkFunc func, EngineThreadType threadType = ENGINE_THREAD_TYPE_ANY);
+	void AddQueuedWork(QueuedWorkFunc func, EngineThreadType threadType = ENGINE_THREAD_TYPE_ANY, QueuedWorkPriority priority = WORK_PRIORITY_NORMAL);
+	void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func, EngineThreadType threadType = ENGINE_THREAD_TYPE_ANY);	// 和AddQueuedWork一样，执行时的帧为调用时的帧
+
+    std::shared_ptr<QueuedThreadPool> GetThreadPool(EngineThreadType threadType = ENGINE_THREAD_TYPE_ANY) { return TypeToThreadPool(threadType); }
 
 private:
     std::shared_ptr<QueuedThreadPool> TypeToThreadPool(EngineThreadType threadType);
 
     std::shared_ptr<QueuedThreadPool> rhiThread;
     std::shared_ptr<QueuedThreadPool> anyThread;
+    std::shared_ptr<QueuedThreadPool> assetThread;
     
     static thread_local uint32_t threadFrameIndex; // 
     static thread_local uint32_t threadTick;
@@ -8,12 +8,15 @@
 #include "Function/Render/RDG/RDGHandle.h"
 #include "Function/Render/RDG/RDGNode.h"
 #include "Function/Render/RDG/RDGPool.h"
+#include "Function/Render/RHI/RHI.h"
 #include "Function/Render/RHI/RHIStructs.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstdint>
 #include <cstdio>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -165,116 +168,453 @@ RDGBufferHandle RDGBuilder::GetBuffer(std::string name)
     return node->GetHandle();
 }
 
-void RDGBuilder::Execute()
+void RDGBuilder::Compile()
 {
-    // TODO 还没做剔除
-    for (auto& pass : passes) 
+    ENGINE_TIME_SCOPE(RDGBuilder::Compile);
+
+    for(auto& pass : passes) 
     {
-        if(pass->isCulled || !pass) continue;
-        // printf("rdg executing pass: %s\n", pass->Name().c_str());
+        pass->isCulled = false;
+        pass->compiled = {};
+    }
+#if ENABLE_RDG_PASS_CULLING
+    CullPasses();
+#endif
+#if ENABLE_RDG_TRANSIENT_ALIASING
+    PlaceTransientResources();
+#endif
+
+    std::vector<RDGEdgeState> states(graph->EdgeCount());
+    CompileTextureStates(states);
+    CompileBufferStates(states);
+
+    for(auto& pass : passes)
+    {
+        if(!pass->isCulled) CompileBarriers(pass, states);
+    }
+    compiled = true;
+}
 
-        switch (pass->NodeType()) {
-        case RDG_PASS_NODE_TYPE_RENDER:         ExecutePass(dynamic_cast<RDGRenderPassNodeRef>(pass));          break; 
-        case RDG_PASS_NODE_TYPE_COMPUTE:        ExecutePass(dynamic_cast<RDGComputePassNodeRef>(pass));         break; 
-        case RDG_PASS_NODE_TYPE_RAY_TRACING:    ExecutePass(dynamic_cast<RDGRayTracingPassNodeRef>(pass));      break; 
-        case RDG_PASS_NODE_TYPE_PRESENT:        ExecutePass(dynamic_cast<RDGPresentPassNodeRef>(pass));         break; 
-        case RDG_PASS_NODE_TYPE_COPY:           ExecutePass(dynamic_cast<RDGCopyPassNodeRef>(pass));            break; 
-        default:                                ENGINE_LOG_FATAL("Unsupported RDG pass type!");
+void RDGBuilder::Execute()
+{
+    if(!compiled) Compile();
+
+    std::vector<RDGPassNodeRef> executePasses;
+    {
+        ENGINE_TIME_SCOPE(RDGBuilder::Prepare);     // 资源池和RHI对象的创建都不是线程安全的，按顺序在当前线程完成
+        for (auto& pass : passes) 
+        {
+            if(!pass || pass->isCulled) continue;
+            PreparePass(pass);
+            executePasses.push_back(pass);
         }
     }
+    {
+        ENGINE_TIME_SCOPE(RDGBuilder::Record);
+        RecordPasses(executePasses);
+    }
 
     for (auto& pass : passes)   // 释放池化资源
     {
         //ReleaseResource(pass);
         for(auto& descriptor : pass->pooledDescriptorSets)  // 池化的view在pass结束后就可以释放，但是描述符得全部执行完再释放？
         {
-            RDGDescriptorSetPool::Get(EngineContext::ThreadPool()->ThreadFrameIndex())->Release({descriptor.first}, pass->rootSignature, descriptor.second);
+            RDGDescriptorSetPool::Get(EngineContext::ThreadPool()->ThreadFrameIndex())->Release(descriptor.first, pass->rootSignature, descriptor.second);
         }
     }
 }
 
-void RDGBuilder::CreateInputBarriers(RDGPassNodeRef pass)
+void RDGBuilder::CullPasses()
 {
-    graph->ForEachTexture(pass, [&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
+    // 按执行顺序倒序遍历，pass存活的条件：
+    // 1. present pass，或写入了导入的外部资源，或写入了被后续存活pass使用的资源
+    // 2. 没有声明任何写入，可能在RDG之外有副作用（例如直接绑定的描述符），保守保留
+    // 存活pass使用的全部资源都标记为被使用，其前序的写入pass也因此存活
+    std::vector<bool> used(graph->NodeCount(), false);
+
+    for(auto iter = passes.rbegin(); iter != passes.rend(); iter++)
+    {
+        RDGPassNodeRef pass = *iter;
+        bool hasWrite = false;
+        bool alive = pass->NodeType() == RDG_PASS_NODE_TYPE_PRESENT;
+
+        graph->ForEachTexture(pass, [&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
+            if(edge->FromID() != pass->ID()) return;    // pass -> 资源的边为写入
+            hasWrite = true;
+            if(texture->IsImported() || used[texture->ID()]) alive = true;
+        });
+        graph->ForEachBuffer(pass, [&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
+            if(edge->FromID() != pass->ID()) return;
+            hasWrite = true;
+            if(buffer->IsImported() || used[buffer->ID()]) alive = true;
+        });
+
+        pass->isCulled = hasWrite && !alive;
+        if(pass->isCulled) continue;
+
+        graph->ForEachTexture(pass, [&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){ used[texture->ID()] = true; });
+        graph->ForEachBuffer(pass, [&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){ used[buffer->ID()] = true; });
+    }
+}
+
+void RDGBuilder::PlaceTransientResources()
+{
+    // 统计存活pass中每个资源的首次和最后使用的pass序号，只有非导入的GPU独占资源参与放置
+    // texture和buffer分开放置，不需要处理bufferImageGranularity；memoryTypeBits不同的资源也不能共用heap
+    for(auto& texture : graph->GetNodes<RDGTextureNode>())  texture->heap = nullptr;
+    for(auto& buffer : graph->GetNodes<RDGBufferNode>())    buffer->heap = nullptr;
+    if(RHIBackend::Get() == nullptr) return;    // 只做编译的测试中没有后端
 
-        if(edge->IsOutput()) return;
-        RHIResourceState previousState = PreviousState(texture, pass, edge->subresource, false);
-        //if(previousState != edge->state)  // 状态一样也加屏障？ 比如连续两个UAV读写的情况？
+    auto allocator = RDGTransientAllocator::Get();
+    allocator->Tick();
+
+    struct Transient
+    {
+        RDGTextureNodeRef texture = nullptr;
+        RDGBufferNodeRef buffer = nullptr;
+        uint64_t heapKey;
+        RDGTransientAllocator::Placement placement;
+    };
+    std::vector<Transient> transients;
+    std::vector<int32_t> transientIndex(graph->NodeCount(), -1);
+
+    auto addTransient = [&](Transient transient, const RHIMemoryRequirements& requirements, uint32_t passIndex) {
+        transient.heapKey = ((uint64_t)requirements.memoryTypeBits << 32) | (transient.texture ? RDG_RESOURCE_NODE_TYPE_TEXTURE : RDG_RESOURCE_NODE_TYPE_BUFFER);
+        transient.placement = { passIndex, passIndex, requirements.size, requirements.alignment };
+        transients.push_back(transient);
+    };
+
+    uint32_t passIndex = 0;
+    for(auto& pass : passes)
+    {
+        if(pass->isCulled) continue;
+
+        graph->ForEachTexture(pass, [&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
+            if(texture->IsImported() || texture->info.memoryUsage != MEMORY_USAGE_GPU_ONLY) return;
+            int32_t& index = transientIndex[texture->ID()];
+            if(index < 0) 
+            {
+                index = transients.size();
+                addTransient({ .texture = texture }, allocator->GetMemoryRequirements(texture->info), passIndex);
+            }
+            transients[index].placement.last = passIndex;
+        });
+        graph->ForEachBuffer(pass, [&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
+            if(buffer->IsImported() || buffer->info.memoryUsage != MEMORY_USAGE_GPU_ONLY) return;
+            int32_t& index = transientIndex[buffer->ID()];
+            if(index < 0) 
+            {
+                index = transients.size();
+                addTransient({ .buffer = buffer }, allocator->GetMemoryRequirements(buffer->info), passIndex);
+            }
+            transients[index].placement.last = passIndex;
+        });
+        passIndex++;
+    }
+
+    // 每组资源放置到一个heap上
+    RDGTransientAllocator::Stats stats = {};
+    std::map<uint64_t, std::vector<uint32_t>> groups;
+    for(uint32_t i = 0; i < transients.size(); i++) groups[transients[i].heapKey].push_back(i);
+
+    std::vector<RDGTransientAllocator::Placement> placements;
+    for(auto& group : groups)
+    {
+        placements.clear();
+        uint64_t alignment = 1;
+        for(uint32_t index : group.second)
         {
-            RHITextureBarrier barrier = {
-                .texture = Resolve(texture),
-                .srcState = previousState,
-                .dstState = edge->state,
-                .subresource = edge->subresource   
-            };
-            command->TextureBarrier(barrier);
+            placements.push_back(transients[index].placement);
+            alignment = std::max(alignment, transients[index].placement.alignment);
+        }
 
-            // printf("rdg resource %lld, raw: %s barrier: %d to %d\n", (int64_t)texture->texture.get(), ToHex((uint64_t)texture->texture->RawHandle(), false).c_str(), (uint32_t)previousState, (uint32_t)edge->state);
+        uint64_t heapSize = RDGTransientAllocator::Place(placements);
+        RHIHeapRef heap = allocator->GetHeap(group.first, {
+            .size = heapSize,
+            .alignment = alignment,
+            .memoryUsage = MEMORY_USAGE_GPU_ONLY,
+            .memoryTypeBits = (uint32_t)(group.first >> 32) });
+
+        for(uint32_t i = 0; i < group.second.size(); i++)
+        {
+            Transient& transient = transients[group.second[i]];
+            transient.placement.offset = placements[i].offset;
+
+            RDGResourceNodeRef node = transient.texture ? (RDGResourceNodeRef)transient.texture : (RDGResourceNodeRef)transient.buffer;
+            node->heap = heap;
+            node->heapOffset = placements[i].offset;
         }
-    });
+        stats.placedBytes += heapSize;
+    }
 
-    graph->ForEachBuffer(pass, [&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
-        
-        if(edge->IsOutput()) return;
-        RHIResourceState previousState = PreviousState(buffer, pass, false);
-        //if(previousState != edge->state)  // 状态一样也加屏障？ 比如连续两个UAV读写的情况？
+    // 对照：资源池按整个对象复用，资源在最后一次使用后归还，之后描述相同（buffer为尺寸足够）的资源才能取出复用
+    std::vector<uint32_t> order(transients.size());
+    for(uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return transients[a].placement.first < transients[b].placement.first; });
+
+    std::vector<uint32_t> pooled;       // 已归还的资源
+    std::vector<uint32_t> living;
+    for(uint32_t index : order)
+    {
+        Transient& transient = transients[index];
+        for(uint32_t i = 0; i < living.size();)     // 归还在此之前已经结束使用的
         {
-            RHIBufferBarrier barrier = {
-                .buffer = Resolve(buffer),
-                .srcState = previousState,
-                .dstState = edge->state,
-                .offset = edge->offset,
-                .size = edge->size
-            };
-            command->BufferBarrier(barrier);
+            if(transients[living[i]].placement.last < transient.placement.first)
+            {
+                pooled.push_back(living[i]);
+                living[i] = living.back();
+                living.pop_back();
+            }
+            else i++;
+        }
 
-            // printf("rdg resource %lld, raw: %s barrier: %d to %d\n", (int64_t)buffer->buffer.get(), ToHex((uint64_t)buffer->buffer->RawHandle(), false).c_str(), (uint32_t)previousState, (uint32_t)edge->state);
+        auto found = std::find_if(pooled.begin(), pooled.end(), [&](uint32_t other) {
+            Transient& pooledTransient = transients[other];
+            if(transient.texture)   return  pooledTransient.texture &&
+                                            RDGTransientAllocator::Normalize(pooledTransient.texture->info) == RDGTransientAllocator::Normalize(transient.texture->info);
+            else                    return  pooledTransient.buffer &&
+                                            RDGBufferPool::Key(pooledTransient.buffer->info) == RDGBufferPool::Key(transient.buffer->info) &&
+                                            pooledTransient.placement.size >= transient.placement.size;
+        });
+        if(found != pooled.end()) 
+        {
+            transient.placement.size = transients[*found].placement.size;   // 取出的是原先的对象
+            pooled.erase(found);
         }
-    });
+        else stats.pooledBytes += transient.placement.size;
+        living.push_back(index);
+    }
+
+    stats.resourceCount = transients.size();
+    allocator->SetStats(stats);
 }
 
-void RDGBuilder::CreateOutputBarriers(RDGPassNodeRef pass)
+// 按pass顺序遍历一个资源的全部边一次，计算每条边的前序状态和资源的释放位置，结果和原先逐边扫描全部边的实现一致：
+// 1. 作为输入时，取之前最后一个有边覆盖该子资源的pass，pass内优先取最后一条输出边的状态，没有时取第一条
+// 2. 作为输出时，取本pass内覆盖该子资源的边，优先取最后一条输入边的状态，没有时取第一条
+// 3. 最后一个pass内有输出边时在第一条输出边处释放，否则在第一条资源->pass的边处释放
+// 子资源覆盖：任意一方为默认范围，或者范围完全一致
+template<typename EdgeType, typename IsDefaultFunc, typename IsSameFunc>
+static void CompileResourceStates(  std::vector<std::pair<EdgeType, RDGPassNodeRef>>& edges, 
+                                    IsDefaultFunc isDefault, 
+                                    IsSameFunc isSame,
+                                    std::vector<RDGEdgeState>& states)
 {
-    graph->ForEachTexture(pass, [&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
+    if(edges.empty()) return;
 
-        if(!edge->IsOutput()) return;
-        RHIResourceState previousState = PreviousState(texture, pass, edge->subresource, true);
-        //if(previousState != edge->state)  // 状态一样也加屏障？ 比如连续两个UAV读写的情况？
+    auto passOrder = [](const std::pair<EdgeType, RDGPassNodeRef>& a, const std::pair<EdgeType, RDGPassNodeRef>& b) { 
+        return a.second->ID() < b.second->ID(); 
+    };
+    if(!std::is_sorted(edges.begin(), edges.end(), passOrder)) std::stable_sort(edges.begin(), edges.end(), passOrder);
+
+    auto passEnd = [&](uint32_t begin) {
+        uint32_t end = begin;
+        while(end < edges.size() && edges[end].second == edges[begin].second) end++;
+        return end;
+    };
+    auto select = [&](EdgeType query, uint32_t begin, uint32_t end, bool preferOutput) -> EdgeType {
+        EdgeType first = nullptr;
+        EdgeType preferred = nullptr;
+        for(uint32_t i = begin; i < end; i++)
         {
-            RHITextureBarrier barrier = {
-                .texture = Resolve(texture),
-                .srcState = previousState,
-                .dstState = edge->state,
-                .subresource = edge->subresource   
-            };
-            command->TextureBarrier(barrier);
+            EdgeType edge = edges[i].first;
+            if(!(isDefault(query) || isDefault(edge) || isSame(query, edge))) continue;
+            if(first == nullptr) first = edge;
+            if(edge->IsOutput() == preferOutput) preferred = edge;
+        }
+        return preferred ? preferred : first;
+    };
 
-            // printf("rdg resource %lld, raw: %s barrier: %d to %d\n", (int64_t)texture->texture.get(), ToHex((uint64_t)texture->texture->RawHandle(), false).c_str(), (uint32_t)previousState, (uint32_t)edge->state);
+    int32_t lastAny = -1;                                       // 最后一个使用资源的pass，存其在edges中的起始下标
+    int32_t lastDefault = -1;                                   // 最后一个以默认范围使用资源的pass
+    std::vector<std::pair<EdgeType, int32_t>> lastRanges;       // 各个非默认范围最后出现的pass，范围的种类很少，线性查找即可
+
+    for(uint32_t begin = 0; begin < edges.size(); )
+    {
+        uint32_t end = passEnd(begin);
+
+        for(uint32_t i = begin; i < end; i++)
+        {
+            EdgeType edge = edges[i].first;
+            EdgeType previous = nullptr;
+            if(edge->IsOutput()) previous = select(edge, begin, end, false);
+            else
+            {
+                int32_t previousBegin = lastAny;
+                if(!isDefault(edge))
+                {
+                    previousBegin = lastDefault;
+                    for(auto& range : lastRanges)
+                    {
+                        if(isSame(range.first, edge)) { previousBegin = std::max(previousBegin, range.second); break; }
+                    }
+                }
+                if(previousBegin >= 0) previous = select(edge, previousBegin, passEnd(previousBegin), true);
+            }
+
+            RDGEdgeState& state = states[edge->ID()];
+            state.initState = previous == nullptr;
+            state.srcState = previous ? previous->state : RESOURCE_STATE_UNDEFINED;
+        }
+
+        for(uint32_t i = begin; i < end; i++)
+        {
+            EdgeType edge = edges[i].first;
+            if(isDefault(edge)) { lastDefault = begin; continue; }
+
+            bool found = false;
+            for(auto& range : lastRanges)
+            {
+                if(isSame(range.first, edge)) { range.second = begin; found = true; break; }
+            }
+            if(!found) lastRanges.push_back({edge, (int32_t)begin});
         }
+
+        lastAny = begin;
+        begin = end;
+    }
+
+    EdgeType releaseEdge = nullptr;
+    for(uint32_t i = lastAny; i < edges.size() && releaseEdge == nullptr; i++)
+    {
+        if(edges[i].first->IsOutput()) releaseEdge = edges[i].first;
+    }
+    for(uint32_t i = lastAny; i < edges.size() && releaseEdge == nullptr; i++)
+    {
+        if(edges[i].first->ToID() == edges[i].second->ID()) releaseEdge = edges[i].first;
+    }
+    if(releaseEdge == nullptr) releaseEdge = edges[lastAny].first;
+    states[releaseEdge->ID()].release = true;
+}
+
+void RDGBuilder::CompileTextureStates(std::vector<RDGEdgeState>& states)
+{
+    std::vector<std::pair<RDGTextureEdgeRef, RDGPassNodeRef>> edges;
+    for(auto& texture : graph->GetNodes<RDGTextureNode>())
+    {
+        edges.clear();
+        graph->ForEachPass(texture, [&](RDGTextureEdgeRef edge, RDGPassNodeRef pass){
+            if(!pass->isCulled) edges.emplace_back(edge, pass);
+        });
+
+        CompileResourceStates(  edges, 
+                                [](RDGTextureEdgeRef edge) { return edge->subresource.IsDefault(); },
+                                [](RDGTextureEdgeRef a, RDGTextureEdgeRef b) { return a->subresource == b->subresource; },
+                                states);
+    }
+}
+
+void RDGBuilder::CompileBufferStates(std::vector<RDGEdgeState>& states)
+{
+    std::vector<std::pair<RDGBufferEdgeRef, RDGPassNodeRef>> edges;
+    for(auto& buffer : graph->GetNodes<RDGBufferNode>())
+    {
+        edges.clear();
+        graph->ForEachPass(buffer, [&](RDGBufferEdgeRef edge, RDGPassNodeRef pass){
+            if(!pass->isCulled) edges.emplace_back(edge, pass);
+        });
+
+        CompileResourceStates(  edges, 
+                                [](RDGBufferEdgeRef edge) { return edge->offset == 0 && edge->size == 0; },
+                                [](RDGBufferEdgeRef a, RDGBufferEdgeRef b) { return a->offset == b->offset && a->size == b->size; },
+                                states);
+    }
+}
+
+void RDGBuilder::CompileBarriers(RDGPassNodeRef pass, const std::vector<RDGEdgeState>& states)
+{
+    // 屏障顺序和原先逐条录制时一致，同一批次的屏障在一次调用里提交
+    // 作用于同一资源重叠子资源的屏障需要保持先后顺序，另起一批
+    RDGCompiledPass& compiled = pass->compiled;
+    uint32_t batchBegin[4] = { 0, 0, 0, 0 };
+
+    graph->ForEachTexture(pass, [&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
+
+        const RDGEdgeState& state = states[edge->ID()];
+        auto& barriers = edge->IsOutput() ? compiled.outputTextureBarriers : compiled.inputTextureBarriers;
+        uint32_t& begin = batchBegin[edge->IsOutput() ? 1 : 0];
+
+        bool overlap = false;
+        for(uint32_t i = begin; i < barriers.size() && !overlap; i++)
+        {
+            RDGTextureEdgeRef other = barriers[i].edge;
+            overlap = barriers[i].texture == texture && 
+                      (other->subresource.IsDefault() || edge->subresource.IsDefault() || other->subresource == edge->subresource);
+        }
+        if(overlap) begin = barriers.size();
+        barriers.push_back({ texture, edge, state.srcState, state.initState, overlap });
+
+        if(state.release) compiled.releaseTextures.emplace_back(texture, edge->state);
     });
 
     graph->ForEachBuffer(pass, [&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
-        
-        if(!edge->IsOutput()) return;
-        RHIResourceState previousState = PreviousState(buffer, pass, true);
-        //if(previousState != edge->state)  // 状态一样也加屏障？ 比如连续两个UAV读写的情况？
-        {
-            RHIBufferBarrier barrier = {
-                .buffer = Resolve(buffer),
-                .srcState = previousState,
-                .dstState = edge->state,
-                .offset = edge->offset,
-                .size = edge->size
-            };
-            command->BufferBarrier(barrier);
 
-            // printf("rdg resource %lld, raw: %s barrier: %d to %d\n", (int64_t)buffer->buffer.get(), ToHex((uint64_t)buffer->buffer->RawHandle(), false).c_str(), (uint32_t)previousState, (uint32_t)edge->state);
+        const RDGEdgeState& state = states[edge->ID()];
+        auto& barriers = edge->IsOutput() ? compiled.outputBufferBarriers : compiled.inputBufferBarriers;
+        uint32_t& begin = batchBegin[edge->IsOutput() ? 3 : 2];
+
+        bool overlap = false;
+        for(uint32_t i = begin; i < barriers.size() && !overlap; i++)
+        {
+            RDGBufferEdgeRef other = barriers[i].edge;
+            overlap = barriers[i].buffer == buffer && 
+                      (other->size == 0 || edge->size == 0 ||      // size为0时一直到缓冲末尾
+                       (other->offset < edge->offset + edge->size && edge->offset < other->offset + other->size));
         }
+        if(overlap) begin = barriers.size();
+        barriers.push_back({ buffer, edge, state.srcState, state.initState, overlap });
+
+        if(state.release) compiled.releaseBuffers.emplace_back(buffer, edge->state);
     });
 }
 
+void RDGBuilder::PrepareBarriers(const std::vector<RDGTextureBarrierInfo>& infos, std::vector<std::vector<RHITextureBarrier>>& batches)
+{
+    batches.clear();
+    for(auto& info : infos)
+    {
+        if(batches.empty() || info.newBatch) batches.emplace_back();
+
+        RHITextureRef texture = Resolve(info.texture);      // 资源的初始状态在解析后才确定
+        batches.back().push_back({
+            .texture = texture,
+            .srcState = info.initState ? info.texture->initState : info.srcState,
+            .dstState = info.edge->state,
+            .subresource = info.edge->subresource,
+            .aliasing = info.initState && info.texture->IsPlaced() });
+    }
+}
+
+void RDGBuilder::PrepareBarriers(const std::vector<RDGBufferBarrierInfo>& infos, std::vector<std::vector<RHIBufferBarrier>>& batches)
+{
+    batches.clear();
+    for(auto& info : infos)
+    {
+        if(batches.empty() || info.newBatch) batches.emplace_back();
+
+        RHIBufferRef buffer = Resolve(info.buffer);
+        batches.back().push_back({
+            .buffer = buffer,
+            .srcState = info.initState ? info.buffer->initState : info.srcState,
+            .dstState = info.edge->state,
+            .offset = info.edge->offset,
+            .size = info.edge->size,
+            .aliasing = info.initState && info.buffer->IsPlaced() });
+    }
+}
+
+void RDGBuilder::CreateBarriers(RDGPassNodeRef pass, RHICommandListRef command, uint32_t output)
+{
+    for(auto& batch : pass->prepared.textureBarriers[output]) command->TextureBarriers(batch);
+    for(auto& batch : pass->prepared.bufferBarriers[output])  command->BufferBarriers(batch);
+}
+
 void RDGBuilder::PrepareDescriptorSet(RDGPassNodeRef pass)
 {
+    // 先按set收集全部写入，每个set只分配一次并合并为一次提交
+    std::array<std::vector<RHIDescriptorUpdateInfo>, MAX_DESCRIPTOR_SETS> writes;
+    std::array<bool, MAX_DESCRIPTOR_SETS> used = {};
+
     graph->ForEachTexture(pass, [&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
 
         if(edge->IsOutput()) return;    // 作为output声明时不需要view
@@ -285,70 +625,59 @@ void RDGBuilder::PrepareDescriptorSet(RDGPassNodeRef pass)
             .subresource = edge->subresource}).textureView;
         pass->pooledViews.push_back(view);
 
-        if(pass->descriptorSets[edge->set] == nullptr && pass->rootSignature != nullptr)
+        used[edge->set] = true;
+        if(edge->asShaderRead || edge->asShaderReadWrite)
         {
-            auto descriptor = RDGDescriptorSetPool::Get(EngineContext::ThreadPool()->ThreadFrameIndex())->Allocate(pass->rootSignature, edge->set).descriptor;
-            pass->descriptorSets[edge->set] = descriptor;
-            pass->pooledDescriptorSets.push_back({descriptor, edge->set});
-        }
-
-        if((edge->asShaderRead || edge->asShaderReadWrite) && 
-            pass->descriptorSets[edge->set] != nullptr)    
-        {
-            RHIDescriptorUpdateInfo updateInfo = {
+            writes[edge->set].push_back({
                 .binding = edge->binding,
                 .index = edge->index,
                 .resourceType = edge->type,
                 .textureView = view
-            };
-            pass->descriptorSets[edge->set]->UpdateDescriptor(updateInfo);        
+            });
         }
     });
 
     graph->ForEachBuffer(pass, [&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
 
-        if(pass->descriptorSets[edge->set] == nullptr && pass->rootSignature != nullptr)
+        used[edge->set] = true;
+        if(edge->asShaderRead || edge->asShaderReadWrite)
         {
-            auto descriptor = RDGDescriptorSetPool::Get(EngineContext::ThreadPool()->ThreadFrameIndex())->Allocate(pass->rootSignature, edge->set).descriptor;
-            pass->descriptorSets[edge->set] = descriptor;
-            pass->pooledDescriptorSets.push_back({descriptor, edge->set});
-        }
-
-        if((edge->asShaderRead || edge->asShaderReadWrite) && 
-            pass->descriptorSets[edge->set] != nullptr)
-        {
-            RHIDescriptorUpdateInfo updateInfo = {
+            writes[edge->set].push_back({
                 .binding = edge->binding,
                 .index = edge->index,
                 .resourceType = edge->type,
                 .buffer = Resolve(buffer),
                 .bufferOffset = edge->offset,
                 .bufferRange = edge->size
-            };
-
-            pass->descriptorSets[edge->set]->UpdateDescriptor(updateInfo); 
+            });
         }
     });
 
     for(auto& sampler : pass->samplers)
     {
-        if(pass->descriptorSets[sampler.set] == nullptr && pass->rootSignature != nullptr)
+        used[sampler.set] = true;
+        writes[sampler.set].push_back({
+            .binding = sampler.binding,
+            .index = sampler.index,
+            .resourceType = RESOURCE_TYPE_SAMPLER,
+            .sampler = sampler.sampler
+        });
+    }
+
+    for(uint32_t set = 0; set < MAX_DESCRIPTOR_SETS; set++)
+    {
+        if(!used[set]) continue;
+
+        if(pass->descriptorSets[set] == nullptr && pass->rootSignature != nullptr)
         {
-            auto descriptor = RDGDescriptorSetPool::Get(EngineContext::ThreadPool()->ThreadFrameIndex())->Allocate(pass->rootSignature, sampler.set).descriptor;
-            pass->descriptorSets[sampler.set] = descriptor;
-            pass->pooledDescriptorSets.push_back({descriptor, sampler.set});
+            // 池化的描述符上次写入的内容相同时直接复用，不需要重新写入
+            auto pooled = RDGDescriptorSetPool::Get(EngineContext::ThreadPool()->ThreadFrameIndex())->Allocate(pass->rootSignature, set, writes[set]);
+            pass->descriptorSets[set] = pooled.descriptor;
+            pass->pooledDescriptorSets.push_back({pooled, set});
         }
-
-        if(pass->descriptorSets[sampler.set] != nullptr)
+        else if(pass->descriptorSets[set] != nullptr && !writes[set].empty())
         {
-            RHIDescriptorUpdateInfo updateInfo = {
-                .binding = sampler.binding,
-                .index = sampler.index,
-                .resourceType = RESOURCE_TYPE_SAMPLER,
-                .sampler = sampler.sampler
-            };
-
-            pass->descriptorSets[sampler.set]->UpdateDescriptor(updateInfo); 
+            pass->descriptorSets[set]->UpdateDescriptors(writes[set]);
         }
     }
 }
@@ -399,13 +728,8 @@ void RDGBuilder::PrepareRenderTarget(RDGRenderPassNodeRef pass, RHIRenderPassInf
 
 void RDGBuilder::ReleaseResource(RDGPassNodeRef pass)
 {
-    pass->ForEachTexture([&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
-        if(IsLastUsedPass(texture, pass, edge->IsOutput())) Release(texture, edge->state);
-    });
-
-    pass->ForEachBuffer([&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
-        if(IsLastUsedPass(buffer, pass, edge->IsOutput())) Release(buffer, edge->state);
-    });
+    for(auto& release : pass->compiled.releaseTextures) Release(release.first, release.second);
+    for(auto& release : pass->compiled.releaseBuffers)  Release(release.first, release.second);
 
     for(auto& view : pass->pooledViews)
     {
@@ -414,26 +738,204 @@ void RDGBuilder::ReleaseResource(RDGPassNodeRef pass)
     pass->pooledViews.clear();
 }
 
-void RDGBuilder::ExecutePass(RDGRenderPassNodeRef pass)
+void RDGBuilder::PreparePass(RDGPassNodeRef pass)
 {
-    ENGINE_TIME_SCOPE_STR("RDGBuilder::ExecutePass::" + pass->Name());
-
     // 根据各个资源依赖的edge收集描述符更新信息以及framebuffer信息，
     // 调用Resolve()来分配和获取实际的RHI资源，资源将在最后一个使用的pass之后返回资源池
-    // 处理状态转换的屏障
+    // 处理状态转换的屏障，录制时只使用这里解析好的结果
+    switch (pass->NodeType()) {
+    case RDG_PASS_NODE_TYPE_RENDER:         PreparePass(dynamic_cast<RDGRenderPassNodeRef>(pass));      break; 
+    case RDG_PASS_NODE_TYPE_COMPUTE:        
+    case RDG_PASS_NODE_TYPE_RAY_TRACING:    PrepareDescriptorSet(pass);                                 break; 
+    case RDG_PASS_NODE_TYPE_PRESENT:        PreparePass(dynamic_cast<RDGPresentPassNodeRef>(pass));     break; 
+    case RDG_PASS_NODE_TYPE_COPY:           PreparePass(dynamic_cast<RDGCopyPassNodeRef>(pass));        break; 
+    default:                                ENGINE_LOG_FATAL("Unsupported RDG pass type!");
+    }
 
+    const RDGCompiledPass& compiled = pass->compiled;
+    RDGPreparedPass& prepared = pass->prepared;
+    PrepareBarriers(compiled.inputTextureBarriers, prepared.textureBarriers[0]);
+    PrepareBarriers(compiled.inputBufferBarriers, prepared.bufferBarriers[0]);
+    PrepareBarriers(compiled.outputTextureBarriers, prepared.textureBarriers[1]);
+    PrepareBarriers(compiled.outputBufferBarriers, prepared.bufferBarriers[1]);
+
+    ReleaseResource(pass);      // 后续pass的准备可以复用这里归还的资源，和原先逐个pass执行时的分配顺序一致
+}
+
+void RDGBuilder::PreparePass(RDGRenderPassNodeRef pass)
+{
     PrepareDescriptorSet(pass);
 
     RHIRenderPassInfo renderPassInfo = {};
     PrepareRenderTarget(pass, renderPassInfo);
 
-    RHIRenderPassRef renderPass = EngineContext::RHI()->CreateRenderPass(renderPassInfo);   // renderPass和frameBuffer是在RHI层做的池化
+    pass->renderPass = EngineContext::RHI()->CreateRenderPass(renderPassInfo);   // renderPass和frameBuffer是在RHI层做的池化
+}
+
+void RDGBuilder::PreparePass(RDGPresentPassNodeRef pass)
+{
+    RDGTextureNodeRef presentTexture;
+    RDGTextureNodeRef texture;
+
+    auto edges = pass->InEdges<RDGTextureEdge>();
+    if(edges[0]->asPresent)
+    {
+        presentTexture = edges[0]->From<RDGTextureNode>();
+        texture = edges[1]->From<RDGTextureNode>();
+        pass->subresource = edges[1]->subresource.aspect == TEXTURE_ASPECT_NONE ? 
+                            Resolve(texture)->GetDefaultSubresourceLayers() : edges[1]->subresourceLayer;
+    }
+    else 
+    {
+        presentTexture = edges[1]->From<RDGTextureNode>();
+        texture = edges[0]->From<RDGTextureNode>();
+        pass->subresource = edges[0]->subresource.aspect == TEXTURE_ASPECT_NONE ? 
+                            Resolve(texture)->GetDefaultSubresourceLayers() : edges[0]->subresourceLayer;
+    }
+
+    pass->presentTexture = Resolve(presentTexture);
+    pass->texture = Resolve(texture);
+}
+
+void RDGBuilder::PreparePass(RDGCopyPassNodeRef pass)
+{
+    pass->bufferFrom = nullptr;
+    pass->bufferTo = nullptr;
+    pass->textureFrom = nullptr;
+    pass->textureTo = nullptr;
+
+    pass->ForEachBuffer([&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
+
+        if(edge->asTransferSrc)
+        {
+            pass->bufferFrom = Resolve(buffer);
+            pass->offsetFrom = edge->offset;
+            pass->size = edge->size;
+        }
+        else if(edge->asTransferDst)
+        {
+            pass->bufferTo = Resolve(buffer);
+            pass->offsetTo = edge->offset;
+            pass->size = edge->size;
+        }
+    });
+
+    pass->ForEachTexture([&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
+
+        if(edge->asTransferSrc)
+        {
+            pass->textureFrom = Resolve(texture);
+            pass->fromSubresource = edge->subresourceLayer;
+        }
+        else if(edge->asTransferDst)
+        {
+            pass->textureTo = Resolve(texture);
+            pass->toSubresource = edge->subresourceLayer;
+        }
+    });
+}
+
+void RDGBuilder::RecordPasses(const std::vector<RDGPassNodeRef>& executePasses)
+{
+    recordedCommands.clear();
+    if(executePasses.empty()) return;
+
+    struct RecordChunk
+    {
+        uint32_t begin;
+        uint32_t end;
+        bool mainThread;        // 只在当前线程上录制
+        uint32_t count = 1;     // 并行区间再切成的段数
+    };
+
+    // 按标记切成连续的区间，过短的未标记区间不值得调度，也并入主线程录制
+    std::vector<RecordChunk> spans;
+    for(uint32_t i = 0; i < executePasses.size(); i++)
+    {
+        bool mainThread = executePasses[i]->recordOnMainThread;
+        if(spans.empty() || spans.back().mainThread != mainThread)  spans.push_back({ i, i + 1, mainThread });
+        else                                                        spans.back().end = i + 1;
+    }
+    for(auto& span : spans) if(span.end - span.begin < MIN_RDG_PASSES_PER_CHUNK) span.mainThread = true;
+
+    std::vector<RecordChunk> merged;
+    for(auto& span : spans)
+    {
+        if(!merged.empty() && merged.back().mainThread && span.mainThread)  merged.back().end = span.end;
+        else                                                                merged.push_back(span);
+    }
+    spans.swap(merged);
+
+    // 每个区间至少一段，剩余的指令列表分给平均段长最大的并行区间
+    uint32_t maxChunks = 1;
+#if ENABLE_RDG_PARALLEL_RECORDING
+    maxChunks = workerCommands.size() + 1;
+#endif
+    if(spans.size() > maxChunks) spans = { { 0, (uint32_t)executePasses.size(), true } };
+    for(uint32_t remain = maxChunks - spans.size(); remain > 0; remain--)
+    {
+        RecordChunk* best = nullptr;
+        for(auto& span : spans)
+        {
+            uint32_t size = span.end - span.begin;
+            if(span.mainThread || size / (span.count + 1) < MIN_RDG_PASSES_PER_CHUNK) continue;
+            if(!best || size * best->count > (best->end - best->begin) * span.count) best = &span;
+        }
+        if(!best) break;
+        best->count++;
+    }
+
+    std::vector<RecordChunk> chunks;
+    for(auto& span : spans)
+    {
+        uint32_t size = span.end - span.begin;
+        for(uint32_t i = 0; i < span.count; i++) chunks.push_back({ span.begin + size * i / span.count, span.begin + size * (i + 1) / span.count, span.mainThread });
+    }
+
+    // 第一段录制到command，其余段按顺序录制到各自的workerCommands
+    // 段之间没有额外的同步，屏障都已在准备阶段解析好，各段按顺序提交后与串行录制的结果一致
+    recordedCommands.assign(workerCommands.begin(), workerCommands.begin() + (chunks.size() - 1));
+    auto record = [&](uint32_t chunk) {
+
+        RHICommandListRef chunkCommand = chunk == 0 ? command : recordedCommands[chunk - 1];
+        if(chunk != 0) chunkCommand->BeginCommand();
+        for(uint32_t i = chunks[chunk].begin; i < chunks[chunk].end; i++) ExecutePass(executePasses[i], chunkCommand);
+        if(chunk != 0) chunkCommand->EndCommand();
+    };
+
+    // 连续的并行段一起交给线程池，主线程段等之前的段录制完再录制，执行函数看到的状态和串行录制时一致
+    uint32_t first = 0;
+    for(uint32_t chunk = 0; chunk <= chunks.size(); chunk++)
+    {
+        if(chunk < chunks.size() && !chunks[chunk].mainThread) continue;
+
+        if(chunk > first) EngineContext::ThreadPool()->ParallelFor(chunk - first, [&](uint32_t index){ record(first + index); });
+        if(chunk < chunks.size()) record(chunk);
+        first = chunk + 1;
+    }
+}
+
+void RDGBuilder::ExecutePass(RDGPassNodeRef pass, RHICommandListRef command)
+{
+    switch (pass->NodeType()) {
+    case RDG_PASS_NODE_TYPE_RENDER:         ExecutePass(dynamic_cast<RDGRenderPassNodeRef>(pass), command);         break; 
+    case RDG_PASS_NODE_TYPE_COMPUTE:        ExecutePass(dynamic_cast<RDGComputePassNodeRef>(pass), command);        break; 
+    case RDG_PASS_NODE_TYPE_RAY_TRACING:    ExecutePass(dynamic_cast<RDGRayTracingPassNodeRef>(pass), command);     break; 
+    case RDG_PASS_NODE_TYPE_PRESENT:        ExecutePass(dynamic_cast<RDGPresentPassNodeRef>(pass), command);        break; 
+    case RDG_PASS_NODE_TYPE_COPY:           ExecutePass(dynamic_cast<RDGCopyPassNodeRef>(pass), command);           break; 
+    default:                                ENGINE_LOG_FATAL("Unsupported RDG pass type!");
+    }
+}
+
+void RDGBuilder::ExecutePass(RDGRenderPassNodeRef pass, RHICommandListRef command)
+{
+    ENGINE_TIME_SCOPE_STR("RDGBuilder::ExecutePass::", pass->Name());
 
     command->PushEvent(pass->Name(), {0.0f, 0.0f, 0.0f});
 
-    CreateInputBarriers(pass);
+    CreateBarriers(pass, command, 0);
 
-    command->BeginRenderPass(renderPass);
+    command->BeginRenderPass(pass->renderPass);
 
     RDGPassContext context = {
         .command = command,
@@ -443,26 +945,22 @@ void RDGBuilder::ExecutePass(RDGRenderPassNodeRef pass)
     context.passIndex[0] = pass->passIndex[0];
     context.passIndex[1] = pass->passIndex[1];
     context.passIndex[2] = pass->passIndex[2];
-    pass->execute(context);
+    if(pass->execute) pass->execute(context);
 
     command->EndRenderPass();
 
-    CreateOutputBarriers(pass);
-
-    ReleaseResource(pass);
+    CreateBarriers(pass, command, 1);
 
     command->PopEvent();
 }
 
-void RDGBuilder::ExecutePass(RDGComputePassNodeRef pass)
+void RDGBuilder::ExecutePass(RDGComputePassNodeRef pass, RHICommandListRef command)
 {
-    ENGINE_TIME_SCOPE_STR("RDGBuilder::ExecutePass::" + pass->Name());
-
-    PrepareDescriptorSet(pass);
+    ENGINE_TIME_SCOPE_STR("RDGBuilder::ExecutePass::", pass->Name());
 
     command->PushEvent(pass->Name(), {1.0f, 0.0f, 0.0f});
 
-    CreateInputBarriers(pass);
+    CreateBarriers(pass, command, 0);
 
     RDGPassContext context = {
         .command = command,
@@ -472,24 +970,20 @@ void RDGBuilder::ExecutePass(RDGComputePassNodeRef pass)
     context.passIndex[0] = pass->passIndex[0];
     context.passIndex[1] = pass->passIndex[1];
     context.passIndex[2] = pass->passIndex[2];
-    pass->execute(context);
-
-    CreateOutputBarriers(pass);
+    if(pass->execute) pass->execute(context);
 
-    ReleaseResource(pass);
+    CreateBarriers(pass, command, 1);
 
     command->PopEvent();
 }
 
-void RDGBuilder::ExecutePass(RDGRayTracingPassNodeRef pass)
+void RDGBuilder::ExecutePass(RDGRayTracingPassNodeRef pass, RHICommandListRef command)
 {
-    ENGINE_TIME_SCOPE_STR("RDGBuilder::ExecutePass::" + pass->Name());
-
-    PrepareDescriptorSet(pass);
+    ENGINE_TIME_SCOPE_STR("RDGBuilder::ExecutePass::", pass->Name());
 
     command->PushEvent(pass->Name(), {0.0f, 1.0f, 0.0f});
 
-    CreateInputBarriers(pass);
+    CreateBarriers(pass, command, 0);
 
     RDGPassContext context = {
         .command = command,
@@ -499,124 +993,59 @@ void RDGBuilder::ExecutePass(RDGRayTracingPassNodeRef pass)
     context.passIndex[0] = pass->passIndex[0];
     context.passIndex[1] = pass->passIndex[1];
     context.passIndex[2] = pass->passIndex[2];
-    pass->execute(context);
-
-    CreateOutputBarriers(pass);
+    if(pass->execute) pass->execute(context);
 
-    ReleaseResource(pass);
+    CreateBarriers(pass, command, 1);
 
     command->PopEvent();
 }
 
-void RDGBuilder::ExecutePass(RDGPresentPassNodeRef pass)
+void RDGBuilder::ExecutePass(RDGPresentPassNodeRef pass, RHICommandListRef command)
 {  
-    RDGTextureNodeRef presentTexture;
-    RDGTextureNodeRef texture;
-    TextureSubresourceLayers subresource;
-
-    auto edges = pass->InEdges<RDGTextureEdge>();
-    if(edges[0]->asPresent)
-    {
-        presentTexture = edges[0]->From<RDGTextureNode>();
-        texture = edges[1]->From<RDGTextureNode>();
-        subresource = edges[1]->subresource.aspect == TEXTURE_ASPECT_NONE ? 
-                        Resolve(texture)->GetDefaultSubresourceLayers() : edges[1]->subresourceLayer;
-    }
-    else 
-    {
-        presentTexture = edges[1]->From<RDGTextureNode>();
-        texture = edges[0]->From<RDGTextureNode>();
-        subresource = edges[0]->subresource.aspect == TEXTURE_ASPECT_NONE ? 
-                        Resolve(texture)->GetDefaultSubresourceLayers() : edges[0]->subresourceLayer;
-    }
-
     command->PushEvent(pass->Name(), {0.0f, 0.0f, 1.0f});
 
-    CreateInputBarriers(pass);
-
-    command->TextureBarrier({Resolve(presentTexture), RESOURCE_STATE_PRESENT, RESOURCE_STATE_TRANSFER_DST});
-    command->CopyTexture(   Resolve(texture), subresource, 
-                            Resolve(presentTexture), {TEXTURE_ASPECT_COLOR, 0, 0, 1});
-    command->TextureBarrier({Resolve(presentTexture), RESOURCE_STATE_TRANSFER_DST, RESOURCE_STATE_PRESENT});
+    CreateBarriers(pass, command, 0);
 
-    CreateOutputBarriers(pass);
+    command->TextureBarrier({pass->presentTexture, RESOURCE_STATE_PRESENT, RESOURCE_STATE_TRANSFER_DST});
+    command->CopyTexture(   pass->texture, pass->subresource, 
+                            pass->presentTexture, {TEXTURE_ASPECT_COLOR, 0, 0, 1});
+    command->TextureBarrier({pass->presentTexture, RESOURCE_STATE_TRANSFER_DST, RESOURCE_STATE_PRESENT});
 
-    ReleaseResource(pass);
+    CreateBarriers(pass, command, 1);
 
     command->PopEvent();
 }
 
-void RDGBuilder::ExecutePass(RDGCopyPassNodeRef pass)
+void RDGBuilder::ExecutePass(RDGCopyPassNodeRef pass, RHICommandListRef command)
 {
-    RDGBufferNodeRef bufferFrom = nullptr;
-    RDGBufferNodeRef bufferTo = nullptr;
-    uint32_t offsetFrom;
-    uint32_t offsetTo;
-    uint32_t size;
-
-    RDGTextureNodeRef textureFrom = nullptr;
-    RDGTextureNodeRef textureTo = nullptr;
-    TextureSubresourceLayers fromSubresource;
-    TextureSubresourceLayers toSubresource;
-
-    pass->ForEachBuffer([&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
-
-        if(edge->asTransferSrc)
-        {
-            bufferFrom = buffer;
-            offsetFrom = edge->offset;
-            size = edge->size;
-        }
-        else if(edge->asTransferDst)
-        {
-            bufferTo = buffer;
-            offsetTo = edge->offset;
-            size = edge->size;
-        }
-    });
-
-    pass->ForEachTexture([&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
-
-        if(edge->asTransferSrc)
-        {
-            textureFrom = texture;
-            fromSubresource = edge->subresourceLayer;
-        }
-        else if(edge->asTransferDst)
-        {
-            textureTo = texture;
-            toSubresource = edge->subresourceLayer;
-        }
-    });
-
     command->PushEvent(pass->Name(), {1.0f, 1.0f, 0.0f});
 
-    CreateInputBarriers(pass);
+    CreateBarriers(pass, command, 0);
 
-    if(bufferFrom != nullptr && bufferTo != nullptr)
+    if(pass->bufferFrom != nullptr && pass->bufferTo != nullptr)
     {
-        command->CopyBuffer(Resolve(bufferFrom), offsetFrom, 
-                            Resolve(bufferTo), offsetTo, size);
+        command->CopyBuffer(pass->bufferFrom, pass->offsetFrom, 
+                            pass->bufferTo, pass->offsetTo, pass->size);
     }
 
-    if(textureFrom != nullptr && textureTo != nullptr)
+    if(pass->textureFrom != nullptr && pass->textureTo != nullptr)
     {
-        command->CopyTexture(   Resolve(textureFrom), fromSubresource, 
-                                Resolve(textureTo), toSubresource);
+        command->CopyTexture(   pass->textureFrom, pass->fromSubresource, 
+                                pass->textureTo, pass->toSubresource);
 
         if(pass->generateMip) 
         {
             RHITextureBarrier barrier = {
-                .texture = Resolve(textureTo),
+                .texture = pass->textureTo,
                 .srcState = RESOURCE_STATE_TRANSFER_DST,
                 .dstState = RESOURCE_STATE_TRANSFER_SRC,
                 .subresource = {} 
             };
             command->TextureBarrier(barrier);
-            command->GenerateMips(Resolve(textureTo)); // 默认纹理处于src状态，需要手动加屏障
+            command->GenerateMips(pass->textureTo); // 默认纹理处于src状态，需要手动加屏障
 
             barrier = {
-                .texture = Resolve(textureTo),
+                .texture = pass->textureTo,
                 .srcState = RESOURCE_STATE_TRANSFER_SRC,
                 .dstState = RESOURCE_STATE_TRANSFER_DST,
                 .subresource = {} 
@@ -625,15 +1054,18 @@ void RDGBuilder::ExecutePass(RDGCopyPassNodeRef pass)
         }
     }
 
-    CreateOutputBarriers(pass);
-
-    ReleaseResource(pass);
+    CreateBarriers(pass, command, 1);
 
     command->PopEvent();
 }
 
 RHITextureRef RDGBuilder::Resolve(RDGTextureNodeRef textureNode)
 {   
+    if(textureNode->texture == nullptr && textureNode->IsPlaced())
+    {
+        textureNode->texture = RDGTransientAllocator::Get()->GetTexture(textureNode->info, textureNode->heap, textureNode->heapOffset);
+        textureNode->initState = RESOURCE_STATE_UNDEFINED;      // 这段内存可能刚被其他资源使用过，内容无效
+    }
     if(textureNode->texture == nullptr)
     {
         auto pooledTexture = RDGTexturePool::Get()->Allocate(textureNode->info);
@@ -651,6 +1083,11 @@ RHITextureRef RDGBuilder::Resolve(RDGTextureNodeRef textureNode)
 
 RHIBufferRef RDGBuilder::Resolve(RDGBufferNodeRef bufferNode)
 {
+    if(bufferNode->buffer == nullptr && bufferNode->IsPlaced())
+    {
+        bufferNode->buffer = RDGTransientAllocator::Get()->GetBuffer(bufferNode->info, bufferNode->heap, bufferNode->heapOffset);
+        bufferNode->initState = RESOURCE_STATE_UNDEFINED;
+    }
     if(bufferNode->buffer == nullptr)
     {
         auto pooledBuffer = RDGBufferPool::Get()->Allocate(bufferNode->info);
@@ -672,7 +1109,7 @@ void RDGBuilder::Release(RDGTextureNodeRef textureNode, RHIResourceState state)
     {
         // printf("rdg resource %s released: %lld, raw: %s\n", textureNode->Name().c_str(), (int64_t)textureNode->texture.get(), ToHex((uint64_t)textureNode->texture->RawHandle(), false).c_str());
 
-        RDGTexturePool::Get()->Release({ textureNode->texture, state});
+        if(!textureNode->IsPlaced()) RDGTexturePool::Get()->Release({ textureNode->texture, state});     // 放置资源由RDGTransientAllocator持有
         textureNode->texture = nullptr;
         textureNode->initState = RESOURCE_STATE_UNDEFINED;
     }
@@ -686,104 +1123,12 @@ void RDGBuilder::Release(RDGBufferNodeRef bufferNode, RHIResourceState state)
     {
         // printf("rdg resource %s released: %lld, raw: %s\n", bufferNode->Name().c_str(), (int64_t)bufferNode->buffer.get(), ToHex((uint64_t)bufferNode->buffer->RawHandle(), false).c_str());
 
-        RDGBufferPool::Get()->Release({ bufferNode->buffer, state});
+        if(!bufferNode->IsPlaced()) RDGBufferPool::Get()->Release({ bufferNode->buffer, state});
         bufferNode->buffer = nullptr;
         bufferNode->initState = RESOURCE_STATE_UNDEFINED;
     }
 }
 
-RHIResourceState RDGBuilder::PreviousState(RDGTextureNodeRef textureNode, RDGPassNodeRef passNode, TextureSubresourceRange subresource, bool output)
-{
-    Resolve(textureNode);
-    NodeID currentID = passNode->ID();
-    NodeID previousID = UINT32_MAX;
-
-    RHIResourceState previousState = textureNode->initState;        // 若没有前序引用，那状态就是资源本身的初始状态
-
-    graph->ForEachPass(textureNode, [&](RDGTextureEdgeRef edge, RDGPassNodeRef pass){
-
-        bool isOutputFirst = output ? !edge->IsOutput() : edge->IsOutput();
-        bool isPrevoiusPass = output ? pass->ID() <= currentID : pass->ID() < currentID;
-        bool isSubresourceCovered = subresource.IsDefault() ||                      // 无状态地追踪整个子资源状态实在有些困难，现在支持的方法是：
-                                    edge->subresource.IsDefault() ||                // 1. 若目标状态是默认范围，那只追踪前序最近的状态
-                                    subresource == edge->subresource;               // 2. 若目标状态是子范围，那必须追踪前序最近的完全一致的子范围/默认范围的状态
-                                                                                    // 再合理利用output的手动屏障，应该能够完成全部子范围的管理
-        if(!(isPrevoiusPass && isSubresourceCovered)) return;
-        if(pass->ID() > previousID || previousID == UINT32_MAX)     // 不同的前序pass，取最后一个的状态
-        {
-            previousState = edge->state;
-            previousID = pass->ID();
-        }
-        else if(pass->ID() == previousID &&                         // 同一个前序pass，考虑取输入or输出状态
-                isOutputFirst)           
-        {    
-            previousState = edge->state;
-            previousID = pass->ID();
-        }   
-    });
-
-    return previousState;
-}   
-
-RHIResourceState RDGBuilder::PreviousState(RDGBufferNodeRef bufferNode, RDGPassNodeRef passNode, uint32_t offset, uint32_t size, bool output)
-{
-    Resolve(bufferNode);
-    NodeID currentID = passNode->ID();
-    NodeID previousID = UINT32_MAX;
-
-    RHIResourceState previousState = bufferNode->initState;         // 若没有前序引用，那状态就是资源本身的初始状态
-
-    graph->ForEachPass(bufferNode, [&](RDGBufferEdgeRef edge, RDGPassNodeRef pass){
-
-        bool isOutputFirst = output ? !edge->IsOutput() : edge->IsOutput();
-        bool isPrevoiusPass = output ? pass->ID() <= currentID : pass->ID() < currentID;
-        bool isSubresourceCovered = (offset == 0 && size == 0) || 
-                                    (edge->offset == 0 && edge->size == 0) || 
-                                    (offset == edge->offset && size == edge->size);  // 同texture里的策略
-        
-        if(!(isPrevoiusPass && isSubresourceCovered)) return;
-        if(pass->ID() > previousID || previousID == UINT32_MAX)     // 不同的前序pass，取最后一个的状态
-        {
-            previousState = edge->state;
-            previousID = pass->ID();
-        }
-        else if(pass->ID() == previousID &&                         // 同一个前序pass，考虑取输入or输出状态
-                isOutputFirst)           
-        {    
-            previousState = edge->state;
-            previousID = pass->ID();
-        }   
-    });
-
-    return previousState;
-}
-
-bool RDGBuilder::IsLastUsedPass(RDGTextureNodeRef textureNode, RDGPassNodeRef passNode, bool output)
-{
-    NodeID currentID = passNode->ID();
-    bool last = true;
-
-    graph->ForEachPass(textureNode, [&](RDGTextureEdgeRef edge, RDGPassNodeRef pass){
-        if(pass->ID() > currentID) last = false;
-        if(!output && pass->ID() == currentID && edge->IsOutput()) last = false;
-    });
-
-    return last;
-}
-
-bool RDGBuilder::IsLastUsedPass(RDGBufferNodeRef bufferNode, RDGPassNodeRef passNode, bool output)
-{
-    NodeID currentID = passNode->ID();
-    bool last = true;
-
-    graph->ForEachPass(bufferNode, [&](RDGBufferEdgeRef edge, RDGPassNodeRef pass){
-        if(pass->ID() > currentID) last = false;
-        if(!output && pass->ID() == currentID && edge->IsOutput()) last = false;
-    });
-
-    return last;
-}
-
 RDGTextureBuilder& RDGTextureBuilder::Import(RHITextureRef texture, RHIResourceState initState)
 {
     if(validationMode)
@@ -1223,6 +1568,12 @@ RDGRenderPassBuilder& RDGRenderPassBuilder::Execute(const RDGPassExecuteFunc& ex
     return *this;
 }
 
+RDGRenderPassBuilder& RDGRenderPassBuilder::RecordOnMainThread()
+{
+    pass->recordOnMainThread = true;
+    return *this;
+}
+
 RDGComputePassBuilder& RDGComputePassBuilder::PassIndex(uint32_t x, uint32_t y, uint32_t z)
 {
     pass->passIndex[0] = x;
@@ -1391,6 +1742,12 @@ RDGComputePassBuilder& RDGComputePassBuilder::Execute(const RDGPassExecuteFunc&
     return *this;
 }
 
+RDGComputePassBuilder& RDGComputePassBuilder::RecordOnMainThread()
+{
+    pass->recordOnMainThread = true;
+    return *this;
+}
+
 RDGRayTracingPassBuilder& RDGRayTracingPassBuilder::PassIndex(uint32_t x, uint32_t y, uint32_t z)
 {
     pass->passIndex[0] = x;
@@ -1546,6 +1903,12 @@ RDGRayTracingPassBuilder& RDGRayTracingPassBuilder::Execute(const RDGPassExecute
     return *this;
 }
 
+RDGRayTracingPassBuilder& RDGRayTracingPassBuilder::RecordOnMainThread()
+{
+    pass->recordOnMainThread = true;
+    return *this;
+}
+
 RDGPresentPassBuilder& RDGPresentPassBuilder::Texture(RDGTextureHandle texture, TextureSubresourceLayers subresource)
 {
     RDGTextureEdgeRef edge = graph->CreateEdge<RDGTextureEdge>();
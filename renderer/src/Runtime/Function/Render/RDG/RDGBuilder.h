@@ -32,6 +32,14 @@ private:
     std::unordered_map<std::string, RDGTextureNodeRef> textures;
 };
 
+typedef struct RDGEdgeState  // 编译阶段每条边的结果，按边ID索引
+{
+    RHIResourceState srcState = RESOURCE_STATE_UNDEFINED;
+    bool initState = true;      // 没有前序引用
+    bool release = false;       // 资源在该边之后返回资源池
+
+} RDGEdgeState;
+
 // UE中的RDG：
 // 每个pass一个cpp文件 有graphbuilder的构建回调函数，
 // meshpass继承pass，多一个获取场景meshbatch的回调函数
@@ -40,13 +48,18 @@ private:
 // 状态设置等信息由一个parameters结构体描述，这个结构体的生命周期也应该与RDG一致（单帧），builder会给一个allocateParameters函数来返回
 
 // 目前的RDG只实现了最基本的功能，相当多特性还未完成，例如：
-// pass排序，pass剔除，多线程录制，multi queue，资源池GC，细粒度的资源处理（内存对齐，subresource屏障等），……
+// pass排序，multi queue，资源池GC，细粒度的资源处理（内存对齐，subresource屏障等），……
+// Execute前会先Compile：剔除输出没有被使用的pass，对每个资源的使用列表只遍历一次，预计算各个pass的屏障批次和资源的释放位置
+// 再按临时资源的生命周期把它们放置到共享的heap上，生命周期不重叠的资源复用同一段显存
+// Execute分两步：先按顺序准备各pass（分配资源和描述符，解析屏障，创建render pass），再把pass列表切成连续的若干段并行录制，声明了RecordOnMainThread的pass在主线程上录制
+// 每段的屏障都在段内，提交时各段按顺序合并为一次提交，前一段的屏障对后一段同样有效
 class RDGBuilder
 {
 public:
     RDGBuilder() = delete;
-    RDGBuilder(RHICommandListRef command)
+    RDGBuilder(RHICommandListRef command, std::vector<RHICommandListRef> workerCommands = {})     // workerCommands用于并行录制，需来自不同的指令池
     : command(command)
+    , workerCommands(workerCommands)
     {}
     
     ~RDGBuilder() {};
@@ -71,19 +84,35 @@ public:
 
     RDGDependencyGraphRef GetGraph() { return graph; }
 
-    void Execute();
+    void Compile();     // 只需要图结构，不分配资源也不录制指令；编译后不应再添加pass
+
+    void Execute();     // 未编译时会先调用Compile
+
+    const std::vector<RHICommandListRef>& GetRecordedCommands() { return recordedCommands; }    // 本次执行用到的workerCommands，提交时按顺序跟在command之后
 
 private:
-    void CreateInputBarriers(RDGPassNodeRef pass);
-    void CreateOutputBarriers(RDGPassNodeRef pass);
+    void CullPasses();
+    void PlaceTransientResources();
+    void CompileTextureStates(std::vector<RDGEdgeState>& states);
+    void CompileBufferStates(std::vector<RDGEdgeState>& states);
+    void CompileBarriers(RDGPassNodeRef pass, const std::vector<RDGEdgeState>& states);
+    void PrepareBarriers(const std::vector<RDGTextureBarrierInfo>& infos, std::vector<std::vector<RHITextureBarrier>>& batches);
+    void PrepareBarriers(const std::vector<RDGBufferBarrierInfo>& infos, std::vector<std::vector<RHIBufferBarrier>>& batches);
     void PrepareDescriptorSet(RDGPassNodeRef pass);
     void PrepareRenderTarget(RDGRenderPassNodeRef pass, RHIRenderPassInfo& renderPassInfo);
+    void PreparePass(RDGPassNodeRef pass);
+    void PreparePass(RDGRenderPassNodeRef pass);
+    void PreparePass(RDGPresentPassNodeRef pass);
+    void PreparePass(RDGCopyPassNodeRef pass);
     void ReleaseResource(RDGPassNodeRef pass);
-    void ExecutePass(RDGRenderPassNodeRef pass);
-    void ExecutePass(RDGComputePassNodeRef pass);
-    void ExecutePass(RDGRayTracingPassNodeRef pass);
-    void ExecutePass(RDGPresentPassNodeRef pass);
-    void ExecutePass(RDGCopyPassNodeRef pass);
+    void CreateBarriers(RDGPassNodeRef pass, RHICommandListRef command, uint32_t output);
+    void RecordPasses(const std::vector<RDGPassNodeRef>& executePasses);
+    void ExecutePass(RDGPassNodeRef pass, RHICommandListRef command);      // 只录制指令，可在工作线程上调用
+    void ExecutePass(RDGRenderPassNodeRef pass, RHICommandListRef command);
+    void ExecutePass(RDGComputePassNodeRef pass, RHICommandListRef command);
+    void ExecutePass(RDGRayTracingPassNodeRef pass, RHICommandListRef command);
+    void ExecutePass(RDGPresentPassNodeRef pass, RHICommandListRef command);
+    void ExecutePass(RDGCopyPassNodeRef pass, RHICommandListRef command);
 
     template<typename Type, typename Handle>
     Handle GetPass(std::string name)
@@ -102,17 +131,15 @@ private:
     void Release(RDGTextureNodeRef textureNode, RHIResourceState state);  
     void Release(RDGBufferNodeRef bufferNode, RHIResourceState state);  
 
-    RHIResourceState PreviousState(RDGTextureNodeRef textureNode, RDGPassNodeRef passNode, TextureSubresourceRange subresource = {}, bool output = false);    // 获取当前pass（在执行顺序上）的资源的前序状态
-    RHIResourceState PreviousState(RDGBufferNodeRef bufferNode, RDGPassNodeRef passNode, uint32_t offset = 0, uint32_t size = 0, bool output = false);      // output用于标记是相对于输入还是输出资源
-    bool IsLastUsedPass(RDGTextureNodeRef textureNode, RDGPassNodeRef passNode, bool output = false);
-    bool IsLastUsedPass(RDGBufferNodeRef bufferNode, RDGPassNodeRef passNode, bool output = false);
-
     std::vector<RDGPassNodeRef> passes; // 创建的全部pass，按照创建顺序执行
+    bool compiled = false;
 
     RDGDependencyGraphRef graph = std::make_shared<RDGDependencyGraph>();
     RDGBlackBoard blackBoard;
 
     RHICommandListRef command;
+    std::vector<RHICommandListRef> workerCommands;
+    std::vector<RHICommandListRef> recordedCommands;
 };
 typedef std::shared_ptr<RDGBuilder> RDGBuilderRef;
 
@@ -199,6 +226,7 @@ public:
     RDGRenderPassBuilder& OutputReadWrite(RDGBufferHandle buffer, uint32_t offset = 0, uint32_t size = 0);
     RDGRenderPassBuilder& OutputReadWrite(RDGTextureHandle texture, TextureSubresourceRange subresource = {});  
     RDGRenderPassBuilder& Execute(const RDGPassExecuteFunc& execute);
+    RDGRenderPassBuilder& RecordOnMainThread();                                                   // 执行函数不是线程安全的，并行录制时留在主线程上
 
     RDGRenderPassHandle Finish() { return pass->GetHandle(); }
 
@@ -233,6 +261,7 @@ public:
 
 
     RDGComputePassBuilder& Execute(const RDGPassExecuteFunc& execute);
+    RDGComputePassBuilder& RecordOnMainThread();                                                   // 执行函数不是线程安全的，并行录制时留在主线程上
 
     RDGComputePassHandle Finish() { return pass->GetHandle(); }
 
@@ -266,6 +295,7 @@ public:
 
 
     RDGRayTracingPassBuilder& Execute(const RDGPassExecuteFunc& execute);
+    RDGRayTracingPassBuilder& RecordOnMainThread();                                                   // 执行函数不是线程安全的，并行录制时留在主线程上
 
     RDGRayTracingPassHandle Finish() { return pass->GetHandle(); }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Function/Render/RDG/RDGEdge.h"
+#include "Function/Render/RDG/RDGPool.h"
 #include "Function/Render/RHI/RHICommandList.h"
 #include "RDGHandle.h"
 #include "Core/DependencyGraph/DependencyGraph.h"
@@ -46,6 +47,8 @@ typedef struct RDGPassContext
 
 } RDGPassContext;
 
+// 并行录制时在工作线程上和其他pass的执行函数同时调用，只应向context.command录制指令，读取准备阶段已经确定的资源和只读的全局状态
+// 不能创建RHI资源，修改缓存、场景、资源管理器等共享状态，也不能执行UI等其他逻辑；做不到的pass需要声明RecordOnMainThread
 typedef std::function<void(RDGPassContext)> RDGPassExecuteFunc;
 
 class RDGNode : public DependencyGraph::Node
@@ -73,12 +76,18 @@ public:
     {}
 
     inline bool IsImported() { return isImported; }
+    inline bool IsPlaced() { return heap != nullptr; }
 
     RDGResourceNodeType NodeType() { return nodeType; }
 
 protected:
     RDGResourceNodeType nodeType;
     bool isImported = false;
+
+    RHIHeapRef heap;                // 编译阶段放置的heap和偏移，为空时从资源池分配
+    uint64_t heapOffset = 0;
+
+    friend class RDGBuilder;
 };
 typedef RDGResourceNode* RDGResourceNodeRef;
 
@@ -140,6 +149,47 @@ struct SamplerBind
     uint32_t index;
 };
 
+// 编译阶段预计算的屏障，执行时只需要解析出RHI资源
+typedef struct RDGTextureBarrierInfo
+{
+    RDGTextureNodeRef texture;
+    RDGTextureEdgeRef edge;                                 // dstState和子资源范围
+    RHIResourceState srcState = RESOURCE_STATE_UNDEFINED;
+    bool initState = false;                                 // 没有前序引用，srcState取资源分配/导入时的初始状态
+    bool newBatch = false;                                  // 和当前批次里的屏障作用于重叠的子资源，需要另起一批
+
+} RDGTextureBarrierInfo;
+
+typedef struct RDGBufferBarrierInfo
+{
+    RDGBufferNodeRef buffer;
+    RDGBufferEdgeRef edge;
+    RHIResourceState srcState = RESOURCE_STATE_UNDEFINED;
+    bool initState = false;
+    bool newBatch = false;
+
+} RDGBufferBarrierInfo;
+
+typedef struct RDGCompiledPass
+{
+    std::vector<RDGTextureBarrierInfo> inputTextureBarriers;
+    std::vector<RDGBufferBarrierInfo> inputBufferBarriers;
+    std::vector<RDGTextureBarrierInfo> outputTextureBarriers;
+    std::vector<RDGBufferBarrierInfo> outputBufferBarriers;
+
+    std::vector<std::pair<RDGTextureNodeRef, RHIResourceState>> releaseTextures;    // 最后使用该资源的pass，执行完后以对应状态返回资源池
+    std::vector<std::pair<RDGBufferNodeRef, RHIResourceState>> releaseBuffers;
+
+} RDGCompiledPass;
+
+// 执行阶段在当前线程上按顺序准备的结果，RHI资源都已解析，录制时只读，不再访问资源池
+typedef struct RDGPreparedPass
+{
+    std::vector<std::vector<RHITextureBarrier>> textureBarriers[2];     // 0为输入屏障，1为输出屏障，每个元素为一次提交的批次
+    std::vector<std::vector<RHIBufferBarrier>> bufferBarriers[2];
+
+} RDGPreparedPass;
+
 class RDGPassNode : public RDGNode
 {
 public:
@@ -156,15 +206,22 @@ public:
 
     RDGPassNodeType NodeType() { return nodeType; }
 
+    inline bool IsCulled()                      { return isCulled; }
+    inline bool RecordOnMainThread()            { return recordOnMainThread; }
+    const RDGCompiledPass& GetCompiled()        { return compiled; }
+
 protected:
     RDGPassNodeType nodeType;
     bool isCulled = false;
+    bool recordOnMainThread = false;                        // 执行函数不满足并行录制的要求，只在调用Execute的线程上录制
+    RDGCompiledPass compiled;
+    RDGPreparedPass prepared;
 
     RHIRootSignatureRef rootSignature;
     std::array<RHIDescriptorSetRef, MAX_DESCRIPTOR_SETS> descriptorSets;
 
     std::vector<RHITextureViewRef> pooledViews;             // 动态分配的池化资源，执行完毕后返回资源池
-    std::vector<std::pair<RHIDescriptorSetRef, uint32_t>> pooledDescriptorSets;
+    std::vector<std::pair<RDGDescriptorSetPool::PooledDescriptor, uint32_t>> pooledDescriptorSets;
     std::vector<SamplerBind> samplers;                
 
     friend class RDGBuilder;
@@ -185,6 +242,8 @@ private:
     RDGPassExecuteFunc execute;
     uint32_t multiviewCount = 0;    
 
+    RHIRenderPassRef renderPass;    // 准备阶段创建
+
     friend class RDGRenderPassBuilder;
     friend class RDGBuilder;
 };
@@ -233,6 +292,10 @@ public:
 
     RDGPresentPassHandle GetHandle() { return RDGPresentPassHandle(ID()); } 
 private:
+    RHITextureRef presentTexture;               // 准备阶段解析
+    RHITextureRef texture;
+    TextureSubresourceLayers subresource;
+
     friend class RDGPresentPassBuilder;
     friend class RDGBuilder;
 };
@@ -249,6 +312,17 @@ public:
 private:
     bool generateMip = false;
 
+    RHIBufferRef bufferFrom;                    // 准备阶段解析
+    RHIBufferRef bufferTo;
+    uint32_t offsetFrom = 0;
+    uint32_t offsetTo = 0;
+    uint32_t size = 0;
+
+    RHITextureRef textureFrom;
+    RHITextureRef textureTo;
+    TextureSubresourceLayers fromSubresource;
+    TextureSubresourceLayers toSubresource;
+
     friend class RDGCopyPassBuilder;
     friend class RDGBuilder;
 };
@@ -3,22 +3,108 @@
 #include "Function/Global/EngineContext.h"
 #include "Function/Render/RHI/RHIResource.h"
 #include "Function/Render/RHI/RHIStructs.h"
+#include <algorithm>
 #include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// 池中的元素，multimap的元素为pair
+template<typename Entry>
+static Entry& PooledEntry(Entry& entry)                             { return entry; }
+template<typename Size, typename Entry>
+static Entry& PooledEntry(std::pair<const Size, Entry>& entry)     { return entry.second; }
+
+// 先清理空闲超过帧数限制的资源，仍超出显存预算时再按最后使用的帧从旧到新清理
+template<typename Map, typename BytesFunc>
+static void CollectGarbage(Map& pooled, uint64_t frame, const RDGPoolConfig& config, RDGPoolStats& stats, BytesFunc&& bytesOf)
+{
+    auto evict = [&](auto& entries, auto iter) {
+        stats.pooledCount--;
+        stats.pooledBytes -= bytesOf(PooledEntry(*iter));
+        stats.evictions++;
+        return entries.erase(iter);
+    };
+
+    if(config.maxUnusedFrames > 0)
+    {
+        for(auto& pair : pooled)
+        {
+            auto& entries = pair.second;
+            for(auto iter = entries.begin(); iter != entries.end();)
+            {
+                if(frame - PooledEntry(*iter).lastUsedFrame > config.maxUnusedFrames)  iter = evict(entries, iter);
+                else                                                                    iter++;
+            }
+        }
+    }
+
+    if(config.maxPooledBytes > 0 && stats.pooledBytes > config.maxPooledBytes)
+    {
+        using Bucket = typename Map::iterator;
+        using Entry = typename Map::mapped_type::iterator;
+        std::vector<std::tuple<uint64_t, Bucket, Entry>> candidates;
+        for(auto bucket = pooled.begin(); bucket != pooled.end(); bucket++)
+        {
+            for(auto iter = bucket->second.begin(); iter != bucket->second.end(); iter++) 
+            {
+                candidates.push_back({ PooledEntry(*iter).lastUsedFrame, bucket, iter });
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+            return std::get<0>(a) < std::get<0>(b);
+        });
+
+        for(auto& candidate : candidates)   // 只删除容器内的元素，其余迭代器不失效
+        {
+            if(stats.pooledBytes <= config.maxPooledBytes) break;
+            evict(std::get<1>(candidate)->second, std::get<2>(candidate));
+        }
+    }
+
+    for(auto iter = pooled.begin(); iter != pooled.end();)  // 分辨率变化后旧的键不会再被命中，一并删除
+    {
+        if(iter->second.empty())    iter = pooled.erase(iter);
+        else                        iter++;
+    }
+}
+
+// 结算本帧的计数，清空后开始下一帧
+static void SwapStats(RDGPoolStats& current, RDGPoolStats& stats)
+{
+    stats = current;
+    current.hits = 0;
+    current.misses = 0;
+    current.evictions = 0;
+    current.reuses = 0;
+}
+
+static uint64_t TextureBytes(const RHITextureInfo& info)
+{
+    uint64_t bytes = 0;
+    for(uint32_t mip = 0; mip < info.mipLevels; mip++)
+    {
+        bytes +=    (uint64_t)std::max((uint32_t)1, info.extent.width >> mip) * 
+                    std::max((uint32_t)1, info.extent.height >> mip) * 
+                    std::max((uint32_t)1, info.extent.depth >> mip);
+    }
+    return bytes * FormatPixelSize(info.format) * info.arrayLayers;
+}
 
 RDGBufferPool::PooledBuffer RDGBufferPool::Allocate(const RHIBufferInfo& info)
 {
     RDGBufferPool::PooledBuffer ret;
 
     auto& buffers = pooledBuffers[info];
-    for(auto iter = buffers.begin(); iter != buffers.end(); iter++) 
+    auto iter = buffers.lower_bound(info.size);     // 最佳适配，取够用的里面最小的
+    if(iter != buffers.end())
     {
-        if(iter->buffer->GetInfo().size >= info.size)   // 搜索符合条件的，尺寸
-        {
-            ret = *iter;
-            buffers.erase(iter);
-            pooledSize--;
-            return ret;
-        }
+        ret = iter->second;
+        buffers.erase(iter);
+        current.pooledCount--;
+        current.pooledBytes -= ret.buffer->GetInfo().size;
+        current.hits++;
+        return ret;
     }
     
     LOG_DEBUG("RHIBuffer not found in cache, creating new.");
@@ -27,14 +113,28 @@ RDGBufferPool::PooledBuffer RDGBufferPool::Allocate(const RHIBufferInfo& info)
         .state = RESOURCE_STATE_UNDEFINED
     };
     allocatedSize++;
+    current.misses++;
 
     return ret;
 }
 
 void RDGBufferPool::Release(const RDGBufferPool::PooledBuffer& pooledBuffer)
 {
-    pooledBuffers[pooledBuffer.buffer->GetInfo()].push_back(pooledBuffer);
-    pooledSize++;
+    PooledBuffer released = pooledBuffer;
+    released.lastUsedFrame = frame;
+
+    pooledBuffers[pooledBuffer.buffer->GetInfo()].insert({ pooledBuffer.buffer->GetInfo().size, released });
+    current.pooledCount++;
+    current.pooledBytes += pooledBuffer.buffer->GetInfo().size;
+}
+
+void RDGBufferPool::Tick()
+{
+    CollectGarbage(pooledBuffers, frame, config, current, [](const PooledBuffer& pooled) {
+        return pooled.buffer->GetInfo().size;
+    });
+    SwapStats(current, stats);
+    frame++;
 }
 
 RDGTexturePool::PooledTexture RDGTexturePool::Allocate(const RHITextureInfo& info)
@@ -45,11 +145,13 @@ RDGTexturePool::PooledTexture RDGTexturePool::Allocate(const RHITextureInfo& inf
     if(tempInfo.mipLevels == 0) tempInfo.mipLevels = tempInfo.extent.MipSize();     // 处理一下自动的mipLevels
 
     auto& textures = pooledTextures[tempInfo];
-    for(auto iter = textures.begin(); iter != textures.end(); iter++) 
+    if(!textures.empty())
     {
-        ret = *iter;                    
-        textures.erase(iter);
-        pooledSize--;
+        ret = textures.back();          // 最近归还的优先，久未使用的留在前面等待清理
+        textures.pop_back();
+        current.pooledCount--;
+        current.pooledBytes -= TextureBytes(tempInfo);
+        current.hits++;
         return ret;
     }
     
@@ -59,14 +161,28 @@ RDGTexturePool::PooledTexture RDGTexturePool::Allocate(const RHITextureInfo& inf
         .state = RESOURCE_STATE_UNDEFINED,
     };
     allocatedSize++;
+    current.misses++;
 
     return ret;
 }
 
 void RDGTexturePool::Release(const RDGTexturePool::PooledTexture& pooledTexture)
 {
-    pooledTextures[pooledTexture.texture->GetInfo()].push_back(pooledTexture);
-    pooledSize++;
+    PooledTexture released = pooledTexture;
+    released.lastUsedFrame = frame;
+
+    pooledTextures[pooledTexture.texture->GetInfo()].push_back(released);
+    current.pooledCount++;
+    current.pooledBytes += TextureBytes(pooledTexture.texture->GetInfo());
+}
+
+void RDGTexturePool::Tick()
+{
+    CollectGarbage(pooledTextures, frame, config, current, [](const PooledTexture& pooled) {
+        return TextureBytes(pooled.texture->GetInfo());
+    });
+    SwapStats(current, stats);
+    frame++;
 }
 
 RDGTextureViewPool::PooledTextureView RDGTextureViewPool::Allocate(const RHITextureViewInfo& info)
@@ -77,11 +193,12 @@ RDGTextureViewPool::PooledTextureView RDGTextureViewPool::Allocate(const RHIText
     RDGTextureViewPool::PooledTextureView ret;
 
     auto& textureViews = pooledTextureViews[actualInfo];
-    for(auto iter = textureViews.begin(); iter != textureViews.end(); iter++) 
+    if(!textureViews.empty())
     {
-        ret = *iter;                    
-        textureViews.erase(iter);
-        pooledSize--;
+        ret = textureViews.back();
+        textureViews.pop_back();
+        current.pooledCount--;
+        current.hits++;
         return ret;
     }
     
@@ -90,27 +207,43 @@ RDGTextureViewPool::PooledTextureView RDGTextureViewPool::Allocate(const RHIText
         .textureView = EngineContext::RHI()->CreateTextureView(actualInfo)   
     };
     allocatedSize++;
+    current.misses++;
 
     return ret;
 }
 
 void RDGTextureViewPool::Release(const RDGTextureViewPool::PooledTextureView& pooledTextureView)
 {
-    pooledTextureViews[pooledTextureView.textureView->GetInfo()].push_back(pooledTextureView);
-    pooledSize++;
+    PooledTextureView released = pooledTextureView;
+    released.lastUsedFrame = frame;
+
+    pooledTextureViews[pooledTextureView.textureView->GetInfo()].push_back(released);
+    current.pooledCount++;
 }
 
+void RDGTextureViewPool::Tick()
+{
+    // 视图持有所引用的纹理，纹理被清理后对应的视图也不会再被命中，需要一起按帧龄清理才能真正释放显存
+    CollectGarbage(pooledTextureViews, frame, config, current, [](const PooledTextureView& pooled) {
+        return (uint64_t)0;
+    });
+    SwapStats(current, stats);
+    frame++;
+}
 
 RDGDescriptorSetPool::PooledDescriptor RDGDescriptorSetPool::Allocate(const RHIRootSignatureRef& rootSignature, uint32_t set)
 {
     RDGDescriptorSetPool::PooledDescriptor ret;
 
     auto& descriptors = pooledDescriptors[{rootSignature->GetInfo(), set}];
-    for(auto iter = descriptors.begin(); iter != descriptors.end(); iter++) 
+    if(!descriptors.empty())
     {
-        ret = *iter;                    
-        descriptors.erase(iter);
-        pooledSize--;
+        ret = descriptors.back();
+        ret.writes.clear();         // 由调用者写入，内容未知
+        ret.writesHash = 0;
+        descriptors.pop_back();
+        current.pooledCount--;
+        current.hits++;
         return ret;
     }
     
@@ -119,12 +252,209 @@ RDGDescriptorSetPool::PooledDescriptor RDGDescriptorSetPool::Allocate(const RHIR
         .descriptor = rootSignature->CreateDescriptorSet(set)
     };
     allocatedSize++;
+    current.misses++;
+
+    return ret;
+}
+
+RDGDescriptorSetPool::PooledDescriptor RDGDescriptorSetPool::Allocate(const RHIRootSignatureRef& rootSignature, uint32_t set, const std::vector<RHIDescriptorUpdateInfo>& writes)
+{
+    uint64_t writesHash = HashWrites(writes);
+
+    // 描述符池每帧一个，池中的描述符最近一次在FRAMES_IN_FLIGHT帧之前使用，渲染流程不变时各pass每帧都能取回写入过相同内容的描述符
+    auto& descriptors = pooledDescriptors[{rootSignature->GetInfo(), set}];
+    for(auto iter = descriptors.rbegin(); iter != descriptors.rend(); iter++)
+    {
+        if(iter->writesHash == writesHash && SameWrites(iter->writes, writes))
+        {
+            PooledDescriptor ret = *iter;
+            descriptors.erase(std::next(iter).base());
+            current.pooledCount--;
+            current.hits++;
+            current.reuses++;
+            return ret;
+        }
+    }
+
+    PooledDescriptor ret = Allocate(rootSignature, set);
+    ret.writes = writes;
+    ret.writesHash = writesHash;
+    if(ret.descriptor && !writes.empty()) ret.descriptor->UpdateDescriptors(writes);
 
     return ret;
 }
 
 void RDGDescriptorSetPool::Release(const RDGDescriptorSetPool::PooledDescriptor& pooledDescriptor, const RHIRootSignatureRef& rootSignature, uint32_t set)
 {
-    pooledDescriptors[{rootSignature->GetInfo(), set}].push_back(pooledDescriptor);
-    pooledSize++;    
-}
\ No newline at end of file
+    PooledDescriptor released = pooledDescriptor;
+    released.lastUsedFrame = frame;
+
+    pooledDescriptors[{rootSignature->GetInfo(), set}].push_back(released);
+    current.pooledCount++;
+}
+
+uint64_t RDGDescriptorSetPool::HashWrites(const std::vector<RHIDescriptorUpdateInfo>& writes)
+{
+    struct WriteKey
+    {
+        uint32_t binding;
+        uint32_t index;
+        uint64_t resourceType;
+        const void* resources[4];
+        uint64_t bufferOffset;
+        uint64_t bufferRange;
+    };
+
+    std::vector<WriteKey> keys(writes.size());
+    for(uint32_t i = 0; i < writes.size(); i++)
+    {
+        const RHIDescriptorUpdateInfo& write = writes[i];
+        keys[i] = { 
+            .binding = write.binding, 
+            .index = write.index, 
+            .resourceType = write.resourceType,
+            .resources = { write.buffer.get(), write.textureView.get(), write.sampler.get(), write.tlas.get() },
+            .bufferOffset = write.bufferOffset,
+            .bufferRange = write.bufferRange };
+    }
+    return MurmurHash64A(keys.data(), keys.size() * sizeof(WriteKey), 0);
+}
+
+bool RDGDescriptorSetPool::SameWrites(const std::vector<RHIDescriptorUpdateInfo>& a, const std::vector<RHIDescriptorUpdateInfo>& b)
+{
+    if(a.size() != b.size()) return false;
+    for(uint32_t i = 0; i < a.size(); i++)
+    {
+        if( a[i].binding != b[i].binding ||
+            a[i].index != b[i].index ||
+            a[i].resourceType != b[i].resourceType ||
+            a[i].buffer != b[i].buffer ||
+            a[i].textureView != b[i].textureView ||
+            a[i].sampler != b[i].sampler ||
+            a[i].tlas != b[i].tlas ||
+            a[i].bufferOffset != b[i].bufferOffset ||
+            a[i].bufferRange != b[i].bufferRange) return false;
+    }
+    return true;
+}
+
+void RDGDescriptorSetPool::Tick()
+{
+    CollectGarbage(pooledDescriptors, frame, config, current, [](const PooledDescriptor& pooled) {
+        return (uint64_t)0;
+    });
+    SwapStats(current, stats);
+    frame++;
+}
+
+uint64_t RDGTransientAllocator::Place(std::vector<Placement>& placements)
+{
+    // 区间图上的贪心放置：按尺寸从大到小依次放置，每个资源只需避开生命周期重叠的已放置资源，取能容纳它的最低对齐偏移
+    std::vector<uint32_t> order(placements.size());
+    for(uint32_t i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if(placements[a].size != placements[b].size) return placements[a].size > placements[b].size;
+        return placements[a].first < placements[b].first;
+    });
+
+    uint64_t heapSize = 0;
+    std::vector<uint32_t> placed;
+    std::vector<std::pair<uint64_t, uint64_t>> occupied;   // 和当前资源同时存活的资源所占的[begin, end)
+    placed.reserve(placements.size());
+    for(uint32_t index : order)
+    {
+        Placement& placement = placements[index];
+
+        occupied.clear();
+        for(uint32_t other : placed)
+        {
+            const Placement& otherPlacement = placements[other];
+            if(otherPlacement.first > placement.last || otherPlacement.last < placement.first) continue;
+            occupied.push_back({ otherPlacement.offset, otherPlacement.offset + otherPlacement.size });
+        }
+        std::sort(occupied.begin(), occupied.end());
+
+        uint64_t alignment = std::max(placement.alignment, (uint64_t)1);
+        uint64_t offset = 0;
+        for(auto& range : occupied)
+        {
+            if(range.first >= offset + placement.size) break;   // 之前的空隙已经放得下
+            offset = std::max(offset, (range.second + alignment - 1) / alignment * alignment);
+        }
+
+        placement.offset = offset;
+        placed.push_back(index);
+        heapSize = std::max(heapSize, offset + placement.size);
+    }
+    return heapSize;
+}
+
+RHIMemoryRequirements RDGTransientAllocator::GetMemoryRequirements(const RHITextureInfo& info)
+{
+    RHITextureInfo actualInfo = Normalize(info);
+    auto iter = textureRequirements.find(actualInfo);
+    if(iter != textureRequirements.end()) return iter->second;
+
+    RHIMemoryRequirements requirements = EngineContext::RHI()->GetMemoryRequirements(actualInfo);
+    textureRequirements[actualInfo] = requirements;
+    return requirements;
+}
+
+RHIMemoryRequirements RDGTransientAllocator::GetMemoryRequirements(const RHIBufferInfo& info)
+{
+    auto iter = bufferRequirements.find(info);
+    if(iter != bufferRequirements.end()) return iter->second;
+
+    RHIMemoryRequirements requirements = EngineContext::RHI()->GetMemoryRequirements(info);
+    bufferRequirements[info] = requirements;
+    return requirements;
+}
+
+RHIHeapRef RDGTransientAllocator::GetHeap(uint64_t key, const RHIHeapInfo& info)
+{
+    RHIHeapRef& heap = heaps[key];
+    if( heap &&
+        heap->GetInfo().size >= info.size &&
+        heap->GetInfo().alignment >= info.alignment) return heap;
+
+    // 旧heap上的放置资源不会再被命中，由Tick清理，GPU上的使用由RHI的延迟析构保证
+    if(heap) heapBytes -= heap->GetInfo().size;
+    heap = EngineContext::RHI()->CreateHeap(info);
+    heapBytes += info.size;
+
+    ENGINE_LOG_INFO("RDG transient heap created: {} MB, total transient heap: {} MB", 
+        info.size / (1024.0f * 1024.0f), 
+        heapBytes / (1024.0f * 1024.0f));
+    return heap;
+}
+
+RHITextureRef RDGTransientAllocator::GetTexture(const RHITextureInfo& info, RHIHeapRef heap, uint64_t offset)
+{
+    RHITextureInfo actualInfo = Normalize(info);
+    auto& placed = placedTextures[{ actualInfo, heap.get(), offset }];
+    if(placed.resource == nullptr) placed.resource = EngineContext::RHI()->CreatePlacedTexture(actualInfo, heap, offset);
+    placed.unusedTicks = 0;
+    return placed.resource;
+}
+
+RHIBufferRef RDGTransientAllocator::GetBuffer(const RHIBufferInfo& info, RHIHeapRef heap, uint64_t offset)
+{
+    auto& placed = placedBuffers[{ info, heap.get(), offset }];
+    if(placed.resource == nullptr) placed.resource = EngineContext::RHI()->CreatePlacedBuffer(info, heap, offset);
+    placed.unusedTicks = 0;
+    return placed.resource;
+}
+
+void RDGTransientAllocator::Tick()
+{
+    for(auto iter = placedTextures.begin(); iter != placedTextures.end();)
+    {
+        if(++iter->second.unusedTicks > MAX_UNUSED_TICKS)   iter = placedTextures.erase(iter);
+        else                                                iter++;
+    }
+    for(auto iter = placedBuffers.begin(); iter != placedBuffers.end();)
+    {
+        if(++iter->second.unusedTicks > MAX_UNUSED_TICKS)   iter = placedBuffers.erase(iter);
+        else                                                iter++;
+    }
+}
@@ -6,15 +6,35 @@
 #include <cstdint>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 // RDG所用到的主要的资源，由于每帧重构，都需要池化
 // 包括buffer texture textureView等
 // 录制每个pass的命令时会申请此处的实际RHI资源，录制完成后再将资源归还给池子
 
 // renderPass和frameBuffer是在RHI层实现的池化
-// TODO 目前并没有做池化后的GC，冗余资源没有定期删除
+// 每个池子每帧Tick一次，池中空闲的资源记录最后归还的帧，按帧龄和显存预算清理
+
+// GPU独占的临时资源不走池化，而是由RDGTransientAllocator在编译阶段按生命周期放置到共享的heap上
+
+struct RDGPoolStats
+{
+    uint32_t hits = 0;              // 命中，新建和清理的数量，GetStats返回上一帧的计数
+    uint32_t misses = 0;
+    uint32_t evictions = 0;
+    uint32_t pooledCount = 0;       // 当前池中空闲的资源数
+    uint64_t pooledBytes = 0;       // 空闲资源的显存估计，视图，描述符和管线不计
+    uint32_t reuses = 0;            // 命中中内容完全相同，不需要重新写入的数量，只有描述符池统计
+};
+
+struct RDGPoolConfig
+{
+    uint32_t maxUnusedFrames = 120; // 空闲超过该帧数的资源会被清理，0为不按帧龄清理
+    uint64_t maxPooledBytes = 0;    // 空闲资源的显存预算，超出时从最久未使用的开始清理，0为不限制
+};
 
 class RDGBufferPool
 {
@@ -23,6 +43,8 @@ public:
     {
         RHIBufferRef buffer;    // RHIBuffer的析构是在RHI里追踪完成的，无须手动释放
         RHIResourceState state; // 当前所处的资源状态
+
+        uint64_t lastUsedFrame = 0;
     };
 
     struct Key
@@ -57,9 +79,13 @@ public:
     PooledBuffer Allocate(const RHIBufferInfo& info);
     void Release(const PooledBuffer& pooledBuffer);
 
-    inline uint32_t PooledSize()    { return pooledSize; }
+    void Tick();                    // 每帧调用一次，清理空闲资源并结算统计
+
+    inline uint32_t PooledSize()    { return current.pooledCount; }
     inline uint32_t AllocatedSize() { return allocatedSize; }
-    void Clear()                    { pooledBuffers.clear(); pooledSize = 0; }
+    inline const RDGPoolStats& GetStats()   { return stats; }
+    inline RDGPoolConfig& GetConfig()       { return config; }
+    void Clear()                    { pooledBuffers.clear(); current.pooledCount = 0; current.pooledBytes = 0; }
 
     static std::shared_ptr<RDGBufferPool> Get()
     {
@@ -69,9 +95,13 @@ public:
     }
 
 private:
-    std::unordered_map<Key, std::list<PooledBuffer>, Key::Hash> pooledBuffers;    // 可能有多个满足需求的buffer，还得再靠size等筛选
-    uint32_t pooledSize = 0;
+    std::unordered_map<Key, std::multimap<uint64_t, PooledBuffer>, Key::Hash> pooledBuffers;  // 可能有多个满足需求的buffer，按size排序后取最小的够用的
     uint32_t allocatedSize = 0;
+
+    uint64_t frame = 0;
+    RDGPoolConfig config;
+    RDGPoolStats current;
+    RDGPoolStats stats;
 };
 
 
@@ -82,6 +112,8 @@ public:
     {
         RHITextureRef texture;  
         RHIResourceState state; 
+
+        uint64_t lastUsedFrame = 0;
     };
 
     struct Key
@@ -107,9 +139,13 @@ public:
     PooledTexture Allocate(const RHITextureInfo& info);
     void Release(const PooledTexture& pooledTexture);
 
-    inline uint32_t PooledSize()    { return pooledSize; }
+    void Tick();                    // 每帧调用一次，清理空闲资源并结算统计
+
+    inline uint32_t PooledSize()    { return current.pooledCount; }
     inline uint32_t AllocatedSize() { return allocatedSize; }
-    void Clear()                    { pooledTextures.clear(); pooledSize = 0; }
+    inline const RDGPoolStats& GetStats()   { return stats; }
+    inline RDGPoolConfig& GetConfig()       { return config; }
+    void Clear()                    { pooledTextures.clear(); current.pooledCount = 0; current.pooledBytes = 0; }
 
     static std::shared_ptr<RDGTexturePool> Get()
     {
@@ -119,9 +155,13 @@ public:
     }
 
 private:
-    std::unordered_map<Key, std::list<PooledTexture>, Key::Hash> pooledTextures;  
-    uint32_t pooledSize = 0;
+    std::unordered_map<Key, std::list<PooledTexture>, Key::Hash> pooledTextures;
     uint32_t allocatedSize = 0;
+
+    uint64_t frame = 0;
+    RDGPoolConfig config;
+    RDGPoolStats current;
+    RDGPoolStats stats;
 };
 
 
@@ -131,6 +171,8 @@ public:
     struct PooledTextureView
     {
         RHITextureViewRef textureView;  
+
+        uint64_t lastUsedFrame = 0;
     };
 
     struct Key
@@ -156,9 +198,13 @@ public:
     PooledTextureView Allocate(const RHITextureViewInfo& info);
     void Release(const PooledTextureView& pooledTextureView);
 
-    inline uint32_t PooledSize()    { return pooledSize; }
+    void Tick();                    // 每帧调用一次，清理空闲资源并结算统计
+
+    inline uint32_t PooledSize()    { return current.pooledCount; }
     inline uint32_t AllocatedSize() { return allocatedSize; }
-    void Clear()                    { pooledTextureViews.clear(); pooledSize = 0; }
+    inline const RDGPoolStats& GetStats()   { return stats; }
+    inline RDGPoolConfig& GetConfig()       { return config; }
+    void Clear()                    { pooledTextureViews.clear(); current.pooledCount = 0; current.pooledBytes = 0; }
 
     static std::shared_ptr<RDGTextureViewPool> Get()
     {
@@ -169,8 +215,12 @@ public:
 
 private:
     std::unordered_map<Key, std::list<PooledTextureView>, Key::Hash> pooledTextureViews;
-    uint32_t pooledSize = 0;
     uint32_t allocatedSize = 0;
+
+    uint64_t frame = 0;
+    RDGPoolConfig config;
+    RDGPoolStats current;
+    RDGPoolStats stats;
 };
 
 class RDGDescriptorSetPool
@@ -179,6 +229,10 @@ public:
     struct PooledDescriptor
     {
         RHIDescriptorSetRef descriptor;  
+        std::vector<RHIDescriptorUpdateInfo> writes;    // 最近一次写入的内容，同时持有引用，保证对应的资源对象不会被释放后复用
+        uint64_t writesHash = 0;
+
+        uint64_t lastUsedFrame = 0;
     };
 
     struct Key
@@ -212,11 +266,19 @@ public:
     };
 
     PooledDescriptor Allocate(const RHIRootSignatureRef& rootSignature, uint32_t set);
+    PooledDescriptor Allocate(const RHIRootSignatureRef& rootSignature, uint32_t set, const std::vector<RHIDescriptorUpdateInfo>& writes);  // 优先取上次写入内容相同的，跳过写入；否则批量写入
     void Release(const PooledDescriptor& pooledDescriptor, const RHIRootSignatureRef& rootSignature, uint32_t set);
 
-    inline uint32_t PooledSize()    { return pooledSize; }
+    static uint64_t HashWrites(const std::vector<RHIDescriptorUpdateInfo>& writes);     // 按binding，index，类型，资源对象和范围计算
+    static bool SameWrites(const std::vector<RHIDescriptorUpdateInfo>& a, const std::vector<RHIDescriptorUpdateInfo>& b);
+
+    void Tick();                    // 每帧调用一次，清理空闲资源并结算统计
+
+    inline uint32_t PooledSize()    { return current.pooledCount; }
     inline uint32_t AllocatedSize() { return allocatedSize; }
-    void Clear()                    { pooledDescriptors.clear(); pooledSize = 0; }
+    inline const RDGPoolStats& GetStats()   { return stats; }
+    inline RDGPoolConfig& GetConfig()       { return config; }
+    void Clear()                    { pooledDescriptors.clear(); current.pooledCount = 0; current.pooledBytes = 0; }
 
     static std::shared_ptr<RDGDescriptorSetPool> Get(uint32_t index)    // 描述符池需要FRAMES_IN_FLIGHT每帧一个，不然下一帧修改可能影响上一帧还未完成的渲染！！！
     {                                                                   
@@ -227,6 +289,118 @@ public:
 
 private:
     std::unordered_map<Key, std::list<PooledDescriptor>, Key::Hash> pooledDescriptors;
-    uint32_t pooledSize = 0;
     uint32_t allocatedSize = 0;
+
+    uint64_t frame = 0;
+    RDGPoolConfig config;
+    RDGPoolStats current;
+    RDGPoolStats stats;
+};
+
+// 临时资源的放置分配：编译阶段根据各资源的生命周期（首次和最后使用的pass区间），把不重叠的资源放在同一段heap内存上
+// heap和放置资源都跨帧保留，渲染流程不变时每帧的放置结果相同，直接复用上一帧创建的RHI资源
+class RDGTransientAllocator
+{
+public:
+    struct Placement
+    {
+        uint32_t first;         // 生命周期，按pass执行顺序的闭区间
+        uint32_t last;
+        uint64_t size;
+        uint64_t alignment;
+
+        uint64_t offset = 0;    // 放置结果
+    };
+
+    struct Stats                // 临时资源的显存占用，字节
+    {
+        uint32_t resourceCount = 0;
+        uint64_t pooledBytes = 0;       // 按资源池整对象复用的方式所需的峰值
+        uint64_t placedBytes = 0;       // 放置后各heap所需的大小之和
+    };
+
+    static uint64_t Place(std::vector<Placement>& placements);     // 返回所需的heap大小
+
+    RHIMemoryRequirements GetMemoryRequirements(const RHITextureInfo& info);   // 结果按info缓存
+    RHIMemoryRequirements GetMemoryRequirements(const RHIBufferInfo& info);
+
+    RHIHeapRef GetHeap(uint64_t key, const RHIHeapInfo& info);                 // 同一个key只持有一个heap，容量不足时重新创建
+    RHITextureRef GetTexture(const RHITextureInfo& info, RHIHeapRef heap, uint64_t offset);
+    RHIBufferRef GetBuffer(const RHIBufferInfo& info, RHIHeapRef heap, uint64_t offset);
+
+    void Tick();                // 每次编译调用一次，清理长时间没有再被放置的资源
+
+    inline const Stats& GetStats()              { return stats; }       // 最近一次编译的统计
+    inline void SetStats(const Stats& newStats) { stats = newStats; }
+    inline uint64_t HeapBytes()                 { return heapBytes; }   // 实际持有的heap大小之和，只增不减
+
+    static RHITextureInfo Normalize(const RHITextureInfo& info)
+    {
+        RHITextureInfo ret = info;
+        if(ret.mipLevels == 0) ret.mipLevels = ret.extent.MipSize();     // 和RDGTexturePool一致，处理一下自动的mipLevels
+        return ret;
+    }
+
+    static std::shared_ptr<RDGTransientAllocator> Get()
+    {
+        static std::shared_ptr<RDGTransientAllocator> allocator;
+        if(allocator == nullptr) allocator = std::make_shared<RDGTransientAllocator>();
+        return allocator;
+    }
+
+private:
+    static const uint32_t MAX_UNUSED_TICKS = 8;
+
+    struct InfoHash {
+        size_t operator()(const RHITextureInfo& a) const    { return MurmurHash64A(&a, sizeof(RHITextureInfo), 0); }
+        size_t operator()(const RHIBufferInfo& a) const     // 结构体有填充，逐个字段计算
+        {
+            uint64_t fields[4] = { a.size, a.memoryUsage, a.type, a.creationFlag };
+            return MurmurHash64A(fields, sizeof(fields), 0);
+        }
+    };
+    struct InfoEqual {
+        bool operator()(const RHITextureInfo& a, const RHITextureInfo& b) const { return a == b; }
+        bool operator()(const RHIBufferInfo& a, const RHIBufferInfo& b) const   { return a.size == b.size && a.memoryUsage == b.memoryUsage && a.type == b.type && a.creationFlag == b.creationFlag; }
+    };
+
+    template<typename Info>
+    struct Key
+    {
+        Info info;
+        RHIHeap* heap;
+        uint64_t offset;
+
+        bool operator== (const Key& other) const
+        {
+            return  InfoEqual()(info, other.info) &&
+                    heap == other.heap &&
+                    offset == other.offset;
+        }
+
+        struct Hash {
+            size_t operator()(const Key& a) const {
+                return  InfoHash()(a.info) ^
+                        (std::hash<RHIHeap*>()(a.heap) << 1) ^
+                        (std::hash<uint64_t>()(a.offset) << 2);
+            }
+        };
+    };
+
+    template<typename Ref>
+    struct Placed
+    {
+        Ref resource;
+        uint32_t unusedTicks = 0;
+    };
+
+    std::unordered_map<RHITextureInfo, RHIMemoryRequirements, InfoHash, InfoEqual> textureRequirements;
+    std::unordered_map<RHIBufferInfo, RHIMemoryRequirements, InfoHash, InfoEqual> bufferRequirements;
+
+    std::unordered_map<uint64_t, RHIHeapRef> heaps;
+    std::unordered_map<Key<RHITextureInfo>, Placed<RHITextureRef>, typename Key<RHITextureInfo>::Hash> placedTextures;
+    std::unordered_map<Key<RHIBufferInfo>, Placed<RHIBufferRef>, typename Key<RHIBufferInfo>::Hash> placedBuffers;
+
+    uint64_t heapBytes = 0;
+    Stats stats;
 };
@@ -0,0 +1,595 @@
+#include "NullRHI.h"
+#include "NullRHIResource.h"
+#include "Function/Render/RHI/RHIResource.h"
+#include "Function/Render/RHI/RHIStructs.h"
+#include "Function/Render/RHI/RHI.h"
+#include "Function/Global/Definations.h"
+#include "Platform/HAL/PlatformProcess.h"
+#include "Platform/HAL/ScopeLock.h"
+#include "Core/Log/Log.h"
+#include "implot.h"
+
+#include <imgui.h>
+#include "ImGuizmo.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// 拷贝指令在CPU端真实执行，便于校验上传/回读的数据
+static void CopyBufferData(RHIBufferRef src, uint64_t srcOffset, RHIBufferRef dst, uint64_t dstOffset, uint64_t size)
+{
+    if(srcOffset + size > src->GetInfo().size || dstOffset + size > dst->GetInfo().size)
+    {
+        LOG_FATAL("Buffer copy out of range!");
+    }
+    memcpy(NullResourceCast(dst)->GetData() + dstOffset, NullResourceCast(src)->GetData() + srcOffset, size);
+}
+
+static void CopyBufferTextureData(RHIBufferRef buffer, uint64_t bufferOffset, RHITextureRef texture, TextureSubresourceLayers subresource, bool toTexture)
+{
+    NullRHITexture* nullTexture = NullResourceCast(texture.get());
+    NullRHIBuffer* nullBuffer = NullResourceCast(buffer.get());
+
+    uint32_t layerCount = subresource.layerCount == 0 ? 1 : subresource.layerCount;
+    uint64_t begin = nullTexture->GetSubresourceOffset(subresource.mipLevel, subresource.baseArrayLayer);
+    uint64_t end = nullTexture->GetSubresourceOffset(subresource.mipLevel, subresource.baseArrayLayer + layerCount);
+    uint64_t size = std::min(end - begin, buffer->GetInfo().size - std::min(bufferOffset, buffer->GetInfo().size));
+
+    if(toTexture)   memcpy(nullTexture->GetData() + begin, nullBuffer->GetData() + bufferOffset, size);
+    else            memcpy(nullBuffer->GetData() + bufferOffset, nullTexture->GetData() + begin, size);
+}
+
+NullRHIBackend::NullRHIBackend(const RHIBackendInfo& info)
+: RHIBackend(info)
+, sync(PlatformProcess::CreateMutex())
+{
+    for (uint32_t i = 0; i < QUEUE_TYPE_MAX_ENUM; i++)
+    {
+        for(uint32_t j = 0; j < MAX_QUEUE_CNT; j++)
+        {
+            RHIQueueInfo queueInfo = { .type = (QueueType)i, .index = j };
+            queues[i][j] = Register(std::make_shared<NullRHIQueue>(queueInfo));
+        }
+    }
+
+    immediateCommandContext = Register(std::make_shared<NullRHICommandContextImmediate>(*this));
+
+    CommandListImmediateInfo commandInfo = {
+        .context = immediateCommandContext
+    };
+    immediateCommand = std::make_shared<RHICommandListImmediate>(commandInfo);
+}
+
+void NullRHIBackend::Tick()
+{
+    RHIBackend::Tick();
+}
+
+void NullRHIBackend::Destroy()
+{
+    if(initImGui)
+    {
+        ImPlot::DestroyContext();
+        ImGui::DestroyContext();
+    }
+
+    RHIBackend::Destroy();
+}
+
+//ImGui ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void NullRHIBackend::InitImGui(GLFWwindow* window)
+{
+    initImGui = true;
+
+    // 只创建上下文，UI逻辑照常执行，但没有平台和渲染后端
+	IMGUI_CHECKVERSION();
+	ImGui::CreateContext();
+    ImPlot::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(WINDOW_WIDTH, WINDOW_HEIGHT);
+    io.DeltaTime = 1.0f / 60.0f;
+}
+
+//基本资源 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RHIQueueRef NullRHIBackend::GetQueue(const RHIQueueInfo& info)
+{
+    return queues[info.type][info.index];
+}
+
+RHISurfaceRef NullRHIBackend::CreateSurface(GLFWwindow* window)
+{
+    return Register(std::make_shared<NullRHISurface>(window, *this));
+}
+
+RHISwapchainRef NullRHIBackend::CreateSwapChain(const RHISwapchainInfo& info)
+{
+    return Register(std::make_shared<NullRHISwapchain>(info, *this));
+}
+
+RHICommandPoolRef NullRHIBackend::CreateCommandPool(const RHICommandPoolInfo& info)
+{
+    return Register(std::make_shared<NullRHICommandPool>(info, *this));
+}
+
+RHICommandContextRef NullRHIBackend::CreateCommandContext(RHICommandPoolRef pool)
+{
+    return Register(std::make_shared<NullRHICommandContext>(pool, *this));
+}
+
+//缓冲，纹理，着色器，加速结构 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RHIBufferRef NullRHIBackend::CreateBuffer(const RHIBufferInfo& info)
+{
+    return Register(std::make_shared<NullRHIBuffer>(info, *this));
+}
+
+RHITextureRef NullRHIBackend::CreateTexture(const RHITextureInfo& info)
+{
+    return Register(std::make_shared<NullRHITexture>(info, *this));
+}
+
+RHIHeapRef NullRHIBackend::CreateHeap(const RHIHeapInfo& info)
+{
+    return Register(std::make_shared<NullRHIHeap>(info, *this));
+}
+
+RHIMemoryRequirements NullRHIBackend::GetMemoryRequirements(const RHIBufferInfo& info)
+{
+    // 对齐参照D3D12的放置资源，只有一种内存类型
+    return { info.size, 256, 1 };
+}
+
+RHIMemoryRequirements NullRHIBackend::GetMemoryRequirements(const RHITextureInfo& info)
+{
+    return { NullRHITexture::SubresourceOffset(info, info.mipLevels, 0), 65536, 1 };
+}
+
+RHIBufferRef NullRHIBackend::CreatePlacedBuffer(const RHIBufferInfo& info, RHIHeapRef heap, uint64_t offset)
+{
+    return Register(std::make_shared<NullRHIBuffer>(info, *this, heap, offset));
+}
+
+RHITextureRef NullRHIBackend::CreatePlacedTexture(const RHITextureInfo& info, RHIHeapRef heap, uint64_t offset)
+{
+    return Register(std::make_shared<NullRHITexture>(info, *this, heap, offset));
+}
+
+RHITextureViewRef NullRHIBackend::CreateTextureView(const RHITextureViewInfo& info)
+{
+    return Register(std::make_shared<NullRHITextureView>(info, *this));
+}
+
+RHISamplerRef NullRHIBackend::CreateSampler(const RHISamplerInfo& info)
+{
+    return Register(std::make_shared<NullRHISampler>(info, *this));
+}
+
+RHIShaderRef NullRHIBackend::CreateShader(const RHIShaderInfo& info)
+{
+    return Register(std::make_shared<NullRHIShader>(info, *this));
+}
+
+RHIShaderBindingTableRef NullRHIBackend::CreateShaderBindingTable(const RHIShaderBindingTableInfo& info)
+{
+    return Register(std::make_shared<NullRHIShaderBindingTable>(info, *this));
+}
+
+RHITopLevelAccelerationStructureRef NullRHIBackend::CreateTopLevelAccelerationStructure(const RHITopLevelAccelerationStructureInfo& info)
+{
+    return Register(std::make_shared<NullRHITopLevelAccelerationStructure>(info, *this));
+}
+
+RHIBottomLevelAccelerationStructureRef NullRHIBackend::CreateBottomLevelAccelerationStructure(const RHIBottomLevelAccelerationStructureInfo& info)
+{
+    return Register(std::make_shared<NullRHIBottomLevelAccelerationStructure>(info, *this));
+}
+
+//根签名，描述符 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RHIRootSignatureRef NullRHIBackend::CreateRootSignature(const RHIRootSignatureInfo& info)
+{
+    return Register(std::make_shared<NullRHIRootSignature>(info, *this));
+}
+
+//管线状态 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RHIRenderPassRef NullRHIBackend::CreateRenderPass(const RHIRenderPassInfo& info)
+{
+    return Register(std::make_shared<NullRHIRenderPass>(info, *this));
+}
+
+RHIGraphicsPipelineRef NullRHIBackend::CreateGraphicsPipeline(const RHIGraphicsPipelineInfo& info)
+{
+    return Register(std::make_shared<NullRHIGraphicsPipeline>(info, *this));
+}
+
+RHIComputePipelineRef NullRHIBackend::CreateComputePipeline(const RHIComputePipelineInfo& info)
+{
+    return Register(std::make_shared<NullRHIComputePipeline>(info, *this));
+}
+
+RHIRayTracingPipelineRef NullRHIBackend::CreateRayTracingPipeline(const RHIRayTracingPipelineInfo& info)
+{
+    return Register(std::make_shared<NullRHIRayTracingPipeline>(info, *this));
+}
+
+//同步 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RHIFenceRef NullRHIBackend::CreateFence(bool signaled)
+{
+    return Register(std::make_shared<NullRHIFence>(signaled, *this));
+}
+
+RHISemaphoreRef NullRHIBackend::CreateSemaphore()
+{
+    return Register(std::make_shared<NullRHISemaphore>(*this));
+}
+
+//立即模式的命令接口 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RHICommandListImmediateRef NullRHIBackend::GetImmediateCommand()
+{
+    return immediateCommand;
+}
+
+//统计 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+NullRHIStatistics NullRHIBackend::GetStatistics()
+{
+    ScopeLock lock(sync);
+    return statistics;
+}
+
+void NullRHIBackend::ResetStatistics()
+{
+    ScopeLock lock(sync);
+    uint64_t bufferBytes = statistics.allocatedBufferBytes;     // 内存占用是当前状态，不随重置清零
+    uint64_t textureBytes = statistics.allocatedTextureBytes;
+    statistics = {};
+    statistics.allocatedBufferBytes = bufferBytes;
+    statistics.allocatedTextureBytes = textureBytes;
+}
+
+uint64_t NullRHIBackend::OnCommandsSubmitted(const std::vector<NullRHICommandRecord>& records)
+{
+    ScopeLock lock(sync);
+    for(auto& record : records) statistics.commandCounts[record.type]++;
+    return ++statistics.submitCount;
+}
+
+void NullRHIBackend::OnFlush()
+{
+    ScopeLock lock(sync);
+    statistics.flushCount++;
+}
+
+void NullRHIBackend::OnDescriptorUpdate(uint32_t count)
+{
+    ScopeLock lock(sync);
+    statistics.descriptorUpdateCount += count;
+    statistics.descriptorBatchCount++;
+}
+
+void NullRHIBackend::OnCreate(RHIResourceType type)
+{
+    ScopeLock lock(sync);
+    statistics.createCounts[type]++;
+}
+
+void NullRHIBackend::OnAllocate(RHIResourceType type, uint64_t size)
+{
+    ScopeLock lock(sync);
+    if(type == RHI_BUFFER)  statistics.allocatedBufferBytes += size;
+    if(type == RHI_TEXTURE) statistics.allocatedTextureBytes += size;
+    if(type == RHI_HEAP)    statistics.allocatedHeapBytes += size;
+}
+
+void NullRHIBackend::OnRelease(RHIResourceType type, uint64_t size)
+{
+    ScopeLock lock(sync);
+    if(type == RHI_BUFFER)  statistics.allocatedBufferBytes -= size;
+    if(type == RHI_TEXTURE) statistics.allocatedTextureBytes -= size;
+    if(type == RHI_HEAP)    statistics.allocatedHeapBytes -= size;
+}
+
+
+
+
+
+
+
+NullRHICommandContext::NullRHICommandContext(RHICommandPoolRef pool, NullRHIBackend& backend)
+: RHICommandContext(pool)
+, backend(backend)
+{}
+
+void NullRHICommandContext::BeginCommand()
+{
+    records.clear();
+    recording = true;
+}
+
+void NullRHICommandContext::EndCommand()
+{
+    if(!recording) LOG_FATAL("Command context is not recording!");
+    recording = false;
+}
+
+void NullRHICommandContext::Execute(RHIFenceRef fence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore)
+{
+    Execute({}, fence, waitSemaphore, signalSemaphore);
+}
+
+void NullRHICommandContext::Execute(const std::vector<RHICommandContextRef>& following, RHIFenceRef fence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore)
+{
+    if(recording) LOG_FATAL("Command context is still recording!");
+
+    for(auto& context : following)      // 按提交顺序拼接，整批只算一次提交
+    {
+        NullRHICommandContext* other = static_cast<NullRHICommandContext*>(context.get());
+        if(other->recording) LOG_FATAL("Command context is still recording!");
+
+        records.insert(records.end(), other->records.begin(), other->records.end());
+        other->submitted = std::move(other->records);
+        other->records.clear();
+    }
+
+    uint64_t submitIndex = backend.OnCommandsSubmitted(records);
+    submitted = std::move(records);
+    records.clear();
+
+    if(fence != nullptr) NullResourceCast(fence)->Signal(submitIndex);
+}
+
+void NullRHICommandContext::TextureBarrier(const RHITextureBarrier& barrier)
+{
+    Record(NULL_RHI_COMMAND_TEXTURE_BARRIER, barrier.texture.get(), { barrier.srcState, barrier.dstState });
+}
+
+void NullRHICommandContext::BufferBarrier(const RHIBufferBarrier& barrier)
+{
+    Record(NULL_RHI_COMMAND_BUFFER_BARRIER, barrier.buffer.get(), { barrier.srcState, barrier.dstState });
+}
+
+void NullRHICommandContext::TextureBarriers(const std::vector<RHITextureBarrier>& barriers)
+{
+    // 逐条记录，和单条屏障的输出可以直接比较
+    for(const auto& barrier : barriers) TextureBarrier(barrier);
+}
+
+void NullRHICommandContext::BufferBarriers(const std::vector<RHIBufferBarrier>& barriers)
+{
+    for(const auto& barrier : barriers) BufferBarrier(barrier);
+}
+
+void NullRHICommandContext::CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset)
+{
+    Record(NULL_RHI_COMMAND_COPY_TEXTURE_TO_BUFFER, src.get(), { dstOffset });
+    CopyBufferTextureData(dst, dstOffset, src, srcSubresource, false);
+}
+
+void NullRHICommandContext::CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource)
+{
+    Record(NULL_RHI_COMMAND_COPY_BUFFER_TO_TEXTURE, src.get(), { srcOffset });
+    CopyBufferTextureData(src, srcOffset, dst, dstSubresource, true);
+}
+
+void NullRHICommandContext::CopyBuffer(RHIBufferRef src, uint64_t srcOffset, RHIBufferRef dst, uint64_t dstOffset, uint64_t size)
+{
+    Record(NULL_RHI_COMMAND_COPY_BUFFER, src.get(), { srcOffset, dstOffset, size });
+    CopyBufferData(src, srcOffset, dst, dstOffset, size);
+}
+
+void NullRHICommandContext::CopyTexture(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHITextureRef dst, TextureSubresourceLayers dstSubresource)
+{
+    Record(NULL_RHI_COMMAND_COPY_TEXTURE, src.get());
+}
+
+void NullRHICommandContext::GenerateMips(RHITextureRef src)
+{
+    Record(NULL_RHI_COMMAND_GENERATE_MIPS, src.get());
+}
+
+void NullRHICommandContext::PushEvent(const std::string& name, Color3 color)
+{
+    Record(NULL_RHI_COMMAND_PUSH_EVENT);
+}
+
+void NullRHICommandContext::PopEvent()
+{
+    Record(NULL_RHI_COMMAND_POP_EVENT);
+}
+
+void NullRHICommandContext::BeginRenderPass(RHIRenderPassRef renderPass)
+{
+    Record(NULL_RHI_COMMAND_BEGIN_RENDER_PASS, renderPass.get());
+}
+
+void NullRHICommandContext::EndRenderPass()
+{
+    Record(NULL_RHI_COMMAND_END_RENDER_PASS);
+}
+
+void NullRHICommandContext::SetViewport(Offset2D min, Offset2D max)
+{
+    Record(NULL_RHI_COMMAND_SET_VIEWPORT, nullptr, { (uint64_t)min.x, (uint64_t)min.y, (uint64_t)max.x, (uint64_t)max.y });
+}
+
+void NullRHICommandContext::SetScissor(Offset2D min, Offset2D max)
+{
+    Record(NULL_RHI_COMMAND_SET_SCISSOR, nullptr, { (uint64_t)min.x, (uint64_t)min.y, (uint64_t)max.x, (uint64_t)max.y });
+}
+
+void NullRHICommandContext::ClearScissors(const std::vector<ClearAttachment>& attachments, const std::vector<Rect2D>& scissors, uint32_t baseArrayLayer, uint32_t layerCount)
+{
+    Record(NULL_RHI_COMMAND_CLEAR_SCISSORS, nullptr, { attachments.size(), scissors.size(), baseArrayLayer, layerCount });
+}
+
+void NullRHICommandContext::SetDepthBias(float constantBias, float slopeBias, float clampBias)
+{
+    Record(NULL_RHI_COMMAND_SET_DEPTH_BIAS);
+}
+
+void NullRHICommandContext::SetLineWidth(float width)
+{
+    Record(NULL_RHI_COMMAND_SET_LINE_WIDTH);
+}
+
+void NullRHICommandContext::SetGraphicsPipeline(RHIGraphicsPipelineRef graphicsPipeline)
+{
+    Record(NULL_RHI_COMMAND_SET_GRAPHICS_PIPELINE, graphicsPipeline.get());
+}
+
+void NullRHICommandContext::SetComputePipeline(RHIComputePipelineRef computePipeline)
+{
+    Record(NULL_RHI_COMMAND_SET_COMPUTE_PIPELINE, computePipeline.get());
+}
+
+void NullRHICommandContext::SetRayTracingPipeline(RHIRayTracingPipelineRef rayTracingPipeline)
+{
+    Record(NULL_RHI_COMMAND_SET_RAY_TRACING_PIPELINE, rayTracingPipeline.get());
+}
+
+void NullRHICommandContext::PushConstants(void* data, uint16_t size, ShaderFrequency frequency)
+{
+    Record(NULL_RHI_COMMAND_PUSH_CONSTANTS, nullptr, { size, frequency });
+}
+
+void NullRHICommandContext::BindDescriptorSet(RHIDescriptorSetRef descriptor, uint32_t set)
+{
+    Record(NULL_RHI_COMMAND_BIND_DESCRIPTOR_SET, descriptor.get(), { set });
+}
+
+void NullRHICommandContext::BindVertexBuffer(RHIBufferRef vertexBuffer, uint32_t streamIndex, uint32_t offset)
+{
+    Record(NULL_RHI_COMMAND_BIND_VERTEX_BUFFER, vertexBuffer.get(), { streamIndex, offset });
+}
+
+void NullRHICommandContext::BindIndexBuffer(RHIBufferRef indexBuffer, uint32_t offset)
+{
+    Record(NULL_RHI_COMMAND_BIND_INDEX_BUFFER, indexBuffer.get(), { offset });
+}
+
+void NullRHICommandContext::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    Record(NULL_RHI_COMMAND_DISPATCH, nullptr, { groupCountX, groupCountY, groupCountZ });
+}
+
+void NullRHICommandContext::DispatchIndirect(RHIBufferRef argumentBuffer, uint32_t argumentOffset)
+{
+    Record(NULL_RHI_COMMAND_DISPATCH_INDIRECT, argumentBuffer.get(), { argumentOffset });
+}
+
+void NullRHICommandContext::TraceRays(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    Record(NULL_RHI_COMMAND_TRACE_RAYS, nullptr, { groupCountX, groupCountY, groupCountZ });
+}
+
+void NullRHICommandContext::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance)
+{
+    Record(NULL_RHI_COMMAND_DRAW, nullptr, { vertexCount, instanceCount, firstVertex, firstInstance });
+}
+
+void NullRHICommandContext::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance)
+{
+    Record(NULL_RHI_COMMAND_DRAW_INDEXED, nullptr, { indexCount, instanceCount, firstIndex, vertexOffset, firstInstance });
+}
+
+void NullRHICommandContext::DrawIndirect(RHIBufferRef argumentBuffer, uint32_t offset, uint32_t drawCount)
+{
+    Record(NULL_RHI_COMMAND_DRAW_INDIRECT, argumentBuffer.get(), { offset, drawCount });
+}
+
+void NullRHICommandContext::DrawIndexedIndirect(RHIBufferRef argumentBuffer, uint32_t offset, uint32_t drawCount)
+{
+    Record(NULL_RHI_COMMAND_DRAW_INDEXED_INDIRECT, argumentBuffer.get(), { offset, drawCount });
+}
+
+void NullRHICommandContext::ImGuiCreateFontsTexture()
+{
+    unsigned char* pixels;
+    int width, height;
+    ImGui::GetIO().Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);    // 字体图集照常构建，只是不上传
+}
+
+void NullRHICommandContext::ImGuiRenderDrawData(ImGuiDrawFunc func)
+{
+    ImGui::NewFrame();
+    IMGUIZMO_NAMESPACE::BeginFrame();
+
+    func();
+
+    ImGui::Render();
+    Record(NULL_RHI_COMMAND_IMGUI_RENDER_DRAW_DATA, nullptr, { (uint64_t)ImGui::GetDrawData()->TotalVtxCount });
+}
+
+
+
+
+
+
+
+NullRHICommandContextImmediate::NullRHICommandContextImmediate(NullRHIBackend& backend)
+: RHICommandContextImmediate()
+, backend(backend)
+{}
+
+void NullRHICommandContextImmediate::Flush()
+{
+    backend.OnFlush();
+    backend.OnCommandsSubmitted(records);
+    records.clear();
+}
+
+void NullRHICommandContextImmediate::TextureBarrier(const RHITextureBarrier& barrier)
+{
+    Record(NULL_RHI_COMMAND_TEXTURE_BARRIER, barrier.texture.get(), { barrier.srcState, barrier.dstState });
+}
+
+void NullRHICommandContextImmediate::BufferBarrier(const RHIBufferBarrier& barrier)
+{
+    Record(NULL_RHI_COMMAND_BUFFER_BARRIER, barrier.buffer.get(), { barrier.srcState, barrier.dstState });
+}
+
+void NullRHICommandContextImmediate::TextureBarriers(const std::vector<RHITextureBarrier>& barriers)
+{
+    for(const auto& barrier : barriers) TextureBarrier(barrier);
+}
+
+void NullRHICommandContextImmediate::BufferBarriers(const std::vector<RHIBufferBarrier>& barriers)
+{
+    for(const auto& barrier : barriers) BufferBarrier(barrier);
+}
+
+void NullRHICommandContextImmediate::CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset)
+{
+    Record(NULL_RHI_COMMAND_COPY_TEXTURE_TO_BUFFER, src.get(), { dstOffset });
+    CopyBufferTextureData(dst, dstOffset, src, srcSubresource, false);
+}
+
+void NullRHICommandContextImmediate::CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource)
+{
+    Record(NULL_RHI_COMMAND_COPY_BUFFER_TO_TEXTURE, src.get(), { srcOffset });
+    CopyBufferTextureData(src, srcOffset, dst, dstSubresource, true);
+}
+
+void NullRHICommandContextImmediate::CopyBuffer(RHIBufferRef src, uint64_t srcOffset, RHIBufferRef dst, uint64_t dstOffset, uint64_t size)
+{
+    Record(NULL_RHI_COMMAND_COPY_BUFFER, src.get(), { srcOffset, dstOffset, size });
+    CopyBufferData(src, srcOffset, dst, dstOffset, size);
+}
+
+void NullRHICommandContextImmediate::CopyTexture(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHITextureRef dst, TextureSubresourceLayers dstSubresource)
+{
+    Record(NULL_RHI_COMMAND_COPY_TEXTURE, src.get());
+}
+
+void NullRHICommandContextImmediate::GenerateMips(RHITextureRef src)
+{
+    Record(NULL_RHI_COMMAND_GENERATE_MIPS, src.get());
+}
@@ -0,0 +1,329 @@
+#pragma once
+
+#include "NullRHIResource.h"
+#include "Function/Render/RHI/RHI.h"
+#include "Function/Render/RHI/RHICommandList.h"
+#include "Function/Render/RHI/RHIResource.h"
+#include "Function/Render/RHI/RHIStructs.h"
+#include "Platform/HAL/Mutex.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 空后端：不依赖GPU和窗口，资源在CPU端分配，指令只做记录，提交即视为执行完成
+// 用于在没有显卡的CI机器上跑完整的渲染流程，统计和回归CPU端的开销
+
+enum NullRHICommandType
+{
+    NULL_RHI_COMMAND_TEXTURE_BARRIER = 0,
+    NULL_RHI_COMMAND_BUFFER_BARRIER,
+    NULL_RHI_COMMAND_COPY_TEXTURE_TO_BUFFER,
+    NULL_RHI_COMMAND_COPY_BUFFER_TO_TEXTURE,
+    NULL_RHI_COMMAND_COPY_BUFFER,
+    NULL_RHI_COMMAND_COPY_TEXTURE,
+    NULL_RHI_COMMAND_GENERATE_MIPS,
+    NULL_RHI_COMMAND_PUSH_EVENT,
+    NULL_RHI_COMMAND_POP_EVENT,
+    NULL_RHI_COMMAND_BEGIN_RENDER_PASS,
+    NULL_RHI_COMMAND_END_RENDER_PASS,
+    NULL_RHI_COMMAND_SET_VIEWPORT,
+    NULL_RHI_COMMAND_SET_SCISSOR,
+    NULL_RHI_COMMAND_CLEAR_SCISSORS,
+    NULL_RHI_COMMAND_SET_DEPTH_BIAS,
+    NULL_RHI_COMMAND_SET_LINE_WIDTH,
+    NULL_RHI_COMMAND_SET_GRAPHICS_PIPELINE,
+    NULL_RHI_COMMAND_SET_COMPUTE_PIPELINE,
+    NULL_RHI_COMMAND_SET_RAY_TRACING_PIPELINE,
+    NULL_RHI_COMMAND_PUSH_CONSTANTS,
+    NULL_RHI_COMMAND_BIND_DESCRIPTOR_SET,
+    NULL_RHI_COMMAND_BIND_VERTEX_BUFFER,
+    NULL_RHI_COMMAND_BIND_INDEX_BUFFER,
+    NULL_RHI_COMMAND_DISPATCH,
+    NULL_RHI_COMMAND_DISPATCH_INDIRECT,
+    NULL_RHI_COMMAND_TRACE_RAYS,
+    NULL_RHI_COMMAND_DRAW,
+    NULL_RHI_COMMAND_DRAW_INDEXED,
+    NULL_RHI_COMMAND_DRAW_INDIRECT,
+    NULL_RHI_COMMAND_DRAW_INDEXED_INDIRECT,
+    NULL_RHI_COMMAND_IMGUI_RENDER_DRAW_DATA,
+
+    NULL_RHI_COMMAND_TYPE_MAX_CNT,    //
+};
+
+typedef struct NullRHICommandRecord     // 只记录类型，主要资源和整型参数，足够做统计和校验
+{
+    NullRHICommandType type;
+    RHIResource* resource = nullptr;
+    std::array<uint64_t, 5> args = {};
+
+} NullRHICommandRecord;
+
+typedef struct NullRHIStatistics
+{
+    uint64_t submitCount = 0;           // Execute的次数，也是fence的值
+    uint64_t flushCount = 0;            // 立即模式的Flush次数
+    uint64_t descriptorUpdateCount = 0;     // 写入的描述符数目
+    uint64_t descriptorBatchCount = 0;      // 描述符更新的提交次数，对应vkUpdateDescriptorSets的调用
+
+    uint64_t allocatedBufferBytes = 0;
+    uint64_t allocatedTextureBytes = 0;
+    uint64_t allocatedHeapBytes = 0;        // 放置资源的内存只计入heap
+
+    std::array<uint64_t, NULL_RHI_COMMAND_TYPE_MAX_CNT> commandCounts = {};
+    std::array<uint64_t, RHI_RESOURCE_TYPE_MAX_CNT> createCounts = {};
+
+} NullRHIStatistics;
+
+class NullRHICommandContextImmediate;
+
+class NullRHIBackend : public RHIBackend
+{
+public:
+    NullRHIBackend() = delete;
+
+    NullRHIBackend(const RHIBackendInfo& info);
+
+    virtual void Tick() override final;
+
+    virtual void Destroy() override final;
+
+    //ImGui ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    virtual void InitImGui(GLFWwindow* window) override final;
+
+    //基本资源 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    virtual RHIQueueRef GetQueue(const RHIQueueInfo& info) override final;
+
+    virtual RHISurfaceRef CreateSurface(GLFWwindow* window) override final;
+
+    virtual RHISwapchainRef CreateSwapChain(const RHISwapchainInfo& info) override final;
+
+    virtual RHICommandPoolRef CreateCommandPool(const RHICommandPoolInfo& info) override final;
+
+    virtual RHICommandContextRef CreateCommandContext(RHICommandPoolRef pool) override final;
+
+    //缓冲，纹理，着色器，加速结构 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    virtual RHIBufferRef CreateBuffer(const RHIBufferInfo& info) override final;
+
+    virtual RHITextureRef CreateTexture(const RHITextureInfo& info) override final;
+
+    virtual RHIHeapRef CreateHeap(const RHIHeapInfo& info) override final;
+
+    virtual RHIMemoryRequirements GetMemoryRequirements(const RHIBufferInfo& info) override final;
+
+    virtual RHIMemoryRequirements GetMemoryRequirements(const RHITextureInfo& info) override final;
+
+    virtual RHIBufferRef CreatePlacedBuffer(const RHIBufferInfo& info, RHIHeapRef heap, uint64_t offset) override final;
+
+    virtual RHITextureRef CreatePlacedTexture(const RHITextureInfo& info, RHIHeapRef heap, uint64_t offset) override final;
+
+    virtual RHITextureViewRef CreateTextureView(const RHITextureViewInfo& info) override final;
+
+    virtual RHISamplerRef CreateSampler(const RHISamplerInfo& info) override final;
+
+    virtual RHIShaderRef CreateShader(const RHIShaderInfo& info) override final;
+
+    virtual RHIShaderBindingTableRef CreateShaderBindingTable(const RHIShaderBindingTableInfo& info) override final;
+
+    virtual RHITopLevelAccelerationStructureRef CreateTopLevelAccelerationStructure(const RHITopLevelAccelerationStructureInfo& info) override final;
+
+    virtual RHIBottomLevelAccelerationStructureRef CreateBottomLevelAccelerationStructure(const RHIBottomLevelAccelerationStructureInfo& info) override final;
+
+    //根签名，描述符 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    virtual RHIRootSignatureRef CreateRootSignature(const RHIRootSignatureInfo& info) override final;
+
+    //管线状态 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    virtual RHIRenderPassRef CreateRenderPass(const RHIRenderPassInfo& info) override final;
+
+    virtual RHIGraphicsPipelineRef CreateGraphicsPipeline(const RHIGraphicsPipelineInfo& info) override final;
+
+    virtual RHIComputePipelineRef CreateComputePipeline(const RHIComputePipelineInfo& info) override final;
+
+    virtual RHIRayTracingPipelineRef CreateRayTracingPipeline(const RHIRayTracingPipelineInfo& info) override final;
+
+    //同步 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    virtual RHIFenceRef CreateFence(bool signaled = false) override final;
+
+    virtual RHISemaphoreRef CreateSemaphore() override final;
+
+    //立即模式的命令接口 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    virtual RHICommandListImmediateRef GetImmediateCommand() override final;
+
+public:
+    NullRHIStatistics GetStatistics();      // 返回拷贝，可在任意线程调用
+    void ResetStatistics();
+
+    uint64_t OnCommandsSubmitted(const std::vector<NullRHICommandRecord>& records);
+    void OnFlush();
+    void OnDescriptorUpdate(uint32_t count);
+    void OnCreate(RHIResourceType type);
+    void OnAllocate(RHIResourceType type, uint64_t size);  // 仅统计heap，buffer和texture的内存
+    void OnRelease(RHIResourceType type, uint64_t size);
+
+private:
+    std::array<std::array<RHIQueueRef, MAX_QUEUE_CNT>, QUEUE_TYPE_MAX_ENUM> queues;
+
+    // 立即模式命令队列
+    RHICommandContextImmediateRef immediateCommandContext;
+    RHICommandListImmediateRef immediateCommand;
+
+    // 统计
+    NullRHIStatistics statistics;
+    MutexRef sync;
+
+    bool initImGui = false;
+
+    template<typename T>
+    T Register(T resource)
+    {
+        OnCreate(resource->GetType());
+        RegisterResource(resource);
+        return resource;
+    }
+
+    friend class NullRHIRootSignature;      // 调用RegisterResource
+};
+
+
+class NullRHICommandContext : public RHICommandContext
+{
+public:
+    NullRHICommandContext(RHICommandPoolRef pool, NullRHIBackend& backend);
+
+    virtual void BeginCommand() override final;
+
+	virtual void EndCommand() override final;
+
+    virtual void Execute(RHIFenceRef fence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore) override final;
+
+    virtual void Execute(const std::vector<RHICommandContextRef>& following, RHIFenceRef fence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore) override final;
+
+    virtual void TextureBarrier(const RHITextureBarrier& barrier) override final;
+
+    virtual void BufferBarrier(const RHIBufferBarrier& barrier) override final;
+
+    virtual void TextureBarriers(const std::vector<RHITextureBarrier>& barriers) override final;
+
+    virtual void BufferBarriers(const std::vector<RHIBufferBarrier>& barriers) override final;
+
+    virtual void CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset) override final;
+
+    virtual void CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource) override final;
+
+    virtual void CopyBuffer(RHIBufferRef src, uint64_t srcOffset, RHIBufferRef dst, uint64_t dstOffset, uint64_t size) override final;
+
+    virtual void CopyTexture(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHITextureRef dst, TextureSubresourceLayers dstSubresource) override final;
+
+    virtual void GenerateMips(RHITextureRef src) override final;
+
+    virtual void PushEvent(const std::string& name, Color3 color) override final;
+
+	virtual void PopEvent() override final;
+
+    virtual void BeginRenderPass(RHIRenderPassRef renderPass) override final;
+
+	virtual void EndRenderPass() override final;
+
+    virtual void SetViewport(Offset2D min, Offset2D max) override final;
+
+    virtual void SetScissor(Offset2D min, Offset2D max) override final;
+
+    virtual void ClearScissors(const std::vector<ClearAttachment>& attachments, const std::vector<Rect2D>& scissors, uint32_t baseArrayLayer, uint32_t layerCount) override final;
+
+    virtual void SetDepthBias(float constantBias, float slopeBias, float clampBias) override final;
+
+    virtual void SetLineWidth(float width) override final;
+
+    virtual void SetGraphicsPipeline(RHIGraphicsPipelineRef graphicsPipeline) override final;
+
+    virtual void SetComputePipeline(RHIComputePipelineRef computePipeline) override final;
+
+    virtual void SetRayTracingPipeline(RHIRayTracingPipelineRef rayTracingPipeline) override final;
+
+    virtual void PushConstants(void* data, uint16_t size, ShaderFrequency frequency) override final;
+
+    virtual void BindDescriptorSet(RHIDescriptorSetRef descriptor, uint32_t set) override final;
+
+    virtual void BindVertexBuffer(RHIBufferRef vertexBuffer, uint32_t streamIndex, uint32_t offset) override final;
+
+    virtual void BindIndexBuffer(RHIBufferRef indexBuffer, uint32_t offset) override final;
+
+	virtual void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override final;
+
+	virtual void DispatchIndirect(RHIBufferRef argumentBuffer, uint32_t argumentOffset) override final;
+
+    virtual void TraceRays(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override final;
+
+    virtual void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) override final;
+
+    virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance) override final;
+
+    virtual void DrawIndirect(RHIBufferRef argumentBuffer, uint32_t offset, uint32_t drawCount) override final;
+
+    virtual void DrawIndexedIndirect(RHIBufferRef argumentBuffer, uint32_t offset, uint32_t drawCount) override final;
+
+    //ImGui /////////////////////////////////////////////////////////////////////////////////////
+
+    virtual void ImGuiCreateFontsTexture() override final;
+
+    virtual void ImGuiRenderDrawData(ImGuiDrawFunc func) override final;
+
+    inline const std::vector<NullRHICommandRecord>& GetRecords() const 		{ return records; }		// 正在录制的指令
+    inline const std::vector<NullRHICommandRecord>& GetSubmitted() const 	{ return submitted; }	// 最近一次提交的指令，合并提交时包含following的指令
+
+private:
+    NullRHIBackend& backend;
+
+    std::vector<NullRHICommandRecord> records;
+    std::vector<NullRHICommandRecord> submitted;
+    bool recording = false;
+
+    inline void Record(NullRHICommandType type, RHIResource* resource = nullptr, std::array<uint64_t, 5> args = {})
+    {
+        records.push_back({ type, resource, args });
+    }
+};
+
+class NullRHICommandContextImmediate : public RHICommandContextImmediate
+{
+public:
+    NullRHICommandContextImmediate(NullRHIBackend& backend);
+
+    virtual void Flush() override final;
+
+    virtual void TextureBarrier(const RHITextureBarrier& barrier) override final;
+
+    virtual void BufferBarrier(const RHIBufferBarrier& barrier) override final;
+
+    virtual void TextureBarriers(const std::vector<RHITextureBarrier>& barriers) override final;
+
+    virtual void BufferBarriers(const std::vector<RHIBufferBarrier>& barriers) override final;
+
+    virtual void CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset) override final;
+
+    virtual void CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource) override final;
+
+    virtual void CopyBuffer(RHIBufferRef src, uint64_t srcOffset, RHIBufferRef dst, uint64_t dstOffset, uint64_t size) override final;
+
+    virtual void CopyTexture(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHITextureRef dst, TextureSubresourceLayers dstSubresource) override final;
+
+    virtual void GenerateMips(RHITextureRef src) override final;
+
+private:
+    NullRHIBackend& backend;
+
+    std::vector<NullRHICommandRecord> records;
+
+    inline void Record(NullRHICommandType type, RHIResource* resource = nullptr, std::array<uint64_t, 5> args = {})
+    {
+        records.push_back({ type, resource, args });
+    }
+};
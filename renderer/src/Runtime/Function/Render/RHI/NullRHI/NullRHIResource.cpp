@@ -0,0 +1,259 @@
+#include "NullRHIResource.h"
+#include "NullRHI.h"
+#include "Function/Global/Definations.h"
+#include "Function/Render/RHI/RHIStructs.h"
+#include "Function/Render/RHI/ShaderReflect.h"
+#include "Function/Render/RHI/ShaderReflectCache.h"
+#include "Core/Log/Log.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+//基本资源 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+NullRHISurface::NullRHISurface(GLFWwindow* window, NullRHIBackend& backend)
+: RHISurface()
+{
+    extent = { WINDOW_WIDTH, WINDOW_HEIGHT };   // 无窗口时使用默认分辨率
+    if(window != nullptr)
+    {
+        int width, height;
+        glfwGetWindowSize(window, &width, &height);
+        extent = { (uint32_t)width, (uint32_t)height };
+    }
+}
+
+NullRHISwapchain::NullRHISwapchain(const RHISwapchainInfo& info, NullRHIBackend& backend)
+: RHISwapchain(info)
+{
+    for(uint32_t i = 0; i < info.imageCount; i++)
+    {
+        RHITextureInfo textureInfo = {
+            .format = info.format,
+            .extent = { info.extent.width, info.extent.height, 1},
+            .arrayLayers = 1,
+            .mipLevels = 1,
+            .memoryUsage = MEMORY_USAGE_GPU_ONLY,
+            .type = RESOURCE_TYPE_TEXTURE | RESOURCE_TYPE_RENDER_TARGET,
+            .creationFlag = TEXTURE_CREATION_NONE
+        };
+
+        textures.push_back(std::make_shared<NullRHITexture>(textureInfo, backend));
+    }
+}
+
+RHITextureRef NullRHISwapchain::GetNewFrame(RHIFenceRef fence, RHISemaphoreRef signalSemaphore)
+{
+    currentIndex = presentCount % textures.size();     // 按顺序轮转，保证结果确定
+    if(fence != nullptr) NullResourceCast(fence)->Signal(presentCount);
+
+    return textures[currentIndex];
+}
+
+void NullRHISwapchain::Present(RHISemaphoreRef waitSemaphore)
+{
+    presentCount++;
+}
+
+//缓冲，纹理，着色器，加速结构 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+NullRHIHeap::NullRHIHeap(const RHIHeapInfo& info, NullRHIBackend& backend)
+: RHIHeap(info)
+{
+    backend.OnAllocate(RHI_HEAP, info.size);
+}
+
+uint8_t* NullRHIHeap::GetData()
+{
+    if(data.size() != info.size) data.resize(info.size, 0);
+    return data.data();
+}
+
+void NullRHIHeap::Destroy()
+{
+    std::static_pointer_cast<NullRHIBackend>(RHIBackend::Get())->OnRelease(RHI_HEAP, info.size);
+    data.clear();
+    data.shrink_to_fit();
+}
+
+NullRHIBuffer::NullRHIBuffer(const RHIBufferInfo& info, NullRHIBackend& backend)
+: RHIBuffer(info)
+{
+    data.resize(info.size, 0);
+    backend.OnAllocate(RHI_BUFFER, info.size);
+}
+
+NullRHIBuffer::NullRHIBuffer(const RHIBufferInfo& info, NullRHIBackend& backend, RHIHeapRef heap, uint64_t offset)
+: RHIBuffer(info)
+, heap(heap)
+, heapOffset(offset)
+{
+    if(offset + info.size > heap->GetInfo().size) LOG_FATAL("Placed buffer out of heap range!");
+}
+
+uint8_t* NullRHIBuffer::GetData()
+{
+    if(heap) return NullResourceCast(heap)->GetData() + heapOffset;
+    return data.data();
+}
+
+void NullRHIBuffer::Destroy()
+{
+    if(heap) 
+    {
+        heap = nullptr;
+        return;
+    }
+    std::static_pointer_cast<NullRHIBackend>(RHIBackend::Get())->OnRelease(RHI_BUFFER, info.size);
+    data.clear();
+    data.shrink_to_fit();
+}
+
+void NullRHITexture::InitDefaultRange()
+{
+    TextureAspectFlags aspects =    IsDepthStencilFormat(info.format) ? TEXTURE_ASPECT_DEPTH_STENCIL :
+                                    IsDepthFormat(info.format) ? TEXTURE_ASPECT_DEPTH :
+                                    IsStencilFormat(info.format) ? TEXTURE_ASPECT_STENCIL : TEXTURE_ASPECT_COLOR;
+    defaultRange = {aspects, 0, info.mipLevels, 0, info.arrayLayers};
+    defaultLayers = {aspects, 0, 0, info.arrayLayers};
+}
+
+NullRHITexture::NullRHITexture(const RHITextureInfo& info, NullRHIBackend& backend)
+: RHITexture(info)
+{
+    InitDefaultRange();
+
+    size = GetSubresourceOffset(info.mipLevels, 0);
+    backend.OnAllocate(RHI_TEXTURE, size);
+}
+
+NullRHITexture::NullRHITexture(const RHITextureInfo& info, NullRHIBackend& backend, RHIHeapRef heap, uint64_t offset)
+: RHITexture(info)
+, heap(heap)
+, heapOffset(offset)
+{
+    InitDefaultRange();
+
+    size = GetSubresourceOffset(info.mipLevels, 0);
+    if(offset + size > heap->GetInfo().size) LOG_FATAL("Placed texture out of heap range!");
+}
+
+uint8_t* NullRHITexture::GetData()
+{
+    if(heap) return NullResourceCast(heap)->GetData() + heapOffset;
+    if(data.size() != size) data.resize(size, 0);
+    return data.data();
+}
+
+uint64_t NullRHITexture::SubresourceOffset(const RHITextureInfo& info, uint32_t mipLevel, uint32_t arrayLayer)
+{
+    // 按mip优先排布，每级mip内连续存放全部layer
+    auto mipPixels = [&](uint32_t mip) {
+        return  (uint64_t)std::max((uint32_t)1, info.extent.width >> mip) * 
+                std::max((uint32_t)1, info.extent.height >> mip) * 
+                std::max((uint32_t)1, info.extent.depth >> mip);
+    };
+
+    uint64_t pixelSize = FormatPixelSize(info.format);
+    uint64_t offset = 0;
+    for(uint32_t mip = 0; mip < std::min(mipLevel, info.mipLevels); mip++)
+    {
+        offset += pixelSize * mipPixels(mip) * info.arrayLayers;
+    }
+    if(mipLevel < info.mipLevels)
+    {
+        offset += pixelSize * mipPixels(mipLevel) * arrayLayer;
+    }
+    return offset;
+}
+
+void NullRHITexture::Destroy()
+{
+    if(heap) 
+    {
+        heap = nullptr;
+        return;
+    }
+    std::static_pointer_cast<NullRHIBackend>(RHIBackend::Get())->OnRelease(RHI_TEXTURE, size);
+    data.clear();
+    data.shrink_to_fit();
+}
+
+NullRHITextureView::NullRHITextureView(const RHITextureViewInfo& info, NullRHIBackend& backend)
+: RHITextureView(info)
+{
+    if(info.subresource.aspect == TEXTURE_ASPECT_NONE)  this->info.subresource = info.texture->GetDefaultSubresourceRange();
+    if(info.format == FORMAT_UKNOWN)                    this->info.format = info.texture->GetInfo().format;
+}
+
+NullRHIShader::NullRHIShader(const RHIShaderInfo& info, NullRHIBackend& backend)
+: RHIShader(info)
+{
+    this->info.code.clear();    // 和vulkan后端保持一致，代码不需要带着了
+
+    // 反射信息管线缓存等需要用到，照常收集，代码没有变化时直接读取文件旁边的缓存
+    if(info.path.empty() || !ShaderReflectCache::Load(info.path, info.code, reflectInfo))
+    {
+        ShaderReflect::Reflect(info.code, reflectInfo);
+        if(!info.path.empty()) ShaderReflectCache::Save(info.path, info.code, reflectInfo);
+    }
+}
+
+void NullRHITopLevelAccelerationStructure::Update(const std::vector<RHIAccelerationStructureInstanceInfo>& instanceInfos, bool build)
+{
+    if(instanceInfos.size() > info.maxInstance) LOG_FATAL("TLAS instance count exceeds the max instance count!");
+
+    instanceCount = instanceInfos.size();
+}
+
+//根签名，描述符 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+RHIDescriptorSetRef NullRHIRootSignature::CreateDescriptorSet(uint32_t set)
+{
+    RHIDescriptorSetRef descriptorSet = std::make_shared<NullRHIDescriptorSet>(set, backend);
+    backend.OnCreate(RHI_DESCRIPTOR_SET);
+    backend.RegisterResource(descriptorSet);
+
+    return descriptorSet;
+}
+
+RHIDescriptorSet& NullRHIDescriptorSet::UpdateDescriptor(const RHIDescriptorUpdateInfo& descriptorUpdateInfo)
+{
+    backend.OnDescriptorUpdate(1);
+    Write(descriptorUpdateInfo);
+
+    return *this;
+}
+
+RHIDescriptorSet& NullRHIDescriptorSet::UpdateDescriptors(const std::vector<RHIDescriptorUpdateInfo>& descriptorUpdateInfos)
+{
+    if(descriptorUpdateInfos.empty()) return *this;
+
+    backend.OnDescriptorUpdate(descriptorUpdateInfos.size());     // 和vulkan后端一致，一批写入只算一次提交
+    for(auto& info : descriptorUpdateInfos) Write(info);
+
+    return *this;
+}
+
+void NullRHIDescriptorSet::Write(const RHIDescriptorUpdateInfo& descriptorUpdateInfo)
+{
+    for(auto& binding : bindings)
+    {
+        if( binding.binding == descriptorUpdateInfo.binding &&
+            binding.index == descriptorUpdateInfo.index)
+        {
+            binding = descriptorUpdateInfo;
+            return;
+        }
+    }
+    bindings.push_back(descriptorUpdateInfo);
+}
+
+//同步 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void NullRHIFence::Wait()
+{
+    if(!signaled) LOG_DEBUG("Waiting on a fence that has never been signaled, null RHI will not block.");
+    signaled = false;
+}
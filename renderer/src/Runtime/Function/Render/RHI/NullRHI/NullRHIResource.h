@@ -0,0 +1,332 @@
+#pragma once
+
+#include "Function/Render/RHI/RHIResource.h"
+#include "Function/Render/RHI/RHIStructs.h"
+
+#include <GLFW/glfw3.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class NullRHIBackend;
+
+// 空后端的全部资源只在CPU端维护必要的数据，不持有任何图形API对象
+// buffer持有真实的CPU内存，可以正常Map读写；纹理只在被访问时才分配像素内存，避免大尺寸RT占用过多内存
+
+//基本资源 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class NullRHIQueue : public RHIQueue
+{
+public:
+	NullRHIQueue(const RHIQueueInfo& info)
+	: RHIQueue(info)
+	{}
+
+	virtual void WaitIdle() override final {}	// 指令在提交时已经"执行"完毕
+};
+
+class NullRHISurface : public RHISurface
+{
+public:
+	NullRHISurface(GLFWwindow* window, NullRHIBackend& backend);
+};
+
+class NullRHISwapchain : public RHISwapchain
+{
+public:
+	NullRHISwapchain(const RHISwapchainInfo& info, NullRHIBackend& backend);
+
+	virtual uint32_t GetCurrentFrameIndex() override final { return currentIndex; }
+	virtual RHITextureRef GetTexture(uint32_t index) override final { return textures[index]; }
+	virtual RHITextureRef GetNewFrame(RHIFenceRef fence, RHISemaphoreRef signalSemaphore) override final;
+	virtual void Present(RHISemaphoreRef waitSemaphore) override final;
+
+	inline uint64_t GetPresentCount() const { return presentCount; }
+
+private:
+	std::vector<RHITextureRef> textures;
+	uint32_t currentIndex = 0;
+	uint64_t presentCount = 0;
+};
+
+class NullRHICommandPool : public RHICommandPool
+{
+public:
+	NullRHICommandPool(const RHICommandPoolInfo& info, NullRHIBackend& backend)
+	: RHICommandPool(info)
+	{}
+
+	RHIQueueRef GetQueue() { return info.queue; }
+};
+
+//缓冲，纹理，着色器，加速结构 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class NullRHIHeap : public RHIHeap
+{
+public:
+	NullRHIHeap(const RHIHeapInfo& info, NullRHIBackend& backend);
+
+	uint8_t* GetData();												// 首次访问时才分配内存
+
+	virtual void Destroy() override final;
+
+private:
+	std::vector<uint8_t> data;
+};
+
+class NullRHIBuffer : public RHIBuffer
+{
+public:
+	NullRHIBuffer(const RHIBufferInfo& info, NullRHIBackend& backend);
+	NullRHIBuffer(const RHIBufferInfo& info, NullRHIBackend& backend, RHIHeapRef heap, uint64_t offset);		// 内存由heap持有
+
+	virtual void* Map() override final 		{ return GetData(); }
+	virtual void UnMap() override final 	{}
+
+	uint8_t* GetData();
+
+	virtual void Destroy() override final;
+	virtual void* RawHandle() override final { return GetData(); };
+
+private:
+	std::vector<uint8_t> data;
+
+	RHIHeapRef heap;
+	uint64_t heapOffset = 0;
+};
+
+class NullRHITexture : public RHITexture
+{
+public:
+	NullRHITexture(const RHITextureInfo& info, NullRHIBackend& backend);
+	NullRHITexture(const RHITextureInfo& info, NullRHIBackend& backend, RHIHeapRef heap, uint64_t offset);
+
+	static uint64_t SubresourceOffset(const RHITextureInfo& info, uint32_t mipLevel, uint32_t arrayLayer);
+
+	uint8_t* GetData();												// 首次访问时才分配像素内存
+	inline uint64_t GetSize() const 		{ return size; }		// 包含全部mip和layer的字节数
+	uint64_t GetSubresourceOffset(uint32_t mipLevel, uint32_t arrayLayer) { return SubresourceOffset(info, mipLevel, arrayLayer); }
+
+	virtual void Destroy() override final;
+
+private:
+	std::vector<uint8_t> data;
+	uint64_t size = 0;
+
+	RHIHeapRef heap;
+	uint64_t heapOffset = 0;
+
+	void InitDefaultRange();
+};
+
+class NullRHITextureView : public RHITextureView
+{
+public:
+	NullRHITextureView(const RHITextureViewInfo& info, NullRHIBackend& backend);
+};
+
+class NullRHISampler : public RHISampler
+{
+public:
+	NullRHISampler(const RHISamplerInfo& info, NullRHIBackend& backend)
+	: RHISampler(info)
+	{}
+};
+
+class NullRHIShader : public RHIShader
+{
+public:
+	NullRHIShader(const RHIShaderInfo& info, NullRHIBackend& backend);
+};
+
+class NullRHIShaderBindingTable : public RHIShaderBindingTable
+{
+public:
+	NullRHIShaderBindingTable(const RHIShaderBindingTableInfo& info, NullRHIBackend& backend)
+	: RHIShaderBindingTable(info)
+	{}
+};
+
+class NullRHITopLevelAccelerationStructure : public RHITopLevelAccelerationStructure
+{
+public:
+	NullRHITopLevelAccelerationStructure(const RHITopLevelAccelerationStructureInfo& info, NullRHIBackend& backend)
+	: RHITopLevelAccelerationStructure(info)
+	, instanceCount(info.instanceInfos.size())
+	{}
+
+	virtual void Update(const std::vector<RHIAccelerationStructureInstanceInfo>& instanceInfos, bool build = false) override final;
+
+	inline uint32_t GetInstanceCount() const { return instanceCount; }
+
+private:
+	uint32_t instanceCount = 0;
+};
+
+class NullRHIBottomLevelAccelerationStructure : public RHIBottomLevelAccelerationStructure
+{
+public:
+	NullRHIBottomLevelAccelerationStructure(const RHIBottomLevelAccelerationStructureInfo& info, NullRHIBackend& backend)
+	: RHIBottomLevelAccelerationStructure(info)
+	{}
+};
+
+//根签名，描述符 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class NullRHIRootSignature : public RHIRootSignature
+{
+public:
+	NullRHIRootSignature(const RHIRootSignatureInfo& info, NullRHIBackend& backend)
+	: RHIRootSignature(info)
+	, backend(backend)
+	{}
+
+	virtual RHIDescriptorSetRef CreateDescriptorSet(uint32_t set) override final;
+
+private:
+	NullRHIBackend& backend;
+};
+
+class NullRHIDescriptorSet : public RHIDescriptorSet
+{
+public:
+	NullRHIDescriptorSet(uint32_t set, NullRHIBackend& backend)
+	: RHIDescriptorSet()
+	, set(set)
+	, backend(backend)
+	{}
+
+	virtual RHIDescriptorSet& UpdateDescriptor(const RHIDescriptorUpdateInfo& descriptorUpdateInfo) override final;
+	virtual RHIDescriptorSet& UpdateDescriptors(const std::vector<RHIDescriptorUpdateInfo>& descriptorUpdateInfos) override final;
+
+	inline uint32_t GetSet() const 											{ return set; }
+	inline const std::vector<RHIDescriptorUpdateInfo>& GetBindings() const 	{ return bindings; }	// 每个binding和index最近一次的更新
+
+private:
+	uint32_t set;
+	NullRHIBackend& backend;
+	std::vector<RHIDescriptorUpdateInfo> bindings;
+
+	void Write(const RHIDescriptorUpdateInfo& descriptorUpdateInfo);
+};
+
+//管线状态 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class NullRHIRenderPass : public RHIRenderPass
+{
+public:
+	NullRHIRenderPass(const RHIRenderPassInfo& info, NullRHIBackend& backend)
+	: RHIRenderPass(info)
+	{}
+};
+
+class NullRHIGraphicsPipeline : public RHIGraphicsPipeline
+{
+public:
+	NullRHIGraphicsPipeline(const RHIGraphicsPipelineInfo& info, NullRHIBackend& backend)
+	: RHIGraphicsPipeline(info)
+	{}
+};
+
+class NullRHIComputePipeline : public RHIComputePipeline
+{
+public:
+	NullRHIComputePipeline(const RHIComputePipelineInfo& info, NullRHIBackend& backend)
+	: RHIComputePipeline(info)
+	{}
+};
+
+class NullRHIRayTracingPipeline : public RHIRayTracingPipeline
+{
+public:
+	NullRHIRayTracingPipeline(const RHIRayTracingPipelineInfo& info, NullRHIBackend& backend)
+	: RHIRayTracingPipeline(info)
+	{}
+};
+
+//同步 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// 提交即完成，fence的值即为触发它的提交序号，结果是确定性的
+class NullRHIFence : public RHIFence
+{
+public:
+	NullRHIFence(bool signaled, NullRHIBackend& backend)
+	: signaled(signaled)
+	{}
+
+	virtual void Wait() override final;
+
+	void Signal(uint64_t submitIndex) 			{ signaled = true; signaledValue = submitIndex; }
+	inline bool IsSignaled() const 				{ return signaled; }
+	inline uint64_t GetSignaledValue() const 	{ return signaledValue; }
+
+private:
+	bool signaled;
+	uint64_t signaledValue = 0;
+};
+
+class NullRHISemaphore : public RHISemaphore
+{
+public:
+	NullRHISemaphore(NullRHIBackend& backend)
+	{}
+};
+
+
+
+
+
+
+
+template<class T>
+struct NullResourceTraits
+{};
+
+template<>
+struct NullResourceTraits<RHIHeap>
+{
+	typedef NullRHIHeap ConcreteType;
+	typedef std::shared_ptr<NullRHIHeap> ConcretePointerType;
+};
+
+template<>
+struct NullResourceTraits<RHIBuffer>
+{
+	typedef NullRHIBuffer ConcreteType;
+	typedef std::shared_ptr<NullRHIBuffer> ConcretePointerType;
+};
+
+template<>
+struct NullResourceTraits<RHITexture>
+{
+	typedef NullRHITexture ConcreteType;
+	typedef std::shared_ptr<NullRHITexture> ConcretePointerType;
+};
+
+template<>
+struct NullResourceTraits<RHIDescriptorSet>
+{
+	typedef NullRHIDescriptorSet ConcreteType;
+	typedef std::shared_ptr<NullRHIDescriptorSet> ConcretePointerType;
+};
+
+template<>
+struct NullResourceTraits<RHIFence>
+{
+	typedef NullRHIFence ConcreteType;
+	typedef std::shared_ptr<NullRHIFence> ConcretePointerType;
+};
+
+
+// 类型萃取获得子类
+template<typename RHIType>
+static inline typename NullResourceTraits<RHIType>::ConcreteType* NullResourceCast(RHIType* resource)
+{
+	return static_cast<typename NullResourceTraits<RHIType>::ConcreteType*>(resource);
+}
+
+template<typename RHIType>
+static inline typename NullResourceTraits<RHIType>::ConcretePointerType NullResourceCast(std::shared_ptr<RHIType> resource)
+{
+	return static_pointer_cast<typename NullResourceTraits<RHIType>::ConcreteType>(resource);
+}
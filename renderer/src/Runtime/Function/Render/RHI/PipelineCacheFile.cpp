@@ -0,0 +1,73 @@
+#include "PipelineCacheFile.h"
+
+#include "Function/Global/EngineContext.h"
+#include "Platform/File/FileSystem.h"
+
+#include "MurmurHash2.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+std::vector<uint8_t> PipelineCacheFile::Pack(const PipelineCacheDeviceInfo& device, const std::vector<uint8_t>& data)
+{
+    PipelineCacheFileHeader header;
+    memset(&header, 0, sizeof(PipelineCacheFileHeader));
+    header.magic = PIPELINE_CACHE_FILE_MAGIC;
+    header.version = PIPELINE_CACHE_FILE_VERSION;
+    header.vendorID = device.vendorID;
+    header.deviceID = device.deviceID;
+    header.driverVersion = device.driverVersion;
+    memcpy(header.uuid, device.uuid, sizeof(header.uuid));
+    header.dataSize = data.size();
+    header.dataHash = MurmurHash64A(data.data(), data.size(), 0);
+
+    std::vector<uint8_t> file(sizeof(PipelineCacheFileHeader) + data.size());
+    memcpy(file.data(), &header, sizeof(PipelineCacheFileHeader));
+    if(!data.empty()) memcpy(file.data() + sizeof(PipelineCacheFileHeader), data.data(), data.size());
+    return file;
+}
+
+PipelineCacheFileResult PipelineCacheFile::Unpack(const std::vector<uint8_t>& file, const PipelineCacheDeviceInfo& device, std::vector<uint8_t>& data)
+{
+    data.clear();
+    if(file.size() < sizeof(PipelineCacheFileHeader)) return PIPELINE_CACHE_FILE_INVALID;
+
+    PipelineCacheFileHeader header;
+    memcpy(&header, file.data(), sizeof(PipelineCacheFileHeader));
+    if( header.magic != PIPELINE_CACHE_FILE_MAGIC ||
+        header.version != PIPELINE_CACHE_FILE_VERSION ||
+        header.dataSize != file.size() - sizeof(PipelineCacheFileHeader)) return PIPELINE_CACHE_FILE_INVALID;
+
+    if( header.vendorID != device.vendorID ||
+        header.deviceID != device.deviceID ||
+        header.driverVersion != device.driverVersion ||
+        memcmp(header.uuid, device.uuid, sizeof(header.uuid)) != 0) return PIPELINE_CACHE_FILE_DEVICE_MISMATCH;
+
+    const uint8_t* begin = file.data() + sizeof(PipelineCacheFileHeader);
+    if(MurmurHash64A(begin, header.dataSize, 0) != header.dataHash) return PIPELINE_CACHE_FILE_CORRUPTED;
+
+    data.assign(begin, begin + header.dataSize);
+    return PIPELINE_CACHE_FILE_OK;
+}
+
+bool PipelineCacheFile::Read(const std::string& path, std::vector<uint8_t>& file)
+{
+    file.clear();
+    if(!EngineContext::File()->Exists(path)) return false;
+    return EngineContext::File()->LoadBinary(path, file);
+}
+
+bool PipelineCacheFile::Write(const std::string& path, const std::vector<uint8_t>& file)
+{
+    std::string dir = EngineContext::File()->RemoveFilename(path);
+    if(!dir.empty() && !EngineContext::File()->Exists(dir)) EngineContext::File()->CreateDir(dir, true);
+
+    std::ofstream out(EngineContext::File()->Absolute(path), std::ios::binary | std::ios::trunc);
+    if(!out.is_open()) return false;
+
+    out.write(reinterpret_cast<const char*>(file.data()), file.size());
+    return out.good();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 驱动管线缓存数据的磁盘文件，布局：[PipelineCacheFileHeader][数据]
+// 数据由后端从驱动取得（例如vkGetPipelineCacheData），这里不解析，只负责校验
+// 生成缓存的设备，驱动和当前不一致，或者文件不完整，数据损坏时整个缓存作废，由驱动重新编译
+
+#define PIPELINE_CACHE_FILE_MAGIC 0x43505254        // "TRPC"
+#define PIPELINE_CACHE_FILE_VERSION 1
+
+typedef struct PipelineCacheDeviceInfo
+{
+    uint32_t vendorID = 0;
+    uint32_t deviceID = 0;
+    uint32_t driverVersion = 0;
+    uint8_t uuid[16] = {};                  // 驱动给出的管线缓存UUID，驱动更新后会变化
+
+} PipelineCacheDeviceInfo;
+
+typedef struct PipelineCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint32_t driverVersion;
+    uint8_t uuid[16];
+    uint32_t reserved;
+    uint64_t dataSize;                      // 用于检查文件是否写入完整
+    uint64_t dataHash;
+
+} PipelineCacheFileHeader;
+
+enum PipelineCacheFileResult
+{
+    PIPELINE_CACHE_FILE_OK = 0,
+    PIPELINE_CACHE_FILE_INVALID,            // 不是缓存文件，版本不符或者不完整
+    PIPELINE_CACHE_FILE_DEVICE_MISMATCH,    // 由其他设备或驱动生成
+    PIPELINE_CACHE_FILE_CORRUPTED,          // 数据哈希不符
+
+    PIPELINE_CACHE_FILE_MAX_ENUM,   //
+};
+
+class PipelineCacheFile
+{
+public:
+    static std::vector<uint8_t> Pack(const PipelineCacheDeviceInfo& device, const std::vector<uint8_t>& data);
+    static PipelineCacheFileResult Unpack(const std::vector<uint8_t>& file, const PipelineCacheDeviceInfo& device, std::vector<uint8_t>& data);
+
+    static bool Read(const std::string& path, std::vector<uint8_t>& file);         // 文件不存在时返回false，不报错
+    static bool Write(const std::string& path, const std::vector<uint8_t>& file);
+};
@@ -3,6 +3,7 @@
 #include "RHIResource.h"
 #include "RHIStructs.h"
 #include "VulkanRHI/VulkanRHI.h"
+#include "NullRHI/NullRHI.h"
 #include "Core/Log/Log.h"
 
 #include <cstdint>
@@ -19,6 +20,8 @@ std::shared_ptr<RHIBackend> RHIBackend::Init(const RHIBackendInfo& info)
         switch (info.type) {
         case BACKEND_VULKAN:
             backend = std::make_shared<VulkanRHIBackend>(info); break;                 
+        case BACKEND_NULL:
+            backend = std::make_shared<NullRHIBackend>(info); break;
         default:
             LOG_FATAL("Not implemented backend type!");
         }
@@ -29,6 +32,7 @@ std::shared_ptr<RHIBackend> RHIBackend::Init(const RHIBackendInfo& info)
 
 void RHIBackend::Tick()
 {
+    ScopeLock lock(resourceSync);
     for(auto& resources : resourceMap)
     {
         for(RHIResourceRef& resource : resources)
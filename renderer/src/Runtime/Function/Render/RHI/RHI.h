@@ -3,6 +3,8 @@
 #include "Function/Render/RHI/RHIStructs.h"
 #include "RHIResource.h"
 #include "RHIStructs.h"
+#include "Platform/HAL/PlatformProcess.h"
+#include "Platform/HAL/ScopeLock.h"
 
 #include <GLFW/glfw3.h>
 #include <array>
@@ -13,6 +15,7 @@
 enum RHIBackendType
 {
     BACKEND_VULKAN = 0,
+    BACKEND_NULL,       // 无GPU的空后端，资源分配在CPU端，指令只做记录，用于CI上统计和测试CPU端开销
 
     BACKEND_MAX_ENUM,    //
 };
@@ -35,11 +38,19 @@ public:
     static RHIBackendRef Init(const RHIBackendInfo& info);
 
     static RHIBackendRef Get()      { return backend; }
+
+    const RHIBackendInfo& GetBackendInfo() const { return backendInfo; }
     
     virtual void Tick();    // 更新资源计数，清理无引用且长时间未使用资源
 
     virtual void Destroy();
 
+    std::vector<RHIResourceRef> GetResources(RHIResourceType type)     // 当前登记的某类资源的拷贝，包括已无外部引用、等待Tick清理的
+    {
+        ScopeLock lock(resourceSync);
+        return resourceMap[type];
+    }
+
     //ImGui ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     virtual void InitImGui(GLFWwindow* window) = 0;
@@ -62,6 +73,16 @@ public:
 
     virtual RHITextureRef CreateTexture(const RHITextureInfo& info) = 0;
 
+    virtual RHIHeapRef CreateHeap(const RHIHeapInfo& info) = 0;
+
+    virtual RHIMemoryRequirements GetMemoryRequirements(const RHIBufferInfo& info) = 0;
+
+    virtual RHIMemoryRequirements GetMemoryRequirements(const RHITextureInfo& info) = 0;
+
+    virtual RHIBufferRef CreatePlacedBuffer(const RHIBufferInfo& info, RHIHeapRef heap, uint64_t offset) = 0;     // 放置在heap的offset处，不单独分配内存，offset需满足GetMemoryRequirements的对齐
+
+    virtual RHITextureRef CreatePlacedTexture(const RHITextureInfo& info, RHIHeapRef heap, uint64_t offset) = 0;
+
     virtual RHITextureViewRef CreateTextureView(const RHITextureViewInfo& info) = 0;
 
     virtual RHISamplerRef CreateSampler(const RHISamplerInfo& info) = 0;
@@ -101,11 +122,16 @@ public:
     
 protected:
     RHIBackend() = delete;
-    RHIBackend(const RHIBackendInfo& info) : backendInfo(info) {}
+    RHIBackend(const RHIBackendInfo& info) : backendInfo(info), resourceSync(PlatformProcess::CreateMutex()) {}
 
-    void RegisterResource(RHIResourceRef resource) { resourceMap[resource->GetType()].push_back(resource); }     // 所有资源创建时应加入统一的资源管理
+    void RegisterResource(RHIResourceRef resource)  // 所有资源创建时应加入统一的资源管理，可能在工作线程上创建（例如管线）
+    { 
+        ScopeLock lock(resourceSync); 
+        resourceMap[resource->GetType()].push_back(resource); 
+    }     
 
     std::array<std::vector<RHIResourceRef>, RHI_RESOURCE_TYPE_MAX_CNT> resourceMap;
+    MutexRef resourceSync;
 
     RHIBackendInfo backendInfo; 
 };
@@ -135,6 +161,9 @@ public:
 
     virtual void Execute(RHIFenceRef waitFence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore) = 0;     // 实际提交，如果延迟录制也该在对应线程调用该函数完成录制提交
 
+    virtual void Execute(const std::vector<RHICommandContextRef>& following,                                            // 和following按顺序合并为一次提交，
+                         RHIFenceRef waitFence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore) = 0;     // 同一queue上前面context里的屏障对后面的同样有效
+
     // UE RHI彻底做了资源状态（如VkImageLayout）等的屏蔽封装，代价是极其痛苦的RHI实现
     // 和BeginTransitions，FVulkanLayoutManager等有关
     // 参考Sakura Engine还是做暴露吧，与UE和解
@@ -144,6 +173,10 @@ public:
 
     virtual void BufferBarrier(const RHIBufferBarrier& barrier) = 0;
 
+    virtual void TextureBarriers(const std::vector<RHITextureBarrier>& barriers) = 0;      // 合并为一次提交，同一批内不应有作用于同一子资源的屏障
+
+    virtual void BufferBarriers(const std::vector<RHIBufferBarrier>& barriers) = 0;
+
     virtual void CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset) = 0;
 
     virtual void CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource) = 0;
@@ -230,6 +263,10 @@ public:
 
     virtual void BufferBarrier(const RHIBufferBarrier& barrier) = 0;
 
+    virtual void TextureBarriers(const std::vector<RHITextureBarrier>& barriers) = 0;
+
+    virtual void BufferBarriers(const std::vector<RHIBufferBarrier>& barriers) = 0;
+
     virtual void CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset) = 0;
 
     virtual void CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource) = 0;
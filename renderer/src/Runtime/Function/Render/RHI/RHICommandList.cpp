@@ -2,12 +2,47 @@
 #include "RHI.h"
 #include "RHIResource.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <cstdio>
 
+void* RHICommandArena::Allocate(uint32_t size)
+{
+    while(current < blocks.size())
+    {
+        Block& block = blocks[current];
+        if(block.used + size <= block.capacity)
+        {
+            void* ret = reinterpret_cast<uint8_t*>(block.data.get()) + block.used;
+            block.used += size;
+            return ret;
+        }
+        current++;      // 剩余空间不足，后续块在Reset前保持为空
+    }
+
+    Block block;
+    block.capacity = std::max(BLOCK_SIZE, size);
+    block.data = std::unique_ptr<Chunk[]>(new Chunk[block.capacity / ALIGNMENT]);
+    block.used = size;
+    capacity += block.capacity;
+
+    blocks.push_back(std::move(block));
+    current = blocks.size() - 1;
+    return blocks.back().data.get();
+}
+
+void RHICommandArena::Reset()
+{
+    for(auto& block : blocks) block.used = 0;
+    current = 0;
+}
+
 RHICommandList::~RHICommandList() 
 { 
-    info.pool->ReturnToPool(info.context); 
+    ReplayCommands(nullptr);    // 未执行的指令也需要析构，释放持有的资源引用
+
+    if(info.pool) info.pool->ReturnToPool(info.context); 
     info.pool = nullptr;
     info.context = nullptr;
 }
@@ -37,17 +72,88 @@ void RHICommandList::Execute(RHIFenceRef waitFence, RHISemaphoreRef waitSemaphor
     if (!info.byPass) 
     {
         // LOG_DEBUG("Recording command list in delay mode.");
-        for (int32_t i = 0; i < commands.size(); i++) 
-        {
-            commands[i]->Execute(info.context);
-            delete commands[i];
-        }
-        commands.clear();
+        ReplayCommands(info.context.get());
     }
 
     info.context->Execute(waitFence, waitSemaphore, signalSemaphore);
 }
 
+void RHICommandList::Execute(const std::vector<RHICommandListRef>& following, RHIFenceRef waitFence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore)
+{
+    std::vector<RHICommandContextRef> contexts;
+    contexts.reserve(following.size());
+
+    Replay();
+    for(auto& commandList : following)
+    {
+        commandList->Replay();
+        contexts.push_back(commandList->info.context);
+    }
+
+    info.context->Execute(contexts, waitFence, waitSemaphore, signalSemaphore);
+}
+
+void RHICommandList::Replay()
+{
+    if(!info.byPass) ReplayCommands(info.context.get());     // 执行后arena被重置，重复调用没有开销
+}
+
+#define REPLAY_COMMAND(commandName) \
+    case RHICommand##commandName::TYPE: { \
+        RHICommand##commandName* typedCommand = static_cast<RHICommand##commandName*>(command); \
+        if(context) typedCommand->Execute(*context, scratch); \
+        typedCommand->~RHICommand##commandName(); \
+        break; \
+    }
+
+void RHICommandList::ReplayCommands(RHICommandContext* context)
+{
+    arena.ForEach([&](RHICommand* command) {
+        switch (command->type) 
+        {
+        REPLAY_COMMAND(BeginCommand)
+        REPLAY_COMMAND(EndCommand)
+        REPLAY_COMMAND(TextureBarrier)
+        REPLAY_COMMAND(BufferBarrier)
+        REPLAY_COMMAND(TextureBarriers)
+        REPLAY_COMMAND(BufferBarriers)
+        REPLAY_COMMAND(CopyTextureToBuffer)
+        REPLAY_COMMAND(CopyBufferToTexture)
+        REPLAY_COMMAND(CopyBuffer)
+        REPLAY_COMMAND(CopyTexture)
+        REPLAY_COMMAND(GenerateMips)
+        REPLAY_COMMAND(PushEvent)
+        REPLAY_COMMAND(PopEvent)
+        REPLAY_COMMAND(BeginRenderPass)
+        REPLAY_COMMAND(EndRenderPass)
+        REPLAY_COMMAND(SetViewport)
+        REPLAY_COMMAND(SetScissor)
+        REPLAY_COMMAND(ClearScissors)
+        REPLAY_COMMAND(SetDepthBias)
+        REPLAY_COMMAND(SetLineWidth)
+        REPLAY_COMMAND(SetGraphicsPipeline)
+        REPLAY_COMMAND(SetComputePipeline)
+        REPLAY_COMMAND(SetRayTracingPipeline)
+        REPLAY_COMMAND(PushConstants)
+        REPLAY_COMMAND(BindDescriptorSet)
+        REPLAY_COMMAND(BindVertexBuffer)
+        REPLAY_COMMAND(BindIndexBuffer)
+        REPLAY_COMMAND(Dispatch)
+        REPLAY_COMMAND(DispatchIndirect)
+        REPLAY_COMMAND(TraceRays)
+        REPLAY_COMMAND(Draw)
+        REPLAY_COMMAND(DrawIndexed)
+        REPLAY_COMMAND(DrawIndirect)
+        REPLAY_COMMAND(DrawIndexedIndirect)
+        REPLAY_COMMAND(ImGuiCreateFontsTexture)
+        REPLAY_COMMAND(ImGuiRenderDrawData)
+        default: assert(false); break;
+        }
+    });
+    arena.Reset();
+    commandCount = 0;
+}
+
 void RHICommandList::TextureBarrier(const RHITextureBarrier& barrier)
 {
     COMMANDLIST_DEBUG_OUTPUT();
@@ -62,6 +168,22 @@ void RHICommandList::BufferBarrier(const RHIBufferBarrier& barrier)
     else ADD_COMMAND(BufferBarrier, barrier);
 }
 
+void RHICommandList::TextureBarriers(const std::vector<RHITextureBarrier>& barriers)
+{
+    COMMANDLIST_DEBUG_OUTPUT();
+    if(barriers.empty()) return;
+    if(info.byPass) info.context->TextureBarriers(barriers);
+    else ADD_COMMAND(TextureBarriers, barriers);
+}
+
+void RHICommandList::BufferBarriers(const std::vector<RHIBufferBarrier>& barriers)
+{
+    COMMANDLIST_DEBUG_OUTPUT();
+    if(barriers.empty()) return;
+    if(info.byPass) info.context->BufferBarriers(barriers);
+    else ADD_COMMAND(BufferBarriers, barriers);
+}
+
 void RHICommandList::CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset)
 {
     COMMANDLIST_DEBUG_OUTPUT();
@@ -296,6 +418,18 @@ void RHICommandListImmediate::BufferBarrier(const RHIBufferBarrier& barrier)
     ADD_COMMAND_IMMEDIATE(BufferBarrier, barrier);
 }
 
+void RHICommandListImmediate::TextureBarriers(const std::vector<RHITextureBarrier>& barriers)
+{
+    if(barriers.empty()) return;
+    ADD_COMMAND_IMMEDIATE(TextureBarriers, barriers);
+}
+
+void RHICommandListImmediate::BufferBarriers(const std::vector<RHIBufferBarrier>& barriers)
+{
+    if(barriers.empty()) return;
+    ADD_COMMAND_IMMEDIATE(BufferBarriers, barriers);
+}
+
 void RHICommandListImmediate::CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset)
 {
     ADD_COMMAND_IMMEDIATE(CopyTextureToBuffer, src, srcSubresource, dst, dstOffset);
@@ -322,78 +456,107 @@ void RHICommandListImmediate::GenerateMips(RHITextureRef src)
 }
 
 
-void RHICommandBeginCommand::Execute(RHICommandContextRef context) { context->BeginCommand(); }
+void RHICommandBeginCommand::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.BeginCommand(); }
 
-void RHICommandEndCommand::Execute(RHICommandContextRef context) { context->EndCommand(); }
+void RHICommandEndCommand::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.EndCommand(); }
 
-void RHICommandTextureBarrier::Execute(RHICommandContextRef context) { context->TextureBarrier(barrier); }
+void RHICommandTextureBarrier::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.TextureBarrier(barrier); }
 
-void RHICommandBufferBarrier::Execute(RHICommandContextRef context) { context->BufferBarrier(barrier); }
+void RHICommandBufferBarrier::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.BufferBarrier(barrier); }
+
+void RHICommandTextureBarriers::Execute(RHICommandContext& context, RHICommandScratch& scratch) 
+{ 
+    RHITextureBarrier* barriers = RHICommandPayload<RHITextureBarrier>(this);
+    scratch.textureBarriers.assign(barriers, barriers + count);
+    context.TextureBarriers(scratch.textureBarriers); 
+    scratch.textureBarriers.clear();    // 保留容量，释放资源引用
+}
+
+void RHICommandBufferBarriers::Execute(RHICommandContext& context, RHICommandScratch& scratch) 
+{ 
+    RHIBufferBarrier* barriers = RHICommandPayload<RHIBufferBarrier>(this);
+    scratch.bufferBarriers.assign(barriers, barriers + count);
+    context.BufferBarriers(scratch.bufferBarriers); 
+    scratch.bufferBarriers.clear();
+}
 
-void RHICommandCopyTextureToBuffer::Execute(RHICommandContextRef context) { context->CopyTextureToBuffer(src, srcSubresource, dst, dstOffset); }
+void RHICommandCopyTextureToBuffer::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.CopyTextureToBuffer(src, srcSubresource, dst, dstOffset); }
 
-void RHICommandCopyBufferToTexture::Execute(RHICommandContextRef context) { context->CopyBufferToTexture(src, srcOffset, dst, dstSubresource); }
+void RHICommandCopyBufferToTexture::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.CopyBufferToTexture(src, srcOffset, dst, dstSubresource); }
 
-void RHICommandCopyBuffer::Execute(RHICommandContextRef context) { context->CopyBuffer(src, srcOffset, dst, dstOffset, size); }
+void RHICommandCopyBuffer::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.CopyBuffer(src, srcOffset, dst, dstOffset, size); }
 
-void RHICommandCopyTexture::Execute(RHICommandContextRef context) { context->CopyTexture(src, srcSubresource, dst, dstSubresource); }
+void RHICommandCopyTexture::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.CopyTexture(src, srcSubresource, dst, dstSubresource); }
 
-void RHICommandGenerateMips::Execute(RHICommandContextRef context) { context->GenerateMips(src); }
+void RHICommandGenerateMips::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.GenerateMips(src); }
 
-void RHICommandPushEvent::Execute(RHICommandContextRef context) { context->PushEvent(name, color); }
+void RHICommandPushEvent::Execute(RHICommandContext& context, RHICommandScratch& scratch) 
+{ 
+    scratch.name.assign(RHICommandPayload<char>(this), length);
+    context.PushEvent(scratch.name, color); 
+}
 
-void RHICommandPopEvent::Execute(RHICommandContextRef context) { context->PopEvent(); }
+void RHICommandPopEvent::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.PopEvent(); }
 
-void RHICommandBeginRenderPass::Execute(RHICommandContextRef context) { context->BeginRenderPass(renderPass); }
+void RHICommandBeginRenderPass::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.BeginRenderPass(renderPass); }
 
-void RHICommandEndRenderPass::Execute(RHICommandContextRef context) { context->EndRenderPass(); }
+void RHICommandEndRenderPass::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.EndRenderPass(); }
 
-void RHICommandSetViewport::Execute(RHICommandContextRef context) { context->SetViewport(min, max); }
+void RHICommandSetViewport::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.SetViewport(min, max); }
 
-void RHICommandSetScissor::Execute(RHICommandContextRef context) { context->SetScissor(min, max); }
+void RHICommandSetScissor::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.SetScissor(min, max); }
 
-void RHICommandClearScissors::Execute(RHICommandContextRef context) { context->ClearScissors(attachments, scissors, baseArrayLayer, layerCount); }
+void RHICommandClearScissors::Execute(RHICommandContext& context, RHICommandScratch& scratch) 
+{ 
+    scratch.attachments.assign(Attachments(), Attachments() + attachmentCount);
+    scratch.scissors.assign(Scissors(), Scissors() + scissorCount);
+    context.ClearScissors(scratch.attachments, scratch.scissors, baseArrayLayer, layerCount); 
+}
 
-void RHICommandSetDepthBias::Execute(RHICommandContextRef context) { context->SetDepthBias(constantBias, slopeBias, clampBias); }
+void RHICommandSetDepthBias::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.SetDepthBias(constantBias, slopeBias, clampBias); }
 
-void RHICommandSetLineWidth::Execute(RHICommandContextRef context) { context->SetLineWidth(width); }
+void RHICommandSetLineWidth::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.SetLineWidth(width); }
 
-void RHICommandSetGraphicsPipeline::Execute(RHICommandContextRef context) { context->SetGraphicsPipeline(graphicsPipeline); }
+void RHICommandSetGraphicsPipeline::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.SetGraphicsPipeline(graphicsPipeline); }
 
-void RHICommandSetComputePipeline::Execute(RHICommandContextRef context) { context->SetComputePipeline(computePipeline); }
+void RHICommandSetComputePipeline::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.SetComputePipeline(computePipeline); }
 
-void RHICommandSetRayTracingPipeline::Execute(RHICommandContextRef context) { context->SetRayTracingPipeline(rayTracingPipeline); }
+void RHICommandSetRayTracingPipeline::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.SetRayTracingPipeline(rayTracingPipeline); }
 
-void RHICommandPushConstants::Execute(RHICommandContextRef context) { context->PushConstants(&data[0], size, frequency); }
+void RHICommandPushConstants::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.PushConstants(RHICommandPayload<uint8_t>(this), size, frequency); }
 
-void RHICommandBindDescriptorSet::Execute(RHICommandContextRef context) { context->BindDescriptorSet(descriptor, set); }
+void RHICommandBindDescriptorSet::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.BindDescriptorSet(descriptor, set); }
 
-void RHICommandBindVertexBuffer::Execute(RHICommandContextRef context) { context->BindVertexBuffer(vertexBuffer, streamIndex, offset); }
+void RHICommandBindVertexBuffer::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.BindVertexBuffer(vertexBuffer, streamIndex, offset); }
 
-void RHICommandBindIndexBuffer::Execute(RHICommandContextRef context) { context->BindIndexBuffer(indexBuffer, offset); }
+void RHICommandBindIndexBuffer::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.BindIndexBuffer(indexBuffer, offset); }
 
-void RHICommandDispatch::Execute(RHICommandContextRef context) { context->Dispatch(groupCountX, groupCountY, groupCountZ); }
+void RHICommandDispatch::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.Dispatch(groupCountX, groupCountY, groupCountZ); }
 
-void RHICommandDispatchIndirect::Execute(RHICommandContextRef context) { context->DispatchIndirect(argumentBuffer, argumentOffset); }
+void RHICommandDispatchIndirect::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.DispatchIndirect(argumentBuffer, argumentOffset); }
 
-void RHICommandTraceRays::Execute(RHICommandContextRef context) { context->TraceRays(groupCountX, groupCountY, groupCountZ); }
+void RHICommandTraceRays::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.TraceRays(groupCountX, groupCountY, groupCountZ); }
 
-void RHICommandDraw::Execute(RHICommandContextRef context) { context->Draw(vertexCount, instanceCount, firstVertex, firstInstance); }
+void RHICommandDraw::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.Draw(vertexCount, instanceCount, firstVertex, firstInstance); }
 
-void RHICommandDrawIndexed::Execute(RHICommandContextRef context) { context->DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance); }
+void RHICommandDrawIndexed::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance); }
 
-void RHICommandDrawIndirect::Execute(RHICommandContextRef context) { context->DrawIndirect(argumentBuffer, offset, drawCount); }
+void RHICommandDrawIndirect::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.DrawIndirect(argumentBuffer, offset, drawCount); }
 
-void RHICommandDrawIndexedIndirect::Execute(RHICommandContextRef context) { context->DrawIndexedIndirect(argumentBuffer, offset, drawCount); }
+void RHICommandDrawIndexedIndirect::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.DrawIndexedIndirect(argumentBuffer, offset, drawCount); }
 
-void RHICommandImGuiCreateFontsTexture::Execute(RHICommandContextRef context) { context->ImGuiCreateFontsTexture(); }
+void RHICommandImGuiCreateFontsTexture::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.ImGuiCreateFontsTexture(); }
 
-void RHICommandImGuiRenderDrawData::Execute(RHICommandContextRef context) { context->ImGuiRenderDrawData(func); }
+void RHICommandImGuiRenderDrawData::Execute(RHICommandContext& context, RHICommandScratch& scratch) { context.ImGuiRenderDrawData(func); }
 
 void RHICommandImmediateTextureBarrier::Execute(RHICommandContextImmediateRef context) { context->TextureBarrier(barrier); }
 
 void RHICommandImmediateBufferBarrier::Execute(RHICommandContextImmediateRef context) { context->BufferBarrier(barrier); }
 
+void RHICommandImmediateTextureBarriers::Execute(RHICommandContextImmediateRef context) { context->TextureBarriers(barriers); }
+
+void RHICommandImmediateBufferBarriers::Execute(RHICommandContextImmediateRef context) { context->BufferBarriers(barriers); }
+
 void RHICommandImmediateCopyTextureToBuffer::Execute(RHICommandContextImmediateRef context) { context->CopyTextureToBuffer(src, srcSubresource, dst, dstOffset); }
 
 void RHICommandImmediateCopyBufferToTexture::Execute(RHICommandContextImmediateRef context) { context->CopyBufferToTexture(src, srcOffset, dst, dstSubresource); }
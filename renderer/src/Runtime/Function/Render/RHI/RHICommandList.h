@@ -10,6 +10,9 @@
 #include <cstring>
 #include <functional>
 #include <memory>
+#include <new>
+#include <string>
+#include <utility>
 #include <vector>
 
 
@@ -29,6 +32,9 @@
 struct RHICommandImmediate;
 struct RHICommand;
 
+class RHICommandList;
+typedef std::shared_ptr<RHICommandList> RHICommandListRef;
+
 typedef struct CommandListImmediateInfo
 {
 	RHICommandContextImmediateRef context;
@@ -46,10 +52,54 @@ typedef struct CommandListInfo
 
 typedef std::function<void()> ImGuiDrawFunc;
 
+// 延迟录制的指令在线性的arena上紧密存放，按块分配，同一块内的记录首尾相接
+// 指令执行完成后整体重置，块保留给下一次录制复用，稳定后每帧录制不再有堆分配
+class RHICommandArena
+{
+public:
+    static constexpr uint32_t ALIGNMENT = 16;
+    static constexpr uint32_t BLOCK_SIZE = 64 * 1024;
+
+    static inline uint32_t Align(uint64_t size) { return (uint32_t)((size + ALIGNMENT - 1) & ~(uint64_t)(ALIGNMENT - 1)); }
+
+    void* Allocate(uint32_t size);      // size需已按ALIGNMENT对齐，超过BLOCK_SIZE的单独分配一块
+    void Reset();
+
+    template<typename Func>
+    void ForEach(Func&& func);          // 按录制顺序遍历每条记录
+
+    inline uint64_t Capacity()          { return capacity; }
+
+private:
+    struct alignas(ALIGNMENT) Chunk { uint8_t bytes[ALIGNMENT]; };
+
+    struct Block
+    {
+        std::unique_ptr<Chunk[]> data;
+        uint32_t capacity = 0;
+        uint32_t used = 0;
+    };
+
+    std::vector<Block> blocks;
+    uint32_t current = 0;
+    uint64_t capacity = 0;
+};
+
+// 执行延迟指令时复用的临时容器，context的接口需要vector和string
+typedef struct RHICommandScratch
+{
+    std::vector<RHITextureBarrier> textureBarriers;
+    std::vector<RHIBufferBarrier> bufferBarriers;
+    std::vector<ClearAttachment> attachments;
+    std::vector<Rect2D> scissors;
+    std::string name;
+
+} RHICommandScratch;
+
 class RHICommandList	//CommandList没有子类，只是做DynamicRHI和RHIContext中函数的调用
 {
 	//直接用commandList.func()做函数声明
-	//内部做判断：如果bypass就直接调内部的对应接口录制，否则就入队相应的RHICommand（每种command存有参数，并有对应接口录制的执行函数），延迟执行
+	//内部做判断：如果bypass就直接调内部的对应接口录制，否则就在arena上写入相应的指令记录（每种command存有参数和类型标记），Execute时按类型分发延迟执行
 	//全是胶水
 
 public:
@@ -62,10 +112,19 @@ public:
 
 	void Execute(RHIFenceRef fence = nullptr, RHISemaphoreRef waitSemaphore = nullptr, RHISemaphoreRef signalSemaphore = nullptr);
 
+	void Execute(const std::vector<RHICommandListRef>& following, 	// 和following按顺序合并为一次提交，用于并行录制的多个列表
+				 RHIFenceRef fence = nullptr, RHISemaphoreRef waitSemaphore = nullptr, RHISemaphoreRef signalSemaphore = nullptr);
+
+	void Replay();		// 延迟录制时将arena上的指令写入context，Execute会自动调用；context来自不同pool的列表可以在不同线程上并行调用
+
     void TextureBarrier(const RHITextureBarrier& barrier);
 
     void BufferBarrier(const RHIBufferBarrier& barrier);
 
+    void TextureBarriers(const std::vector<RHITextureBarrier>& barriers);
+
+    void BufferBarriers(const std::vector<RHIBufferBarrier>& barriers);
+
     void CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset);
 
     void CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource);
@@ -124,6 +183,11 @@ public:
 
     void* RawHandle();
 
+    inline RHICommandContextRef GetContext()  { return info.context; }
+
+    inline uint32_t CommandCount()      { return commandCount; }        // 尚未执行的延迟指令数
+    inline uint64_t ArenaCapacity()     { return arena.Capacity(); }
+
     //ImGui /////////////////////////////////////////////////////////////////////////////////////
 
     void ImGuiCreateFontsTexture();
@@ -133,14 +197,19 @@ public:
 protected:
 	CommandListInfo info;
 
-    inline void AddCommand(RHICommand* command) { commands.push_back(command); }
-    std::vector<RHICommand*> commands;
+    template<typename Command, typename... Args>
+    inline void AddCommand(Args&&... args);        // 在arena上构造指令，payload为紧跟在记录后的变长数据
+
+    void ReplayCommands(RHICommandContext* context);                   // context为空时只析构不执行
+
+    RHICommandArena arena;
+    RHICommandScratch scratch;
+    uint32_t commandCount = 0;
 
 #if ENABLE_DEBUG_MODE
     int currentCommandIndex = 0;
 #endif
 };
-typedef std::shared_ptr<RHICommandList> RHICommandListRef;
 
 // 并不是所有command都需要在一个绘制的命令队列里完成，应该区别于RHICommandList单独开一个类？
 // 例如生成mipmap，内存交换和屏障，
@@ -158,6 +227,10 @@ public:
 
     void BufferBarrier(const RHIBufferBarrier& barrier);
 
+    void TextureBarriers(const std::vector<RHITextureBarrier>& barriers);
+
+    void BufferBarriers(const std::vector<RHIBufferBarrier>& barriers);
+
     void CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset);
 
     void CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource);
@@ -183,8 +256,7 @@ typedef std::shared_ptr<RHICommandListImmediate> RHICommandListImmediateRef;
 } while (0)
 
 #define ADD_COMMAND(commandName, ...) do { \
-    RHICommand* command = new RHICommand##commandName(__VA_ARGS__);  \
-    AddCommand(command); \
+    AddCommand<RHICommand##commandName>(__VA_ARGS__); \
 } while (0)
 
 typedef struct RHICommandImmediate	
@@ -195,52 +267,160 @@ typedef struct RHICommandImmediate
     virtual void Execute(RHICommandContextImmediateRef context) = 0;
 } RHICommandImmediate;
 
+enum RHICommandType : uint32_t
+{
+    RHI_COMMAND_BEGIN_COMMAND = 0,
+    RHI_COMMAND_END_COMMAND,
+    RHI_COMMAND_TEXTURE_BARRIER,
+    RHI_COMMAND_BUFFER_BARRIER,
+    RHI_COMMAND_TEXTURE_BARRIERS,
+    RHI_COMMAND_BUFFER_BARRIERS,
+    RHI_COMMAND_COPY_TEXTURE_TO_BUFFER,
+    RHI_COMMAND_COPY_BUFFER_TO_TEXTURE,
+    RHI_COMMAND_COPY_BUFFER,
+    RHI_COMMAND_COPY_TEXTURE,
+    RHI_COMMAND_GENERATE_MIPS,
+    RHI_COMMAND_PUSH_EVENT,
+    RHI_COMMAND_POP_EVENT,
+    RHI_COMMAND_BEGIN_RENDER_PASS,
+    RHI_COMMAND_END_RENDER_PASS,
+    RHI_COMMAND_SET_VIEWPORT,
+    RHI_COMMAND_SET_SCISSOR,
+    RHI_COMMAND_CLEAR_SCISSORS,
+    RHI_COMMAND_SET_DEPTH_BIAS,
+    RHI_COMMAND_SET_LINE_WIDTH,
+    RHI_COMMAND_SET_GRAPHICS_PIPELINE,
+    RHI_COMMAND_SET_COMPUTE_PIPELINE,
+    RHI_COMMAND_SET_RAY_TRACING_PIPELINE,
+    RHI_COMMAND_PUSH_CONSTANTS,
+    RHI_COMMAND_BIND_DESCRIPTOR_SET,
+    RHI_COMMAND_BIND_VERTEX_BUFFER,
+    RHI_COMMAND_BIND_INDEX_BUFFER,
+    RHI_COMMAND_DISPATCH,
+    RHI_COMMAND_DISPATCH_INDIRECT,
+    RHI_COMMAND_TRACE_RAYS,
+    RHI_COMMAND_DRAW,
+    RHI_COMMAND_DRAW_INDEXED,
+    RHI_COMMAND_DRAW_INDIRECT,
+    RHI_COMMAND_DRAW_INDEXED_INDIRECT,
+    RHI_COMMAND_IMGUI_CREATE_FONTS_TEXTURE,
+    RHI_COMMAND_IMGUI_RENDER_DRAW_DATA,
+
+    RHI_COMMAND_TYPE_MAX_ENUM,	//
+};
+
+// 延迟指令的记录头，没有虚函数，执行时按type分发，执行后手动析构
 typedef struct RHICommand	
 {
-    RHICommand() = default;
-    virtual ~RHICommand() = default;
+    RHICommandType type;
+    uint32_t commandSize;   // 包括payload在内的字节数，遍历时跳到下一条记录
 
-    virtual void Execute(RHICommandContextRef context) = 0;
+    template<typename... Args>
+    static uint32_t PayloadSize(const Args&... args) { return 0; }      // 有变长数据的指令自行覆盖
 } RHICommand;
 
+template<typename T, typename Command>
+static inline T* RHICommandPayload(Command* command, uint64_t offset = 0)
+{
+    return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(command) + RHICommandArena::Align(sizeof(Command)) + offset);
+}
+
 struct RHICommandBeginCommand : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_BEGIN_COMMAND;
+
     RHICommandBeginCommand() {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandEndCommand : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_END_COMMAND;
+
     RHICommandEndCommand() {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandTextureBarrier : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_TEXTURE_BARRIER;
+
     RHITextureBarrier barrier;
 
     RHICommandTextureBarrier(const RHITextureBarrier& barrier) 
     : barrier(barrier)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandBufferBarrier : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_BUFFER_BARRIER;
+
     RHIBufferBarrier barrier;
 
     RHICommandBufferBarrier(const RHIBufferBarrier& barrier)
     : barrier(barrier) 
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
+};
+
+struct RHICommandTextureBarriers : public RHICommand 
+{
+    static const RHICommandType TYPE = RHI_COMMAND_TEXTURE_BARRIERS;
+
+    uint32_t count;         // payload: RHITextureBarrier[count]
+
+    RHICommandTextureBarriers(const std::vector<RHITextureBarrier>& barriers) 
+    : count(barriers.size())
+    {
+        RHITextureBarrier* payload = RHICommandPayload<RHITextureBarrier>(this);
+        for(uint32_t i = 0; i < count; i++) new (&payload[i]) RHITextureBarrier(barriers[i]);
+    }
+
+    ~RHICommandTextureBarriers()
+    {
+        RHITextureBarrier* payload = RHICommandPayload<RHITextureBarrier>(this);
+        for(uint32_t i = 0; i < count; i++) payload[i].~RHITextureBarrier();
+    }
+
+    static uint32_t PayloadSize(const std::vector<RHITextureBarrier>& barriers) { return barriers.size() * sizeof(RHITextureBarrier); }
+
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
+};
+
+struct RHICommandBufferBarriers : public RHICommand 
+{
+    static const RHICommandType TYPE = RHI_COMMAND_BUFFER_BARRIERS;
+
+    uint32_t count;         // payload: RHIBufferBarrier[count]
+
+    RHICommandBufferBarriers(const std::vector<RHIBufferBarrier>& barriers)
+    : count(barriers.size())
+    {
+        RHIBufferBarrier* payload = RHICommandPayload<RHIBufferBarrier>(this);
+        for(uint32_t i = 0; i < count; i++) new (&payload[i]) RHIBufferBarrier(barriers[i]);
+    }
+
+    ~RHICommandBufferBarriers()
+    {
+        RHIBufferBarrier* payload = RHICommandPayload<RHIBufferBarrier>(this);
+        for(uint32_t i = 0; i < count; i++) payload[i].~RHIBufferBarrier();
+    }
+
+    static uint32_t PayloadSize(const std::vector<RHIBufferBarrier>& barriers) { return barriers.size() * sizeof(RHIBufferBarrier); }
+
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandCopyTextureToBuffer : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_COPY_TEXTURE_TO_BUFFER;
+
     RHITextureRef src;
     TextureSubresourceLayers srcSubresource;
     RHIBufferRef dst;
@@ -253,11 +433,13 @@ struct RHICommandCopyTextureToBuffer : public RHICommand
     , dstOffset(dstOffset)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandCopyBufferToTexture : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_COPY_BUFFER_TO_TEXTURE;
+
     RHIBufferRef src;
     uint64_t srcOffset;
     RHITextureRef dst;
@@ -270,11 +452,13 @@ struct RHICommandCopyBufferToTexture : public RHICommand
     , dstSubresource(dstSubresource)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandCopyBuffer : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_COPY_BUFFER;
+
     RHIBufferRef src;
     uint64_t srcOffset;
     RHIBufferRef dst;
@@ -289,11 +473,13 @@ struct RHICommandCopyBuffer : public RHICommand
     , size(size)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandCopyTexture : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_COPY_TEXTURE;
+
     RHITextureRef src;
     TextureSubresourceLayers srcSubresource;
     RHITextureRef dst;
@@ -306,60 +492,76 @@ struct RHICommandCopyTexture : public RHICommand
     , dstSubresource(dstSubresource)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandGenerateMips : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_GENERATE_MIPS;
+
     RHITextureRef src;
 
     RHICommandGenerateMips(RHITextureRef src)
     : src(src)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandPushEvent : public RHICommand 
 {
-    std::string name;
+    static const RHICommandType TYPE = RHI_COMMAND_PUSH_EVENT;
+
+    uint32_t length;        // payload: char[length]，名字内联存放，不再单独分配string
     Color3 color;
 
     RHICommandPushEvent(const std::string& name, Color3 color) 
-    : name(name)
+    : length(name.size())
     , color(color)
-    {}
+    {
+        memcpy(RHICommandPayload<char>(this), name.data(), length);
+    }
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    static uint32_t PayloadSize(const std::string& name, Color3 color) { return name.size(); }
+
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandPopEvent : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_POP_EVENT;
+
     RHICommandPopEvent() {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandBeginRenderPass : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_BEGIN_RENDER_PASS;
+
     RHIRenderPassRef renderPass;
 
     RHICommandBeginRenderPass(RHIRenderPassRef renderPass) 
     : renderPass(renderPass)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandEndRenderPass : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_END_RENDER_PASS;
+
     RHICommandEndRenderPass() {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandSetViewport : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_SET_VIEWPORT;
+
     Offset2D min;
     Offset2D max;
 
@@ -368,11 +570,13 @@ struct RHICommandSetViewport : public RHICommand
     , max(max) 
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandSetScissor : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_SET_SCISSOR;
+
     Offset2D min;
     Offset2D max;
 
@@ -381,28 +585,43 @@ struct RHICommandSetScissor : public RHICommand
     , max(max)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandClearScissors : public RHICommand 
 {
-    std::vector<ClearAttachment> attachments;
-    std::vector<Rect2D> scissors;
+    static const RHICommandType TYPE = RHI_COMMAND_CLEAR_SCISSORS;
+
+    uint32_t attachmentCount;   // payload: ClearAttachment[attachmentCount], Rect2D[scissorCount]
+    uint32_t scissorCount;
     uint32_t baseArrayLayer;
     uint32_t layerCount;
 
     RHICommandClearScissors(const std::vector<ClearAttachment>& attachments, const std::vector<Rect2D>& scissors, uint32_t baseArrayLayer, uint32_t layerCount) 
-    : attachments(attachments)
-    , scissors(scissors)
+    : attachmentCount(attachments.size())
+    , scissorCount(scissors.size())
     , baseArrayLayer(baseArrayLayer)
     , layerCount(layerCount)
-    {}
+    {
+        memcpy(Attachments(), attachments.data(), attachmentCount * sizeof(ClearAttachment));
+        memcpy(Scissors(), scissors.data(), scissorCount * sizeof(Rect2D));
+    }
+
+    static uint32_t PayloadSize(const std::vector<ClearAttachment>& attachments, const std::vector<Rect2D>& scissors, uint32_t baseArrayLayer, uint32_t layerCount) 
+    { 
+        return RHICommandArena::Align(attachments.size() * sizeof(ClearAttachment)) + scissors.size() * sizeof(Rect2D); 
+    }
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    inline ClearAttachment* Attachments()   { return RHICommandPayload<ClearAttachment>(this); }
+    inline Rect2D* Scissors()               { return RHICommandPayload<Rect2D>(this, RHICommandArena::Align(attachmentCount * sizeof(ClearAttachment))); }
+
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandSetDepthBias : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_SET_DEPTH_BIAS;
+
     float constantBias;
     float slopeBias;
     float clampBias;
@@ -413,72 +632,84 @@ struct RHICommandSetDepthBias : public RHICommand
     , clampBias(clampBias)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandSetLineWidth : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_SET_LINE_WIDTH;
+
     float width;
 
     RHICommandSetLineWidth(float width) 
     : width(width)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
     
 struct RHICommandSetGraphicsPipeline : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_SET_GRAPHICS_PIPELINE;
+
     RHIGraphicsPipelineRef graphicsPipeline;
 
     RHICommandSetGraphicsPipeline(RHIGraphicsPipelineRef graphicsPipeline)
     : graphicsPipeline(graphicsPipeline) 
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandSetComputePipeline : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_SET_COMPUTE_PIPELINE;
+
     RHIComputePipelineRef computePipeline;
 
     RHICommandSetComputePipeline(RHIComputePipelineRef computePipeline) 
     : computePipeline(computePipeline)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandSetRayTracingPipeline : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_SET_RAY_TRACING_PIPELINE;
+
     RHIRayTracingPipelineRef rayTracingPipeline;
 
     RHICommandSetRayTracingPipeline(RHIRayTracingPipelineRef rayTracingPipeline) 
     : rayTracingPipeline(rayTracingPipeline)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandPushConstants : public RHICommand 
 {
-    uint8_t data[256] = { 0 };  // 需要缓存push constant的数据，假定最大支持256字节
-    uint16_t size;
+    static const RHICommandType TYPE = RHI_COMMAND_PUSH_CONSTANTS;
+
+    uint16_t size;          // payload: uint8_t[size]，只存实际大小的数据
     ShaderFrequency frequency;
 
     RHICommandPushConstants(void* data, uint16_t size, ShaderFrequency frequency) 
     : size(size)
     , frequency(frequency)
     {
-        assert(size <= 256);
-        memcpy(&this->data[0], data, size);
+        memcpy(RHICommandPayload<uint8_t>(this), data, size);
     }
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    static uint32_t PayloadSize(void* data, uint16_t size, ShaderFrequency frequency) { return size; }
+
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandBindDescriptorSet : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_BIND_DESCRIPTOR_SET;
+
     RHIDescriptorSetRef descriptor;
     uint32_t set;
 
@@ -487,11 +718,13 @@ struct RHICommandBindDescriptorSet : public RHICommand
     , set(set)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandBindVertexBuffer : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_BIND_VERTEX_BUFFER;
+
     RHIBufferRef vertexBuffer;
     uint32_t streamIndex;
     uint32_t offset;
@@ -502,11 +735,13 @@ struct RHICommandBindVertexBuffer : public RHICommand
     , offset(offset)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandBindIndexBuffer : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_BIND_INDEX_BUFFER;
+
     RHIBufferRef indexBuffer;
     uint32_t offset;
 
@@ -515,11 +750,13 @@ struct RHICommandBindIndexBuffer : public RHICommand
     , offset(offset)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandDispatch : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_DISPATCH;
+
     uint32_t groupCountX;
     uint32_t groupCountY;
     uint32_t groupCountZ;
@@ -530,11 +767,13 @@ struct RHICommandDispatch : public RHICommand
     , groupCountZ(groupCountZ)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandDispatchIndirect : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_DISPATCH_INDIRECT;
+
     RHIBufferRef argumentBuffer;
     uint32_t argumentOffset;
 
@@ -543,11 +782,13 @@ struct RHICommandDispatchIndirect : public RHICommand
     , argumentOffset(argumentOffset)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandTraceRays : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_TRACE_RAYS;
+
     uint32_t groupCountX;
     uint32_t groupCountY;
     uint32_t groupCountZ;
@@ -558,11 +799,13 @@ struct RHICommandTraceRays : public RHICommand
     , groupCountZ(groupCountZ)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandDraw : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_DRAW;
+
     uint32_t vertexCount;
     uint32_t instanceCount;
     uint32_t firstVertex;
@@ -575,11 +818,13 @@ struct RHICommandDraw : public RHICommand
     ,firstInstance(firstInstance)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandDrawIndexed : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_DRAW_INDEXED;
+
     uint32_t indexCount; 
     uint32_t instanceCount;
     uint32_t firstIndex;
@@ -594,11 +839,13 @@ struct RHICommandDrawIndexed : public RHICommand
     , firstInstance(firstInstance)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandDrawIndirect : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_DRAW_INDIRECT;
+
     RHIBufferRef argumentBuffer;
     uint32_t offset;
     uint32_t drawCount;
@@ -609,11 +856,13 @@ struct RHICommandDrawIndirect : public RHICommand
     , drawCount(drawCount)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandDrawIndexedIndirect : public RHICommand 
 {
+    static const RHICommandType TYPE = RHI_COMMAND_DRAW_INDEXED_INDIRECT;
+
     RHIBufferRef argumentBuffer;
     uint32_t offset;
     uint32_t drawCount;
@@ -624,27 +873,56 @@ struct RHICommandDrawIndexedIndirect : public RHICommand
     , drawCount(drawCount)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandImGuiCreateFontsTexture : public RHICommand
 {
+    static const RHICommandType TYPE = RHI_COMMAND_IMGUI_CREATE_FONTS_TEXTURE;
+
     RHICommandImGuiCreateFontsTexture() {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
 struct RHICommandImGuiRenderDrawData : public RHICommand
 {
+    static const RHICommandType TYPE = RHI_COMMAND_IMGUI_RENDER_DRAW_DATA;
+
     ImGuiDrawFunc func;
 
     RHICommandImGuiRenderDrawData(ImGuiDrawFunc func) 
     : func(func)
     {}
 
-    virtual void Execute(RHICommandContextRef context) override final;
+    void Execute(RHICommandContext& context, RHICommandScratch& scratch);
 };
 
+template<typename Func>
+inline void RHICommandArena::ForEach(Func&& func)
+{
+    for(auto& block : blocks)
+    {
+        uint8_t* data = reinterpret_cast<uint8_t*>(block.data.get());
+        for(uint32_t offset = 0; offset < block.used;)
+        {
+            RHICommand* command = reinterpret_cast<RHICommand*>(data + offset);
+            offset += command->commandSize; // 回调里会析构记录，先取出大小
+            func(command);
+        }
+    }
+}
+
+template<typename Command, typename... Args>
+inline void RHICommandList::AddCommand(Args&&... args)
+{
+    uint32_t size = RHICommandArena::Align(sizeof(Command)) + RHICommandArena::Align(Command::PayloadSize(args...));
+    Command* command = new (arena.Allocate(size)) Command(std::forward<Args>(args)...);
+    command->type = Command::TYPE;
+    command->commandSize = size;
+    commandCount++;
+}
+
 
 struct RHICommandImmediateTextureBarrier : public RHICommandImmediate 
 {
@@ -668,6 +946,28 @@ struct RHICommandImmediateBufferBarrier : public RHICommandImmediate
     virtual void Execute(RHICommandContextImmediateRef context) override final;
 };
 
+struct RHICommandImmediateTextureBarriers : public RHICommandImmediate 
+{
+    std::vector<RHITextureBarrier> barriers;
+
+    RHICommandImmediateTextureBarriers(const std::vector<RHITextureBarrier>& barriers) 
+    : barriers(barriers)
+    {}
+
+    virtual void Execute(RHICommandContextImmediateRef context) override final;
+};
+
+struct RHICommandImmediateBufferBarriers : public RHICommandImmediate 
+{
+    std::vector<RHIBufferBarrier> barriers;
+
+    RHICommandImmediateBufferBarriers(const std::vector<RHIBufferBarrier>& barriers)
+    : barriers(barriers) 
+    {}
+
+    virtual void Execute(RHICommandContextImmediateRef context) override final;
+};
+
 struct RHICommandImmediateCopyTextureToBuffer : public RHICommandImmediate 
 {
     RHITextureRef src;
@@ -3,6 +3,8 @@
 #include "Core/Log/Log.h"
 #include "Platform/HAL/ScopeLock.h"
 
+#include "MurmurHash2.h"
+
 #include <memory>
 
 RHICommandListRef RHICommandPool::CreateCommandList(bool byPass)
@@ -30,6 +32,21 @@ RHICommandListRef RHICommandPool::CreateCommandList(bool byPass)
     return commandList;
 }
 
+uint64_t RHIShader::ComputeHash(const RHIShaderInfo& info)
+{
+    uint64_t hash = MurmurHash64A(info.code.data(), info.code.size(), info.frequency);
+    return MurmurHash64A(info.entry.data(), info.entry.size(), hash);
+}
+
+uint64_t RHIRootSignature::ComputeHash(const RHIRootSignatureInfo& info)
+{
+    const std::vector<ShaderResourceEntry>& entries = info.GetEntries();
+    const std::vector<PushConstantInfo>& pushConstants = info.GetPushConstants();
+
+    uint64_t hash = MurmurHash64A(entries.data(), entries.size() * sizeof(ShaderResourceEntry), entries.size());
+    return MurmurHash64A(pushConstants.data(), pushConstants.size() * sizeof(PushConstantInfo), hash);
+}
+
 Extent3D RHITexture::MipExtent(uint32_t mipLevel)
 {
     if(mipLevel > info.mipLevels) LOG_DEBUG("Mip level is greater than texture`s max mip!");
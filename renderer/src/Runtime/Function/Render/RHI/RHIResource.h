@@ -100,6 +100,20 @@ protected:
 
 //缓冲，纹理，着色器，加速结构 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+class RHIHeap : public RHIResource		// 一段显存，可在任意偏移处放置buffer和texture，生命周期不重叠的资源可以共享内存
+{
+public:
+	RHIHeap(const RHIHeapInfo& info)
+	: RHIResource(RHI_HEAP)
+	, info(info)
+	{}
+
+	inline const RHIHeapInfo& GetInfo() const { return info; }
+
+protected:
+	RHIHeapInfo info;
+};
+
 class RHIBuffer : public RHIResource
 {
 public:
@@ -175,14 +189,19 @@ public:
 	, info(info)
 	{
 		frequency = info.frequency;
+		hash = ComputeHash(info);
 	}
 
 	ShaderFrequency GetFrequency() 				const { return frequency; }
 	const ShaderReflectInfo& GetReflectInfo() 	const { return reflectInfo; }
 	const RHIShaderInfo& GetInfo() 				const { return info; }
+	uint64_t GetHash()							const { return hash; }	// 按入口，阶段和代码内容计算，跨进程稳定；后端在反射后可能释放代码，因此在构造时计算
+
+	static uint64_t ComputeHash(const RHIShaderInfo& info);
 
 private:
 	ShaderFrequency frequency;
+	uint64_t hash;
 
 protected:
 	RHIShaderInfo info;
@@ -241,14 +260,19 @@ public:
 	RHIRootSignature(const RHIRootSignatureInfo& info) 
 	: RHIResource(RHI_ROOT_SIGNATURE)
 	, info(info)
+	, hash(ComputeHash(info))
 	{}
 
 	virtual RHIDescriptorSetRef CreateDescriptorSet(uint32_t set) = 0;
 
 	const RHIRootSignatureInfo& GetInfo() { return info; }
+	uint64_t GetHash() const { return hash; }		// 按绑定和push constant计算，跨进程稳定
+
+	static uint64_t ComputeHash(const RHIRootSignatureInfo& info);
 
 protected:
 	RHIRootSignatureInfo info;
+	uint64_t hash;
 };
 
 class RHIDescriptorSet : public RHIResource 
@@ -258,7 +282,7 @@ public:
 
 	virtual RHIDescriptorSet& UpdateDescriptor(const RHIDescriptorUpdateInfo& descriptorUpdateInfo) = 0;
 
-	RHIDescriptorSet& UpdateDescriptors(const std::vector<RHIDescriptorUpdateInfo>& descriptorUpdateInfos) 
+	virtual RHIDescriptorSet& UpdateDescriptors(const std::vector<RHIDescriptorUpdateInfo>& descriptorUpdateInfos) 	// 后端应当合并为一次提交，按顺序生效
 	{ 
 		for(auto& info : descriptorUpdateInfos) UpdateDescriptor(info); 
 		return *this;
@@ -16,6 +16,7 @@ typedef std::shared_ptr<class RHICommandContextImmediate> RHICommandContextImmed
 typedef std::shared_ptr<class RHICommandContext> RHICommandContextRef;
 typedef std::shared_ptr<class RHIBackend> RHIBackendRef;
 typedef std::shared_ptr<class RHIResource> RHIResourceRef;
+typedef std::shared_ptr<class RHIHeap> RHIHeapRef;
 typedef std::shared_ptr<class RHIBuffer> RHIBufferRef;
 typedef std::shared_ptr<class RHITexture> RHITextureRef;
 typedef std::shared_ptr<class RHITextureView> RHITextureViewRef;
@@ -39,7 +40,8 @@ typedef std::shared_ptr<class RHISemaphore> RHISemaphoreRef;
 
 enum RHIResourceType : uint32_t	// 此处的倒序也是有效的析构顺序
 {
-	RHI_BUFFER = 0,
+	RHI_HEAP = 0,		// 放置资源持有heap的引用，heap总是最后析构
+	RHI_BUFFER,
 	RHI_TEXTURE,
 	RHI_TEXTURE_VIEW,
 	RHI_SAMPLER,
@@ -305,6 +307,92 @@ static uint32_t FormatChanelCounts(RHIFormat format)
     }
 }
 
+static uint32_t FormatPixelSize(RHIFormat format)	// 单个像素的字节数，用于估算纹理内存占用
+{
+	switch (format) {
+	case FORMAT_R8_SRGB:
+	case FORMAT_R8_UNORM:
+	case FORMAT_R8_SNORM:
+	case FORMAT_R8_UINT:
+	case FORMAT_R8_SINT:
+		return 1;
+
+	case FORMAT_R8G8_SRGB:
+	case FORMAT_R8G8_UNORM:
+	case FORMAT_R8G8_SNORM:
+	case FORMAT_R8G8_UINT:
+	case FORMAT_R8G8_SINT:
+	case FORMAT_R16_SFLOAT:
+	case FORMAT_R16_UNORM:
+	case FORMAT_R16_SNORM:
+	case FORMAT_R16_UINT:
+	case FORMAT_R16_SINT:
+		return 2;
+
+	case FORMAT_R8G8B8_SRGB:
+	case FORMAT_R8G8B8_UNORM:
+	case FORMAT_R8G8B8_SNORM:
+	case FORMAT_R8G8B8_UINT:
+	case FORMAT_R8G8B8_SINT:
+		return 3;
+
+	case FORMAT_R8G8B8A8_SRGB:
+	case FORMAT_B8G8R8A8_SRGB:
+	case FORMAT_R8G8B8A8_UNORM:
+	case FORMAT_R8G8B8A8_SNORM:
+	case FORMAT_R8G8B8A8_UINT:
+	case FORMAT_R8G8B8A8_SINT:
+	case FORMAT_R16G16_SFLOAT:
+	case FORMAT_R16G16_UNORM:
+	case FORMAT_R16G16_SNORM:
+	case FORMAT_R16G16_UINT:
+	case FORMAT_R16G16_SINT:
+	case FORMAT_R32_SFLOAT:
+	case FORMAT_R32_UINT:
+	case FORMAT_R32_SINT:
+	case FORMAT_D32_SFLOAT:
+	case FORMAT_D24_UNORM_S8_UINT:
+	case FORMAT_A2R10G10B10_SNORM:
+    case FORMAT_A2R10G10B10_UNORM:
+    case FORMAT_A2R10G10B10_SINT:
+    case FORMAT_A2R10G10B10_UINT:
+    case FORMAT_B10G11R11_UFLOAT:
+    case FORMAT_E5B9G9R9_UFLOAT:
+		return 4;
+
+	case FORMAT_R16G16B16_SFLOAT:
+	case FORMAT_R16G16B16_UNORM:
+	case FORMAT_R16G16B16_SNORM:
+	case FORMAT_R16G16B16_UINT:
+	case FORMAT_R16G16B16_SINT:
+		return 6;
+
+	case FORMAT_R16G16B16A16_SFLOAT:
+	case FORMAT_R16G16B16A16_UNORM:
+	case FORMAT_R16G16B16A16_SNORM:
+	case FORMAT_R16G16B16A16_UINT:
+	case FORMAT_R16G16B16A16_SINT:
+	case FORMAT_R32G32_SFLOAT:
+	case FORMAT_R32G32_UINT:
+	case FORMAT_R32G32_SINT:
+	case FORMAT_D32_SFLOAT_S8_UINT:
+		return 8;
+
+	case FORMAT_R32G32B32_SFLOAT:
+	case FORMAT_R32G32B32_UINT:
+	case FORMAT_R32G32B32_SINT:
+		return 12;
+
+	case FORMAT_R32G32B32A32_SFLOAT:
+	case FORMAT_R32G32B32A32_UINT:
+	case FORMAT_R32G32B32A32_SINT:
+		return 16;
+
+	default:  
+		return 0;
+    }
+}
+
 static bool IsDepthStencilFormat(RHIFormat format)
 {
 	switch (format) {
@@ -796,6 +884,24 @@ typedef struct RHICommandPoolInfo
 
 } RHICommandPoolInfo;
 
+typedef struct RHIHeapInfo
+{
+	uint64_t size;
+	uint64_t alignment = 1;			// 取放置其上的资源对齐的最大值
+
+	MemoryUsage memoryUsage = MEMORY_USAGE_GPU_ONLY;
+	uint32_t memoryTypeBits = 0;	// 放置其上的资源所允许的内存类型的交集
+
+} RHIHeapInfo;
+
+typedef struct RHIMemoryRequirements
+{
+	uint64_t size = 0;
+	uint64_t alignment = 1;
+	uint32_t memoryTypeBits = 0;	// 后端相关，只用于判断资源能否放置在同一个heap上
+
+} RHIMemoryRequirements;
+
 typedef struct RHIBufferInfo
 {
 	uint64_t size;
@@ -872,6 +978,8 @@ typedef struct RHIShaderInfo
 
 	ShaderFrequency frequency;
 	std::vector<uint8_t> code;
+
+	std::string path = "";		// 着色器文件路径，非空时反射信息缓存在文件旁边，代码没有变化时跳过反射
 } RHIShaderInfo;
 
 typedef struct RHIShaderBindingTableInfo
@@ -952,6 +1060,7 @@ typedef struct ShaderReflectInfo
     uint32_t localSizeX = 0;
     uint32_t localSizeY = 0;
     uint32_t localSizeZ = 0;
+	uint32_t pushConstantSize = 0;
 
 	bool DefinedSymbol(std::string symbol) const { return definedSymbols.find(symbol) != definedSymbols.end(); }
 
@@ -1241,6 +1350,8 @@ typedef struct RHIBufferBarrier
 	uint32_t offset = 0;
 	uint32_t size = 0;
 
+	bool aliasing = false;		// 放置资源在该内存上的首次使用，需要等待之前占用同一段内存的资源的访问完成
+
 } RHIBufferBarrier;
 
 typedef struct RHITextureBarrier
@@ -1251,4 +1362,6 @@ typedef struct RHITextureBarrier
 
 	TextureSubresourceRange subresource = {};	// 此时取texture的默认range
 
+	bool aliasing = false;		// 同RHIBufferBarrier
+
 } RHITextureBarrier;
@@ -0,0 +1,241 @@
+#include "ShaderReflect.h"
+#include "Core/Log/Log.h"
+
+#include <spirv_reflect.h>
+#include <algorithm>
+#include <cstdint>
+#include <regex>
+#include <string>
+#include <vector>
+
+static RHIFormat SpvFormatToRHIFormat(const SpvReflectFormat& spvFormat)
+{
+    RHIFormat format;
+
+    switch (spvFormat) {
+    case SPV_REFLECT_FORMAT_UNDEFINED:              format = FORMAT_UKNOWN;                 break;
+    case SPV_REFLECT_FORMAT_R16_UINT:               format = FORMAT_R16_UINT;               break;
+    case SPV_REFLECT_FORMAT_R16_SINT:               format = FORMAT_R16_SINT;               break;
+    case SPV_REFLECT_FORMAT_R16_SFLOAT:             format = FORMAT_R16_SFLOAT;             break;
+    case SPV_REFLECT_FORMAT_R16G16_UINT:            format = FORMAT_R16G16_UINT;            break;
+    case SPV_REFLECT_FORMAT_R16G16_SINT:            format = FORMAT_R16G16_SINT;            break;
+    case SPV_REFLECT_FORMAT_R16G16_SFLOAT:          format = FORMAT_R16G16_SFLOAT;          break;
+    case SPV_REFLECT_FORMAT_R16G16B16_UINT:         format = FORMAT_R16G16B16_UINT;         break;
+    case SPV_REFLECT_FORMAT_R16G16B16_SINT:         format = FORMAT_R16G16B16_SINT;         break;
+    case SPV_REFLECT_FORMAT_R16G16B16_SFLOAT:       format = FORMAT_R16G16B16_SFLOAT;       break;
+    case SPV_REFLECT_FORMAT_R16G16B16A16_UINT:      format = FORMAT_R16G16B16A16_UINT;      break;
+    case SPV_REFLECT_FORMAT_R16G16B16A16_SINT:      format = FORMAT_R16G16B16A16_SINT;      break;
+    case SPV_REFLECT_FORMAT_R16G16B16A16_SFLOAT:    format = FORMAT_R16G16B16A16_SFLOAT;    break;
+    case SPV_REFLECT_FORMAT_R32_UINT:               format = FORMAT_R32_UINT;               break;
+    case SPV_REFLECT_FORMAT_R32_SINT:               format = FORMAT_R32_SINT;               break;
+    case SPV_REFLECT_FORMAT_R32_SFLOAT:             format = FORMAT_R32_SFLOAT;             break;
+    case SPV_REFLECT_FORMAT_R32G32_UINT:            format = FORMAT_R32G32_UINT;            break;
+    case SPV_REFLECT_FORMAT_R32G32_SINT:            format = FORMAT_R32G32_SINT;            break;
+    case SPV_REFLECT_FORMAT_R32G32_SFLOAT:          format = FORMAT_R32G32_SFLOAT;          break;
+    case SPV_REFLECT_FORMAT_R32G32B32_UINT:         format = FORMAT_R32G32B32_UINT;         break;
+    case SPV_REFLECT_FORMAT_R32G32B32_SINT:         format = FORMAT_R32G32B32_SINT;         break;
+    case SPV_REFLECT_FORMAT_R32G32B32_SFLOAT:       format = FORMAT_R32G32B32_SFLOAT;       break;
+    case SPV_REFLECT_FORMAT_R32G32B32A32_UINT:      format = FORMAT_R32G32B32A32_UINT;      break;
+    case SPV_REFLECT_FORMAT_R32G32B32A32_SINT:      format = FORMAT_R32G32B32A32_SINT;      break;
+    case SPV_REFLECT_FORMAT_R32G32B32A32_SFLOAT:    format = FORMAT_R32G32B32A32_SFLOAT;    break;  
+    default:                                        LOG_FATAL("Unsupported reflect format type!"); 
+    }
+
+    return format;
+}
+
+static ShaderFrequency SpvShaderStageToFrequency(SpvReflectShaderStageFlagBits spvShaderStage)
+{
+    ShaderFrequency frequency;
+    switch (spvShaderStage) {
+    case SPV_REFLECT_SHADER_STAGE_VERTEX_BIT:               frequency = SHADER_FREQUENCY_VERTEX;         break;
+    case SPV_REFLECT_SHADER_STAGE_GEOMETRY_BIT:             frequency = SHADER_FREQUENCY_GEOMETRY;       break;
+    case SPV_REFLECT_SHADER_STAGE_FRAGMENT_BIT:             frequency = SHADER_FREQUENCY_FRAGMENT;       break;
+    case SPV_REFLECT_SHADER_STAGE_COMPUTE_BIT:              frequency = SHADER_FREQUENCY_COMPUTE;        break;
+    case SPV_REFLECT_SHADER_STAGE_MESH_BIT_NV:              frequency = SHADER_FREQUENCY_MESH;           break;
+    case SPV_REFLECT_SHADER_STAGE_RAYGEN_BIT_KHR:           frequency = SHADER_FREQUENCY_RAY_GEN;        break;
+    case SPV_REFLECT_SHADER_STAGE_ANY_HIT_BIT_KHR:          frequency = SHADER_FREQUENCY_ANY_HIT;        break;
+    case SPV_REFLECT_SHADER_STAGE_CLOSEST_HIT_BIT_KHR:      frequency = SHADER_FREQUENCY_CLOSEST_HIT;    break;
+    case SPV_REFLECT_SHADER_STAGE_MISS_BIT_KHR:             frequency = SHADER_FREQUENCY_RAY_MISS;       break;
+    case SPV_REFLECT_SHADER_STAGE_INTERSECTION_BIT_KHR:     frequency = SHADER_FREQUENCY_INTERSECTION;   break;
+    default:                                                frequency = SHADER_FREQUENCY_ALL;            break;
+    }
+
+    return frequency;
+}
+
+static ResourceType SpvDescriptorTypeToResourceType (SpvReflectDescriptorType descriptorType)
+{
+    ResourceType resourceType;
+    switch (descriptorType) {
+    case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLER:                       resourceType = RESOURCE_TYPE_SAMPLER;                   break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:        resourceType = RESOURCE_TYPE_COMBINED_IMAGE_SAMPLER;    break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE:                 resourceType = RESOURCE_TYPE_TEXTURE;                   break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_IMAGE:                 resourceType = RESOURCE_TYPE_RW_TEXTURE;                break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:          resourceType = RESOURCE_TYPE_TEXEL_BUFFER;              break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:          resourceType = RESOURCE_TYPE_RW_TEXEL_BUFFER;           break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER:                resourceType = RESOURCE_TYPE_UNIFORM_BUFFER;            break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER:                resourceType = RESOURCE_TYPE_RW_BUFFER;                 break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:        resourceType = RESOURCE_TYPE_UNIFORM_BUFFER;            break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:        resourceType = RESOURCE_TYPE_RW_BUFFER;                 break;
+    case SPV_REFLECT_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:    resourceType = RESOURCE_TYPE_RAY_TRACING;               break;
+    default:                                                        LOG_FATAL("Unsupported reflect descriptor type!"); 
+    }
+
+    return resourceType;
+}
+
+static TextureViewType SpvDimToTextureViewType(SpvDim dim, bool isArray)
+{
+    TextureViewType viewType;
+    switch (dim) {
+    case SpvDim1D:      viewType = isArray ? VIEW_TYPE_1D_ARRAY : VIEW_TYPE_1D;         break;
+    case SpvDim2D:      viewType = isArray ? VIEW_TYPE_2D_ARRAY : VIEW_TYPE_2D;         break;
+    case SpvDim3D:      viewType = isArray ? VIEW_TYPE_UNDEFINED : VIEW_TYPE_3D;        break;
+    case SpvDimCube:    viewType = isArray ? VIEW_TYPE_CUBE_ARRAY : VIEW_TYPE_CUBE;     break;
+    default:            LOG_FATAL("Unsupported texture view type!");  
+    }
+    
+    return viewType;
+}
+
+void ShaderReflect::Reflect(const std::vector<uint8_t>& code, ShaderReflectInfo& reflectInfo)
+{
+    // 从spv文件的字符串信息里收集定义的宏
+    std::regex pattern("#define (\\w+)");
+    for (std::cregex_iterator it((char*)code.data(), (char*)code.data() + code.size(), pattern); 
+            it != std::cregex_iterator{}; it++) 
+    {
+        reflectInfo.definedSymbols.insert((*it)[1].str());
+    }
+
+    SpvReflectShaderModule module;
+    SpvReflectResult result = spvReflectCreateShaderModule(code.size(), code.data(), &module);
+    if(result != SPV_REFLECT_RESULT_SUCCESS)    LOG_DEBUG("Failed to generate shader reflect data!");
+    if(module.entry_point_count != 1)           LOG_DEBUG("Shader file contains more than one entry!");   //暂时只做单entry吧       
+
+    const SpvReflectEntryPoint* entry = spvReflectGetEntryPoint(&module, module.entry_points[0].name);
+
+    reflectInfo.name = std::string(entry->name);
+    reflectInfo.frequency = SpvShaderStageToFrequency(entry->shader_stage);
+    if (reflectInfo.frequency == SHADER_FREQUENCY_COMPUTE)
+    {
+        reflectInfo.localSizeX = entry->local_size.x;
+        reflectInfo.localSizeY = entry->local_size.y;
+        reflectInfo.localSizeZ = entry->local_size.z;
+    }
+
+    // bool isGLSL = module.source_language & SpvSourceLanguageGLSL;
+    // bool isHLSL = module.source_language & SpvSourceLanguageHLSL;
+
+    // pushConstant，只记录占用的大小
+    uint32_t pushConstantCnt;
+    spvReflectEnumeratePushConstantBlocks(&module, &pushConstantCnt, NULL);
+    if (pushConstantCnt > 0) 
+    {
+        std::vector<SpvReflectBlockVariable*> blockVariables(pushConstantCnt);
+        spvReflectEnumeratePushConstantBlocks(&module, &pushConstantCnt, blockVariables.data());
+
+        for(uint32_t i = 0; i < pushConstantCnt; i++)
+            reflectInfo.pushConstantSize = std::max(reflectInfo.pushConstantSize, blockVariables[i]->offset + blockVariables[i]->size);
+    }
+
+    // 着色器输入和输出
+    uint32_t inputVariableCnt;
+    spvReflectEnumerateInputVariables(&module, &inputVariableCnt, NULL);
+    if (inputVariableCnt > 0)
+    {
+        std::vector<SpvReflectInterfaceVariable*> inputVariables(inputVariableCnt);   
+        spvReflectEnumerateInputVariables(&module, &inputVariableCnt, inputVariables.data()); 
+
+        for(uint32_t i = 0; i < inputVariableCnt; i++)
+        {
+            if(inputVariables[i]->location < MAX_SHADER_IN_OUT_VARIABLES)
+                reflectInfo.inputVariables[inputVariables[i]->location] = SpvFormatToRHIFormat(inputVariables[i]->format);
+        }
+    }
+
+    uint32_t outputVariableCnt;
+    spvReflectEnumerateOutputVariables(&module, &outputVariableCnt, NULL);
+    if(outputVariableCnt > 0)
+    {
+        std::vector<SpvReflectInterfaceVariable*> outputVariables(outputVariableCnt);
+        spvReflectEnumerateOutputVariables(&module, &outputVariableCnt, outputVariables.data());
+
+        for(uint32_t i = 0; i < outputVariableCnt; i++)
+        {
+            if(outputVariables[i]->location < MAX_SHADER_IN_OUT_VARIABLES)
+                reflectInfo.outputVariables[outputVariables[i]->location] = SpvFormatToRHIFormat(outputVariables[i]->format);
+        }
+    }
+
+    // specialization constant
+    // uint32_t specializationConstantCnt;
+    // spvReflectEnumerateSpecializationConstants(&module, &specializationConstantCnt, NULL);
+    // if(specializationConstantCnt > 0)
+    // {
+    //     std::vector<SpvReflectSpecializationConstant*> specializationConstants(specializationConstantCnt);
+    //     spvReflectEnumerateSpecializationConstants(&module, &specializationConstantCnt, specializationConstants.data());
+
+    //     for(uint32_t i = 0; i < specializationConstantCnt; i++)
+    //     {
+    //         specializationConstants[i];
+    //     }       
+    // }
+
+    // interface variable
+    // uint32_t interfaceVariableCnt;
+    // spvReflectEnumerateInterfaceVariables(&module, &interfaceVariableCnt, NULL);
+    // if(interfaceVariableCnt > 0)
+    // {
+    //     std::vector<SpvReflectInterfaceVariable*> interfaceVariables(interfaceVariableCnt);
+    //     spvReflectEnumerateInterfaceVariables(&module, &interfaceVariableCnt, interfaceVariables.data());
+
+    //     for(uint32_t i = 0; i < interfaceVariableCnt; i++)
+    //     {
+    //         interfaceVariables[i];
+    //     }       
+    // }
+
+
+    // 描述符
+    uint32_t descriptorSetCnt;
+    spvReflectEnumerateDescriptorSets(&module, &descriptorSetCnt, NULL);
+    if (descriptorSetCnt > 0)
+    {
+        std::vector<SpvReflectDescriptorSet*> descriptorSets(descriptorSetCnt);
+        spvReflectEnumerateDescriptorSets(&module, &descriptorSetCnt, descriptorSets.data());
+
+        uint32_t descriptorSize = 0;
+        for (uint32_t i = 0; i < descriptorSetCnt; i++)   descriptorSize += descriptorSets[i]->binding_count;
+        reflectInfo.resources.resize(descriptorSize);
+
+        uint32_t i = 0;
+        for (uint32_t set = 0; set < descriptorSetCnt; set++)
+        {
+            SpvReflectDescriptorSet* currentSet = descriptorSets[set];
+
+            for (uint32_t binding = 0; binding < currentSet->binding_count; binding++, i++)
+            {
+                SpvReflectDescriptorBinding* currentBinding = currentSet->bindings[binding];
+
+                ShaderResourceEntry& entry = reflectInfo.resources[i];
+                //entry.name = std::string(currentBinding->name);
+                entry.set = currentBinding->set;
+                entry.binding = currentBinding->binding; 
+                entry.size = currentBinding->count;
+                entry.type = SpvDescriptorTypeToResourceType(currentBinding->descriptor_type);
+                entry.frequency = reflectInfo.frequency;
+
+                if ((currentBinding->type_description->type_flags & SPV_REFLECT_TYPE_FLAG_EXTERNAL_IMAGE) ||
+                    (currentBinding->type_description->type_flags & SPV_REFLECT_TYPE_FLAG_EXTERNAL_SAMPLED_IMAGE))
+                {
+                    bool isArray = (currentBinding->type_description->type_flags & SPV_REFLECT_TYPE_FLAG_ARRAY);
+                    // entry.textureViewType = SpvDimToTextureViewType(currentBinding->image.dim, isArray); // 暂时不需要这个信息
+                }
+            }
+        }
+    }
+
+    spvReflectDestroyShaderModule(&module);
+}
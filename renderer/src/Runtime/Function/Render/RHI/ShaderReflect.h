@@ -0,0 +1,13 @@
+#pragma once
+
+#include "RHIStructs.h"
+
+#include <cstdint>
+#include <vector>
+
+// 着色器反射，只依赖spv代码本身，不依赖设备和后端，各后端创建着色器时共用
+class ShaderReflect
+{
+public:
+    static void Reflect(const std::vector<uint8_t>& code, ShaderReflectInfo& reflectInfo);
+};
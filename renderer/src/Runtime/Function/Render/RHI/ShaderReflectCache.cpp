@@ -0,0 +1,202 @@
+#include "ShaderReflectCache.h"
+
+#include "Core/Math/Hash.h"
+#include "Function/Global/EngineContext.h"
+#include "Platform/File/FileSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class ReflectDataWriter
+{
+public:
+    template<typename T>
+    void Write(const T& value)
+    {
+        const uint8_t* begin = (const uint8_t*)&value;
+        data.insert(data.end(), begin, begin + sizeof(T));
+    }
+
+    void Write(const std::string& str)
+    {
+        Write((uint32_t)str.size());
+        data.insert(data.end(), str.begin(), str.end());
+    }
+
+    std::vector<uint8_t> data;
+};
+
+class ReflectDataReader
+{
+public:
+    ReflectDataReader(const uint8_t* begin, uint64_t size) : begin(begin), size(size) {}
+
+    template<typename T>
+    bool Read(T& value)
+    {
+        if(offset + sizeof(T) > size) return false;
+        memcpy(&value, begin + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool Read(std::string& str)
+    {
+        uint32_t length;
+        if(!Read(length) || offset + length > size) return false;
+        str.assign((const char*)begin + offset, length);
+        offset += length;
+        return true;
+    }
+
+    bool End() { return offset == size; }
+
+private:
+    const uint8_t* begin;
+    uint64_t size;
+    uint64_t offset = 0;
+};
+
+uint32_t ShaderReflectCache::CodeHash(const std::vector<uint8_t>& code)
+{
+    return Hash(code.data(), code.size());
+}
+
+std::vector<uint8_t> ShaderReflectCache::Serialize(const std::vector<uint8_t>& code, const ShaderReflectInfo& reflectInfo)
+{
+    ReflectDataWriter writer;
+    writer.Write(reflectInfo.name);
+    writer.Write((uint32_t)reflectInfo.frequency);
+    writer.Write(reflectInfo.localSizeX);
+    writer.Write(reflectInfo.localSizeY);
+    writer.Write(reflectInfo.localSizeZ);
+    writer.Write(reflectInfo.pushConstantSize);
+    for(RHIFormat format : reflectInfo.inputVariables)  writer.Write((uint32_t)format);
+    for(RHIFormat format : reflectInfo.outputVariables) writer.Write((uint32_t)format);
+
+    writer.Write((uint32_t)reflectInfo.resources.size());
+    for(const ShaderResourceEntry& entry : reflectInfo.resources)
+    {
+        writer.Write(entry.set);
+        writer.Write(entry.binding);
+        writer.Write(entry.size);
+        writer.Write((uint32_t)entry.frequency);
+        writer.Write((uint32_t)entry.type);
+    }
+
+    std::vector<std::string> symbols(reflectInfo.definedSymbols.begin(), reflectInfo.definedSymbols.end());
+    std::sort(symbols.begin(), symbols.end());     // 保证相同的反射信息生成相同的文件
+    writer.Write((uint32_t)symbols.size());
+    for(const std::string& symbol : symbols) writer.Write(symbol);
+
+    ShaderReflectCacheHeader header;
+    memset(&header, 0, sizeof(ShaderReflectCacheHeader));
+    header.magic = SHADER_REFLECT_CACHE_MAGIC;
+    header.version = SHADER_REFLECT_CACHE_VERSION;
+    header.codeHash = CodeHash(code);
+    header.dataHash = Hash(writer.data.data(), writer.data.size());
+    header.codeSize = code.size();
+    header.dataSize = writer.data.size();
+
+    std::vector<uint8_t> file(sizeof(ShaderReflectCacheHeader) + writer.data.size());
+    memcpy(file.data(), &header, sizeof(ShaderReflectCacheHeader));
+    memcpy(file.data() + sizeof(ShaderReflectCacheHeader), writer.data.data(), writer.data.size());
+    return file;
+}
+
+bool ShaderReflectCache::Deserialize(const std::vector<uint8_t>& file, const std::vector<uint8_t>& code, ShaderReflectInfo& reflectInfo)
+{
+    if(file.size() < sizeof(ShaderReflectCacheHeader)) return false;
+
+    ShaderReflectCacheHeader header;
+    memcpy(&header, file.data(), sizeof(ShaderReflectCacheHeader));
+    if( header.magic != SHADER_REFLECT_CACHE_MAGIC ||
+        header.version != SHADER_REFLECT_CACHE_VERSION ||
+        header.dataSize != file.size() - sizeof(ShaderReflectCacheHeader)) return false;
+
+    if( header.codeSize != code.size() ||
+        header.codeHash != CodeHash(code)) return false;
+
+    const uint8_t* begin = file.data() + sizeof(ShaderReflectCacheHeader);
+    if(Hash(begin, header.dataSize) != header.dataHash) return false;
+
+    // 先读到临时变量里，失败时不修改输出
+    ShaderReflectInfo info = {};
+    ReflectDataReader reader(begin, header.dataSize);
+
+    uint32_t frequency;
+    if( !reader.Read(info.name) ||
+        !reader.Read(frequency) ||
+        !reader.Read(info.localSizeX) ||
+        !reader.Read(info.localSizeY) ||
+        !reader.Read(info.localSizeZ) ||
+        !reader.Read(info.pushConstantSize)) return false;
+    info.frequency = (ShaderFrequency)frequency;
+
+    for(RHIFormat& format : info.inputVariables)
+    {
+        uint32_t value;
+        if(!reader.Read(value)) return false;
+        format = (RHIFormat)value;
+    }
+    for(RHIFormat& format : info.outputVariables)
+    {
+        uint32_t value;
+        if(!reader.Read(value)) return false;
+        format = (RHIFormat)value;
+    }
+
+    uint32_t resourceCount;
+    if(!reader.Read(resourceCount)) return false;
+    for(uint32_t i = 0; i < resourceCount; i++)
+    {
+        ShaderResourceEntry entry = {};
+        uint32_t entryFrequency, type;
+        if( !reader.Read(entry.set) ||
+            !reader.Read(entry.binding) ||
+            !reader.Read(entry.size) ||
+            !reader.Read(entryFrequency) ||
+            !reader.Read(type)) return false;
+        entry.frequency = (ShaderFrequency)entryFrequency;
+        entry.type = (ResourceType)type;
+        info.resources.push_back(entry);
+    }
+
+    uint32_t symbolCount;
+    if(!reader.Read(symbolCount)) return false;
+    for(uint32_t i = 0; i < symbolCount; i++)
+    {
+        std::string symbol;
+        if(!reader.Read(symbol)) return false;
+        info.definedSymbols.insert(symbol);
+    }
+    if(!reader.End()) return false;
+
+    reflectInfo = std::move(info);
+    return true;
+}
+
+bool ShaderReflectCache::Load(const std::string& shaderPath, const std::vector<uint8_t>& code, ShaderReflectInfo& reflectInfo)
+{
+    std::string path = CachePath(shaderPath);
+    if(!EngineContext::File()->Exists(path)) return false;
+
+    std::vector<uint8_t> file;
+    if(!EngineContext::File()->LoadBinary(path, file)) return false;
+    return Deserialize(file, code, reflectInfo);
+}
+
+bool ShaderReflectCache::Save(const std::string& shaderPath, const std::vector<uint8_t>& code, const ShaderReflectInfo& reflectInfo)
+{
+    std::vector<uint8_t> file = Serialize(code, reflectInfo);
+
+    std::ofstream out(EngineContext::File()->Absolute(CachePath(shaderPath)), std::ios::binary | std::ios::trunc);
+    if(!out.is_open()) return false;
+
+    out.write(reinterpret_cast<const char*>(file.data()), file.size());
+    return out.good();
+}
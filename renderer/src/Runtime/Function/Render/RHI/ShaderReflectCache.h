@@ -0,0 +1,38 @@
+#pragma once
+
+#include "RHIStructs.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 着色器反射信息的磁盘缓存，存放在spv文件旁边（xxx.spv.reflect），布局：[ShaderReflectCacheHeader][数据]
+// 反射只依赖spv代码本身，按代码的哈希和长度匹配，代码重新编译后缓存自动作废，重新反射后覆盖
+// 数据包含入口名，阶段，计算着色器的线程组大小，push constant大小，输入输出变量格式，描述符绑定和定义的宏
+
+#define SHADER_REFLECT_CACHE_MAGIC 0x52535254       // "TRSR"
+#define SHADER_REFLECT_CACHE_VERSION 1              // 反射的内容或者数据格式改变时递增，旧缓存全部作废
+
+typedef struct ShaderReflectCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t codeHash;
+    uint32_t dataHash;
+    uint64_t codeSize;
+    uint64_t dataSize;                      // 用于检查文件是否写入完整
+
+} ShaderReflectCacheHeader;
+
+class ShaderReflectCache
+{
+public:
+    static std::string CachePath(const std::string& shaderPath)   { return shaderPath + ".reflect"; }
+    static uint32_t CodeHash(const std::vector<uint8_t>& code);
+
+    static std::vector<uint8_t> Serialize(const std::vector<uint8_t>& code, const ShaderReflectInfo& reflectInfo);
+    static bool Deserialize(const std::vector<uint8_t>& file, const std::vector<uint8_t>& code, ShaderReflectInfo& reflectInfo);    // 代码不符，文件不完整或损坏时返回false
+
+    static bool Load(const std::string& shaderPath, const std::vector<uint8_t>& code, ShaderReflectInfo& reflectInfo);             // 缓存不存在或者失效时返回false，不报错
+    static bool Save(const std::string& shaderPath, const std::vector<uint8_t>& code, const ShaderReflectInfo& reflectInfo);
+};
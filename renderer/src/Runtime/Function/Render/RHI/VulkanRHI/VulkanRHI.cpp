@@ -7,6 +7,7 @@
 #include "Function/Render/RHI/RHIResource.h"
 #include "Function/Render/RHI/RHIStructs.h"
 #include "Function/Render/RHI/RHI.h"
+#include "Function/Render/RHI/PipelineCacheFile.h"
 #include "Platform/HAL/PlatformProcess.h"
 #include "Core/Log/Log.h"
 #include "implot.h"
@@ -20,6 +21,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -34,6 +36,7 @@ VulkanRHIBackend::VulkanRHIBackend(const RHIBackendInfo& info)
     CreateQueues();
     CreateMemoryAllocator();
     CreateDescriptorPool();
+    CreatePipelineCache();
     CreateImmediateCommand();
 }
 
@@ -62,8 +65,12 @@ void VulkanRHIBackend::Destroy()
 
     renderPassPool.Clear();
     frameBufferPool.Clear();
+    descriptorUpdateTemplatePool.Clear();
     vkDestroyDescriptorPool(logicalDevice, descriptorPool, nullptr);
 
+    SavePipelineCache();
+    vkDestroyPipelineCache(logicalDevice, pipelineCache, nullptr);
+
     vmaDestroyAllocator(memoryAllocator);
     vkDestroyDevice(logicalDevice, nullptr);
     vkDestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
@@ -181,6 +188,65 @@ RHITextureRef VulkanRHIBackend::CreateTexture(const RHITextureInfo& info)
     return texture;
 }
 
+RHIHeapRef VulkanRHIBackend::CreateHeap(const RHIHeapInfo& info)
+{
+    RHIHeapRef heap = std::make_shared<VulkanRHIHeap>(info, *this);
+    RegisterResource(heap);
+
+    return heap;
+}
+
+RHIMemoryRequirements VulkanRHIBackend::GetMemoryRequirements(const RHIBufferInfo& info)
+{
+    // 创建一个不绑定内存的临时对象来查询，调用方应缓存结果
+    VkBufferCreateInfo bufferInfo = VulkanRHIBuffer::CreateInfo(info);
+    VkBuffer buffer;
+    if(vkCreateBuffer(logicalDevice, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
+    {
+        LOG_FATAL("Failed to create buffer!");
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(logicalDevice, buffer, &requirements);
+    vkDestroyBuffer(logicalDevice, buffer, nullptr);
+
+    if(info.creationFlag & BUFFER_CREATION_FORCE_ALIGNMENT) requirements.alignment = std::max(requirements.alignment, (VkDeviceSize)256);
+
+    return { requirements.size, requirements.alignment, requirements.memoryTypeBits };
+}
+
+RHIMemoryRequirements VulkanRHIBackend::GetMemoryRequirements(const RHITextureInfo& info)
+{
+    VkImageCreateInfo imageInfo = VulkanRHITexture::CreateInfo(info);
+    VkImage image;
+    if(vkCreateImage(logicalDevice, &imageInfo, nullptr, &image) != VK_SUCCESS)
+    {
+        LOG_FATAL("Failed to create image!");
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(logicalDevice, image, &requirements);
+    vkDestroyImage(logicalDevice, image, nullptr);
+
+    return { requirements.size, requirements.alignment, requirements.memoryTypeBits };
+}
+
+RHIBufferRef VulkanRHIBackend::CreatePlacedBuffer(const RHIBufferInfo& info, RHIHeapRef heap, uint64_t offset)
+{
+    RHIBufferRef buffer = std::make_shared<VulkanRHIBuffer>(info, *this, heap, offset);
+    RegisterResource(buffer);
+
+    return buffer;
+}
+
+RHITextureRef VulkanRHIBackend::CreatePlacedTexture(const RHITextureInfo& info, RHIHeapRef heap, uint64_t offset)
+{
+    RHITextureRef texture = std::make_shared<VulkanRHITexture>(info, *this, heap, offset);
+    RegisterResource(texture);
+
+    return texture;
+}
+
 RHITextureViewRef VulkanRHIBackend::CreateTextureView(const RHITextureViewInfo& info)
 {
     RHITextureViewRef textureView = std::make_shared<VulkanRHITextureView>(info, *this);
@@ -753,6 +819,83 @@ void VulkanRHIBackend::CreateDescriptorPool()
     }
 }
 
+static const std::string PIPELINE_CACHE_PATH = "PipelineCache/vulkan.bin";     // 相对缓存目录
+
+static PipelineCacheDeviceInfo GetPipelineCacheDeviceInfo(const VkPhysicalDeviceProperties& properties)
+{
+    PipelineCacheDeviceInfo device = {};
+    device.vendorID = properties.vendorID;
+    device.deviceID = properties.deviceID;
+    device.driverVersion = properties.driverVersion;
+    memcpy(device.uuid, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return device;
+}
+
+// 驱动数据自带的头，文件头已经校验过一次，这里防止驱动不按UUID区分数据格式
+static bool CheckPipelineCacheData(const std::vector<uint8_t>& data, const VkPhysicalDeviceProperties& properties)
+{
+    VkPipelineCacheHeaderVersionOne header;
+    if(data.size() < sizeof(VkPipelineCacheHeaderVersionOne)) return false;
+    memcpy(&header, data.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+
+    return  header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne) &&
+            header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+            header.vendorID == properties.vendorID &&
+            header.deviceID == properties.deviceID &&
+            memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void VulkanRHIBackend::CreatePipelineCache()
+{
+    std::string path = EngineContext::File()->CachePath() + PIPELINE_CACHE_PATH;
+    PipelineCacheDeviceInfo device = GetPipelineCacheDeviceInfo(properties);
+
+    std::vector<uint8_t> file, data;
+    if(PipelineCacheFile::Read(path, file))
+    {
+        PipelineCacheFileResult result = PipelineCacheFile::Unpack(file, device, data);
+        if(result == PIPELINE_CACHE_FILE_OK && !CheckPipelineCacheData(data, properties)) result = PIPELINE_CACHE_FILE_DEVICE_MISMATCH;
+        if(result != PIPELINE_CACHE_FILE_OK)
+        {
+            ENGINE_LOG_WARN("Pipeline cache [{}] is discarded, reason [{}]", path, (uint32_t)result);
+            data.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo = {};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(logicalDevice, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) 
+    {
+        // 驱动拒绝了数据时用空缓存重试
+        cacheInfo.initialDataSize = 0;
+        cacheInfo.pInitialData = nullptr;
+        if (vkCreatePipelineCache(logicalDevice, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) 
+        {
+            LOG_FATAL("Failed to create pipeline cache!");
+        }
+    }
+    else if(!data.empty()) ENGINE_LOG_INFO("Pipeline cache loaded, size [{}]", data.size());
+}
+
+void VulkanRHIBackend::SavePipelineCache()
+{
+    size_t size = 0;
+    if(vkGetPipelineCacheData(logicalDevice, pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) return;
+
+    std::vector<uint8_t> data(size);
+    if(vkGetPipelineCacheData(logicalDevice, pipelineCache, &size, data.data()) != VK_SUCCESS) return;
+    data.resize(size);
+
+    std::string path = EngineContext::File()->CachePath() + PIPELINE_CACHE_PATH;
+    if(!PipelineCacheFile::Write(path, PipelineCacheFile::Pack(GetPipelineCacheDeviceInfo(properties), data)))
+    {
+        ENGINE_LOG_WARN("Failed to save pipeline cache [{}]", path);
+    }
+}
+
 void VulkanRHIBackend::CreateImmediateCommand()
 {
     immediateCommandContext = std::make_shared<VulkanRHICommandContextImmediate>(*this);
@@ -865,21 +1008,44 @@ VkFramebuffer VulkanRHIBackend::CreateVkFramebuffer(const VkFramebufferCreateInf
     return frameBuffer;
 }
 
+VkDescriptorUpdateTemplate VulkanRHIBackend::CreateVkDescriptorUpdateTemplate(VkDescriptorSetLayout layout, const std::vector<VkDescriptorUpdateTemplateEntry>& entries)
+{
+    VkDescriptorUpdateTemplateCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    createInfo.descriptorUpdateEntryCount = (uint32_t)entries.size();
+    createInfo.pDescriptorUpdateEntries = entries.data();
+    createInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    createInfo.descriptorSetLayout = layout;
+
+    VkDescriptorUpdateTemplate updateTemplate;
+    if (vkCreateDescriptorUpdateTemplate(logicalDevice, &createInfo, nullptr, &updateTemplate) != VK_SUCCESS) 
+    {
+        LOG_FATAL("Failed to create descriptor update template!");
+    }
 
+    return updateTemplate;
+}
 
 
 
 
 
-void TextureBarrier(VkCommandBuffer commandBuffer, const RHITextureBarrier& barrier)
+
+
+VkImageMemoryBarrier ImageMemoryBarrier(const RHITextureBarrier& barrier, VkPipelineStageFlags& srcStage, VkPipelineStageFlags& dstStage)
 {
     TextureSubresourceRange range = barrier.subresource;
     if (range.aspect == TEXTURE_ASPECT_NONE) range = barrier.texture->GetDefaultSubresourceRange();
 
     VkAccessFlags srcAccessMask = VulkanUtil::ResourceStateToAccessFlags(barrier.srcState);
     VkAccessFlags dstAccessMask = VulkanUtil::ResourceStateToAccessFlags(barrier.dstState);
-    VkPipelineStageFlags srcStage = VulkanUtil::AccessFlagsToPipelineStageFlags(srcAccessMask);
-    VkPipelineStageFlags dstStage = VulkanUtil::AccessFlagsToPipelineStageFlags(dstAccessMask);
+    srcStage |= VulkanUtil::AccessFlagsToPipelineStageFlags(srcAccessMask);
+    dstStage |= VulkanUtil::AccessFlagsToPipelineStageFlags(dstAccessMask);
+    if(barrier.aliasing)    // 不知道之前占用这段内存的资源的状态，等待全部的写入
+    {
+        srcStage |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        srcAccessMask |= VK_ACCESS_MEMORY_WRITE_BIT;
+    }
 
     // srcStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;   // 可以保证绝对不会出错
     // dstStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;   // 目前验证层VK_VALIDATION_FEATURE_ENABLE_SYNCHRONIZATION_VALIDATION_EXT还是会有一些报错，太难调了
@@ -895,20 +1061,20 @@ void TextureBarrier(VkCommandBuffer commandBuffer, const RHITextureBarrier& barr
     memoryBarrier.srcAccessMask = srcAccessMask;
     memoryBarrier.dstAccessMask = dstAccessMask;
 
-    vkCmdPipelineBarrier(
-        commandBuffer,
-        srcStage, dstStage, 0,
-        0, nullptr,
-        0, nullptr,
-        1, &memoryBarrier);
+    return memoryBarrier;
 }
 
-void BufferBarrier(VkCommandBuffer commandBuffer, const RHIBufferBarrier& barrier)
+VkBufferMemoryBarrier BufferMemoryBarrier(const RHIBufferBarrier& barrier, VkPipelineStageFlags& srcStage, VkPipelineStageFlags& dstStage)
 {
     VkAccessFlags srcAccessMask = VulkanUtil::ResourceStateToAccessFlags(barrier.srcState);
     VkAccessFlags dstAccessMask = VulkanUtil::ResourceStateToAccessFlags(barrier.dstState);
-    VkPipelineStageFlags srcStage = VulkanUtil::AccessFlagsToPipelineStageFlags(srcAccessMask);
-    VkPipelineStageFlags dstStage = VulkanUtil::AccessFlagsToPipelineStageFlags(dstAccessMask);
+    srcStage |= VulkanUtil::AccessFlagsToPipelineStageFlags(srcAccessMask);
+    dstStage |= VulkanUtil::AccessFlagsToPipelineStageFlags(dstAccessMask);
+    if(barrier.aliasing)    // 不知道之前占用这段内存的资源的状态，等待全部的写入
+    {
+        srcStage |= VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+        srcAccessMask |= VK_ACCESS_MEMORY_WRITE_BIT;
+    }
 
     VkBufferMemoryBarrier memoryBarrier = {};
     memoryBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
@@ -920,6 +1086,29 @@ void BufferBarrier(VkCommandBuffer commandBuffer, const RHIBufferBarrier& barrie
     memoryBarrier.offset = barrier.offset;               // TODO
     memoryBarrier.size = barrier.size == 0 ? VK_WHOLE_SIZE : barrier.size;
 
+    return memoryBarrier;
+}
+
+void TextureBarrier(VkCommandBuffer commandBuffer, const RHITextureBarrier& barrier)
+{
+    VkPipelineStageFlags srcStage = 0;
+    VkPipelineStageFlags dstStage = 0;
+    VkImageMemoryBarrier memoryBarrier = ImageMemoryBarrier(barrier, srcStage, dstStage);
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        srcStage, dstStage, 0,
+        0, nullptr,
+        0, nullptr,
+        1, &memoryBarrier);
+}
+
+void BufferBarrier(VkCommandBuffer commandBuffer, const RHIBufferBarrier& barrier)
+{
+    VkPipelineStageFlags srcStage = 0;
+    VkPipelineStageFlags dstStage = 0;
+    VkBufferMemoryBarrier memoryBarrier = BufferMemoryBarrier(barrier, srcStage, dstStage);
+
     vkCmdPipelineBarrier(
         commandBuffer,
         srcStage, dstStage, 0,
@@ -928,6 +1117,43 @@ void BufferBarrier(VkCommandBuffer commandBuffer, const RHIBufferBarrier& barrie
         0, nullptr);
 }
 
+void TextureBarriers(VkCommandBuffer commandBuffer, const std::vector<RHITextureBarrier>& barriers)
+{
+    if (barriers.empty()) return;
+
+    // 一次vkCmdPipelineBarrier提交整批屏障，stage取所有屏障的并集
+    VkPipelineStageFlags srcStage = 0;
+    VkPipelineStageFlags dstStage = 0;
+    std::vector<VkImageMemoryBarrier> memoryBarriers;
+    memoryBarriers.reserve(barriers.size());
+    for (const auto& barrier : barriers) memoryBarriers.push_back(ImageMemoryBarrier(barrier, srcStage, dstStage));
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        srcStage, dstStage, 0,
+        0, nullptr,
+        0, nullptr,
+        memoryBarriers.size(), memoryBarriers.data());
+}
+
+void BufferBarriers(VkCommandBuffer commandBuffer, const std::vector<RHIBufferBarrier>& barriers)
+{
+    if (barriers.empty()) return;
+
+    VkPipelineStageFlags srcStage = 0;
+    VkPipelineStageFlags dstStage = 0;
+    std::vector<VkBufferMemoryBarrier> memoryBarriers;
+    memoryBarriers.reserve(barriers.size());
+    for (const auto& barrier : barriers) memoryBarriers.push_back(BufferMemoryBarrier(barrier, srcStage, dstStage));
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        srcStage, dstStage, 0,
+        0, nullptr,
+        memoryBarriers.size(), memoryBarriers.data(),
+        0, nullptr);
+}
+
 void CopyTextureToBuffer(VkCommandBuffer commandBuffer, RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset)
 {
     VkBufferImageCopy copy = {};
@@ -1125,14 +1351,22 @@ void VulkanRHICommandContext::EndCommand()
 }
 
 void VulkanRHICommandContext::Execute(RHIFenceRef fence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore)
+{
+    Execute({}, fence, waitSemaphore, signalSemaphore);
+}
+
+void VulkanRHICommandContext::Execute(const std::vector<RHICommandContextRef>& following, RHIFenceRef fence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore)
 {
     VkPipelineStageFlags stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;   
     VkFence signalFence = VK_NULL_HANDLE;
 
+    std::vector<VkCommandBuffer> commandBuffers = { handle };     // 同一次提交内按数组顺序执行，屏障的同步范围覆盖提交顺序在前的全部指令
+    for(auto& context : following) commandBuffers.push_back(std::static_pointer_cast<VulkanRHICommandContext>(context)->GetHandle());
+
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &handle;
+    submitInfo.commandBufferCount = (uint32_t)commandBuffers.size();
+    submitInfo.pCommandBuffers = commandBuffers.data();
 
     if (fence != nullptr)
     {
@@ -1166,6 +1400,16 @@ void VulkanRHICommandContext::BufferBarrier(const RHIBufferBarrier& barrier)
     ::BufferBarrier(handle, barrier);
 }
 
+void VulkanRHICommandContext::TextureBarriers(const std::vector<RHITextureBarrier>& barriers)
+{
+    ::TextureBarriers(handle, barriers);
+}
+
+void VulkanRHICommandContext::BufferBarriers(const std::vector<RHIBufferBarrier>& barriers)
+{
+    ::BufferBarriers(handle, barriers);
+}
+
 void VulkanRHICommandContext::CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset)
 {
     ::CopyTextureToBuffer(handle, src, srcSubresource, dst, dstOffset);
@@ -1486,6 +1730,16 @@ void VulkanRHICommandContextImmediate::BufferBarrier(const RHIBufferBarrier& bar
     ::BufferBarrier(handle, barrier);
 }
 
+void VulkanRHICommandContextImmediate::TextureBarriers(const std::vector<RHITextureBarrier>& barriers)
+{
+    ::TextureBarriers(handle, barriers);
+}
+
+void VulkanRHICommandContextImmediate::BufferBarriers(const std::vector<RHIBufferBarrier>& barriers)
+{
+    ::BufferBarriers(handle, barriers);
+}
+
 void VulkanRHICommandContextImmediate::CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset)
 {
     ::CopyTextureToBuffer(handle, src, srcSubresource, dst, dstOffset);
@@ -52,6 +52,16 @@ public:
 
     virtual RHITextureRef CreateTexture(const RHITextureInfo& info) override final;
 
+    virtual RHIHeapRef CreateHeap(const RHIHeapInfo& info) override final;
+
+    virtual RHIMemoryRequirements GetMemoryRequirements(const RHIBufferInfo& info) override final;
+
+    virtual RHIMemoryRequirements GetMemoryRequirements(const RHITextureInfo& info) override final;
+
+    virtual RHIBufferRef CreatePlacedBuffer(const RHIBufferInfo& info, RHIHeapRef heap, uint64_t offset) override final;
+
+    virtual RHITextureRef CreatePlacedTexture(const RHITextureInfo& info, RHIHeapRef heap, uint64_t offset) override final;
+
     virtual RHITextureViewRef CreateTextureView(const RHITextureViewInfo& info) override final;
 
     virtual RHISamplerRef CreateSampler(const RHISamplerInfo& info) override final;
@@ -97,6 +107,7 @@ public:
     inline VkDevice GetLogicalDevice() const            { return logicalDevice; }
     inline VmaAllocator GetMemoryAllocator() const      { return memoryAllocator; }
     inline VkDescriptorPool GetDescriptorPool() const   { return descriptorPool; }
+    inline VkPipelineCache GetPipelineCache() const     { return pipelineCache; }
 
     VkRenderPass FindOrCreateVkRenderPass(const VulkanRenderPassAttachments& info) { return renderPassPool.Allocate(info).pass; }
     VkRenderPass CreateVkRenderPass(const VulkanRenderPassAttachments& info);
@@ -104,6 +115,10 @@ public:
     VkFramebuffer FindOrCreateVkFramebuffer(const VkFramebufferCreateInfo& info) { return frameBufferPool.Allocate(info).frameBuffer; }
     VkFramebuffer CreateVkFramebuffer(const VkFramebufferCreateInfo& info);
 
+    VkDescriptorUpdateTemplate FindOrCreateVkDescriptorUpdateTemplate(VkDescriptorSetLayout layout, const std::vector<VkDescriptorUpdateTemplateEntry>& entries) { return descriptorUpdateTemplatePool.Allocate(layout, entries); }
+    VkDescriptorUpdateTemplate CreateVkDescriptorUpdateTemplate(VkDescriptorSetLayout layout, const std::vector<VkDescriptorUpdateTemplateEntry>& entries);
+    void ReleaseVkDescriptorUpdateTemplates(VkDescriptorSetLayout layout) { descriptorUpdateTemplatePool.Release(layout); }
+
     VkPhysicalDeviceRayTracingPipelinePropertiesKHR GetRayTracingPipelineProperties() { return rayTracingPipelineProperties; }
 
 private:
@@ -136,10 +151,16 @@ private:
     // 描述符池
     VkDescriptorPool descriptorPool;
 
+    // 驱动的管线缓存，启动时从磁盘读取，销毁时写回，全部管线创建共用
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+
     // 池化的renderPass和frameBuffer
     VkRenderPassCache renderPassPool;
     VkFramebufferCache frameBufferPool;
 
+    // 描述符更新模板
+    VkDescriptorUpdateTemplateCache descriptorUpdateTemplatePool;
+
     // 立即模式命令队列
     RHICommandContextImmediateRef immediateCommandContext;
     RHICommandListImmediateRef immediateCommand;
@@ -156,7 +177,9 @@ private:
     void CreateQueues();
     void CreateMemoryAllocator();
     void CreateDescriptorPool(); 
+    void CreatePipelineCache();
     void CreateImmediateCommand(); 
+    void SavePipelineCache();
 
     friend class VulkanRHIRootSignature;    // 调用RegisterResource
 };
@@ -175,10 +198,16 @@ public:
 
     virtual void Execute(RHIFenceRef fence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore) override final;   
 
+    virtual void Execute(const std::vector<RHICommandContextRef>& following, RHIFenceRef fence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore) override final;
+
     virtual void TextureBarrier(const RHITextureBarrier& barrier) override final;
 
     virtual void BufferBarrier(const RHIBufferBarrier& barrier) override final;
 
+    virtual void TextureBarriers(const std::vector<RHITextureBarrier>& barriers) override final;
+
+    virtual void BufferBarriers(const std::vector<RHIBufferBarrier>& barriers) override final;
+
     virtual void CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset) override final;
 
     virtual void CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource) override final;
@@ -269,6 +298,10 @@ public:
 
     virtual void BufferBarrier(const RHIBufferBarrier& barrier) override final;
 
+    virtual void TextureBarriers(const std::vector<RHITextureBarrier>& barriers) override final;
+
+    virtual void BufferBarriers(const std::vector<RHIBufferBarrier>& barriers) override final;
+
     virtual void CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset) override final;
 
     virtual void CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource) override final;
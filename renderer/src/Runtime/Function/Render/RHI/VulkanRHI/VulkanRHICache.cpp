@@ -1,9 +1,17 @@
 #include "VulkanRHICache.h"
 #include "Function/Render/RHI/VulkanRHI/VulkanRHI.h"
 #include "Function/Render/RHI/VulkanRHI/VulkanUtil.h"
+#include "Platform/HAL/PlatformProcess.h"
+#include "Platform/HAL/ScopeLock.h"
+
+VkRenderPassCache::VkRenderPassCache()
+: sync(PlatformProcess::CreateMutex())
+{}
 
 VkRenderPassCache::CachedRenderPass VkRenderPassCache::Allocate(const VulkanRenderPassAttachments& info)
 {
+    ScopeLock lock(sync);
+
     VkRenderPassCache::CachedRenderPass ret;
 
     auto iter = cachedPasses.find(info);
@@ -24,6 +32,8 @@ VkRenderPassCache::CachedRenderPass VkRenderPassCache::Allocate(const VulkanRend
 
 void VkRenderPassCache::Clear()
 {
+    ScopeLock lock(sync);
+
     for(auto iter : cachedPasses)
     {
         vkDestroyRenderPass(Backend()->GetLogicalDevice(), iter.second.pass, nullptr);
@@ -31,8 +41,14 @@ void VkRenderPassCache::Clear()
     cachedPasses.clear();
 }
 
+VkFramebufferCache::VkFramebufferCache()
+: sync(PlatformProcess::CreateMutex())
+{}
+
 VkFramebufferCache::CachedFramebuffer VkFramebufferCache::Allocate(const VkFramebufferCreateInfo& info)
 {
+    ScopeLock lock(sync);
+
     VkFramebufferCache::CachedFramebuffer ret;
 
     auto iter = cachedFramebuffers.find(info);
@@ -53,9 +69,53 @@ VkFramebufferCache::CachedFramebuffer VkFramebufferCache::Allocate(const VkFrame
 
 void VkFramebufferCache::Clear()
 {
+    ScopeLock lock(sync);
+
     for(auto iter : cachedFramebuffers)
     {
         vkDestroyFramebuffer(Backend()->GetLogicalDevice(), iter.second.frameBuffer, nullptr);
     }
     cachedFramebuffers.clear();
-}
\ No newline at end of file
+}
+
+VkDescriptorUpdateTemplateCache::VkDescriptorUpdateTemplateCache()
+: sync(PlatformProcess::CreateMutex())
+{}
+
+VkDescriptorUpdateTemplate VkDescriptorUpdateTemplateCache::Allocate(VkDescriptorSetLayout layout, const std::vector<VkDescriptorUpdateTemplateEntry>& entries)
+{
+    ScopeLock lock(sync);
+
+    CachedTemplate& cached = cachedTemplates[{layout, entries}];
+    cached.useCount++;
+    if(cached.updateTemplate == VK_NULL_HANDLE && cached.useCount >= 2)
+    {
+        LOG_DEBUG("VkDescriptorUpdateTemplate not found in cache, creating new.");
+        cached.updateTemplate = Backend()->CreateVkDescriptorUpdateTemplate(layout, entries);
+    }
+    return cached.updateTemplate;
+}
+
+void VkDescriptorUpdateTemplateCache::Release(VkDescriptorSetLayout layout)
+{
+    ScopeLock lock(sync);
+
+    for(auto iter = cachedTemplates.begin(); iter != cachedTemplates.end();)
+    {
+        if(iter->first.layout != layout) { iter++; continue; }
+
+        if(iter->second.updateTemplate != VK_NULL_HANDLE) vkDestroyDescriptorUpdateTemplate(Backend()->GetLogicalDevice(), iter->second.updateTemplate, nullptr);
+        iter = cachedTemplates.erase(iter);
+    }
+}
+
+void VkDescriptorUpdateTemplateCache::Clear()
+{
+    ScopeLock lock(sync);
+
+    for(auto iter : cachedTemplates)
+    {
+        if(iter.second.updateTemplate != VK_NULL_HANDLE) vkDestroyDescriptorUpdateTemplate(Backend()->GetLogicalDevice(), iter.second.updateTemplate, nullptr);
+    }
+    cachedTemplates.clear();
+}
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Function/Render/RHI/VulkanRHI/VulkanUtil.h"
+#include "Platform/HAL/Mutex.h"
+#include "MurmurHash2.h"
 
 #include <cstdint>
 #include <functional>
@@ -74,6 +76,7 @@ public:
         };
     };
 
+    VkRenderPassCache();
     ~VkRenderPassCache() { Clear(); }
 
     CachedRenderPass Allocate(const VulkanRenderPassAttachments& info);
@@ -83,6 +86,7 @@ public:
 
 private:
     std::unordered_map<Key, CachedRenderPass, Key::Hash> cachedPasses;    
+    MutexRef sync;                  // 资源线程异步编译管线时也会查找
 };
 
 class VkFramebufferCache
@@ -154,6 +158,7 @@ public:
         };
     };
 
+    VkFramebufferCache();
     ~VkFramebufferCache() { Clear(); }
 
     CachedFramebuffer Allocate(const VkFramebufferCreateInfo& info);
@@ -164,5 +169,56 @@ public:
 
 private:
     std::unordered_map<Key, CachedFramebuffer, Key::Hash> cachedFramebuffers;    
+    MutexRef sync;
 
-};
\ No newline at end of file
+};
+
+class VkDescriptorUpdateTemplateCache   // 按描述符布局和写入形式（每项的binding，index，类型）缓存更新模板
+{
+public:
+    struct CachedTemplate
+    {
+        VkDescriptorUpdateTemplate updateTemplate = VK_NULL_HANDLE;
+        uint32_t useCount = 0;
+    };
+
+    struct Key
+    {
+        Key(VkDescriptorSetLayout layout, const std::vector<VkDescriptorUpdateTemplateEntry>& entries) 
+        : layout(layout)
+        {
+            for(auto& entry : entries) shape.insert(shape.end(), { entry.dstBinding, entry.dstArrayElement, (uint32_t)entry.descriptorType });
+        }
+
+        VkDescriptorSetLayout layout;
+        std::vector<uint32_t> shape;
+
+        friend bool operator== (const Key& a, const Key& b)
+        {
+            return  a.layout == b.layout &&
+                    a.shape == b.shape;
+        }
+
+        struct Hash {
+            size_t operator()(const Key& a) const {
+                return  MurmurHash64A(a.shape.data(), a.shape.size() * sizeof(uint32_t), 0) ^
+                        (std::hash<uint64_t>()((uint64_t)a.layout) << 1);
+            }
+        };
+    };
+
+    VkDescriptorUpdateTemplateCache();
+    ~VkDescriptorUpdateTemplateCache() { Clear(); }
+
+    // 同一形式第二次出现时才创建模板，只出现一次的写入不值得创建；返回VK_NULL_HANDLE时由调用者直接写入
+    // 模板要求数据按entries里的offset和stride排布
+    VkDescriptorUpdateTemplate Allocate(VkDescriptorSetLayout layout, const std::vector<VkDescriptorUpdateTemplateEntry>& entries);
+    void Release(VkDescriptorSetLayout layout);     // 布局销毁前调用，句柄可能被复用
+
+    inline uint32_t CachedSize()    { return cachedTemplates.size(); }
+    void Clear();
+
+private:
+    std::unordered_map<Key, CachedTemplate, Key::Hash> cachedTemplates;
+    MutexRef sync;                  // 描述符可能在多个线程更新
+};
@@ -3,6 +3,8 @@
 #include "VulkanRHI.h"
 #include "Function/Render/RHI/RHIResource.h"
 #include "Function/Render/RHI/RHIStructs.h"
+#include "Function/Render/RHI/ShaderReflect.h"
+#include "Function/Render/RHI/ShaderReflectCache.h"
 #include "Core/Log/Log.h"
 #include "imgui_impl_vulkan.h"
 #include "vma.h"
@@ -299,8 +301,30 @@ void VulkanRHICommandPool::Destroy()
 
 //缓冲，纹理，着色器，加速结构 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-VulkanRHIBuffer::VulkanRHIBuffer(const RHIBufferInfo& info, VulkanRHIBackend& backend)
-: RHIBuffer(info)
+VulkanRHIHeap::VulkanRHIHeap(const RHIHeapInfo& info, VulkanRHIBackend& backend)
+: RHIHeap(info)
+{
+    VkMemoryRequirements requirements = {};
+    requirements.size = info.size;
+    requirements.alignment = info.alignment;
+    requirements.memoryTypeBits = info.memoryTypeBits;
+
+    VmaAllocationCreateInfo allocationCreateInfo = {};
+    allocationCreateInfo.usage = VulkanUtil::MemoryUsageToVma(info.memoryUsage);
+
+    allocationInfo = {};
+    if(vmaAllocateMemory(backend.GetMemoryAllocator(), &requirements, &allocationCreateInfo, &allocation, &allocationInfo) != VK_SUCCESS)
+    {
+        LOG_FATAL("VMA failed to allocate heap!");
+    }
+}
+
+void VulkanRHIHeap::Destroy()
+{
+    vmaFreeMemory(Backend()->GetMemoryAllocator(), allocation);
+}
+
+VkBufferCreateInfo VulkanRHIBuffer::CreateInfo(const RHIBufferInfo& info)
 {
     VkBufferUsageFlags usage = VulkanUtil::ResourceTypeToBufferUsage(info.type);
     if (info.memoryUsage == MEMORY_USAGE_GPU_ONLY || info.memoryUsage == MEMORY_USAGE_GPU_TO_CPU)   usage |= VK_BUFFER_USAGE_TRANSFER_DST_BIT;
@@ -313,6 +337,14 @@ VulkanRHIBuffer::VulkanRHIBuffer(const RHIBufferInfo& info, VulkanRHIBackend& ba
     bufferInfo.queueFamilyIndexCount = 0,
     bufferInfo.pQueueFamilyIndices = NULL;
 
+    return bufferInfo;
+}
+
+VulkanRHIBuffer::VulkanRHIBuffer(const RHIBufferInfo& info, VulkanRHIBackend& backend)
+: RHIBuffer(info)
+{
+    VkBufferCreateInfo bufferInfo = CreateInfo(info);
+
     VmaAllocationCreateInfo allocationCreateInfo = {};
     allocationCreateInfo.usage = VulkanUtil::MemoryUsageToVma(info.memoryUsage);
     if(info.creationFlag & BUFFER_CREATION_PERSISTENT_MAP) 
@@ -358,12 +390,28 @@ VulkanRHIBuffer::VulkanRHIBuffer(const RHIBufferInfo& info, VulkanRHIBackend& ba
     //vmaMapMemory(VmaAllocator  _Nonnull allocator, VmaAllocation  _Nonnull allocation, void * _Nullable * _Nonnull ppData)
 }
 
+VulkanRHIBuffer::VulkanRHIBuffer(const RHIBufferInfo& info, VulkanRHIBackend& backend, RHIHeapRef heap, uint64_t offset)
+: RHIBuffer(info)
+, heap(heap)
+, heapOffset(offset)
+{
+    VkBufferCreateInfo bufferInfo = CreateInfo(info);
+
+    allocation = ResourceCast(heap)->GetAllocation();   // 只用于映射，销毁时不释放
+    allocationInfo = {};
+    if(vmaCreateAliasingBuffer2(backend.GetMemoryAllocator(), allocation, offset, &bufferInfo, &handle) != VK_SUCCESS)
+    {
+        LOG_FATAL("VMA failed to create placed buffer!");
+    }
+}
+
 void* VulkanRHIBuffer::Map()
 {
-    if(info.creationFlag & BUFFER_CREATION_PERSISTENT_MAP) return allocationInfo.pMappedData;
+    if(info.creationFlag & BUFFER_CREATION_PERSISTENT_MAP && !heap) return allocationInfo.pMappedData;
     if(!mapped) 
     {
         vmaMapMemory(Backend()->GetMemoryAllocator(), allocation, &pointer);
+        pointer = (uint8_t*)pointer + heapOffset;
         mapped = true;
     }
     return pointer;
@@ -371,7 +419,7 @@ void* VulkanRHIBuffer::Map()
 
 void VulkanRHIBuffer::UnMap()
 {
-    if(mapped && !(info.creationFlag & BUFFER_CREATION_PERSISTENT_MAP))
+    if(mapped && (!(info.creationFlag & BUFFER_CREATION_PERSISTENT_MAP) || heap))
     {
         vmaUnmapMemory(Backend()->GetMemoryAllocator(), allocation);
         pointer = nullptr;
@@ -388,30 +436,17 @@ void VulkanRHIBuffer::UnMap()
 
 void VulkanRHIBuffer::Destroy()
 {
-    if(mapped && !(info.creationFlag & BUFFER_CREATION_PERSISTENT_MAP))
+    UnMap();
+    if(heap)
     {
-        vmaUnmapMemory(Backend()->GetMemoryAllocator(), allocation);
-        pointer = nullptr;
-        mapped = false;
+        vkDestroyBuffer(Backend()->GetLogicalDevice(), handle, nullptr);
+        heap = nullptr;
     }
-    vmaDestroyBuffer(Backend()->GetMemoryAllocator(), handle, allocation);
+    else vmaDestroyBuffer(Backend()->GetMemoryAllocator(), handle, allocation);
 }
 
-VulkanRHITexture::VulkanRHITexture(const RHITextureInfo& info, VulkanRHIBackend& backend, VkImage image)
-: RHITexture(info)
+VkImageCreateInfo VulkanRHITexture::CreateInfo(const RHITextureInfo& info)
 {
-    TextureAspectFlags aspects =    IsDepthStencilFormat(info.format) ? TEXTURE_ASPECT_DEPTH_STENCIL :
-                                    IsDepthFormat(info.format) ? TEXTURE_ASPECT_DEPTH :
-                                    IsStencilFormat(info.format) ? TEXTURE_ASPECT_STENCIL : TEXTURE_ASPECT_COLOR;
-    defaultRange = {aspects, 0, info.mipLevels, 0, info.arrayLayers};
-    defaultLayers = {aspects, 0, 0, info.arrayLayers};
-
-    if(image != VK_NULL_HANDLE)     // 留给swapchain的初始化方式
-    {
-        handle = image; 
-        return;
-    }
-
     VkFormat format = VulkanUtil::RHIFormatToVkFormat(info.format);
 
     VkImageUsageFlags usage = VulkanUtil::ResourceTypeToImageUsage(info.type);
@@ -447,6 +482,31 @@ VulkanRHITexture::VulkanRHITexture(const RHITextureInfo& info, VulkanRHIBackend&
     imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
     imageInfo.flags = flag; // Optional
 
+    return imageInfo;
+}
+
+void VulkanRHITexture::InitDefaultRange()
+{
+    TextureAspectFlags aspects =    IsDepthStencilFormat(info.format) ? TEXTURE_ASPECT_DEPTH_STENCIL :
+                                    IsDepthFormat(info.format) ? TEXTURE_ASPECT_DEPTH :
+                                    IsStencilFormat(info.format) ? TEXTURE_ASPECT_STENCIL : TEXTURE_ASPECT_COLOR;
+    defaultRange = {aspects, 0, info.mipLevels, 0, info.arrayLayers};
+    defaultLayers = {aspects, 0, 0, info.arrayLayers};
+}
+
+VulkanRHITexture::VulkanRHITexture(const RHITextureInfo& info, VulkanRHIBackend& backend, VkImage image)
+: RHITexture(info)
+{
+    InitDefaultRange();
+
+    if(image != VK_NULL_HANDLE)     // 留给swapchain的初始化方式
+    {
+        handle = image; 
+        return;
+    }
+
+    VkImageCreateInfo imageInfo = CreateInfo(info);
+
     VmaAllocationCreateInfo allocationCreateInfo = {};
     allocationCreateInfo.usage = VulkanUtil::MemoryUsageToVma(info.memoryUsage);
 
@@ -457,9 +517,30 @@ VulkanRHITexture::VulkanRHITexture(const RHITextureInfo& info, VulkanRHIBackend&
     }
 }
 
+VulkanRHITexture::VulkanRHITexture(const RHITextureInfo& info, VulkanRHIBackend& backend, RHIHeapRef heap, uint64_t offset)
+: RHITexture(info)
+, heap(heap)
+{
+    InitDefaultRange();
+
+    VkImageCreateInfo imageInfo = CreateInfo(info);
+
+    allocation = VK_NULL_HANDLE;
+    allocationInfo = {};
+    if(vmaCreateAliasingImage2(backend.GetMemoryAllocator(), ResourceCast(heap)->GetAllocation(), offset, &imageInfo, &handle) != VK_SUCCESS)
+    {
+        LOG_FATAL("VMA failed to create placed image!");
+    }
+}
+
 void VulkanRHITexture::Destroy()
 {
-    vmaDestroyImage(Backend()->GetMemoryAllocator(), handle, allocation);
+    if(heap)
+    {
+        vkDestroyImage(Backend()->GetLogicalDevice(), handle, nullptr);
+        heap = nullptr;
+    }
+    else vmaDestroyImage(Backend()->GetMemoryAllocator(), handle, allocation);
     //vkDestroyImage(Backend()->GetLogicalDevice(), handle, nullptr);
 }
 
@@ -561,14 +642,6 @@ void VulkanRHISampler::Destroy()
 VulkanRHIShader::VulkanRHIShader(const RHIShaderInfo& info, VulkanRHIBackend& backend)
 : RHIShader(info)
 {
-    // 从spv文件的字符串信息里收集定义的宏
-    std::regex pattern("#define (\\w+)");
-    for (std::cregex_iterator it((char*)info.code.data(), (char*)info.code.data() + info.code.size(), pattern); 
-            it != std::cregex_iterator{}; it++) 
-    {
-        reflectInfo.definedSymbols.insert((*it)[1].str());
-    }
-
     // 创建ShaderModule
     VkShaderModuleCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -581,130 +654,11 @@ VulkanRHIShader::VulkanRHIShader(const RHIShaderInfo& info, VulkanRHIBackend& ba
     }
     this->info.code.clear();    // 代码不需要带着了
 
-    // 收集反射信息
-    SpvReflectShaderModule module;
-    SpvReflectResult result = spvReflectCreateShaderModule(info.code.size(), info.code.data(), &module);
-    if(result != SPV_REFLECT_RESULT_SUCCESS)    LOG_DEBUG("Failed to generate shader reflect data!");
-    if(module.entry_point_count != 1)           LOG_DEBUG("Shader file contains more than one entry!");   //暂时只做单entry吧       
-
-    const SpvReflectEntryPoint* entry = spvReflectGetEntryPoint(&module, module.entry_points[0].name);
-
-    reflectInfo.name = std::string(entry->name);
-    reflectInfo.frequency = VulkanUtil::SpvShaderStageToFrequency(entry->shader_stage);
-    if (reflectInfo.frequency == SHADER_FREQUENCY_COMPUTE)
-    {
-        reflectInfo.localSizeX = entry->local_size.x;
-        reflectInfo.localSizeY = entry->local_size.y;
-        reflectInfo.localSizeZ = entry->local_size.z;
-    }
-
-    // bool isGLSL = module.source_language & SpvSourceLanguageGLSL;
-    // bool isHLSL = module.source_language & SpvSourceLanguageHLSL;
-
-    // pushConstant
-    // uint32_t pushConstantCnt;
-    // spvReflectEnumeratePushConstantBlocks(&module, &pushConstantCnt, NULL);
-    // if (pushConstantCnt > 0) 
-    // {
-    //     std::vector<SpvReflectBlockVariable*> blockVariables(pushConstantCnt + 1);
-    //     spvReflectEnumeratePushConstantBlocks(&module, &pushConstantCnt, blockVariables.data());
-    // }
-
-    // 着色器输入和输出
-    uint32_t inputVariableCnt;
-    spvReflectEnumerateInputVariables(&module, &inputVariableCnt, NULL);
-    if (inputVariableCnt > 0)
-    {
-        std::vector<SpvReflectInterfaceVariable*> inputVariables(inputVariableCnt);   
-        spvReflectEnumerateInputVariables(&module, &inputVariableCnt, inputVariables.data()); 
-
-        for(uint32_t i = 0; i < inputVariableCnt; i++)
-        {
-            if(inputVariables[i]->location < MAX_SHADER_IN_OUT_VARIABLES)
-                reflectInfo.inputVariables[inputVariables[i]->location] = VulkanUtil::SpvFormatToRHIFormat(inputVariables[i]->format);
-        }
-    }
-
-    uint32_t outputVariableCnt;
-    spvReflectEnumerateOutputVariables(&module, &outputVariableCnt, NULL);
-    if(outputVariableCnt > 0)
-    {
-        std::vector<SpvReflectInterfaceVariable*> outputVariables(outputVariableCnt);
-        spvReflectEnumerateOutputVariables(&module, &outputVariableCnt, outputVariables.data());
-
-        for(uint32_t i = 0; i < outputVariableCnt; i++)
-        {
-            if(outputVariables[i]->location < MAX_SHADER_IN_OUT_VARIABLES)
-                reflectInfo.outputVariables[outputVariables[i]->location] = VulkanUtil::SpvFormatToRHIFormat(outputVariables[i]->format);
-        }
-    }
-
-    // specialization constant
-    // uint32_t specializationConstantCnt;
-    // spvReflectEnumerateSpecializationConstants(&module, &specializationConstantCnt, NULL);
-    // if(specializationConstantCnt > 0)
-    // {
-    //     std::vector<SpvReflectSpecializationConstant*> specializationConstants(specializationConstantCnt);
-    //     spvReflectEnumerateSpecializationConstants(&module, &specializationConstantCnt, specializationConstants.data());
-
-    //     for(uint32_t i = 0; i < specializationConstantCnt; i++)
-    //     {
-    //         specializationConstants[i];
-    //     }       
-    // }
-
-    // interface variable
-    // uint32_t interfaceVariableCnt;
-    // spvReflectEnumerateInterfaceVariables(&module, &interfaceVariableCnt, NULL);
-    // if(interfaceVariableCnt > 0)
-    // {
-    //     std::vector<SpvReflectInterfaceVariable*> interfaceVariables(interfaceVariableCnt);
-    //     spvReflectEnumerateInterfaceVariables(&module, &interfaceVariableCnt, interfaceVariables.data());
-
-    //     for(uint32_t i = 0; i < interfaceVariableCnt; i++)
-    //     {
-    //         interfaceVariables[i];
-    //     }       
-    // }
-
-
-    // 描述符
-    uint32_t descriptorSetCnt;
-    spvReflectEnumerateDescriptorSets(&module, &descriptorSetCnt, NULL);
-    if (descriptorSetCnt > 0)
+    // 收集反射信息，代码没有变化时直接读取文件旁边的缓存
+    if(info.path.empty() || !ShaderReflectCache::Load(info.path, info.code, reflectInfo))
     {
-        std::vector<SpvReflectDescriptorSet*> descriptorSets(descriptorSetCnt);
-        spvReflectEnumerateDescriptorSets(&module, &descriptorSetCnt, descriptorSets.data());
-        
-        uint32_t descriptorSize = 0;
-        for (uint32_t i = 0; i < descriptorSetCnt; i++)   descriptorSize += descriptorSets[i]->binding_count;
-        reflectInfo.resources.resize(descriptorSize);
-
-        uint32_t i = 0;
-        for (uint32_t set = 0; set < descriptorSetCnt; set++)
-        {
-            SpvReflectDescriptorSet* currentSet = descriptorSets[set];
-
-            for (uint32_t binding = 0; binding < currentSet->binding_count; binding++, i++)
-            {
-                SpvReflectDescriptorBinding* currentBinding = currentSet->bindings[binding];
-
-                ShaderResourceEntry& entry = reflectInfo.resources[i];
-                //entry.name = std::string(currentBinding->name);
-                entry.set = currentBinding->set;
-                entry.binding = currentBinding->binding; 
-                entry.size = currentBinding->count;
-                entry.type = VulkanUtil::SpvDescriptorTypeToResourceType(currentBinding->descriptor_type);
-                entry.frequency = reflectInfo.frequency;
-
-                if ((currentBinding->type_description->type_flags & SPV_REFLECT_TYPE_FLAG_EXTERNAL_IMAGE) ||
-                    (currentBinding->type_description->type_flags & SPV_REFLECT_TYPE_FLAG_EXTERNAL_SAMPLED_IMAGE))
-                {
-                    bool isArray = (currentBinding->type_description->type_flags & SPV_REFLECT_TYPE_FLAG_ARRAY);
-                    // entry.textureViewType = VulkanUtil::SpvDimToTextureViewType(currentBinding->image.dim, isArray); // 暂时不需要这个信息
-                }
-            }
-        }
+        ShaderReflect::Reflect(info.code, reflectInfo);
+        if(!info.path.empty()) ShaderReflectCache::Save(info.path, info.code, reflectInfo);
     }
 }
 
@@ -1164,12 +1118,14 @@ void VulkanRHIRootSignature::Destroy()
 {
     for(SetInfo& set : setInfos)
     {
+        Backend()->ReleaseVkDescriptorUpdateTemplates(set.layout);
         vkDestroyDescriptorSetLayout(Backend()->GetLogicalDevice(), set.layout, nullptr);
     } 
 }
 
 VulkanRHIDescriptorSet::VulkanRHIDescriptorSet(VkDescriptorSetLayout setLayout, VulkanRHIBackend& backend)
 : RHIDescriptorSet()
+, layout(setLayout)
 {
     //描述符集合信息
     VkDescriptorSetLayout layouts[] = { setLayout };
@@ -1186,67 +1142,139 @@ VulkanRHIDescriptorSet::VulkanRHIDescriptorSet(VkDescriptorSetLayout setLayout,
     }
 }
 
-RHIDescriptorSet& VulkanRHIDescriptorSet::UpdateDescriptor(const RHIDescriptorUpdateInfo& descriptorUpdateInfo)
+typedef union VulkanDescriptorData     // 更新模板按固定的步长读取，每个描述符占一项
 {
-    //更新写入信息
-    VkWriteDescriptorSet descriptorWrite = {};
-    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descriptorWrite.dstSet = handle;
-    descriptorWrite.dstBinding = descriptorUpdateInfo.binding;
-    descriptorWrite.dstArrayElement = descriptorUpdateInfo.index;
-    descriptorWrite.descriptorType = VulkanUtil::ResourceTypeToVk(descriptorUpdateInfo.resourceType);
-    descriptorWrite.descriptorCount = 1;
-    
-    VkDescriptorImageInfo imageDescriptor = {};
-    VkDescriptorBufferInfo bufferDescriptor = {};
-    VkWriteDescriptorSetAccelerationStructureKHR accelerationDescriptor = {};
+    VkDescriptorImageInfo image;
+    VkDescriptorBufferInfo buffer;
+    VkAccelerationStructureKHR accelerationStructure;
 
+} VulkanDescriptorData;
+
+static void FillDescriptorData(const RHIDescriptorUpdateInfo& descriptorUpdateInfo, VulkanDescriptorData& data)
+{
     switch (descriptorUpdateInfo.resourceType) {
 
     case RESOURCE_TYPE_SAMPLER:
-        imageDescriptor.sampler = ResourceCast(descriptorUpdateInfo.sampler)->GetHandle();
-        descriptorWrite.pImageInfo = &imageDescriptor;
+        data.image.sampler = ResourceCast(descriptorUpdateInfo.sampler)->GetHandle();
         break;
         
     case RESOURCE_TYPE_TEXTURE:
 	case RESOURCE_TYPE_RW_TEXTURE:
     case RESOURCE_TYPE_TEXTURE_CUBE:
-        imageDescriptor.imageView = ResourceCast(descriptorUpdateInfo.textureView)->GetHandle();
-        imageDescriptor.imageLayout = VulkanUtil::ResourceTypeToImageLayout(descriptorUpdateInfo.resourceType);
-        descriptorWrite.pImageInfo = &imageDescriptor;
+        data.image.imageView = ResourceCast(descriptorUpdateInfo.textureView)->GetHandle();
+        data.image.imageLayout = VulkanUtil::ResourceTypeToImageLayout(descriptorUpdateInfo.resourceType);
         break;
 
 	case RESOURCE_TYPE_COMBINED_IMAGE_SAMPLER:
-        imageDescriptor.sampler = ResourceCast(descriptorUpdateInfo.sampler)->GetHandle();
-        imageDescriptor.imageView = ResourceCast(descriptorUpdateInfo.textureView)->GetHandle();
-        imageDescriptor.imageLayout = VulkanUtil::ResourceTypeToImageLayout(descriptorUpdateInfo.resourceType);
-        descriptorWrite.pImageInfo = &imageDescriptor;
+        data.image.sampler = ResourceCast(descriptorUpdateInfo.sampler)->GetHandle();
+        data.image.imageView = ResourceCast(descriptorUpdateInfo.textureView)->GetHandle();
+        data.image.imageLayout = VulkanUtil::ResourceTypeToImageLayout(descriptorUpdateInfo.resourceType);
         break;
 
     case RESOURCE_TYPE_BUFFER:
     case RESOURCE_TYPE_RW_BUFFER:
     case RESOURCE_TYPE_UNIFORM_BUFFER:
-        bufferDescriptor.buffer = ResourceCast(descriptorUpdateInfo.buffer)->GetHandle();
-        bufferDescriptor.offset = descriptorUpdateInfo.bufferOffset;
-        bufferDescriptor.range = (descriptorUpdateInfo.bufferRange > 0) ? descriptorUpdateInfo.bufferRange : VK_WHOLE_SIZE;
-        descriptorWrite.pBufferInfo = &bufferDescriptor;
+        data.buffer.buffer = ResourceCast(descriptorUpdateInfo.buffer)->GetHandle();
+        data.buffer.offset = descriptorUpdateInfo.bufferOffset;
+        data.buffer.range = (descriptorUpdateInfo.bufferRange > 0) ? descriptorUpdateInfo.bufferRange : VK_WHOLE_SIZE;
         break;
 
 	case RESOURCE_TYPE_RAY_TRACING:
+        data.accelerationStructure = ResourceCast(descriptorUpdateInfo.tlas)->GetHandle();
+        break;
+
+    default:    LOG_FATAL("Unsupported resource type!");
+    }
+}
+
+static VkWriteDescriptorSet DescriptorWrite(   VkDescriptorSet set, 
+                                                const VkDescriptorUpdateTemplateEntry& entry,
+                                                const VulkanDescriptorData& data, 
+                                                VkWriteDescriptorSetAccelerationStructureKHR& accelerationDescriptor)
+{
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = set;
+    descriptorWrite.dstBinding = entry.dstBinding;
+    descriptorWrite.dstArrayElement = entry.dstArrayElement;
+    descriptorWrite.descriptorType = entry.descriptorType;
+    descriptorWrite.descriptorCount = 1;
+
+    switch (entry.descriptorType) {
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        descriptorWrite.pBufferInfo = &data.buffer;
+        break;
+
+    case VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:
+        accelerationDescriptor = {};
         accelerationDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR;
         accelerationDescriptor.accelerationStructureCount = 1;
-        accelerationDescriptor.pAccelerationStructures = &ResourceCast(descriptorUpdateInfo.tlas)->GetHandle();
+        accelerationDescriptor.pAccelerationStructures = &data.accelerationStructure;
         descriptorWrite.pNext = &accelerationDescriptor;
         break;
 
-    default:    LOG_FATAL("Unsupported resource type!");
+    default:
+        descriptorWrite.pImageInfo = &data.image;
+        break;
     }
+    return descriptorWrite;
+}
+
+static VkDescriptorUpdateTemplateEntry DescriptorEntry(const RHIDescriptorUpdateInfo& descriptorUpdateInfo, uint32_t index)
+{
+    VkDescriptorUpdateTemplateEntry entry = {};
+    entry.dstBinding = descriptorUpdateInfo.binding;
+    entry.dstArrayElement = descriptorUpdateInfo.index;
+    entry.descriptorCount = 1;
+    entry.descriptorType = VulkanUtil::ResourceTypeToVk(descriptorUpdateInfo.resourceType);
+    entry.offset = index * sizeof(VulkanDescriptorData);
+    entry.stride = sizeof(VulkanDescriptorData);
+    return entry;
+}
+
+RHIDescriptorSet& VulkanRHIDescriptorSet::UpdateDescriptor(const RHIDescriptorUpdateInfo& descriptorUpdateInfo)
+{
+    VulkanDescriptorData data = {};
+    FillDescriptorData(descriptorUpdateInfo, data);
 
+    VkWriteDescriptorSetAccelerationStructureKHR accelerationDescriptor = {};
+    VkWriteDescriptorSet descriptorWrite = DescriptorWrite(handle, DescriptorEntry(descriptorUpdateInfo, 0), data, accelerationDescriptor);
     vkUpdateDescriptorSets(Backend()->GetLogicalDevice(), 1, &descriptorWrite, 0, nullptr);
 
     return *this;
 }
 
+RHIDescriptorSet& VulkanRHIDescriptorSet::UpdateDescriptors(const std::vector<RHIDescriptorUpdateInfo>& descriptorUpdateInfos)
+{
+    if(descriptorUpdateInfos.empty()) return *this;
+
+    uint32_t count = descriptorUpdateInfos.size();
+    std::vector<VulkanDescriptorData> data(count);
+    std::vector<VkDescriptorUpdateTemplateEntry> entries(count);
+    for(uint32_t i = 0; i < count; i++)
+    {
+        FillDescriptorData(descriptorUpdateInfos[i], data[i]);
+        entries[i] = DescriptorEntry(descriptorUpdateInfos[i], i);
+    }
+
+    // 同一布局下写入形式稳定时使用更新模板，驱动直接按模板读取数据
+    VkDescriptorUpdateTemplate updateTemplate = Backend()->FindOrCreateVkDescriptorUpdateTemplate(layout, entries);
+    if(updateTemplate != VK_NULL_HANDLE)
+    {
+        vkUpdateDescriptorSetWithTemplate(Backend()->GetLogicalDevice(), handle, updateTemplate, data.data());
+        return *this;
+    }
+
+    // 否则全部写入合并为一次提交
+    std::vector<VkWriteDescriptorSet> descriptorWrites(count);
+    std::vector<VkWriteDescriptorSetAccelerationStructureKHR> accelerationDescriptors(count);
+    for(uint32_t i = 0; i < count; i++) descriptorWrites[i] = DescriptorWrite(handle, entries[i], data[i], accelerationDescriptors[i]);
+    vkUpdateDescriptorSets(Backend()->GetLogicalDevice(), count, descriptorWrites.data(), 0, nullptr);
+
+    return *this;
+}
+
 void VulkanRHIDescriptorSet::Destroy()
 {
     //vkFreeDescriptorSets(Backend()->GetLogicalDevice(), Backend()->GetDescriptorPool(), 1, &handle);
@@ -1392,7 +1420,7 @@ VulkanRHIGraphicsPipeline::VulkanRHIGraphicsPipeline(const RHIGraphicsPipelineIn
     pipelineInfo.renderPass = renderPass;  
 	pipelineInfo.subpass = 0;
 
-    if (vkCreateGraphicsPipelines(backend.GetLogicalDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, VK_NULL_HANDLE, &handle) != VK_SUCCESS) 
+    if (vkCreateGraphicsPipelines(backend.GetLogicalDevice(), backend.GetPipelineCache(), 1, &pipelineInfo, VK_NULL_HANDLE, &handle) != VK_SUCCESS) 
     {
         LOG_FATAL("Failed to create graphics pipeline!");
     }
@@ -1637,7 +1665,7 @@ VulkanRHIComputePipeline::VulkanRHIComputePipeline(const RHIComputePipelineInfo&
     pipelineInfo.stage = shaderStage;
     pipelineInfo.layout = pipelineLayout;
     
-    if (vkCreateComputePipelines(backend.GetLogicalDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, VK_NULL_HANDLE, &handle) != VK_SUCCESS) 
+    if (vkCreateComputePipelines(backend.GetLogicalDevice(), backend.GetPipelineCache(), 1, &pipelineInfo, VK_NULL_HANDLE, &handle) != VK_SUCCESS) 
     {
         LOG_FATAL("Failed to create compute pipeline!");
     }
@@ -1683,7 +1711,7 @@ VulkanRHIRayTracingPipeline::VulkanRHIRayTracingPipeline(const RHIRayTracingPipe
     pipelineInfo.groupCount	                    = (uint32_t)ResourceCast(info.shaderBindingTable)->GetGroups().size();
     pipelineInfo.pGroups                        = ResourceCast(info.shaderBindingTable)->GetGroups().data();
     
-    if (vkCreateRayTracingPipelinesKHR(backend.GetLogicalDevice(), VK_NULL_HANDLE, VK_NULL_HANDLE, 1, &pipelineInfo, VK_NULL_HANDLE, &handle) != VK_SUCCESS) 
+    if (vkCreateRayTracingPipelinesKHR(backend.GetLogicalDevice(), VK_NULL_HANDLE, backend.GetPipelineCache(), 1, &pipelineInfo, VK_NULL_HANDLE, &handle) != VK_SUCCESS) 
     {
         LOG_FATAL("Failed to create compute pipeline!");
     }
@@ -84,7 +84,7 @@ private:
     VkExtent2D ChooseSwapExtent();
 };
 
-class VulkanRHICommandPool : public RHICommandPool
+class VulkanRHICommandPool : public RHICommandPool		// VkCommandPool需要外部同步，多线程录制时每个线程使用各自的pool
 {
 public:
 	VulkanRHICommandPool(const RHICommandPoolInfo& info, VulkanRHIBackend& backend);
@@ -102,10 +102,28 @@ private:
 
 //缓冲，纹理，着色器，加速结构 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+class VulkanRHIHeap : public RHIHeap
+{
+public:
+	VulkanRHIHeap(const RHIHeapInfo& info, VulkanRHIBackend& backend);
+
+	const VmaAllocation& GetAllocation() { return allocation; }
+
+	virtual void Destroy() override final;
+	virtual void* RawHandle() override final { return allocationInfo.deviceMemory; };
+
+private:
+	VmaAllocation allocation;
+	VmaAllocationInfo allocationInfo;
+};
+
 class VulkanRHIBuffer : public RHIBuffer
 {
 public:
 	VulkanRHIBuffer(const RHIBufferInfo& info, VulkanRHIBackend& backend);
+	VulkanRHIBuffer(const RHIBufferInfo& info, VulkanRHIBackend& backend, RHIHeapRef heap, uint64_t offset);	// 放置在heap上，不持有allocation
+
+	static VkBufferCreateInfo CreateInfo(const RHIBufferInfo& info);
 
 	const VkBuffer& GetHandle() { return handle; }
 
@@ -121,6 +139,9 @@ private:
 	VmaAllocation allocation;
 	VmaAllocationInfo allocationInfo;
 
+	RHIHeapRef heap;
+	uint64_t heapOffset = 0;
+
 	bool mapped = false;
 	void* pointer = nullptr;
 };
@@ -129,6 +150,9 @@ class VulkanRHITexture : public RHITexture
 {
 public:
 	VulkanRHITexture(const RHITextureInfo& info, VulkanRHIBackend& backend, VkImage image = VK_NULL_HANDLE);
+	VulkanRHITexture(const RHITextureInfo& info, VulkanRHIBackend& backend, RHIHeapRef heap, uint64_t offset);
+
+	static VkImageCreateInfo CreateInfo(const RHITextureInfo& info);
 
 	const VkImage& GetHandle() { return handle; }
 
@@ -140,6 +164,10 @@ private:
 
 	VmaAllocation allocation;
 	VmaAllocationInfo allocationInfo;
+
+	RHIHeapRef heap;
+
+	void InitDefaultRange();
 };
 
 class VulkanRHITextureView : public RHITextureView
@@ -278,6 +306,7 @@ public:
 	VulkanRHIDescriptorSet(VkDescriptorSetLayout setLayout, VulkanRHIBackend& backend);
 
 	virtual RHIDescriptorSet& UpdateDescriptor(const RHIDescriptorUpdateInfo& descriptorUpdateInfo) override final;
+	virtual RHIDescriptorSet& UpdateDescriptors(const std::vector<RHIDescriptorUpdateInfo>& descriptorUpdateInfos) override final;
 
 	const VkDescriptorSet& GetHandle() { return handle; }
 
@@ -286,6 +315,7 @@ public:
 
 private:
 	VkDescriptorSet handle;
+	VkDescriptorSetLayout layout;
 };
 
 //管线状态 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -475,6 +505,13 @@ struct VulkanResourceTraits<RHIRenderPass>
 	typedef std::shared_ptr<VulkanRHIRenderPass> ConcretePointerType;
 };
 
+template<>
+struct VulkanResourceTraits<RHIHeap>
+{
+	typedef VulkanRHIHeap ConcreteType;
+	typedef std::shared_ptr<VulkanRHIHeap> ConcretePointerType;
+};
+
 template<>
 struct VulkanResourceTraits<RHIBuffer>
 {
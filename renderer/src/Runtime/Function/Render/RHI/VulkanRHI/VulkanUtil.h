@@ -7,9 +7,9 @@
 
 #include "Function/Global/Definations.h"
 
-#include <spirv_reflect.h>
 #include <volk.h>
 #include <vma.h>
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <vector>
@@ -374,42 +374,6 @@ public:
         return format;
     }
 
-    static RHIFormat SpvFormatToRHIFormat(const SpvReflectFormat& spvFormat)
-    {
-        RHIFormat format;
-
-        switch (spvFormat) {
-        case SPV_REFLECT_FORMAT_UNDEFINED:              format = FORMAT_UKNOWN;                 break;
-        case SPV_REFLECT_FORMAT_R16_UINT:               format = FORMAT_R16_UINT;               break;
-        case SPV_REFLECT_FORMAT_R16_SINT:               format = FORMAT_R16_SINT;               break;
-        case SPV_REFLECT_FORMAT_R16_SFLOAT:             format = FORMAT_R16_SFLOAT;             break;
-        case SPV_REFLECT_FORMAT_R16G16_UINT:            format = FORMAT_R16G16_UINT;            break;
-        case SPV_REFLECT_FORMAT_R16G16_SINT:            format = FORMAT_R16G16_SINT;            break;
-        case SPV_REFLECT_FORMAT_R16G16_SFLOAT:          format = FORMAT_R16G16_SFLOAT;          break;
-        case SPV_REFLECT_FORMAT_R16G16B16_UINT:         format = FORMAT_R16G16B16_UINT;         break;
-        case SPV_REFLECT_FORMAT_R16G16B16_SINT:         format = FORMAT_R16G16B16_SINT;         break;
-        case SPV_REFLECT_FORMAT_R16G16B16_SFLOAT:       format = FORMAT_R16G16B16_SFLOAT;       break;
-        case SPV_REFLECT_FORMAT_R16G16B16A16_UINT:      format = FORMAT_R16G16B16A16_UINT;      break;
-        case SPV_REFLECT_FORMAT_R16G16B16A16_SINT:      format = FORMAT_R16G16B16A16_SINT;      break;
-        case SPV_REFLECT_FORMAT_R16G16B16A16_SFLOAT:    format = FORMAT_R16G16B16A16_SFLOAT;    break;
-        case SPV_REFLECT_FORMAT_R32_UINT:               format = FORMAT_R32_UINT;               break;
-        case SPV_REFLECT_FORMAT_R32_SINT:               format = FORMAT_R32_SINT;               break;
-        case SPV_REFLECT_FORMAT_R32_SFLOAT:             format = FORMAT_R32_SFLOAT;             break;
-        case SPV_REFLECT_FORMAT_R32G32_UINT:            format = FORMAT_R32G32_UINT;            break;
-        case SPV_REFLECT_FORMAT_R32G32_SINT:            format = FORMAT_R32G32_SINT;            break;
-        case SPV_REFLECT_FORMAT_R32G32_SFLOAT:          format = FORMAT_R32G32_SFLOAT;          break;
-        case SPV_REFLECT_FORMAT_R32G32B32_UINT:         format = FORMAT_R32G32B32_UINT;         break;
-        case SPV_REFLECT_FORMAT_R32G32B32_SINT:         format = FORMAT_R32G32B32_SINT;         break;
-        case SPV_REFLECT_FORMAT_R32G32B32_SFLOAT:       format = FORMAT_R32G32B32_SFLOAT;       break;
-        case SPV_REFLECT_FORMAT_R32G32B32A32_UINT:      format = FORMAT_R32G32B32A32_UINT;      break;
-        case SPV_REFLECT_FORMAT_R32G32B32A32_SINT:      format = FORMAT_R32G32B32A32_SINT;      break;
-        case SPV_REFLECT_FORMAT_R32G32B32A32_SFLOAT:    format = FORMAT_R32G32B32A32_SFLOAT;    break;  
-        default:                                        LOG_FATAL("Unsupported reflect format type!"); 
-        }
-
-        return format;
-    }
-
     static VmaMemoryUsage MemoryUsageToVma(MemoryUsage memoryUsage)
     {
         VmaMemoryUsage usage;
@@ -534,61 +498,6 @@ public:
         return type;
     }
 
-    static ShaderFrequency SpvShaderStageToFrequency(SpvReflectShaderStageFlagBits spvShaderStage)
-    {
-        ShaderFrequency frequency;
-        switch (spvShaderStage) {
-        case SPV_REFLECT_SHADER_STAGE_VERTEX_BIT:               frequency = SHADER_FREQUENCY_VERTEX;         break;
-        case SPV_REFLECT_SHADER_STAGE_GEOMETRY_BIT:             frequency = SHADER_FREQUENCY_GEOMETRY;       break;
-        case SPV_REFLECT_SHADER_STAGE_FRAGMENT_BIT:             frequency = SHADER_FREQUENCY_FRAGMENT;       break;
-        case SPV_REFLECT_SHADER_STAGE_COMPUTE_BIT:              frequency = SHADER_FREQUENCY_COMPUTE;        break;
-        case SPV_REFLECT_SHADER_STAGE_MESH_BIT_NV:              frequency = SHADER_FREQUENCY_MESH;           break;
-        case SPV_REFLECT_SHADER_STAGE_RAYGEN_BIT_KHR:           frequency = SHADER_FREQUENCY_RAY_GEN;        break;
-        case SPV_REFLECT_SHADER_STAGE_ANY_HIT_BIT_KHR:          frequency = SHADER_FREQUENCY_ANY_HIT;        break;
-        case SPV_REFLECT_SHADER_STAGE_CLOSEST_HIT_BIT_KHR:      frequency = SHADER_FREQUENCY_CLOSEST_HIT;    break;
-        case SPV_REFLECT_SHADER_STAGE_MISS_BIT_KHR:             frequency = SHADER_FREQUENCY_RAY_MISS;       break;
-        case SPV_REFLECT_SHADER_STAGE_INTERSECTION_BIT_KHR:     frequency = SHADER_FREQUENCY_INTERSECTION;   break;
-        default:                                                frequency = SHADER_FREQUENCY_ALL;            break;
-        }
-
-        return frequency;
-    }
-
-    static ResourceType SpvDescriptorTypeToResourceType (SpvReflectDescriptorType descriptorType)
-    {
-        ResourceType resourceType;
-        switch (descriptorType) {
-        case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLER:                       resourceType = RESOURCE_TYPE_SAMPLER;                   break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:        resourceType = RESOURCE_TYPE_COMBINED_IMAGE_SAMPLER;    break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_SAMPLED_IMAGE:                 resourceType = RESOURCE_TYPE_TEXTURE;                   break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_IMAGE:                 resourceType = RESOURCE_TYPE_RW_TEXTURE;                break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:          resourceType = RESOURCE_TYPE_TEXEL_BUFFER;              break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:          resourceType = RESOURCE_TYPE_RW_TEXEL_BUFFER;           break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER:                resourceType = RESOURCE_TYPE_UNIFORM_BUFFER;            break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER:                resourceType = RESOURCE_TYPE_RW_BUFFER;                 break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:        resourceType = RESOURCE_TYPE_UNIFORM_BUFFER;            break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC:        resourceType = RESOURCE_TYPE_RW_BUFFER;                 break;
-        case SPV_REFLECT_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR:    resourceType = RESOURCE_TYPE_RAY_TRACING;               break;
-        default:                                                        LOG_FATAL("Unsupported reflect descriptor type!"); 
-        }
-
-        return resourceType;
-    }
-
-    static TextureViewType SpvDimToTextureViewType(SpvDim dim, bool isArray)
-    {
-        TextureViewType viewType;
-        switch (dim) {
-        case SpvDim1D:      viewType = isArray ? VIEW_TYPE_1D_ARRAY : VIEW_TYPE_1D;         break;
-        case SpvDim2D:      viewType = isArray ? VIEW_TYPE_2D_ARRAY : VIEW_TYPE_2D;         break;
-        case SpvDim3D:      viewType = isArray ? VIEW_TYPE_UNDEFINED : VIEW_TYPE_3D;        break;
-        case SpvDimCube:    viewType = isArray ? VIEW_TYPE_CUBE_ARRAY : VIEW_TYPE_CUBE;     break;
-        default:            LOG_FATAL("Unsupported texture view type!");  
-        }
-        
-        return viewType;
-    }
-
     static VkDescriptorType ResourceTypeToVk(ResourceType resourceType)
     {
         VkDescriptorType descriptorType;
@@ -24,6 +24,7 @@ void EditorUIPass::Build(RDGBuilder& builder)
         RDGRenderPassHandle pass = builder.CreateRenderPass(GetName())
             .Color(0, outColor, ATTACHMENT_LOAD_OP_LOAD, ATTACHMENT_STORE_OP_STORE, {0.0f, 0.0f, 0.0f, 0.0f})
             .DepthStencil(depth, ATTACHMENT_LOAD_OP_LOAD, ATTACHMENT_STORE_OP_STORE, 1.0f, 0)   // 为什么必须加深度才有效？
+            .RecordOnMainThread()   // 执行时调用编辑器UI
             .Execute([&](RDGPassContext context) {
                 
                 Extent2D windowExtent = EngineContext::Render()->GetWindowsExtent();
@@ -59,7 +60,7 @@ void EditorUIPass::InitImGuiStyle()
         command->Execute();
         queue->WaitIdle();
 
-		ImGui_ImplVulkan_DestroyFontUploadObjects();
+		if(EngineContext::RHI()->GetBackendInfo().type == BACKEND_VULKAN) ImGui_ImplVulkan_DestroyFontUploadObjects();
 	}
 
     // 风格设置
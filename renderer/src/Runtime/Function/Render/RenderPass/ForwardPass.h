@@ -43,7 +43,7 @@ public:
     // virtual void OnBuildDrawCommands(                                                           
     //                 uint32_t pipelineIndex,     
     //                 RHIGraphicsPipelineRef pipeline, 
-    //                 const std::vector<DrawGeometryInfo>& geometries) override final;
+    //                 std::span<const DrawGeometryInfo> geometries) override final;
 
 private:
     ForwardPass* pass;
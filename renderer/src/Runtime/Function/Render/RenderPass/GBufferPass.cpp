@@ -35,7 +35,7 @@ RHIGraphicsPipelineRef GBufferPassProcessor::OnCreatePipeline(const DrawPipeline
 
     // if(!pipelineInfo.vertexShader->GetReflectInfo().DefinedSymbol("VERTEX_INPUT"));   // 也可以根据反射信息来检查管线适配性
 
-    pipeline = GraphicsPipelineCache::Get()->Allocate(pipelineInfo).pipeline;     // 按原本提交的管线状态
+    pipeline = AllocatePipeline(pipelineInfo);                                          // 按原本提交的管线状态，还在后台编译时先用默认着色器代替
     if(pipeline) return pipeline;                                                       // TODO 给定的着色器能否满足管线需要其实可以在材质绑定着色器的时候检查和设置标志位？
                                                                                         // 这样只用做一次而不是每帧检查
     pipelineInfo.vertexShader = pipelineState.clusterRender ? 
@@ -43,7 +43,7 @@ RHIGraphicsPipelineRef GBufferPassProcessor::OnCreatePipeline(const DrawPipeline
                                     pass->vertexShader.shader;                          // 用默认着色器
     pipelineInfo.geometryShader = nullptr;
     pipelineInfo.fragmentShader = pass->fragmentShader.shader;
-    pipeline = GraphicsPipelineCache::Get()->Allocate(pipelineInfo).pipeline;
+    pipeline = AllocatePipeline(pipelineInfo);
     if(pipeline) return pipeline;
 
     if(pipelineState.clusterRender) return pass->clusterPipeline;                       // 用默认管线
@@ -28,6 +28,8 @@ public:
 
 	void CollectStatisticDatas();
 
+	bool FrustumCullingEnabled()		{ return lodSetting.disableFrustrumCulling == 0; }
+
 private:
 	struct CullingLodSetting
 	{
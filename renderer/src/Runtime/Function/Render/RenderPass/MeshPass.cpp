@@ -1,5 +1,6 @@
 #include "MeshPass.h"
 #include "Core/Log/Log.h"
+#include "Core/Util/RadixSort.h"
 #include "Function/Global/EngineContext.h"
 #include "Function/Render/RHI/RHIStructs.h"
 #include "Function/Render/RenderResource/PipelineCache.h"
@@ -8,12 +9,10 @@
 #include <cassert>
 #include <cstdint>
 #include <functional>
-#include <set>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
-uint32_t MeshPassProcessor::globalClusterOffset = 0;
-
 const std::vector<std::shared_ptr<MeshPassIndirectBuffers>>& MeshPassProcessor::GetIndirectBuffers()                                   
 { 
     return indirectBuffers[EngineContext::ThreadPool()->ThreadFrameIndex()]; 
@@ -21,12 +20,14 @@ const std::vector<std::shared_ptr<MeshPassIndirectBuffers>>& MeshPassProcessor::
 
 void MeshPassProcessor::AddDrawCommand(const DrawCommand& drawCommand, uint32_t passIndex)                         
 { 
-    drawCommands[EngineContext::ThreadPool()->ThreadFrameIndex()][passIndex].emplace_back(drawCommand); 
+    processedDrawCommands[passIndex].emplace_back(drawCommand); 
 }
 
 void MeshPassProcessor::Init(uint32_t multiPass)
 { 
     this->multiPass = multiPass;
+    processedDrawCommands.resize(multiPass);
+    for(auto& drawCommand : drawCommands) drawCommand.resize(multiPass);
     for(auto& indirectBuffer : indirectBuffers)
     {
         indirectBuffer.clear();
@@ -35,100 +36,173 @@ void MeshPassProcessor::Init(uint32_t multiPass)
     }
 }
 
+RHIGraphicsPipelineRef MeshPassProcessor::AllocatePipeline(const RHIGraphicsPipelineInfo& info)
+{
+    GraphicsPipelineCache::CachedPipeline cached = GraphicsPipelineCache::Get()->AllocateAsync(info);
+    if(cached.pending) pendingPipeline = true;
+    return cached.pipeline;
+}
+
+bool MeshPassProcessor::PipelinesUpdated()
+{
+    return pendingPipeline && GraphicsPipelineCache::Get()->GetCompileVersion() != pipelineCompileVersion;
+}
+
+void MeshPassProcessor::AddDrawInfo(const DrawPipelineState& pipelineState, const DrawGeometryInfo& geometryInfo)
+{
+    auto iter = pipelineStateIndices.find(pipelineState);
+    uint32_t index;
+    if(iter != pipelineStateIndices.end()) index = iter->second;
+    else
+    {
+        index = pipelineStates.size();
+        pipelineStates.push_back(pipelineState);
+        pipelineStateIndices.emplace(pipelineState, index);
+    }
+
+    drawKeys.push_back(pipelineState.SortKeyBits() | index);
+    drawGeometries.push_back(geometryInfo);
+}
+
 void MeshPassProcessor::Process(const std::vector<DrawBatch>& drawBatches)
 {
     ENGINE_TIME_SCOPE(MeshPassProcessor::Process);
 
     batches.clear();
+    pipelineStates.clear();
+    pipelineStateIndices.clear();
+    drawKeys.clear();
     drawGeometries.clear();
-    drawCommands[EngineContext::ThreadPool()->ThreadFrameIndex()].clear();
+    processedDrawCommands.clear();
     meshDrawCommand.clear();
     meshDrawInfo.clear();
     clusterDrawCommand.clear();
     clusterDrawInfo.clear();
     clusterGroupDrawInfo.clear();
 
-    drawCommands[EngineContext::ThreadPool()->ThreadFrameIndex()].resize(multiPass);
+    processedDrawCommands.resize(multiPass);
+    processVersion++;
+    pendingPipeline = false;
+    pipelineCompileVersion = GraphicsPipelineCache::Get()->GetCompileVersion();    // 先于查询记录，期间完成的编译会在下一帧触发重建
 
     for(auto& batch : drawBatches)
     {
         OnCollectBatch(batch);
     }
 
-    for(auto& batch : batches)
+    for(auto batch : batches)
     {
-        OnBuildDrawInfo(batch); 
+        OnBuildDrawInfo(*batch); 
     }
 
+    // 按排序键分桶，同一管线状态的几何信息连续存放，键相同的保持收集顺序
+    RadixSort(drawKeys, sortOrder, sortTemp);
+    sortedGeometries.resize(drawGeometries.size());
+    for(uint32_t i = 0; i < sortOrder.size(); i++) sortedGeometries[i] = drawGeometries[sortOrder[i]];
+
     uint32_t pipelineIndex = 0;
-    for(auto& pair : drawGeometries)
+    for(uint32_t begin = 0; begin < sortOrder.size(); )
     {
+        uint64_t key = drawKeys[sortOrder[begin]];
+        uint32_t end = begin + 1;
+        while(end < sortOrder.size() && drawKeys[sortOrder[end]] == key) end++;
+
         assert(pipelineIndex < MAX_PER_PASS_PIPELINE_STATE_COUNT);      // 限制最大的可能管线状态数目
         
-        RHIGraphicsPipelineRef pipeline = OnCreatePipeline(pair.first);
+        RHIGraphicsPipelineRef pipeline = OnCreatePipeline(pipelineStates[key & 0xFFFFFFFF]);
         if(pipeline)
         {
-            OnBuildDrawCommands(pipelineIndex, pipeline, pair.second);
+            OnBuildDrawCommands(pipelineIndex, pipeline, std::span<const DrawGeometryInfo>(sortedGeometries.data() + begin, end - begin));
             pipelineIndex++;
         }
+        begin = end;
     }
+    pipelineStateSize = pipelineIndex;
+
+    processSizes[0] = meshDrawInfo.size();
+    processSizes[1] = clusterGroupDrawInfo.size();
+    processSizes[2] = clusterDrawInfo.size() + clusterGroupDrawInfo.size() * CLUSTER_GROUP_SIZE;
+
+    clusterOffsetSize = 0;
+    for(uint32_t i = 0; i < pipelineStateSize; i++) clusterOffsetSize += clusterCount[i];
+    clusterOffsetSize *= multiPass;     // 每个pass buffer各占一段
+}
+
+void MeshPassProcessor::Upload(uint32_t clusterOffset)
+{
+    ENGINE_TIME_SCOPE(MeshPassProcessor::Upload);
 
     // 将准备好的全部数据提交给GPU端
     IndirectSetting meshDrawSetting = {
         .processSize = (uint32_t)meshDrawInfo.size(),
-        .pipelineStateSize = pipelineIndex,
+        .pipelineStateSize = pipelineStateSize,
         .drawSize = 0,
         .frustumCull = 0,
         .occlusionCull = 0
     };
     IndirectSetting clusterDrawSetting = {
         .processSize = (uint32_t)clusterDrawInfo.size(),
-        .pipelineStateSize = pipelineIndex,
+        .pipelineStateSize = pipelineStateSize,
         .drawSize = 0,
         .frustumCull = 0,
         .occlusionCull = 0
     };
     IndirectSetting clusterGroupDrawSetting = {
         .processSize = (uint32_t)clusterGroupDrawInfo.size(),
-        .pipelineStateSize = pipelineIndex,
+        .pipelineStateSize = pipelineStateSize,
         .drawSize = 0,
         .frustumCull = 0,
         .occlusionCull = 0
     };
-    processSizes[0] = meshDrawInfo.size();
-    processSizes[1] = clusterGroupDrawInfo.size();
-    processSizes[2] = clusterDrawInfo.size() + clusterGroupDrawInfo.size() * CLUSTER_GROUP_SIZE;
+
+    uint32_t frameIndex = EngineContext::ThreadPool()->ThreadFrameIndex();
+    bool upToDate = uploadedVersions[frameIndex] == processVersion;
+    uploadedVersions[frameIndex] = processVersion;
 
     auto& passBuffers = GetIndirectBuffers();
+    if(!upToDate)
+    {
+        drawCommands[frameIndex] = processedDrawCommands;
+        for(uint32_t i = 0; i < passBuffers.size(); i++)
+        {
+            for(auto& drawCommand : drawCommands[frameIndex][i])
+            {
+                if(!drawCommand.indirectMeshCommandBuffer)      drawCommand.indirectMeshCommandBuffer = passBuffers[i]->meshDrawCommandBuffer.buffer;
+                if(!drawCommand.indirectClusterCommandBuffer)   drawCommand.indirectClusterCommandBuffer = passBuffers[i]->clusterDrawCommandBuffer.buffer;
+            }
+        }
+    }
+
     for(auto& buffers : passBuffers)
     {
         // 填写cluster的间接绘制命令
-        // 由于所有绘制指令里的索引最后指向同一个全局缓冲，需要计算全局的偏移
-        uint32_t globalClusterOffset = MeshPassProcessor::GetGlobalClusterOffset();
+        // 由于所有绘制指令里的索引最后指向同一个全局缓冲，需要加上全局的偏移
+        // 偏移由调用方按pass顺序做前缀和得到，和处理的先后无关
         uint32_t localClusterOffset = 0;
         clusterDrawCommand.clear();
-        for(uint32_t i = 0; i < pipelineIndex; i++)
+        for(uint32_t i = 0; i < pipelineStateSize; i++)
         {
             clusterDrawCommand.push_back({
                 .vertexCount = CLUSTER_TRIANGLE_SIZE * 3,
                 .instanceCount = 0,
                 .firstVertex = 0,
-                .firstInstance = globalClusterOffset + localClusterOffset
+                .firstInstance = clusterOffset + localClusterOffset
             });
             localClusterOffset += clusterCount[i];
         }
-        MeshPassProcessor::AddGlobalClusterOffset(localClusterOffset);
-
+        clusterOffset += localClusterOffset;
 
+        // 剔除时GPU会累加统计数据和cluster的instanceCount，设置和cluster绘制命令每帧都要重置
+        // 绘制信息GPU只会在CPU提交的部分之后追加，mesh绘制命令GPU只改写instanceCount，没有变化时不需要重新提交
         buffers->meshDrawDataBuffer.SetData(&meshDrawSetting, sizeof(IndirectSetting), 0);
-        buffers->meshDrawDataBuffer.SetData(meshDrawInfo.data(), meshDrawInfo.size() * sizeof(IndirectMeshDrawInfo), sizeof(IndirectSetting));
-        buffers->meshDrawCommandBuffer.SetData(meshDrawCommand.data(), meshDrawCommand.size() * sizeof(RHIIndirectCommand), 0);
-
         buffers->clusterDrawDataBuffer.SetData(&clusterDrawSetting, sizeof(IndirectSetting), 0);
-        buffers->clusterDrawDataBuffer.SetData(clusterDrawInfo.data(), clusterDrawInfo.size() * sizeof(IndirectClusterDrawInfo), sizeof(IndirectSetting));
         buffers->clusterDrawCommandBuffer.SetData(clusterDrawCommand.data(), clusterDrawCommand.size() * sizeof(RHIIndirectCommand), 0);
-
         buffers->clusterGroupDrawDataBuffer.SetData(&clusterGroupDrawSetting, sizeof(IndirectSetting), 0);
+        if(upToDate) continue;
+
+        buffers->meshDrawDataBuffer.SetData(meshDrawInfo.data(), meshDrawInfo.size() * sizeof(IndirectMeshDrawInfo), sizeof(IndirectSetting));
+        buffers->meshDrawCommandBuffer.SetData(meshDrawCommand.data(), meshDrawCommand.size() * sizeof(RHIIndirectCommand), 0);
+        buffers->clusterDrawDataBuffer.SetData(clusterDrawInfo.data(), clusterDrawInfo.size() * sizeof(IndirectClusterDrawInfo), sizeof(IndirectSetting));
         buffers->clusterGroupDrawDataBuffer.SetData(clusterGroupDrawInfo.data(), clusterGroupDrawInfo.size() * sizeof(IndirectClusterGroupDrawInfo), sizeof(IndirectSetting));
     }
 
@@ -209,13 +283,13 @@ RHIGraphicsPipelineRef MeshPassProcessor::OnCreatePipeline(const DrawPipelineSta
     // pipelineInfo.colorAttachmentFormats[3]      = FORMAT_R16G16B16A16_SFLOAT;                                               
     // pipelineInfo.depthStencilAttachmentFormat   = EngineContext::Render()->GetDepthFormat();
 
-    return GraphicsPipelineCache::Get()->Allocate(pipelineInfo).pipeline;   // 构建可能失败返回空，则后续处理将放弃该pipelineState的绘制
+    return AllocatePipeline(pipelineInfo);      // 构建可能失败或者还在编译而返回空，则后续处理将放弃该pipelineState的绘制
 }
 
 void MeshPassProcessor::OnBuildDrawCommands(
     uint32_t pipelineIndex, 
     RHIGraphicsPipelineRef pipeline, 
-    const std::vector<DrawGeometryInfo>& geometries)
+    std::span<const DrawGeometryInfo> geometries)
 {
     DrawCommand drawCommand = {
         .pipeline = pipeline,
@@ -286,12 +360,6 @@ void MeshPassProcessor::OnBuildDrawCommands(
     }
     drawCommand.meshCommandRange.size = meshCount;  //每个mesh一个command
 
-    auto& indirectBuffers = GetIndirectBuffers();
-    for(int i = 0; i < indirectBuffers.size(); i++)
-    {
-        drawCommand.indirectMeshCommandBuffer = indirectBuffers[i]->meshDrawCommandBuffer.buffer;
-        drawCommand.indirectClusterCommandBuffer = indirectBuffers[i]->clusterDrawCommandBuffer.buffer;
-        AddDrawCommand(drawCommand, i);
-    }
+    for(uint32_t i = 0; i < multiPass; i++) AddDrawCommand(drawCommand, i);     // 间接绘制缓冲在Upload时按帧填写
 }
 
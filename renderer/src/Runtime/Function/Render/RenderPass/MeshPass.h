@@ -5,8 +5,12 @@
 #include "Function/Global/Definations.h"
 #include "RenderPass.h"
 #include "Function/Render/RenderResource/PipelineCache.h"
+#include <algorithm>
 #include <array>
 #include <cstdint>
+#include <functional>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 // mesh pass提供了对于各个需要光栅化绘制mesh的pass的抽象
@@ -32,7 +36,7 @@
 // 暂时没有单独抽象MeshElementCollector，直接在render system里完成对全部绘制的收集
 // 目前仅有MeshRendererComponent一种组件提供了提交DrawBatch信息的CollectDrawBatch()函数，后续可以此为接口做扩展
 // 单次绘制以DrawBatch结构体为基础，经过各个mesh pass提供的MeshPassProcessor子类完成指令解析和合批过程，并完成用于GPU端剔除和指令生成的全部数据收集
-// 暂时没有CPU端剔除，后续可以做八叉树场景管理等提前削掉一部分
+// 进入processor前RenderMeshManager已经用场景八叉树按相机和平行光级联做过一次CPU端剔除，点光源阴影只在GPU端剔除
 // MeshPassProcessor子类可重构部分处理流程函数来自定义处理，例如DrawBatch的收集条件，管线创建等过程
 // 其余的功能已经尽可能封装，在扩展Mesh pass时只需要定义好processor的处理过程然后在渲染pass里靠processor录制绘制指令即可
 // 剔除需要配合GPUCullingPass，该pass会收集全部剔除处理的数据并进行计算
@@ -141,6 +145,30 @@ typedef struct DrawPipelineState
                 (fragmentShader.get() != other.fragmentShader.get()) ?  (fragmentShader.get() < other.fragmentShader.get()) : false;
     }
 
+    // 着色器以外的状态按上面比较的先后顺序压缩到排序键的高位，低32位由processor填入管线状态的编号
+    uint64_t SortKeyBits() const
+    {
+        uint64_t key = std::min(renderQueue, 0xFFFFu);          // 16位
+        key = (key << 2) | (cullMode & 0x3);
+        key = (key << 2) | (fillMode & 0x3);
+        key = (key << 1) | (depthTest ? 1 : 0);
+        key = (key << 1) | (depthWrite ? 1 : 0);
+        key = (key << 3) | (depthCompare & 0x7);
+        key = (key << 1) | (meshRender ? 1 : 0);
+        key = (key << 1) | (clusterRender ? 1 : 0);
+        return key << 32;
+    }
+
+    struct Hash {
+        size_t operator()(const DrawPipelineState& a) const {
+            size_t hash = a.SortKeyBits();
+            hash ^= std::hash<const void*>()(a.vertexShader.get()) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            hash ^= std::hash<const void*>()(a.geometryShader.get()) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            hash ^= std::hash<const void*>()(a.fragmentShader.get()) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
 } DrawPipelineState;
 
 typedef struct DrawGeometryInfo
@@ -183,32 +211,34 @@ typedef struct MeshPassIndirectBuffers
 } MeshPassIndirectBuffers;
 
 // 各个meshpass对应子类，收集各meshpass需要的绘制信息，生成绘制指令 
+// Process只访问processor自身的数据，不同pass的processor可以在线程池上并行处理，之后再在主线程按pass顺序Upload
 class MeshPassProcessor
 {
 public:
     void Init(uint32_t multiPass = 1);
-    void Process(const std::vector<DrawBatch>& batches);
+    void Process(const std::vector<DrawBatch>& batches);                                       // CPU端的收集，排序合批和绘制指令生成，只在场景图元的结构变化时调用
+    void Upload(uint32_t clusterOffset);                                                        // 每帧调用，填写cluster间接绘制命令并提交GPU缓冲，clusterOffset为该processor在全局cluster缓冲中的起始偏移
+                                                                                                // 绘制信息只在当前帧的缓冲还不是最新的Process结果时才重新提交
     void Draw(RHICommandListRef command, uint32_t passIndex = 0);
 
     const std::vector<std::shared_ptr<MeshPassIndirectBuffers>>& GetIndirectBuffers();
     const std::array<uint32_t, 3>& GetProcessSizes()                                                { return processSizes; }
-
-    static const uint32_t& GetGlobalClusterOffset()                                                 { return globalClusterOffset; }
-    static const uint32_t& AddGlobalClusterOffset(uint32_t size)                                    { globalClusterOffset += size; return globalClusterOffset; }
-    static void ResetGlobalClusterOffset()                                                          { globalClusterOffset = 0; }
+    uint32_t GetClusterOffsetSize()                                                                 { return clusterOffsetSize; }  // Process后有效，占用的全局cluster偏移范围
+    bool PipelinesUpdated();                                                                        // 上次Process时有管线在后台编译而用了默认管线代替，且之后有编译完成，需要重新Process
 
 protected:    
     virtual void OnCollectBatch(const DrawBatch& batch);                                        // 由子类重载，负责条件判断和实际添加batch进processor，
     virtual void OnBuildDrawInfo(const DrawBatch& batch);                                       // 由子类重载，负责生成绘制信息（包括管线状态信息和几何信息）进processor，
-    virtual RHIGraphicsPipelineRef OnCreatePipeline(const DrawPipelineState& pipelineState);    // 由子类重载，负责根据管线状态创建管线
+    virtual RHIGraphicsPipelineRef OnCreatePipeline(const DrawPipelineState& pipelineState);    // 由子类重载，负责根据管线状态创建管线，可能在工作线程调用
     virtual void OnBuildDrawCommands(                                                           // 由子类重载，负责填充间接绘制相关的缓冲和生成绘制指令
                     uint32_t pipelineIndex,     
                     RHIGraphicsPipelineRef pipeline, 
-                    const std::vector<DrawGeometryInfo>& geometries);
+                    std::span<const DrawGeometryInfo> geometries);
     
-    void AddBatch(const DrawBatch& batch)                                                           { batches.emplace_back(batch); }
-    void AddDrawInfo(const DrawPipelineState& pipelineState, const DrawGeometryInfo& geometryInfo)  { drawGeometries[pipelineState].emplace_back(geometryInfo); }
+    void AddBatch(const DrawBatch& batch)                                                           { batches.push_back(&batch); }     // 只记录指针，batch需要在Process期间保持有效
+    void AddDrawInfo(const DrawPipelineState& pipelineState, const DrawGeometryInfo& geometryInfo);
     void AddDrawCommand(const DrawCommand& drawCommand, uint32_t passIndex);
+    RHIGraphicsPipelineRef AllocatePipeline(const RHIGraphicsPipelineInfo& info);                   // 从管线缓存异步获取，还在编译时返回空并记录，调用方改用默认管线
 
     // 需要提交给GPU缓冲的信息 ///////////////////////////////////////////////////
     std::vector<RHIIndirectCommand> meshDrawCommand;                            
@@ -222,15 +252,25 @@ protected:
     std::array<std::vector<std::shared_ptr<MeshPassIndirectBuffers>>, FRAMES_IN_FLIGHT> indirectBuffers;     // 每帧都完全重构的buffer，因此需要每帧一份   
                                                                                                              // 允许一个processor对应多个不同的绘制指令
 private:                                                                                                     // （例如点光源/平行光源阴影，收集流程完全相同，剔除和绘制流程不同）
-    // CPU端的数据处理结果 ///////////////////////////////////////////////////
-    std::vector<DrawBatch> batches;
-    std::map<DrawPipelineState, std::vector<DrawGeometryInfo>> drawGeometries;
+    // CPU端的数据处理结果，数组每帧清空但保留容量 ///////////////////////////////////////////////////
+    std::vector<const DrawBatch*> batches;
+    std::vector<DrawPipelineState> pipelineStates;                                                          // 本帧出现过的管线状态，下标即排序键的低32位
+    std::unordered_map<DrawPipelineState, uint32_t, DrawPipelineState::Hash> pipelineStateIndices;
+    std::vector<uint64_t> drawKeys;                                                                         // 和drawGeometries一一对应的排序键
+    std::vector<DrawGeometryInfo> drawGeometries;
+    std::vector<DrawGeometryInfo> sortedGeometries;                                                         // 按排序键分桶后的几何信息，同一管线状态的几何连续存放
+    std::vector<uint32_t> sortOrder;
+    std::vector<uint32_t> sortTemp;
+    std::vector<std::vector<DrawCommand>> processedDrawCommands;                                            // Process生成的绘制指令，不含间接绘制缓冲
     std::array<std::vector<std::vector<DrawCommand>>, FRAMES_IN_FLIGHT> drawCommands;                       // CPU端的绘制指令也可能延迟执行，数据也需要每帧一份
+    std::array<uint32_t, FRAMES_IN_FLIGHT> uploadedVersions = {};                                           // 各帧缓冲对应的Process版本
+    uint32_t processVersion = 0;
     std::array<uint32_t, 3> processSizes = { 0, 0, 0 };
+    uint32_t pipelineStateSize = 0;
+    uint32_t clusterOffsetSize = 0;
     uint32_t multiPass = 1;
-
-    // cluster数据的全局偏移，最后所有的pass都需要收集cluster绘制信息到一个全局buffer，需要记录偏移
-    static uint32_t globalClusterOffset;
+    bool pendingPipeline = false;                                                                           // 上次Process时是否有管线还在编译
+    uint32_t pipelineCompileVersion = 0;                                                                    // 上次Process开始时管线缓存的编译版本
 };
 typedef std::shared_ptr<MeshPassProcessor> MeshPassProcessorRef;
 
@@ -72,52 +72,77 @@ void VertexBuffer::SetBufferData(void* data, uint32_t size, RHIBufferRef& buffer
 }
 
 void VertexBuffer::SetPosition(const std::vector<Vec3>& position)
+{
+    SetPosition(position.data(), position.size());
+}
+
+void VertexBuffer::SetPosition(const Vec3* position, uint32_t count)
 {
     SetBufferData(
-        (void*)position.data(), 
-        position.size() * sizeof(Vec3),
+        (void*)position, 
+        count * sizeof(Vec3),
         positionBuffer, 
         vertexInfo.positionID, 
         BINDLESS_SLOT_POSITION);
     
-    vertexNum = position.size();    // 存一下当前的顶点数目，以position为基准
+    vertexNum = count;    // 存一下当前的顶点数目，以position为基准
 }
 
 void VertexBuffer::SetNormal(const std::vector<Vec3>& normal)
+{
+    SetNormal(normal.data(), normal.size());
+}
+
+void VertexBuffer::SetNormal(const Vec3* normal, uint32_t count)
 {
     SetBufferData(
-        (void*)normal.data(), 
-        normal.size() * sizeof(Vec3),
+        (void*)normal, 
+        count * sizeof(Vec3),
         normalBuffer, 
         vertexInfo.normalID, 
         BINDLESS_SLOT_NORMAL);
 }
 
 void VertexBuffer::SetTangent(const std::vector<Vec4>& tangent)
+{
+    SetTangent(tangent.data(), tangent.size());
+}
+
+void VertexBuffer::SetTangent(const Vec4* tangent, uint32_t count)
 {
     SetBufferData(
-        (void*)tangent.data(), 
-        tangent.size() * sizeof(Vec4),
+        (void*)tangent, 
+        count * sizeof(Vec4),
         tangentBuffer, 
         vertexInfo.tangentID, 
         BINDLESS_SLOT_TANGENT);
 }
 
 void VertexBuffer::SetTexCoord(const std::vector<Vec2>& texCoord)
+{
+    SetTexCoord(texCoord.data(), texCoord.size());
+}
+
+void VertexBuffer::SetTexCoord(const Vec2* texCoord, uint32_t count)
 {
     SetBufferData(
-        (void*)texCoord.data(), 
-        texCoord.size() * sizeof(Vec2),
+        (void*)texCoord, 
+        count * sizeof(Vec2),
         texCoordBuffer, 
         vertexInfo.texCoordID, 
         BINDLESS_SLOT_TEXCOORD);
 }
 
 void VertexBuffer::SetColor(const std::vector<Vec3>& color)
+{
+    SetColor(color.data(), color.size());
+}
+
+void VertexBuffer::SetColor(const Vec3* color, uint32_t count)
 {
     SetBufferData(
-        (void*)color.data(), 
-        color.size() * sizeof(Vec3),
+        (void*)color, 
+        count * sizeof(Vec3),
         colorBuffer, 
         vertexInfo.colorID, 
         BINDLESS_SLOT_COLOR);
@@ -150,8 +175,13 @@ IndexBuffer::~IndexBuffer()
 
 void IndexBuffer::SetIndex(const std::vector<uint32_t>& index)
 {
-    indexNum = index.size();
-    uint32_t size = index.size() * sizeof(uint32_t);
+    SetIndex(index.data(), index.size());
+}
+
+void IndexBuffer::SetIndex(const uint32_t* index, uint32_t count)
+{
+    indexNum = count;
+    uint32_t size = count * sizeof(uint32_t);
 
     if(size == 0) return;
     if(!buffer || buffer->GetInfo().size < size)  // 创建buffer
@@ -171,7 +201,7 @@ void IndexBuffer::SetIndex(const std::vector<uint32_t>& index)
             BINDLESS_SLOT_INDEX);
     }
 
-    memcpy(buffer->Map(), index.data(), size);
+    memcpy(buffer->Map(), index, size);
     //buffer->UnMap();
 }
 
@@ -71,6 +71,12 @@ public:
     void SetBoneIndex(const std::vector<IVec4>& boneIndex);
     void SetBoneWeight(const std::vector<Vec4>& boneWeight);
 
+    void SetPosition(const Vec3* position, uint32_t count);     // 直接从外部内存（如映射的缓存文件）拷贝
+    void SetNormal(const Vec3* normal, uint32_t count);
+    void SetTangent(const Vec4* tangent, uint32_t count);
+    void SetTexCoord(const Vec2* texCoord, uint32_t count);
+    void SetColor(const Vec3* color, uint32_t count);
+
     RHIBufferRef positionBuffer;
     RHIBufferRef normalBuffer;
     RHIBufferRef tangentBuffer;
@@ -107,6 +113,7 @@ public:
     ~IndexBuffer();
 
     void SetIndex(const std::vector<uint32_t>& index);
+    void SetIndex(const uint32_t* index, uint32_t count);
 
     RHIBufferRef buffer;
 
@@ -187,6 +194,8 @@ public:
         memcpy((Type*)buffer->Map() + index, data, size * sizeof(Type));
     }
 
+    Type* Map()                                     { return (Type*)buffer->Map(); }
+
     uint32_t Allocate()                             { return idAlloctor.Allocate(); }
     IndexRange Allocate(uint32_t size)              { return idAlloctor.Allocate(size); }
     void Release(uint32_t index)                    { idAlloctor.Release(index); }
@@ -0,0 +1,19 @@
+#include "Drawable.h"
+#include "Function/Global/EngineContext.h"
+
+void Drawable::MarkDrawableDirty(DrawableDirtyFlags flags)
+{
+    if(primitiveID != 0 && !EngineContext::Destroyed()) EngineContext::Render()->GetMeshManager()->MarkPrimitiveDirty(primitiveID, flags);
+}
+
+void Drawable::RegisterDrawable(Component* owner)
+{
+    if(primitiveID != 0) return;
+    primitiveID = EngineContext::Render()->GetMeshManager()->AddPrimitive(this, owner);
+}
+
+void Drawable::UnregisterDrawable()
+{
+    if(primitiveID != 0 && !EngineContext::Destroyed()) EngineContext::Render()->GetMeshManager()->RemovePrimitive(primitiveID);
+    primitiveID = 0;
+}
@@ -1,16 +1,49 @@
 #pragma once
 
+#include "Core/Math/BoundingBox.h"
 #include "Function/Render/RHI/RHIStructs.h"
 #include "Function/Render/RenderPass/MeshPass.h"
+#include "Function/Render/RenderResource/ObjectInfoBatch.h"
 #include "Function/Render/RenderSystem/RenderSurfaceCacheManager.h"
 
+#include <cstdint>
+
+class Component;
+
+enum DrawableDirtyFlagBits
+{
+    DRAWABLE_DIRTY_NONE = 0x00,
+    DRAWABLE_DIRTY_TRANSFORM = 0x01,    // 变换改变，需要重新计算物体信息
+    DRAWABLE_DIRTY_MATERIAL = 0x02,     // 材质改变，需要重新收集DrawBatch
+    DRAWABLE_DIRTY_MESH = 0x04,         // 网格改变，需要重新收集DrawBatch
+
+    DRAWABLE_DIRTY_ALL = 0x07,
+};
+typedef uint32_t DrawableDirtyFlags;
+
+// 可绘制物体注册到RenderMeshManager的常驻图元表后，只在标脏后才重新收集DrawBatch和上传物体信息
 class Drawable
 {
 public:
-    virtual void CollectDrawBatch(std::vector<DrawBatch>& batches) = 0;
+    virtual void CollectDrawBatch(std::vector<DrawBatch>& batches) = 0;    // 注册和材质/网格标脏时调用，结果由图元表缓存
+
+    virtual uint32_t ObjectInfoSize() { return 0; };                       // CollectObjectInfos最多加入的物体信息数目，用于预先分配batch中的范围
+
+    virtual void CollectObjectInfos(ObjectInfoBatch::Range& range, bool recompute) {};     // 标脏后的几帧内调用，把需要上传到当前帧物体缓冲的物体信息加入range，recompute时需要重新计算矩阵
+                                                                            // 会在工作线程并行调用，只能读写自己的数据
+
+    virtual bool GetWorldBounds(BoundingBox& box) { return false; };        // 世界空间包围盒，在batch执行之后并行调用，返回false时不参与CPU端剔除
 
     virtual void CollectAccelerationStructureInstance(std::vector<RHIAccelerationStructureInstanceInfo>& instances) {};
 
     virtual void CollectSurfaceCacheTask(std::vector<SurfaceCacheTask>& tasks) {};
-    
-};
\ No newline at end of file
+
+    void MarkDrawableDirty(DrawableDirtyFlags flags);
+
+protected:
+    void RegisterDrawable(Component* owner);                                // owner用于判断图元是否属于当前场景
+    void UnregisterDrawable();
+
+private:
+    uint32_t primitiveID = 0;       // 0为未注册
+};
@@ -10,6 +10,8 @@
 CEREAL_REGISTER_TYPE(Material)
 CEREAL_REGISTER_POLYMORPHIC_RELATION(Asset, Material)
 
+std::atomic<uint32_t> Material::pipelineStateVersion = 0;
+
 void Material::OnLoadAsset()
 {
     BeginLoadAssetBind()
@@ -26,6 +28,7 @@ void Material::OnLoadAsset()
     EndLoadAssetBind
 
     Update();
+    UpdatePipelineState();
 }
 
 void Material::OnSaveAsset()
@@ -8,6 +8,7 @@
 #include "Function/Render/RenderResource/Texture.h"
 #include "Resource/Asset/Asset.h"
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 
@@ -62,9 +63,9 @@ public:
     void SetTexture2D(TextureRef texture, uint32_t index)   { texture2D[index] = texture;   Update(); } 
     void SetTextureCube(TextureRef texture, uint32_t index) { textureCube[index] = texture; Update(); } 
     void SetTexture3D(TextureRef texture, uint32_t index)   { texture3D[index] = texture;   Update(); } 
-    void SetVertexShader(ShaderRef shader)                  { vertexShader = shader; }
-    void SetGeometryShader(ShaderRef shader)                { geometryShader = shader; }
-    void SetFragmentShader(ShaderRef shader)                { fragmentShader = shader; }
+    void SetVertexShader(ShaderRef shader)                  { vertexShader = shader;      UpdatePipelineState(); }
+    void SetGeometryShader(ShaderRef shader)                { geometryShader = shader;    UpdatePipelineState(); }
+    void SetFragmentShader(ShaderRef shader)                { fragmentShader = shader;    UpdatePipelineState(); }
 
     inline Vec4 GetDiffuse() const                          { return this->diffuse; }
     inline Vec4 GetEmission() const                         { return this->emission; }
@@ -92,15 +93,19 @@ public:
     bool UseForDepthPass()                                  { return useForDepthPass; }
     bool CastShadow()                                       { return castShadow; }
 
-    void SetRenderQueue(uint32_t queue)                     { renderQueue = queue; }
-    void SetRenderPassMask(RenderPassMasks mask)            { renderPassMask = mask; }
-    void SetCullMode(RasterizerCullMode cull)               { cullMode = cull; }
-    void SetFillMode(RasterizerFillMode fill)               { fillMode = fill; }
-    void SetDepthTest(bool test)                            { depthTest = test;}
-    void SetDepthWrite(bool write)                          { depthWrite = write; }
-    void SetDepthCompare(CompareFunction compare)           { depthCompare = compare; }
-    void SetUseForDepthPass(bool use)                       { useForDepthPass = use; }
-    void SetCastShadow(bool shadow)                         { castShadow = shadow; }
+    void SetRenderQueue(uint32_t queue)                     { renderQueue = queue;        UpdatePipelineState(); }
+    void SetRenderPassMask(RenderPassMasks mask)            { renderPassMask = mask;      UpdatePipelineState(); }
+    void SetCullMode(RasterizerCullMode cull)               { cullMode = cull;            UpdatePipelineState(); }
+    void SetFillMode(RasterizerFillMode fill)               { fillMode = fill;            UpdatePipelineState(); }
+    void SetDepthTest(bool test)                            { depthTest = test;           UpdatePipelineState(); }
+    void SetDepthWrite(bool write)                          { depthWrite = write;         UpdatePipelineState(); }
+    void SetDepthCompare(CompareFunction compare)           { depthCompare = compare;     UpdatePipelineState(); }
+    void SetUseForDepthPass(bool use)                       { useForDepthPass = use;      UpdatePipelineState(); }
+    void SetCastShadow(bool shadow)                         { castShadow = shadow;        UpdatePipelineState(); }
+
+    // 任一材质的管线状态，着色器或pass掩码变化时递增，mesh pass据此判断是否需要重新合批
+    static uint32_t PipelineStateVersion()                  { return pipelineStateVersion.load(); }
+    static void UpdatePipelineState()                       { pipelineStateVersion.fetch_add(1); }
 
 protected:
     Vec4 diffuse = Vec4::Ones();
@@ -150,6 +155,8 @@ protected:
     MaterialInfo materialInfo;      // 提交给GPU的信息和下标ID
     uint32_t materialID;
 
+    static std::atomic<uint32_t> pipelineStateVersion;
+
 private:
     BeginSerailize()
     SerailizeBaseClass(Asset)
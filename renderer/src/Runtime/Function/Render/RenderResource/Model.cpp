@@ -2,16 +2,19 @@
 #include "Function/Render/RenderResource/Model.h"
 #include "Core/Log/log.h"
 #include "Core/Math/BoundingBox.h"
+#include "Core/Math/Hash.h"
 #include "Core/Math/Math.h"
 #include "Core/Mesh/Mesh.h"
 #include "Core/Mesh/TangentSpace.h"
 #include "Core/Mesh/MeshOptimizor/MeshOptimizor.h"
+#include "Core/Util/TimeScope.h"
 #include "Function/Global/EngineContext.h"
 #include "Function/Global/EngineThreadPool.h"
 #include "Function/Render/RHI/RHIStructs.h"
 #include "Function/Render/RenderResource/Buffer.h"
 #include "Function/Render/RenderResource/Texture.h"
 #include "Material.h"
+#include "ModelCache.h"
 #include "RenderStructs.h"
 #include "Resource/Asset/Asset.h"
 #include "assimp/defs.h"
@@ -20,14 +23,76 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <cstdio>
+#include <functional>
 #include <memory>
 #include <vector>
 
 CEREAL_REGISTER_TYPE(Model)
 CEREAL_REGISTER_POLYMORPHIC_RELATION(Asset, Model)
 
-CEREAL_REGISTER_TYPE(ModelCache)
-CEREAL_REGISTER_POLYMORPHIC_RELATION(Asset, ModelCache)
+// 单个submesh的全部cluster合并后的数据，和缓存文件中一个section的内容一致
+struct ClusterData
+{
+    Mesh mesh;
+    std::vector<MeshClusterInfo> clusterInfos;          // vertexID和indexID在上传时填充
+    std::vector<MeshClusterGroupInfo> clusterGroupInfos;    // clusterID为submesh内的局部下标
+    uint32_t lod0TriangleNum = 0;
+    uint32_t maxMipLevel = 0;
+
+    ClusterDataView View() const
+    {
+        ClusterDataView view = {};
+        view.vertexCount = mesh.position.size();
+        view.position = mesh.position.data();
+        view.normal = mesh.normal.empty() ? nullptr : mesh.normal.data();
+        view.tangent = mesh.tangent.empty() ? nullptr : mesh.tangent.data();
+        view.texCoord = mesh.texCoord.empty() ? nullptr : mesh.texCoord.data();
+        view.color = mesh.color.empty() ? nullptr : mesh.color.data();
+        view.indexCount = mesh.index.size();
+        view.index = mesh.index.data();
+        view.clusterCount = clusterInfos.size();
+        view.clusters = clusterInfos.data();
+        view.clusterGroupCount = clusterGroupInfos.size();
+        view.clusterGroups = clusterGroupInfos.empty() ? nullptr : clusterGroupInfos.data();
+        view.lod0TriangleNum = lod0TriangleNum;
+        view.maxMipLevel = maxMipLevel;
+        return view;
+    }
+};
+
+static void FlattenClusters(const std::vector<MeshClusterRef>& clusters, const std::vector<MeshClusterGroupRef>& clusterGroups, ClusterData& data)
+{
+    uint32_t indexOffset = 0;
+    for(auto& cluster : clusters)   // 把单个submesh的全部cluster合并到一个buffer里存储
+    {
+        data.mesh.Merge(*cluster->mesh.get());
+
+        data.clusterInfos.push_back({
+            .vertexID = 0,
+            .indexID = 0,
+            .indexOffset = indexOffset,
+            .lodError = cluster->lodError,
+            .sphere = cluster->sphereBound
+        });
+        indexOffset += cluster->mesh->index.size();
+
+        if(cluster->mipLevel == 0) data.lod0TriangleNum += cluster->mesh->TriangleNum();
+    }
+
+    for(auto& clusterGroup : clusterGroups)
+    {
+        MeshClusterGroupInfo groupInfo = {};
+        for(uint32_t j = 0; j < clusterGroup->clusters.size(); j++) groupInfo.clusterID[j] = clusterGroup->clusters[j];
+        groupInfo.clusterSize = clusterGroup->clusters.size();
+        groupInfo.parentLodError = clusterGroup->parentLodError;
+        groupInfo.mipLevel = clusterGroup->mipLevel;
+        groupInfo.sphere = clusterGroup->lodBound;
+
+        data.clusterGroupInfos.push_back(groupInfo);
+        data.maxMipLevel = std::max(data.maxMipLevel, clusterGroup->mipLevel);
+    }
+}
 
 Model::~Model()
 {
@@ -40,137 +105,114 @@ Model::~Model()
     }
 }
 
-void Model::OnLoadAsset()
+void Model::OnPrepareAsset()
 {
     BeginLoadAssetBind()
-    LoadAssetBind(ModelCache, cache)
     ResizeAssetArray(materials)
     LoadAssetArrayBind(Material, materials)
     EndLoadAssetBind
 
-    LoadFromFile(path);
+    // 首次导入时需要在ProcessMesh里创建材质和纹理，涉及GPU资源，留到OnLoadAsset在主线程完成
+    if(processSetting.loadMaterials)
+    {
+        if(materials.empty()) return;
+        for(auto& material : materials) if(!material) return;
+    }
+
+    LoadCpuData();
+    prepared = true;
+}
 
-    // 在读取模型数据后，分配GPU端的全部资源
-    for(uint32_t i = 0; i < submeshes.size(); i++)
+void Model::LoadCpuData()
+{
+    bool useCluster = processSetting.generateCluster || processSetting.generateVirtualMesh;
+    if(useCluster && processSetting.cacheCluster)
     {
-        VertexBufferRef vertexBuffer = std::make_shared<VertexBuffer>();
-        vertexBuffer->SetPosition(submeshes[i].mesh->position);
-        vertexBuffer->SetNormal(submeshes[i].mesh->normal);
-        vertexBuffer->SetTangent(submeshes[i].mesh->tangent);
-        vertexBuffer->SetTexCoord(submeshes[i].mesh->texCoord);
-        vertexBuffer->SetColor(submeshes[i].mesh->color);
-        vertexBuffer->SetBoneIndex(submeshes[i].mesh->boneIndex);
-        vertexBuffer->SetBoneWeight(submeshes[i].mesh->boneWeight);
-        submeshes[i].vertexBuffer = vertexBuffer;
-
-        IndexBufferRef indexBuffer = std::make_shared<IndexBuffer>();
-        indexBuffer->SetIndex(submeshes[i].mesh->index);
-        submeshes[i].indexBuffer = indexBuffer;
+        TimeScope timer;
+        timer.Begin();
+        cache = ModelCache::Load(CacheFilePath(), CacheSettingHash());
+        timer.End();
+
+        if(cache) ENGINE_LOG_INFO("Model cache mapped: [{}], size: {} KB, time: {} ms", CacheFilePath(), cache->Size() / 1024, timer.GetMilliSeconds());
     }
 
-    if(processSetting.generateCluster)
+    LoadFromFile(path);     // 缓存有效时不会构建cluster
+}
+
+void Model::OnLoadAsset()
+{
+    if(!prepared)           // 同步加载，或者异步加载时没能提前准备
+    {
+        BeginLoadAssetBind()
+        ResizeAssetArray(materials)
+        LoadAssetArrayBind(Material, materials)
+        EndLoadAssetBind
+
+        LoadCpuData();
+    }
+    prepared = false;
+
+    bool useCluster = processSetting.generateCluster || processSetting.generateVirtualMesh;
+    ModelCacheSectionType sectionType = processSetting.generateVirtualMesh ? MODEL_CACHE_SECTION_VIRTUAL_MESH : MODEL_CACHE_SECTION_CLUSTER;   // 同时开启时以虚拟几何体为准
+
+    // 在读取模型数据后，分配GPU端的全部资源
+    if(!useCluster)
     {
         for(uint32_t i = 0; i < submeshes.size(); i++)
         {
-            auto& submesh = submeshes[i];
-
-            uint32_t indexOffset = 0;
-            Mesh tempMesh = Mesh();             // 把单个submesh的全部cluster合并到一个buffer里存储
-            std::vector<MeshClusterInfo> meshClusterInfos;
             VertexBufferRef vertexBuffer = std::make_shared<VertexBuffer>();
-            IndexBufferRef indexBuffer = std::make_shared<IndexBuffer>();
+            vertexBuffer->SetPosition(submeshes[i].mesh->position);
+            vertexBuffer->SetNormal(submeshes[i].mesh->normal);
+            vertexBuffer->SetTangent(submeshes[i].mesh->tangent);
+            vertexBuffer->SetTexCoord(submeshes[i].mesh->texCoord);
+            vertexBuffer->SetColor(submeshes[i].mesh->color);
+            vertexBuffer->SetBoneIndex(submeshes[i].mesh->boneIndex);
+            vertexBuffer->SetBoneWeight(submeshes[i].mesh->boneWeight);
+            submeshes[i].vertexBuffer = vertexBuffer;
 
-            for(auto& cluster : submesh.clusters)  // cluster信息
-            {
-                tempMesh.Merge(*cluster->mesh.get());
-
-                meshClusterInfos.push_back({
-                    .vertexID = vertexBuffer->vertexID,
-                    .indexID = indexBuffer->indexID,
-                    .indexOffset = indexOffset,
-                    .lodError = cluster->lodError,
-                    .sphere = cluster->sphereBound
-                });
-                indexOffset += cluster->mesh->index.size();
-            }
-   
-            vertexBuffer->SetPosition(tempMesh.position);
-            vertexBuffer->SetNormal(tempMesh.normal);
-            vertexBuffer->SetTangent(tempMesh.tangent);
-            vertexBuffer->SetTexCoord(tempMesh.texCoord);
-            vertexBuffer->SetColor(tempMesh.color);
-            // vertexBuffer->SetBoneIndex(tempMesh.boneIndex);      // 不支持骨骼
-            // vertexBuffer->SetBoneWeight(tempMesh.boneWeight);
-            submesh.vertexBuffer = vertexBuffer;
-  
-            indexBuffer->SetIndex(tempMesh.index);
-            submesh.indexBuffer = indexBuffer;
-
-            submesh.meshClusterID = EngineContext::RenderResource()->AllocateMeshClusterID(meshClusterInfos.size());
-            EngineContext::RenderResource()->SetMeshClusterInfo(meshClusterInfos, submesh.meshClusterID.begin);
+            IndexBufferRef indexBuffer = std::make_shared<IndexBuffer>();
+            indexBuffer->SetIndex(submeshes[i].mesh->index);
+            submeshes[i].indexBuffer = indexBuffer;
         }
     }
 
     std::vector<uint32_t> lod0TriangleNums(submeshes.size());   // 对于虚拟几何体，构建加速结构使用的是第0层cluster的全部三角形
-    if(processSetting.generateVirtualMesh)
-    {   
+    if(useCluster)
+    {
+        std::vector<std::unique_ptr<ClusterData>> clusterDatas;    // 新构建的数据，写入缓存前需要保持有效
+        std::vector<ModelCacheSectionDesc> cacheSections;
+
+        totalClusterCnt = 0;
+        totalClusterMaxMip = 0;
         for(uint32_t i = 0; i < submeshes.size(); i++)
         {
             auto& submesh = submeshes[i];
+            uint32_t sourceVertexCount = submesh.mesh->position.size();
+            uint32_t sourceIndexCount = submesh.mesh->index.size();
 
-            uint32_t indexOffset = 0;
-            Mesh tempMesh = Mesh();             // 把单个submesh的全部cluster合并到一个buffer里存储
-            std::vector<MeshClusterInfo> meshClusterInfos;
-            std::vector<MeshClusterGroupInfo> meshClusterGroupInfos;
-            VertexBufferRef vertexBuffer = std::make_shared<VertexBuffer>();
-            IndexBufferRef indexBuffer = std::make_shared<IndexBuffer>();
-
-            lod0TriangleNums[i] = 0;
-            for(auto& cluster : submesh.virtualMesh->clusters)  // cluster信息
+            ClusterDataView data = {};
+            if(!cache || !cache->Find(i, sectionType, sourceVertexCount, sourceIndexCount, data))
             {
-                tempMesh.Merge(*cluster->mesh.get());
-
-                meshClusterInfos.push_back({
-                    .vertexID = vertexBuffer->vertexID,
-                    .indexID = indexBuffer->indexID,
-                    .indexOffset = indexOffset,
-                    .lodError = cluster->lodError,
-                    .sphere = cluster->sphereBound
-                });
-                indexOffset += cluster->mesh->index.size();
-
-                if(cluster->mipLevel == 0) lod0TriangleNums[i] += cluster->mesh->TriangleNum();
-            }
+                clusterDatas.push_back(std::make_unique<ClusterData>());
+                if(processSetting.generateVirtualMesh)  FlattenClusters(submesh.virtualMesh->clusters, submesh.virtualMesh->clusterGroups, *clusterDatas.back());
+                else                                    FlattenClusters(submesh.clusters, {}, *clusterDatas.back());
 
-            vertexBuffer->SetPosition(tempMesh.position);
-            vertexBuffer->SetNormal(tempMesh.normal);
-            vertexBuffer->SetTangent(tempMesh.tangent);
-            vertexBuffer->SetTexCoord(tempMesh.texCoord);
-            vertexBuffer->SetColor(tempMesh.color);
-            // vertexBuffer->SetBoneIndex(tempMesh.boneIndex);      // 不支持骨骼
-            // vertexBuffer->SetBoneWeight(tempMesh.boneWeight);
-            submesh.vertexBuffer = vertexBuffer;
-  
-            indexBuffer->SetIndex(tempMesh.index);
-            submesh.indexBuffer = indexBuffer;
-
-            submesh.meshClusterID = EngineContext::RenderResource()->AllocateMeshClusterID(meshClusterInfos.size());
-            EngineContext::RenderResource()->SetMeshClusterInfo(meshClusterInfos, submesh.meshClusterID.begin);
-
-            for(auto& clusterGroup : submesh.virtualMesh->clusterGroups)    // cluster group信息
-            {
-                MeshClusterGroupInfo groupInfo = {};
-                for(uint32_t j = 0; j < clusterGroup->clusters.size(); j++) groupInfo.clusterID[j] = clusterGroup->clusters[j] + submesh.meshClusterID.begin;  // 本地偏移加全局偏移
-                groupInfo.clusterSize = clusterGroup->clusters.size();
-                groupInfo.parentLodError = clusterGroup->parentLodError;
-                groupInfo.mipLevel = clusterGroup->mipLevel;
-                groupInfo.sphere = clusterGroup->lodBound;
-
-                meshClusterGroupInfos.push_back(groupInfo);
+                data = clusterDatas.back()->View();
+                cacheSections.push_back({ i, sectionType, sourceVertexCount, sourceIndexCount, data });
             }
+            UploadClusterData(submesh, data);
 
-            submesh.meshClusterGroupID = EngineContext::RenderResource()->AllocateMeshClusterGroupID(meshClusterGroupInfos.size());
-            EngineContext::RenderResource()->SetMeshClusterGroupInfo(meshClusterGroupInfos, submesh.meshClusterGroupID.begin);
+            lod0TriangleNums[i] = data.lod0TriangleNum;
+            totalClusterCnt += data.clusterCount;
+            totalClusterMaxMip = std::max(totalClusterMaxMip, data.maxMipLevel);
+        }
+        ENGINE_LOG_INFO("Mesh cluster load success. total clusters: {}, max miplevel: {}", totalClusterCnt, totalClusterMaxMip);
+
+        cache = nullptr;    // 数据都已经拷贝到GPU端，释放映射；后面重写缓存文件前也必须先释放
+
+        if(processSetting.cacheCluster && !cacheSections.empty())
+        {
+            if(!ModelCache::Save(CacheFilePath(), CacheSettingHash(), cacheSections)) ENGINE_LOG_WARN("Failed to save model cache [{}]", CacheFilePath());
         }
     }
 
@@ -196,32 +238,69 @@ void Model::OnLoadAsset()
 
 void Model::OnSaveAsset()
 {
-    if(processSetting.cacheCluster)
-    {
-        if(!cache) cache = std::make_shared<ModelCache>();
-        cache->submeshes.clear();
-        cache->submeshes.resize(submeshes.size());
-        for(uint32_t i = 0; i < submeshes.size(); i++)
-        {
-            cache->submeshes[i].clusters = submeshes[i].clusters;
-            cache->submeshes[i].virtualMesh = submeshes[i].virtualMesh;
-        }
-        if(EngineContext::Asset()->UIDToFilePath(cache->GetUID()).empty())    // 路径为空说明cache还没有保存到文件过，手动保存一下
-        {
-            std::string modelPath = EngineContext::Asset()->UIDToFilePath(this->GetUID());
-            assert(!modelPath.empty());
-
-            //ENGINE_LOG_INFO("Saving model cache {} ...", EngineContext::File()->ReplaceExtension(modelPath, ".modelCache.binasset"));
-            EngineContext::Asset()->SaveAsset(cache, EngineContext::File()->ReplaceExtension(modelPath, ".modelCache.binasset"));
-        }   
-    }
-
     BeginSaveAssetBind()
-    SaveAssetBind(cache)
     SaveAssetArrayBind(materials)
     EndSaveAssetBind
 }
 
+std::string Model::CacheFilePath()
+{
+    // 按模型文件路径区分，同一个模型文件的不同导入设置共用一个缓存文件，设置变化时覆盖
+    char pathHash[16];
+    snprintf(pathHash, sizeof(pathHash), "%08zx", std::hash<std::string>{}(path) & 0xFFFFFFFF);
+
+    return EngineContext::File()->CachePath() + EngineContext::File()->Basename(path) + "_" + pathHash + ".modelcache";
+}
+
+uint32_t Model::CacheSettingHash()
+{
+    // 影响cluster生成结果的导入设置，以及源文件的修改时间
+    uint32_t settingBits =  (processSetting.smoothNormal << 0) |
+                            (processSetting.flipUV << 1) |
+                            (processSetting.tangentSpace << 2) |
+                            (processSetting.generateCluster << 3) |
+                            (processSetting.generateVirtualMesh << 4);
+
+    uint32_t timeHash = std::hash<std::string>{}(EngineContext::File()->ModifiedTime(path));
+    return Hash(settingBits, timeHash);
+}
+
+void Model::UploadClusterData(SubmeshData& submesh, const ClusterDataView& data)
+{
+    VertexBufferRef vertexBuffer = std::make_shared<VertexBuffer>();
+    IndexBufferRef indexBuffer = std::make_shared<IndexBuffer>();
+
+    vertexBuffer->SetPosition(data.position, data.vertexCount);
+    if(data.normal)     vertexBuffer->SetNormal(data.normal, data.vertexCount);
+    if(data.tangent)    vertexBuffer->SetTangent(data.tangent, data.vertexCount);
+    if(data.texCoord)   vertexBuffer->SetTexCoord(data.texCoord, data.vertexCount);
+    if(data.color)      vertexBuffer->SetColor(data.color, data.vertexCount);
+    // 不支持骨骼
+    submesh.vertexBuffer = vertexBuffer;
+
+    indexBuffer->SetIndex(data.index, data.indexCount);
+    submesh.indexBuffer = indexBuffer;
+
+    std::vector<MeshClusterInfo> meshClusterInfos(data.clusters, data.clusters + data.clusterCount);
+    for(auto& info : meshClusterInfos)
+    {
+        info.vertexID = vertexBuffer->vertexID;
+        info.indexID = indexBuffer->indexID;
+    }
+    submesh.meshClusterID = EngineContext::RenderResource()->AllocateMeshClusterID(meshClusterInfos.size());
+    EngineContext::RenderResource()->SetMeshClusterInfo(meshClusterInfos, submesh.meshClusterID.begin);
+
+    if(data.clusterGroupCount == 0) return;
+
+    std::vector<MeshClusterGroupInfo> meshClusterGroupInfos(data.clusterGroups, data.clusterGroups + data.clusterGroupCount);
+    for(auto& info : meshClusterGroupInfos)
+    {
+        for(uint32_t j = 0; j < info.clusterSize; j++) info.clusterID[j] += submesh.meshClusterID.begin;   // 本地偏移加全局偏移
+    }
+    submesh.meshClusterGroupID = EngineContext::RenderResource()->AllocateMeshClusterGroupID(meshClusterGroupInfos.size());
+    EngineContext::RenderResource()->SetMeshClusterGroupInfo(meshClusterGroupInfos, submesh.meshClusterGroupID.begin);
+}
+
 Model::Model(std::string path, ModelProcessSetting processSetting)
 : path(path)
 , processSetting(processSetting)
@@ -269,7 +348,41 @@ bool Model::LoadFromFile(std::string path)
     // EngineContext::ThreadPool()->WaitAllIdle();
     textureMap.clear();
 
-    // 统计信息
+    // cluster和虚拟几何体的构建只依赖各自的mesh，子mesh之间并行，子mesh内的图划分和同层的group之间也并行
+    // 缓存文件只能整体重写，缺少任意一个submesh的数据时全部重新构建
+    if(processSetting.generateCluster || processSetting.generateVirtualMesh)
+    {
+        ModelCacheSectionType sectionType = processSetting.generateVirtualMesh ? MODEL_CACHE_SECTION_VIRTUAL_MESH : MODEL_CACHE_SECTION_CLUSTER;
+        for(uint32_t i = 0; cache && i < submeshes.size(); i++)
+        {
+            ClusterDataView data;
+            if(!cache->Find(i, sectionType, submeshes[i].mesh->position.size(), submeshes[i].mesh->index.size(), data))
+            {
+                ENGINE_LOG_INFO("Model cache is out of date, rebuilding clusters...");
+                cache = nullptr;
+            }
+        }
+
+        if(!cache)
+        {
+            QueuedThreadPoolRef threadPool = EngineContext::ThreadPool()->GetThreadPool(ENGINE_THREAD_TYPE_ASSET);
+            threadPool->ParallelFor(submeshes.size(), [&](uint32_t i) {
+                auto& submesh = submeshes[i];
+                if(processSetting.generateVirtualMesh)
+                {
+                    submesh.virtualMesh = std::make_shared<VirtualMesh>();
+                    submesh.virtualMesh->Build(submesh.mesh, threadPool);
+                }
+                else 
+                {
+                    ClusterTriangles(submesh.mesh, submesh.clusters, threadPool);
+                    for (auto& cluster : submesh.clusters) cluster->FixSize();
+                }
+            });
+        }
+    }
+
+    // 统计信息，cluster数目在上传时统计
     totalIndex = 0;
     totalVertex = 0;
     for(auto& submesh : submeshes)
@@ -277,29 +390,6 @@ bool Model::LoadFromFile(std::string path)
         totalIndex += submesh.mesh->index.size();
         totalVertex += submesh.mesh->position.size();
     }
-    if(processSetting.generateCluster)
-    {
-        totalClusterCnt = 0;
-        for(auto& submesh : submeshes)
-        {   
-            totalClusterCnt += submesh.clusters.size();
-        }
-        ENGINE_LOG_INFO("Mesh cluster build success. total clusters: {}", totalClusterCnt);
-    }
-    if(processSetting.generateVirtualMesh)
-    {
-        totalClusterCnt = 0;
-        totalClusterMaxMip = 0;
-        for(auto& submesh : submeshes)
-        {   
-            for(auto& clusterGroup : submesh.virtualMesh->clusterGroups)
-            {
-                totalClusterMaxMip = std::max(totalClusterMaxMip, clusterGroup->mipLevel);
-            }
-            totalClusterCnt += submesh.virtualMesh->clusters.size();
-        }
-        ENGINE_LOG_INFO("Virtual mesh build success. total clusters: {}, max miplevel: {}", totalClusterCnt, totalClusterMaxMip);
-    }
 
     return true;
 }
@@ -525,50 +615,6 @@ void Model::ProcessMesh(aiMesh* mesh, const aiScene* scene, int index)
 
     // 添加到mesh asset
     submeshes[index].mesh = submesh;
-
-    // 处理分簇
-    if (processSetting.generateCluster)
-    {
-        if( processSetting.cacheCluster &&
-            cache && 
-            cache->submeshes.size() > index && 
-            cache->submeshes[index].clusters.size() > 0) //使用缓存
-        {
-            ENGINE_LOG_INFO("Loading mesh cluster from cache...");
-            submeshes[index].clusters = cache->submeshes[index].clusters;
-        }
-        else 
-        {
-            ClusterTriangles(submeshes[index].mesh, submeshes[index].clusters);
-        }
-
-        for (auto& cluster : submeshes[index].clusters) cluster->FixSize();
-    }
-
-    // 处理虚拟几何体
-    if(processSetting.generateVirtualMesh)
-    {
-        if( processSetting.cacheCluster && 
-            cache && 
-            cache->submeshes.size() > index && 
-            cache->submeshes[index].virtualMesh) //使用缓存
-        {
-            ENGINE_LOG_INFO("Loading virtual mesh from cache...");
-            submeshes[index].virtualMesh = cache->submeshes[index].virtualMesh;
-        }
-        else 
-        {
-            // submeshes[index].mesh->normal.clear();
-            // submeshes[index].mesh->tangent.clear();
-            // submeshes[index].mesh->texCoord.clear();
-            // submeshes[index].mesh->color.clear();
-            // submeshes[index].mesh->boneIndex.clear();
-            // submeshes[index].mesh->boneWeight.clear();
-
-            submeshes[index].virtualMesh = std::make_shared<VirtualMesh>();
-            submeshes[index].virtualMesh->Build(submeshes[index].mesh);
-        }
-    }
 }
 
 void Model::ExtractBoneWeights(Mesh* submesh, aiMesh* mesh, const aiScene* scene)
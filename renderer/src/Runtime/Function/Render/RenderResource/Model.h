@@ -9,6 +9,7 @@
 #include "Function/Render/RenderResource/Buffer.h"
 #include "Function/Render/RenderResource/Texture.h"
 #include "Material.h"
+#include "ModelCache.h"
 #include "Resource/Asset/Asset.h"
 
 #include <assimp/Importer.hpp>
@@ -22,30 +23,6 @@
 #include <unordered_map>
 #include <vector>
 
-struct CachedSubmeshData
-{
-    std::vector<MeshClusterRef> clusters;                     
-    std::shared_ptr<VirtualMesh> virtualMesh;    
-
-private:
-    BeginSerailize()
-    SerailizeEntry(clusters)
-    SerailizeEntry(virtualMesh)
-    EndSerailize
-};
-
-class ModelCache : public Asset
-{
-public:
-    std::vector<CachedSubmeshData> submeshes;
-
-private:
-    BeginSerailize()
-    SerailizeBaseClass(Asset)
-    SerailizeEntry(submeshes)
-    EndSerailize              
-};
-
 typedef struct ModelProcessSetting
 {
     bool smoothNormal = false;                  // 生成平滑法线
@@ -55,7 +32,7 @@ typedef struct ModelProcessSetting
     bool generateBVH = false;                   // 生成BVH
     bool generateCluster = false;               // 生成Cluster
     bool generateVirtualMesh = false;           // 生成虚拟几何体
-    bool cacheCluster = false;                  // 对于虚拟几何体和Cluster做缓存，只需要生成一次
+    bool cacheCluster = false;                  // 对于虚拟几何体和Cluster做缓存，只需要生成一次，缓存文件在Asset/Cache下
     bool forcePngTexture = false;               // 强制纹理使用.png后缀（目前不支持部分纹理格式，自己手动处理生成png文件）
 
 private:
@@ -79,8 +56,8 @@ struct SubmeshData
     Vec3 scale;                                                 // 对应的缩放向量
 
     std::shared_ptr<Mesh> mesh;                                 // CPU端的mesh和cluster信息
-    std::vector<MeshClusterRef> clusters;                       // 仅生成cluster时的信息
-    std::shared_ptr<VirtualMesh> virtualMesh;                   // 生成cluster + cluster group时的信息
+    std::vector<MeshClusterRef> clusters;                       // 仅生成cluster时的信息，从缓存读取时为空
+    std::shared_ptr<VirtualMesh> virtualMesh;                   // 生成cluster + cluster group时的信息，从缓存读取时为空
 
     VertexBufferRef vertexBuffer;                               // GPU端的顶点和索引缓冲，既可能存储单个submesh的全部顶点和索引，也可能存储其全部cluster合并后的数据
     IndexBufferRef indexBuffer;
@@ -101,6 +78,7 @@ public:
     virtual std::string GetAssetTypeName() override 		    { return "Model Asset"; }
     virtual AssetType GetAssetType() override                   { return ASSET_TYPE_MODEL; }
 
+    virtual void OnPrepareAsset() override;
     virtual void OnLoadAsset() override;
     virtual void OnSaveAsset() override;
 
@@ -118,6 +96,7 @@ public:
     const SubmeshData& Submesh(uint32_t subMeshIndex)           { return submeshes[subMeshIndex]; }
 
 protected:
+    void LoadCpuData();                                     // 读取模型文件和cluster缓存，构建cluster，不涉及GPU资源
     bool LoadFromFile(std::string path);
     void ProcessNode(aiNode* node, const aiScene* scene, std::vector<aiMesh*>& processMeshes, aiMatrix4x4 mat);
     void ProcessMesh(aiMesh* mesh, const aiScene* scene, int index);
@@ -125,9 +104,14 @@ protected:
     void ExtractBoneWeights(Mesh* submesh, aiMesh* mesh, const aiScene* scene);
     std::shared_ptr<Texture> LoadMaterialTexture(aiMaterial* mat, aiTextureType type);
 
+    std::string CacheFilePath();
+    uint32_t CacheSettingHash();
+    void UploadClusterData(SubmeshData& submesh, const ClusterDataView& data);
+
     std::vector<SubmeshData> submeshes;
     std::vector<MaterialRef> materials;
-    std::shared_ptr<ModelCache> cache;
+    ModelCacheRef cache;                                    // 映射的cluster缓存文件，加载完成后释放
+    bool prepared = false;                                  // 异步加载时CPU端数据已经在工作线程上准备好
 
     std::string path;
     ModelProcessSetting processSetting;
@@ -0,0 +1,197 @@
+#include "ModelCache.h"
+
+#include "Function/Global/EngineContext.h"
+#include "Platform/File/FileSystem.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+static const uint64_t MODEL_CACHE_ALIGNMENT = 16;
+
+static inline uint64_t AlignUp(uint64_t offset)
+{
+    return (offset + MODEL_CACHE_ALIGNMENT - 1) & ~(MODEL_CACHE_ALIGNMENT - 1);
+}
+
+// 数组在文件内的范围是否合法
+static inline bool CheckRange(uint64_t offset, uint64_t count, uint64_t stride, uint64_t fileSize)
+{
+    if(count == 0) return true;
+    if(offset == 0 || offset % MODEL_CACHE_ALIGNMENT != 0) return false;
+    return offset <= fileSize && count * stride <= fileSize - offset;
+}
+
+template<typename Type>
+static inline const Type* GetArray(const uint8_t* data, uint64_t offset)
+{
+    return offset == 0 ? nullptr : reinterpret_cast<const Type*>(data + offset);
+}
+
+std::shared_ptr<ModelCache> ModelCache::Load(const std::string& path, uint32_t settingHash)
+{
+    MappedFileRef file = EngineContext::File()->MapBinary(path);
+    if(!file || file->Size() < sizeof(ModelCacheHeader)) return nullptr;
+
+    const ModelCacheHeader* header = reinterpret_cast<const ModelCacheHeader*>(file->Data());
+    if( header->magic != MODEL_CACHE_MAGIC ||
+        header->version != MODEL_CACHE_VERSION ||
+        header->settingHash != settingHash ||
+        header->clusterTriangleSize != CLUSTER_TRIANGLE_SIZE ||
+        header->clusterGroupSize != CLUSTER_GROUP_SIZE ||
+        header->fileSize != file->Size()) return nullptr;
+
+    uint64_t fileSize = file->Size();
+    if(sizeof(ModelCacheHeader) + (uint64_t)header->sectionCount * sizeof(ModelCacheSection) > fileSize) return nullptr;
+
+    const ModelCacheSection* sections = reinterpret_cast<const ModelCacheSection*>(file->Data() + sizeof(ModelCacheHeader));
+    for(uint32_t i = 0; i < header->sectionCount; i++)  // 只在打开时检查一次，之后的访问都不再检查
+    {
+        const ModelCacheSection& section = sections[i];
+        if( section.type >= MODEL_CACHE_SECTION_MAX_ENUM ||
+            section.positionOffset == 0 ||
+            !CheckRange(section.positionOffset, section.vertexCount, sizeof(Vec3), fileSize) ||
+            !CheckRange(section.normalOffset, section.normalOffset ? section.vertexCount : 0, sizeof(Vec3), fileSize) ||
+            !CheckRange(section.tangentOffset, section.tangentOffset ? section.vertexCount : 0, sizeof(Vec4), fileSize) ||
+            !CheckRange(section.texCoordOffset, section.texCoordOffset ? section.vertexCount : 0, sizeof(Vec2), fileSize) ||
+            !CheckRange(section.colorOffset, section.colorOffset ? section.vertexCount : 0, sizeof(Vec3), fileSize) ||
+            !CheckRange(section.indexOffset, section.indexCount, sizeof(uint32_t), fileSize) ||
+            !CheckRange(section.clusterOffset, section.clusterCount, sizeof(MeshClusterInfo), fileSize) ||
+            !CheckRange(section.clusterGroupOffset, section.clusterGroupCount, sizeof(MeshClusterGroupInfo), fileSize)) return nullptr;
+    }
+
+    std::shared_ptr<ModelCache> cache = std::make_shared<ModelCache>();
+    cache->file = file;
+    cache->header = header;
+    cache->sections = sections;
+    return cache;
+}
+
+bool ModelCache::Save(const std::string& path, uint32_t settingHash, const std::vector<ModelCacheSectionDesc>& sectionDescs)
+{
+    // 先计算全部偏移，再顺序写出
+    std::vector<ModelCacheSection> sections(sectionDescs.size());
+    uint64_t offset = AlignUp(sizeof(ModelCacheHeader) + sections.size() * sizeof(ModelCacheSection));
+    auto allocate = [&](const void* data, uint64_t size) -> uint64_t {
+        if(!data || size == 0) return 0;
+        uint64_t begin = offset;
+        offset = AlignUp(offset + size);
+        return begin;
+    };
+
+    for(uint32_t i = 0; i < sectionDescs.size(); i++)
+    {
+        const ModelCacheSectionDesc& desc = sectionDescs[i];
+        const ClusterDataView& data = desc.data;
+        ModelCacheSection& section = sections[i];
+
+        section = {};
+        section.submeshIndex = desc.submeshIndex;
+        section.type = desc.type;
+        section.sourceVertexCount = desc.sourceVertexCount;
+        section.sourceIndexCount = desc.sourceIndexCount;
+        section.vertexCount = data.vertexCount;
+        section.indexCount = data.indexCount;
+        section.clusterCount = data.clusterCount;
+        section.clusterGroupCount = data.clusterGroupCount;
+        section.lod0TriangleNum = data.lod0TriangleNum;
+        section.maxMipLevel = data.maxMipLevel;
+
+        section.positionOffset = allocate(data.position, data.vertexCount * sizeof(Vec3));
+        section.normalOffset = allocate(data.normal, data.vertexCount * sizeof(Vec3));
+        section.tangentOffset = allocate(data.tangent, data.vertexCount * sizeof(Vec4));
+        section.texCoordOffset = allocate(data.texCoord, data.vertexCount * sizeof(Vec2));
+        section.colorOffset = allocate(data.color, data.vertexCount * sizeof(Vec3));
+        section.indexOffset = allocate(data.index, data.indexCount * sizeof(uint32_t));
+        section.clusterOffset = allocate(data.clusters, data.clusterCount * sizeof(MeshClusterInfo));
+        section.clusterGroupOffset = allocate(data.clusterGroups, data.clusterGroupCount * sizeof(MeshClusterGroupInfo));
+
+        if(section.positionOffset == 0) return false;
+    }
+
+    ModelCacheHeader header = {};
+    header.magic = MODEL_CACHE_MAGIC;
+    header.version = MODEL_CACHE_VERSION;
+    header.settingHash = settingHash;
+    header.clusterTriangleSize = CLUSTER_TRIANGLE_SIZE;
+    header.clusterGroupSize = CLUSTER_GROUP_SIZE;
+    header.sectionCount = sections.size();
+    header.fileSize = offset;
+
+    std::string dir = EngineContext::File()->RemoveFilename(path);
+    if(!dir.empty() && !EngineContext::File()->Exists(dir)) EngineContext::File()->CreateDir(dir, true);
+
+    std::ofstream out(EngineContext::File()->Absolute(path), std::ios::binary | std::ios::trunc);
+    if(!out.is_open()) return false;
+
+    uint64_t written = 0;
+    auto write = [&](const void* data, uint64_t size, uint64_t at) {
+        static const char zeros[MODEL_CACHE_ALIGNMENT] = {};
+        while(written < at)     // 对齐填充
+        {
+            uint64_t pad = std::min<uint64_t>(at - written, MODEL_CACHE_ALIGNMENT);
+            out.write(zeros, pad);
+            written += pad;
+        }
+        out.write(reinterpret_cast<const char*>(data), size);
+        written += size;
+    };
+
+    write(&header, sizeof(ModelCacheHeader), 0);
+    write(sections.data(), sections.size() * sizeof(ModelCacheSection), sizeof(ModelCacheHeader));
+    for(uint32_t i = 0; i < sections.size(); i++)   // 和上面分配偏移的顺序一致
+    {
+        const ClusterDataView& data = sectionDescs[i].data;
+        const ModelCacheSection& section = sections[i];
+
+        if(section.positionOffset)      write(data.position, data.vertexCount * sizeof(Vec3), section.positionOffset);
+        if(section.normalOffset)        write(data.normal, data.vertexCount * sizeof(Vec3), section.normalOffset);
+        if(section.tangentOffset)       write(data.tangent, data.vertexCount * sizeof(Vec4), section.tangentOffset);
+        if(section.texCoordOffset)      write(data.texCoord, data.vertexCount * sizeof(Vec2), section.texCoordOffset);
+        if(section.colorOffset)         write(data.color, data.vertexCount * sizeof(Vec3), section.colorOffset);
+        if(section.indexOffset)         write(data.index, data.indexCount * sizeof(uint32_t), section.indexOffset);
+        if(section.clusterOffset)       write(data.clusters, data.clusterCount * sizeof(MeshClusterInfo), section.clusterOffset);
+        if(section.clusterGroupOffset)  write(data.clusterGroups, data.clusterGroupCount * sizeof(MeshClusterGroupInfo), section.clusterGroupOffset);
+    }
+    write(nullptr, 0, offset);
+
+    return out.good();
+}
+
+bool ModelCache::Find(  uint32_t submeshIndex,
+                        ModelCacheSectionType type,
+                        uint32_t sourceVertexCount,
+                        uint32_t sourceIndexCount,
+                        ClusterDataView& view) const
+{
+    const uint8_t* data = file->Data();
+    for(uint32_t i = 0; i < header->sectionCount; i++)
+    {
+        const ModelCacheSection& section = sections[i];
+        if( section.submeshIndex != submeshIndex ||
+            section.type != type) continue;
+        if( section.sourceVertexCount != sourceVertexCount ||
+            section.sourceIndexCount != sourceIndexCount) return false;
+
+        view = {};
+        view.vertexCount = section.vertexCount;
+        view.position = GetArray<Vec3>(data, section.positionOffset);
+        view.normal = GetArray<Vec3>(data, section.normalOffset);
+        view.tangent = GetArray<Vec4>(data, section.tangentOffset);
+        view.texCoord = GetArray<Vec2>(data, section.texCoordOffset);
+        view.color = GetArray<Vec3>(data, section.colorOffset);
+        view.indexCount = section.indexCount;
+        view.index = GetArray<uint32_t>(data, section.indexOffset);
+        view.clusterCount = section.clusterCount;
+        view.clusters = GetArray<MeshClusterInfo>(data, section.clusterOffset);
+        view.clusterGroupCount = section.clusterGroupCount;
+        view.clusterGroups = GetArray<MeshClusterGroupInfo>(data, section.clusterGroupOffset);
+        view.lod0TriangleNum = section.lod0TriangleNum;
+        view.maxMipLevel = section.maxMipLevel;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Core/Math/Math.h"
+#include "Function/Render/RenderResource/RenderStructs.h"
+#include "Platform/File/MappedFile.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// cluster和虚拟几何体的二进制缓存，文件直接内存映射使用，读取时不需要反序列化和重建任何对象
+// 文件布局：[ModelCacheHeader][ModelCacheSection * sectionCount][数据区]
+// 每个section对应一个submesh的一种cluster数据，数据区内的各数组按16字节对齐，偏移量都相对文件起始
+
+#define MODEL_CACHE_MAGIC 0x434D5254        // "TRMC"
+#define MODEL_CACHE_VERSION 1
+
+enum ModelCacheSectionType
+{
+    MODEL_CACHE_SECTION_CLUSTER = 0,        // 仅生成cluster
+    MODEL_CACHE_SECTION_VIRTUAL_MESH,       // cluster + cluster group
+
+    MODEL_CACHE_SECTION_MAX_ENUM,   //
+};
+
+typedef struct ModelCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t settingHash;                   // 影响生成结果的导入设置和源文件信息
+    uint32_t clusterTriangleSize;           // 和当前的CLUSTER_TRIANGLE_SIZE，CLUSTER_GROUP_SIZE不一致时缓存失效
+    uint32_t clusterGroupSize;
+    uint32_t sectionCount;
+    uint64_t fileSize;                      // 用于检查文件是否写入完整
+
+} ModelCacheHeader;
+
+typedef struct ModelCacheSection
+{
+    uint32_t submeshIndex;
+    uint32_t type;                          // ModelCacheSectionType
+    uint32_t sourceVertexCount;             // 生成缓存时原始submesh的规模，用于校验
+    uint32_t sourceIndexCount;
+
+    uint32_t vertexCount;                   // 全部cluster合并后的顶点和索引数目
+    uint32_t indexCount;
+    uint32_t clusterCount;
+    uint32_t clusterGroupCount;
+    uint32_t lod0TriangleNum;               // 第0层cluster的三角形总数
+    uint32_t maxMipLevel;
+
+    uint64_t positionOffset;                // 各顶点通道，为0表示不存在
+    uint64_t normalOffset;
+    uint64_t tangentOffset;
+    uint64_t texCoordOffset;
+    uint64_t colorOffset;
+    uint64_t indexOffset;
+    uint64_t clusterOffset;                 // MeshClusterInfo数组，vertexID和indexID为0，上传时再填充
+    uint64_t clusterGroupOffset;            // MeshClusterGroupInfo数组，clusterID为submesh内的局部下标
+
+} ModelCacheSection;
+
+// 单个section的数据视图，既可以指向映射的缓存文件，也可以指向内存中刚生成的数据
+typedef struct ClusterDataView
+{
+    uint32_t vertexCount = 0;
+    const Vec3* position = nullptr;
+    const Vec3* normal = nullptr;
+    const Vec4* tangent = nullptr;
+    const Vec2* texCoord = nullptr;
+    const Vec3* color = nullptr;
+
+    uint32_t indexCount = 0;
+    const uint32_t* index = nullptr;
+
+    uint32_t clusterCount = 0;
+    const MeshClusterInfo* clusters = nullptr;
+
+    uint32_t clusterGroupCount = 0;
+    const MeshClusterGroupInfo* clusterGroups = nullptr;
+
+    uint32_t lod0TriangleNum = 0;
+    uint32_t maxMipLevel = 0;
+
+} ClusterDataView;
+
+typedef struct ModelCacheSectionDesc
+{
+    uint32_t submeshIndex;
+    ModelCacheSectionType type;
+    uint32_t sourceVertexCount;
+    uint32_t sourceIndexCount;
+    ClusterDataView data;
+
+} ModelCacheSectionDesc;
+
+class ModelCache
+{
+public:
+    static std::shared_ptr<ModelCache> Load(const std::string& path, uint32_t settingHash);     // 文件不存在或校验失败时返回nullptr
+    static bool Save(const std::string& path, uint32_t settingHash, const std::vector<ModelCacheSectionDesc>& sections);
+
+    bool Find(  uint32_t submeshIndex,
+                ModelCacheSectionType type,
+                uint32_t sourceVertexCount,
+                uint32_t sourceIndexCount,
+                ClusterDataView& view) const;
+
+    inline uint64_t Size() const            { return file->Size(); }
+
+private:
+    MappedFileRef file;
+    const ModelCacheHeader* header = nullptr;
+    const ModelCacheSection* sections = nullptr;
+};
+typedef std::shared_ptr<ModelCache> ModelCacheRef;
@@ -0,0 +1,76 @@
+#include "ObjectInfoBatch.h"
+#include "Core/Math/Math.h"
+#include "Function/Global/EngineContext.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+void ObjectInfoBatch::Clear()
+{
+    transforms.Clear();
+    recomputeItems.clear();
+    uploadItems.clear();
+}
+
+ObjectInfoBatch::Range ObjectInfoBatch::Allocate(uint32_t recomputeSize, uint32_t uploadSize)
+{
+    Range range;
+    range.batch = this;
+    range.recomputeIndex = recomputeItems.size();
+    range.recomputeEnd = range.recomputeIndex + recomputeSize;
+    range.uploadIndex = uploadItems.size();
+    range.uploadEnd = range.uploadIndex + uploadSize;
+
+    recomputeItems.resize(range.recomputeEnd);
+    uploadItems.resize(range.uploadEnd);
+    transforms.Resize(range.recomputeEnd);
+    return range;
+}
+
+void ObjectInfoBatch::Range::Add(ObjectInfo* info, uint32_t objectID)
+{
+    assert(uploadIndex < uploadEnd);
+    batch->uploadItems[uploadIndex++] = { info, objectID };
+}
+
+void ObjectInfoBatch::Range::Add(ObjectInfo* info, uint32_t objectID, const Mat4& model, const Mat4& invModel, const Mat4& local, const Mat4& localInv)
+{
+    assert(recomputeIndex < recomputeEnd);
+    info->prevModel = info->model;
+    batch->transforms.Set(recomputeIndex, model, invModel, local, localInv, &info->model, &info->invModel);
+    batch->recomputeItems[recomputeIndex++] = { info, objectID };
+}
+
+void ObjectInfoBatch::Execute(ObjectInfo* dst)
+{
+    ENGINE_TIME_SCOPE(ObjectInfoBatch::Execute);
+
+    uint32_t recomputeChunks = Math::CeilDivide(recomputeItems.size(), CHUNK_SIZE);
+    uint32_t uploadChunks = Math::CeilDivide(uploadItems.size(), CHUNK_SIZE);
+    if(recomputeChunks + uploadChunks == 0) return;
+
+    // 每个任务写入的物体ID互不重叠，整块拷贝ObjectInfo，对写合并内存更友好
+    auto upload = [dst](const std::vector<Item>& items, uint32_t begin, uint32_t end) {
+        for(uint32_t i = begin; i < end; i++)
+        {
+            if(items[i].info) memcpy(dst + items[i].objectID, items[i].info, sizeof(ObjectInfo));     // 分配了但没有填写的项跳过
+        }
+    };
+
+    EngineContext::ThreadPool()->ParallelFor(recomputeChunks + uploadChunks, [&](uint32_t chunk) {
+        if(chunk < recomputeChunks)
+        {
+            uint32_t begin = chunk * CHUNK_SIZE;
+            uint32_t end = std::min(begin + CHUNK_SIZE, (uint32_t)recomputeItems.size());
+            transforms.Compute(begin, end);
+            upload(recomputeItems, begin, end);
+        }
+        else 
+        {
+            uint32_t begin = (chunk - recomputeChunks) * CHUNK_SIZE;
+            uint32_t end = std::min(begin + CHUNK_SIZE, (uint32_t)uploadItems.size());
+            upload(uploadItems, begin, end);
+        }
+    });
+}
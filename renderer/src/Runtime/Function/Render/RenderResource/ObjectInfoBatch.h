@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Core/Math/Math.h"
+#include "Core/Math/TransformBatch.h"
+#include "RenderStructs.h"
+
+#include <cstdint>
+#include <vector>
+
+// 一帧内需要上传的物体信息，由RenderMeshManager从标脏的Drawable收集后统一执行
+// 收集前先串行为每个Drawable分配一段连续的项（Range），各个Range再分块并行填写，填写不满的项在执行时跳过
+// 需要重新计算的项把变换放进TransformBatch，分块并行计算model/invModel，算完直接写入持久映射的物体缓冲
+// info指向Drawable自己持有的物体信息缓存，执行前不能被释放
+class ObjectInfoBatch
+{
+public:
+    class Range
+    {
+    public:
+        void Add(ObjectInfo* info, uint32_t objectID);      // 只上传，物体信息不变
+        void Add(ObjectInfo* info, uint32_t objectID,       // model = 物体世界矩阵 * local，原model移到prevModel，然后上传
+                 const Mat4& model, const Mat4& invModel, const Mat4& local, const Mat4& localInv);
+
+    private:
+        friend class ObjectInfoBatch;
+
+        ObjectInfoBatch* batch = nullptr;
+        uint32_t recomputeIndex = 0;
+        uint32_t recomputeEnd = 0;
+        uint32_t uploadIndex = 0;
+        uint32_t uploadEnd = 0;
+    };
+
+    void Clear();
+
+    Range Allocate(uint32_t recomputeSize, uint32_t uploadSize);    // 只能串行调用，之后batch的大小不再变化
+
+    void Execute(ObjectInfo* dst);                          // dst按物体ID索引
+
+    inline uint32_t RecomputeSize() const   { return recomputeItems.size(); }
+    inline uint32_t Size() const            { return recomputeItems.size() + uploadItems.size(); }
+
+private:
+    struct Item
+    {
+        ObjectInfo* info = nullptr;
+        uint32_t objectID = 0;
+    };
+
+    static const uint32_t CHUNK_SIZE = 256;                 // 每个并行任务处理的项数
+
+    TransformBatch transforms;                              // 和recomputeItems一一对应
+    std::vector<Item> recomputeItems;
+    std::vector<Item> uploadItems;
+};
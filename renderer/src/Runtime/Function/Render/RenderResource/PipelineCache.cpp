@@ -1,16 +1,42 @@
 #include "PipelineCache.h"
 #include "Function/Global/EngineContext.h"
 #include "Function/Render/RHI/RHIStructs.h"
+#include "Function/Render/RHI/PipelineCacheFile.h"
+
+#include "Function/Global/EngineThreadPool.h"
 
 #include "Core/Log/Log.h"
+#include "Platform/HAL/ScopeLock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+static inline float MilliSecondsBetween(TimePoint begin, TimePoint end)
+{
+    return std::chrono::duration<float, std::milli>(end - begin).count();
+}
+
+uint32_t PipelineCompileStats::HistogramBucket(float milliSeconds)
+{
+    if(milliSeconds < 1.0f) return 0;
+    return std::min((uint32_t)std::log2(milliSeconds) + 1, (uint32_t)PIPELINE_COMPILE_HISTOGRAM_SIZE - 1);
+}
 
 GraphicsPipelineCache::CachedPipeline GraphicsPipelineCache::Allocate(const RHIGraphicsPipelineInfo& info)
 {
     GraphicsPipelineCache::CachedPipeline ret;
 
+    ScopeLock lock(sync);       // 创建管线也放在锁内，避免多个线程重复创建同一管线
     auto iter = cachedPipelines.find(info);
     if(iter != cachedPipelines.end())
-    return iter->second;
+    {
+        iter->second.lastUsedFrame = frame;
+        if(!iter->second.pending) current.hits++;     // 正在后台编译的同样返回pending
+        return iter->second;
+    }
     
     if(!IsValid(info))
     {
@@ -20,13 +46,337 @@ GraphicsPipelineCache::CachedPipeline GraphicsPipelineCache::Allocate(const RHIG
 
     LOG_DEBUG("RHIGraphicsPipeline not found in cache, creating new.");
     ret = {
-        .pipeline = EngineContext::RHI()->CreateGraphicsPipeline(info)
+        .pipeline = EngineContext::RHI()->CreateGraphicsPipeline(info),
+        .lastUsedFrame = frame
     };
     cachedPipelines[info] = ret;
+    current.pooledCount++;
+    current.misses++;
+    if(ret.pipeline) AddWarmupRecord(info);
     
     return ret;
 }
 
+GraphicsPipelineCache::CachedPipeline GraphicsPipelineCache::AllocateAsync(const RHIGraphicsPipelineInfo& info)
+{
+    if(EngineContext::Destroyed()) return Allocate(info);
+
+    ScopeLock lock(sync);
+    auto iter = cachedPipelines.find(info);
+    if(iter != cachedPipelines.end())
+    {
+        iter->second.lastUsedFrame = frame;
+        if(!iter->second.pending) current.hits++;
+        return iter->second;
+    }
+
+    if(!IsValid(info)) return { nullptr };
+
+    CachedPipeline ret = {
+        .pipeline = nullptr,
+        .lastUsedFrame = frame,
+        .pending = true
+    };
+    cachedPipelines[info] = ret;
+    current.pooledCount++;
+    current.misses++;
+    compileStats.queueDepth++;
+    compileStats.maxQueueDepth = std::max(compileStats.maxQueueDepth, compileStats.queueDepth);
+
+    // 资源线程池不参与每帧的WaitIdle，编译不会阻塞帧
+    TimePoint submitTime = std::chrono::steady_clock::now();
+    EngineContext::ThreadPool()->AddQueuedWork([this, info, submitTime]() { Compile(info, submitTime); }, ENGINE_THREAD_TYPE_ASSET);
+
+    return ret;
+}
+
+void GraphicsPipelineCache::Compile(const RHIGraphicsPipelineInfo& info, TimePoint submitTime)
+{
+    TimePoint begin = std::chrono::steady_clock::now();
+    RHIGraphicsPipelineRef pipeline = EngineContext::RHI()->CreateGraphicsPipeline(info);
+    TimePoint end = std::chrono::steady_clock::now();
+
+    ScopeLock lock(sync);
+    compileStats.queueDepth--;
+    if(pipeline)
+    {
+        float time = MilliSecondsBetween(begin, end);
+        compileStats.compiledCount++;
+        compileStats.totalTime += time;
+        compileStats.maxTime = std::max(compileStats.maxTime, time);
+        compileStats.totalLatency += MilliSecondsBetween(submitTime, end);
+        compileStats.histogram[PipelineCompileStats::HistogramBucket(time)]++;
+        AddWarmupRecord(info);
+    }
+    else compileStats.failedCount++;
+    compileVersion++;
+
+    auto iter = cachedPipelines.find(info);
+    if(iter == cachedPipelines.end()) return;   // 编译期间缓存被清空
+    iter->second.pipeline = pipeline;           // 失败时缓存空管线，和同步创建一致
+    iter->second.pending = false;
+}
+
+uint32_t GraphicsPipelineCache::GetCompileVersion()
+{
+    ScopeLock lock(sync);
+    return compileVersion;
+}
+
+PipelineCompileStats GraphicsPipelineCache::GetCompileStats()
+{
+    ScopeLock lock(sync);
+    return compileStats;
+}
+
+uint32_t GraphicsPipelineCache::CachedSize()
+{
+    ScopeLock lock(sync);
+    return cachedPipelines.size();
+}
+
+void GraphicsPipelineCache::Clear()
+{
+    ScopeLock lock(sync);
+    cachedPipelines.clear();
+    current.pooledCount = 0;
+}
+
+void GraphicsPipelineCache::Tick()
+{
+    bool retryWarmup = false;
+    {
+        ScopeLock lock(sync);
+        if(config.maxUnusedFrames > 0)
+        {
+            for(auto iter = cachedPipelines.begin(); iter != cachedPipelines.end();)
+            {
+                if(!iter->second.pending && frame - iter->second.lastUsedFrame > config.maxUnusedFrames)
+                {
+                    iter = cachedPipelines.erase(iter);
+                    current.pooledCount--;
+                    current.evictions++;
+                }
+                else iter++;
+            }
+        }
+
+        stats = current;
+        current.hits = 0;
+        current.misses = 0;
+        current.evictions = 0;
+        frame++;
+
+        retryWarmup = !pendingWarmups.empty() && frame % WARMUP_RETRY_FRAMES == 0;
+    }
+    if(retryWarmup) Warmup(true);   // 引用材质等运行时才加载的着色器的记录，加载后才能解析
+}
+
+RDGPoolStats GraphicsPipelineCache::GetStats()
+{
+    ScopeLock lock(sync);
+    return stats;
+}
+
+void GraphicsPipelineCache::SetConfig(const RDGPoolConfig& newConfig)
+{
+    ScopeLock lock(sync);
+    config = newConfig;
+}
+
+RDGPoolConfig GraphicsPipelineCache::GetConfig()
+{
+    ScopeLock lock(sync);
+    return config;
+}
+
+void GraphicsPipelineCache::LoadWarmupList(const std::string& path)
+{
+    std::vector<uint8_t> file;
+    std::vector<PipelineWarmupRecord> records;
+    if(!PipelineCacheFile::Read(path, file)) return;
+    if(!DeserializeWarmupList(file, records))
+    {
+        ENGINE_LOG_WARN("Pipeline warmup list [{}] is invalid, discarded", path);
+        return;
+    }
+
+    ScopeLock lock(sync);
+    pendingWarmups = std::move(records);
+}
+
+void GraphicsPipelineCache::SaveWarmupList(const std::string& path)
+{
+    std::vector<PipelineWarmupRecord> records;
+    {
+        ScopeLock lock(sync);
+        records = warmupRecords;
+        for(auto& record : pendingWarmups)  // 本次没有用到的管线也保留，例如其他场景的材质
+        {
+            if(records.size() >= MAX_WARMUP_RECORDS) break;
+            if(warmupRecordHashes.find(MurmurHash64A(&record, sizeof(PipelineWarmupRecord), 0)) == warmupRecordHashes.end()) records.push_back(record);
+        }
+    }
+
+    if(!PipelineCacheFile::Write(path, SerializeWarmupList(records)))
+    {
+        ENGINE_LOG_WARN("Failed to save pipeline warmup list [{}]", path);
+    }
+}
+
+uint32_t GraphicsPipelineCache::Warmup(bool async)
+{
+    std::vector<PipelineWarmupRecord> records;
+    {
+        ScopeLock lock(sync);
+        records.swap(pendingWarmups);
+    }
+    if(records.empty()) return 0;
+
+    // 只使用仍被外部持有的资源，和各个pass实际使用的是同一个对象，预热的管线才能被命中
+    // 资源表和这里的拷贝各持有一份引用
+    std::unordered_map<uint64_t, RHIShaderRef> shaders;
+    std::unordered_map<uint64_t, RHIRootSignatureRef> rootSignatures;
+    for(RHIResourceRef& resource : EngineContext::RHI()->GetResources(RHI_SHADER))
+    {
+        if(resource && resource.use_count() > 2) 
+        {
+            RHIShaderRef shader = std::static_pointer_cast<RHIShader>(resource);
+            shaders[shader->GetHash()] = shader;
+        }
+    }
+    for(RHIResourceRef& resource : EngineContext::RHI()->GetResources(RHI_ROOT_SIGNATURE))
+    {
+        if(resource && resource.use_count() > 2) 
+        {
+            RHIRootSignatureRef rootSignature = std::static_pointer_cast<RHIRootSignature>(resource);
+            rootSignatures[rootSignature->GetHash()] = rootSignature;
+        }
+    }
+
+    uint32_t created = 0;
+    std::vector<PipelineWarmupRecord> unresolved;
+    for(auto& record : records)
+    {
+        RHIGraphicsPipelineInfo info;
+        if(!ResolveWarmupRecord(record, shaders, rootSignatures, info)) 
+        {
+            unresolved.push_back(record);
+            continue;
+        }
+        CachedPipeline cached = async ? AllocateAsync(info) : Allocate(info);
+        if(cached.pipeline || cached.pending) created++;
+    }
+
+    ScopeLock lock(sync);
+    pendingWarmups.insert(pendingWarmups.end(), unresolved.begin(), unresolved.end());
+    if(created > 0) ENGINE_LOG_INFO("Pipeline warmup created [{}], pending [{}]", created, pendingWarmups.size());
+    return created;
+}
+
+uint32_t GraphicsPipelineCache::PendingWarmupSize()
+{
+    ScopeLock lock(sync);
+    return pendingWarmups.size();
+}
+
+bool GraphicsPipelineCache::MakeWarmupRecord(const RHIGraphicsPipelineInfo& info, PipelineWarmupRecord& record)
+{
+    if(!info.vertexShader || !info.fragmentShader || !info.rootSignature) return false;
+    if(!info.vertexInputState.vertexElements.empty()) return false;
+
+    memset(static_cast<void*>(&record), 0, sizeof(PipelineWarmupRecord));      // 逐字节哈希和比较
+    record.vertexShader = info.vertexShader->GetHash();
+    record.geometryShader = info.geometryShader ? info.geometryShader->GetHash() : 0;
+    record.fragmentShader = info.fragmentShader->GetHash();
+    record.rootSignature = info.rootSignature->GetHash();
+    record.primitiveType = info.primitiveType;
+    record.rasterizerState = info.rasterizerState;
+    record.blendState = info.blendState;
+    record.depthStencilState = info.depthStencilState;
+    record.colorAttachmentFormats = info.colorAttachmentFormats;
+    record.depthStencilAttachmentFormat = info.depthStencilAttachmentFormat;
+    record.viewMask = info.viewMask;
+    return true;
+}
+
+bool GraphicsPipelineCache::ResolveWarmupRecord(const PipelineWarmupRecord& record,
+                                                const std::unordered_map<uint64_t, RHIShaderRef>& shaders,
+                                                const std::unordered_map<uint64_t, RHIRootSignatureRef>& rootSignatures,
+                                                RHIGraphicsPipelineInfo& info)
+{
+    auto findShader = [&](uint64_t hash) -> RHIShaderRef {
+        auto iter = shaders.find(hash);
+        return iter != shaders.end() ? iter->second : nullptr;
+    };
+
+    info = {};
+    info.vertexShader = findShader(record.vertexShader);
+    info.geometryShader = record.geometryShader != 0 ? findShader(record.geometryShader) : nullptr;
+    info.fragmentShader = findShader(record.fragmentShader);
+    auto iter = rootSignatures.find(record.rootSignature);
+    info.rootSignature = iter != rootSignatures.end() ? iter->second : nullptr;
+
+    if( !info.vertexShader || !info.fragmentShader || !info.rootSignature ||
+        (record.geometryShader != 0 && !info.geometryShader)) return false;
+
+    info.primitiveType = record.primitiveType;
+    info.rasterizerState = record.rasterizerState;
+    info.blendState = record.blendState;
+    info.depthStencilState = record.depthStencilState;
+    info.colorAttachmentFormats = record.colorAttachmentFormats;
+    info.depthStencilAttachmentFormat = record.depthStencilAttachmentFormat;
+    info.viewMask = record.viewMask;
+    return true;
+}
+
+std::vector<uint8_t> GraphicsPipelineCache::SerializeWarmupList(const std::vector<PipelineWarmupRecord>& records)
+{
+    uint64_t recordBytes = records.size() * sizeof(PipelineWarmupRecord);
+
+    PipelineWarmupListHeader header;
+    memset(&header, 0, sizeof(PipelineWarmupListHeader));
+    header.magic = PIPELINE_WARMUP_LIST_MAGIC;
+    header.version = PIPELINE_WARMUP_LIST_VERSION;
+    header.recordSize = sizeof(PipelineWarmupRecord);
+    header.recordCount = records.size();
+    header.recordHash = MurmurHash64A(records.data(), recordBytes, 0);
+
+    std::vector<uint8_t> file(sizeof(PipelineWarmupListHeader) + recordBytes);
+    memcpy(file.data(), &header, sizeof(PipelineWarmupListHeader));
+    if(recordBytes > 0) memcpy(file.data() + sizeof(PipelineWarmupListHeader), records.data(), recordBytes);
+    return file;
+}
+
+bool GraphicsPipelineCache::DeserializeWarmupList(const std::vector<uint8_t>& file, std::vector<PipelineWarmupRecord>& records)
+{
+    records.clear();
+    if(file.size() < sizeof(PipelineWarmupListHeader)) return false;
+
+    PipelineWarmupListHeader header;
+    memcpy(&header, file.data(), sizeof(PipelineWarmupListHeader));
+    uint64_t recordBytes = (uint64_t)header.recordCount * sizeof(PipelineWarmupRecord);
+    if( header.magic != PIPELINE_WARMUP_LIST_MAGIC ||
+        header.version != PIPELINE_WARMUP_LIST_VERSION ||
+        header.recordSize != sizeof(PipelineWarmupRecord) ||
+        recordBytes != file.size() - sizeof(PipelineWarmupListHeader)) return false;
+
+    const uint8_t* begin = file.data() + sizeof(PipelineWarmupListHeader);
+    if(MurmurHash64A(begin, recordBytes, 0) != header.recordHash) return false;
+
+    records.resize(header.recordCount);
+    if(recordBytes > 0) memcpy(static_cast<void*>(records.data()), begin, recordBytes);
+    return true;
+}
+
+void GraphicsPipelineCache::AddWarmupRecord(const RHIGraphicsPipelineInfo& info)
+{
+    PipelineWarmupRecord record;
+    if(warmupRecords.size() >= MAX_WARMUP_RECORDS || !MakeWarmupRecord(info, record)) return;
+
+    if(warmupRecordHashes.insert(MurmurHash64A(&record, sizeof(PipelineWarmupRecord), 0)).second) warmupRecords.push_back(record);
+}
+
 bool GraphicsPipelineCache::IsValid(RHIGraphicsPipelineInfo info)
 {
     if(!info.vertexShader || !info.fragmentShader || !info.rootSignature) return false;
@@ -1,20 +1,86 @@
 #pragma once
 
+#include "Function/Render/RDG/RDGPool.h"
 #include "Function/Render/RHI/RHIStructs.h"
 #include "Function/Render/RHI/RHIResource.h"
 
+#include "Core/Util/TimeScope.h"
 #include "MurmurHash2.h"
+#include "Platform/HAL/PlatformProcess.h"
 
+#include <array>
 #include <cstdint>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
+// 预热列表的一项，着色器和根签名按内容哈希记录，其余状态原样保存，可以跨进程使用
+typedef struct PipelineWarmupRecord
+{
+    uint64_t vertexShader;
+    uint64_t geometryShader;                // 为0时没有几何着色器
+    uint64_t fragmentShader;
+    uint64_t rootSignature;
+
+    PrimitiveType primitiveType;
+    RHIRasterizerStateInfo rasterizerState;
+    RHIBlendStateInfo blendState;
+    RHIDepthStencilStateInfo depthStencilState;
+    std::array<RHIFormat, MAX_RENDER_TARGETS> colorAttachmentFormats;
+    RHIFormat depthStencilAttachmentFormat;
+    uint32_t viewMask;
+
+} PipelineWarmupRecord;
+
+#define PIPELINE_COMPILE_HISTOGRAM_SIZE 8
+
+typedef struct PipelineCompileStats         // 后台编译的统计，除队列深度外都是累计值
+{
+    uint32_t queueDepth = 0;                // 等待和正在编译的管线数目
+    uint32_t maxQueueDepth = 0;
+    uint32_t compiledCount = 0;
+    uint32_t failedCount = 0;
+
+    float totalTime = 0.0f;                 // 编译耗时之和，毫秒
+    float maxTime = 0.0f;
+    float totalLatency = 0.0f;              // 从提交到可用的时间之和，包括排队，毫秒
+
+    std::array<uint32_t, PIPELINE_COMPILE_HISTOGRAM_SIZE> histogram = {};    // 编译耗时的分布，第0档小于1毫秒，第i档为[2^(i-1), 2^i)毫秒，最后一档不设上限
+
+    float AverageTime() const               { return compiledCount > 0 ? totalTime / compiledCount : 0.0f; }
+    float AverageLatency() const            { return compiledCount > 0 ? totalLatency / compiledCount : 0.0f; }
+    static uint32_t HistogramBucket(float milliSeconds);
+
+} PipelineCompileStats;
+
+#define PIPELINE_WARMUP_LIST_MAGIC 0x57505254       // "TRPW"
+#define PIPELINE_WARMUP_LIST_VERSION 1
+
+typedef struct PipelineWarmupListHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t recordSize;                    // PipelineWarmupRecord的布局变化时列表失效
+    uint32_t recordCount;
+    uint64_t recordHash;
+
+} PipelineWarmupListHeader;
+
+// 各个mesh pass的processor会在工作线程上并行查询和创建管线，加锁访问
+// 和RDG的资源池一样每帧Tick，长时间没有查询过的管线从缓存中移除，仍被pass持有的管线不受影响
+// AllocateAsync把未缓存的管线提交到资源线程池后台编译，编译完成前返回pending，由调用方先用默认管线代替
 class GraphicsPipelineCache
 {
 public:
+    GraphicsPipelineCache() : sync(PlatformProcess::CreateMutex()) { config.maxUnusedFrames = 3600; }     // 管线重建代价高，保留更久
+
     struct CachedPipeline
     {
         RHIGraphicsPipelineRef pipeline;
+
+        uint64_t lastUsedFrame = 0;
+        bool pending = false;               // 正在后台编译，pipeline为空
     };
 
     struct Key
@@ -72,20 +138,60 @@ public:
         };
     };
 
-    CachedPipeline Allocate(const RHIGraphicsPipelineInfo& info);
-
-    inline uint32_t CachedSize()    { return cachedPipelines.size(); }
-    void Clear()                    { cachedPipelines.clear(); }
+    CachedPipeline Allocate(const RHIGraphicsPipelineInfo& info);          // 未缓存时在当前线程同步创建
+    CachedPipeline AllocateAsync(const RHIGraphicsPipelineInfo& info);     // 未缓存时提交后台编译并返回pending，没有EngineContext时同步创建
+    uint32_t GetCompileVersion();           // 每完成一次后台编译加一，用于判断用默认管线代替的绘制是否需要重建
+    PipelineCompileStats GetCompileStats();
+
+    uint32_t CachedSize();
+    void Clear();
+
+    void Tick();                            // 每帧调用一次，清理长时间未查询的管线并结算统计
+    RDGPoolStats GetStats();
+    void SetConfig(const RDGPoolConfig& newConfig);
+    RDGPoolConfig GetConfig();
+
+    // 预热列表，记录创建过的管线，下次启动时在引用的着色器和根签名创建之后立即创建，避免首次绘制时的卡顿
+    // 配合后端的磁盘管线缓存，预热时驱动通常可以直接命中，不需要重新编译
+    void LoadWarmupList(const std::string& path);
+    void SaveWarmupList(const std::string& path);
+    uint32_t Warmup(bool async = false);    // 创建引用资源都已存在的待预热管线，返回本次创建或提交编译的数目，其余的留到之后的Tick重试
+    uint32_t PendingWarmupSize();
+
+    static bool MakeWarmupRecord(const RHIGraphicsPipelineInfo& info, PipelineWarmupRecord& record);    // 带顶点输入的管线不记录
+    static bool ResolveWarmupRecord(const PipelineWarmupRecord& record,
+                                    const std::unordered_map<uint64_t, RHIShaderRef>& shaders,
+                                    const std::unordered_map<uint64_t, RHIRootSignatureRef>& rootSignatures,
+                                    RHIGraphicsPipelineInfo& info);
+    static std::vector<uint8_t> SerializeWarmupList(const std::vector<PipelineWarmupRecord>& records);
+    static bool DeserializeWarmupList(const std::vector<uint8_t>& file, std::vector<PipelineWarmupRecord>& records);
 
     static std::shared_ptr<GraphicsPipelineCache> Get()
     {
-        static std::shared_ptr<GraphicsPipelineCache> pool;
-        if(pool == nullptr) pool = std::make_shared<GraphicsPipelineCache>();
+        static std::shared_ptr<GraphicsPipelineCache> pool = std::make_shared<GraphicsPipelineCache>();
         return pool;
     }
 
 private:
     std::unordered_map<Key, CachedPipeline, Key::Hash> cachedPipelines;   
+    MutexRef sync;
+
+    uint64_t frame = 0;
+    RDGPoolConfig config;
+    RDGPoolStats current;   // 管线的pooledCount为缓存的数量
+    RDGPoolStats stats;
+
+    uint32_t compileVersion = 0;
+    PipelineCompileStats compileStats;
+
+    static const uint32_t MAX_WARMUP_RECORDS = 4096;
+    static const uint32_t WARMUP_RETRY_FRAMES = 60;
+
+    std::vector<PipelineWarmupRecord> warmupRecords;        // 本次运行创建过的管线
+    std::unordered_set<uint64_t> warmupRecordHashes;
+    std::vector<PipelineWarmupRecord> pendingWarmups;       // 读取的列表中尚未能创建的
 
     bool IsValid(RHIGraphicsPipelineInfo info);
+    void Compile(const RHIGraphicsPipelineInfo& info, TimePoint submitTime);   // 在资源线程上执行
+    void AddWarmupRecord(const RHIGraphicsPipelineInfo& info);
 };
\ No newline at end of file
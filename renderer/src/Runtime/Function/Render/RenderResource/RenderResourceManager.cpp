@@ -83,6 +83,11 @@ void RenderResourceManager::SetObjectInfos(const std::vector<ObjectInfo>& object
     perFrameResources[EngineContext::ThreadPool()->ThreadFrameIndex()].objectBuffer.SetData(objectInfos, baseObjectID);
 }
 
+ObjectInfo* RenderResourceManager::GetMappedObjectInfos()
+{
+    return perFrameResources[EngineContext::ThreadPool()->ThreadFrameIndex()].objectBuffer.Map();
+}
+
 void RenderResourceManager::SetDirectionalLightInfo(const DirectionalLightInfo& directionalLightInfo, uint32_t cascade)
 {
     perFrameResources[EngineContext::ThreadPool()->ThreadFrameIndex()].lightBuffer.SetData(
@@ -182,7 +187,8 @@ RHIShaderRef RenderResourceManager::GetOrCreateRHIShader(const std::string& path
     RHIShaderInfo shaderInfo = {
         .entry = entry,
         .frequency = frequency,
-        .code = code
+        .code = code,
+        .path = path
     };
     RHIShaderRef shader = EngineContext::RHI()->CreateShader(shaderInfo);
 
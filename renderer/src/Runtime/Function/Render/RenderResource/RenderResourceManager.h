@@ -181,6 +181,7 @@ public:
     void SetCameraInfo(const CameraInfo& cameraInfo);
     void SetObjectInfo(const ObjectInfo& objectInfo, uint32_t objectID);
     void SetObjectInfos(const std::vector<ObjectInfo>& objectInfos, uint32_t baseObjectID);
+    ObjectInfo* GetMappedObjectInfos();                         // 当前帧物体缓冲的持久映射地址，按物体ID索引，用于批量直接写入
     void SetDirectionalLightInfo(const DirectionalLightInfo& directionalLightInfo, uint32_t cascade);
     void SetPointLightInfo(const PointLightInfo& pointLightInfo, uint32_t pointLightID);
     void SetVolumeLightInfo(const VolumeLightInfo& volumeLightInfo, uint32_t volumeLightID);
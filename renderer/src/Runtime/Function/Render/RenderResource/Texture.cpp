@@ -4,6 +4,7 @@
 #include "Function/Global/EngineContext.h"
 #include "Function/Render/RHI/RHIStructs.h"
 #include "Function/Render/RenderResource/RenderResourceManager.h"
+#include "Function/Render/RenderResource/UploadHeap.h"
 #include <cstdint>
 #include <cstring>
 #include <string>
@@ -75,6 +76,11 @@ Texture::~Texture()
     if(!EngineContext::Destroyed() && textureID != 0) EngineContext::RenderResource()->ReleaseBindlessID(textureID, TextureTypeToBindlessSlot(textureType));
 }
 
+void Texture::OnPrepareAsset()
+{
+    if(paths.size() > 0)    DecodeFiles();      // 解码很慢，在工作线程上提前完成
+}
+
 void Texture::OnLoadAsset()
 {   
     if(paths.size() > 0)    LoadFromFile();
@@ -113,20 +119,20 @@ void Texture::InitRHI()
     // EngineContext::RHI()->GetImmediateCommand()->TextureBarrier({texture, RESOURCE_STATE_UNDEFINED, RESOURCE_STATE_SHADER_RESOURCE});
 }
 
-void Texture::LoadFromFile()
+bool Texture::DecodeFiles()
 {
     if(textureType == TEXTURE_TYPE_CUBE && paths.size() != 6)
     {
         LOG_DEBUG("Wrong file num with texture type cube!"); 
-        return;        
+        return false;        
     }
     if(textureType == TEXTURE_TYPE_3D)
     {
         LOG_DEBUG("3D texture file is not supported for now!"); 
-        return;        
+        return false;        
     }
 
-    bool initRHI = false;
+    decodedImages.resize(paths.size());
     for(uint32_t i = 0; i < paths.size(); i++)
     {
         std::vector<uint8_t> data;
@@ -136,49 +142,52 @@ void Texture::LoadFromFile()
         int width, height, channels;
         stbi_info_from_memory(data.data(), data.size(), &width, &height, &channels);
         stbi_uc* pixels = stbi_load_from_memory(data.data(), data.size(), &width, &height, &channels, targetChannel);   // 这个函数非常慢,10~100ms
-        uint32_t bufferSize = width * height * sizeof(uint8_t) * targetChannel;
+        if(!pixels)
+        {
+            LOG_DEBUG("Failed to decode texture file %s!", paths[i].c_str());
+            decodedImages.clear();
+            return false;
+        }
 
         // bool is16Bit = stbi_is_16_bit_from_memory(data.data(), data.size());
         // bool hdr = stbi_is_hdr_from_memory(data.data(), data.size());
         // uint32_t size = extent.width * extent.height * (uint32_t)path.size() * sizeof(uint32_t);     //RGBA8，4字节每像素
 
-        if(!initRHI)
-        {
-            initRHI = true;
+        decodedImages[i].width = width;
+        decodedImages[i].height = height;
+        decodedImages[i].pixels = std::shared_ptr<uint8_t>(pixels, stbi_image_free);
+    }
+    return true;
+}
 
-            extent = {(uint32_t)width, (uint32_t)height, 1};         
-            mipLevels = (uint32_t)(std::floor(std::log2(std::max(width, height)))) + 1;
+void Texture::LoadFromFile()
+{
+    if(decodedImages.empty() && !DecodeFiles()) return;     // 同步加载时在这里解码
 
-            InitRHI();
-        }
+    int targetChannel = FormatChanelCounts(format);
+    int width = decodedImages[0].width;
+    int height = decodedImages[0].height;
+    uint32_t layerSize = width * height * sizeof(uint8_t) * targetChannel;
 
-        // 拷贝纹理内存
-        RHIBufferInfo bufferInfo = {
-            .size = bufferSize,
-            .memoryUsage = MEMORY_USAGE_CPU_ONLY,
-            .type = RESOURCE_TYPE_BUFFER,
-            .creationFlag = BUFFER_CREATION_PERSISTENT_MAP
-        };
-        RHIBufferRef stagingBuffer = EngineContext::RHI()->CreateBuffer(bufferInfo);
-        memcpy(stagingBuffer->Map(), pixels, bufferSize);   
-        EngineContext::RHI()->GetImmediateCommand()->TextureBarrier(
-            {texture, 
-            RESOURCE_STATE_UNDEFINED, RESOURCE_STATE_TRANSFER_DST,
-            {TEXTURE_ASPECT_COLOR, 0, mipLevels, i, 1}});      
-        EngineContext::RHI()->GetImmediateCommand()->CopyBufferToTexture(stagingBuffer, 0, texture, {TEXTURE_ASPECT_COLOR, 0, i, 1});
-        
-        stbi_image_free(pixels);
+    std::vector<const void*> layers;
+    for(auto& image : decodedImages)
+    {
+        if(image.width != width || image.height != height)
+        {
+            LOG_DEBUG("Texture layers have different extents!");
+            decodedImages.clear();
+            return;
+        }
+        layers.push_back(image.pixels.get());
     }
 
-    // 生成mip，转到SRV状态
-    EngineContext::RHI()->GetImmediateCommand()->TextureBarrier({texture, 
-        RESOURCE_STATE_TRANSFER_DST, RESOURCE_STATE_TRANSFER_SRC, 
-                {TEXTURE_ASPECT_COLOR, 0, mipLevels, 0, arrayLayer}});
-    EngineContext::RHI()->GetImmediateCommand()->GenerateMips(texture);
-    EngineContext::RHI()->GetImmediateCommand()->TextureBarrier({texture, 
-        RESOURCE_STATE_TRANSFER_SRC, RESOURCE_STATE_SHADER_RESOURCE, 
-                {TEXTURE_ASPECT_COLOR, 0, mipLevels, 0, arrayLayer}});     
-    EngineContext::RHI()->GetImmediateCommand()->Flush();
+    extent = {(uint32_t)width, (uint32_t)height, 1};         
+    mipLevels = (uint32_t)(std::floor(std::log2(std::max(width, height)))) + 1;
+    InitRHI();
+
+    // 拷贝到上传堆，下一帧开始时随帧一起拷贝纹理内存，生成mip并转到SRV状态
+    UploadHeap::Get()->UploadTexture(texture, layers, layerSize);
+    decodedImages.clear();
 
     // 分配bindless，仅当从文件读入时使用
     textureID = EngineContext::RenderResource()->AllocateBindlessID({ 
@@ -4,6 +4,7 @@
 #include "Function/Render/RHI/RHIStructs.h"
 #include "Resource/Asset/Asset.h"
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 enum TextureType{
@@ -26,6 +27,7 @@ public:
     virtual std::string GetAssetTypeName() override 			{ return "Texture Asset"; }
     virtual AssetType GetAssetType() override                   { return ASSET_TYPE_TEXTURE; }
 
+    virtual void OnPrepareAsset() override;
     virtual void OnLoadAsset() override;
 
     TextureType GetTextureType()                                { return textureType; }
@@ -50,7 +52,16 @@ protected:
     uint32_t mipLevels;
     uint32_t arrayLayer;
 
+    typedef struct DecodedImage
+    {
+        int width = 0;
+        int height = 0;
+        std::shared_ptr<uint8_t> pixels;
+    } DecodedImage;
+    std::vector<DecodedImage> decodedImages;            // 异步加载时在工作线程上解码好的图像，上传后释放
+
     void InitRHI();
+    bool DecodeFiles();
     void LoadFromFile();
 
 private:
@@ -0,0 +1,156 @@
+#include "UploadHeap.h"
+#include "Function/Global/EngineContext.h"
+#include "Function/Render/RHI/RHIStructs.h"
+
+#include "Platform/HAL/ScopeLock.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+UploadHeap::StagedData UploadHeap::Stage(const void* data, uint64_t size)
+{
+    if(!ringBuffer)
+    {
+        ringBuffer = EngineContext::RHI()->CreateBuffer({
+            .size = allocator.GetCapacity(),
+            .memoryUsage = MEMORY_USAGE_CPU_ONLY,
+            .type = RESOURCE_TYPE_BUFFER,
+            .creationFlag = BUFFER_CREATION_PERSISTENT_MAP});
+    }
+
+    uint64_t offset;
+    if(allocator.Allocate(size, UPLOAD_ALIGNMENT, offset))
+    {
+        memcpy((uint8_t*)ringBuffer->Map() + offset, data, size);
+        return { ringBuffer, offset };
+    }
+
+    RHIBufferRef stagingBuffer = EngineContext::RHI()->CreateBuffer({
+        .size = size,
+        .memoryUsage = MEMORY_USAGE_CPU_ONLY,
+        .type = RESOURCE_TYPE_BUFFER,
+        .creationFlag = BUFFER_CREATION_PERSISTENT_MAP});
+    memcpy(stagingBuffer->Map(), data, size);
+
+    pendingStagingBuffers.push_back(stagingBuffer);
+    current.fallbackCount++;
+    return { stagingBuffer, 0 };
+}
+
+void UploadHeap::UploadBuffer(RHIBufferRef dst, uint64_t dstOffset, const void* data, uint64_t size)
+{
+    if(!dst || size == 0) return;
+
+    ScopeLock lock(sync);
+    current.uploadCount++;
+    current.uploadBytes += size;
+
+    for(uint64_t offset = 0; offset < size; )
+    {
+        uint64_t chunkSize = std::min(UPLOAD_CHUNK_SIZE, size - offset);
+        uint64_t available = allocator.LargestAllocation(UPLOAD_ALIGNMENT);
+        if(available < chunkSize)   // 先用满环形缓冲剩余的连续空间，放不下时剩余部分一次放到单独的暂存缓冲
+        {
+            chunkSize = available >= UPLOAD_MIN_CHUNK_SIZE ? available : size - offset;
+        }
+
+        StagedData src = Stage((const uint8_t*)data + offset, chunkSize);
+        pendingBuffers.push_back({ src, dst, dstOffset + offset, chunkSize });
+        offset += chunkSize;
+    }
+}
+
+void UploadHeap::UploadTexture(RHITextureRef dst, const std::vector<const void*>& layers, uint64_t layerSize, bool generateMips)
+{
+    if(!dst || layers.empty() || layerSize == 0) return;
+
+    ScopeLock lock(sync);
+    current.uploadCount++;
+    current.uploadBytes += layerSize * layers.size();
+
+    TextureUpload upload = { .dst = dst, .generateMips = generateMips };
+    for(const void* data : layers) upload.layers.push_back(Stage(data, layerSize));     // 单层无法拆分，拷贝指令总是写入整个mip
+    pendingTextures.push_back(upload);
+}
+
+void UploadHeap::Flush(RHICommandListRef command, uint64_t frame)
+{
+    ScopeLock lock(sync);
+    if(!pendingBuffers.empty() || !pendingTextures.empty())
+    {
+        std::vector<RHIBufferBarrier> bufferBarriers;
+        std::vector<RHITextureBarrier> textureBarriers;
+        for(auto& upload : pendingBuffers)  bufferBarriers.push_back({ upload.dst, RESOURCE_STATE_UNDEFINED, RESOURCE_STATE_TRANSFER_DST, (uint32_t)upload.dstOffset, (uint32_t)upload.size });
+        for(auto& upload : pendingTextures) textureBarriers.push_back({ upload.dst, RESOURCE_STATE_UNDEFINED, RESOURCE_STATE_TRANSFER_DST, upload.dst->GetDefaultSubresourceRange() });
+        if(!bufferBarriers.empty())     command->BufferBarriers(bufferBarriers);
+        if(!textureBarriers.empty())    command->TextureBarriers(textureBarriers);
+
+        for(auto& upload : pendingBuffers)
+        {
+            command->CopyBuffer(upload.src.buffer, upload.src.offset, upload.dst, upload.dstOffset, upload.size);
+            current.copyCount++;
+        }
+        for(auto& upload : pendingTextures)
+        {
+            for(uint32_t i = 0; i < upload.layers.size(); i++)
+            {
+                command->CopyBufferToTexture(upload.layers[i].buffer, upload.layers[i].offset, upload.dst, {TEXTURE_ASPECT_COLOR, 0, i, 1});
+                current.copyCount++;
+            }
+        }
+
+        // 生成mip，全部转到SRV状态
+        std::vector<RHITextureBarrier> mipBarriers;
+        for(auto& barrier : bufferBarriers)     barrier = { barrier.buffer, RESOURCE_STATE_TRANSFER_DST, RESOURCE_STATE_SHADER_RESOURCE, barrier.offset, barrier.size };
+        for(uint32_t i = 0; i < textureBarriers.size(); i++)
+        {
+            RHITextureBarrier& barrier = textureBarriers[i];
+            if(pendingTextures[i].generateMips && barrier.subresource.levelCount > 1)
+            {
+                mipBarriers.push_back({ barrier.texture, RESOURCE_STATE_TRANSFER_DST, RESOURCE_STATE_TRANSFER_SRC, barrier.subresource });
+                barrier.srcState = RESOURCE_STATE_TRANSFER_SRC;
+            }
+            else barrier.srcState = RESOURCE_STATE_TRANSFER_DST;
+            barrier.dstState = RESOURCE_STATE_SHADER_RESOURCE;
+        }
+        if(!mipBarriers.empty())
+        {
+            command->TextureBarriers(mipBarriers);
+            for(auto& barrier : mipBarriers) command->GenerateMips(barrier.texture);
+        }
+        if(!bufferBarriers.empty())     command->BufferBarriers(bufferBarriers);
+        if(!textureBarriers.empty())    command->TextureBarriers(textureBarriers);
+
+        pendingBuffers.clear();
+        pendingTextures.clear();
+    }
+
+    allocator.FinishFrame(frame);
+    for(auto& buffer : pendingStagingBuffers) inFlightStagingBuffers.push_back({ frame, buffer });
+    pendingStagingBuffers.clear();
+
+    current.usedBytes = allocator.GetStats().usedSize;
+    current.capacity = allocator.GetCapacity();
+    stats = current;
+    current = {};
+}
+
+void UploadHeap::Retire(uint64_t completedFrame)
+{
+    ScopeLock lock(sync);
+    allocator.Retire(completedFrame);
+    while(!inFlightStagingBuffers.empty() && inFlightStagingBuffers.front().first <= completedFrame) inFlightStagingBuffers.pop_front();
+}
+
+uint32_t UploadHeap::PendingSize()
+{
+    ScopeLock lock(sync);
+    return current.uploadCount;
+}
+
+UploadHeapStats UploadHeap::GetStats()
+{
+    ScopeLock lock(sync);
+    return stats;
+}
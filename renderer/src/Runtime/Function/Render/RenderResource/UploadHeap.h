@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Core/Util/RingAllocator.h"
+#include "Function/Global/Definations.h"
+#include "Function/Render/RHI/RHICommandList.h"
+#include "Function/Render/RHI/RHIResource.h"
+#include "Function/Render/RHI/RHIStructs.h"
+#include "Platform/HAL/PlatformProcess.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+typedef struct UploadHeapStats      // 上一次Flush的统计
+{
+    uint32_t uploadCount = 0;       // 上传请求数
+    uint32_t copyCount = 0;         // 录制的拷贝指令数，大的缓冲上传拆成多段
+    uint32_t fallbackCount = 0;     // 环形缓冲放不下，使用单独暂存缓冲的拷贝数
+    uint64_t uploadBytes = 0;
+    uint64_t usedBytes = 0;         // 环形缓冲中尚未回收的字节数
+    uint64_t capacity = 0;
+
+} UploadHeapStats;
+
+// 帧流水的上传堆，代替每次上传单独创建暂存缓冲再立即Flush等待
+// 数据先拷贝到持久映射的环形暂存缓冲中，拷贝指令积累到下一帧开始时一次录制到该帧的指令列表头部，随帧一起提交
+// 暂存空间按帧号回收：帧栅栏等待完成后调用Retire，环形缓冲的子分配见RingAllocator
+// 上传后的资源在下一帧及之后的渲染中可用，调用方不需要等待
+class UploadHeap
+{
+public:
+    UploadHeap(uint64_t capacity = (uint64_t)UPLOAD_HEAP_FRAME_SIZE * FRAMES_IN_FLIGHT)
+    : sync(PlatformProcess::CreateMutex())
+    , allocator(capacity) {}
+
+    void UploadBuffer(RHIBufferRef dst, uint64_t dstOffset, const void* data, uint64_t size);                       // 按UPLOAD_CHUNK_SIZE拆成多段，每段一条拷贝指令
+    void UploadTexture(RHITextureRef dst, const std::vector<const void*>& layers, uint64_t layerSize, bool generateMips = true);    // 写入各层的mip0，之后生成mip并转到SRV状态
+
+    void Flush(RHICommandListRef command, uint64_t frame);      // 录制积累的上传，frame为本帧帧号，需要单调递增
+    void Retire(uint64_t completedFrame);                       // GPU执行完completedFrame及之前的帧后调用
+
+    uint32_t PendingSize();                                     // 尚未录制的上传请求数
+    UploadHeapStats GetStats();
+
+    static std::shared_ptr<UploadHeap> Get()
+    {
+        static std::shared_ptr<UploadHeap> heap = std::make_shared<UploadHeap>();
+        return heap;
+    }
+
+    static constexpr uint64_t UPLOAD_ALIGNMENT = 256;               // 满足拷贝到纹理时对偏移的对齐要求
+    static constexpr uint64_t UPLOAD_CHUNK_SIZE = 4 * 1024 * 1024;  // 缓冲上传的分段大小，环形缓冲有碎片时也能放下大部分
+    static constexpr uint64_t UPLOAD_MIN_CHUNK_SIZE = 64 * 1024;    // 剩余空间小于此时不再拆分
+
+private:
+    struct StagedData
+    {
+        RHIBufferRef buffer;
+        uint64_t offset = 0;
+    };
+
+    struct BufferUpload
+    {
+        StagedData src;
+        RHIBufferRef dst;
+        uint64_t dstOffset;
+        uint64_t size;
+    };
+
+    struct TextureUpload
+    {
+        RHITextureRef dst;
+        std::vector<StagedData> layers;
+        bool generateMips;
+    };
+
+    StagedData Stage(const void* data, uint64_t size);         // 环形缓冲放不下时创建单独的暂存缓冲
+
+    MutexRef sync;
+    RingAllocator allocator;
+    RHIBufferRef ringBuffer;                                    // 首次上传时创建
+
+    std::vector<BufferUpload> pendingBuffers;
+    std::vector<TextureUpload> pendingTextures;
+    std::vector<RHIBufferRef> pendingStagingBuffers;
+    std::deque<std::pair<uint64_t, RHIBufferRef>> inFlightStagingBuffers;     // 单独创建的暂存缓冲，按帧号释放
+
+    UploadHeapStats current;
+    UploadHeapStats stats;
+};
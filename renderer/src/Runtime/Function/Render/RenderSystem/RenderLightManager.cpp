@@ -15,6 +15,15 @@ void RenderLightManager::Tick()
     PrepareLights();
 }
 
+void RenderLightManager::PrepareDirectionalLight()
+{
+    ENGINE_TIME_SCOPE(RenderLightManager::PrepareDirectionalLight);
+
+    auto& lights = perframeLights[EngineContext::ThreadPool()->ThreadFrameIndex()];
+    lights.directionalLight = EngineContext::World()->GetActiveScene()->GetDirectionalLight();
+    if(lights.directionalLight && lights.directionalLight->Enable()) lights.directionalLight->UpdateLightInfo();
+}
+
 std::shared_ptr<DirectionalLightComponent> RenderLightManager::GetDirectionalLight()                 
 { 
     return perframeLights[EngineContext::ThreadPool()->ThreadFrameIndex()].directionalLight; 
@@ -43,21 +52,15 @@ void RenderLightManager::PrepareLights()
 
     auto& lights = perframeLights[EngineContext::ThreadPool()->ThreadFrameIndex()];
 
-    lights.directionalLight = nullptr;
     lights.pointShadowLights.clear();
     lights.volumeLights.clear();
 
     // 收集光源信息,更新参数
     // TODO 场景的CPU端剔除
 
-    lights.directionalLight = EngineContext::World()->GetActiveScene()->GetDirectionalLight();
-    if(lights.directionalLight && lights.directionalLight->Enable()) 
-    {
-        lights.directionalLight->UpdateLightInfo();
-        setting.directionalLightCnt = 1;
-    }
+    if(lights.directionalLight && lights.directionalLight->Enable()) setting.directionalLightCnt = 1;    // 已在PrepareDirectionalLight中更新
 
-    auto pointLightComponents = EngineContext::World()->GetActiveScene()->GetPointLights();
+    const auto& pointLightComponents = EngineContext::World()->GetActiveScene()->GetPointLights();
     for(auto& pointLight : pointLightComponents) 
     {
         if(pointLight) 
@@ -81,7 +84,7 @@ void RenderLightManager::PrepareLights()
         }
     }
 
-    auto volumeLightComponents = EngineContext::World()->GetActiveScene()->GetVolumeLights();
+    const auto& volumeLightComponents = EngineContext::World()->GetActiveScene()->GetVolumeLights();
     for(auto& volumeLight : volumeLightComponents)
     {
         if(volumeLight && volumeLight->Enable())
@@ -12,6 +12,7 @@ class RenderLightManager
 public:
     void Init();
     void Tick();
+    void PrepareDirectionalLight();     // 级联视锥会被RenderMeshManager的CPU端剔除读取，在各manager并行Tick之前由主线程调用
 
     std::shared_ptr<DirectionalLightComponent> GetDirectionalLight();
     const std::vector<std::shared_ptr<PointLightComponent>>& GetPointShadowLights();
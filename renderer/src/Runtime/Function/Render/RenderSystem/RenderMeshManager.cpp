@@ -1,10 +1,17 @@
 #include "RenderMeshManager.h"
+#include "Function/Framework/Component/DirectionalLightComponent.h"
 #include "Function/Framework/Component/MeshRendererComponent.h"
+#include "Function/Framework/Entity/Entity.h"
+#include "Function/Framework/Scene/Scene.h"
 #include "Function/Global/Definations.h"
 #include "Function/Global/EngineContext.h"
 #include "Function/Render/RenderPass/GPUCullingPass.h"
+#include "Function/Render/RenderResource/Material.h"
+#include "Platform/HAL/ScopeLock.h"
 #include "RenderSystem.h"
 
+#include <algorithm>
+
 void RenderMeshManager::Init()
 {
     tlas = EngineContext::RHI()->CreateTopLevelAccelerationStructure({
@@ -27,6 +34,276 @@ void RenderMeshManager::Tick()
     if(camera) camera->UpdateCameraInfo();  // 更新相机数据
 }
 
+uint32_t RenderMeshManager::AddPrimitive(Drawable* drawable, Component* owner)
+{
+    ScopeLock lock(sync);
+
+    uint32_t primitiveID;
+    if(freePrimitiveIDs.size() > 0)
+    {
+        primitiveID = freePrimitiveIDs.back();
+        freePrimitiveIDs.pop_back();
+    }
+    else
+    {
+        primitiveID = primitives.size();
+        primitives.emplace_back();
+    }
+
+    ScenePrimitive& primitive = primitives[primitiveID];
+    primitive.drawable = drawable;
+    primitive.owner = owner;
+    primitive.dirtyFlags = DRAWABLE_DIRTY_ALL;      // 首次注册需要收集全部数据
+    primitive.recomputeFrames = 0;
+    primitive.uploadFrames = 0;
+    primitive.cullable = false;
+    primitive.batches.clear();
+    if(!primitive.inDirtyList)                      // 释放前可能还留在脏列表里，不重复添加
+    {
+        primitive.inDirtyList = true;
+        dirtyPrimitives.push_back(primitiveID);
+    }
+    primitiveCount++;
+    return primitiveID;
+}
+
+void RenderMeshManager::RemovePrimitive(uint32_t primitiveID)
+{
+    ScopeLock lock(sync);
+
+    ScenePrimitive& primitive = primitives[primitiveID];
+    primitive.drawable = nullptr;
+    primitive.owner = nullptr;
+    primitive.batches.clear();
+    if(primitive.cullable) octree.Remove(primitiveID);
+    primitive.cullable = false;
+    freePrimitiveIDs.push_back(primitiveID);
+    primitiveCount--;
+    structureDirty = true;
+}
+
+void RenderMeshManager::MarkPrimitiveDirty(uint32_t primitiveID, DrawableDirtyFlags flags)
+{
+    ScopeLock lock(sync);
+
+    ScenePrimitive& primitive = primitives[primitiveID];
+    if(!primitive.drawable) return;
+    primitive.dirtyFlags |= flags;
+    if(!primitive.inDirtyList)
+    {
+        primitive.inDirtyList = true;
+        dirtyPrimitives.push_back(primitiveID);
+    }
+}
+
+bool RenderMeshManager::UpdatePrimitives()
+{
+    ENGINE_TIME_SCOPE(RenderMeshManager::UpdatePrimitives);
+
+    // Drawable的回调内可能会标脏（MarkPrimitiveDirty），回调期间不持有sync：先在锁内取出脏列表，解锁执行回调，再加锁写回结果
+    // 回调内不能移除图元
+    std::shared_ptr<Scene> scene = EngineContext::World()->GetActiveScene();
+    primitiveUpdates.clear();
+    {
+        ScopeLock lock(sync);
+        statistics = {};
+
+        // 场景切换，场景内增删物体，材质的管线状态变化都需要重新合批
+        uint32_t sceneVersion = scene ? scene->GetVersion() : 0;
+        if(scene.get() != lastScene || sceneVersion != lastSceneVersion)
+        {
+            lastScene = scene.get();
+            lastSceneVersion = sceneVersion;
+            structureDirty = true;
+        }
+        if(Material::PipelineStateVersion() != lastMaterialVersion)
+        {
+            lastMaterialVersion = Material::PipelineStateVersion();
+            structureDirty = true;
+        }
+
+        // 只处理脏列表里的图元，之后几帧还需要上传的留在列表里；回调中新标脏的图元下一帧处理
+        uint32_t remain = 0;
+        for(uint32_t primitiveID : dirtyPrimitives)
+        {
+            ScenePrimitive& primitive = primitives[primitiveID];
+            if(!primitive.drawable)
+            {
+                primitive.inDirtyList = false;
+                continue;
+            }
+
+            ScenePrimitiveUpdate& update = primitiveUpdates.emplace_back();
+            update.primitiveID = primitiveID;
+            update.drawable = primitive.drawable;
+            update.collect = primitive.dirtyFlags & (DRAWABLE_DIRTY_MATERIAL | DRAWABLE_DIRTY_MESH);
+            if(primitive.dirtyFlags != DRAWABLE_DIRTY_NONE) primitive.recomputeFrames = 2;    // 下一帧再算一次，让prevModel追上当前值
+            primitive.dirtyFlags = DRAWABLE_DIRTY_NONE;
+
+            if(primitive.recomputeFrames > 0)
+            {
+                primitive.recomputeFrames--;
+                primitive.uploadFrames = FRAMES_IN_FLIGHT;
+                update.recompute = true;
+            }
+            else update.upload = primitive.uploadFrames > 0;
+            if(primitive.uploadFrames > 0) primitive.uploadFrames--;
+            statistics.touchedPrimitives++;
+
+            if(primitive.recomputeFrames > 0 || primitive.uploadFrames > 0) dirtyPrimitives[remain++] = primitiveID;
+            else primitive.inDirtyList = false;
+        }
+        dirtyPrimitives.resize(remain);
+    }
+
+    // 物体信息先收集到batch里统一计算和上传
+    // 串行为每个图元分配好batch里的范围，再按图元分块并行收集，和计算一样不需要加锁
+    objectInfoBatch.Clear();
+    for(auto& update : primitiveUpdates)
+    {
+        if(update.collect) update.drawable->CollectDrawBatch(update.batches);
+
+        uint32_t size = (update.recompute || update.upload) ? update.drawable->ObjectInfoSize() : 0;
+        update.objectInfos = update.recompute ? objectInfoBatch.Allocate(size, 0) : objectInfoBatch.Allocate(0, size);
+    }
+
+    uint32_t chunks = Math::CeilDivide(primitiveUpdates.size(), PRIMITIVE_CHUNK_SIZE);
+    EngineContext::ThreadPool()->ParallelFor(chunks, [&](uint32_t chunk) {
+        uint32_t begin = chunk * PRIMITIVE_CHUNK_SIZE;
+        uint32_t end = std::min(begin + PRIMITIVE_CHUNK_SIZE, (uint32_t)primitiveUpdates.size());
+        for(uint32_t i = begin; i < end; i++)
+        {
+            ScenePrimitiveUpdate& update = primitiveUpdates[i];
+            if(update.recompute)        update.drawable->CollectObjectInfos(update.objectInfos, true);
+            else if(update.upload)      update.drawable->CollectObjectInfos(update.objectInfos, false);
+        }
+    });
+    objectInfoBatch.Execute(EngineContext::RenderResource()->GetMappedObjectInfos());
+
+    EngineContext::ThreadPool()->ParallelFor(chunks, [&](uint32_t chunk) {     // 包围盒依赖新的矩阵
+        uint32_t begin = chunk * PRIMITIVE_CHUNK_SIZE;
+        uint32_t end = std::min(begin + PRIMITIVE_CHUNK_SIZE, (uint32_t)primitiveUpdates.size());
+        for(uint32_t i = begin; i < end; i++)
+        {
+            ScenePrimitiveUpdate& update = primitiveUpdates[i];
+            if(update.recompute) update.cullable = update.drawable->GetWorldBounds(update.box);
+        }
+    });
+
+    ScopeLock lock(sync);
+    statistics.recomputedObjects = objectInfoBatch.RecomputeSize();
+    for(auto& update : primitiveUpdates)
+    {
+        ScenePrimitive& primitive = primitives[update.primitiveID];
+        if(primitive.drawable != update.drawable) continue;
+
+        if(update.collect)
+        {
+            primitive.batches.swap(update.batches);
+            structureDirty = true;
+            statistics.collectedPrimitives++;
+        }
+        if(update.recompute)
+        {
+            primitive.cullable = update.cullable;
+            if(primitive.cullable)  octree.Update(update.primitiveID, update.box);
+            else                    octree.Remove(update.primitiveID);
+        }
+    }
+
+    // 重新拼接全部DrawBatch，只在结构变化时进行
+    bool rebuild = structureDirty;
+    structureDirty = false;
+    if(rebuild)
+    {
+        batches.clear();
+        batchPrimitives.clear();
+        for(uint32_t primitiveID = 0; primitiveID < primitives.size(); primitiveID++)
+        {
+            ScenePrimitive& primitive = primitives[primitiveID];
+            if(!primitive.drawable || !primitive.owner) continue;
+            std::shared_ptr<Entity> entity = primitive.owner->GetEntity();
+            if(!entity || entity->GetScene() != scene) continue;
+            batches.insert(batches.end(), primitive.batches.begin(), primitive.batches.end());
+            batchPrimitives.insert(batchPrimitives.end(), primitive.batches.size(), primitiveID);
+        }
+    }
+    statistics.primitiveCount = primitiveCount;
+    statistics.drawBatchCount = batches.size();
+    return rebuild;
+}
+
+void RenderMeshManager::CullPrimitives(bool rebuild)
+{
+    ENGINE_TIME_SCOPE(RenderMeshManager::CullPrimitives);
+
+    ScopeLock lock(sync);
+
+    // 第0个视锥为相机，之后为平行光的各级级联，每个meshpass用掩码选择需要的视锥，掩码为0的pass不剔除
+    // 点光源阴影的各个面仍然只在GPU端剔除
+    std::array<FrustumPlanes, 1 + DIRECTIONAL_SHADOW_CASCADE_LEVEL> frustums;
+    std::array<uint32_t, MESH_PASS_TYPE_MAX_CNT> passMasks = {};
+    uint32_t frustumCount = 0;
+
+    auto cullingPass = std::dynamic_pointer_cast<GPUCullingPass>(EngineContext::Render()->GetPasses()[GPU_CULLING_PASS]);
+    bool enable = !cullingPass || cullingPass->FrustumCullingEnabled();     // 调试时关闭视锥剔除，CPU端也一起关闭
+
+    std::shared_ptr<Scene> scene = EngineContext::World()->GetActiveScene();
+    std::shared_ptr<CameraComponent> camera = scene ? scene->GetActiveCamera() : nullptr;
+    if(enable && camera)
+    {
+        uint32_t mask = 1 << frustumCount;
+        frustums[frustumCount++] = FrustumPlanes(camera->GetFrustum());
+        passMasks[MESH_DEPTH_PASS] = mask;
+        passMasks[MESH_G_BUFFER_PASS] = mask;
+        passMasks[MESH_FORWARD_PASS] = mask;
+        passMasks[MESH_TRANSPARENT_PASS] = mask;
+    }
+
+    std::shared_ptr<DirectionalLightComponent> directionalLight = EngineContext::Render()->GetLightManager()->GetDirectionalLight();
+    if(enable && directionalLight)
+    {
+        for(uint32_t i = 0; i < DIRECTIONAL_SHADOW_CASCADE_LEVEL; i++)
+        {
+            passMasks[MESH_DIRECTIONAL_SHADOW_PASS] |= 1 << frustumCount;
+            frustums[frustumCount++] = FrustumPlanes(directionalLight->GetFrustum(i), true);   // 光源和级联之间的物体也会投射阴影
+        }
+    }
+
+    if(frustumCount > 0) octree.Cull(frustums.data(), frustumCount, visibleMasks);
+
+    // 可见集合和上一次处理时一致的pass不需要重新生成绘制指令
+    statistics.culledBatches = 0;
+    for(uint32_t pass = 0; pass < MESH_PASS_TYPE_MAX_CNT; pass++)
+    {
+        uint32_t passMask = passMasks[pass];
+        if(passMask == 0)
+        {
+            passDirty[pass] = rebuild || passInputs[pass] != &batches;
+            passInputs[pass] = &batches;
+            passVisibleBatches[pass].clear();
+            passBatches[pass].clear();
+            continue;
+        }
+
+        visibleBatches.clear();
+        for(uint32_t i = 0; i < batches.size(); i++)
+        {
+            uint32_t primitiveID = batchPrimitives[i];
+            if(!primitives[primitiveID].cullable || (visibleMasks[primitiveID] & passMask)) visibleBatches.push_back(i);
+        }
+        statistics.culledBatches += batches.size() - visibleBatches.size();
+
+        passDirty[pass] = rebuild || passInputs[pass] != &passBatches[pass] || visibleBatches != passVisibleBatches[pass];
+        passInputs[pass] = &passBatches[pass];
+        if(!passDirty[pass]) continue;
+
+        passVisibleBatches[pass].swap(visibleBatches);
+        passBatches[pass].clear();
+        for(uint32_t index : passVisibleBatches[pass]) passBatches[pass].push_back(batches[index]);
+    }
+}
+
 void RenderMeshManager::PrepareMeshPass()
 {
     ENGINE_TIME_SCOPE(RenderMeshManager::PrepareMeshPass);
@@ -35,21 +312,39 @@ void RenderMeshManager::PrepareMeshPass()
     auto cullingPass = std::dynamic_pointer_cast<GPUCullingPass>(EngineContext::Render()->GetPasses()[GPU_CULLING_PASS]);
     if(cullingPass) cullingPass->CollectStatisticDatas();   
 
-    // 遍历场景，获取绘制信息
-    // TODO 场景的CPU端剔除
-    std::vector<DrawBatch> batches;
-    auto rendererComponents = EngineContext::World()->GetActiveScene()->GetComponents<MeshRendererComponent>();     // 场景物体
-    for(auto component : rendererComponents) component->CollectDrawBatch(batches);
+    // 更新常驻图元表，获取绘制信息，再做CPU端的场景剔除
+    bool rebuild = UpdatePrimitives();
+    CullPrimitives(rebuild);
 
-    auto skybox = EngineContext::World()->GetActiveScene()->GetSkyBox();    // 天空盒
-    if(skybox) skybox->CollectDrawBatch(batches);
+    // 可见的图元没有变化时沿用上次的合批结果，否则交给各个meshpass的processor并行处理
+    // 上次用默认管线代替的pass在后台编译完成后也需要重新处理
+    // TODO 脏的pass目前整体重新Process，增删一个图元、替换材质或网格、管线状态版本变化的开销都和整个场景重建相同，
+    //      按图元和管线状态分桶增量修补绘制指令留作后续，在此之前由rebuiltDrawBatches如实统计
+    auto& passes = EngineContext::Render()->GetMeshPasses();
+    statistics.rebuiltPasses = 0;
+    statistics.rebuiltDrawBatches = 0;
+    for(uint32_t i = 0; i < passes.size(); i++)
+    {
+        if(!passes[i]) continue;
+        if(passes[i]->GetMeshPassProcessor()->PipelinesUpdated()) passDirty[i] = true;
+        if(!passDirty[i]) continue;
+        statistics.rebuiltPasses++;
+        statistics.rebuiltDrawBatches += passInputs[i]->size();
+    }
+    if(statistics.rebuiltPasses > 0)
+    {
+        EngineContext::ThreadPool()->ParallelFor(passes.size(), [&](uint32_t i) {
+            if(passes[i] && passDirty[i]) passes[i]->GetMeshPassProcessor()->Process(*passInputs[i]);
+        });
+    }
 
-    // 交给各个meshpass的processor处理
-    MeshPassProcessor::ResetGlobalClusterOffset();
-    for(auto& pass : EngineContext::Render()->GetMeshPasses())
+    // 所有pass的cluster绘制信息最后收集到同一个全局缓冲，按pass顺序前缀和得到各自的偏移后再提交
+    uint32_t clusterOffset = 0;
+    for(auto& pass : passes)
     {
         if(!pass) continue;
-        pass->GetMeshPassProcessor()->Process(batches);
+        pass->GetMeshPassProcessor()->Upload(clusterOffset);
+        clusterOffset += pass->GetMeshPassProcessor()->GetClusterOffsetSize();
     }
 }
 
@@ -59,7 +354,7 @@ void RenderMeshManager::PrepareRayTracePass()
 
     // 遍历场景，获取光追实例信息
     instances.clear();
-    auto rendererComponents = EngineContext::World()->GetActiveScene()->GetComponents<MeshRendererComponent>();     // 场景物体
+    const auto& rendererComponents = EngineContext::World()->GetActiveScene()->GetComponents<MeshRendererComponent>();     // 场景物体
     for(auto component : rendererComponents) component->CollectAccelerationStructureInstance(instances);
 
     //UpdateTLAS();
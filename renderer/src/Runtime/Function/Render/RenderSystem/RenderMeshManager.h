@@ -1,6 +1,61 @@
 #pragma once
 
+#include "Core/Math/LooseOctree.h"
+#include "Function/Global/Definations.h"
 #include "Function/Render/RHI/RHIStructs.h"
+#include "Function/Render/RenderPass/MeshPass.h"
+#include "Function/Render/RenderPass/RenderPass.h"
+#include "Function/Render/RenderResource/Drawable.h"
+#include "Platform/HAL/PlatformProcess.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class Component;
+class Scene;
+
+// 常驻的场景图元表，每个注册的Drawable占一项，缓存其DrawBatch
+typedef struct ScenePrimitive
+{
+    Drawable* drawable = nullptr;               // 为空表示该项已释放
+    Component* owner = nullptr;
+    DrawableDirtyFlags dirtyFlags = DRAWABLE_DIRTY_NONE;
+    uint32_t recomputeFrames = 0;               // 还需要重新计算物体信息的帧数
+    uint32_t uploadFrames = 0;                  // 还需要上传物体信息的帧数，物体缓冲每帧一份
+    bool inDirtyList = false;
+    bool cullable = false;                      // 是否在八叉树中参与CPU端剔除
+    std::vector<DrawBatch> batches;
+
+} ScenePrimitive;
+
+typedef struct ScenePrimitiveUpdate            // 本帧需要处理的脏图元，加锁时确定要做的事，解锁后调用Drawable的回调
+{
+    uint32_t primitiveID = 0;
+    Drawable* drawable = nullptr;               // 回调后用于判断图元是否已经被移除或复用
+    bool collect = false;                       // 重新收集DrawBatch
+    bool recompute = false;                     // 重新计算物体信息和包围盒
+    bool upload = false;                        // 只上传物体信息
+    bool cullable = false;
+    BoundingBox box;
+    std::vector<DrawBatch> batches;
+    ObjectInfoBatch::Range objectInfos;         // 预先分配的batch范围，并行收集时各自填写
+
+} ScenePrimitiveUpdate;
+
+typedef struct ScenePrimitiveStatistics
+{
+    uint32_t primitiveCount = 0;
+    uint32_t touchedPrimitives = 0;             // 本帧处理过的图元数目，静态场景下应当为0，只统计物体信息的更新
+    uint32_t collectedPrimitives = 0;           // 本帧重新收集DrawBatch的图元数目
+    uint32_t recomputedObjects = 0;             // 本帧重新计算变换矩阵的物体数目
+    uint32_t drawBatchCount = 0;
+    uint32_t rebuiltPasses = 0;                 // 本帧重新合批和生成了绘制指令的meshpass数目
+    uint32_t rebuiltDrawBatches = 0;            // 这些pass重新处理的DrawBatch数目之和，目前总是整个pass的输入
+    uint32_t culledBatches = 0;                 // 各个meshpass被CPU端剔除的DrawBatch数目之和
+
+} ScenePrimitiveStatistics;
+
 class RenderMeshManager
 {
 public:
@@ -9,11 +64,46 @@ public:
 
     void UpdateTLAS();
 
+    uint32_t AddPrimitive(Drawable* drawable, Component* owner);        // 可以在任意线程调用
+    void RemovePrimitive(uint32_t primitiveID);
+    void MarkPrimitiveDirty(uint32_t primitiveID, DrawableDirtyFlags flags);
+
+    const ScenePrimitiveStatistics& GetPrimitiveStatistics()            { return statistics; }
+
 private:
+    bool UpdatePrimitives();                    // 返回是否需要重新合批
+    void CullPrimitives(bool rebuild);          // 标记可见集合变化了的meshpass
     void PrepareMeshPass();
     void PrepareRayTracePass();
 
+    static const uint32_t PRIMITIVE_CHUNK_SIZE = 64;   // 并行收集物体信息和包围盒时每个任务处理的图元数
+
+    MutexRef sync = PlatformProcess::CreateMutex();
+    std::vector<ScenePrimitive> primitives = std::vector<ScenePrimitive>(1);   // 0号保留为无效值
+    std::vector<uint32_t> freePrimitiveIDs;
+    std::vector<uint32_t> dirtyPrimitives;
+    uint32_t primitiveCount = 0;
+
+    bool structureDirty = true;                 // 图元集合或DrawBatch发生变化，需要重新合批
+    Scene* lastScene = nullptr;
+    uint32_t lastSceneVersion = 0;
+    uint32_t lastMaterialVersion = 0;
+    std::vector<DrawBatch> batches;             // 全部图元DrawBatch的拼接，重新合批时才重建
+    std::vector<uint32_t> batchPrimitives;      // 每个DrawBatch所属的图元
+    ObjectInfoBatch objectInfoBatch;            // 本帧需要计算和上传的物体信息
+    std::vector<ScenePrimitiveUpdate> primitiveUpdates;    // 本帧处理的脏图元
+    ScenePrimitiveStatistics statistics;
+
+    // CPU端剔除，按相机视锥和平行光各级级联剔除后，只有可见的DrawBatch交给对应的meshpass处理
+    LooseOctree octree = LooseOctree(Vec3::Zero(), SCENE_OCTREE_HALF_SIZE, SCENE_OCTREE_MAX_DEPTH);
+    std::vector<uint32_t> visibleMasks;         // 按图元ID索引
+    std::array<std::vector<uint32_t>, MESH_PASS_TYPE_MAX_CNT> passVisibleBatches;
+    std::array<std::vector<DrawBatch>, MESH_PASS_TYPE_MAX_CNT> passBatches;
+    std::array<const std::vector<DrawBatch>*, MESH_PASS_TYPE_MAX_CNT> passInputs = {};    // 不剔除时直接使用batches
+    std::array<bool, MESH_PASS_TYPE_MAX_CNT> passDirty = {};
+    std::vector<uint32_t> visibleBatches;       // 剔除时的临时数组
+
     std::vector<RHIAccelerationStructureInstanceInfo> instances;
     RHITopLevelAccelerationStructureRef tlas;
     bool init = false;
-};
\ No newline at end of file
+};
@@ -170,7 +170,7 @@ void RenderSurfaceCacheManager::UpdateSurfaceCache()
     std::vector<SurfaceCacheTask> tasks;
     {
         ENGINE_TIME_SCOPE(RenderSurfaceCacheManager::CollectTask);
-        auto rendererComponents = EngineContext::World()->GetActiveScene()->GetComponents<MeshRendererComponent>();     // 场景物体
+        const auto& rendererComponents = EngineContext::World()->GetActiveScene()->GetComponents<MeshRendererComponent>();     // 场景物体
         for(auto& component : rendererComponents) component->CollectSurfaceCacheTask(tasks);
     }
 
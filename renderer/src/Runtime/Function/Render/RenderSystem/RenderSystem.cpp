@@ -3,6 +3,9 @@
 #include "Function/Global/EngineContext.h"
 #include "Function/Global/EngineThreadPool.h"
 #include "Function/Render/RDG/RDGBuilder.h"
+#include "Function/Render/RDG/RDGPool.h"
+#include "Function/Render/RenderResource/PipelineCache.h"
+#include "Function/Render/RenderResource/UploadHeap.h"
 #include "Function/Render/RenderPass/GPUCullingPass.h"
 #include "Function/Render/RenderPass/ClusterLightingPass.h"
 #include "Function/Render/RenderPass/IBLPass.h"
@@ -41,9 +44,12 @@
 #include "RenderSurfaceCacheManager.h"
 #include <cstdio>
 #include <memory>
+#include <string>
 
 void RenderSystem::InitGLFW()
 {
+    if(ENABLE_NULL_RHI) { window = nullptr; return; }    // 空后端不需要窗口
+
     glfwInit();
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
     glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
@@ -58,10 +64,14 @@ void RenderSystem::InitGLFW()
 
 void RenderSystem::DestroyGLFW()
 {
+    if(window == nullptr) return;
+
     glfwDestroyWindow(window);
     glfwTerminate();
 }
 
+static const std::string PIPELINE_WARMUP_LIST_PATH = "PipelineCache/warmup.bin";    // 相对缓存目录
+
 void RenderSystem::Init() 
 { 
     EngineContext::RHI()->InitImGui(window);
@@ -75,6 +85,16 @@ void RenderSystem::Init()
 
     InitBaseResource(); 
     InitPasses();  
+
+    // 上次运行创建过的管线，各pass的着色器已经创建完成，材质相关的在资源加载后由Tick重试
+    GraphicsPipelineCache::Get()->LoadWarmupList(EngineContext::File()->CachePath() + PIPELINE_WARMUP_LIST_PATH);
+    GraphicsPipelineCache::Get()->Warmup();
+}
+
+void RenderSystem::Destroy()
+{
+    EngineContext::ThreadPool()->WaitIdle(ENGINE_THREAD_TYPE_ASSET);     // 后台编译的管线需要在RHI销毁前完成
+    GraphicsPipelineCache::Get()->SaveWarmupList(EngineContext::File()->CachePath() + PIPELINE_WARMUP_LIST_PATH);
 }
 
 void RenderSystem::InitBaseResource()
@@ -84,9 +104,11 @@ void RenderSystem::InitBaseResource()
     queue         = backend->GetQueue({ QUEUE_TYPE_GRAPHICS, 0 });
     swapchain     = backend->CreateSwapChain({ surface, queue, FRAMES_IN_FLIGHT, surface->GetExetent(), COLOR_FORMAT });
     pool          = backend->CreateCommandPool({ queue });  
+    for(auto& workerPool : workerPools) workerPool = backend->CreateCommandPool({ queue });
     for(uint32_t i = 0; i < FRAMES_IN_FLIGHT; i++) 
     {
         perFrameCommonResources[i].command = pool->CreateCommandList(false);
+        for(auto& workerPool : workerPools) perFrameCommonResources[i].workerCommands.push_back(workerPool->CreateCommandList(false));
         perFrameCommonResources[i].startSemaphore = backend->CreateSemaphore();
         perFrameCommonResources[i].finishSemaphore = backend->CreateSemaphore();
         perFrameCommonResources[i].fence = backend->CreateFence(true);
@@ -166,7 +188,9 @@ void RenderSystem::InitPasses()
 bool RenderSystem::Tick()
 {
     ENGINE_TIME_SCOPE(RenderSystem::Tick);
-    if(!glfwWindowShouldClose(window))
+    bool shouldClose =  window ? glfwWindowShouldClose(window) :
+                        EngineContext::GetCurretTick() >= NULL_RHI_MAX_FRAMES;    // 无窗口时跑固定帧数后退出
+    if(!shouldClose)
     {
         if(EngineContext::World()->GetActiveScene() == nullptr) return false;
 
@@ -175,6 +199,17 @@ bool RenderSystem::Tick()
             auto& resource = perFrameCommonResources[EngineContext::ThreadPool()->ThreadFrameIndex()];
             resource.fence->Wait();                         // 等待帧栅栏，前一次本帧执行完毕后本帧才可重新开始收集和提交数据
         }    
+        {
+            ENGINE_TIME_SCOPE(RenderSystem::TickPools);     // 资源池的GC，此时上一帧的资源都已归还，工作线程也空闲
+            RDGBufferPool::Get()->Tick();
+            RDGTexturePool::Get()->Tick();
+            RDGTextureViewPool::Get()->Tick();
+            RDGDescriptorSetPool::Get(EngineContext::ThreadPool()->ThreadFrameIndex())->Tick();    // 描述符池每帧一个，只有本帧的会被使用
+            GraphicsPipelineCache::Get()->Tick();
+
+            uint32_t tick = EngineContext::GetCurretTick();    // 等到本帧栅栏时，FRAMES_IN_FLIGHT帧之前提交的上传已经执行完毕
+            if(tick >= FRAMES_IN_FLIGHT) UploadHeap::Get()->Retire(tick - FRAMES_IN_FLIGHT);
+        }
         {
             ENGINE_TIME_SCOPE(RenderSystem::TickManagers);
             // meshManager->Tick();             // 先准备各个meshpass的绘制信息
@@ -183,6 +218,8 @@ bool RenderSystem::Tick()
             // UpdateGlobalSetting(); 
             
             // 非常简单的并行  
+            // 平行光的级联视锥先在主线程算好，meshManager的CPU端剔除要读，不能和lightManager并行
+            lightManager->PrepareDirectionalLight();
             EngineContext::ThreadPool()->AddQueuedWork([this](){
                 surfaceCacheManager->Tick();
             });
@@ -198,7 +235,7 @@ bool RenderSystem::Tick()
             EngineContext::ThreadPool()->WaitIdle();
         }
         
-        BuildRDG(); // RDG的构建目前暂未支持多线程并行，只能串行；执行需要依赖于上面几个manager的数据处理结果
+        BuildRDG(); // RDG的构建目前暂未支持多线程并行，只能串行，录制是分段并行的；执行需要依赖于上面几个manager的数据处理结果
                     // 上面的WaitIdle该做成task graph的执行依赖
         ExecuteRDG();                             
         
@@ -224,7 +261,8 @@ void RenderSystem::BuildRDG()
 
     RHICommandListRef command = resource.command;   // 构建RDG，绘制提交
     command->BeginCommand();
-    rdgBuilder = std::make_shared<RDGBuilder>(command);
+    UploadHeap::Get()->Flush(command, EngineContext::GetCurretTick());     // 积累的资源上传放在本帧所有pass之前
+    rdgBuilder = std::make_shared<RDGBuilder>(command, resource.workerCommands);
     {
         ENGINE_TIME_SCOPE(RenderSystem::RDGBuild);
 
@@ -239,7 +277,7 @@ void RenderSystem::BuildRDG()
             { 
                 if(pass) 
                 {
-                    ENGINE_TIME_SCOPE_STR("RDGBuilder::BuildPass::" + pass->GetName());
+                    ENGINE_TIME_SCOPE_STR("RDGBuilder::BuildPass::", pass->GetName());
                     pass->Build(*rdgBuilder.get()); 
                 }
             }
@@ -251,11 +289,13 @@ void RenderSystem::ExecuteRDG()
 {
     ENGINE_TIME_SCOPE(RenderSystem::RDGExecute);
 
+    auto& resource = perFrameCommonResources[EngineContext::ThreadPool()->ThreadFrameIndex()];
     auto& rdgBuilder = rdgBuilders[EngineContext::ThreadPool()->ThreadFrameIndex()];
     if(rdgBuilder)
     {
         rdgBuilder->Execute();
         rdgDependencyGraph = rdgBuilder->GetGraph(); //
+        resource.recordedCommands = rdgBuilder->GetRecordedCommands();
     }
 }
 
@@ -267,7 +307,14 @@ void RenderSystem::SubmitRHI()
     RHITextureRef swapchainTexture = swapchain->GetNewFrame(nullptr, resource.startSemaphore);
     RHICommandListRef command = resource.command; 
     command->EndCommand();
-    command->Execute(resource.fence, resource.startSemaphore, resource.finishSemaphore);    // 指令提交
+    {
+        ENGINE_TIME_SCOPE(RenderSystem::ReplayCommands);    // 各段的指令列表来自不同的指令池，可以并行写入各自的command buffer
+        auto& recordedCommands = resource.recordedCommands;
+        EngineContext::ThreadPool()->ParallelFor(recordedCommands.size() + 1, [&](uint32_t index){
+            (index == 0 ? command : recordedCommands[index - 1])->Replay();
+        });
+    }
+    command->Execute(resource.recordedCommands, resource.fence, resource.startSemaphore, resource.finishSemaphore);    // 指令提交，各段按顺序合并为一次提交
     swapchain->Present(resource.finishSemaphore); 
 }
 
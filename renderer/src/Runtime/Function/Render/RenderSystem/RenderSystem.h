@@ -21,7 +21,7 @@ class RenderSystem
 {
 public:
     void Init();
-    void Destroy() {}
+    void Destroy();
     void InitGLFW();
     void DestroyGLFW();
 
@@ -61,11 +61,13 @@ private:
     RHIQueueRef queue;
     RHISwapchainRef swapchain;
     RHICommandPoolRef pool;
-    
+    std::array<RHICommandPoolRef, MAX_RDG_RECORDING_CHUNKS - 1> workerPools;     // RDG并行录制用，指令池不能被多个线程同时使用，每段一个
 
     struct PerFrameCommonResource 
     {
         RHICommandListRef command;
+        std::vector<RHICommandListRef> workerCommands;      // 各取自一个workerPools
+        std::vector<RHICommandListRef> recordedCommands;    // 本帧RDG实际录制了的workerCommands，按顺序跟在command后提交
         RHISemaphoreRef startSemaphore;
         RHISemaphoreRef finishSemaphore;
         RHIFenceRef fence;
@@ -311,6 +311,11 @@ bool FileSystem::LoadBinary(const std::string& filename, std::vector<uint8_t>& d
 	return true;
 }
 
+MappedFileRef FileSystem::MapBinary(const std::string& filename)
+{
+    return MappedFile::Open(Absolute(filename));
+}
+
 bool FileSystem::WriteString(const std::string& filename, const std::string& str)
 {
     std::string name = this->root.generic_string();
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "MappedFile.h"
+
 #include <string>
 #include <vector>
 #include <filesystem>
@@ -21,6 +23,7 @@ public:
 
 	std::string AssetPath() 		{ return "Asset/"; }				// 写死的固定路径
     std::string TempAssetPath() 	{ return "Asset/Temp/"; }
+	std::string CachePath() 		{ return "Asset/Cache/"; }			// 各种可以随时删除重新生成的缓存
 	std::string BuildInAssetPath()	{ return "Asset/BuildIn/"; }
 	std::string ShaderPath()		{ return "Asset/BuildIn/Shader/"; }
 	std::string FontPath()			{ return "Asset/BuildIn/Font/"; }
@@ -54,6 +57,7 @@ public:
 	void RenameFile(const std::string& dir, const std::string& oldName, const std::string& newName);
 
 	bool LoadBinary(const std::string& filename, std::vector<uint8_t>& data);
+	MappedFileRef MapBinary(const std::string& filename);				// 只读映射，文件不存在时返回nullptr
 	bool WriteString(const std::string& filename, const std::string& str);
 	bool LoadString(const std::string& filename, std::string& str);
 
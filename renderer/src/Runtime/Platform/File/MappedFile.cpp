@@ -0,0 +1,64 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#undef CreateFile
+#undef CreateMutex
+#undef CreateSemaphore
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <memory>
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& absolutePath)
+{
+	std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+
+#if defined(_WIN32)
+	HANDLE handle = CreateFileA(absolutePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if(handle == INVALID_HANDLE_VALUE) return nullptr;
+	file->fileHandle = handle;
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0) return nullptr;
+	file->size = fileSize.QuadPart;
+
+	HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(mapping == nullptr) return nullptr;
+	file->mappingHandle = mapping;
+
+	file->data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(file->data == nullptr) return nullptr;
+#else
+	int fd = open(absolutePath.c_str(), O_RDONLY);
+	if(fd < 0) return nullptr;
+	file->fileHandle = (void*)(intptr_t)(fd + 1);	// 加1避免描述符0和空指针混淆
+
+	struct stat fileStat;
+	if(fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) return nullptr;
+	file->size = fileStat.st_size;
+
+	void* data = mmap(nullptr, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if(data == MAP_FAILED) return nullptr;
+	file->data = (const uint8_t*)data;
+#endif
+
+	return file;
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(_WIN32)
+	if(data) 			UnmapViewOfFile(data);
+	if(mappingHandle) 	CloseHandle((HANDLE)mappingHandle);
+	if(fileHandle) 		CloseHandle((HANDLE)fileHandle);
+#else
+	if(data) 			munmap((void*)data, size);
+	if(fileHandle) 		close((int)(intptr_t)fileHandle - 1);
+#endif
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// 只读的内存映射文件，映射期间数据直接由操作系统按页读入，不经过额外的拷贝
+class MappedFile
+{
+public:
+	static std::shared_ptr<MappedFile> Open(const std::string& absolutePath);	// 文件不存在或为空时返回nullptr
+
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	inline const uint8_t* Data() const 	{ return data; }
+	inline uint64_t Size() const 		{ return size; }
+
+private:
+	const uint8_t* data = nullptr;
+	uint64_t size = 0;
+
+	void* fileHandle = nullptr;			// windows下为文件和映射对象句柄，其他平台为文件描述符
+	void* mappingHandle = nullptr;
+};
+typedef std::shared_ptr<MappedFile> MappedFileRef;
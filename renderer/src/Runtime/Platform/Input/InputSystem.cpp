@@ -23,6 +23,7 @@ bool InputSystem::mouseButtonShouldUpdate[MOUSE_BUTTON_TYPE_MAX_ENUM] = { false
 void InputSystem::InitGLFW()
 {
     window = EngineContext::Render()->GetWindow();
+    if(window == nullptr) return;
 
     // glfwSetWindowUserPointer(window, this);
     // glfwSetWindowSizeCallback(window, nullptr); //TODO
@@ -39,7 +40,7 @@ void InputSystem::Tick()
     mousePositionPreviousX = mousePositionX;
     mousePositionPreviousY = mousePositionY;
 
-    glfwPollEvents(); // 更新回调函数
+    if(window) glfwPollEvents(); // 更新回调函数
 
     mouseDeltaX = (float)mousePositionX - mousePositionPreviousX;
     mouseDeltaY = (float)mousePositionY - mousePositionPreviousY;
@@ -2,28 +2,54 @@
 #include "QueuedThreadPool.h"
 #include "Core/Log/Log.h"
 
+#include <atomic>
 #include <cassert>
 
+thread_local QueuedThread* QueuedThread::currentThread = nullptr;
+
+static const uint32_t QUEUED_THREAD_SPIN_COUNT = 64;
+
 uint32_t QueuedRunnable::Run() 
 {
+	QueuedThread::currentThread = ownerThread;
+	QueuedThreadPool* pool = ownerThread->ownerPool;
+
+	uint32_t idleCount = 0;
 	while (!timeToDie)
 	{
-		doWorkEvent->Wait();
-		if(timeToDie) break;
-
-		QueuedWorkRef localQueuedWork = queuedWork;
-		queuedWork = nullptr;
+		QueuedWorkRef work = pool->GetNextWork(ownerThread);
+		if (work)
+		{
+			pool->ExecuteWork(work);
+			idleCount = 0;
+			continue;
+		}
+		if (++idleCount < QUEUED_THREAD_SPIN_COUNT)		// 任务通常成批提交，睡眠前先让出几次时间片，减少唤醒开销
+		{
+			PlatformProcess::Sleep(0.0f);
+			continue;
+		}
+		idleCount = 0;
 
-		assert(localQueuedWork != nullptr);		
-		while (localQueuedWork)
+		// 先标记睡眠再检查一次队列，和提交线程的先入队再检查睡眠标记配对，避免丢失唤醒
+		sleeping.store(true);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (pool->HasWork() || timeToDie)
 		{
-			localQueuedWork->DoThreadedWork();
-			localQueuedWork = ownerThread->TryGetNextWork();
+			if (sleeping.exchange(false)) continue;		// 被唤醒时事件已触发，下次Wait会直接返回，无害
 		}
+		doWorkEvent->Wait();
+		sleeping.store(false);
 	}
+	QueuedThread::currentThread = nullptr;
 	return 0;
 }
 
+void QueuedThread::StartThread(uint32_t stackSize, ThreadPriorityType priority)
+{
+	thread = RunnableThread::Create(runnable, stackSize, priority);
+}
+
 void QueuedThread::KillThread()
 {
 	runnable->timeToDie = true;
@@ -32,14 +58,14 @@ void QueuedThread::KillThread()
 	thread->WaitForCompletion();
 }
 
-void QueuedThread::StartWork(QueuedWorkRef queuedWork)    //仅在未启动时调用
+bool QueuedThread::Wake()
 {
-	if(runnable->queuedWork != nullptr) LOG_DEBUG("QueuedThread is already working!");
-	runnable->queuedWork = queuedWork;
+	if (!runnable->sleeping.load() || !runnable->sleeping.exchange(false)) return false;
 	runnable->doWorkEvent->Trigger();
+	return true;
 }
 
-QueuedWorkRef QueuedThread::TryGetNextWork()
+QueuedThread* QueuedThread::Current()
 {
-	return ownerPool->ReturnToPoolOrGetNextWork(this);
-}
\ No newline at end of file
+	return currentThread;
+}
@@ -2,7 +2,10 @@
 
 #include "Platform/HAL/PlatformProcess.h"
 #include "QueuedWork.h"
+#include "WorkStealingQueue.h"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 
 class QueuedThread;
@@ -15,18 +18,18 @@ public:
 
     QueuedRunnable(QueuedThread* owner)
     : timeToDie(false)
-    , queuedWork(nullptr)
     , doWorkEvent(PlatformProcess::CreateSyncEvent(false))
     , ownerThread(owner)
     {}
 
 protected:
-    bool timeToDie;
-    QueuedWorkRef queuedWork;
+    std::atomic<bool> timeToDie;
+    std::atomic<bool> sleeping = false;     // 没有任务可做，正在等待doWorkEvent
     SyncEventRef doWorkEvent;
     QueuedThread* ownerThread;
 
     friend class QueuedThread;
+    friend class QueuedThreadPool;
 };
 typedef std::shared_ptr<QueuedRunnable> QueuedRunnableRef;
 
@@ -37,13 +40,14 @@ class QueuedThread
 public:
 	static QueuedThreadRef Create(
         QueuedThreadPool* pool, 
+        uint32_t index,
         uint32_t stackSize = 0, 
         ThreadPriorityType priority = PRIORITY_TYPE_NORMAL)
 	{
         QueuedThreadRef queuedThread = std::make_shared<QueuedThread>();
 		queuedThread->ownerPool = pool;
+        queuedThread->index = index;
         queuedThread->runnable = std::make_shared<QueuedRunnable>(queuedThread.get());
-		queuedThread->thread = RunnableThread::Create(queuedThread->runnable, stackSize, priority);
 
         return queuedThread;
 	}
@@ -51,15 +55,24 @@ public:
     QueuedThread() = default;
     ~QueuedThread() {};
 	
+    void StartThread(uint32_t stackSize, ThreadPriorityType priority);     // 池内全部线程创建完成后再启动，线程间会互相窃取
 	void KillThread();
-	void StartWork(QueuedWorkRef queuedWork);    //仅在未启动时调用
-    QueuedWorkRef TryGetNextWork();
+    bool Wake();                                                            // 线程在睡眠时唤醒，返回是否唤醒
 
-private:
-    
+    static QueuedThread* Current();                                         // 当前线程对应的池内线程，不是池内线程时为nullptr
+    QueuedThreadPool* GetOwnerPool() const                                  { return ownerPool; }
+    uint32_t GetIndex() const                                               { return index; }
 
+private:
     QueuedRunnableRef runnable;
 	RunnableThreadRef thread;
 
 	QueuedThreadPool* ownerPool = nullptr;
-};
\ No newline at end of file
+    uint32_t index = 0;
+    WorkStealingQueue<QueuedWork*> localWorks;                              // 本线程提交的任务，其他线程从另一端窃取
+
+    static thread_local QueuedThread* currentThread;
+
+    friend class QueuedRunnable;
+    friend class QueuedThreadPool;
+};
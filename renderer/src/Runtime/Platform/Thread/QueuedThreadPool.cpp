@@ -5,6 +5,8 @@
 #include "QueuedThread.h"
 #include "QueuedWork.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <memory>
@@ -20,10 +22,9 @@ QueuedThreadPoolRef QueuedThreadPool::Create(
 
     for (uint32_t i = 0; i < numThreads; i++)
     {
-        QueuedThreadRef thread = QueuedThread::Create(pool.get(), stackSize, priority);
-        pool->idleThreads.push(thread.get());
-        pool->allThreads.push_back(thread);
+        pool->allThreads.push_back(QueuedThread::Create(pool.get(), i, stackSize, priority));
     }
+    for (auto& thread : pool->allThreads) thread->StartThread(stackSize, priority);     // 线程启动后就会互相窃取，需要全部创建完成
     return pool;
 }
 
@@ -31,93 +32,222 @@ void QueuedThreadPool::AddQueuedWork(QueuedWorkRef queuedWork)
 {
     assert(queuedWork != nullptr);
 
+    // 销毁后提交的任务也要计数并走ScheduleWork，由AbandonWork标记完成并释放后继，否则等待它的线程会一直等下去
+    numPendingWorks.fetch_add(1);
+    queuedWork->ownerPool = this;
+    queuedWork->self = queuedWork;
+    if (queuedWork->pendingDependencies.fetch_sub(1) == 1) ScheduleWork(queuedWork.get());
+}
+
+void QueuedThreadPool::ScheduleWork(QueuedWork* work)
+{
     if (timeToDie)
     {
-        queuedWork->Abandon();
+        AbandonWork(work);
         return;
     }
 
-    QueuedThread* thread = nullptr;
+    // 只有一个线程的池要保证提交顺序（例如RHI），不能进后进先出的本地队列
+    QueuedThread* thread = QueuedThread::Current();
+    if (thread && thread->ownerPool == this && work->priority == WORK_PRIORITY_NORMAL && allThreads.size() > 1) 
+    {
+        thread->localWorks.Push(work);
+    }
+    else
     {
         ScopeLock lock(sync);   //加锁
-        if (idleThreads.size() == 0)
-        {
-            works.push(queuedWork);
-            return;
-        }
-
-        thread = idleThreads.front();
-        idleThreads.pop();
+        globalWorks[work->priority].push_back(work);
+        numGlobalWorks.fetch_add(1);
+        if (work->priority < WORK_PRIORITY_NORMAL) numUrgentWorks.fetch_add(1);
     }
+    WakeThread();
+}
 
-    thread->StartWork(queuedWork);
+void QueuedThreadPool::ExecuteWork(const QueuedWorkRef& work)
+{
+    work->DoThreadedWork();
+    FinishWork(work.get());
 }
 
-void QueuedThreadPool::WaitIdle()
+void QueuedThreadPool::AbandonWork(QueuedWork* work)
 {
-    while (true)
+    QueuedWorkRef ref = std::move(work->self);
+    ref->Abandon();
+    FinishWork(ref.get());      // 依赖该任务的任务也会被放弃
+}
+
+void QueuedThreadPool::FinishWork(QueuedWork* work)
+{
+    std::vector<QueuedWork*> continuations;
+    work->LockContinuations();
+    work->finished.store(true, std::memory_order_release);
+    continuations.swap(work->continuations);
+    work->UnlockContinuations();
+
+    for (QueuedWork* continuation : continuations)
     {
-        ScopeLock lock(sync);   //加锁
-        if (allThreads.size() == idleThreads.size()) 
-            break;
-        
-        PlatformProcess::Sleep(0.0001f); 
+        if (continuation->pendingDependencies.fetch_sub(1) == 1) continuation->ownerPool->ScheduleWork(continuation);
     }
+    numPendingWorks.fetch_sub(1);   // 后继已经计入，这里减到0时确实没有剩余任务
 }
 
-void QueuedThreadPool::Destroy()
+QueuedWorkRef QueuedThreadPool::PopGlobalWork(bool urgentOnly)
 {
-   {
-        timeToDie = true;
-        ScopeLock lock(sync);   //加锁
-        while (works.size() > 0)
-        {   
-            QueuedWorkRef work = works.top();   
-            works.pop();
-            work->Abandon();
-        }
-    }
-    while (true)
+    ScopeLock lock(sync);   //加锁
+    uint32_t end = urgentOnly ? WORK_PRIORITY_NORMAL : WORK_PRIORITY_MAX_ENUM;
+    for (uint32_t priority = 0; priority < end; priority++)
     {
-        {
-            ScopeLock lock(sync);   //加锁
-            if (allThreads.size() == idleThreads.size()) 
-            {            
-                while (idleThreads.size() > 0)
-                {
-                    QueuedThread* thread = idleThreads.front();
-                    thread->KillThread();
-                    idleThreads.pop();
-                }
-                allThreads.clear();
-                break;
-            }
-        }        
-        PlatformProcess::Sleep(0.0f); 
+        if (globalWorks[priority].empty()) continue;
+
+        QueuedWork* work = globalWorks[priority].front();
+        globalWorks[priority].pop_front();
+        numGlobalWorks.fetch_sub(1);
+        if (priority < WORK_PRIORITY_NORMAL) numUrgentWorks.fetch_sub(1);
+        return std::move(work->self);
     }
+    return nullptr;
 }
 
-QueuedWorkRef QueuedThreadPool::ReturnToPoolOrGetNextWork(QueuedThread* queuedThread)   //由QueuedThread调用
+QueuedWorkRef QueuedThreadPool::GetNextWork(QueuedThread* thread)
 {
-    assert(queuedThread != nullptr);
+    // 高优先级的全局任务 > 本地队列 > 其余全局任务 > 窃取
     QueuedWorkRef work = nullptr;
+    if (numUrgentWorks.load(std::memory_order_relaxed) > 0) work = PopGlobalWork(true);
+    if (work) return work;
+
+    if (thread)
+    {
+        QueuedWork* local = thread->localWorks.Pop();
+        if (local) return std::move(local->self);
+    }
+
+    if (numGlobalWorks.load(std::memory_order_relaxed) > 0) work = PopGlobalWork(false);
+    if (work) return work;
+
+    uint32_t numThreads = allThreads.size();
+    uint32_t start = thread ? thread->index + 1 : 0;
+    for (uint32_t i = 0; i < numThreads; i++)
+    {
+        QueuedThread* victim = allThreads[(start + i) % numThreads].get();
+        if (victim == thread) continue;
+
+        QueuedWork* stolen = victim->localWorks.Steal();
+        if (stolen) return std::move(stolen->self);
+    }
+    return nullptr;
+}
+
+bool QueuedThreadPool::HasWork()
+{
+    if (numGlobalWorks.load() > 0) return true;
+    for (auto& thread : allThreads) if (!thread->localWorks.Empty()) return true;
+    return false;
+}
+
+void QueuedThreadPool::WakeThread()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);    // 和QueuedRunnable::Run中的睡眠检查配对
+    for (auto& thread : allThreads)
     {
-        ScopeLock lock(sync);   //加锁 
+        if (thread->Wake()) return;
+    }
+}
+
+bool QueuedThreadPool::CanHelp()
+{
+    QueuedThread* thread = QueuedThread::Current();
+    return (thread && thread->ownerPool == this) || allThreads.size() > 1;
+}
+
+bool QueuedThreadPool::TryExecuteWork()
+{
+    QueuedThread* thread = QueuedThread::Current();
+    if (thread && thread->ownerPool != this) thread = nullptr;  // 其他池的线程，按池外线程处理
+
+    QueuedWorkRef work = GetNextWork(thread);
+    if (!work) return false;
+
+    ExecuteWork(work);
+    return true;
+}
+
+void QueuedThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func)
+{
+    if (count == 0) return;
+
+    struct ParallelForState     // 已入队但还未开始执行的任务可能在本函数返回后才运行，状态需要共享持有
+    {
+        std::function<void(uint32_t)> func;
+        uint32_t count;
+        std::atomic<uint32_t> next = 0;
+        std::atomic<uint32_t> finished = 0;
+        SyncEventRef doneEvent;
+    };
+    std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+    state->func = func;
+    state->count = count;
+    state->doneEvent = PlatformProcess::CreateSyncEvent(true);
 
-        cnt++;
-        if(cnt % 1000 == 0)  
+    auto work = [state]() {
+        uint32_t index;
+        while ((index = state->next.fetch_add(1)) < state->count)
         {
-            //LOG_DEBUG("QueuedThreadPool finished %d works", cnt);
-            //cnt = 0;
+            state->func(index);
+            if (state->finished.fetch_add(1) + 1 == state->count) state->doneEvent->Trigger();
         }
+    };
+
+    uint32_t numWorks = std::min(count - 1, (uint32_t)allThreads.size());
+    for (uint32_t i = 0; i < numWorks; i++) AddQueuedWork(std::make_shared<QueuedWork>(work));
+
+    work();
+
+    // 调用线程返回时所有下标都已被领取，剩余的正在其他线程上执行，直接阻塞等待即可
+    // 正在执行的下标不会反过来等待本次调用，嵌套调用也不会死锁；还在队列中的任务之后执行时直接返回
+    if (state->finished.load() < count) state->doneEvent->Wait();
+}
 
-        if (works.size() > 0)
+void QueuedThreadPool::WaitIdle(const std::function<void()>& onWait)
+{
+    bool help = CanHelp();
+    while (numPendingWorks.load() > 0)
+    {
+        if (onWait) onWait();
+        if (!help || !TryExecuteWork()) PlatformProcess::Sleep(0.0f);
+    }
+}
+
+void QueuedThreadPool::Wait(const QueuedWorkRef& work)
+{
+    bool help = CanHelp();
+    while (!work->IsFinished())
+    {
+        if (!help || !TryExecuteWork()) PlatformProcess::Sleep(0.0f);
+    }
+}
+
+void QueuedThreadPool::Destroy()
+{
+    if (allThreads.empty()) return;
+
+    timeToDie = true;
+    std::vector<QueuedWork*> abandoned;
+    {
+        ScopeLock lock(sync);   //加锁
+        for (auto& works : globalWorks)
         {
-            work = works.top();
-            works.pop();
+            abandoned.insert(abandoned.end(), works.begin(), works.end());
+            works.clear();
         }
+        numGlobalWorks = 0;
+        numUrgentWorks = 0;
+    }
+    for (QueuedWork* work : abandoned) AbandonWork(work);
 
-        if (!work) idleThreads.push(queuedThread);
+    for (auto& thread : allThreads) thread->KillThread();     // 正在执行的任务会先完成
+    for (auto& thread : allThreads)
+    {
+        while (QueuedWork* work = thread->localWorks.Pop()) AbandonWork(work);
     }
-    return work;
-}
\ No newline at end of file
+    allThreads.clear();
+}
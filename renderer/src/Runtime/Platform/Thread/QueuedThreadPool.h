@@ -5,12 +5,19 @@
 #include "Platform/HAL/RunnableThread.h"
 #include "Platform/HAL/Mutex.h"
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
-#include <queue>
 #include <string>
 #include <vector>
 
+// 工作窃取线程池
+// 每个池内线程有自己的无锁双端队列，池内线程提交的普通优先级任务进入自己的队列，空闲线程从其他线程的队列窃取
+// 池外线程提交的任务，非普通优先级的任务和只有一个线程的池的任务进入按优先级分组的全局队列，只有这里需要加锁
+// 等待（WaitIdle，Wait）时调用线程会帮忙执行池内任务而不是睡眠；ParallelFor的调用线程领取下标执行，领完后阻塞；只有一个线程的池用于保证执行顺序（例如RHI），池外线程不帮忙
 
 typedef std::shared_ptr<class QueuedThreadPool> QueuedThreadPoolRef;
 class QueuedThreadPool
@@ -25,20 +32,37 @@ public:
         ThreadPriorityType priority = PRIORITY_TYPE_NORMAL, 
         const std::string& name = "");
 
-	void WaitIdle();
+	void WaitIdle(const std::function<void()>& onWait = nullptr);	// 等待已提交的全部任务完成，包括还在等待依赖的任务；onWait在每次轮询时调用
+	void Wait(const QueuedWorkRef& work);			// 等待单个任务完成
 	void Destroy();
-	void AddQueuedWork(QueuedWorkRef queuedWork);
+	void AddQueuedWork(QueuedWorkRef queuedWork);	// 提交任务，有未完成的依赖（QueuedWork::AddDependency）时暂缓到依赖完成后入队
 	int32_t GetNumThreads() const { return allThreads.size(); }
+
+	// 将[0, count)分发到池内线程执行，调用线程也参与执行，领取不到新的下标后阻塞到全部完成
+	// 调用线程本身可以是池内线程（嵌套调用），池内线程都繁忙时退化为调用线程串行执行，不会死锁
+	void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func);
 	
 private:
-	std::priority_queue<QueuedWorkRef, std::vector<QueuedWorkRef>, QueuedWork::Compare> works = {};      // 所有暂未执行的任务
-	std::queue<QueuedThread*> idleThreads = {};       	// 暂未运行的线程
 	std::vector<QueuedThreadRef> allThreads = {};       // 所有分配的线程
 
-	MutexRef sync;							// 临界区，锁线程资源
-	bool timeToDie;
-	uint32_t cnt;
+	std::array<std::deque<QueuedWork*>, WORK_PRIORITY_MAX_ENUM> globalWorks = {};	// 池外提交的任务，按优先级分组，组内先进先出
+	std::atomic<uint32_t> numGlobalWorks = 0;			// 无锁判断全局队列是否为空
+	std::atomic<uint32_t> numUrgentWorks = 0;			// 高于普通优先级的任务，池内线程优先于本地队列处理
+	MutexRef sync;										// 仅保护globalWorks
+
+	std::atomic<uint32_t> numPendingWorks = 0;			// 已提交未完成的任务数，包括等待依赖的
+	std::atomic<bool> timeToDie = false;
+
+	void ScheduleWork(QueuedWork* work);				// 依赖已满足，实际入队
+	void ExecuteWork(const QueuedWorkRef& work);
+	void AbandonWork(QueuedWork* work);
+	void FinishWork(QueuedWork* work);
+	QueuedWorkRef GetNextWork(QueuedThread* thread);	// thread为nullptr时表示池外线程帮忙执行
+	QueuedWorkRef PopGlobalWork(bool urgentOnly);
+	bool TryExecuteWork();
+	bool CanHelp();
+	bool HasWork();
+	void WakeThread();
 
-	QueuedWorkRef ReturnToPoolOrGetNextWork(QueuedThread* queuedThread);
-	friend class QueuedThread;
+	friend class QueuedRunnable;
 };
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <vector>
 
 enum QueuedWorkPriority
 {
@@ -21,8 +24,9 @@ class QueuedWork
 {
 public:
     QueuedWork() = default;
-    QueuedWork(QueuedWorkFunc func)
-    : func(func)
+    QueuedWork(QueuedWorkFunc func, QueuedWorkPriority priority = WORK_PRIORITY_NORMAL)
+    : priority(priority)
+    , func(func)
     {}
 
     virtual void DoThreadedWork() 
@@ -33,6 +37,22 @@ public:
         //delete this;
     }
 
+    inline QueuedWorkPriority GetPriority() const { return priority; }
+    inline bool IsFinished() const              { return finished.load(std::memory_order_acquire); }
+
+    // 本任务需要在dependency执行完成后才能执行，只能在提交本任务之前调用
+    // 依赖可以属于其他线程池；提交后本任务暂存在依赖的后继列表中，最后一个依赖完成时才真正入队
+    void AddDependency(const QueuedWorkRef& dependency)
+    {
+        dependency->LockContinuations();
+        if(!dependency->finished.load(std::memory_order_relaxed))
+        {
+            pendingDependencies.fetch_add(1);
+            dependency->continuations.push_back(this);
+        }
+        dependency->UnlockContinuations();
+    }
+
     virtual void Abandon()
     {
         // not supported
@@ -50,12 +70,26 @@ public:
     };
 
 protected:
+    void LockContinuations()                    { while(continuationLock.test_and_set(std::memory_order_acquire)); }
+    void UnlockContinuations()                  { continuationLock.clear(std::memory_order_release); }
+
     // TUniqueFunction<ResultType()> Function; // 被执行的函数列表.
     // TPromise<ResultType> Promise; // 用于同步的对象
 
     QueuedWorkPriority priority = WORK_PRIORITY_NORMAL;
 
     QueuedWorkFunc func = nullptr;
+
+private:
+    std::atomic<uint32_t> pendingDependencies = 1;     // 额外的1在提交时减掉，避免提交前就被依赖触发执行
+    std::atomic<bool> finished = false;
+    std::atomic_flag continuationLock = ATOMIC_FLAG_INIT;
+    std::vector<QueuedWork*> continuations;             // 依赖本任务的任务，由线程池持有到入队
+
+    class QueuedThreadPool* ownerPool = nullptr;
+    QueuedWorkRef self;                                 // 入队期间持有自身，队列内只存裸指针
+
+    friend class QueuedThreadPool;
 };
 
  
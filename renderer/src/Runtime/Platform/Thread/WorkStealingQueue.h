@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// Chase-Lev工作窃取双端队列（按C11内存模型修正的版本，Lê et al. 2013）
+// 所属线程在底部Push/Pop（后进先出，缓存友好），其他线程在顶部Steal（先进先出），均无锁
+// 容量不足时所属线程扩容，旧数组可能仍被窃取线程读取，保留到队列析构时再释放
+template<typename Type>
+class WorkStealingQueue
+{
+    static_assert(std::is_pointer<Type>::value, "WorkStealingQueue only stores pointers");
+
+public:
+    WorkStealingQueue(int64_t capacity = 1024)
+    {
+        int64_t size = 1;
+        while (size < capacity) size <<= 1;
+        array.store(new Array(size), std::memory_order_relaxed);
+    }
+
+    ~WorkStealingQueue()
+    {
+        for (Array* old : garbage) delete old;
+        delete array.load(std::memory_order_relaxed);
+    }
+
+    WorkStealingQueue(const WorkStealingQueue&) = delete;
+    WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+    void Push(Type item)        // 仅所属线程调用
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Array* a = array.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) a = Grow(a, t, b);
+
+        a->Put(b, item);
+        bottom.store(b + 1, std::memory_order_release);     // 原文为release栅栏加relaxed写，效果相同
+    }
+
+    Type Pop()                  // 仅所属线程调用，为空时返回nullptr
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        Type item = nullptr;
+        if (t <= b)
+        {
+            item = a->Get(b);
+            if (t == b)         // 最后一个元素，和窃取线程竞争
+            {
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) item = nullptr;
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        }
+        else bottom.store(b + 1, std::memory_order_relaxed);
+        return item;
+    }
+
+    Type Steal()                // 任意线程调用，为空或竞争失败时返回nullptr
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+
+        if (t < b)
+        {
+            Array* a = array.load(std::memory_order_acquire);
+            Type item = a->Get(t);
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) return nullptr;
+            return item;
+        }
+        return nullptr;
+    }
+
+    bool Empty() const
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_relaxed);
+        return b <= t;
+    }
+
+private:
+    struct Array
+    {
+        int64_t capacity;
+        int64_t mask;
+        std::atomic<Type>* items;
+
+        Array(int64_t capacity)
+        : capacity(capacity)
+        , mask(capacity - 1)
+        , items(new std::atomic<Type>[capacity])
+        {}
+
+        ~Array() { delete[] items; }
+
+        Type Get(int64_t i) const           { return items[i & mask].load(std::memory_order_relaxed); }
+        void Put(int64_t i, Type item)      { items[i & mask].store(item, std::memory_order_relaxed); }
+    };
+
+    Array* Grow(Array* a, int64_t t, int64_t b)
+    {
+        Array* newArray = new Array(a->capacity * 2);
+        for (int64_t i = t; i < b; i++) newArray->Put(i, a->Get(i));
+        garbage.push_back(a);
+        array.store(newArray, std::memory_order_release);
+        return newArray;
+    }
+
+    alignas(64) std::atomic<int64_t> top = 0;       // 避免和bottom伪共享
+    alignas(64) std::atomic<int64_t> bottom = 0;
+    alignas(64) std::atomic<Array*> array;
+    std::vector<Array*> garbage;                    // 仅所属线程访问
+};
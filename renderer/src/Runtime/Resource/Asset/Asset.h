@@ -32,6 +32,8 @@ public:
 	virtual AssetType GetAssetType() 			{ return ASSET_TYPE_UNKNOWN; }		// 类型枚举
     virtual void OnLoadAsset() {};													// 反序列化后，实际申请资源时调用以初始化对象
 	virtual void OnSaveAsset() {};													// 序列化前，完成资源绑定等保存前的准备工作
+	virtual void OnPrepareAsset() {};												// 异步加载时在工作线程上先于OnLoadAsset调用，此时依赖的资源都已可用；只做读文件，解码等CPU端工作，不能访问RHI
+	virtual void GetDependencies(std::vector<UID>& dependencies) {};				// 异步加载时需要先行加载的资源，AssetBinder绑定的资源会自动收集，不需要重复添加
     
     inline const UID& GetUID()                  { return uid; }						// 全局唯一标识符，主键
 
@@ -48,6 +50,16 @@ typedef std::shared_ptr<Asset> AssetRef;
 
 class AssetBinder
 {
+public:
+	void GetBindedAssets(std::vector<UID>& uids) const					// 绑定的全部非空资源
+	{
+		for(auto& pair : assetMap) 		if(!pair.second.IsEmpty()) uids.push_back(pair.second);
+		for(auto& pair : assetArrayMap)
+		{
+			for(auto& uid : pair.second) 	if(!uid.IsEmpty()) uids.push_back(uid);
+		}
+	}
+
 protected:
 	std::unordered_map<std::string, UID> assetMap;
 	std::unordered_map<std::string, std::vector<UID>> assetArrayMap;
@@ -1,40 +1,136 @@
 #include "AssetManager.h"
 #include "Core/UID/UID.h"
 #include "Function/Global/EngineContext.h"
+#include "Function/Global/EngineThreadPool.h"
 #include "Platform/File/FileSystem.h"
+#include "Platform/HAL/PlatformProcess.h"
+#include "Platform/HAL/ScopeLock.h"
 #include "Resource/Asset/Asset.h"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
+
+static inline float MilliSecondsBetween(TimePoint begin, TimePoint end)
+{
+	return std::chrono::duration<float, std::milli>(end - begin).count();
+}
+
+float AssetLoadStatistics::AverageLatency() const
+{
+	return loadedCount > 0 ? totalLatency / loadedCount : 0.0f;
+}
+
+float AssetLoadStatistics::Throughput() const
+{
+	float seconds = MilliSecondsBetween(firstRequestTime, lastLoadedTime) / 1000.0f;
+	return seconds > 0.0f ? loadedCount / seconds : 0.0f;
+}
+
+AssetRequest::AssetRequest()
+: doneEvent(PlatformProcess::CreateSyncEvent(true))
+{}
+
+AssetManager::AssetManager()
+: sync(PlatformProcess::CreateMutex())
+, uploadEvent(PlatformProcess::CreateSyncEvent())
+{}
 
 void AssetManager::Init()
 {
-	// 初始化时扫描和加载目标路径下的全部资源，后续也可通过GetOrLoadAsset继续加载
+	// 初始化时扫描目标路径下的全部资源并反序列化（不初始化），后续也可通过GetOrLoadAsset继续加载
+	// 文件之间相互独立，在资源线程池上并行读取
+	std::vector<std::string> paths;
 	for(auto& path : EngineContext::File()->Traverse(EngineContext::File()->AssetPath(), true))
 	{
 		std::string extention = EngineContext::File()->Extension(path);
-		if(	extention == "asset" || 
+		if(path.ends_with(".modelCache.binasset"))		// 旧版cereal格式的模型缓存，类型已经移除，现在的缓存在CachePath下
+		{
+			ENGINE_LOG_WARN("Skipping legacy model cache {}, it is no longer used and can be deleted", path);
+			continue;
+		}
+		if(	extention == "asset" ||
 			extention == "binasset")
 		{
-			ENGINE_LOG_INFO("Pre loading asset {} from file...", path);
-			LoadAsset(path, false);
+			paths.push_back(path);
 		}
 	}
+
+	std::vector<AssetRef> loadedAssets(paths.size());
+	EngineContext::ThreadPool()->GetThreadPool(ENGINE_THREAD_TYPE_ASSET)->ParallelFor(paths.size(), [&](uint32_t i) {
+		loadedAssets[i] = DeserializeAsset(paths[i]);
+	});
+
+	ScopeLock lock(sync);
+	for(uint32_t i = 0; i < paths.size(); i++)
+	{
+		if(!loadedAssets[i]) continue;
+
+		ENGINE_LOG_INFO("Pre loading asset {} from file...", paths[i]);
+		uninitializedAssets[loadedAssets[i]->GetUID()] = loadedAssets[i];
+		UpdateFilePathAndUID(paths[i], loadedAssets[i]->GetUID());
+	}
 }
 
 void AssetManager::Tick()
 {
 	ENGINE_TIME_SCOPE(AssetManager::Tick);
-	for(auto& asset : assets)
+	ScopeLock lock(sync);
+	for(auto iter = assets.begin(); iter != assets.end();)
 	{
-		if(asset.second.use_count() == 1)	//每帧检查，只在manager处有引用的资源就释放掉了
+		if(iter->second.use_count() == 1)	//每帧检查，只在manager处有引用的资源就释放掉了
 		{
-			ENGINE_LOG_INFO("Asset [{}] [{}] released.", asset.second->GetAssetTypeName(), asset.second->GetUID().ToString());
-			assets.erase(asset.first);
+			ENGINE_LOG_INFO("Asset [{}] [{}] released.", iter->second->GetAssetTypeName(), iter->second->GetUID().ToString());
+			iter = assets.erase(iter);
 		}
+		else iter++;
 	}
 }
 
+void AssetManager::UpdateStreaming(float budgetMilliSeconds)
+{
+	if(!EngineContext::ThreadPool()->IsMainThread())		// OnLoadAsset会创建RHI资源，申请bindless索引等，只能在主线程执行
+	{
+		ENGINE_LOG_WARN("Asset streaming can only be updated on main thread!");
+		return;
+	}
+
+	TimeScope budgetTimer;
+	budgetTimer.Begin();
+	while(true)
+	{
+		AssetRequestRef request;
+		{
+			ScopeLock lock(sync);
+			if(uploadQueue.empty()) break;
+
+			auto iter = std::min_element(uploadQueue.begin(), uploadQueue.end(), [](const AssetRequestRef& a, const AssetRequestRef& b) {
+				return a->priority < b->priority;		// 优先级高的先上传，同优先级的按准备完成的顺序
+			});
+			request = *iter;
+			uploadQueue.erase(iter);
+		}
+
+		TimeScope timer;
+		timer.Begin();
+		request->asset->OnLoadAsset();
+		timer.End();
+		FinishRequest(request, true, timer.GetMilliSeconds());
+
+		budgetTimer.End();
+		if(budgetTimer.GetMilliSeconds() >= budgetMilliSeconds) break;	// 至少处理一个，剩余的留到下一帧
+	}
+}
+
+void AssetManager::ServeBlockingRequests()
+{
+	// 等待的资源的依赖可能还排在上传队列的后面，全部上传
+	if(numBlockingWaits.load() > 0) UpdateStreaming(std::numeric_limits<float>::max());
+}
+
 void AssetManager::Save()
 {
 	// for (auto& iter : assets)	// 由于递归，这种写法可能多次保存同一个资源
@@ -44,7 +140,7 @@ void AssetManager::Save()
 	// }
 }
 
-AssetRef AssetManager::LoadAsset(const std::string& filePath, bool init)
+AssetRef AssetManager::DeserializeAsset(const std::string& filePath, uint64_t* fileSize)
 {
 	AssetRef asset;
 
@@ -54,7 +150,7 @@ AssetRef AssetManager::LoadAsset(const std::string& filePath, bool init)
 		return nullptr;
 	}
 	
-	// 读文件，反序列化
+	// 读文件，反序列化；可以在工作线程上调用
 	std::string extention = EngineContext::File()->Extension(filePath);
 	int format =  extention == "asset" 	 ? 2 : 
 				  extention == "binasset" ? 1 : 0;
@@ -66,26 +162,34 @@ AssetRef AssetManager::LoadAsset(const std::string& filePath, bool init)
 	else if(format == 1)
 	{
 		std::ifstream ifs(EngineContext::File()->Absolute(filePath), std::ios::binary);
+		if(!ifs.is_open()) return nullptr;
 		cereal::BinaryInputArchive archive(ifs);
 		archive(asset);
+		if(fileSize) *fileSize = ifs.tellg();
 	}
 	else 
 	{
 		std::ifstream ifs(EngineContext::File()->Absolute(filePath));
+		if(!ifs.is_open()) return nullptr;
 		cereal::JSONInputArchive archive(ifs);
 		archive(asset);
+		if(fileSize) *fileSize = ifs.tellg();
 	}
 
+	return asset;
+}
+
+AssetRef AssetManager::LoadAsset(const std::string& filePath, bool init)
+{
+	AssetRef asset = DeserializeAsset(filePath);
+	if(!asset) return nullptr;
+
 	// 初始化资源,存储键值索引
-	if(init) 								
-	{
-		asset->OnLoadAsset();	//	
-		assets[asset->GetUID()] = asset;
-	}
-	else 
-	{	
-		uninitializedAssets[asset->GetUID()] = asset;
-	}
+	if(init) asset->OnLoadAsset();
+
+	ScopeLock lock(sync);
+	if(init) 	assets[asset->GetUID()] = asset;
+	else 		uninitializedAssets[asset->GetUID()] = asset;
 	UpdateFilePathAndUID(filePath, asset->GetUID());
 	
 	return asset;
@@ -93,8 +197,18 @@ AssetRef AssetManager::LoadAsset(const std::string& filePath, bool init)
 
 AssetRef AssetManager::GetOrLoadAssetInternal(const std::string& filePath)
 {
-	AssetRef asset = GetAsset(filePath);
-	if(asset == nullptr) 	asset = LoadAsset(filePath, true);
+	AssetRef asset;
+	if(EngineContext::ThreadPool()->IsMainThread())
+	{
+		asset = GetAsset(filePath);
+		if(asset == nullptr) 	asset = LoadAsset(filePath, true);
+	}
+	else 						// 其他线程不能执行OnLoadAsset，请求后等待主线程上传
+	{
+		AssetRequestRef request = RequestAsset(filePath, WORK_PRIORITY_BLOCK);
+		WaitAsset(request);
+		asset = request->GetAsset();
+	}
 
 	if (asset == nullptr)	ENGINE_LOG_WARN("Fail to load asset \t [{}]", filePath);
 	else					ENGINE_LOG_INFO("Finish loading asset \t [{}]", filePath);
@@ -104,8 +218,22 @@ AssetRef AssetManager::GetOrLoadAssetInternal(const std::string& filePath)
 
 AssetRef AssetManager::GetOrLoadAssetInternal(const UID& uid)
 {
-	AssetRef asset = GetAsset(uid);
-	//if(asset == nullptr) 	asset = LoadAsset(filePath, true);	// UID找不到路径就没办法了
+	AssetRef asset;
+	if(EngineContext::ThreadPool()->IsMainThread())
+	{
+		asset = GetAsset(uid);
+		if(asset == nullptr)		// 已经被释放的资源，按记录的路径重新读取
+		{
+			std::string filePath = UIDToFilePath(uid);
+			if(!filePath.empty()) 	asset = LoadAsset(filePath, true);
+		}
+	}
+	else 							// 同上，已经被释放的资源由请求按记录的路径重新读取
+	{
+		AssetRequestRef request = RequestAsset(uid, WORK_PRIORITY_BLOCK);
+		WaitAsset(request);
+		asset = request->GetAsset();
+	}
 
 	if (asset == nullptr)	ENGINE_LOG_WARN("Fail to load asset \t [{}]", uid.ToString());
 	else					ENGINE_LOG_INFO("Finish loading asset \t [{}]", uid.ToString());
@@ -126,16 +254,44 @@ AssetRef AssetManager::GetAsset(const std::string& filePath)
 
 AssetRef AssetManager::GetAsset(const UID& uid)
 {
-	if (assets.find(uid) != assets.end()) return assets[uid];
+	bool mainThread = EngineContext::ThreadPool()->IsMainThread();
+	bool deferred = false;
+	AssetRequestRef request;
+	AssetRef asset;
+	{
+		ScopeLock lock(sync);
+		auto assetIter = assets.find(uid);
+		if(assetIter != assets.end()) return assetIter->second;
+
+		auto requestIter = requests.find(uid);
+		if(requestIter != requests.end()) request = requestIter->second;	// 正在异步加载
+		else 
+		{
+			auto iter = uninitializedAssets.find(uid);
+			if(iter != uninitializedAssets.end())
+			{
+				if(mainThread)
+				{
+					asset = iter->second;
+					uninitializedAssets.erase(iter);
+				}
+				else deferred = true;		// 其他线程不能执行OnLoadAsset，交给主线程
+			}
+		}
+	}
+	if(deferred) request = RequestAsset(uid, WORK_PRIORITY_BLOCK);
 
-	auto iter = uninitializedAssets.find(uid);
-	if(iter != uninitializedAssets.end())
+	if(request)
+	{
+		WaitAsset(request);
+		if(request->IsReady()) return request->GetAsset();
+	}
+	else if(asset)
 	{
-		AssetRef asset = iter->second;
 		asset->OnLoadAsset();
-		uninitializedAssets.erase(iter);
-		assets[uid] = asset;
 
+		ScopeLock lock(sync);
+		assets[uid] = asset;
 		return asset;
 	}
 
@@ -143,6 +299,236 @@ AssetRef AssetManager::GetAsset(const UID& uid)
 	return nullptr;
 }
 
+AssetRequestRef AssetManager::RequestAsset(const std::string& filePath, QueuedWorkPriority priority)
+{
+	UID uid = FilePathToUID(filePath);
+	if(!uid.IsEmpty()) return RequestAsset(uid, priority);
+
+	// 还没有扫描过的文件，UID要在反序列化之后才知道
+	AssetRequestRef request = std::make_shared<AssetRequest>();
+	request->path = filePath;
+	request->priority = priority;
+	request->requestTime = std::chrono::steady_clock::now();
+
+	EngineContext::ThreadPool()->AddQueuedWork([this, request]() { LoadRequest(request); }, ENGINE_THREAD_TYPE_ASSET, priority);
+	return request;
+}
+
+AssetRequestRef AssetManager::RequestAsset(const UID& uid, QueuedWorkPriority priority)
+{
+	AssetRequestRef request = std::make_shared<AssetRequest>();
+	request->uid = uid;
+	request->priority = priority;
+	request->requestTime = std::chrono::steady_clock::now();
+	{
+		ScopeLock lock(sync);
+
+		auto assetIter = assets.find(uid);
+		if(assetIter != assets.end())						// 已经加载完成
+		{
+			request->asset = assetIter->second;
+			CompleteRequest(request, ASSET_LOAD_STATE_READY);
+			return request;
+		}
+
+		auto requestIter = requests.find(uid);
+		if(requestIter != requests.end()) return requestIter->second;		// 正在加载，共用同一个请求
+
+		auto pathIter = uidToPath.find(uid);
+		if(pathIter == uidToPath.end())
+		{
+			ENGINE_LOG_WARN("Fail to find asset file path \t [{}]", uid.ToString());
+			CompleteRequest(request, ASSET_LOAD_STATE_FAILED);
+			return request;
+		}
+		request->path = pathIter->second;
+
+		auto uninitIter = uninitializedAssets.find(uid);	// Init时已经反序列化的，跳过读文件
+		if(uninitIter != uninitializedAssets.end())
+		{
+			request->asset = uninitIter->second;
+			uninitializedAssets.erase(uninitIter);
+		}
+		requests[uid] = request;
+	}
+
+	EngineContext::ThreadPool()->AddQueuedWork([this, request]() { LoadRequest(request); }, ENGINE_THREAD_TYPE_ASSET, priority);
+	return request;
+}
+
+void AssetManager::WaitAsset(AssetRequestRef request)
+{
+	if(request->IsDone()) return;
+
+	if(EngineContext::ThreadPool()->IsMainThread())
+	{
+		// 等待的资源或其依赖可能正排在上传队列里，直接上传；队列空时阻塞到有新的资源准备完成
+		while(!request->IsDone())
+		{
+			UpdateStreaming(std::numeric_limits<float>::max());
+			if(!request->IsDone()) uploadEvent->Wait();
+		}
+	}
+	else 
+	{
+		// 例如世界的Tick在ANY线程上同步请求资源，此时主线程正在WaitIdle，会通过ServeBlockingRequests上传
+		request->priority = WORK_PRIORITY_BLOCK;
+		numBlockingWaits++;
+		request->doneEvent->Wait();
+		numBlockingWaits--;
+	}
+}
+
+AssetLoadStatistics AssetManager::GetLoadStatistics(AssetType type)
+{
+	ScopeLock lock(sync);
+	return statistics[type];
+}
+
+void AssetManager::LoadRequest(AssetRequestRef request)
+{
+	TimeScope timer;
+	timer.Begin();
+	if(!request->asset) request->asset = DeserializeAsset(request->path, &request->fileSize);
+	timer.End();
+	request->ioTime = timer.GetMilliSeconds();
+
+	if(!request->asset)
+	{
+		FinishRequest(request, false);
+		return;
+	}
+
+	if(request->uid.IsEmpty())		// 按路径请求的，登记索引后再检查是否重复
+	{
+		ScopeLock lock(sync);
+		request->uid = request->asset->GetUID();
+		UpdateFilePathAndUID(request->path, request->uid);
+
+		auto assetIter = assets.find(request->uid);
+		if(assetIter != assets.end())					// 已经加载过，丢弃刚读出的副本
+		{
+			request->asset = assetIter->second;
+			CompleteRequest(request, ASSET_LOAD_STATE_READY);
+			return;
+		}
+
+		auto requestIter = requests.find(request->uid);
+		if(requestIter != requests.end())				// 同一资源正在加载，等待该请求
+		{
+			request->source = requestIter->second;
+			request->state = ASSET_LOAD_STATE_WAIT_DEPENDENCY;
+			request->pendingDependencies = 1;
+			request->source->dependents.push_back(request);
+			return;
+		}
+		requests[request->uid] = request;
+	}
+
+	std::vector<UID> dependencies;
+	if(AssetBinder* binder = dynamic_cast<AssetBinder*>(request->asset.get())) binder->GetBindedAssets(dependencies);
+	request->asset->GetDependencies(dependencies);
+
+	// 计数额外加1，防止在全部依赖发出请求之前就归零
+	request->state = ASSET_LOAD_STATE_WAIT_DEPENDENCY;
+	request->pendingDependencies = dependencies.size() + 1;
+	for(auto& uid : dependencies)
+	{
+		AssetRequestRef dependency = RequestAsset(uid, request->priority);
+		request->dependencies.push_back(dependency);
+
+		bool done = true;
+		{
+			ScopeLock lock(sync);
+			if(!dependency->IsDone())
+			{
+				dependency->dependents.push_back(request);
+				done = false;
+			}
+		}
+		if(done) OnDependencyFinished(request);
+	}
+	OnDependencyFinished(request);
+}
+
+void AssetManager::OnDependencyFinished(AssetRequestRef request)
+{
+	if(--request->pendingDependencies > 0) return;
+
+	if(request->source)				// 转发同一资源的另一个请求的结果
+	{
+		AssetRequestRef source = request->source;
+		request->asset = source->asset;
+		request->source = nullptr;
+		CompleteRequest(request, source->GetState());
+		return;
+	}
+
+	request->state = ASSET_LOAD_STATE_PREPARING;
+	EngineContext::ThreadPool()->AddQueuedWork([this, request]() { PrepareRequest(request); }, ENGINE_THREAD_TYPE_ASSET, request->priority);
+}
+
+void AssetManager::PrepareRequest(AssetRequestRef request)
+{
+	TimeScope timer;
+	timer.Begin();
+	request->asset->OnPrepareAsset();
+	timer.End();
+	request->prepareTime = timer.GetMilliSeconds();
+
+	ScopeLock lock(sync);
+	request->state = ASSET_LOAD_STATE_UPLOADING;
+	uploadQueue.push_back(request);
+	uploadEvent->Trigger();
+}
+
+void AssetManager::FinishRequest(AssetRequestRef request, bool success, float uploadTime)
+{
+	TimePoint now = std::chrono::steady_clock::now();
+	float latency = MilliSecondsBetween(request->requestTime, now);
+
+	std::vector<AssetRequestRef> dependents;
+	{
+		ScopeLock lock(sync);
+		if(success) assets[request->uid] = request->asset;
+
+		auto requestIter = requests.find(request->uid);
+		if(requestIter != requests.end() && requestIter->second == request) requests.erase(requestIter);
+
+		AssetLoadStatistics& stat = statistics[request->asset ? request->asset->GetAssetType() : ASSET_TYPE_UNKNOWN];
+		if(stat.loadedCount + stat.failedCount == 0 || request->requestTime < stat.firstRequestTime) stat.firstRequestTime = request->requestTime;
+		if(success)
+		{
+			stat.loadedCount++;
+			stat.lastLoadedTime = now;
+			stat.totalLatency += latency;
+			stat.maxLatency = std::max(stat.maxLatency, latency);
+		}
+		else stat.failedCount++;
+		stat.fileSize += request->fileSize;
+		stat.ioTime += request->ioTime;
+		stat.prepareTime += request->prepareTime;
+		stat.uploadTime += uploadTime;
+
+		CompleteRequest(request, success ? ASSET_LOAD_STATE_READY : ASSET_LOAD_STATE_FAILED);
+		request->dependencies.clear();
+		dependents.swap(request->dependents);
+	}
+
+	if(success) ENGINE_LOG_INFO("Asset [{}] [{}] streamed in {} ms (io {} ms, prepare {} ms, upload {} ms).", 
+		request->asset->GetAssetTypeName(), request->path, latency, request->ioTime, request->prepareTime, uploadTime);
+	else 		ENGINE_LOG_WARN("Fail to stream asset \t [{}]", request->path);
+
+	for(auto& dependent : dependents) OnDependencyFinished(dependent);
+}
+
+void AssetManager::CompleteRequest(AssetRequestRef request, AssetLoadState state)
+{
+	request->state = state;
+	request->doneEvent->Trigger();
+	uploadEvent->Trigger();
+}
+
 void AssetManager::SaveAsset(AssetRef asset, const std::string& filePath)
 {
 	// 处理文件路径
@@ -162,6 +548,7 @@ void AssetManager::SaveAsset(AssetRef asset, const std::string& filePath)
 
 	asset->OnSaveAsset();	// 
 
+	ScopeLock lock(sync);
 	UpdateFilePathAndUID(path, asset->GetUID());
 	
 	if(!path.compare(oldPath))	// 删除旧文件
@@ -186,7 +573,7 @@ void AssetManager::SaveAsset(AssetRef asset, const std::string& filePath)
 	assets[asset->GetUID()] = asset;
 }
 
-void AssetManager::UpdateFilePathAndUID(const std::string& filePath, const UID& uid)
+void AssetManager::UpdateFilePathAndUID(const std::string& filePath, const UID& uid)		// 调用者需要持有sync
 {
 	if(filePath.empty())
 	{
@@ -222,6 +609,7 @@ void AssetManager::UpdateFilePathAndUID(const std::string& filePath, const UID&
 
 UID AssetManager::FilePathToUID(const std::string& filePath)
 {
+	ScopeLock lock(sync);
 	auto iter = pathToUID.find(filePath);
 	if(iter == pathToUID.end()) 
 	{
@@ -232,6 +620,7 @@ UID AssetManager::FilePathToUID(const std::string& filePath)
 
 std::string AssetManager::UIDToFilePath(const UID& uid)
 {
+	ScopeLock lock(sync);
 	auto iter = uidToPath.find(uid);
 	if(iter == uidToPath.end()) 
 	{
@@ -268,6 +657,7 @@ void AssetManager::DeleteAsset(const std::string& filePath)
 	UID uid = FilePathToUID(filePath);
 	if(!uid.IsEmpty())
 	{
+		ScopeLock lock(sync);
 		UpdateFilePathAndUID("", uid);
 	}
 }
\ No newline at end of file
@@ -1,12 +1,20 @@
 #pragma once
 
 #include "Core/UID/UID.h"
+#include "Core/Util/TimeScope.h"
+#include "Function/Global/Definations.h"
+#include "Platform/HAL/Mutex.h"
+#include "Platform/HAL/SyncEvent.h"
+#include "Platform/Thread/QueuedWork.h"
 #include "Resource/Asset/Asset.h"
 
+#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 // 什么样的对象应该被抽象成资源？ /////////////////////////////////////////////////////////////
 // 需要被缓存以免重复创建的对象，需要序列化反序列化进行存储的对象
@@ -30,18 +38,95 @@
 // Asset文件存储的索引通过UUID完成，运行时索引使用智能指针，序列化时通过指针去查UUID来存，反序列化时通过UUID向AssetManager请求运行时资源
 // 此外AssetManager也维护全部物理文件路径与资源的索引关系，方便通过路径查找
 // 序列化和反序列化资源时，需要递归的处理全部依赖资源；这种递归处理也会为还没并入AssetManager缓存中的资源创建一个默认文件，并加入管理
-// TODO 资源的请求最终需要支持异步
+// 资源的异步请求 /////////////////////////////////////////////////////////////
+// RequestAsset返回AssetRequest句柄，读文件和反序列化在ENGINE_THREAD_TYPE_ASSET线程池上完成
+// 反序列化后收集依赖的资源（AssetBinder绑定的资源和GetDependencies），依赖按DAG先行加载，全部完成后在工作线程上执行OnPrepareAsset
+// 最后的OnLoadAsset需要创建GPU资源，交回主线程在UpdateStreaming中按优先级和时间预算执行
+// 同步的GetAsset遇到正在异步加载的资源时会等待其完成；资源间的依赖不能成环
+// OnLoadAsset只在主线程执行：其他线程同步获取资源时改为以WORK_PRIORITY_BLOCK发出请求并阻塞，由主线程在WaitIdle（ServeBlockingRequests）或UpdateStreaming中完成上传
+
+enum AssetLoadState
+{
+	ASSET_LOAD_STATE_LOADING = 0,		// 工作线程读文件，反序列化
+	ASSET_LOAD_STATE_WAIT_DEPENDENCY,	// 等待依赖的资源加载完成
+	ASSET_LOAD_STATE_PREPARING,			// 工作线程执行OnPrepareAsset
+	ASSET_LOAD_STATE_UPLOADING,			// 等待主线程执行OnLoadAsset
+	ASSET_LOAD_STATE_READY,				// 以下为完成状态
+	ASSET_LOAD_STATE_FAILED,
+
+	ASSET_LOAD_STATE_MAX_ENUM,	//
+};
+
+class AssetRequest
+{
+public:
+	AssetRequest();
+
+	inline AssetLoadState GetState() const 				{ return state.load(); }
+	inline bool IsDone() const 							{ return GetState() >= ASSET_LOAD_STATE_READY; }
+	inline bool IsReady() const 						{ return GetState() == ASSET_LOAD_STATE_READY; }
+	inline const UID& GetUID() const 					{ return uid; }
+	inline QueuedWorkPriority GetPriority() const 		{ return priority.load(); }
+	inline AssetRef GetAsset() const 					{ return IsReady() ? asset : nullptr; }
+
+	template<typename Type>
+	std::shared_ptr<Type> Get() const 					{ return std::dynamic_pointer_cast<Type>(GetAsset()); }
+
+private:
+	UID uid = UID::Empty();
+	std::string path;
+	std::atomic<QueuedWorkPriority> priority = WORK_PRIORITY_NORMAL;	// 其他线程同步等待时会提高
+	std::atomic<AssetLoadState> state = ASSET_LOAD_STATE_LOADING;
+	SyncEventRef doneEvent;										// 进入完成状态时触发
+	AssetRef asset;
+
+	std::atomic<uint32_t> pendingDependencies = 0;
+	std::vector<std::shared_ptr<AssetRequest>> dependencies;	// 依赖的资源的请求，持有到本资源加载完成，避免依赖被Tick提前释放
+	std::vector<std::shared_ptr<AssetRequest>> dependents;		// 等待本资源的请求，由AssetManager加锁访问
+	std::shared_ptr<AssetRequest> source;						// 按路径请求时，反序列化后发现同一资源已在加载，转而等待该请求
+
+	TimePoint requestTime;										// 统计信息，毫秒
+	float ioTime = 0.0f;
+	float prepareTime = 0.0f;
+	uint64_t fileSize = 0;
+
+	friend class AssetManager;
+};
+typedef std::shared_ptr<AssetRequest> AssetRequestRef;
+
+typedef struct AssetLoadStatistics			// 按资源类型统计的异步加载信息
+{
+	uint32_t loadedCount = 0;
+	uint32_t failedCount = 0;
+	uint64_t fileSize = 0;					// 工作线程实际读取的文件字节数
+
+	float totalLatency = 0.0f;				// 从请求到可用的时间之和，毫秒
+	float maxLatency = 0.0f;
+	float ioTime = 0.0f;					// 各阶段的耗时之和，毫秒
+	float prepareTime = 0.0f;
+	float uploadTime = 0.0f;
+
+	TimePoint firstRequestTime;
+	TimePoint lastLoadedTime;
+
+	float AverageLatency() const;
+	float Throughput() const;				// 每秒加载完成的资源数目
+
+} AssetLoadStatistics;
 
 class AssetManager
 {
 public:
-	AssetManager() = default;
+	AssetManager();
 	~AssetManager() {};
 
 	void Init();
 
 	void Tick();
 
+	void UpdateStreaming(float budgetMilliSeconds = ASSET_UPLOAD_TIME_BUDGET);		// 每帧主线程调用，执行加载完成的资源的OnLoadAsset
+	void ServeBlockingRequests();													// 主线程等待线程池时调用，有线程阻塞在同步加载上时立即上传
+
 	void Save();
 
 	UID FilePathToUID(const std::string& filePath);				// 检索特定文件目录是否对应资源，返回UID
@@ -64,6 +149,12 @@ public:
 	AssetRef GetAsset(const std::string& filePath);	
 	AssetRef GetAsset(const UID& uid);						
 
+	AssetRequestRef RequestAsset(const UID& uid, QueuedWorkPriority priority = WORK_PRIORITY_NORMAL);			// 异步加载，返回的句柄可以轮询或等待
+	AssetRequestRef RequestAsset(const std::string& filePath, QueuedWorkPriority priority = WORK_PRIORITY_NORMAL);
+	void WaitAsset(AssetRequestRef request);																	// 主线程等待时会同时执行上传，其他线程阻塞到主线程上传完成
+
+	AssetLoadStatistics GetLoadStatistics(AssetType type);
+
 	void SaveAsset(AssetRef asset, const std::string& filePath = "");	// 保存资源到指定路径；会覆盖已有资源
 	void DeleteAsset(AssetRef asset);									// 删除指定资源的物理文件
 	void DeleteAsset(const std::string& filePath);
@@ -76,11 +167,25 @@ private:
 	std::unordered_map<std::string, UID> pathToUID;				// 文件路径到UID的索引，本身也是主键，有一一对应关系
 	std::unordered_map<UID, std::string> uidToPath;
 
+	std::unordered_map<UID, AssetRequestRef> requests;			// 正在异步加载的资源
+	std::vector<AssetRequestRef> uploadQueue;					// 等待主线程执行OnLoadAsset的资源
+	std::array<AssetLoadStatistics, ASSET_TYPE_MAX_ENUM> statistics;
+	MutexRef sync;												// 工作线程和主线程都会访问上面的全部容器
+	SyncEventRef uploadEvent;									// 上传队列有新资源或有请求完成时触发，唤醒在WaitAsset中的主线程
+	std::atomic<uint32_t> numBlockingWaits = 0;					// 阻塞在WaitAsset中的非主线程数目
+
 	void UpdateFilePathAndUID(const std::string& filePath, const UID& uid);	
 
 	AssetRef GetOrLoadAssetInternal(const std::string& filePath);
 	AssetRef GetOrLoadAssetInternal(const UID& uid);
 
 	AssetRef LoadAsset(const std::string& path, bool init = false);	
+	AssetRef DeserializeAsset(const std::string& path, uint64_t* fileSize = nullptr);
+
+	void LoadRequest(AssetRequestRef request);					// 异步加载的各个阶段
+	void PrepareRequest(AssetRequestRef request);
+	void FinishRequest(AssetRequestRef request, bool success, float uploadTime = 0.0f);
+	void CompleteRequest(AssetRequestRef request, AssetLoadState state);		// 设置完成状态并唤醒等待者
+	void OnDependencyFinished(AssetRequestRef request);
 };
 
@@ -0,0 +1,274 @@
+#pragma once
+
+#include "Core/Math/Hash.h"
+#include "Core/Math/Math.h"
+#include "Core/Mesh/Mesh.h"
+#include "Core/Mesh/VirtualMesh/MeshCluster.h"
+#include "Core/Mesh/VirtualMesh/Partitioner.h"
+#include "Core/Util/RadixSort.h"
+#include "Core/Util/TimeScope.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// ClusterTriangles中莫顿码排序，连通块间邻近连边（BuildLocalityLinks）和边邻接三个步骤的性能测试，不依赖EngineContext
+// 旧实现（std::sort，重复计算三角形中心，std::unordered_map边哈希）原样保留在这里作为对照
+// 例: BenchmarkClusterTriangles(512);
+
+namespace BenchmarkClusterTrianglesDetail
+{
+    // 经纬度划分的球面，三角形顺序打乱，避免输入本身已经有空间局部性
+    static std::shared_ptr<Mesh> CreateSphere(uint32_t resolution)
+    {
+        std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+        for (uint32_t y = 0; y <= resolution; y++)
+        {
+            for (uint32_t x = 0; x <= resolution; x++)
+            {
+                float theta = PI * y / resolution;
+                float phi = 2.0f * PI * x / resolution;
+                mesh->position.push_back(Vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi)));
+            }
+        }
+
+        std::vector<uint32_t> quads(resolution * resolution);
+        for (uint32_t i = 0; i < quads.size(); i++) quads[i] = i;
+        std::shuffle(quads.begin(), quads.end(), std::mt19937(0));
+
+        for (uint32_t quad : quads)
+        {
+            uint32_t x = quad % resolution;
+            uint32_t y = quad / resolution;
+            uint32_t i0 = y * (resolution + 1) + x;
+            uint32_t i1 = i0 + 1;
+            uint32_t i2 = i0 + resolution + 1;
+            uint32_t i3 = i2 + 1;
+            mesh->index.insert(mesh->index.end(), { i0, i2, i1, i1, i2, i3 });
+        }
+        return mesh;
+    }
+
+    static Vec3 TriangleCenter(const std::shared_ptr<Mesh>& mesh, uint32_t triangle)
+    {
+        auto& indices = mesh->index;
+        return (mesh->position[indices[triangle * 3]] + mesh->position[indices[triangle * 3 + 1]] + mesh->position[indices[triangle * 3 + 2]]) * (1.0f / 3.0f);
+    }
+
+    static void MortonKeys(const std::shared_ptr<Mesh>& mesh, bool legacy, std::vector<uint32_t>& keys)
+    {
+        BoundingBox bounds = { mesh->position[0], mesh->position[0] };
+        for (auto& position : mesh->position) bounds.Merge(position);
+        Vec3 extent = bounds.maxBound - bounds.minBound;
+        float maxLength = std::max(std::max(extent.x(), extent.y()), extent.z());
+
+        keys.resize(mesh->index.size() / 3);
+        for (uint32_t i = 0; i < keys.size(); i++)
+        {
+            Vec3 local = (TriangleCenter(mesh, i) - bounds.minBound) * (1 / maxLength);
+            keys[i] = Morton3D(local);
+            if (legacy)     // 旧实现z只左移了1位，和y重叠
+            {
+                uint32_t z = keys[i] & 0x09249249u;
+                keys[i] = (keys[i] & ~0x09249249u) | (z << 1);
+            }
+        }
+    }
+
+    // 排序后相邻三角形中心的平均距离，越小说明莫顿序的空间局部性越好
+    static float AverageNeighborDistance(const std::shared_ptr<Mesh>& mesh, const std::vector<uint32_t>& order)
+    {
+        double sum = 0;
+        for (uint32_t i = 1; i < order.size(); i++) sum += (TriangleCenter(mesh, order[i]) - TriangleCenter(mesh, order[i - 1])).norm();
+        return sum / std::max((size_t)1, order.size() - 1);
+    }
+
+    // 旧实现：std::sort排序，邻近搜索中每次重新计算三角形中心
+    static void LegacyBuildLocalityLinks(const std::shared_ptr<Mesh>& mesh, PartitionGraph& graph)
+    {
+        uint32_t triangleSize = mesh->index.size() / 3;
+
+        std::vector<uint32_t> sortKeys, newTriangleIndex(triangleSize);
+        MortonKeys(mesh, true, sortKeys);
+        for (uint32_t i = 0; i < triangleSize; i++) newTriangleIndex[i] = i;
+        std::sort(newTriangleIndex.begin(), newTriangleIndex.end(), [&](uint32_t i, uint32_t j) { return sortKeys[i] < sortKeys[j]; });
+
+        std::vector<std::pair<uint32_t, uint32_t>> islandRuns(triangleSize);
+        uint32_t runIslandID = 0;
+        uint32_t runFirstElement = 0;
+        for (uint32_t i = 0; i < triangleSize; i++)
+        {
+            uint32_t islandID = graph.Find(newTriangleIndex[i]);
+            if (runIslandID != islandID)
+            {
+                for (uint32_t j = runFirstElement; j < i; j++) islandRuns[j].second = i - 1;
+                runIslandID = islandID;
+                runFirstElement = i;
+            }
+            islandRuns[i].first = runFirstElement;
+        }
+        for (uint32_t j = runFirstElement; j < triangleSize; j++) islandRuns[j].second = triangleSize - 1;
+
+        for (uint32_t i = 0; i < triangleSize; i++)
+        {
+            uint32_t index = newTriangleIndex[i];
+            Vec3 center = TriangleCenter(mesh, index);
+            uint32_t islandID = graph.parents[index];
+
+            const uint32_t maxLinksPerElement = 5;
+            uint32_t closestIndex[maxLinksPerElement];
+            float closestDist2[maxLinksPerElement];
+            for (uint32_t k = 0; k < maxLinksPerElement; k++) { closestIndex[k] = ~0u; closestDist2[k] = 3.402823466e+38F; }
+
+            for (int direction = 0; direction < 2; direction++)
+            {
+                uint32_t limit = direction ? triangleSize - 1 : 0;
+                uint32_t step = direction ? 1 : -1;
+
+                uint32_t adj = i;
+                for (int iterations = 0; iterations < 16; iterations++)
+                {
+                    if (adj == limit) break;
+                    adj += step;
+
+                    uint32_t adjIndex = newTriangleIndex[adj];
+                    if (islandID == graph.parents[adjIndex])
+                    {
+                        adj = direction ? islandRuns[adj].second : islandRuns[adj].first;
+                    }
+                    else
+                    {
+                        float adjDist2 = (center - TriangleCenter(mesh, adjIndex)).squaredNorm();
+                        for (uint32_t k = 0; k < maxLinksPerElement; k++)
+                        {
+                            if (adjDist2 < closestDist2[k])
+                            {
+                                std::swap(adjIndex, closestIndex[k]);
+                                std::swap(adjDist2, closestDist2[k]);
+                            }
+                        }
+                    }
+                }
+            }
+
+            for (uint32_t k = 0; k < maxLinksPerElement; k++)
+            {
+                if (closestIndex[k] == ~0u) continue;
+                graph.IncreaseEdgeCost(index, closestIndex[k], 1);
+                graph.IncreaseEdgeCost(closestIndex[k], index, 1);
+            }
+        }
+    }
+
+    static uint32_t LegacyHashVertex(const std::shared_ptr<Mesh>& mesh, uint32_t index)
+    {
+        uint32_t hash = Hash(mesh->position[index]);
+        if (mesh->HasNormal())   hash = Hash(hash, Hash(mesh->normal[index]));
+        if (mesh->HasTexCoord()) hash = Hash(hash, Hash(mesh->texCoord[index]));
+        return hash;
+    }
+
+    static uint32_t LegacyCycle3(uint32_t i) { return i - i % 3 + ((1 << (i % 3)) & 3); }
+
+    static uint32_t LegacyBuildEdgeGraph(const std::shared_ptr<Mesh>& mesh)
+    {
+        auto& indices = mesh->index;
+        std::unordered_map<uint32_t, std::vector<uint32_t>> edgeHash;
+        uint32_t adjacentEdges = 0;
+        for (uint32_t i = 0; i < indices.size(); i++)
+        {
+            uint32_t v0 = LegacyHashVertex(mesh, indices[i]);
+            uint32_t v1 = LegacyHashVertex(mesh, indices[LegacyCycle3(i)]);
+            edgeHash[Hash(v0, v1)].push_back(i);
+
+            for (uint32_t j : edgeHash[Hash(v1, v0)])
+            {
+                if (mesh->position[indices[LegacyCycle3(i)]] == mesh->position[indices[j]] &&
+                    mesh->position[indices[i]] == mesh->position[indices[LegacyCycle3(j)]]) adjacentEdges += 2;
+            }
+        }
+        return adjacentEdges;
+    }
+
+    static void PrintResult(const char* name, uint32_t triangleNum, float legacyTime, float time)
+    {
+        printf("[BenchmarkClusterTriangles] %-16s legacy: %8.3f ms (%12.1f tris/s), new: %8.3f ms (%12.1f tris/s), speedup: %5.2fx\n",
+            name, legacyTime, triangleNum / (legacyTime / 1000.0f), time, triangleNum / (time / 1000.0f), legacyTime / time);
+    }
+}
+
+static void BenchmarkClusterTriangles(uint32_t resolution)
+{
+    using namespace BenchmarkClusterTrianglesDetail;
+
+    std::shared_ptr<Mesh> mesh = CreateSphere(resolution);
+    uint32_t triangleNum = mesh->index.size() / 3;
+    printf("[BenchmarkClusterTriangles] triangles: %d\n", triangleNum);
+
+    // 1. 莫顿码排序
+    std::vector<uint32_t> legacyKeys, keys, legacyOrder(triangleNum), order;
+    TimeScope timer;
+
+    timer.Begin();
+    MortonKeys(mesh, true, legacyKeys);
+    for (uint32_t i = 0; i < triangleNum; i++) legacyOrder[i] = i;
+    std::sort(legacyOrder.begin(), legacyOrder.end(), [&](uint32_t i, uint32_t j) { return legacyKeys[i] < legacyKeys[j]; });
+    timer.End();
+    float legacyTime = timer.GetMilliSeconds();
+
+    timer.Begin();
+    MortonKeys(mesh, false, keys);
+    RadixSort32(keys, order);
+    timer.End();
+    PrintResult("morton sort", triangleNum, legacyTime, timer.GetMilliSeconds());
+    printf("[BenchmarkClusterTriangles] average neighbor distance, legacy: %f, new: %f\n",
+        AverageNeighborDistance(mesh, legacyOrder), AverageNeighborDistance(mesh, order));
+
+    // 2. 不同连通块间的邻近连边，每个四边形的两个三角形作为一个连通块，连边后整个网格应当连通
+    auto createIslands = [&](PartitionGraph& graph) {
+        graph.Init(triangleNum);
+        for (uint32_t i = 0; i + 1 < triangleNum; i += 2) graph.Union(i, i + 1);
+    };
+    PartitionGraph legacyGraph, graph;
+    createIslands(legacyGraph);
+    createIslands(graph);
+
+    timer.Begin();
+    LegacyBuildLocalityLinks(mesh, legacyGraph);
+    timer.End();
+    legacyTime = timer.GetMilliSeconds();
+
+    timer.Begin();
+    BuildLocalityLinks(mesh, graph);
+    timer.End();
+    PrintResult("locality links", triangleNum, legacyTime, timer.GetMilliSeconds());
+
+    legacyGraph.Build();
+    graph.Build();
+    printf("[BenchmarkClusterTriangles] locality links, legacy: %d, new: %d\n", (uint32_t)legacyGraph.adjacency.size() / 2, (uint32_t)graph.adjacency.size() / 2);
+    for (uint32_t i = 0; i < triangleNum; i++)
+    {
+        if (graph.Find(i) != graph.Find(0)) { printf("[BenchmarkClusterTriangles] locality links not connected!\n"); break; }
+    }
+
+    // 3. 半边邻接
+    timer.Begin();
+    uint32_t legacyEdges = LegacyBuildEdgeGraph(mesh);
+    timer.End();
+    legacyTime = timer.GetMilliSeconds();
+
+    PartitionGraph edgeGraph;
+    timer.Begin();
+    BuildEdgeGraph(mesh, edgeGraph);
+    timer.End();
+    PrintResult("edge adjacency", triangleNum, legacyTime, timer.GetMilliSeconds());
+
+    uint32_t edges = 0;     // 重复边在CSR中合并了，权重之和才是加边次数
+    for (int weight : edgeGraph.weights) edges += weight;
+    if (legacyEdges != edges) printf("[BenchmarkClusterTriangles] edge adjacency mismatch! legacy: %d, new: %d\n", legacyEdges, edges);
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "Core/Util/TimeScope.h"
+#include "Function/Render/RHI/RHI.h"
+#include "Function/Render/RHI/RHICommandList.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// RHICommandList延迟录制的性能测试，不依赖EngineContext
+// 用只计数的context隔离掉后端的开销，对比立即录制，arena延迟录制，以及旧的每条指令new一个多态对象的延迟录制
+// 旧实现只保留了测试用到的几种指令作为对照
+// 例: BenchmarkCommandList(100000);
+
+namespace BenchmarkCommandListDetail
+{
+    class CountingContext : public RHICommandContext
+    {
+    public:
+        CountingContext() : RHICommandContext(nullptr) {}
+
+        uint64_t count = 0;
+        uint64_t checksum = 0;      // 校验各模式执行的参数一致
+
+        virtual void BeginCommand() override                                                    { count++; }
+        virtual void EndCommand() override                                                      { count++; }
+        virtual void Execute(RHIFenceRef waitFence, RHISemaphoreRef waitSemaphore, RHISemaphoreRef signalSemaphore) override {}
+        virtual void TextureBarrier(const RHITextureBarrier& barrier) override                  { count++; }
+        virtual void BufferBarrier(const RHIBufferBarrier& barrier) override                    { count++; }
+        virtual void TextureBarriers(const std::vector<RHITextureBarrier>& barriers) override   { count++; }
+        virtual void BufferBarriers(const std::vector<RHIBufferBarrier>& barriers) override     { count++; }
+        virtual void CopyTextureToBuffer(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHIBufferRef dst, uint64_t dstOffset) override { count++; }
+        virtual void CopyBufferToTexture(RHIBufferRef src, uint64_t srcOffset, RHITextureRef dst, TextureSubresourceLayers dstSubresource) override { count++; }
+        virtual void CopyBuffer(RHIBufferRef src, uint64_t srcOffset, RHIBufferRef dst, uint64_t dstOffset, uint64_t size) override { count++; }
+        virtual void CopyTexture(RHITextureRef src, TextureSubresourceLayers srcSubresource, RHITextureRef dst, TextureSubresourceLayers dstSubresource) override { count++; }
+        virtual void GenerateMips(RHITextureRef src) override                                   { count++; }
+        virtual void PushEvent(const std::string& name, Color3 color) override                  { count++; checksum += name.size(); }
+        virtual void PopEvent() override                                                        { count++; }
+        virtual void BeginRenderPass(RHIRenderPassRef renderPass) override                      { count++; }
+        virtual void EndRenderPass() override                                                   { count++; }
+        virtual void SetViewport(Offset2D min, Offset2D max) override                           { count++; }
+        virtual void SetScissor(Offset2D min, Offset2D max) override                            { count++; }
+        virtual void ClearScissors(const std::vector<ClearAttachment>& attachments, const std::vector<Rect2D>& scissors, uint32_t baseArrayLayer, uint32_t layerCount) override { count++; }
+        virtual void SetDepthBias(float constantBias, float slopeBias, float clampBias) override { count++; }
+        virtual void SetLineWidth(float width) override                                         { count++; }
+        virtual void SetGraphicsPipeline(RHIGraphicsPipelineRef graphicsPipeline) override      { count++; }
+        virtual void SetComputePipeline(RHIComputePipelineRef computePipeline) override         { count++; }
+        virtual void SetRayTracingPipeline(RHIRayTracingPipelineRef rayTracingPipeline) override { count++; }
+        virtual void PushConstants(void* data, uint16_t size, ShaderFrequency frequency) override { count++; checksum += ((uint32_t*)data)[0] + size; }
+        virtual void BindDescriptorSet(RHIDescriptorSetRef descriptor, uint32_t set) override   { count++; }
+        virtual void BindVertexBuffer(RHIBufferRef vertexBuffer, uint32_t streamIndex, uint32_t offset) override { count++; }
+        virtual void BindIndexBuffer(RHIBufferRef indexBuffer, uint32_t offset) override        { count++; }
+        virtual void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override { count++; }
+        virtual void DispatchIndirect(RHIBufferRef argumentBuffer, uint32_t argumentOffset) override { count++; }
+        virtual void TraceRays(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override { count++; }
+        virtual void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) override { count++; checksum += vertexCount + firstInstance; }
+        virtual void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance) override { count++; checksum += indexCount + firstInstance; }
+        virtual void DrawIndirect(RHIBufferRef argumentBuffer, uint32_t offset, uint32_t drawCount) override { count++; }
+        virtual void DrawIndexedIndirect(RHIBufferRef argumentBuffer, uint32_t offset, uint32_t drawCount) override { count++; }
+        virtual void ImGuiCreateFontsTexture() override                                         { count++; }
+        virtual void ImGuiRenderDrawData(ImGuiDrawFunc func) override                           { count++; }
+    };
+
+    // 旧的延迟录制：每条指令一个堆上的多态对象，执行时虚函数分发后delete
+    struct LegacyCommand
+    {
+        virtual ~LegacyCommand() = default;
+        virtual void Execute(RHICommandContextRef context) = 0;
+    };
+
+    struct LegacyPushEvent : public LegacyCommand
+    {
+        std::string name;
+        Color3 color;
+        LegacyPushEvent(const std::string& name, Color3 color) : name(name), color(color) {}
+        virtual void Execute(RHICommandContextRef context) override final { context->PushEvent(name, color); }
+    };
+
+    struct LegacyPopEvent : public LegacyCommand
+    {
+        virtual void Execute(RHICommandContextRef context) override final { context->PopEvent(); }
+    };
+
+    struct LegacyPushConstants : public LegacyCommand
+    {
+        uint8_t data[256] = { 0 };
+        uint16_t size;
+        ShaderFrequency frequency;
+        LegacyPushConstants(void* data, uint16_t size, ShaderFrequency frequency) : size(size), frequency(frequency) { memcpy(this->data, data, size); }
+        virtual void Execute(RHICommandContextRef context) override final { context->PushConstants(data, size, frequency); }
+    };
+
+    struct LegacyDrawIndexed : public LegacyCommand
+    {
+        uint32_t indexCount, instanceCount, firstIndex, vertexOffset, firstInstance;
+        LegacyDrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance)
+        : indexCount(indexCount), instanceCount(instanceCount), firstIndex(firstIndex), vertexOffset(vertexOffset), firstInstance(firstInstance) {}
+        virtual void Execute(RHICommandContextRef context) override final { context->DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance); }
+    };
+
+    struct PushConstantData
+    {
+        uint32_t data[16];          // 64字节，和mesh pass的常量大小相当
+    };
+
+    static const uint32_t DRAWS_PER_CONSTANTS = 4;
+    static const uint32_t DRAWS_PER_EVENT = 1000;
+
+    // 每4次绘制更新一次push constant，每1000次绘制一组调试标记
+    template<typename List>
+    static void Record(List& list, uint32_t drawCount)
+    {
+        PushConstantData constants = {};
+        for (uint32_t i = 0; i < drawCount; i++)
+        {
+            if (i % DRAWS_PER_EVENT == 0) list.PushEvent("BenchmarkCommandList::Batch", { 1.0f, 0.0f, 0.0f });
+            if (i % DRAWS_PER_CONSTANTS == 0)
+            {
+                constants.data[0] = i;
+                list.PushConstants(&constants, sizeof(PushConstantData), SHADER_FREQUENCY_GRAPHICS);
+            }
+            list.DrawIndexed(36 + i % 64, 1, 0, 0, i);
+            if (i % DRAWS_PER_EVENT == DRAWS_PER_EVENT - 1 || i == drawCount - 1) list.PopEvent();
+        }
+    }
+
+    class LegacyList
+    {
+    public:
+        LegacyList(RHICommandContextRef context) : context(context) {}
+
+        void PushEvent(const std::string& name, Color3 color)                       { commands.push_back(new LegacyPushEvent(name, color)); }
+        void PopEvent()                                                             { commands.push_back(new LegacyPopEvent()); }
+        void PushConstants(void* data, uint16_t size, ShaderFrequency frequency)    { commands.push_back(new LegacyPushConstants(data, size, frequency)); }
+        void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance)
+        {
+            commands.push_back(new LegacyDrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance));
+        }
+
+        void Execute()
+        {
+            for (uint32_t i = 0; i < commands.size(); i++)
+            {
+                commands[i]->Execute(context);
+                delete commands[i];
+            }
+            commands.clear();
+        }
+
+    private:
+        RHICommandContextRef context;
+        std::vector<LegacyCommand*> commands;
+    };
+
+    template<typename Func>
+    static float Measure(uint32_t rounds, Func&& func)
+    {
+        TimeScope timer;
+        timer.Begin();
+        for (uint32_t i = 0; i < rounds; i++) func();
+        timer.End();
+        return timer.GetMilliSeconds() / rounds;
+    }
+}
+
+static void BenchmarkCommandList(uint32_t drawCount)
+{
+    using namespace BenchmarkCommandListDetail;
+
+    const uint32_t rounds = 20;
+
+    auto bypassContext = std::make_shared<CountingContext>();
+    auto deferredContext = std::make_shared<CountingContext>();
+    auto legacyContext = std::make_shared<CountingContext>();
+
+    RHICommandList bypassList({ .pool = nullptr, .context = bypassContext, .byPass = true });
+    RHICommandList deferredList({ .pool = nullptr, .context = deferredContext, .byPass = false });
+    LegacyList legacyList(legacyContext);
+
+    Record(deferredList, drawCount);                // 预热，arena的块在之后的帧里复用
+    uint32_t commandCount = deferredList.CommandCount();
+    deferredList.Execute();
+    deferredContext->count = deferredContext->checksum = 0;
+
+    float bypassTime = Measure(rounds, [&]() { Record(bypassList, drawCount); });
+
+    float deferredRecordTime = 0.0f, deferredExecuteTime = 0.0f;
+    float legacyRecordTime = 0.0f, legacyExecuteTime = 0.0f;
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        deferredRecordTime += Measure(1, [&]() { Record(deferredList, drawCount); });
+        deferredExecuteTime += Measure(1, [&]() { deferredList.Execute(); });
+        legacyRecordTime += Measure(1, [&]() { Record(legacyList, drawCount); });
+        legacyExecuteTime += Measure(1, [&]() { legacyList.Execute(); });
+    }
+    deferredRecordTime /= rounds;
+    deferredExecuteTime /= rounds;
+    legacyRecordTime /= rounds;
+    legacyExecuteTime /= rounds;
+
+    float deferredTime = deferredRecordTime + deferredExecuteTime;
+    float legacyTime = legacyRecordTime + legacyExecuteTime;
+
+    printf("[BenchmarkCommandList] draws: %d, commands: %d, arena: %.1f KB\n", drawCount, commandCount, deferredList.ArenaCapacity() / 1024.0f);
+    printf("[BenchmarkCommandList] bypass:            %8.3f ms\n", bypassTime);
+    printf("[BenchmarkCommandList] deferred arena:    %8.3f ms (record %8.3f, execute %8.3f)\n", deferredTime, deferredRecordTime, deferredExecuteTime);
+    printf("[BenchmarkCommandList] deferred per-new:  %8.3f ms (record %8.3f, execute %8.3f), arena %5.2fx faster\n", legacyTime, legacyRecordTime, legacyExecuteTime, legacyTime / deferredTime);
+
+    if (bypassContext->count != deferredContext->count || bypassContext->checksum != deferredContext->checksum ||
+        bypassContext->count != legacyContext->count || bypassContext->checksum != legacyContext->checksum)
+    {
+        printf("[BenchmarkCommandList] replay mismatch! bypass: %llu, deferred: %llu, per-new: %llu\n",
+            (unsigned long long)bypassContext->count, (unsigned long long)deferredContext->count, (unsigned long long)legacyContext->count);
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Core/Util/IndexAlloctor.h"
+#include "Core/Util/TimeScope.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <random>
+#include <vector>
+
+// IndexAlloctor和旧实现（链表first fit，释放只和后一个区间合并）的对比，不依赖EngineContext
+// 模拟长时间运行的碎片化负载：大量单个索引和不同大小的范围交替分配释放，统计耗时和最终的碎片情况
+// 例: BenchmarkIndexAlloctor();
+
+namespace BenchmarkIndexAlloctorDetail
+{
+    // 旧实现，原样保留作为对照
+    class LegacyIndexAlloctor
+    {
+    public:
+        LegacyIndexAlloctor(uint32_t maxIndex = UINT32_MAX) : maxIndex(maxIndex), nextIndex(1) {}
+
+        IndexRange Allocate(uint32_t size)
+        {
+            for(auto iter = unusedIndex.begin(); iter != unusedIndex.end(); iter++)
+            {
+                if(iter->size > size)
+                {
+                    iter->size -= size;
+                    return { iter->begin + iter->size, size};
+                }
+                if(iter->size == size)
+                {
+                    IndexRange range = *iter;
+                    unusedIndex.erase(iter);
+                    return range;
+                }
+            }
+
+            IndexRange range = {nextIndex, size};
+            nextIndex += size;
+            return range;
+        }
+
+        void Release(IndexRange range)
+        {
+            uint32_t end = range.begin + range.size;
+
+            for(auto iter = unusedIndex.begin(); iter != unusedIndex.end(); iter++)
+            {
+                if(end < iter->begin)
+                {
+                    unusedIndex.insert(iter, range);
+                    return;
+                }
+                if(end == iter->begin)
+                {
+                    iter->begin = range.begin;
+                    return;
+                }
+            }
+
+            unusedIndex.push_back(range);
+        }
+
+        uint32_t FreeRangeCount()   { return unusedIndex.size(); }
+        uint32_t NextIndex()        { return nextIndex; }
+
+    private:
+        uint32_t maxIndex;
+        uint32_t nextIndex;
+        std::list<IndexRange> unusedIndex;
+    };
+
+    template<typename AlloctorType>
+    static float Run(AlloctorType& alloctor, uint32_t liveRanges, uint32_t steps, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::vector<IndexRange> ranges;
+        ranges.reserve(liveRanges);
+
+        TimeScope timer;
+        timer.Begin();
+        for(uint32_t i = 0; i < liveRanges; i++)
+        {
+            ranges.push_back(alloctor.Allocate(random() % 8 == 0 ? random() % 128 + 1 : 1));
+        }
+        for(uint32_t step = 0; step < steps; step++)        // 稳定状态下随机替换，活跃数量不变
+        {
+            uint32_t index = random() % liveRanges;
+            alloctor.Release(ranges[index]);
+            ranges[index] = alloctor.Allocate(random() % 8 == 0 ? random() % 128 + 1 : 1);
+        }
+        timer.End();
+        return timer.GetMilliSeconds();
+    }
+}
+
+static void BenchmarkIndexAlloctor()
+{
+    using namespace BenchmarkIndexAlloctorDetail;
+
+    for(uint32_t liveRanges : { 1000, 10000, 50000 })
+    {
+        uint32_t steps = 100000;
+
+        LegacyIndexAlloctor legacy;
+        IndexAlloctor alloctor;
+        float legacyTime = Run(legacy, liveRanges, steps, liveRanges);
+        float time = Run(alloctor, liveRanges, steps, liveRanges);
+
+        IndexAlloctorStats stats = alloctor.GetStats();
+        printf("[BenchmarkIndexAlloctor] live %6d, legacy: %9.3f ms, %6d free ranges, next index %8d | new: %8.3f ms, %6d free ranges, next index %8d, fragmentation %.3f, speedup: %6.2fx\n",
+            liveRanges, legacyTime, legacy.FreeRangeCount(), legacy.NextIndex(), time, stats.freeRangeCount, stats.nextIndex, stats.Fragmentation(), legacyTime / time);
+    }
+}
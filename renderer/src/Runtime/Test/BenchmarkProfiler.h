@@ -0,0 +1,245 @@
+#pragma once
+
+#include "Core/Util/Profiler.h"
+#include "Core/Util/TimeScope.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <stack>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 无锁Profiler和旧的TimeScopes计时（每个区间一个shared_ptr，按线程ID查map，复制名字）的单区间开销对比，不依赖EngineContext
+// 同时检查多线程写入后按帧收集的事件数量和嵌套深度，并导出一份Chrome trace
+// 例: BenchmarkProfiler(8, "ProfilerTrace.json");
+
+namespace BenchmarkProfilerDetail
+{
+    // 旧实现，原样保留作为对照
+    class LegacyTimeScope
+    {
+    public:
+        std::string name;
+        TimePoint begin;
+        TimePoint end;
+        uint32_t depth = 0;
+    };
+
+    class LegacyTimeScopes
+    {
+    public:
+        void PushScope(std::string name)
+        {
+            std::shared_ptr<LegacyTimeScope> newScope = std::make_shared<LegacyTimeScope>();
+            newScope->name = name;
+            newScope->depth = depth;
+            newScope->begin = std::chrono::steady_clock::now();
+
+            scopes.push_back(newScope);
+            runningScopes.push(newScope);
+            depth++;
+        }
+
+        void PopScope()
+        {
+            auto scope = runningScopes.top();
+            runningScopes.pop();
+            scope->end = std::chrono::steady_clock::now();
+            depth--;
+        }
+
+        std::vector<std::shared_ptr<LegacyTimeScope>> scopes;
+        std::stack<std::shared_ptr<LegacyTimeScope>> runningScopes;
+        uint32_t depth = 0;
+    };
+
+    class LegacyTimeScopeHelper
+    {
+    public:
+        LegacyTimeScopeHelper(std::string name, LegacyTimeScopes* scopes) : scopes(scopes) { scopes->PushScope(name); }
+        ~LegacyTimeScopeHelper() { scopes->PopScope(); }
+
+    private:
+        LegacyTimeScopes* scopes;
+    };
+
+    // 每帧重新生成，和原先EngineContext::UpdateTimers一致
+    static float LegacyScopes(uint32_t numScopes, uint32_t frameScopes)
+    {
+        std::map<uint32_t, std::shared_ptr<LegacyTimeScopes>> timers;
+        uint32_t threadID = 0;
+
+        TimeScope timer;
+        timer.Begin();
+        for(uint32_t i = 0; i < numScopes; i++)
+        {
+            if(i % frameScopes == 0) timers[threadID] = std::make_shared<LegacyTimeScopes>();
+
+            auto& timeScopes = timers;
+            if(!timeScopes[threadID]) timeScopes[threadID] = std::make_shared<LegacyTimeScopes>();
+            LegacyTimeScopeHelper helper("BenchmarkProfiler::Scope", timeScopes[threadID].get());
+        }
+        timer.End();
+        return timer.GetMicroSeconds() * 1000.0f / numScopes;
+    }
+
+    static float ProfilerScopes(uint32_t numScopes, uint32_t tick)
+    {
+        TimeScope timer;
+        timer.Begin();
+        for(uint32_t i = 0; i < numScopes; i++)
+        {
+            ProfilerScope scope("BenchmarkProfiler::Scope", tick);
+        }
+        timer.End();
+        return timer.GetMicroSeconds() * 1000.0f / numScopes;
+    }
+
+    static float InternedScopes(uint32_t numScopes, uint32_t tick)
+    {
+        std::string passName = "GBufferPass";
+
+        TimeScope timer;
+        timer.Begin();
+        for(uint32_t i = 0; i < numScopes; i++)
+        {
+            ProfilerScope scope(Profiler::InternName("BenchmarkProfiler::", passName), tick);
+        }
+        timer.End();
+        return timer.GetMicroSeconds() * 1000.0f / numScopes;
+    }
+
+    // 每个线程写入outer个两层嵌套的区间，收集后检查数量和深度
+    static bool CheckCollect(uint32_t numThreads, uint32_t outer, uint32_t tick, ProfilerFrame& frame)
+    {
+        std::vector<std::thread> threads;
+        for(uint32_t t = 0; t < numThreads; t++)
+        {
+            threads.emplace_back([=]() {
+                for(uint32_t i = 0; i < outer; i++)
+                {
+                    ProfilerScope scope("BenchmarkProfiler::Outer", tick);
+                    {
+                        ProfilerScope inner(Profiler::InternName("BenchmarkProfiler::Inner", std::to_string(i % 4)), tick);
+                    }
+                }
+            });
+        }
+        for(auto& thread : threads) thread.join();
+
+        Profiler::Get()->BeginFrame(tick, 0);
+        frame = Profiler::Get()->GetHistoryFrame();
+
+        uint32_t filledThreads = 0;
+        bool success = frame.tick == tick && frame.begin <= frame.end;
+        for(auto& threadEvents : frame.threads)
+        {
+            if(threadEvents.events.empty()) continue;
+            filledThreads++;
+
+            uint32_t depths[2] = { 0, 0 };
+            for(auto& event : threadEvents.events)
+            {
+                if(event.depth > 1 || event.end < event.begin) { success = false; continue; }
+                depths[event.depth]++;
+            }
+            if(depths[0] != outer || depths[1] != outer) success = false;
+        }
+        return success && filledThreads == numThreads;
+    }
+
+    static uint32_t CountEvents(const ProfilerFrame& frame)
+    {
+        uint32_t count = 0;
+        for(auto& threadEvents : frame.threads) count += threadEvents.events.size();
+        return count;
+    }
+
+    // 等待时帮忙执行其他帧的任务，同一线程的事件会按帧交错，两帧都不能丢
+    static bool CheckInterleavedTicks(uint32_t tick)
+    {
+        std::thread thread([=]() {
+            for(uint32_t i = 0; i < 64; i++) ProfilerScope scope("BenchmarkProfiler::Interleaved", i % 3 == 1 ? tick + 1 : tick);
+        });
+        thread.join();
+
+        Profiler::Get()->BeginFrame(tick, 0);
+        uint32_t first = CountEvents(Profiler::Get()->GetHistoryFrame());
+        Profiler::Get()->BeginFrame(tick + 1, 0);
+        uint32_t second = CountEvents(Profiler::Get()->GetHistoryFrame());
+        return first == 43 && second == 21;
+    }
+
+    // 写入线程持续写入时收集已经写完的帧，每帧的事件都要完整
+    static bool CheckConcurrentCollect(uint32_t tick, uint32_t frames, uint32_t frameScopes)
+    {
+        std::atomic<uint32_t> written = 0;      // 已经写完的帧数
+        std::atomic<uint32_t> collected = 0;
+        std::thread thread([&]() {
+            for(uint32_t frame = 0; frame < frames; frame++)
+            {
+                while(frame > collected.load() + 4) std::this_thread::yield();    // 不能超过环形缓冲的容量
+                for(uint32_t i = 0; i < frameScopes; i++) ProfilerScope scope("BenchmarkProfiler::Concurrent", tick + frame);
+                written.fetch_add(1);
+            }
+        });
+
+        bool success = true;
+        while(collected.load() < frames)
+        {
+            if(collected.load() >= written.load())
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            Profiler::Get()->BeginFrame(tick + collected.load(), 0);
+            if(CountEvents(Profiler::Get()->GetHistoryFrame()) != frameScopes) success = false;
+            collected.fetch_add(1);
+        }
+        thread.join();
+        return success;
+    }
+}
+
+static void BenchmarkProfiler(uint32_t numThreads, const std::string& tracePath = "")
+{
+    using namespace BenchmarkProfilerDetail;
+
+    const uint32_t numScopes = 1000000;
+    const uint32_t frameScopes = 2000;
+    uint32_t tick = 1;
+
+    ProfilerScopes(numScopes / 10, tick);       // 预热，注册线程缓冲
+    float legacy = LegacyScopes(numScopes, frameScopes);
+    float profiler = ProfilerScopes(numScopes, tick);
+    float interned = InternedScopes(numScopes, tick);
+    printf("[BenchmarkProfiler] per scope legacy: %8.1f ns, profiler: %8.1f ns, interned name: %8.1f ns, speedup: %5.2fx\n",
+        legacy, profiler, interned, legacy / profiler);
+
+    Profiler::Get()->BeginFrame(tick, 0);       // 收走上面的事件
+
+    ProfilerFrame frame;
+    bool success = true;
+    for(uint32_t round = 0; round < 4; round++)
+    {
+        tick++;
+        if(!CheckCollect(numThreads, PROFILER_EVENTS_PER_THREAD / 4, tick, frame)) success = false;
+    }
+    printf("[BenchmarkProfiler] collect from %d threads: %s\n", numThreads, success ? "passed" : "FAILED");
+
+    tick++;
+    printf("[BenchmarkProfiler] interleaved ticks: %s\n", CheckInterleavedTicks(tick) ? "passed" : "FAILED");
+    tick += 2;
+    printf("[BenchmarkProfiler] concurrent collect: %s\n", CheckConcurrentCollect(tick, 64, PROFILER_EVENTS_PER_THREAD / 8) ? "passed" : "FAILED");
+
+    if(!tracePath.empty())
+    {
+        bool written = Profiler::WriteChromeTrace(tracePath, { frame });
+        printf("[BenchmarkProfiler] chrome trace %s: %s\n", tracePath.c_str(), written ? "written" : "FAILED");
+    }
+}
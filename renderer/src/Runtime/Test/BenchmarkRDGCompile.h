@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Core/Util/TimeScope.h"
+#include "TestRDGCompile.h"
+
+#include <cstdint>
+#include <cstdio>
+
+// RDG编译阶段的性能测试，不依赖EngineContext
+// 对照组为原先执行时对每条边调用PreviousState和IsLastUsedPass的全量扫描，以及逐条录制的屏障调用次数
+// 例: BenchmarkRDGCompile(200);
+
+namespace BenchmarkRDGCompileDetail
+{
+    template<typename Func>
+    static float Measure(uint32_t rounds, Func&& func)
+    {
+        TimeScope timer;
+        timer.Begin();
+        for (uint32_t i = 0; i < rounds; i++) func();
+        timer.End();
+        return timer.GetMilliSeconds() / rounds;
+    }
+
+    static void ReferenceScan(RDGBuilder& builder)
+    {
+        using namespace TestRDGCompileDetail;
+
+        RDGDependencyGraphRef graph = builder.GetGraph();
+        std::map<RDGNodeRef, RHIResourceState> textures, buffers;
+        for(auto& pass : graph->GetNodes<RDGPassNode>())
+        {
+            if(pass->IsCulled()) continue;
+            graph->ForEachTexture(pass, [&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
+                PreviousState(graph, texture, pass, edge->subresource, edge->IsOutput());
+            });
+            graph->ForEachBuffer(pass, [&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
+                PreviousState(graph, buffer, pass, edge->offset, edge->size, edge->IsOutput());
+            });
+            ReferenceReleases(graph, pass, textures, buffers);
+        }
+    }
+}
+
+static void BenchmarkRDGCompile(uint32_t passCount)
+{
+    using namespace BenchmarkRDGCompileDetail;
+
+    const uint32_t rounds = 20;
+
+    RDGBuilder builder(nullptr);
+    TestRDGCompileDetail::BuildSyntheticGraph(builder, passCount, 0, 10);
+
+    float compileTime = Measure(rounds, [&]() { builder.Compile(); });
+    float referenceTime = Measure(rounds, [&]() { ReferenceScan(builder); });
+
+    uint32_t culledCount = 0;
+    for(auto& pass : builder.GetGraph()->GetNodes<RDGPassNode>()) if(pass->IsCulled()) culledCount++;
+
+    uint32_t barrierCount, batchCount;
+    uint32_t mismatch = TestRDGCompileDetail::CompareWithReference(builder, barrierCount, batchCount);
+
+    printf("[BenchmarkRDGCompile] passes: %d, culled: %d, edges: %d\n", passCount + 1, culledCount, builder.GetGraph()->EdgeCount());
+    printf("[BenchmarkRDGCompile] compile: %8.3f ms, per-edge scan: %8.3f ms (%5.2fx)\n", compileTime, referenceTime, referenceTime / compileTime);
+    printf("[BenchmarkRDGCompile] barriers: %d, barrier calls: %d -> %d\n", barrierCount, barrierCount, batchCount);
+
+    if(mismatch != 0) printf("[BenchmarkRDGCompile] barrier mismatch: %d\n", mismatch);
+}
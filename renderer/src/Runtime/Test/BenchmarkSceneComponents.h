@@ -0,0 +1,162 @@
+#pragma once
+
+#include "Core/Util/TimeScope.h"
+#include "Function/Framework/Component/DirectionalLightComponent.h"
+#include "Function/Framework/Component/PointLightComponent.h"
+#include "Function/Framework/Component/TransformComponent.h"
+#include "Function/Framework/Entity/Entity.h"
+#include "Function/Framework/Scene/Scene.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// 场景组件查找的对比：旧实现遍历全部实体逐个dynamic_pointer_cast并返回新分配的数组，新实现直接返回组件表中连续存放的数组
+// 只创建组件不初始化，不依赖EngineContext
+// 例: BenchmarkSceneComponents();
+
+namespace BenchmarkSceneComponentsDetail
+{
+    // 原Entity::TryGetComponent
+    template<typename TComponent>
+    static std::shared_ptr<TComponent> LegacyTryGetComponent(std::shared_ptr<Entity> entity)
+    {
+        for (auto& component : entity->GetComponents())
+        {
+            std::shared_ptr<TComponent> cast = std::dynamic_pointer_cast<TComponent>(component);
+            if(cast != nullptr) return cast;
+        }
+        return nullptr;
+    }
+
+    // 原Scene::GetComponents
+    template<typename TComponent>
+    static std::vector<std::shared_ptr<TComponent>> LegacyGetComponents(const std::vector<std::shared_ptr<Entity>>& entities)
+    {
+        std::vector<std::shared_ptr<TComponent>> components;
+        for(auto& entity : entities)
+        {
+            std::shared_ptr<TComponent> component = LegacyTryGetComponent<TComponent>(entity);
+            if(component) components.push_back(component);
+        }
+        return components;
+    }
+
+    static std::shared_ptr<Scene> CreateScene(uint32_t numEntities, uint32_t lightInterval)
+    {
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>("BenchmarkSceneComponents");
+        for(uint32_t i = 0; i < numEntities; i++)
+        {
+            std::shared_ptr<Entity> entity = scene->CreateEntity("Entity");
+            if(i % lightInterval == 0) entity->AddComponent<PointLightComponent>();
+        }
+        return scene;
+    }
+
+    // 模拟每帧的遍历，返回每次的平均耗时，微秒
+    static float Legacy(const std::vector<std::shared_ptr<Entity>>& entities, uint32_t rounds, uint32_t& count)
+    {
+        TimeScope timer;
+        timer.Begin();
+        for(uint32_t round = 0; round < rounds; round++)
+        {
+            auto lights = LegacyGetComponents<PointLightComponent>(entities);
+            count = 0;
+            for(auto& light : lights) if(light) count++;
+        }
+        timer.End();
+        return timer.GetMicroSeconds() / rounds;
+    }
+
+    static float Registry(Scene& scene, uint32_t rounds, uint32_t& count)
+    {
+        TimeScope timer;
+        timer.Begin();
+        for(uint32_t round = 0; round < rounds; round++)
+        {
+            const auto& lights = scene.GetPointLights();
+            count = 0;
+            for(auto& light : lights) if(light) count++;
+        }
+        timer.End();
+        return timer.GetMicroSeconds() / rounds;
+    }
+
+    template<typename Func>
+    static float TryGetAll(const std::vector<std::shared_ptr<Entity>>& entities, uint32_t rounds, Func&& func)
+    {
+        TimeScope timer;
+        timer.Begin();
+        uint32_t found = 0;
+        for(uint32_t round = 0; round < rounds; round++)
+        {
+            for(auto& entity : entities) if(func(entity)) found++;
+        }
+        timer.End();
+        if(found != entities.size() * rounds) printf("[BenchmarkSceneComponents] try get: missing components!\n");
+        return timer.GetMicroSeconds() / rounds;
+    }
+
+    // 删除一半带光源的实体，再比较两种方式得到的组件集合
+    static bool CheckAfterRemove(std::shared_ptr<Scene> scene)
+    {
+        std::vector<std::shared_ptr<Entity>> entities = scene->GetEntities();
+        for(uint32_t i = 0; i < entities.size(); i += 2)
+        {
+            if(i % 4 == 0) scene->RemoveEntity(entities[i]->GetID());
+            else if(entities[i]->TryGetComponent<PointLightComponent>()) entities[i]->RemoveComponent<PointLightComponent>();
+        }
+
+        auto legacy = LegacyGetComponents<PointLightComponent>(scene->GetEntities());
+        std::vector<std::shared_ptr<PointLightComponent>> current = scene->GetPointLights();
+        auto compare = [](auto& a, auto& b) { return a.get() < b.get(); };
+        std::sort(legacy.begin(), legacy.end(), compare);
+        std::sort(current.begin(), current.end(), compare);
+        return legacy == current;
+    }
+
+    // 组件池交换删除后顺序会变，GetDirectionalLight等仍要返回实体顺序的第一个
+    static bool CheckFirstComponent()
+    {
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>("BenchmarkSceneComponents");
+        std::vector<std::shared_ptr<Entity>> entities;
+        for(uint32_t i = 0; i < 3; i++)
+        {
+            entities.push_back(scene->CreateEntity("Light"));
+            entities.back()->AddComponent<DirectionalLightComponent>();
+        }
+
+        entities[0]->RemoveComponent<DirectionalLightComponent>();     // 池内变为2，1
+        return scene->GetDirectionalLight() == entities[1]->TryGetComponent<DirectionalLightComponent>();
+    }
+}
+
+static void BenchmarkSceneComponents()
+{
+    using namespace BenchmarkSceneComponentsDetail;
+
+    for(uint32_t numEntities : { 10000, 100000 })
+    {
+        const uint32_t lightInterval = 10;
+        const uint32_t rounds = 20;
+
+        std::shared_ptr<Scene> scene = CreateScene(numEntities, lightInterval);
+        std::vector<std::shared_ptr<Entity>> entities = scene->GetEntities();
+
+        uint32_t legacyCount, count;
+        float legacyTime = Legacy(entities, rounds, legacyCount);
+        float time = Registry(*scene, rounds, count);
+        printf("[BenchmarkSceneComponents] entities %6d, GetComponents legacy: %9.1f us, registry: %9.1f us, speedup: %7.1fx%s\n",
+            numEntities, legacyTime, time, legacyTime / time, legacyCount == count ? "" : ", count MISMATCH");
+
+        float legacyTryGet = TryGetAll(entities, rounds, [](auto& entity) { return LegacyTryGetComponent<TransformComponent>(entity) != nullptr; });
+        float tryGet = TryGetAll(entities, rounds, [](auto& entity) { return entity->template TryGetComponent<TransformComponent>() != nullptr; });
+        printf("[BenchmarkSceneComponents] entities %6d, TryGetComponent legacy: %9.1f us, static type: %9.1f us, speedup: %7.1fx\n",
+            numEntities, legacyTryGet, tryGet, legacyTryGet / tryGet);
+
+        printf("[BenchmarkSceneComponents] entities %6d, remove and sync: %s\n", numEntities, CheckAfterRemove(scene) ? "passed" : "FAILED");
+    }
+    printf("[BenchmarkSceneComponents] first component in entity order: %s\n", CheckFirstComponent() ? "passed" : "FAILED");
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "Core/Math/BoundingBox.h"
+#include "Core/Math/LooseOctree.h"
+#include "Core/Math/Math.h"
+#include "Core/Util/TimeScope.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// CPU端场景剔除的性能测试，不依赖EngineContext
+// 对照组为逐物体调用FrustumIntersectBox的暴力剔除，视锥为一个相机视锥和四级平行光级联
+// 例: BenchmarkSceneCulling(100000);
+
+namespace BenchmarkSceneCullingDetail
+{
+    static const uint32_t CASCADE_COUNT = 4;
+    static const uint32_t FRUSTUM_COUNT = 1 + CASCADE_COUNT;
+    static const uint32_t CAMERA_PASS_COUNT = 3;            // 深度，G-Buffer，前向
+    static const uint32_t DRAW_BYTES = sizeof(uint32_t) * 2 + sizeof(uint32_t) * 4;     // IndirectMeshDrawInfo + RHIIndirectCommand
+
+    // 城市规模的场景，大部分是小物体，少量大物体
+    static std::vector<BoundingBox> CreateBoxes(uint32_t count, float worldSize)
+    {
+        std::mt19937 random(0);
+        std::uniform_real_distribution<float> position(-worldSize, worldSize);
+        std::uniform_real_distribution<float> height(0.0f, worldSize * 0.05f);
+        std::uniform_real_distribution<float> size(0.2f, 4.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        std::vector<BoundingBox> boxes(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            Vec3 center = Vec3(position(random), height(random), position(random));
+            Vec3 extent = Vec3(size(random), size(random), size(random));
+            if (unit(random) < 0.01f) extent *= 20.0f;
+            boxes[i] = BoundingBox(center - extent, center + extent);
+        }
+        return boxes;
+    }
+
+    static void CreateFrustums(Vec3 eye, Vec3 front, std::vector<Frustum>& frustums, std::vector<FrustumPlanes>& planes)
+    {
+        float near = 0.1f, far = 1000.0f;
+        Mat4 view = Math::LookAt(eye, eye + front, Vec3(0.0f, 1.0f, 0.0f));
+        Mat4 proj = Math::Perspective(Math::ToRadians(60.0f), 16.0f / 9.0f, near, far);
+        proj(1, 1) *= -1;
+
+        frustums.clear();
+        planes.clear();
+        frustums.push_back(CreateFrustumFromMatrix(proj * view, -1.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f));
+        planes.emplace_back(frustums.back());
+
+        // 沿视线方向逐级放大的正交级联，和DirectionalLightComponent一样去掉近平面
+        Vec3 lightDir = Vec3(-0.3f, -1.0f, -0.2f).normalized();
+        float split = 20.0f;
+        for (uint32_t i = 0; i < CASCADE_COUNT; i++)
+        {
+            Vec3 center = eye + front * split * 0.5f;
+            float radius = split * 0.6f;
+            Mat4 lightView = Math::LookAt(center - lightDir * radius * 2.0f, center, Vec3(0.0f, 0.0f, 1.0f));
+            Mat4 lightProj = Math::Ortho(-radius, radius, -radius, radius, 0.0f, radius * 4.0f);
+            frustums.push_back(CreateFrustumFromMatrix(lightProj * lightView, -1.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f));
+            planes.emplace_back(frustums.back(), true);
+            split *= 4.0f;
+        }
+    }
+
+    // 旧的逐物体剔除，级联也只测试和引擎一致的去掉近平面的视锥
+    static void BruteForceCull(const std::vector<BoundingBox>& boxes, const std::vector<Frustum>& frustums, std::vector<uint32_t>& masks)
+    {
+        masks.assign(boxes.size(), 0);
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            uint32_t mask = 0;
+            for (uint32_t f = 0; f < frustums.size(); f++)
+            {
+                Frustum frustum = frustums[f];
+                if (f > 0) frustum.planeNear = Vec4(0.0f, 0.0f, 0.0f, -1.0f);
+                if (FrustumIntersectBox(frustum, boxes[i])) mask |= 1u << f;
+            }
+            masks[i] = mask;
+        }
+    }
+
+    static void FlatCull(const std::vector<BoundingBox>& boxes, const std::vector<FrustumPlanes>& planes, std::vector<uint32_t>& masks)
+    {
+        masks.assign(boxes.size(), 0);
+        for (uint32_t i = 0; i < boxes.size(); i++)
+        {
+            Vec3 center = (boxes[i].maxBound + boxes[i].minBound) * 0.5f;
+            Vec3 extent = (boxes[i].maxBound - boxes[i].minBound) * 0.5f;
+            uint32_t mask = 0;
+            for (uint32_t f = 0; f < planes.size(); f++)
+            {
+                if (planes[f].Test(center, extent) != FRUSTUM_OUTSIDE) mask |= 1u << f;
+            }
+            masks[i] = mask;
+        }
+    }
+
+    static uint32_t CountMismatch(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+    {
+        uint32_t mismatch = 0;
+        for (uint32_t i = 0; i < a.size(); i++) if (a[i] != b[i]) mismatch++;
+        return mismatch;
+    }
+
+    template<typename Func>
+    static float Measure(uint32_t rounds, Func&& func)
+    {
+        TimeScope timer;
+        timer.Begin();
+        for (uint32_t i = 0; i < rounds; i++) func();
+        timer.End();
+        return timer.GetMilliSeconds() / rounds;
+    }
+}
+
+static void BenchmarkSceneCulling(uint32_t count)
+{
+    using namespace BenchmarkSceneCullingDetail;
+
+    const float worldSize = 2000.0f;
+    const uint32_t rounds = 20;
+    std::vector<BoundingBox> boxes = CreateBoxes(count, worldSize);
+
+    std::vector<Frustum> frustums;
+    std::vector<FrustumPlanes> planes;
+    CreateFrustums(Vec3(0.0f, 20.0f, 0.0f), Vec3(1.0f, -0.1f, 0.3f).normalized(), frustums, planes);
+
+    LooseOctree octree(Vec3::Zero(), worldSize, 5);       // 叶节点格子半边长约60，和引擎里的设置接近
+    float buildTime = Measure(1, [&]() {
+        for (uint32_t i = 0; i < count; i++) octree.Update(i, boxes[i]);
+    });
+
+    std::vector<uint32_t> bruteMasks, flatMasks, octreeMasks;
+    float bruteTime = Measure(rounds, [&]() { BruteForceCull(boxes, frustums, bruteMasks); });
+    float flatTime = Measure(rounds, [&]() { FlatCull(boxes, planes, flatMasks); });
+    float octreeTime = Measure(rounds, [&]() { octree.Cull(planes.data(), planes.size(), octreeMasks); });
+
+    // 每帧有1%的物体移动
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> offset(-2.0f, 2.0f);
+    uint32_t moveCount = std::max(count / 100, 1u);
+    float updateTime = Measure(rounds, [&]() {
+        for (uint32_t i = 0; i < moveCount; i++)
+        {
+            uint32_t index = random() % count;
+            Vec3 delta = Vec3(offset(random), 0.0f, offset(random));
+            boxes[index] = BoundingBox(boxes[index].minBound + delta, boxes[index].maxBound + delta);
+            octree.Update(index, boxes[index]);
+        }
+    });
+    BruteForceCull(boxes, frustums, bruteMasks);
+    FlatCull(boxes, planes, flatMasks);
+    octree.Cull(planes.data(), planes.size(), octreeMasks);
+
+    uint32_t cameraVisible = 0, shadowVisible = 0;
+    for (uint32_t mask : octreeMasks)
+    {
+        if (mask & 1) cameraVisible++;
+        if (mask & ~1u) shadowVisible++;
+    }
+    uint64_t savedBytes = (uint64_t)(count - cameraVisible) * DRAW_BYTES * CAMERA_PASS_COUNT + (uint64_t)(count - shadowVisible) * DRAW_BYTES * CASCADE_COUNT;
+
+    printf("[BenchmarkSceneCulling] objects: %d, frustums: %d, octree nodes: %d\n", count, FRUSTUM_COUNT, octree.NodeCount());
+    printf("[BenchmarkSceneCulling] build: %8.3f ms, update %d moved: %8.3f ms\n", buildTime, moveCount, updateTime);
+    printf("[BenchmarkSceneCulling] cull brute force: %8.3f ms, flat simd: %8.3f ms (%5.2fx), octree: %8.3f ms (%5.2fx)\n",
+        bruteTime, flatTime, bruteTime / flatTime, octreeTime, bruteTime / octreeTime);
+    printf("[BenchmarkSceneCulling] visible camera: %d, shadow: %d, upload saved per frame: %.1f KB\n",
+        cameraVisible, shadowVisible, savedBytes / 1024.0f);
+
+    if (CountMismatch(bruteMasks, flatMasks) != 0 || CountMismatch(bruteMasks, octreeMasks) != 0)
+    {
+        printf("[BenchmarkSceneCulling] visibility mismatch! flat: %d, octree: %d\n", CountMismatch(bruteMasks, flatMasks), CountMismatch(bruteMasks, octreeMasks));
+    }
+}
@@ -0,0 +1,336 @@
+#pragma once
+
+#include "Core/Util/TimeScope.h"
+#include "Platform/HAL/PlatformProcess.h"
+#include "Platform/HAL/ScopeLock.h"
+#include "Platform/Thread/QueuedThreadPool.h"
+#include "Platform/Thread/QueuedWork.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <queue>
+#include <vector>
+
+// 工作窃取线程池和旧线程池（单锁优先队列，WaitIdle加锁轮询）的吞吐量和延迟对比，不依赖EngineContext
+// 旧实现原样保留在这里作为对照
+// 例: BenchmarkThreadPool(8);
+
+namespace BenchmarkThreadPoolDetail
+{
+    class LegacyThreadPool
+    {
+    public:
+        static std::shared_ptr<LegacyThreadPool> Create(uint32_t numThreads)
+        {
+            std::shared_ptr<LegacyThreadPool> pool = std::make_shared<LegacyThreadPool>();
+            pool->sync = PlatformProcess::CreateMutex();
+            for (uint32_t i = 0; i < numThreads; i++)
+            {
+                std::shared_ptr<Worker> worker = std::make_shared<Worker>();
+                worker->pool = pool.get();
+                worker->doWorkEvent = PlatformProcess::CreateSyncEvent(false);
+                worker->thread = RunnableThread::Create(worker);
+                pool->idleThreads.push(worker.get());
+                pool->allThreads.push_back(worker);
+            }
+            return pool;
+        }
+
+        ~LegacyThreadPool()
+        {
+            WaitIdle();
+            for (auto& worker : allThreads)
+            {
+                worker->timeToDie = true;
+                worker->doWorkEvent->Trigger();
+                worker->thread->WaitForCompletion();
+            }
+        }
+
+        void AddQueuedWork(QueuedWorkRef work)
+        {
+            Worker* worker = nullptr;
+            {
+                ScopeLock lock(sync);
+                if (idleThreads.size() == 0)
+                {
+                    works.push(work);
+                    return;
+                }
+                worker = idleThreads.front();
+                idleThreads.pop();
+            }
+            worker->work = work;
+            worker->doWorkEvent->Trigger();
+        }
+
+        void WaitIdle()
+        {
+            while (true)
+            {
+                ScopeLock lock(sync);
+                if (allThreads.size() == idleThreads.size()) break;
+                PlatformProcess::Sleep(0.0001f);
+            }
+        }
+
+        void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& func)
+        {
+            struct State
+            {
+                std::function<void(uint32_t)> func;
+                uint32_t count;
+                std::atomic<uint32_t> next = 0;
+                std::atomic<uint32_t> finished = 0;
+            };
+            std::shared_ptr<State> state = std::make_shared<State>();
+            state->func = func;
+            state->count = count;
+
+            auto work = [state]() {
+                uint32_t index;
+                while ((index = state->next.fetch_add(1)) < state->count)
+                {
+                    state->func(index);
+                    state->finished.fetch_add(1);
+                }
+            };
+            uint32_t numWorks = std::min(count - 1, (uint32_t)allThreads.size());
+            for (uint32_t i = 0; i < numWorks; i++) AddQueuedWork(std::make_shared<QueuedWork>(work));
+            work();
+            while (state->finished.load() < count) PlatformProcess::Sleep(0.0f);
+        }
+
+    private:
+        struct Worker : public Runnable
+        {
+            LegacyThreadPool* pool;
+            QueuedWorkRef work;
+            SyncEventRef doWorkEvent;
+            RunnableThreadRef thread;
+            std::atomic<bool> timeToDie = false;
+
+            virtual uint32_t Run() override
+            {
+                while (!timeToDie)
+                {
+                    doWorkEvent->Wait();
+                    if (timeToDie) break;
+
+                    QueuedWorkRef local = work;
+                    work = nullptr;
+                    while (local)
+                    {
+                        local->DoThreadedWork();
+                        local = pool->ReturnToPoolOrGetNextWork(this);
+                    }
+                }
+                return 0;
+            }
+        };
+
+        QueuedWorkRef ReturnToPoolOrGetNextWork(Worker* worker)
+        {
+            ScopeLock lock(sync);
+            QueuedWorkRef work = nullptr;
+            if (works.size() > 0)
+            {
+                work = works.top();
+                works.pop();
+            }
+            if (!work) idleThreads.push(worker);
+            return work;
+        }
+
+        std::priority_queue<QueuedWorkRef, std::vector<QueuedWorkRef>, QueuedWork::Compare> works;
+        std::queue<Worker*> idleThreads;
+        std::vector<std::shared_ptr<Worker>> allThreads;
+        MutexRef sync;
+    };
+
+    static void Spin(uint32_t iterations)       // 模拟很小的任务
+    {
+        volatile uint32_t value = 0;
+        for (uint32_t i = 0; i < iterations; i++) value = value + i;
+    }
+
+    // 主线程提交大量小任务
+    template<typename PoolType>
+    static float SubmitMany(PoolType& pool, uint32_t numWorks, uint32_t workSize)
+    {
+        std::atomic<uint32_t> done = 0;
+        TimeScope timer;
+        timer.Begin();
+        for (uint32_t i = 0; i < numWorks; i++)
+        {
+            pool.AddQueuedWork(std::make_shared<QueuedWork>([&]() { Spin(workSize); done.fetch_add(1); }));
+        }
+        pool.WaitIdle();
+        timer.End();
+        if (done.load() != numWorks) printf("[BenchmarkThreadPool] submit: lost works! %d / %d\n", done.load(), numWorks);
+        return timer.GetMilliSeconds();
+    }
+
+    // 池内任务再派生子任务
+    template<typename PoolType>
+    static float FanOut(PoolType& pool, uint32_t numParents, uint32_t numChildren, uint32_t workSize)
+    {
+        std::atomic<uint32_t> done = 0;
+        TimeScope timer;
+        timer.Begin();
+        for (uint32_t i = 0; i < numParents; i++)
+        {
+            pool.AddQueuedWork(std::make_shared<QueuedWork>([&]() {
+                for (uint32_t j = 0; j < numChildren; j++)
+                {
+                    pool.AddQueuedWork(std::make_shared<QueuedWork>([&]() { Spin(workSize); done.fetch_add(1); }));
+                }
+            }));
+        }
+        while (done.load() < numParents * numChildren) PlatformProcess::Sleep(0.0f);     // 子任务可能在WaitIdle检查之后才提交
+        pool.WaitIdle();
+        timer.End();
+        return timer.GetMilliSeconds();
+    }
+
+    // 嵌套ParallelFor
+    template<typename PoolType>
+    static float NestedParallelFor(PoolType& pool, uint32_t outer, uint32_t inner, uint32_t workSize)
+    {
+        std::atomic<uint32_t> done = 0;
+        TimeScope timer;
+        timer.Begin();
+        pool.ParallelFor(outer, [&](uint32_t) {
+            pool.ParallelFor(inner, [&](uint32_t) { Spin(workSize); done.fetch_add(1); });
+        });
+        timer.End();
+        if (done.load() != outer * inner) printf("[BenchmarkThreadPool] parallel for: lost works! %d / %d\n", done.load(), outer * inner);
+        return timer.GetMilliSeconds();
+    }
+
+    // 空闲的池从提交到开始执行的延迟，以及提交到WaitIdle返回的往返时间，微秒
+    template<typename PoolType>
+    static void Latency(PoolType& pool, uint32_t samples, float& startLatency, float& roundTrip, float& p99RoundTrip)
+    {
+        std::vector<float> starts(samples), trips(samples);
+        for (uint32_t i = 0; i < samples; i++)
+        {
+            PlatformProcess::Sleep(0.0002f);    // 让线程进入睡眠
+            TimePoint begin = std::chrono::steady_clock::now();
+            TimePoint started;
+            pool.AddQueuedWork(std::make_shared<QueuedWork>([&]() { started = std::chrono::steady_clock::now(); }));
+            pool.WaitIdle();
+            TimePoint end = std::chrono::steady_clock::now();
+
+            starts[i] = std::chrono::duration<float, std::micro>(started - begin).count();
+            trips[i] = std::chrono::duration<float, std::micro>(end - begin).count();
+        }
+        startLatency = 0;
+        roundTrip = 0;
+        for (uint32_t i = 0; i < samples; i++) { startLatency += starts[i]; roundTrip += trips[i]; }
+        startLatency /= samples;
+        roundTrip /= samples;
+        std::sort(trips.begin(), trips.end());
+        p99RoundTrip = trips[std::min(samples - 1, samples * 99 / 100)];
+    }
+
+    // 菱形依赖，检查后继一定在依赖全部完成后执行
+    static bool CheckDependencies(QueuedThreadPool& pool, uint32_t rounds)
+    {
+        bool success = true;
+        for (uint32_t round = 0; round < rounds; round++)
+        {
+            std::atomic<uint32_t> stage = 0;
+            std::atomic<bool> error = false;
+            QueuedWorkRef root = std::make_shared<QueuedWork>([&]() { Spin(100); stage.fetch_add(1); });
+            std::vector<QueuedWorkRef> middles;
+            for (uint32_t i = 0; i < 8; i++)
+            {
+                middles.push_back(std::make_shared<QueuedWork>([&]() {
+                    if (stage.load() < 1) error = true;
+                    Spin(100);
+                    stage.fetch_add(1);
+                }));
+                middles.back()->AddDependency(root);
+            }
+            QueuedWorkRef last = std::make_shared<QueuedWork>([&]() { if (stage.load() != 9) error = true; });
+            for (auto& middle : middles) last->AddDependency(middle);
+
+            pool.AddQueuedWork(last);       // 逆序提交
+            for (auto& middle : middles) pool.AddQueuedWork(middle);
+            pool.AddQueuedWork(root);
+            pool.Wait(last);
+            pool.WaitIdle();
+
+            if (error.load() || !last->IsFinished()) success = false;
+        }
+        return success;
+    }
+
+    static bool CheckSerialOrder(uint32_t numWorks)      // 只有一个线程的池，池内提交的任务也要按提交顺序执行
+    {
+        QueuedThreadPoolRef serial = QueuedThreadPool::Create(1);
+        std::vector<uint32_t> order;
+        serial->AddQueuedWork(std::make_shared<QueuedWork>([&]() {
+            for (uint32_t i = 0; i < numWorks; i++) serial->AddQueuedWork(std::make_shared<QueuedWork>([&order, i]() { order.push_back(i); }));
+        }));
+        serial->WaitIdle();
+        serial->Destroy();
+
+        bool success = order.size() == numWorks;
+        for (uint32_t i = 0; success && i < numWorks; i++) success = order[i] == i;
+        return success;
+    }
+
+    static bool CheckAbandon()                          // 销毁后提交的任务被放弃，等待不能卡住
+    {
+        QueuedThreadPoolRef dead = QueuedThreadPool::Create(2);
+        dead->Destroy();
+
+        bool executed = false;
+        QueuedWorkRef work = std::make_shared<QueuedWork>([&]() { executed = true; });
+        dead->AddQueuedWork(work);
+        dead->Wait(work);
+        dead->WaitIdle();
+        return work->IsFinished() && !executed;
+    }
+
+    static void PrintResult(const char* name, uint32_t numWorks, float legacyTime, float time)
+    {
+        printf("[BenchmarkThreadPool] %-20s legacy: %8.3f ms (%12.1f works/s), new: %8.3f ms (%12.1f works/s), speedup: %5.2fx\n",
+            name, legacyTime, numWorks / (legacyTime / 1000.0f), time, numWorks / (time / 1000.0f), legacyTime / time);
+    }
+}
+
+static void BenchmarkThreadPool(uint32_t numThreads)
+{
+    using namespace BenchmarkThreadPoolDetail;
+
+    std::shared_ptr<LegacyThreadPool> legacyPool = LegacyThreadPool::Create(numThreads);
+    QueuedThreadPoolRef pool = QueuedThreadPool::Create(numThreads);
+    printf("[BenchmarkThreadPool] threads: %d\n", numThreads);
+
+    const uint32_t workSize = 200;
+    uint32_t numWorks = 100000;
+    PrintResult("submit from main", numWorks, SubmitMany(*legacyPool, numWorks, workSize), SubmitMany(*pool, numWorks, workSize));
+
+    uint32_t numParents = 64, numChildren = 1024;
+    PrintResult("fan out in worker", numParents * numChildren, FanOut(*legacyPool, numParents, numChildren, workSize), FanOut(*pool, numParents, numChildren, workSize));
+
+    uint32_t outer = 64, inner = 256;
+    PrintResult("nested parallel for", outer * inner, NestedParallelFor(*legacyPool, outer, inner, workSize), NestedParallelFor(*pool, outer, inner, workSize));
+
+    float legacyStart, legacyTrip, legacyP99, start, trip, p99;
+    Latency(*legacyPool, 1000, legacyStart, legacyTrip, legacyP99);
+    Latency(*pool, 1000, start, trip, p99);
+    printf("[BenchmarkThreadPool] latency (us)         legacy: start %8.2f, round trip %8.2f, p99 %8.2f; new: start %8.2f, round trip %8.2f, p99 %8.2f\n",
+        legacyStart, legacyTrip, legacyP99, start, trip, p99);
+
+    if (!CheckDependencies(*pool, 1000)) printf("[BenchmarkThreadPool] dependency order mismatch!\n");
+    if (!CheckSerialOrder(1000)) printf("[BenchmarkThreadPool] single thread pool order mismatch!\n");
+    if (!CheckAbandon()) printf("[BenchmarkThreadPool] work added after destroy is not finished!\n");
+}
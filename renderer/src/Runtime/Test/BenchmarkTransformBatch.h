@@ -0,0 +1,141 @@
+#pragma once
+
+#include "Core/Math/Math.h"
+#include "Core/Math/Transform.h"
+#include "Core/Math/TransformBatch.h"
+#include "Core/Util/TimeScope.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// TransformBatch和原MeshRendererComponent逐子物体计算方式（GetMatrix相乘后通用4x4求逆）的对比，单线程，不依赖EngineContext
+// 物体的世界矩阵及其逆由TransformHierarchy在变换修改时计算并缓存，这里预先算好，不计入batch的耗时
+// 收集和计算都按引擎里的方式预先分配范围后分块进行，这里串行执行各块，只给出单线程的耗时，不代表并行后的收益
+// 同时检查两者结果一致，以及分块计算和整体计算的结果一致
+// 例: BenchmarkTransformBatch(1000); BenchmarkTransformBatch(100000);
+
+namespace BenchmarkTransformBatchDetail
+{
+    struct Input
+    {
+        std::vector<Transform> transforms;
+        std::vector<Mat4> models;           // TransformComponent缓存的世界矩阵
+        std::vector<Mat4> invModels;
+        std::vector<Mat4> locals;
+        std::vector<Mat4> localInvs;
+    };
+
+    static Input CreateInput(uint32_t count)
+    {
+        std::mt19937 random(0);
+        std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+        std::uniform_real_distribution<float> scale(0.1f, 4.0f);
+
+        Input input;
+        for(uint32_t i = 0; i < count; i++)
+        {
+            input.transforms.emplace_back(
+                Vec3(position(random), position(random), position(random)),
+                Vec3(scale(random), scale(random), scale(random)),
+                Vec3(angle(random), angle(random), angle(random)));
+            input.models.push_back(input.transforms.back().GetMatrix());
+            input.invModels.push_back(input.transforms.back().GetInverseMatrix());
+
+            // 子网格的变换，带非均匀缩放
+            Transform local = Transform(
+                Vec3(position(random), position(random), position(random)) * 0.01f,
+                Vec3(scale(random), scale(random), scale(random)),
+                Vec3(angle(random), angle(random), angle(random)));
+            input.locals.push_back(local.GetMatrix());
+            input.localInvs.push_back(Math::AffineInverse(input.locals.back()));
+        }
+        return input;
+    }
+
+    static float Legacy(const Input& input, std::vector<Mat4>& worlds, std::vector<Mat4>& invWorlds)
+    {
+        TimeScope timer;
+        timer.Begin();
+        for(uint32_t i = 0; i < input.transforms.size(); i++)
+        {
+            worlds[i] = input.transforms[i].GetMatrix() * input.locals[i];
+            invWorlds[i] = worlds[i].inverse();
+        }
+        timer.End();
+        return timer.GetMilliSeconds();
+    }
+
+    // 返回收集和计算各自的耗时，引擎里两者都分块并行执行
+    static void Batch(const Input& input, TransformBatch& batch, std::vector<Mat4>& worlds, std::vector<Mat4>& invWorlds, uint32_t chunkSize, float& collectTime, float& computeTime)
+    {
+        TimeScope timer;
+        timer.Begin();
+        batch.Clear();
+        batch.Resize(input.transforms.size());
+        for(uint32_t begin = 0; begin < batch.Size(); begin += chunkSize)
+        {
+            uint32_t end = std::min(begin + chunkSize, batch.Size());
+            for(uint32_t i = begin; i < end; i++) batch.Set(i, input.models[i], input.invModels[i], input.locals[i], input.localInvs[i], &worlds[i], &invWorlds[i]);
+        }
+        timer.End();
+        collectTime = timer.GetMilliSeconds();
+
+        timer.Clear();
+        timer.Begin();
+        for(uint32_t begin = 0; begin < batch.Size(); begin += chunkSize) batch.Compute(begin, begin + chunkSize);
+        timer.End();
+        computeTime = timer.GetMilliSeconds();
+    }
+
+    // 相对误差，矩阵元素的量级和平移量一致
+    static float MaxError(const std::vector<Mat4>& a, const std::vector<Mat4>& b)
+    {
+        float error = 0.0f;
+        for(uint32_t i = 0; i < a.size(); i++)
+        {
+            float norm = std::max(1.0f, a[i].cwiseAbs().maxCoeff());
+            error = std::max(error, (a[i] - b[i]).cwiseAbs().maxCoeff() / norm);
+        }
+        return error;
+    }
+}
+
+static void BenchmarkTransformBatch(uint32_t count)
+{
+    using namespace BenchmarkTransformBatchDetail;
+
+    Input input = CreateInput(count);
+    std::vector<Mat4> legacyWorlds(count), legacyInvWorlds(count);
+    std::vector<Mat4> worlds(count), invWorlds(count);
+    TransformBatch batch;
+    batch.Reserve(count);
+
+    float legacyTime = 0.0f, collectTime = 0.0f, computeTime = 0.0f;
+    for(uint32_t round = 0; round < 5; round++)     // 取多次中的最小值
+    {
+        float collect, compute;
+        float legacy = Legacy(input, legacyWorlds, legacyInvWorlds);
+        Batch(input, batch, worlds, invWorlds, 256, collect, compute);
+        legacyTime = round == 0 ? legacy : std::min(legacyTime, legacy);
+        collectTime = round == 0 ? collect : std::min(collectTime, collect);
+        computeTime = round == 0 ? compute : std::min(computeTime, compute);
+    }
+
+    float worldError = MaxError(legacyWorlds, worlds);
+    float invError = MaxError(legacyInvWorlds, invWorlds);
+    bool passed = worldError < 1e-4f && invError < 1e-3f;
+
+    // 不分块计算的结果和分块一致
+    float collect, compute;
+    std::vector<Mat4> wholeWorlds(count), wholeInvWorlds(count);
+    Batch(input, batch, wholeWorlds, wholeInvWorlds, count, collect, compute);
+    passed &= MaxError(worlds, wholeWorlds) == 0.0f && MaxError(invWorlds, wholeInvWorlds) == 0.0f;
+
+    printf("[BenchmarkTransformBatch] objects %d, single thread legacy: %8.3f ms, batch collect: %8.3f ms, compute: %8.3f ms, max error world %.2e inverse %.2e, %s\n",
+        count, legacyTime, collectTime, computeTime, worldError, invError, passed ? "passed" : "FAILED");
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Core/Math/Math.h"
+#include "Core/Util/TimeScope.h"
+#include "Function/Framework/Component/TransformComponent.h"
+#include "Function/Framework/Entity/Entity.h"
+#include "Function/Framework/Scene/Scene.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+// 场景层级世界矩阵的增量更新，分别在深（多条长链）、宽（单层）、树状三种层级上测试
+// 每帧的开销应当只和修改的物体及其子孙数目相关，静态场景为0；同时和逐物体沿父链手动相乘的结果比较
+// 不依赖EngineContext，层内串行计算
+// 例: BenchmarkTransformHierarchy();
+
+namespace BenchmarkTransformHierarchyDetail
+{
+    enum HierarchyShape
+    {
+        HIERARCHY_SHAPE_DEEP = 0,       // 100条链，每条1000层
+        HIERARCHY_SHAPE_WIDE,           // 一个根节点，其余都是它的子物体
+        HIERARCHY_SHAPE_TREE,           // 每个节点8个子物体
+    };
+
+    static std::vector<std::shared_ptr<Entity>> CreateHierarchy(Scene& scene, HierarchyShape shape, uint32_t count)
+    {
+        std::mt19937 random(0);
+        std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> angle(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> scale(0.98f, 1.02f);
+
+        std::vector<std::shared_ptr<Entity>> entities;
+        for(uint32_t i = 0; i < count; i++)
+        {
+            std::shared_ptr<Entity> entity = scene.CreateEntity("Node");
+            std::shared_ptr<TransformComponent> transform = entity->TryGetComponent<TransformComponent>();
+            transform->SetPosition(Vec3(position(random), position(random), position(random)));
+            transform->SetRotation(Vec3(angle(random), angle(random), angle(random)));
+            transform->SetScale(Vec3(scale(random), scale(random), scale(random)));
+
+            uint32_t father = UINT32_MAX;
+            switch (shape) {
+            case HIERARCHY_SHAPE_DEEP:  if(i % 1000 != 0) father = i - 1;  break;
+            case HIERARCHY_SHAPE_WIDE:  if(i != 0) father = 0;             break;
+            case HIERARCHY_SHAPE_TREE:  if(i != 0) father = (i - 1) / 8;   break;
+            }
+            if(father != UINT32_MAX) entity->SetFather(entities[father]);
+
+            entities.push_back(entity);
+        }
+        return entities;
+    }
+
+    // 不做缓存，沿父链逐级相乘
+    static Mat4 LegacyWorldMatrix(std::shared_ptr<Entity> entity)
+    {
+        Mat4 world = Mat4::Identity();
+        for(; entity; entity = entity->GetFather().lock())
+        {
+            world = entity->TryGetComponent<TransformComponent>()->GetLocalMat() * world;
+        }
+        return world;
+    }
+
+    static float MaxError(const std::vector<std::shared_ptr<Entity>>& entities)
+    {
+        float error = 0.0f;
+        for(auto& entity : entities)
+        {
+            std::shared_ptr<TransformComponent> transform = entity->TryGetComponent<TransformComponent>();
+            Mat4 legacy = LegacyWorldMatrix(entity);
+            float norm = std::max(1.0f, legacy.cwiseAbs().maxCoeff());
+            error = std::max(error, (legacy - transform->GetModelMat()).cwiseAbs().maxCoeff() / norm);
+            error = std::max(error, (legacy * transform->GetModelMatInv() - Mat4::Identity()).cwiseAbs().maxCoeff());
+        }
+        return error;
+    }
+
+    // 修改给定的物体后更新，返回耗时，微秒
+    static float ModifyAndUpdate(Scene& scene, const std::vector<std::shared_ptr<Entity>>& entities, const std::vector<uint32_t>& modified, float offset)
+    {
+        TimeScope timer;
+        timer.Begin();
+        for(uint32_t index : modified)
+        {
+            std::shared_ptr<TransformComponent> transform = entities[index]->TryGetComponent<TransformComponent>();
+            transform->SetPosition(transform->GetPosition() + Vec3(offset, 0.0f, 0.0f));
+        }
+        scene.UpdateTransforms();
+        timer.End();
+        return timer.GetMicroSeconds();
+    }
+}
+
+static void BenchmarkTransformHierarchy()
+{
+    using namespace BenchmarkTransformHierarchyDetail;
+
+    const uint32_t count = 100000;
+    const char* shapeNames[] = { "deep", "wide", "tree" };
+
+    for(HierarchyShape shape : { HIERARCHY_SHAPE_DEEP, HIERARCHY_SHAPE_WIDE, HIERARCHY_SHAPE_TREE })
+    {
+        std::shared_ptr<Scene> scene = std::make_shared<Scene>("BenchmarkTransformHierarchy");
+        std::vector<std::shared_ptr<Entity>> entities = CreateHierarchy(*scene, shape, count);
+        TransformHierarchy& hierarchy = scene->GetTransformHierarchy();
+
+        // 手动沿父链计算全部物体的世界矩阵
+        TimeScope timer;
+        timer.Begin();
+        Vec3 sum = Vec3::Zero();
+        for(auto& entity : entities) sum += LegacyWorldMatrix(entity).block<3,1>(0,3);
+        timer.End();
+        printf("[BenchmarkTransformHierarchy] %s, nodes %d, legacy per node chain: %10.1f us (%.1f)\n", shapeNames[shape], count, timer.GetMicroSeconds(), sum.x());
+
+        std::mt19937 random(1);
+        std::vector<uint32_t> leaf = { count - 1 };
+        std::vector<uint32_t> roots, percent;
+        for(uint32_t i = 0; i < count; i++) if(!entities[i]->GetFather().lock()) roots.push_back(i);
+        for(uint32_t i = 0; i < count / 100; i++) percent.push_back(random() % count);
+
+        struct Case { const char* name; std::vector<uint32_t> modified; };
+        std::vector<Case> cases = {
+            { "initial", {} },
+            { "static", {} },
+            { "one leaf", leaf },
+            { "1% nodes", percent },
+            { "roots", roots },
+        };
+
+        bool passed = true;
+        for(uint32_t i = 0; i < cases.size(); i++)
+        {
+            float time = ModifyAndUpdate(*scene, entities, cases[i].modified, 0.5f * i);
+            float error = MaxError(entities);
+            passed &= error < 1e-3f;
+            printf("[BenchmarkTransformHierarchy] %s, %-8s modified %6d, updated %6d nodes in %4d levels, %10.1f us, max error %.2e\n",
+                shapeNames[shape], cases[i].name, (uint32_t)cases[i].modified.size(), hierarchy.GetUpdatedCount(), hierarchy.GetLevelCount(), time, error);
+        }
+        passed &= hierarchy.GetUpdatedCount() == count;   // 修改全部根节点后所有物体都要重新计算
+
+        // 修改父子关系后子树跟随新的父物体
+        entities[count - 1]->SetFather(entities[0]);
+        scene->UpdateTransforms();
+        passed &= MaxError({ entities[count - 1] }) < 1e-3f;
+
+        // 清空待更新列表后，之前标记过的物体再次修改仍要能更新
+        entities[0]->TryGetComponent<TransformComponent>()->SetPosition(Vec3(1.0f, 2.0f, 3.0f));
+        hierarchy.Clear();
+        ModifyAndUpdate(*scene, entities, { 0 }, 1.0f);
+        passed &= MaxError({ entities[0], entities[count - 1] }) < 1e-3f;
+
+        printf("[BenchmarkTransformHierarchy] %s, %s\n", shapeNames[shape], passed ? "passed" : "FAILED");
+    }
+}
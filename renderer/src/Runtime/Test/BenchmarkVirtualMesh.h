@@ -0,0 +1,80 @@
+#pragma once
+
+#include "Core/Mesh/Mesh.h"
+#include "Core/Mesh/VirtualMesh/VirtualMesh.h"
+#include "Core/Util/TimeScope.h"
+#include "Function/Render/RenderResource/Model.h"
+#include "Platform/Thread/QueuedThreadPool.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 虚拟几何体构建的性能测试，需要在EngineContext初始化之后调用（可以使用空RHI后端）
+// 对每个模型分别用1到maxThreads个线程构建，输出吞吐量和加速比，并校验与串行构建的结果完全一致
+// 例: BenchmarkVirtualMesh({ "Asset/BuildIn/Model/Basic/stanford_bunny.obj", "Asset/BuildIn/Model/Klee/klee.obj" }, 8);
+
+static bool IsSameVirtualMesh(const VirtualMesh& a, const VirtualMesh& b)
+{
+    if(a.clusters.size() != b.clusters.size() || a.clusterGroups.size() != b.clusterGroups.size()) return false;
+
+    for(uint32_t i = 0; i < a.clusters.size(); i++)
+    {
+        if( a.clusters[i]->mipLevel != b.clusters[i]->mipLevel ||
+            a.clusters[i]->groupID != b.clusters[i]->groupID ||
+            a.clusters[i]->lodError != b.clusters[i]->lodError ||
+            a.clusters[i]->mesh->index != b.clusters[i]->mesh->index ||
+            a.clusters[i]->mesh->position.size() != b.clusters[i]->mesh->position.size()) return false;
+    }
+    for(uint32_t i = 0; i < a.clusterGroups.size(); i++)
+    {
+        if( a.clusterGroups[i]->clusters != b.clusterGroups[i]->clusters ||
+            a.clusterGroups[i]->parentLodError != b.clusterGroups[i]->parentLodError) return false;
+    }
+    return true;
+}
+
+static void BenchmarkVirtualMesh(const std::vector<std::string>& paths, uint32_t maxThreads)
+{
+    ModelProcessSetting setting = {};   // 只读取mesh，虚拟几何体在下面单独构建
+
+    for(auto& path : paths)
+    {
+        std::shared_ptr<Model> model = std::make_shared<Model>(path, setting);
+
+        uint64_t triangleNum = 0;
+        for(uint32_t i = 0; i < model->GetSubmeshCount(); i++) triangleNum += model->Submesh(i).mesh->index.size() / 3;
+
+        printf("[BenchmarkVirtualMesh] %s, submeshes: %d, triangles: %llu\n", path.c_str(), model->GetSubmeshCount(), (unsigned long long)triangleNum);
+
+        std::vector<VirtualMesh> reference;
+        float serialTime = 0.0f;
+        for(uint32_t threads = 1; threads <= maxThreads; threads++)
+        {
+            QueuedThreadPoolRef threadPool = threads > 1 ? QueuedThreadPool::Create(threads - 1) : nullptr;    // 调用线程本身也参与构建
+
+            std::vector<VirtualMesh> virtualMeshes(model->GetSubmeshCount());
+            TimeScope timer;
+            timer.Begin();
+            for(uint32_t i = 0; i < model->GetSubmeshCount(); i++) virtualMeshes[i].Build(model->Submesh(i).mesh, threadPool);
+            timer.End();
+
+            if(threadPool) threadPool->Destroy();
+
+            float time = timer.GetMilliSeconds();
+            if(threads == 1)
+            {
+                serialTime = time;
+                reference = virtualMeshes;
+            }
+
+            bool same = true;
+            for(uint32_t i = 0; i < virtualMeshes.size(); i++) same &= IsSameVirtualMesh(reference[i], virtualMeshes[i]);
+
+            printf("[BenchmarkVirtualMesh] threads: %2d, time: %10.3f ms, triangles/s: %12.1f, speedup: %5.2fx, deterministic: %s\n",
+                threads, time, triangleNum / (time / 1000.0f), serialTime / time, same ? "true" : "false");
+        }
+    }
+}
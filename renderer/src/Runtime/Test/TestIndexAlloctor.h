@@ -0,0 +1,151 @@
+#pragma once
+
+#include "Core/Util/IndexAlloctor.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// IndexAlloctor的随机压力测试，不依赖EngineContext
+// 用逐索引的占用表做对照，检查分配结果不重叠、统计正确、全部释放后空闲区间完全合并，以及序列化前后行为一致
+// 例: TestIndexAlloctor();
+
+namespace TestIndexAlloctorDetail
+{
+    class Reference
+    {
+    public:
+        Reference(uint32_t maxIndex) : used(maxIndex, false) {}
+
+        bool Mark(IndexRange range, bool value)
+        {
+            if(range.begin == 0 || range.begin + range.size > used.size()) return false;
+            for(uint32_t i = range.begin; i < range.begin + range.size; i++)
+            {
+                if(used[i] == value) return false;
+                used[i] = value;
+            }
+            usedSize = value ? usedSize + range.size : usedSize - range.size;
+            return true;
+        }
+
+        uint32_t usedSize = 0;
+
+    private:
+        std::vector<bool> used;
+    };
+
+    static bool CheckStats(IndexAlloctor& alloctor, const Reference& reference)
+    {
+        IndexAlloctorStats stats = alloctor.GetStats();
+        return  stats.usedSize == reference.usedSize &&
+                stats.usedSize + stats.freeSize + 1 == stats.nextIndex &&
+                stats.largestFreeRange <= stats.freeSize &&
+                (stats.freeRangeCount == 0) == (stats.freeSize == 0);
+    }
+
+    // 随机分配释放，分配大小混合单个索引和较大的范围
+    static bool Stress(uint32_t seed, uint32_t steps, IndexAlloctor& alloctor, std::vector<IndexRange>& ranges)
+    {
+        std::mt19937 random(seed);
+        Reference reference(alloctor.GetSize());
+        for(auto& range : ranges) reference.Mark(range, true);
+
+        for(uint32_t step = 0; step < steps; step++)
+        {
+            bool allocate = ranges.empty() || random() % 100 < 55;
+            if(allocate)
+            {
+                uint32_t size = random() % 4 == 0 ? random() % 64 + 1 : 1;
+                if(alloctor.GetStats().nextIndex + size >= alloctor.GetSize()) continue;     // 不测试超出上限
+
+                IndexRange range = alloctor.Allocate(size);
+                if(range.size != size || !reference.Mark(range, true)) return false;
+                ranges.push_back(range);
+            }
+            else
+            {
+                uint32_t index = random() % ranges.size();
+                IndexRange range = ranges[index];
+                ranges[index] = ranges.back();
+                ranges.pop_back();
+
+                if(random() % 2 == 0 && range.size > 1)        // 释放部分范围，剩余部分之后再释放
+                {
+                    uint32_t split = random() % (range.size - 1) + 1;
+                    ranges.push_back({ range.begin + split, range.size - split });
+                    range.size = split;
+                }
+                alloctor.Release(range);
+                if(!reference.Mark(range, false)) return false;
+            }
+            if(step % 64 == 0 && !CheckStats(alloctor, reference)) return false;
+        }
+        return CheckStats(alloctor, reference);
+    }
+
+    static bool ReleaseAll(IndexAlloctor& alloctor, std::vector<IndexRange>& ranges)
+    {
+        for(auto& range : ranges) alloctor.Release(range);
+        ranges.clear();
+
+        IndexAlloctorStats stats = alloctor.GetStats();
+        return stats.usedSize == 0 && stats.freeSize == 0 && stats.freeRangeCount == 0 && stats.nextIndex == 1;
+    }
+
+    static bool SerializeRoundTrip(uint32_t seed)
+    {
+        IndexAlloctor alloctor(1 << 20);
+        std::vector<IndexRange> ranges;
+        if(!Stress(seed, 4000, alloctor, ranges)) return false;
+
+        std::stringstream stream;
+        {
+            cereal::JSONOutputArchive archive(stream);
+            archive(cereal::make_nvp("alloctor", alloctor));
+        }
+        IndexAlloctor loaded;
+        {
+            cereal::JSONInputArchive archive(stream);
+            archive(cereal::make_nvp("alloctor", loaded));
+        }
+
+        IndexAlloctorStats a = alloctor.GetStats();
+        IndexAlloctorStats b = loaded.GetStats();
+        if( a.usedSize != b.usedSize || a.freeSize != b.freeSize || a.freeRangeCount != b.freeRangeCount ||
+            a.largestFreeRange != b.largestFreeRange || a.nextIndex != b.nextIndex) return false;
+
+        // 读回的分配器继续分配，结果和原分配器一致
+        std::vector<IndexRange> loadedRanges = ranges;
+        if(!Stress(seed + 1, 4000, alloctor, ranges) || !Stress(seed + 1, 4000, loaded, loadedRanges)) return false;
+        for(uint32_t i = 0; i < ranges.size(); i++)
+        {
+            if(ranges[i].begin != loadedRanges[i].begin || ranges[i].size != loadedRanges[i].size) return false;
+        }
+        return ReleaseAll(loaded, loadedRanges);
+    }
+}
+
+static void TestIndexAlloctor()
+{
+    using namespace TestIndexAlloctorDetail;
+
+    uint32_t failed = 0;
+    for(uint32_t seed = 0; seed < 20; seed++)
+    {
+        IndexAlloctor alloctor(1 << 16);
+        std::vector<IndexRange> ranges;
+        if(!Stress(seed, 20000, alloctor, ranges) || !ReleaseAll(alloctor, ranges))
+        {
+            printf("[TestIndexAlloctor] seed %d: stress FAILED\n", seed);
+            failed++;
+        }
+    }
+    printf("[TestIndexAlloctor] stress: %s\n", failed == 0 ? "passed" : "FAILED");
+
+    bool serializePassed = true;
+    for(uint32_t seed = 0; seed < 4; seed++) serializePassed &= SerializeRoundTrip(seed);
+    printf("[TestIndexAlloctor] serialize: %s\n", serializePassed ? "passed" : "FAILED");
+}
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Function/Global/EngineContext.h"
+#include "Function/Global/EngineThreadPool.h"
+#include "Function/Render/RHI/RHI.h"
+#include "Function/Render/RHI/RHIStructs.h"
+#include "Function/Render/RenderResource/PipelineCache.h"
+#include "Function/Render/RenderResource/RenderResourceManager.h"
+#include "Function/Render/RenderResource/Shader.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// 管线后台编译的测试，需要在空后端下(ENABLE_NULL_RHI)初始化EngineContext后调用
+// 编译完成前查询返回pending，完成后返回可用的管线，统计的队列深度和耗时分布和提交的数目一致
+// 使用独立的GraphicsPipelineCache实例，不影响引擎的全局缓存
+// 例: TestPipelineAsyncCompile();
+
+namespace TestPipelineAsyncCompileDetail
+{
+    // 和GBufferPass的默认管线相同的着色器和帧缓冲格式
+    static RHIGraphicsPipelineInfo CreatePipelineInfo(const Shader& vertexShader, const Shader& fragmentShader, RHIRootSignatureRef rootSignature)
+    {
+        RHIGraphicsPipelineInfo pipelineInfo = {};
+        pipelineInfo.vertexShader       = vertexShader.shader;
+        pipelineInfo.fragmentShader     = fragmentShader.shader;
+        pipelineInfo.rootSignature      = rootSignature;
+        pipelineInfo.primitiveType      = PRIMITIVE_TYPE_TRIANGLE_LIST;
+        pipelineInfo.rasterizerState    = { FILL_MODE_SOLID, CULL_MODE_BACK, DEPTH_CLIP, 0.0f, 0.0f };
+        pipelineInfo.colorAttachmentFormats[0]      = FORMAT_R8G8B8A8_UNORM;
+        pipelineInfo.colorAttachmentFormats[1]      = FORMAT_R8G8B8A8_SNORM;
+        pipelineInfo.colorAttachmentFormats[2]      = FORMAT_R16G16B16A16_SFLOAT;
+        pipelineInfo.colorAttachmentFormats[3]      = FORMAT_R32G32_SFLOAT;
+        pipelineInfo.colorAttachmentFormats[4]      = FORMAT_R32_UINT;
+        pipelineInfo.depthStencilState              = { COMPARE_FUNCTION_LESS_EQUAL, true, true };
+        pipelineInfo.depthStencilAttachmentFormat   = FORMAT_D32_SFLOAT;
+        return pipelineInfo;
+    }
+
+    // 材质可能改变的几种状态的组合
+    static std::vector<RHIGraphicsPipelineInfo> CreateVariants(const RHIGraphicsPipelineInfo& base)
+    {
+        std::vector<RHIGraphicsPipelineInfo> infos;
+        for(RasterizerCullMode cullMode : { CULL_MODE_NONE, CULL_MODE_FRONT, CULL_MODE_BACK })
+        {
+            for(RasterizerFillMode fillMode : { FILL_MODE_SOLID, FILL_MODE_WIREFRAME })
+            {
+                for(bool depthWrite : { true, false })
+                {
+                    RHIGraphicsPipelineInfo info = base;
+                    info.rasterizerState.cullMode = cullMode;
+                    info.rasterizerState.fillMode = fillMode;
+                    info.depthStencilState.enableDepthWrite = depthWrite;
+                    infos.push_back(info);
+                }
+            }
+        }
+        return infos;
+    }
+
+    static void Check(bool condition, const char* name, bool& passed)
+    {
+        passed &= condition;
+        if(!condition) printf("[TestPipelineAsyncCompile] %s FAILED\n", name);
+    }
+}
+
+static void TestPipelineAsyncCompile()
+{
+    using namespace TestPipelineAsyncCompileDetail;
+
+    bool passed = true;
+
+    // 耗时分档 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    Check(  PipelineCompileStats::HistogramBucket(0.5f) == 0 &&
+            PipelineCompileStats::HistogramBucket(1.0f) == 1 &&
+            PipelineCompileStats::HistogramBucket(1.9f) == 1 &&
+            PipelineCompileStats::HistogramBucket(2.0f) == 2 &&
+            PipelineCompileStats::HistogramBucket(5.0f) == 3 &&
+            PipelineCompileStats::HistogramBucket(10000.0f) == PIPELINE_COMPILE_HISTOGRAM_SIZE - 1, "histogram bucket", passed);
+
+    Shader vertexShader     = Shader(EngineContext::File()->ShaderPath() + "default/default.vert.spv", SHADER_FREQUENCY_VERTEX);
+    Shader fragmentShader   = Shader(EngineContext::File()->ShaderPath() + "default/deferred.frag.spv", SHADER_FREQUENCY_FRAGMENT);
+
+    RHIRootSignatureInfo rootSignatureInfo = {};
+    rootSignatureInfo.AddEntry(EngineContext::RenderResource()->GetPerFrameRootSignature()->GetInfo());
+    RHIRootSignatureRef rootSignature = EngineContext::RHI()->CreateRootSignature(rootSignatureInfo);
+
+    RHIGraphicsPipelineInfo info = CreatePipelineInfo(vertexShader, fragmentShader, rootSignature);
+    std::shared_ptr<GraphicsPipelineCache> cache = std::make_shared<GraphicsPipelineCache>();
+
+    // 单个管线 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        GraphicsPipelineCache::CachedPipeline first = cache->AllocateAsync(info);
+        Check(first.pending && !first.pipeline, "first query pending", passed);
+
+        EngineContext::ThreadPool()->WaitIdle(ENGINE_THREAD_TYPE_ASSET);
+        GraphicsPipelineCache::CachedPipeline ready = cache->AllocateAsync(info);
+        Check(!ready.pending && ready.pipeline, "ready after compile", passed);
+        Check(cache->AllocateAsync(info).pipeline == ready.pipeline, "cached", passed);
+        Check(cache->Allocate(info).pipeline == ready.pipeline, "shared with sync allocate", passed);
+
+        PipelineCompileStats stats = cache->GetCompileStats();
+        Check(stats.queueDepth == 0 && stats.compiledCount == 1 && stats.failedCount == 0 && cache->GetCompileVersion() == 1, "single stats", passed);
+    }
+
+    // 一批新材质同时出现 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        std::vector<RHIGraphicsPipelineInfo> variants = CreateVariants(info);
+        uint32_t pending = 0;
+        for(auto& variant : variants) if(cache->AllocateAsync(variant).pending) pending++;
+
+        EngineContext::ThreadPool()->WaitIdle(ENGINE_THREAD_TYPE_ASSET);
+        uint32_t ready = 0;
+        for(auto& variant : variants) if(cache->AllocateAsync(variant).pipeline) ready++;
+
+        PipelineCompileStats stats = cache->GetCompileStats();
+        uint32_t histogramCount = 0;
+        for(uint32_t count : stats.histogram) histogramCount += count;
+
+        // 和第一个管线状态相同的变体已经缓存
+        Check(pending == variants.size() - 1 && ready == variants.size(), "batch ready", passed);
+        Check(stats.queueDepth == 0 && stats.maxQueueDepth >= 1 && stats.compiledCount == variants.size(), "batch stats", passed);
+        Check(histogramCount == stats.compiledCount, "histogram count", passed);
+
+        printf("[TestPipelineAsyncCompile] variants %d, max queue depth %d, compile avg %.3f ms, max %.3f ms, latency avg %.3f ms\n",
+            (uint32_t)variants.size(), stats.maxQueueDepth, stats.AverageTime(), stats.maxTime, stats.AverageLatency());
+    }
+
+    // 编译期间清空缓存 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        cache->Clear();
+        RHIGraphicsPipelineInfo variant = info;
+        variant.depthStencilState.depthTest = COMPARE_FUNCTION_GREATER_EQUAL;
+        cache->AllocateAsync(variant);
+        cache->Clear();
+
+        EngineContext::ThreadPool()->WaitIdle(ENGINE_THREAD_TYPE_ASSET);
+        Check(cache->CachedSize() == 0 && cache->GetCompileStats().queueDepth == 0, "clear while compiling", passed);
+        Check(cache->AllocateAsync(variant).pending, "resubmit after clear", passed);
+        EngineContext::ThreadPool()->WaitIdle(ENGINE_THREAD_TYPE_ASSET);
+        Check(cache->AllocateAsync(variant).pipeline != nullptr, "ready after resubmit", passed);
+    }
+
+    // 无效的管线不提交 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        RHIGraphicsPipelineInfo invalid = info;
+        invalid.fragmentShader = nullptr;
+        GraphicsPipelineCache::CachedPipeline cached = cache->AllocateAsync(invalid);
+        Check(!cached.pending && !cached.pipeline && cache->GetCompileStats().queueDepth == 0, "invalid", passed);
+    }
+
+    printf("[TestPipelineAsyncCompile] %s\n", passed ? "passed" : "FAILED");
+}
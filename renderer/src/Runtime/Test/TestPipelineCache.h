@@ -0,0 +1,253 @@
+#pragma once
+
+#include "Function/Render/RHI/PipelineCacheFile.h"
+#include "Function/Render/RHI/RHIResource.h"
+#include "Function/Render/RHI/RHIStructs.h"
+#include "Function/Render/RenderResource/PipelineCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// 磁盘管线缓存文件的校验，以及预热列表的序列化和按内容哈希重放，不依赖GPU和EngineContext
+// 着色器和根签名用只在CPU端的对象代替，重放时重新创建一份内容相同的对象，模拟下一次启动
+// 例: TestPipelineCache();
+
+namespace TestPipelineCacheDetail
+{
+    class TestRootSignature : public RHIRootSignature
+    {
+    public:
+        TestRootSignature(const RHIRootSignatureInfo& info) : RHIRootSignature(info) {}
+
+        virtual RHIDescriptorSetRef CreateDescriptorSet(uint32_t set) override final { return nullptr; }
+    };
+
+    static RHIShaderRef CreateShader(ShaderFrequency frequency, uint32_t seed)
+    {
+        RHIShaderInfo info = { .frequency = frequency };
+        info.code.resize(1024);
+        std::mt19937 random(seed);
+        for(auto& byte : info.code) byte = random() & 0xFF;
+        return std::make_shared<RHIShader>(info);
+    }
+
+    static RHIRootSignatureRef CreateRootSignature(uint32_t bindingCount)
+    {
+        RHIRootSignatureInfo info = {};
+        info.AddPushConstant({ 128, SHADER_FREQUENCY_ALL });
+        for(uint32_t i = 0; i < bindingCount; i++) info.AddEntry({ 1, i, 1, SHADER_FREQUENCY_ALL, RESOURCE_TYPE_UNIFORM_BUFFER });
+        return std::make_shared<TestRootSignature>(info);
+    }
+
+    struct Resources
+    {
+        RHIShaderRef vertexShader;
+        RHIShaderRef geometryShader;
+        RHIShaderRef fragmentShader;
+        RHIShaderRef maskedFragmentShader;
+        RHIRootSignatureRef rootSignature;
+
+        std::unordered_map<uint64_t, RHIShaderRef> shaders;
+        std::unordered_map<uint64_t, RHIRootSignatureRef> rootSignatures;
+    };
+
+    static Resources CreateResources(bool withMasked)
+    {
+        Resources resources;
+        resources.vertexShader = CreateShader(SHADER_FREQUENCY_VERTEX, 0);
+        resources.geometryShader = CreateShader(SHADER_FREQUENCY_GEOMETRY, 1);
+        resources.fragmentShader = CreateShader(SHADER_FREQUENCY_FRAGMENT, 2);
+        resources.maskedFragmentShader = withMasked ? CreateShader(SHADER_FREQUENCY_FRAGMENT, 3) : nullptr;
+        resources.rootSignature = CreateRootSignature(4);
+
+        for(auto& shader : { resources.vertexShader, resources.geometryShader, resources.fragmentShader, resources.maskedFragmentShader })
+        {
+            if(shader) resources.shaders[shader->GetHash()] = shader;
+        }
+        resources.rootSignatures[resources.rootSignature->GetHash()] = resources.rootSignature;
+        return resources;
+    }
+
+    // 几种mesh pass里常见的管线状态
+    static std::vector<RHIGraphicsPipelineInfo> CreatePipelineInfos(const Resources& resources)
+    {
+        std::vector<RHIGraphicsPipelineInfo> infos;
+
+        RHIGraphicsPipelineInfo info = {};
+        info.vertexShader = resources.vertexShader;
+        info.fragmentShader = resources.fragmentShader;
+        info.rootSignature = resources.rootSignature;
+        info.colorAttachmentFormats[0] = FORMAT_R16G16B16A16_SFLOAT;
+        info.depthStencilAttachmentFormat = FORMAT_D32_SFLOAT;
+        infos.push_back(info);
+
+        info.rasterizerState.cullMode = CULL_MODE_NONE;
+        info.blendState.renderTargets[0].enable = true;
+        info.blendState.renderTargets[0].colorSrcBlend = BLEND_FACTOR_SRC_ALPHA;
+        info.blendState.renderTargets[0].colorDstBlend = BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        infos.push_back(info);
+
+        info = {};
+        info.vertexShader = resources.vertexShader;
+        info.geometryShader = resources.geometryShader;
+        info.fragmentShader = resources.fragmentShader;
+        info.rootSignature = resources.rootSignature;
+        info.depthStencilState.depthTest = COMPARE_FUNCTION_LESS;
+        info.depthStencilAttachmentFormat = FORMAT_D32_SFLOAT;
+        info.viewMask = 0b00111111;
+        infos.push_back(info);
+
+        if(resources.maskedFragmentShader)
+        {
+            info = infos[0];
+            info.fragmentShader = resources.maskedFragmentShader;
+            infos.push_back(info);
+        }
+        return infos;
+    }
+
+    static bool SameInfo(const RHIGraphicsPipelineInfo& a, const RHIGraphicsPipelineInfo& b)
+    {
+        return  a == b &&
+                a.colorAttachmentFormats == b.colorAttachmentFormats &&
+                a.depthStencilAttachmentFormat == b.depthStencilAttachmentFormat;
+    }
+
+    static void Check(bool condition, const char* name, bool& passed)
+    {
+        passed &= condition;
+        if(!condition) printf("[TestPipelineCache] %s FAILED\n", name);
+    }
+}
+
+static void TestPipelineCache()
+{
+    using namespace TestPipelineCacheDetail;
+
+    bool passed = true;
+
+    // 缓存文件 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        PipelineCacheDeviceInfo device = { .vendorID = 0x10DE, .deviceID = 0x2684, .driverVersion = 0x89A8C000 };
+        for(uint32_t i = 0; i < 16; i++) device.uuid[i] = i * 7 + 1;
+
+        std::vector<uint8_t> data(4096), unpacked;
+        std::mt19937 random(0);
+        for(auto& byte : data) byte = random() & 0xFF;
+
+        std::vector<uint8_t> file = PipelineCacheFile::Pack(device, data);
+        Check(PipelineCacheFile::Unpack(file, device, unpacked) == PIPELINE_CACHE_FILE_OK && unpacked == data, "round trip", passed);
+
+        std::vector<uint8_t> empty = PipelineCacheFile::Pack(device, {});
+        Check(PipelineCacheFile::Unpack(empty, device, unpacked) == PIPELINE_CACHE_FILE_OK && unpacked.empty(), "empty data", passed);
+
+        PipelineCacheDeviceInfo other = device;
+        other.vendorID++;
+        Check(PipelineCacheFile::Unpack(file, other, unpacked) == PIPELINE_CACHE_FILE_DEVICE_MISMATCH && unpacked.empty(), "vendor mismatch", passed);
+        other = device;
+        other.deviceID++;
+        Check(PipelineCacheFile::Unpack(file, other, unpacked) == PIPELINE_CACHE_FILE_DEVICE_MISMATCH, "device mismatch", passed);
+        other = device;
+        other.driverVersion++;
+        Check(PipelineCacheFile::Unpack(file, other, unpacked) == PIPELINE_CACHE_FILE_DEVICE_MISMATCH, "driver mismatch", passed);
+        other = device;
+        other.uuid[15] ^= 1;
+        Check(PipelineCacheFile::Unpack(file, other, unpacked) == PIPELINE_CACHE_FILE_DEVICE_MISMATCH, "uuid mismatch", passed);
+
+        std::vector<uint8_t> broken = file;
+        broken.resize(file.size() - 1);
+        Check(PipelineCacheFile::Unpack(broken, device, unpacked) == PIPELINE_CACHE_FILE_INVALID, "truncated data", passed);
+        broken.resize(sizeof(PipelineCacheFileHeader) - 1);
+        Check(PipelineCacheFile::Unpack(broken, device, unpacked) == PIPELINE_CACHE_FILE_INVALID, "truncated header", passed);
+        Check(PipelineCacheFile::Unpack({}, device, unpacked) == PIPELINE_CACHE_FILE_INVALID, "empty file", passed);
+
+        broken = file;
+        broken[0] ^= 1;
+        Check(PipelineCacheFile::Unpack(broken, device, unpacked) == PIPELINE_CACHE_FILE_INVALID, "magic", passed);
+        broken = file;
+        broken[sizeof(uint32_t)]++;
+        Check(PipelineCacheFile::Unpack(broken, device, unpacked) == PIPELINE_CACHE_FILE_INVALID, "version", passed);
+        broken = file;
+        broken[sizeof(PipelineCacheFileHeader) + 100] ^= 0x10;
+        Check(PipelineCacheFile::Unpack(broken, device, unpacked) == PIPELINE_CACHE_FILE_CORRUPTED && unpacked.empty(), "corrupted data", passed);
+    }
+
+    // 内容哈希 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        Check(CreateShader(SHADER_FREQUENCY_VERTEX, 0)->GetHash() == CreateShader(SHADER_FREQUENCY_VERTEX, 0)->GetHash(), "shader hash stable", passed);
+        Check(CreateShader(SHADER_FREQUENCY_VERTEX, 0)->GetHash() != CreateShader(SHADER_FREQUENCY_VERTEX, 1)->GetHash(), "shader hash code", passed);
+        Check(CreateShader(SHADER_FREQUENCY_VERTEX, 0)->GetHash() != CreateShader(SHADER_FREQUENCY_FRAGMENT, 0)->GetHash(), "shader hash frequency", passed);
+        Check(CreateRootSignature(4)->GetHash() == CreateRootSignature(4)->GetHash(), "root signature hash stable", passed);
+        Check(CreateRootSignature(4)->GetHash() != CreateRootSignature(5)->GetHash(), "root signature hash entries", passed);
+    }
+
+    // 预热列表 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        Resources resources = CreateResources(true);
+        std::vector<RHIGraphicsPipelineInfo> infos = CreatePipelineInfos(resources);
+
+        std::vector<PipelineWarmupRecord> records;
+        for(auto& info : infos)
+        {
+            PipelineWarmupRecord record;
+            Check(GraphicsPipelineCache::MakeWarmupRecord(info, record), "make record", passed);
+            records.push_back(record);
+        }
+
+        RHIGraphicsPipelineInfo withInput = infos[0];
+        withInput.vertexInputState.vertexElements.push_back({});
+        PipelineWarmupRecord record;
+        Check(!GraphicsPipelineCache::MakeWarmupRecord(withInput, record), "skip vertex input", passed);
+
+        std::vector<uint8_t> file = GraphicsPipelineCache::SerializeWarmupList(records);
+        std::vector<PipelineWarmupRecord> loaded;
+        Check(  GraphicsPipelineCache::DeserializeWarmupList(file, loaded) && loaded.size() == records.size() &&
+                memcmp(loaded.data(), records.data(), records.size() * sizeof(PipelineWarmupRecord)) == 0, "list round trip", passed);
+
+        std::vector<uint8_t> broken = file;
+        broken.back() ^= 1;
+        Check(!GraphicsPipelineCache::DeserializeWarmupList(broken, loaded) && loaded.empty(), "list corrupted", passed);
+        broken = file;
+        broken.resize(file.size() - sizeof(PipelineWarmupRecord));
+        Check(!GraphicsPipelineCache::DeserializeWarmupList(broken, loaded), "list truncated", passed);
+        broken = file;
+        broken[2 * sizeof(uint32_t)]++;
+        Check(!GraphicsPipelineCache::DeserializeWarmupList(broken, loaded), "list record size", passed);
+
+        // 下一次启动，masked材质还未加载
+        Resources next = CreateResources(false);
+        std::vector<RHIGraphicsPipelineInfo> expected = CreatePipelineInfos(next);
+        GraphicsPipelineCache::DeserializeWarmupList(file, loaded);
+
+        uint32_t resolved = 0;
+        std::vector<PipelineWarmupRecord> pending;
+        for(uint32_t i = 0; i < loaded.size(); i++)
+        {
+            RHIGraphicsPipelineInfo info;
+            if(GraphicsPipelineCache::ResolveWarmupRecord(loaded[i], next.shaders, next.rootSignatures, info))
+            {
+                Check(i < expected.size() && SameInfo(info, expected[i]), "resolve", passed);
+                resolved++;
+            }
+            else pending.push_back(loaded[i]);
+        }
+        Check(resolved == expected.size() && pending.size() == 1, "resolve count", passed);
+
+        // 加载之后重试
+        RHIShaderRef masked = CreateShader(SHADER_FREQUENCY_FRAGMENT, 3);
+        next.shaders[masked->GetHash()] = masked;
+        RHIGraphicsPipelineInfo info;
+        Check(  GraphicsPipelineCache::ResolveWarmupRecord(pending[0], next.shaders, next.rootSignatures, info) &&
+                info.fragmentShader == masked && info.vertexShader == next.vertexShader, "resolve after load", passed);
+
+        printf("[TestPipelineCache] warmup records %d, list size %d bytes, resolved %d, pending %d\n",
+            (uint32_t)records.size(), (uint32_t)file.size(), resolved, (uint32_t)pending.size());
+    }
+
+    printf("[TestPipelineCache] %s\n", passed ? "passed" : "FAILED");
+}
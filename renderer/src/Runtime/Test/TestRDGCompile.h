@@ -0,0 +1,279 @@
+#pragma once
+
+#include "Function/Render/RDG/RDGBuilder.h"
+#include "Function/Render/RDG/RDGEdge.h"
+#include "Function/Render/RDG/RDGNode.h"
+#include "Function/Render/RHI/RHIStructs.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// RDG编译阶段的测试，只构建图并调用Compile，不依赖EngineContext和GPU
+// 对照组为编译阶段之前在执行时逐边扫描全部边的PreviousState/IsLastUsedPass
+// 例: TestRDGCompile();
+
+namespace TestRDGCompileDetail
+{
+    struct ReferenceState
+    {
+        RHIResourceState state = RESOURCE_STATE_UNDEFINED;
+        bool initState = true;
+
+        bool operator==(const ReferenceState& other) const { return state == other.state && initState == other.initState; }
+    };
+
+    // 原RDGBuilder::PreviousState，资源的初始状态用initState标记，跳过被剔除的pass
+    static ReferenceState PreviousState(RDGDependencyGraphRef graph, RDGTextureNodeRef textureNode, RDGPassNodeRef passNode, TextureSubresourceRange subresource, bool output)
+    {
+        uint32_t currentID = passNode->ID();
+        uint32_t previousID = UINT32_MAX;
+        ReferenceState previous = {};
+
+        graph->ForEachPass(textureNode, [&](RDGTextureEdgeRef edge, RDGPassNodeRef pass){
+
+            if(pass->IsCulled()) return;
+            bool isOutputFirst = output ? !edge->IsOutput() : edge->IsOutput();
+            bool isPrevoiusPass = output ? pass->ID() <= currentID : pass->ID() < currentID;
+            bool isSubresourceCovered = subresource.IsDefault() || edge->subresource.IsDefault() || subresource == edge->subresource;
+
+            if(!(isPrevoiusPass && isSubresourceCovered)) return;
+            if(pass->ID() > previousID || previousID == UINT32_MAX || (pass->ID() == previousID && isOutputFirst))
+            {
+                previous = { edge->state, false };
+                previousID = pass->ID();
+            }
+        });
+        return previous;
+    }
+
+    // 原实现的调用处把output误传给了offset，这里按本意传入范围和output
+    static ReferenceState PreviousState(RDGDependencyGraphRef graph, RDGBufferNodeRef bufferNode, RDGPassNodeRef passNode, uint32_t offset, uint32_t size, bool output)
+    {
+        uint32_t currentID = passNode->ID();
+        uint32_t previousID = UINT32_MAX;
+        ReferenceState previous = {};
+
+        graph->ForEachPass(bufferNode, [&](RDGBufferEdgeRef edge, RDGPassNodeRef pass){
+
+            if(pass->IsCulled()) return;
+            bool isOutputFirst = output ? !edge->IsOutput() : edge->IsOutput();
+            bool isPrevoiusPass = output ? pass->ID() <= currentID : pass->ID() < currentID;
+            bool isSubresourceCovered = (offset == 0 && size == 0) ||
+                                        (edge->offset == 0 && edge->size == 0) ||
+                                        (offset == edge->offset && size == edge->size);
+
+            if(!(isPrevoiusPass && isSubresourceCovered)) return;
+            if(pass->ID() > previousID || previousID == UINT32_MAX || (pass->ID() == previousID && isOutputFirst))
+            {
+                previous = { edge->state, false };
+                previousID = pass->ID();
+            }
+        });
+        return previous;
+    }
+
+    template<typename NodeType>
+    static bool IsLastUsedPass(RDGDependencyGraphRef graph, NodeType node, RDGPassNodeRef passNode, bool output)
+    {
+        bool last = true;
+        graph->ForEachPass(node, [&](auto edge, RDGPassNodeRef pass){
+            if(pass->IsCulled()) return;
+            if(pass->ID() > passNode->ID()) last = false;
+            if(!output && pass->ID() == passNode->ID() && edge->IsOutput()) last = false;
+        });
+        return last;
+    }
+
+    // 原ReleaseResource，按pass->ForEachTexture的顺序第一条满足条件的边决定释放时的状态
+    static void ReferenceReleases(  RDGDependencyGraphRef graph, RDGPassNodeRef pass,
+                                    std::map<RDGNodeRef, RHIResourceState>& textures,
+                                    std::map<RDGNodeRef, RHIResourceState>& buffers)
+    {
+        pass->ForEachTexture([&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
+            if(IsLastUsedPass(graph, texture, pass, edge->IsOutput()) && textures.count(texture) == 0) textures[texture] = edge->state;
+        });
+        pass->ForEachBuffer([&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
+            if(IsLastUsedPass(graph, buffer, pass, edge->IsOutput()) && buffers.count(buffer) == 0) buffers[buffer] = edge->state;
+        });
+    }
+
+    static TextureSubresourceRange RandomRange(std::mt19937& random)
+    {
+        if(random() % 2 == 0) return {};
+        return { TEXTURE_ASPECT_COLOR, (uint32_t)(random() % 4), 1, 0, 1 };
+    }
+
+    // 合成的渲染图：计算/渲染/拷贝pass随机读写纹理（部分为单个mip）和缓冲（部分为子范围），穿插输出声明，最后present
+    // deadPassInterval不为0时，每隔若干个pass插入一个只写入无人读取的纹理的pass，应当被剔除
+    static void BuildSyntheticGraph(RDGBuilder& builder, uint32_t passCount, uint32_t seed, uint32_t deadPassInterval = 0)
+    {
+        std::mt19937 random(seed);
+
+        uint32_t textureCount = passCount / 4 + 4;
+        uint32_t bufferCount = passCount / 8 + 2;
+        std::vector<RDGTextureHandle> textures;
+        std::vector<RDGBufferHandle> buffers;
+        for(uint32_t i = 0; i < textureCount; i++) textures.push_back(builder.CreateTexture("Texture " + std::to_string(i)).MipLevels(4).Finish());
+        for(uint32_t i = 0; i < bufferCount; i++)  buffers.push_back(builder.CreateBuffer("Buffer " + std::to_string(i)).Size(1024).Finish());
+
+        auto texture = [&]() { return textures[random() % textureCount]; };
+        auto buffer = [&]() { return buffers[random() % bufferCount]; };
+
+        for(uint32_t i = 0; i < passCount; i++)
+        {
+            std::string name = "Pass " + std::to_string(i);
+            if(deadPassInterval != 0 && i % deadPassInterval == deadPassInterval - 1)
+            {
+                RDGTextureHandle dead = builder.CreateTexture("Dead " + std::to_string(i)).Finish();
+                builder.CreateComputePass(name)
+                    .Read(0, 0, 0, texture())
+                    .ReadWrite(0, 1, 0, dead)
+                    .Finish();
+                continue;
+            }
+
+            uint32_t type = random() % 10;
+            if(type < 6)
+            {
+                RDGComputePassBuilder pass = builder.CreateComputePass(name);
+                for(uint32_t j = 0; j < 1 + random() % 3; j++) pass.Read(0, j, 0, texture(), VIEW_TYPE_2D, RandomRange(random));
+                for(uint32_t j = 0; j < 1 + random() % 2; j++) pass.ReadWrite(1, j, 0, texture(), VIEW_TYPE_2D, RandomRange(random));
+                if(random() % 2 == 0)
+                {
+                    bool whole = random() % 2 == 0;
+                    pass.Read(2, 0, 0, buffer(), whole ? 0 : (random() % 4) * 256, whole ? 0 : 256);
+                }
+                if(random() % 3 == 0) pass.ReadWrite(2, 1, 0, buffer());
+                if(random() % 4 == 0) pass.OutputRead(texture(), RandomRange(random));
+                if(random() % 4 == 0) pass.OutputReadWrite(buffer());
+                pass.Finish();
+            }
+            else if(type < 9)
+            {
+                RDGRenderPassBuilder pass = builder.CreateRenderPass(name);
+                for(uint32_t j = 0; j < 1 + random() % 3; j++) pass.Read(0, j, 0, texture());
+                pass.Color(0, texture());
+                if(random() % 2 == 0) pass.DepthStencil(texture());
+                if(random() % 3 == 0) pass.Read(1, 0, 0, buffer());
+                pass.Finish();
+            }
+            else
+            {
+                builder.CreateCopyPass(name)
+                    .From(buffer(), 0, 256)
+                    .To(buffer(), 256, 256)
+                    .Finish();
+            }
+        }
+
+        RDGTextureHandle present = builder.CreateTexture("Present").Finish();
+        builder.CreatePresentPass("Present Pass")
+            .Texture(textures[random() % textureCount])
+            .PresentTexture(present)
+            .Finish();
+    }
+
+    // 逐个pass和原实现比较屏障的源状态和资源的释放状态，返回不一致的数目
+    static uint32_t CompareWithReference(RDGBuilder& builder, uint32_t& barrierCount, uint32_t& batchCount)
+    {
+        RDGDependencyGraphRef graph = builder.GetGraph();
+        uint32_t mismatch = 0;
+        barrierCount = 0;
+        batchCount = 0;
+
+        for(auto& pass : graph->GetNodes<RDGPassNode>())
+        {
+            if(pass->IsCulled()) continue;
+            const RDGCompiledPass& compiled = pass->GetCompiled();
+
+            std::vector<std::pair<RDGTextureEdgeRef, ReferenceState>> inputTextures, outputTextures;
+            std::vector<std::pair<RDGBufferEdgeRef, ReferenceState>> inputBuffers, outputBuffers;
+            graph->ForEachTexture(pass, [&](RDGTextureEdgeRef edge, RDGTextureNodeRef texture){
+                auto& list = edge->IsOutput() ? outputTextures : inputTextures;
+                list.push_back({ edge, PreviousState(graph, texture, pass, edge->subresource, edge->IsOutput()) });
+            });
+            graph->ForEachBuffer(pass, [&](RDGBufferEdgeRef edge, RDGBufferNodeRef buffer){
+                auto& list = edge->IsOutput() ? outputBuffers : inputBuffers;
+                list.push_back({ edge, PreviousState(graph, buffer, pass, edge->offset, edge->size, edge->IsOutput()) });
+            });
+
+            auto compare = [&](const auto& reference, const auto& barriers) {
+                if(reference.size() != barriers.size()) { mismatch += 1; return; }
+                for(uint32_t i = 0; i < reference.size(); i++)
+                {
+                    ReferenceState state = { barriers[i].srcState, barriers[i].initState };
+                    if(reference[i].first != barriers[i].edge || !(reference[i].second == state)) mismatch++;
+                    if(i == 0 || barriers[i].newBatch) batchCount++;
+                }
+                barrierCount += reference.size();
+            };
+            compare(inputTextures, compiled.inputTextureBarriers);
+            compare(inputBuffers, compiled.inputBufferBarriers);
+            compare(outputTextures, compiled.outputTextureBarriers);
+            compare(outputBuffers, compiled.outputBufferBarriers);
+
+            std::map<RDGNodeRef, RHIResourceState> referenceTextures, referenceBuffers;
+            ReferenceReleases(graph, pass, referenceTextures, referenceBuffers);
+
+            std::map<RDGNodeRef, RHIResourceState> textures, buffers;
+            for(auto& release : compiled.releaseTextures) textures[release.first] = release.second;
+            for(auto& release : compiled.releaseBuffers)  buffers[release.first] = release.second;
+            if(textures != referenceTextures || compiled.releaseTextures.size() != textures.size()) mismatch++;
+            if(buffers != referenceBuffers || compiled.releaseBuffers.size() != buffers.size()) mismatch++;
+        }
+        return mismatch;
+    }
+
+    // A写T0，B读T0写T1，C写T2无人读取，D读T3写T4，E读T4写T5无人读取，F只读T1，present读T1
+    // 应剔除C和D，E（D的输出只被被剔除的E使用），保留没有声明写入的F
+    static bool TestCulling()
+    {
+        RDGBuilder builder(nullptr);
+        std::vector<RDGTextureHandle> t;
+        for(uint32_t i = 0; i < 6; i++) t.push_back(builder.CreateTexture("T" + std::to_string(i)).Finish());
+        RDGTextureHandle present = builder.CreateTexture("Present").Finish();
+
+        RDGComputePassHandle a = builder.CreateComputePass("A").ReadWrite(0, 0, 0, t[0]).Finish();
+        RDGComputePassHandle b = builder.CreateComputePass("B").Read(0, 0, 0, t[0]).ReadWrite(0, 1, 0, t[1]).Finish();
+        RDGRenderPassHandle c = builder.CreateRenderPass("C").Color(0, t[2]).Finish();
+        RDGComputePassHandle d = builder.CreateComputePass("D").Read(0, 0, 0, t[3]).ReadWrite(0, 1, 0, t[4]).Finish();
+        RDGComputePassHandle e = builder.CreateComputePass("E").Read(0, 0, 0, t[4]).ReadWrite(0, 1, 0, t[5]).Finish();
+        RDGComputePassHandle f = builder.CreateComputePass("F").Read(0, 0, 0, t[1]).Finish();
+        RDGPresentPassHandle p = builder.CreatePresentPass("Present Pass").Texture(t[1]).PresentTexture(present).Finish();
+        builder.Compile();
+
+        RDGDependencyGraphRef graph = builder.GetGraph();
+        auto culled = [&](uint32_t id) { return graph->GetNode<RDGPassNode>(id)->IsCulled(); };
+        return  !culled(a.ID()) && !culled(b.ID()) && culled(c.ID()) && culled(d.ID()) &&
+                culled(e.ID()) && !culled(f.ID()) && !culled(p.ID());
+    }
+}
+
+static void TestRDGCompile()
+{
+    using namespace TestRDGCompileDetail;
+
+    bool cullingPassed = TestCulling();
+    printf("[TestRDGCompile] culling: %s\n", cullingPassed ? "passed" : "FAILED");
+
+    uint32_t failed = 0;
+    for(uint32_t seed = 0; seed < 20; seed++)
+    {
+        RDGBuilder builder(nullptr);
+        BuildSyntheticGraph(builder, 50 + seed * 10, seed, seed % 2 == 0 ? 0 : 7);
+        builder.Compile();
+
+        uint32_t barrierCount, batchCount;
+        uint32_t mismatch = CompareWithReference(builder, barrierCount, batchCount);
+        if(mismatch != 0)
+        {
+            printf("[TestRDGCompile] seed %d: %d mismatch in %d barriers\n", seed, mismatch, barrierCount);
+            failed++;
+        }
+    }
+    printf("[TestRDGCompile] barrier states: %s\n", failed == 0 ? "passed" : "FAILED");
+}
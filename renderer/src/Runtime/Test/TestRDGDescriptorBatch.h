@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Function/Global/EngineContext.h"
+#include "Function/Render/RDG/RDGBuilder.h"
+#include "Function/Render/RDG/RDGPool.h"
+#include "Function/Render/RHI/NullRHI/NullRHI.h"
+#include "Function/Render/RHI/NullRHI/NullRHIResource.h"
+#include "Function/Render/RHI/RHI.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 描述符批量写入和按内容复用的测试，需要在空后端下(ENABLE_NULL_RHI)初始化EngineContext后调用
+// 先直接测试描述符池：内容相同时取回原来的描述符且不产生写入，内容不同时一次提交全部写入
+// 再逐帧执行同一张图，统计空后端记录的每帧描述符写入数和提交次数，渲染流程不变时稳定后每帧应当为0
+// 例: TestRDGDescriptorBatch();
+
+namespace TestRDGDescriptorBatchDetail
+{
+    static RHIRootSignatureRef CreateRootSignature()
+    {
+        RHIRootSignatureInfo info = {};
+        for(uint32_t i = 0; i < 2; i++) info.AddEntry({ 0, i, 1, SHADER_FREQUENCY_COMPUTE, RESOURCE_TYPE_TEXTURE });
+        info.AddEntry({ 0, 2, 1, SHADER_FREQUENCY_COMPUTE, RESOURCE_TYPE_SAMPLER });
+        for(uint32_t i = 0; i < 2; i++) info.AddEntry({ 1, i, 1, SHADER_FREQUENCY_COMPUTE, RESOURCE_TYPE_BUFFER });
+        return EngineContext::RHI()->CreateRootSignature(info);
+    }
+
+    static std::vector<RHIDescriptorUpdateInfo> BufferWrites(const std::vector<RHIBufferRef>& buffers)
+    {
+        std::vector<RHIDescriptorUpdateInfo> writes;
+        for(uint32_t i = 0; i < buffers.size(); i++) writes.push_back({ .binding = i, .resourceType = RESOURCE_TYPE_BUFFER, .buffer = buffers[i] });
+        return writes;
+    }
+
+    static bool Contains(RHIDescriptorSetRef descriptor, const std::vector<RHIDescriptorUpdateInfo>& writes)
+    {
+        const std::vector<RHIDescriptorUpdateInfo>& bindings = std::static_pointer_cast<NullRHIDescriptorSet>(descriptor)->GetBindings();
+        for(auto& write : writes)
+        {
+            bool found = false;
+            for(auto& binding : bindings) found |= binding.binding == write.binding && binding.buffer == write.buffer;
+            if(!found) return false;
+        }
+        return true;
+    }
+
+    // 资源尺寸各不相同，资源池每帧分配到的对象一致
+    static void BuildGraph(RDGBuilder& builder, RHIRootSignatureRef rootSignature, uint32_t passCount, RHISamplerRef sampler)
+    {
+        std::vector<RDGTextureHandle> textures;
+        std::vector<RDGBufferHandle> buffers;
+        for(uint32_t i = 0; i < 8; i++) textures.push_back(builder.CreateTexture("Texture " + std::to_string(i)).Exetent({ 64 + i, 64, 1 }).Format(FORMAT_R8G8B8A8_UNORM).Finish());
+        for(uint32_t i = 0; i < 4; i++) buffers.push_back(builder.CreateBuffer("Buffer " + std::to_string(i)).Size(1024 * (i + 1)).Finish());
+
+        for(uint32_t i = 0; i < passCount; i++)
+        {
+            RDGComputePassBuilder pass = builder.CreateComputePass("Pass " + std::to_string(i));
+            pass.RootSignature(rootSignature)
+                .Read(0, 0, 0, textures[i % textures.size()])
+                .Read(0, 1, 0, textures[(i * 3 + 1) % textures.size()])
+                .Read(1, 0, 0, buffers[i % buffers.size()]);
+            if(i % 2 == 0) pass.Sampler(0, 2, 0, sampler);
+            pass.Finish();
+        }
+    }
+
+    static void Check(bool condition, const char* name, bool& passed)
+    {
+        passed &= condition;
+        if(!condition) printf("[TestRDGDescriptorBatch] %s FAILED\n", name);
+    }
+}
+
+static void TestRDGDescriptorBatch()
+{
+    using namespace TestRDGDescriptorBatchDetail;
+
+    std::shared_ptr<NullRHIBackend> backend = std::dynamic_pointer_cast<NullRHIBackend>(EngineContext::RHI());
+    if(backend == nullptr)
+    {
+        printf("[TestRDGDescriptorBatch] skipped, requires null RHI backend\n");
+        return;
+    }
+
+    bool passed = true;
+    RHIRootSignatureRef rootSignature = CreateRootSignature();
+
+    // 描述符池 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        std::vector<RHIBufferRef> buffers;
+        for(uint32_t i = 0; i < 4; i++) buffers.push_back(backend->CreateBuffer({ .size = 256 }));
+        std::vector<RHIDescriptorUpdateInfo> writesA = BufferWrites({ buffers[0], buffers[1] });
+        std::vector<RHIDescriptorUpdateInfo> writesB = BufferWrites({ buffers[2], buffers[3] });
+
+        RDGDescriptorSetPool pool;
+        backend->ResetStatistics();
+        RDGDescriptorSetPool::PooledDescriptor a = pool.Allocate(rootSignature, 1, writesA);
+        Check(  backend->GetStatistics().descriptorBatchCount == 1 &&
+                backend->GetStatistics().descriptorUpdateCount == 2 &&
+                Contains(a.descriptor, writesA), "first write batched", passed);
+
+        pool.Release(a, rootSignature, 1);
+        RDGDescriptorSetPool::PooledDescriptor reused = pool.Allocate(rootSignature, 1, writesA);
+        Check(reused.descriptor == a.descriptor && backend->GetStatistics().descriptorBatchCount == 1, "same content reused", passed);
+
+        pool.Release(reused, rootSignature, 1);
+        RDGDescriptorSetPool::PooledDescriptor b = pool.Allocate(rootSignature, 1, writesB);
+        Check(backend->GetStatistics().descriptorBatchCount == 2 && Contains(b.descriptor, writesB), "different content rewritten", passed);
+
+        // 两份内容都在池中时，各自取回写入过相同内容的描述符，和释放顺序无关
+        RDGDescriptorSetPool::PooledDescriptor a2 = pool.Allocate(rootSignature, 1, writesA);
+        pool.Release(a2, rootSignature, 1);
+        pool.Release(b, rootSignature, 1);
+        uint64_t batchCount = backend->GetStatistics().descriptorBatchCount;
+        RDGDescriptorSetPool::PooledDescriptor a3 = pool.Allocate(rootSignature, 1, writesA);
+        RDGDescriptorSetPool::PooledDescriptor b3 = pool.Allocate(rootSignature, 1, writesB);
+        Check(  a3.descriptor == a2.descriptor && b3.descriptor == b.descriptor &&
+                backend->GetStatistics().descriptorBatchCount == batchCount, "match by content", passed);
+
+        Check(RDGDescriptorSetPool::HashWrites(writesA) != RDGDescriptorSetPool::HashWrites(writesB), "hash", passed);
+    }
+
+    // 逐帧执行 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        const uint32_t passCount = 64;
+        const uint32_t frameCount = 6;
+        RHISamplerRef sampler = backend->CreateSampler({});
+        RHIQueueRef queue = backend->GetQueue({ QUEUE_TYPE_GRAPHICS, 0 });
+        RHICommandListRef command = backend->CreateCommandPool({ queue })->CreateCommandList(false);
+
+        std::vector<NullRHIStatistics> frames;
+        for(uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            backend->ResetStatistics();
+            command->BeginCommand();
+            {
+                RDGBuilder builder(command);
+                BuildGraph(builder, rootSignature, passCount, sampler);
+                builder.Execute();
+            }
+            command->EndCommand();
+            command->Execute();
+            frames.push_back(backend->GetStatistics());
+
+            printf("[TestRDGDescriptorBatch] frame %d: %d descriptor writes in %d batches\n",
+                frame, (uint32_t)frames.back().descriptorUpdateCount, (uint32_t)frames.back().descriptorBatchCount);
+        }
+
+        // 每个pass两个set，每个set一次提交
+        Check(frames[0].descriptorBatchCount == passCount * 2, "one batch per set", passed);
+        Check(frames[0].descriptorUpdateCount == passCount * 3 + passCount / 2, "first frame writes", passed);
+        Check(frames.back().descriptorUpdateCount == 0 && frames.back().descriptorBatchCount == 0, "steady state without writes", passed);
+    }
+
+    printf("[TestRDGDescriptorBatch] %s\n", passed ? "passed" : "FAILED");
+}
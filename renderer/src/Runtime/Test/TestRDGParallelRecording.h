@@ -0,0 +1,130 @@
+#pragma once
+
+#include "Function/Global/Definations.h"
+#include "Function/Global/EngineContext.h"
+#include "Function/Render/RDG/RDGBuilder.h"
+#include "Function/Render/RHI/NullRHI/NullRHI.h"
+#include "Function/Render/RHI/RHI.h"
+#include "TestRDGCompile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// RDG分段并行录制的测试，需要在空后端下(ENABLE_NULL_RHI)初始化EngineContext后调用
+// 同一张合成图分别串行录制和分段并行录制，合并提交后比较空后端记录的指令类型和参数，两者应完全一致
+// 合成图后再追加几个RecordOnMainThread的pass，并行录制时它们只能在主线程上执行
+// 例: TestRDGParallelRecording();
+
+namespace TestRDGParallelRecordingDetail
+{
+    // 主线程pass之间夹着足够长的普通pass，录制时需要在它们两侧切段
+    static void AddMainThreadPasses(RDGBuilder& builder, std::atomic<uint32_t>& offMainThread)
+    {
+        RDGTextureHandle texture = builder.CreateTexture("Main Thread Texture").MipLevels(4).Finish();
+        for(uint32_t i = 0; i < 3; i++)
+        {
+            builder.CreateComputePass("Main Thread " + std::to_string(i))
+                .Read(0, 0, 0, texture)
+                .RecordOnMainThread()
+                .Execute([&offMainThread](RDGPassContext context) {
+                    if(!EngineContext::ThreadPool()->IsMainThread()) offMainThread++;
+                    context.command->Dispatch(1, 1, 1);
+                })
+                .Finish();
+
+            for(uint32_t j = 0; j < 2 * MIN_RDG_PASSES_PER_CHUNK; j++)
+            {
+                builder.CreateComputePass("Worker " + std::to_string(i) + " " + std::to_string(j))
+                    .Read(0, 0, 0, texture)
+                    .Execute([](RDGPassContext context) { context.command->Dispatch(2, 1, 1); })
+                    .Finish();
+            }
+        }
+    }
+
+    static std::vector<NullRHICommandRecord> Record(uint32_t passCount, uint32_t seed, uint32_t workerCount, uint32_t& chunkCount, uint32_t& offMainThread)
+    {
+        RHIBackendRef backend = EngineContext::RHI();
+        RHIQueueRef queue = backend->GetQueue({ QUEUE_TYPE_GRAPHICS, 0 });
+
+        RHICommandListRef command = backend->CreateCommandPool({ queue })->CreateCommandList(false);
+        std::vector<RHICommandListRef> workerCommands;
+        for(uint32_t i = 0; i < workerCount; i++) workerCommands.push_back(backend->CreateCommandPool({ queue })->CreateCommandList(false));
+
+        std::vector<RHICommandListRef> recordedCommands;
+        std::atomic<uint32_t> offMain = 0;
+        command->BeginCommand();
+        {
+            RDGBuilder builder(command, workerCommands);
+            TestRDGCompileDetail::BuildSyntheticGraph(builder, passCount, seed, 7);
+            AddMainThreadPasses(builder, offMain);
+            builder.Execute();
+            recordedCommands = builder.GetRecordedCommands();
+        }
+        command->EndCommand();
+        command->Execute(recordedCommands);
+
+        chunkCount = recordedCommands.size() + 1;
+        offMainThread = offMain;
+        return static_cast<NullRHICommandContext*>(command->GetContext().get())->GetSubmitted();
+    }
+
+    // 两次执行分配到的资源对象可能不同，只比较指令类型和参数
+    static uint32_t Compare(const std::vector<NullRHICommandRecord>& a, const std::vector<NullRHICommandRecord>& b)
+    {
+        if(a.size() != b.size()) return std::max(a.size(), b.size());
+
+        uint32_t mismatch = 0;
+        for(uint32_t i = 0; i < a.size(); i++)
+        {
+            if(a[i].type != b[i].type || a[i].args != b[i].args) mismatch++;
+        }
+        return mismatch;
+    }
+}
+
+static void TestRDGParallelRecording()
+{
+    using namespace TestRDGParallelRecordingDetail;
+
+    if(std::dynamic_pointer_cast<NullRHIBackend>(EngineContext::RHI()) == nullptr)
+    {
+        printf("[TestRDGParallelRecording] skipped, requires null RHI backend\n");
+        return;
+    }
+
+    uint32_t failed = 0;
+    for(uint32_t seed = 0; seed < 10; seed++)
+    {
+        uint32_t passCount = 50 + seed * 10;
+        uint32_t serialChunks, parallelChunks, offMainThread;
+
+        Record(passCount, seed, 0, serialChunks, offMainThread);       // 预热资源池，之后每次执行分配到的资源初始状态一致
+        std::vector<NullRHICommandRecord> serial = Record(passCount, seed, 0, serialChunks, offMainThread);
+        std::vector<NullRHICommandRecord> parallel = Record(passCount, seed, MAX_RDG_RECORDING_CHUNKS - 1, parallelChunks, offMainThread);
+
+        uint32_t mismatch = Compare(serial, parallel);
+        if(mismatch != 0)
+        {
+            printf("[TestRDGParallelRecording] seed %d: %d mismatch in %d commands, %d chunks\n", seed, mismatch, (uint32_t)serial.size(), parallelChunks);
+            failed++;
+        }
+        if(offMainThread != 0)
+        {
+            printf("[TestRDGParallelRecording] seed %d: %d main thread passes recorded on workers\n", seed, offMainThread);
+            failed++;
+        }
+#if ENABLE_RDG_PARALLEL_RECORDING
+        if(parallelChunks <= 1)
+        {
+            printf("[TestRDGParallelRecording] seed %d: passes were not split into chunks\n", seed);
+            failed++;
+        }
+#endif
+    }
+    printf("[TestRDGParallelRecording] command stream: %s\n", failed == 0 ? "passed" : "FAILED");
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Core/Util/TimeScope.h"
+#include "Function/Global/EngineContext.h"
+#include "Function/Render/RHI/RHIStructs.h"
+#include "Function/Render/RHI/ShaderReflect.h"
+#include "Function/Render/RHI/ShaderReflectCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 遍历引擎自带的全部spv文件，比较缓存的反射信息和重新反射的结果，需要初始化EngineContext（只用到文件系统）
+// 每个着色器都检查序列化往返；spv旁边已经有缓存文件时也和它比较，代码更新过的缓存应当被判定为失效
+// 同时检查截断，篡改和代码不符的缓存都会被拒绝，并输出两种方式的总耗时
+// 例: TestShaderReflectCache();
+
+namespace TestShaderReflectCacheDetail
+{
+    // 返回第一个不一致的字段，全部一致时返回空
+    static std::string Diff(const ShaderReflectInfo& a, const ShaderReflectInfo& b)
+    {
+        if(a.name != b.name)                            return "name";
+        if(a.frequency != b.frequency)                  return "frequency";
+        if(a.localSizeX != b.localSizeX ||
+           a.localSizeY != b.localSizeY ||
+           a.localSizeZ != b.localSizeZ)                return "local size";
+        if(a.pushConstantSize != b.pushConstantSize)    return "push constant size";
+        if(a.inputVariables != b.inputVariables)        return "input variables";
+        if(a.outputVariables != b.outputVariables)      return "output variables";
+        if(a.resources != b.resources)                  return "resources";
+        if(a.definedSymbols != b.definedSymbols)        return "defined symbols";
+        return "";
+    }
+}
+
+static void TestShaderReflectCache()
+{
+    using namespace TestShaderReflectCacheDetail;
+
+    bool passed = true;
+    uint32_t shaderCount = 0, onDiskCount = 0, staleCount = 0;
+    float reflectTime = 0.0f, cachedTime = 0.0f;
+
+    for(const std::string& path : EngineContext::File()->Traverse(EngineContext::File()->ShaderPath(), true))
+    {
+        if(EngineContext::File()->Extension(path) != "spv") continue;
+
+        std::vector<uint8_t> code;
+        if(!EngineContext::File()->LoadBinary(path, code)) continue;
+        shaderCount++;
+
+        TimeScope timer;
+        timer.Begin();
+        ShaderReflectInfo fresh = {};
+        ShaderReflect::Reflect(code, fresh);
+        timer.End();
+        reflectTime += timer.GetMicroSeconds();
+
+        std::vector<uint8_t> file = ShaderReflectCache::Serialize(code, fresh);
+
+        timer.Begin();
+        ShaderReflectInfo cached = {};
+        bool loaded = ShaderReflectCache::Deserialize(file, code, cached);
+        timer.End();
+        cachedTime += timer.GetMicroSeconds();
+
+        std::string diff = loaded ? Diff(fresh, cached) : "deserialize";
+        if(!diff.empty())
+        {
+            passed = false;
+            printf("[TestShaderReflectCache] %s round trip mismatch: %s\n", path.c_str(), diff.c_str());
+        }
+
+        // 已有的缓存文件，失效的不算错误，运行时会重新反射后覆盖
+        if(EngineContext::File()->Exists(ShaderReflectCache::CachePath(path)))
+        {
+            onDiskCount++;
+            ShaderReflectInfo onDisk = {};
+            if(!ShaderReflectCache::Load(path, code, onDisk)) staleCount++;
+            else if(!(diff = Diff(fresh, onDisk)).empty())
+            {
+                passed = false;
+                printf("[TestShaderReflectCache] %s cache file mismatch: %s\n", path.c_str(), diff.c_str());
+            }
+        }
+
+        // 截断，篡改和代码不符
+        std::vector<uint8_t> truncated(file.begin(), file.end() - 1);
+        std::vector<uint8_t> corrupted = file;
+        corrupted.back() ^= 0xFF;
+        std::vector<uint8_t> modifiedCode = code;
+        modifiedCode[modifiedCode.size() / 2] ^= 0xFF;
+
+        ShaderReflectInfo rejected = {};
+        if( ShaderReflectCache::Deserialize(truncated, code, rejected) ||
+            ShaderReflectCache::Deserialize(corrupted, code, rejected) ||
+            ShaderReflectCache::Deserialize(file, modifiedCode, rejected) ||
+            !rejected.name.empty())
+        {
+            passed = false;
+            printf("[TestShaderReflectCache] %s invalid cache accepted\n", path.c_str());
+        }
+    }
+    passed &= shaderCount > 0;
+
+    printf("[TestShaderReflectCache] shaders %d, cache files %d (stale %d), reflect %.1f us, cached %.1f us\n",
+        shaderCount, onDiskCount, staleCount, reflectTime, cachedTime);
+    printf("[TestShaderReflectCache] %s\n", passed ? "passed" : "FAILED");
+}
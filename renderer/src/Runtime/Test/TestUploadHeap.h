@@ -0,0 +1,200 @@
+#pragma once
+
+#include "Core/Util/RingAllocator.h"
+#include "Function/Global/EngineContext.h"
+#include "Function/Render/RHI/NullRHI/NullRHI.h"
+#include "Function/Render/RHI/NullRHI/NullRHIResource.h"
+#include "Function/Render/RHI/RHI.h"
+#include "Function/Render/RenderResource/UploadHeap.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+// 上传堆的测试，环形缓冲的分配和回收部分不依赖EngineContext，上传部分需要在空后端下(ENABLE_NULL_RHI)初始化EngineContext后调用
+// RingAllocator用逐帧记录的分配做对照随机压力测试，检查对齐、不越界、尚未回收的分配互不重叠，分配失败不改变状态，全部回收后恢复为空
+// UploadHeap检查大缓冲拆段、环形缓冲满时使用单独暂存缓冲、拷贝后数据正确、纹理生成mip，以及按帧回收后空间可以重新使用
+// 例: TestUploadHeap();
+
+namespace TestUploadHeapDetail
+{
+    struct Allocation
+    {
+        uint64_t frame;
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    static bool Overlap(const Allocation& a, const Allocation& b)
+    {
+        return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+    }
+
+    static bool SameStats(const RingAllocatorStats& a, const RingAllocatorStats& b)
+    {
+        return  a.usedSize == b.usedSize && a.pendingSize == b.pendingSize &&
+                a.inFlightFrames == b.inFlightFrames && a.head == b.head;
+    }
+
+    // 模拟每帧若干次分配，GPU延迟latency帧完成
+    static bool Stress(uint32_t seed, uint64_t capacity, uint32_t frames, uint32_t latency)
+    {
+        std::mt19937 random(seed);
+        RingAllocator allocator(capacity);
+        std::vector<Allocation> live;
+
+        for(uint64_t frame = 1; frame <= frames; frame++)
+        {
+            if(frame > latency)
+            {
+                allocator.Retire(frame - latency);
+                std::erase_if(live, [&](const Allocation& allocation) { return allocation.frame <= frame - latency; });
+            }
+
+            uint32_t count = random() % 8;
+            for(uint32_t i = 0; i < count; i++)
+            {
+                uint64_t size = 1 + random() % (random() % 4 == 0 ? capacity / 2 : capacity / 16);
+                uint64_t alignment = 1ull << (random() % 9);
+
+                RingAllocatorStats before = allocator.GetStats();
+                uint64_t largest = allocator.LargestAllocation(alignment);
+                uint64_t offset;
+                if(!allocator.Allocate(size, alignment, offset))
+                {
+                    if(!SameStats(before, allocator.GetStats()) || size <= largest) return false;  // 不够时才允许失败
+                    continue;
+                }
+
+                Allocation allocation = { frame, offset, size };
+                if(offset % alignment != 0 || offset + size > capacity) return false;
+                for(auto& other : live) if(Overlap(allocation, other)) return false;
+                live.push_back(allocation);
+
+                uint64_t liveSize = 0;
+                for(auto& other : live) liveSize += other.size;
+                if(allocator.GetStats().usedSize < liveSize || allocator.GetStats().usedSize > capacity) return false;
+            }
+            allocator.FinishFrame(frame);
+        }
+
+        allocator.Retire(frames);
+        RingAllocatorStats stats = allocator.GetStats();
+        return stats.usedSize == 0 && stats.inFlightFrames == 0 && allocator.LargestAllocation(256) == capacity;
+    }
+
+    static void Check(bool condition, const char* name, bool& passed)
+    {
+        passed &= condition;
+        if(!condition) printf("[TestUploadHeap] %s FAILED\n", name);
+    }
+
+    static uint32_t CountCommands(const std::vector<NullRHICommandRecord>& records, NullRHICommandType type)
+    {
+        uint32_t count = 0;
+        for(auto& record : records) if(record.type == type) count++;
+        return count;
+    }
+}
+
+static void TestUploadHeap()
+{
+    using namespace TestUploadHeapDetail;
+
+    bool passed = true;
+
+    // 环形缓冲 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    {
+        RingAllocator allocator(1024);
+        uint64_t a, b, c, d;
+        Check(allocator.Allocate(100, 256, a) && a == 0 && allocator.Allocate(100, 256, b) && b == 256, "align", passed);
+        allocator.FinishFrame(1);
+
+        Check(!allocator.Allocate(600, 256, c) && allocator.LargestAllocation(256) == 512, "no space", passed);
+        Check(allocator.Allocate(512, 256, c) && c == 512 && allocator.GetStats().usedSize == 1024, "fill", passed);
+        allocator.FinishFrame(2);
+        Check(!allocator.Allocate(1, 1, d) && allocator.LargestAllocation(1) == 0, "full", passed);
+
+        allocator.Retire(1);        // 第一帧回收后从0回绕
+        Check(allocator.Allocate(300, 256, d) && d == 0 && allocator.GetStats().inFlightFrames == 1, "wrap", passed);
+        allocator.FinishFrame(3);
+
+        allocator.Retire(3);
+        Check(allocator.GetStats().usedSize == 0 && allocator.LargestAllocation(256) == 1024, "retire all", passed);
+        Check(!allocator.Allocate(2048, 1, d) && !allocator.Allocate(0, 1, d), "invalid size", passed);
+    }
+    {
+        uint32_t failed = 0;
+        for(uint32_t seed = 0; seed < 50; seed++)
+        {
+            if(!Stress(seed, 4096 + seed * 512, 300, 1 + seed % (FRAMES_IN_FLIGHT + 1))) failed++;
+        }
+        Check(failed == 0, "stress", passed);
+    }
+
+    // 上传 ////////////////////////////////////////////////////////////////////////////////////////////////////////
+    std::shared_ptr<NullRHIBackend> backend = std::dynamic_pointer_cast<NullRHIBackend>(EngineContext::RHI());
+    if(backend == nullptr) printf("[TestUploadHeap] upload skipped, requires null RHI backend\n");
+    else
+    {
+        const uint64_t capacity = 256 * 1024;
+        std::shared_ptr<UploadHeap> heap = std::make_shared<UploadHeap>(capacity);     // 独立实例，不影响引擎的全局上传堆
+        RHIQueueRef queue = backend->GetQueue({ QUEUE_TYPE_GRAPHICS, 0 });
+        RHICommandListRef command = backend->CreateCommandPool({ queue })->CreateCommandList(false);
+
+        std::vector<uint8_t> data(1024 * 1024);
+        for(uint32_t i = 0; i < data.size(); i++) data[i] = (i * 131 + i / 4096) & 0xFF;
+        RHIBufferRef dst = backend->CreateBuffer({ .size = data.size() + 4096, .type = RESOURCE_TYPE_RW_BUFFER });
+
+        RHITextureRef texture = backend->CreateTexture({
+            .format = FORMAT_R8G8B8A8_UNORM,
+            .extent = { 64, 64, 1 },
+            .arrayLayers = 1,
+            .mipLevels = 7,
+            .type = RESOURCE_TYPE_TEXTURE});
+        std::vector<uint8_t> pixels(64 * 64 * 4, 0x7F);
+
+        auto execute = [&](uint64_t frame) {
+            command->BeginCommand();
+            heap->Flush(command, frame);
+            command->EndCommand();
+            command->Execute();
+            return static_cast<NullRHICommandContext*>(command->GetContext().get())->GetSubmitted();
+        };
+
+        // 1MB的缓冲，环形缓冲用满后剩余部分放到单独的暂存缓冲
+        heap->UploadBuffer(dst, 4096, data.data(), data.size());
+        heap->UploadTexture(texture, { pixels.data() }, pixels.size());
+        Check(heap->PendingSize() == 2, "pending", passed);
+
+        std::vector<NullRHICommandRecord> records = execute(1);
+        UploadHeapStats stats = heap->GetStats();
+        uint8_t* result = std::static_pointer_cast<NullRHIBuffer>(dst)->GetData() + 4096;
+        Check(  stats.uploadCount == 2 && stats.copyCount == 3 && stats.fallbackCount == 2 &&
+                stats.usedBytes == capacity && heap->PendingSize() == 0, "chunked upload stats", passed);
+        Check(memcmp(result, data.data(), data.size()) == 0, "buffer content", passed);
+        Check(  CountCommands(records, NULL_RHI_COMMAND_COPY_BUFFER) == 2 &&
+                CountCommands(records, NULL_RHI_COMMAND_COPY_BUFFER_TO_TEXTURE) == 1 &&
+                CountCommands(records, NULL_RHI_COMMAND_GENERATE_MIPS) == 1, "recorded commands", passed);
+
+        // 第一帧尚未回收时环形缓冲已满
+        heap->UploadBuffer(dst, 0, data.data(), 1024);
+        execute(2);
+        Check(heap->GetStats().fallbackCount == 1, "full before retire", passed);
+
+        // 回收后重新使用环形缓冲
+        heap->Retire(2);
+        heap->UploadBuffer(dst, 0, data.data() + 1024, 1024);
+        execute(3);
+        stats = heap->GetStats();
+        Check(  stats.fallbackCount == 0 && stats.usedBytes == 1024 &&
+                memcmp(std::static_pointer_cast<NullRHIBuffer>(dst)->GetData(), data.data() + 1024, 1024) == 0, "reuse after retire", passed);
+
+        printf("[TestUploadHeap] capacity %d KB, last frame %d copies, %d fallback\n", (uint32_t)(capacity / 1024), stats.copyCount, stats.fallbackCount);
+    }
+
+    printf("[TestUploadHeap] %s\n", passed ? "passed" : "FAILED");
+}
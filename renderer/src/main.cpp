@@ -893,6 +893,8 @@ int main()
 {  
     EngineContext::Init();
 
+    //BenchmarkVirtualMesh({ "Asset/BuildIn/Model/Basic/stanford_bunny.obj", "Asset/BuildIn/Model/Klee/klee.obj" }, 8);   // 虚拟几何体构建的性能测试，需要#include "Test/BenchmarkVirtualMesh.h"
+
     //InitCornellBoxScene();
     InitScene();
     EngineContext::MainLoop();